@@ -0,0 +1,62 @@
+// Startup benchmark of the extension. Measures how long loading the (statically linked) extension into a new database
+// takes, and how long the first calls that initialize the lazily set up modules (the GDAL drivers and the PROJ
+// database) take afterwards. The process wide initialization only happens once, so the first database of the process
+// is reported separately from the mean of the following ones.
+//
+// Usage: spatial_load_benchmark [iterations]
+
+#include "duckdb.hpp"
+#include "spatial/spatial_extension.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+
+double TimeMs(const std::function<void()> &func) {
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void Query(duckdb::Connection &con, const char *sql) {
+	const auto result = con.Query(sql);
+	if (result->HasError()) {
+		fprintf(stderr, "%s: %s\n", sql, result->GetError().c_str());
+		std::exit(1);
+	}
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	using namespace duckdb;
+
+	const auto iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+
+	printf("%-40s %12s\n", "step", "ms");
+
+	// The first database of the process pays for the process wide initialization
+	{
+		DuckDB db(nullptr);
+		printf("%-40s %12.3f\n", "load (first)", TimeMs([&]() { db.LoadStaticExtension<SpatialExtension>(); }));
+
+		Connection con(db);
+		printf("%-40s %12.3f\n", "first ST_Drivers()",
+		       TimeMs([&]() { Query(con, "SELECT count(*) FROM ST_Drivers()"); }));
+		printf("%-40s %12.3f\n", "first ST_Transform()", TimeMs([&]() {
+			       Query(con, "SELECT ST_Transform(ST_Point(1, 1), 'EPSG:4326', 'EPSG:3857')");
+		       }));
+	}
+
+	double total = 0;
+	for (int i = 0; i < iterations; i++) {
+		DuckDB db(nullptr);
+		total += TimeMs([&]() { db.LoadStaticExtension<SpatialExtension>(); });
+	}
+	printf("%-40s %12.3f\n", "load (mean of following)", iterations > 0 ? total / iterations : 0.0);
+	return 0;
+}
@@ -0,0 +1,394 @@
+// Micro benchmarks of the geometry kernels of sgl and of the geometry serialization, outside of the SQL executor.
+// Every kernel runs over a few corpora of generated geometries (points, long linestrings, polygons with many rings and
+// deeply nested collections), and reports the time per vertex and per geometry, the heap allocations per geometry, and
+// the allocations per geometry requested from the sgl allocator (which are served by an arena, as in the extension).
+//
+// Usage: spatial_micro_benchmark [filter] [min_seconds]
+// Only the benchmarks whose name ("<corpus>/<kernel>") contains the filter are run.
+
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
+
+#include "duckdb/common/allocator.hpp"
+#include "duckdb/storage/arena_allocator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+// Allocation counting
+//----------------------------------------------------------------------------------------------------------------------
+// The heap allocations of the kernels all go through operator new or the (counting) duckdb allocator of the arena
+
+static size_t heap_allocation_count = 0;
+static size_t sgl_allocation_count = 0;
+
+void *operator new(size_t size) {
+	heap_allocation_count++;
+	if (auto ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+namespace duckdb {
+
+namespace {
+
+data_ptr_t CountingAllocate(PrivateAllocatorData *, idx_t size) {
+	heap_allocation_count++;
+	return static_cast<data_ptr_t>(std::malloc(size));
+}
+
+void CountingFree(PrivateAllocatorData *, data_ptr_t ptr, idx_t) {
+	std::free(ptr);
+}
+
+data_ptr_t CountingReallocate(PrivateAllocatorData *, data_ptr_t ptr, idx_t, idx_t size) {
+	heap_allocation_count++;
+	return static_cast<data_ptr_t>(std::realloc(ptr, size));
+}
+
+// An sgl allocator on top of an arena, like the GeometryAllocator of the extension, which counts the allocations
+struct CountingArenaAllocator final : sgl::allocator {
+	explicit CountingArenaAllocator(ArenaAllocator &arena_p) : arena(arena_p) {
+	}
+	void *alloc(size_t size) override {
+		sgl_allocation_count++;
+		return arena.AllocateAligned(size);
+	}
+	void dealloc(void *ptr, size_t size) override {
+	}
+	void *realloc(void *ptr, size_t old_size, size_t new_size) override {
+		sgl_allocation_count++;
+		return arena.ReallocateAligned(static_cast<data_ptr_t>(ptr), old_size, new_size);
+	}
+	ArenaAllocator &arena;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Corpora
+//----------------------------------------------------------------------------------------------------------------------
+// The geometries of a corpus are allocated with the (non-counting) arena of the corpus, and kept alive for the whole
+// run. Every corpus holds about one million vertices.
+
+struct Corpus {
+	explicit Corpus(const char *name_p) : name(name_p), arena(Allocator::DefaultAllocator()) {
+	}
+
+	const char *name;
+	ArenaAllocator arena;
+	std::vector<sgl::geometry *> geoms;
+	size_t vertex_count = 0;
+
+	// The geometries in the formats parsed by the benchmarks
+	std::vector<std::string> wkb;
+	std::vector<std::string> wkt;
+	std::vector<std::string> blobs;
+
+	sgl::geometry *New(sgl::geometry_type type) {
+		return new (arena.AllocateAligned(sizeof(sgl::geometry))) sgl::geometry(type);
+	}
+
+	sgl::geometry *NewLine(sgl::geometry_type type, std::mt19937_64 &rng, uint32_t count, double radius, bool closed) {
+		const auto geom = New(type);
+		const auto data = reinterpret_cast<double *>(arena.AllocateAligned(count * 2 * sizeof(double)));
+		std::uniform_real_distribution<double> jitter(0.9, 1.1);
+		std::uniform_real_distribution<double> offset(0, 1000);
+		const auto cx = offset(rng);
+		const auto cy = offset(rng);
+		for (uint32_t i = 0; i < count; i++) {
+			// A (jittered) circle, so that polygons are simple and have a sensible area
+			const auto angle = 2 * 3.14159265358979323846 * i / (closed ? count - 1 : count);
+			const auto r = radius * jitter(rng);
+			data[i * 2] = cx + r * std::cos(angle);
+			data[i * 2 + 1] = cy + r * std::sin(angle);
+		}
+		if (closed) {
+			data[(count - 1) * 2] = data[0];
+			data[(count - 1) * 2 + 1] = data[1];
+		}
+		geom->set_vertex_data(reinterpret_cast<const char *>(data), count);
+		return geom;
+	}
+
+	sgl::geometry *NewPolygon(std::mt19937_64 &rng, uint32_t ring_count, uint32_t ring_size) {
+		const auto polygon = New(sgl::geometry_type::POLYGON);
+		polygon->append_part(NewLine(sgl::geometry_type::LINESTRING, rng, ring_size, 100, true));
+		for (uint32_t i = 1; i < ring_count; i++) {
+			polygon->append_part(NewLine(sgl::geometry_type::LINESTRING, rng, ring_size, 1, true));
+		}
+		return polygon;
+	}
+
+	sgl::geometry *NewCollection(std::mt19937_64 &rng, uint32_t depth) {
+		if (depth == 0) {
+			return rng() % 2 ? NewLine(sgl::geometry_type::POINT, rng, 1, 0, false)
+			                 : NewLine(sgl::geometry_type::LINESTRING, rng, 4, 10, false);
+		}
+		const auto collection = New(sgl::geometry_type::MULTI_GEOMETRY);
+		collection->append_part(NewCollection(rng, depth - 1));
+		collection->append_part(NewCollection(rng, depth - 1));
+		return collection;
+	}
+
+	// Encode the geometries as WKB, WKT and serialized blobs
+	void Encode() {
+		for (const auto geom : geoms) {
+			vertex_count += sgl::ops::vertex_count(geom);
+
+			std::string buffer(sgl::ops::to_wkb_size(geom), '\0');
+			sgl::ops::to_wkb(geom, reinterpret_cast<uint8_t *>(&buffer[0]), buffer.size());
+			wkb.push_back(std::move(buffer));
+
+			std::string text;
+			WriteWKT(geom, text, true);
+			wkt.push_back(std::move(text));
+
+			buffer.assign(Serde::GetRequiredSize(*geom), '\0');
+			Serde::Serialize(*geom, &buffer[0], buffer.size());
+			blobs.push_back(std::move(buffer));
+		}
+	}
+
+	static void WriteWKT(const sgl::geometry *geom, std::string &text, bool tagged) {
+		char number[64];
+		switch (geom->get_type()) {
+		case sgl::geometry_type::POINT:
+		case sgl::geometry_type::LINESTRING: {
+			if (tagged) {
+				text += geom->get_type() == sgl::geometry_type::POINT ? "POINT " : "LINESTRING ";
+			}
+			text += '(';
+			for (uint32_t i = 0; i < geom->get_count(); i++) {
+				const auto vertex = geom->get_vertex_xy(i);
+				snprintf(number, sizeof(number), "%s%.17g %.17g", i ? ", " : "", vertex.x, vertex.y);
+				text += number;
+			}
+			text += ')';
+		} break;
+		default: {
+			if (geom->get_type() == sgl::geometry_type::POLYGON) {
+				text += tagged ? "POLYGON (" : "(";
+			} else {
+				text += "GEOMETRYCOLLECTION (";
+			}
+			const auto tail = geom->get_last_part();
+			auto part = tail;
+			do {
+				part = part->get_next();
+				WriteWKT(part, text, geom->get_type() != sgl::geometry_type::POLYGON);
+				if (part != tail) {
+					text += ", ";
+				}
+			} while (part != tail);
+			text += ')';
+		} break;
+		}
+	}
+};
+
+std::vector<std::unique_ptr<Corpus>> MakeCorpora() {
+	std::vector<std::unique_ptr<Corpus>> corpora;
+	std::mt19937_64 rng(42);
+
+	corpora.emplace_back(new Corpus("points"));
+	for (idx_t i = 0; i < 1000000; i++) {
+		corpora.back()->geoms.push_back(corpora.back()->NewLine(sgl::geometry_type::POINT, rng, 1, 0, false));
+	}
+
+	corpora.emplace_back(new Corpus("linestrings"));
+	for (idx_t i = 0; i < 100; i++) {
+		corpora.back()->geoms.push_back(corpora.back()->NewLine(sgl::geometry_type::LINESTRING, rng, 10000, 100, false));
+	}
+
+	corpora.emplace_back(new Corpus("polygons"));
+	for (idx_t i = 0; i < 300; i++) {
+		corpora.back()->geoms.push_back(corpora.back()->NewPolygon(rng, 100, 32));
+	}
+
+	corpora.emplace_back(new Corpus("collections"));
+	for (idx_t i = 0; i < 2000; i++) {
+		corpora.back()->geoms.push_back(corpora.back()->NewCollection(rng, 8));
+	}
+
+	for (auto &corpus : corpora) {
+		corpus->Encode();
+	}
+	return corpora;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Benchmarks
+//----------------------------------------------------------------------------------------------------------------------
+
+// Keeps the results of the kernels alive, so that they are not optimized away
+volatile double sink = 0;
+
+struct Kernel {
+	const char *name;
+	// Run the kernel over the geometry with the given index of the corpus
+	std::function<void(Corpus &corpus, idx_t geom_idx)> run;
+};
+
+std::vector<Kernel> MakeKernels(ArenaAllocator &arena, sgl::allocator &alloc) {
+	std::vector<Kernel> kernels;
+
+	kernels.push_back({"wkb_reader_try_parse", [&](Corpus &corpus, idx_t geom_idx) {
+		                   const auto &wkb = corpus.wkb[geom_idx];
+		                   uint32_t stack[256];
+		                   sgl::ops::wkb_reader reader = {};
+		                   reader.alloc = &alloc;
+		                   reader.buf = wkb.data();
+		                   reader.end = wkb.data() + wkb.size();
+		                   reader.copy_vertices = false;
+		                   reader.stack_buf = stack;
+		                   reader.stack_cap = 256;
+
+		                   sgl::geometry geom;
+		                   if (!sgl::ops::wkb_reader_try_parse(&reader, &geom)) {
+			                   throw std::runtime_error(sgl::ops::wkb_reader_get_error_message(&reader));
+		                   }
+		                   sink = sink + geom.get_count();
+	                   }});
+
+	kernels.push_back({"wkt_reader_try_parse", [&](Corpus &corpus, idx_t geom_idx) {
+		                   const auto &wkt = corpus.wkt[geom_idx];
+		                   sgl::ops::wkt_reader reader = {};
+		                   reader.alloc = &alloc;
+		                   reader.buf = wkt.data();
+		                   reader.end = wkt.data() + wkt.size();
+
+		                   sgl::geometry geom;
+		                   if (!sgl::ops::wkt_reader_try_parse(&reader, &geom)) {
+			                   throw std::runtime_error(sgl::ops::wkt_reader_get_error_message(&reader));
+		                   }
+		                   sink = sink + geom.get_count();
+	                   }});
+
+	kernels.push_back({"area", [&](Corpus &corpus, idx_t geom_idx) {
+		                   sink = sink + sgl::ops::area(corpus.geoms[geom_idx]);
+	                   }});
+
+	kernels.push_back({"distance", [&](Corpus &corpus, idx_t geom_idx) {
+		                   sgl::geometry point(sgl::geometry_type::POINT);
+		                   const double xy[2] = {500, 500};
+		                   point.set_vertex_data(reinterpret_cast<const char *>(xy), 1);
+		                   sink = sink + sgl::ops::distance(corpus.geoms[geom_idx], &point);
+	                   }});
+
+	kernels.push_back({"affine_transform", [&](Corpus &corpus, idx_t geom_idx) {
+		                   // Transform a deserialized copy, which references the vertices of the blob, into new vertices
+		                   const auto &blob = corpus.blobs[geom_idx];
+		                   sgl::geometry geom;
+		                   Serde::Deserialize(geom, arena, blob.data(), blob.size());
+		                   const auto matrix = sgl::affine_matrix::translate(1, 2);
+		                   sgl::ops::affine_transform(&alloc, &geom, &matrix);
+		                   sink = sink + geom.get_count();
+	                   }});
+
+	kernels.push_back({"hilbert_encode", [&](Corpus &corpus, idx_t geom_idx) {
+		                   uint32_t hash = 0;
+		                   sgl::ops::visit_vertices(corpus.geoms[geom_idx], [&](const uint8_t *vertex) {
+			                   double xy[2];
+			                   memcpy(xy, vertex, sizeof(xy));
+			                   hash ^= sgl::util::hilbert_encode(16, static_cast<uint32_t>(xy[0] * 60),
+			                                                     static_cast<uint32_t>(xy[1] * 60));
+		                   });
+		                   sink = sink + hash;
+	                   }});
+
+	kernels.push_back({"serialize", [&](Corpus &corpus, idx_t geom_idx) {
+		                   const auto &geom = *corpus.geoms[geom_idx];
+		                   const auto size = Serde::GetRequiredSize(geom);
+		                   const auto buffer = arena.AllocateAligned(size);
+		                   Serde::Serialize(geom, reinterpret_cast<char *>(buffer), size);
+		                   sink = sink + buffer[size - 1];
+	                   }});
+
+	kernels.push_back({"deserialize", [&](Corpus &corpus, idx_t geom_idx) {
+		                   const auto &blob = corpus.blobs[geom_idx];
+		                   sgl::geometry geom;
+		                   Serde::Deserialize(geom, arena, blob.data(), blob.size());
+		                   sink = sink + geom.get_count();
+	                   }});
+
+	return kernels;
+}
+
+// Run a kernel over the whole corpus until at least min_seconds have passed, and print the averages
+void RunKernel(const Kernel &kernel, Corpus &corpus, ArenaAllocator &arena, double min_seconds) {
+	// Warm up, which also grows the arena to its steady state
+	for (idx_t i = 0; i < corpus.geoms.size(); i++) {
+		kernel.run(corpus, i);
+		arena.Reset();
+	}
+
+	idx_t iterations = 0;
+	double seconds = 0;
+	heap_allocation_count = 0;
+	sgl_allocation_count = 0;
+	const auto start = std::chrono::steady_clock::now();
+	do {
+		for (idx_t i = 0; i < corpus.geoms.size(); i++) {
+			kernel.run(corpus, i);
+			arena.Reset();
+		}
+		iterations++;
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	} while (seconds < min_seconds);
+
+	const auto geom_count = static_cast<double>(corpus.geoms.size() * iterations);
+	const auto vertex_count = static_cast<double>(corpus.vertex_count * iterations);
+	printf("%-12s %-22s %12.2f %14.1f %14.3f %14.3f\n", corpus.name, kernel.name, seconds * 1e9 / vertex_count,
+	       seconds * 1e9 / geom_count, static_cast<double>(heap_allocation_count) / geom_count,
+	       static_cast<double>(sgl_allocation_count) / geom_count);
+}
+
+} // namespace
+
+} // namespace duckdb
+
+int main(int argc, char **argv) {
+	using namespace duckdb;
+
+	const std::string filter = argc > 1 ? argv[1] : "";
+	const auto min_seconds = argc > 2 ? std::atof(argv[2]) : 0.5;
+
+	auto corpora = MakeCorpora();
+
+	Allocator counting_allocator(CountingAllocate, CountingFree, CountingReallocate, nullptr);
+	ArenaAllocator arena(counting_allocator);
+	CountingArenaAllocator alloc(arena);
+	const auto kernels = MakeKernels(arena, alloc);
+
+	printf("%-12s %-22s %12s %14s %14s %14s\n", "corpus", "kernel", "ns/vertex", "ns/geometry", "allocs/geom",
+	       "sgl allocs/geom");
+	for (auto &corpus : corpora) {
+		for (const auto &kernel : kernels) {
+			const auto name = std::string(corpus->name) + "/" + kernel.name;
+			if (name.find(filter) == std::string::npos) {
+				continue;
+			}
+			RunKernel(kernel, *corpus, arena, min_seconds);
+		}
+	}
+	return 0;
+}
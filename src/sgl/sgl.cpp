@@ -5,6 +5,7 @@
 #include "sgl/sgl.hpp"
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <vector>
 
 namespace sgl {
@@ -291,6 +292,179 @@ void substring(sgl::geometry *line, sgl::allocator *alloc, const sgl::geometry *
 
 } // namespace linestring
 
+//----------------------------------------------------------------------------------------------------------------------
+// Projection
+//----------------------------------------------------------------------------------------------------------------------
+
+static constexpr double WGS84_A = 6378137.0;
+static constexpr double WGS84_F = 1.0 / 298.257223563;
+static constexpr double DEG_TO_RAD = 0.017453292519943295;
+static constexpr double RAD_TO_DEG = 57.29577951308232;
+static constexpr double PI = 3.14159265358979323846;
+static constexpr double HALF_PI = 1.57079632679489661923;
+
+// Wrap a longitude into [-pi, pi], like PROJ does
+static double wrap_longitude(double lon) {
+	if (std::fabs(lon) < PI + 1e-12) {
+		return lon;
+	}
+	lon += PI;
+	lon -= 2 * PI * std::floor(lon / (2 * PI));
+	return lon - PI;
+}
+
+projection projection::web_mercator(bool inverse, bool lat_lon_order) {
+	projection result;
+	result.type = kind::WEB_MERCATOR;
+	result.inverse = inverse;
+	result.lat_lon_order = lat_lon_order;
+	result.radius = WGS84_A;
+	return result;
+}
+
+projection projection::utm(int zone, bool south, bool inverse, bool lat_lon_order) {
+	projection result;
+	result.type = kind::TRANSVERSE_MERCATOR;
+	result.inverse = inverse;
+	result.lat_lon_order = lat_lon_order;
+	result.lon_0 = (zone * 6.0 - 183.0) * DEG_TO_RAD;
+	result.false_easting = 500000.0;
+	result.false_northing = south ? 10000000.0 : 0.0;
+
+	// Krueger series coefficients, see Karney (2011): "Transverse Mercator with an accuracy of a few nanometers"
+	const auto n = WGS84_F / (2 - WGS84_F);
+	const auto n2 = n * n;
+	const auto n3 = n2 * n;
+	const auto n4 = n3 * n;
+	const auto n5 = n4 * n;
+	const auto n6 = n5 * n;
+
+	constexpr auto k_0 = 0.9996;
+	result.radius = k_0 * WGS84_A / (1 + n) * (1 + n2 / 4 + n4 / 64 + n6 / 256);
+
+	result.alpha[0] = n / 2 - 2 * n2 / 3 + 5 * n3 / 16 + 41 * n4 / 180 - 127 * n5 / 288 + 7891 * n6 / 37800;
+	result.alpha[1] = 13 * n2 / 48 - 3 * n3 / 5 + 557 * n4 / 1440 + 281 * n5 / 630 - 1983433 * n6 / 1935360;
+	result.alpha[2] = 61 * n3 / 240 - 103 * n4 / 140 + 15061 * n5 / 26880 + 167603 * n6 / 181440;
+	result.alpha[3] = 49561 * n4 / 161280 - 179 * n5 / 168 + 6601661 * n6 / 7257600;
+	result.alpha[4] = 34729 * n5 / 80640 - 3418889 * n6 / 1995840;
+	result.alpha[5] = 212378941 * n6 / 319334400;
+
+	result.beta[0] = n / 2 - 2 * n2 / 3 + 37 * n3 / 96 - n4 / 360 - 81 * n5 / 512 + 96199 * n6 / 604800;
+	result.beta[1] = n2 / 48 + n3 / 15 - 437 * n4 / 1440 + 46 * n5 / 105 - 1118711 * n6 / 3870720;
+	result.beta[2] = 17 * n3 / 480 - 37 * n4 / 840 - 209 * n5 / 4480 + 5569 * n6 / 90720;
+	result.beta[3] = 4397 * n4 / 161280 - 11 * n5 / 504 - 830251 * n6 / 7257600;
+	result.beta[4] = 4583 * n5 / 161280 - 108847 * n6 / 3991680;
+	result.beta[5] = 20648693 * n6 / 638668800;
+
+	return result;
+}
+
+// The conformal latitude (as tangent) of a geodetic latitude (as tangent)
+static double conformal_tan(double tau, double e) {
+	const auto sigma = std::sinh(e * std::atanh(e * tau / std::sqrt(1 + tau * tau)));
+	return tau * std::sqrt(1 + sigma * sigma) - sigma * std::sqrt(1 + tau * tau);
+}
+
+void projection::apply(double *x, double *y, size_t count, size_t stride) const {
+	constexpr auto invalid = HUGE_VAL;
+
+	// The longitude/latitude side
+	double *lon_ptr = lat_lon_order ? y : x;
+	double *lat_ptr = lat_lon_order ? x : y;
+
+	switch (type) {
+	case kind::WEB_MERCATOR: {
+		if (!inverse) {
+			for (size_t i = 0; i < count; i++) {
+				const auto lon = lon_ptr[i * stride] * DEG_TO_RAD;
+				const auto lat = lat_ptr[i * stride] * DEG_TO_RAD;
+				// The poles are infinitely far away
+				if (std::fabs(lat) > HALF_PI - 1e-10 || std::isnan(lon) || std::isnan(lat)) {
+					x[i * stride] = invalid;
+					y[i * stride] = invalid;
+					continue;
+				}
+				x[i * stride] = radius * wrap_longitude(lon);
+				y[i * stride] = radius * std::asinh(std::tan(lat));
+			}
+		} else {
+			for (size_t i = 0; i < count; i++) {
+				const auto easting = x[i * stride];
+				const auto northing = y[i * stride];
+				lon_ptr[i * stride] = wrap_longitude(easting / radius) * RAD_TO_DEG;
+				lat_ptr[i * stride] = std::atan(std::sinh(northing / radius)) * RAD_TO_DEG;
+			}
+		}
+	} break;
+	case kind::TRANSVERSE_MERCATOR: {
+		const auto e = std::sqrt(WGS84_F * (2 - WGS84_F));
+		const auto e2m = 1 - e * e;
+
+		if (!inverse) {
+			for (size_t i = 0; i < count; i++) {
+				const auto lon = lon_ptr[i * stride] * DEG_TO_RAD;
+				const auto lat = lat_ptr[i * stride] * DEG_TO_RAD;
+				if (std::fabs(lat) > HALF_PI + 1e-12 || std::isnan(lon) || std::isnan(lat)) {
+					x[i * stride] = invalid;
+					y[i * stride] = invalid;
+					continue;
+				}
+
+				const auto lam = wrap_longitude(lon - lon_0);
+				const auto tau_p = conformal_tan(std::tan(lat), e);
+				const auto cos_lam = std::cos(lam);
+				const auto xi_p = std::atan2(tau_p, cos_lam);
+				const auto eta_p = std::asinh(std::sin(lam) / std::hypot(tau_p, cos_lam));
+
+				auto xi = xi_p;
+				auto eta = eta_p;
+				for (int j = 0; j < 6; j++) {
+					const auto k = 2.0 * (j + 1);
+					xi += alpha[j] * std::sin(k * xi_p) * std::cosh(k * eta_p);
+					eta += alpha[j] * std::cos(k * xi_p) * std::sinh(k * eta_p);
+				}
+
+				x[i * stride] = false_easting + radius * eta;
+				y[i * stride] = false_northing + radius * xi;
+			}
+		} else {
+			for (size_t i = 0; i < count; i++) {
+				const auto xi = (y[i * stride] - false_northing) / radius;
+				const auto eta = (x[i * stride] - false_easting) / radius;
+
+				auto xi_p = xi;
+				auto eta_p = eta;
+				for (int j = 0; j < 6; j++) {
+					const auto k = 2.0 * (j + 1);
+					xi_p -= beta[j] * std::sin(k * xi) * std::cosh(k * eta);
+					eta_p -= beta[j] * std::cos(k * xi) * std::sinh(k * eta);
+				}
+
+				const auto sinh_eta_p = std::sinh(eta_p);
+				const auto cos_xi_p = std::cos(xi_p);
+				const auto tau_p = std::sin(xi_p) / std::hypot(sinh_eta_p, cos_xi_p);
+				const auto lam = std::atan2(sinh_eta_p, cos_xi_p);
+
+				// Newton's method to get the geodetic latitude back from the conformal latitude
+				auto tau = tau_p / e2m;
+				for (int iter = 0; iter < 5; iter++) {
+					const auto tau_i = conformal_tan(tau, e);
+					const auto delta = (tau_p - tau_i) / std::sqrt(1 + tau_i * tau_i) * (1 + e2m * tau * tau) /
+					                   (e2m * std::sqrt(1 + tau * tau));
+					tau += delta;
+					if (!(std::fabs(delta) >= 1e-14 * std::fmax(1.0, std::fabs(tau)))) {
+						break;
+					}
+				}
+
+				lon_ptr[i * stride] = wrap_longitude(lam + lon_0) * RAD_TO_DEG;
+				lat_ptr[i * stride] = std::atan(tau) * RAD_TO_DEG;
+			}
+		}
+	} break;
+	}
+}
+
 namespace ops {
 static uint8_t *resize_vertices(allocator &alloc, geometry *geom, bool set_z, bool set_m, double default_z,
 								double default_m) {
@@ -1329,8 +1503,17 @@ size_t to_wkb(const geometry *geom, uint8_t *buffer, size_t size) {
 // WKT Parsing
 //------------------------------------------------------------------------------
 
+static bool is_ws(char c) {
+	// Locale independent equivalent of std::isspace
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool is_digit(char c) {
+	return static_cast<unsigned char>(c - '0') < 10;
+}
+
 static void parse_ws(wkt_reader *state) {
-	while (state->pos < state->end && std::isspace(*state->pos)) {
+	while (state->pos < state->end && is_ws(*state->pos)) {
 		state->pos++;
 	}
 }
@@ -1361,60 +1544,148 @@ static bool match_char(wkt_reader *state, char c) {
 	return false;
 }
 
-static bool match_double(wkt_reader *state, double *result) {
+const char *parse_double(const char *beg, const char *end, double *result) {
 	// Because we care about the length, we cant just use std::strtod straight away without risking
-	// out-of-bounds reads. Instead, we will manually parse the number and then use std::strtod to
-	// convert the value.
+	// out-of-bounds reads. Instead, we manually scan the number, accumulating the significant digits as we go.
+	// If the number fits in a double exactly and the (decimal) exponent is small enough, a single
+	// multiplication or division with an exact power of ten gives the correctly rounded result (Clinger's fast
+	// path). This covers almost all coordinates found in practice, everything else falls back to std::strtod.
 
-	auto ptr = state->pos;
+	static constexpr double POWERS_OF_TEN[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+	                                           1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+	                                           1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	static constexpr int32_t MAX_EXACT_POWER = 22;
+	static constexpr uint64_t MAX_EXACT_MANTISSA = 1ULL << 53;
+	static constexpr int32_t MAX_MANTISSA_DIGITS = 19;
+
+	auto ptr = beg;
 
 	// Match sign
-	if (ptr < state->end && (*ptr == '+' || *ptr == '-')) {
+	bool negative = false;
+	if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+		negative = *ptr == '-';
 		ptr++;
 	}
 
+	uint64_t mantissa = 0;
+	int32_t mantissa_digits = 0;
+	int32_t exponent = 0;
+	bool truncated = false;
+	size_t digit_count = 0;
+
 	// Match number part
-	while (ptr < state->end && std::isdigit(*ptr)) {
+	const auto int_beg = ptr;
+	while (ptr < end && is_digit(*ptr)) {
+		if (mantissa_digits < MAX_MANTISSA_DIGITS) {
+			mantissa = mantissa * 10 + static_cast<uint64_t>(*ptr - '0');
+			mantissa_digits += mantissa != 0;
+		} else {
+			truncated = true;
+		}
 		ptr++;
 	}
+	digit_count += static_cast<size_t>(ptr - int_beg);
 
 	// Match decimal part
-	if (ptr < state->end && *ptr == '.') {
+	if (ptr < end && *ptr == '.') {
 		ptr++;
-		while (ptr < state->end && std::isdigit(*ptr)) {
+		const auto frac_beg = ptr;
+		while (ptr < end && is_digit(*ptr)) {
+			if (mantissa_digits < MAX_MANTISSA_DIGITS) {
+				mantissa = mantissa * 10 + static_cast<uint64_t>(*ptr - '0');
+				mantissa_digits += mantissa != 0;
+				exponent--;
+			} else {
+				truncated = true;
+			}
 			ptr++;
 		}
+		digit_count += static_cast<size_t>(ptr - frac_beg);
 	}
 
-	// Match exponent part
-	if (ptr < state->end && (*ptr == 'e' || *ptr == 'E')) {
-		ptr++;
-		if (ptr < state->end && (*ptr == '+' || *ptr == '-')) {
-			ptr++;
-		}
+	// Did we manage to parse anything?
+	if (digit_count == 0) {
+		return nullptr;
+	}
 
-		while (ptr < state->end && std::isdigit(*ptr)) {
-			ptr++;
+	// Match exponent part, but only if there are digits following it
+	if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+		auto exp_ptr = ptr + 1;
+		bool exp_negative = false;
+		if (exp_ptr < end && (*exp_ptr == '+' || *exp_ptr == '-')) {
+			exp_negative = *exp_ptr == '-';
+			exp_ptr++;
+		}
+		if (exp_ptr < end && is_digit(*exp_ptr)) {
+			int32_t exp_value = 0;
+			while (exp_ptr < end && is_digit(*exp_ptr)) {
+				// Saturate, anything this large is handled by strtod anyway
+				if (exp_value < 100000) {
+					exp_value = exp_value * 10 + (*exp_ptr - '0');
+				}
+				exp_ptr++;
+			}
+			exponent += exp_negative ? -exp_value : exp_value;
+			ptr = exp_ptr;
 		}
 	}
 
-	// Did we manage to parse anything?
-	if (ptr == state->pos) {
-		return false;
+	if (!truncated && mantissa <= MAX_EXACT_MANTISSA && exponent >= -MAX_EXACT_POWER &&
+	    exponent <= MAX_EXACT_POWER) {
+		auto value = static_cast<double>(mantissa);
+		if (exponent < 0) {
+			value /= POWERS_OF_TEN[-exponent];
+		} else {
+			value *= POWERS_OF_TEN[exponent];
+		}
+		*result = negative ? -value : value;
+	} else {
+		// Slow path, copy the number so that strtod cant read past the end of the input
+		const auto len = static_cast<size_t>(ptr - beg);
+		char small_buf[64];
+		std::string large_buf;
+		char *num = small_buf;
+		if (len >= sizeof(small_buf)) {
+			large_buf.assign(beg, len);
+			num = &large_buf[0];
+		} else {
+			memcpy(small_buf, beg, len);
+			small_buf[len] = '\0';
+		}
+
+		char *num_end;
+		*result = std::strtod(num, &num_end);
+		if (num_end == num) {
+			return nullptr;
+		}
+		ptr = beg + (num_end - num);
 	}
 
-	// If we got here, we know there is something resembling a  number within the bounds of the buffer
-	// We can now use std::strtod to actually parse the number
-	char *end;
-	*result = std::strtod(state->pos, &end);
-	if (state->pos == end) {
+	return ptr;
+}
+
+static bool match_double(wkt_reader *state, double *result) {
+	const auto ptr = parse_double(state->pos, state->end, result);
+	if (!ptr) {
 		return false;
 	}
-	state->pos = end;
+	state->pos = ptr;
 	parse_ws(state);
 	return true;
 }
 
+// Count the vertices in the coordinate list starting at the current position, ending at the next ')'.
+// This is a cheap pre-pass (memchr and a vectorizable count) that lets us allocate the vertex data once with the exact
+// size instead of growing it while parsing. It is only a hint, a malformed list is reported by the actual parse.
+static uint32_t count_vertices(const wkt_reader *state) {
+	const auto len = static_cast<size_t>(state->end - state->pos);
+	const auto close = static_cast<const char *>(memchr(state->pos, ')', len));
+	if (!close) {
+		return 1;
+	}
+	return 1 + static_cast<uint32_t>(std::count(state->pos, close, ','));
+}
+
 struct vertex_buffer {
 	allocator *alloc;
 	const uint32_t stride;
@@ -1422,7 +1693,8 @@ struct vertex_buffer {
 	uint32_t len;
 	uint32_t cap;
 
-	vertex_buffer(allocator *alloc, uint32_t stride) : alloc(alloc), stride(stride), len(0), cap(1) {
+	vertex_buffer(allocator *alloc, uint32_t stride, uint32_t cap = 1)
+	    : alloc(alloc), stride(stride), len(0), cap(cap) {
 		ptr = static_cast<double *>(this->alloc->alloc(sizeof(double) * stride * cap));
 	}
 
@@ -1548,7 +1820,7 @@ bool wkt_reader_try_parse(wkt_reader *state, geometry *out) {
 			case geometry_type::LINESTRING: {
 				expect_char(state, '(');
 
-				vertex_buffer verts(alloc, vertex_stride);
+				vertex_buffer verts(alloc, vertex_stride, count_vertices(state));
 				do {
 					double vert[4] = {0, 0, 0, 0};
 					for (size_t i = 0; i < vertex_stride; i++) {
@@ -1569,7 +1841,7 @@ bool wkt_reader_try_parse(wkt_reader *state, geometry *out) {
 					if (!match_token(state, "EMPTY")) {
 						expect_char(state, '(');
 
-						vertex_buffer verts(alloc, vertex_stride);
+						vertex_buffer verts(alloc, vertex_stride, count_vertices(state));
 						do {
 							double vert[4] = {0, 0, 0, 0};
 							for (size_t i = 0; i < vertex_stride; i++) {
@@ -1622,7 +1894,7 @@ bool wkt_reader_try_parse(wkt_reader *state, geometry *out) {
 					if (!match_token(state, "EMPTY")) {
 						expect_char(state, '(');
 
-						vertex_buffer verts(alloc, vertex_stride);
+						vertex_buffer verts(alloc, vertex_stride, count_vertices(state));
 						do {
 							double vert[4] = {0, 0, 0, 0};
 							for (size_t i = 0; i < vertex_stride; i++) {
@@ -1652,7 +1924,7 @@ bool wkt_reader_try_parse(wkt_reader *state, geometry *out) {
 							if (!match_token(state, "EMPTY")) {
 								expect_char(state, '(');
 
-								vertex_buffer verts(alloc, vertex_stride);
+								vertex_buffer verts(alloc, vertex_stride, count_vertices(state));
 								do {
 									double vert[4] = {0, 0, 0, 0};
 									for (size_t i = 0; i < vertex_stride; i++) {
@@ -2375,6 +2647,476 @@ double distance(const geometry* lhs_p, const geometry* rhs_p) {
 }
 
 
+//----------------------------------------------------------------------------------------------------------------------
+// Simplification
+//----------------------------------------------------------------------------------------------------------------------
+
+// The distance from a point to the segment [a, b], computed the same way as GEOS so that the same vertices are kept
+static double distance_to_segment(const vertex_xy &p, const vertex_xy &a, const vertex_xy &b) {
+	if (a.x == b.x && a.y == b.y) {
+		return std::sqrt((p.x - a.x) * (p.x - a.x) + (p.y - a.y) * (p.y - a.y));
+	}
+
+	const auto len2 = (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y);
+	const auto r = ((p.x - a.x) * (b.x - a.x) + (p.y - a.y) * (b.y - a.y)) / len2;
+	if (r <= 0.0) {
+		return std::sqrt((p.x - a.x) * (p.x - a.x) + (p.y - a.y) * (p.y - a.y));
+	}
+	if (r >= 1.0) {
+		return std::sqrt((p.x - b.x) * (p.x - b.x) + (p.y - b.y) * (p.y - b.y));
+	}
+
+	const auto s = ((a.y - p.y) * (b.x - a.x) - (a.x - p.x) * (b.y - a.y)) / len2;
+	return std::fabs(s) * std::sqrt(len2);
+}
+
+uint32_t simplify_douglas_peucker(const uint8_t *vertices, uint32_t count, size_t vertex_size, double tolerance,
+                                  uint32_t *stack, uint8_t *out) {
+	if (count < 3) {
+		if (out != vertices) {
+			memmove(out, vertices, count * vertex_size);
+		}
+		return count;
+	}
+
+	const auto get_xy = [&](const uint32_t idx) {
+		vertex_xy v;
+		memcpy(&v, vertices + idx * vertex_size, sizeof(vertex_xy));
+		return v;
+	};
+
+	// The sections are processed in order, left to right, so the kept vertices are emitted in order too. The stack
+	// holds the end vertices of the sections still to process, and the anchor is the start vertex of the current one.
+	// The output can never overtake the anchor, so the vertices after it are still intact if 'out' is 'vertices'.
+	uint32_t kept = 0;
+	uint32_t depth = 0;
+	uint32_t anchor = 0;
+	memmove(out, vertices, vertex_size);
+	kept++;
+	stack[depth++] = count - 1;
+
+	while (depth > 0) {
+		const auto end = stack[depth - 1];
+		const auto a = get_xy(anchor);
+		const auto b = get_xy(end);
+
+		// Find the vertex furthest from the segment replacing the section
+		double max_dist = -1.0;
+		uint32_t max_idx = anchor;
+		for (uint32_t i = anchor + 1; i < end; i++) {
+			const auto dist = distance_to_segment(get_xy(i), a, b);
+			if (dist > max_dist) {
+				max_dist = dist;
+				max_idx = i;
+			}
+		}
+
+		if (max_idx != anchor && max_dist > tolerance) {
+			// Split the section at the furthest vertex, and process the left half first
+			SGL_ASSERT(depth < count);
+			stack[depth++] = max_idx;
+			continue;
+		}
+
+		// Drop all vertices within the section, and continue with the next one
+		memmove(out + kept * vertex_size, vertices + end * vertex_size, vertex_size);
+		kept++;
+		anchor = end;
+		depth--;
+	}
+
+	return kept;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Clip By Box
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+enum class clip_relation : uint8_t { DISJOINT, INSIDE, CROSSING };
+
+struct box_clipper {
+	allocator *alloc;
+	box_xy box;
+	bool has_z;
+	bool has_m;
+	uint32_t stride;
+
+	geometry *new_part(const geometry_type type) const {
+		const auto part = static_cast<geometry *>(alloc->alloc(sizeof(geometry)));
+		new (part) geometry(type, has_z, has_m);
+		return part;
+	}
+
+	bool contains(const double *v) const {
+		return v[0] >= box.min.x && v[0] <= box.max.x && v[1] >= box.min.y && v[1] <= box.max.y;
+	}
+
+	// Compare the extent of the vertices of a part with the box, empty parts are disjoint
+	clip_relation relate(const geometry *part) const {
+		const auto data = part->get_vertex_data();
+		const auto vertex_size = part->get_vertex_size();
+
+		auto ext = box_xy::smallest();
+		for (uint32_t i = 0; i < part->get_count(); i++) {
+			vertex_xy v;
+			memcpy(&v, data + i * vertex_size, sizeof(vertex_xy));
+			ext.min.x = std::min(ext.min.x, v.x);
+			ext.min.y = std::min(ext.min.y, v.y);
+			ext.max.x = std::max(ext.max.x, v.x);
+			ext.max.y = std::max(ext.max.y, v.y);
+		}
+
+		if (!ext.intersects(box)) {
+			return clip_relation::DISJOINT;
+		}
+		if (ext.min.x >= box.min.x && ext.max.x <= box.max.x && ext.min.y >= box.min.y && ext.max.y <= box.max.y) {
+			return clip_relation::INSIDE;
+		}
+		return clip_relation::CROSSING;
+	}
+
+	void interpolate(const double *a, const double *b, const double t, double *out) const {
+		for (uint32_t i = 0; i < stride; i++) {
+			out[i] = a[i] + t * (b[i] - a[i]);
+		}
+	}
+
+	// Clip the segment [a, b] to the box (Liang-Barsky), returns false if it is completely outside. Otherwise, the part
+	// inside the box runs from t0 to t1.
+	bool clip_segment(const double *a, const double *b, double &t0, double &t1) const {
+		const auto dx = b[0] - a[0];
+		const auto dy = b[1] - a[1];
+		const double p[4] = {-dx, dx, -dy, dy};
+		const double q[4] = {a[0] - box.min.x, box.max.x - a[0], a[1] - box.min.y, box.max.y - a[1]};
+
+		t0 = 0;
+		t1 = 1;
+		for (uint32_t i = 0; i < 4; i++) {
+			if (p[i] == 0) {
+				if (q[i] < 0) {
+					return false;
+				}
+				continue;
+			}
+			const auto t = q[i] / p[i];
+			if (p[i] < 0) {
+				if (t > t1) {
+					return false;
+				}
+				t0 = std::max(t0, t);
+			} else {
+				if (t < t0) {
+					return false;
+				}
+				t1 = std::min(t1, t);
+			}
+		}
+		return true;
+	}
+
+	// Keep vertices computed by interpolation from drifting out of the box because of rounding
+	void clamp(double *v) const {
+		v[0] = std::min(std::max(v[0], box.min.x), box.max.x);
+		v[1] = std::min(std::max(v[1], box.min.y), box.max.y);
+	}
+
+	// Clip a point, returns false if it is outside the box
+	bool clip_point(const geometry *point, geometry *result) const {
+		if (point->is_empty()) {
+			return false;
+		}
+		double v[4];
+		memcpy(v, point->get_vertex_data(), point->get_vertex_size());
+		if (!contains(v)) {
+			return false;
+		}
+		result->set_vertex_data(point->get_vertex_data(), 1);
+		return true;
+	}
+
+	// Clip a linestring, appending the pieces inside the box to the result
+	void clip_line(const geometry *line, geometry *result) const {
+		switch (relate(line)) {
+		case clip_relation::DISJOINT:
+			return;
+		case clip_relation::INSIDE: {
+			const auto piece = new_part(geometry_type::LINESTRING);
+			piece->set_vertex_data(line->get_vertex_data(), line->get_count());
+			result->append_part(piece);
+			return;
+		}
+		default:
+			break;
+		}
+
+		const auto data = line->get_vertex_data();
+		const auto count = line->get_count();
+		const auto vertex_size = line->get_vertex_size();
+
+		// The vertices of the current piece
+		vertex_buffer verts(alloc, stride, count);
+
+		const auto flush = [&]() {
+			// A piece that only touches the box is not a line
+			const auto is_point = verts.len == 2 && verts.ptr[0] == verts.ptr[stride] &&
+			                      verts.ptr[1] == verts.ptr[stride + 1];
+			if (verts.len >= 2 && !is_point) {
+				const auto size = sizeof(double) * stride * verts.len;
+				const auto mem = static_cast<char *>(alloc->alloc(size));
+				memcpy(mem, verts.ptr, size);
+
+				const auto piece = new_part(geometry_type::LINESTRING);
+				piece->set_vertex_data(mem, verts.len);
+				result->append_part(piece);
+			}
+			verts.len = 0;
+		};
+
+		double a[4];
+		double b[4];
+		double v[4];
+		memcpy(a, data, vertex_size);
+		for (uint32_t i = 1; i < count; i++) {
+			memcpy(b, data + i * vertex_size, vertex_size);
+
+			double t0;
+			double t1;
+			if (!clip_segment(a, b, t0, t1)) {
+				flush();
+			} else {
+				if (t0 > 0) {
+					// The line enters the box again
+					flush();
+				}
+				if (verts.len == 0) {
+					interpolate(a, b, t0, v);
+					clamp(v);
+					verts.push_back(v);
+				}
+				if (t1 > t0 || (b[0] == a[0] && b[1] == a[1])) {
+					// Unless the segment only touches the box
+					interpolate(a, b, t1, v);
+					clamp(v);
+					verts.push_back(v);
+				}
+				if (t1 < 1) {
+					// The line leaves the box
+					flush();
+				}
+			}
+			memcpy(a, b, vertex_size);
+		}
+		flush();
+	}
+
+	static bool is_inside_edge(const double *v, const uint32_t edge, const box_xy &box) {
+		switch (edge) {
+		case 0:
+			return v[0] >= box.min.x;
+		case 1:
+			return v[0] <= box.max.x;
+		case 2:
+			return v[1] >= box.min.y;
+		default:
+			return v[1] <= box.max.y;
+		}
+	}
+
+	// Append a vertex to the ring, skipping repeated vertices
+	static void push_unique(vertex_buffer &ring, const double *v) {
+		if (ring.len > 0) {
+			const auto last = ring.ptr + (ring.len - 1) * ring.stride;
+			if (last[0] == v[0] && last[1] == v[1]) {
+				return;
+			}
+		}
+		ring.push_back(v);
+	}
+
+	// Clip a ring (Sutherland-Hodgman), returns false if nothing with an area is left of it
+	bool clip_ring(const geometry *ring, geometry *result) const {
+		const auto count = ring->get_count();
+		if (count < 4) {
+			return false;
+		}
+
+		switch (relate(ring)) {
+		case clip_relation::DISJOINT:
+			return false;
+		case clip_relation::INSIDE:
+			result->set_vertex_data(ring->get_vertex_data(), count);
+			return true;
+		default:
+			break;
+		}
+
+		const auto data = ring->get_vertex_data();
+		const auto vertex_size = ring->get_vertex_size();
+
+		// Clip the open ring against each edge of the box in turn, ping-ponging between the two buffers
+		vertex_buffer src(alloc, stride, count + 4);
+		vertex_buffer dst(alloc, stride, count + 4);
+
+		double v[4];
+		for (uint32_t i = 0; i + 1 < count; i++) {
+			memcpy(v, data + i * vertex_size, vertex_size);
+			src.push_back(v);
+		}
+
+		for (uint32_t edge = 0; edge < 4; edge++) {
+			const auto axis = edge < 2 ? 0 : 1;
+			const auto bound = edge == 0 ? box.min.x : edge == 1 ? box.max.x : edge == 2 ? box.min.y : box.max.y;
+
+			dst.len = 0;
+			for (uint32_t i = 0; i < src.len; i++) {
+				const auto prev = src.ptr + (i == 0 ? src.len - 1 : i - 1) * stride;
+				const auto curr = src.ptr + i * stride;
+				const auto prev_inside = is_inside_edge(prev, edge, box);
+				const auto curr_inside = is_inside_edge(curr, edge, box);
+				if (prev_inside != curr_inside) {
+					const auto t = (bound - prev[axis]) / (curr[axis] - prev[axis]);
+					interpolate(prev, curr, t, v);
+					v[axis] = bound;
+					push_unique(dst, v);
+				}
+				if (curr_inside) {
+					push_unique(dst, curr);
+				}
+			}
+
+			// The ring is open, so the last vertex may repeat the first
+			if (dst.len > 1 && dst.ptr[0] == dst.ptr[(dst.len - 1) * stride] &&
+			    dst.ptr[1] == dst.ptr[(dst.len - 1) * stride + 1]) {
+				dst.len--;
+			}
+			if (dst.len < 3) {
+				return false;
+			}
+
+			std::swap(src.ptr, dst.ptr);
+			std::swap(src.len, dst.len);
+			std::swap(src.cap, dst.cap);
+		}
+
+		// Drop rings that collapsed onto the border of the box
+		double area = 0;
+		for (uint32_t i = 0; i < src.len; i++) {
+			const auto a = src.ptr + i * stride;
+			const auto b = src.ptr + (i + 1 == src.len ? 0 : i + 1) * stride;
+			area += a[0] * b[1] - b[0] * a[1];
+		}
+		if (area == 0) {
+			return false;
+		}
+
+		// Close the ring again
+		memcpy(v, src.ptr, sizeof(double) * stride);
+		src.push_back(v);
+		src.assign(result);
+		return true;
+	}
+
+	// Clip a polygon, returns false if nothing is left of its shell
+	bool clip_polygon(const geometry *poly, geometry *result) const {
+		const auto tail = poly->get_last_part();
+		if (!tail) {
+			return false;
+		}
+
+		auto ring = tail;
+		do {
+			ring = ring->get_next();
+			const auto clipped = new_part(geometry_type::LINESTRING);
+			if (!clip_ring(ring, clipped)) {
+				if (ring == poly->get_first_part()) {
+					// The box clips the shell away, so the holes inside of it are gone too
+					return false;
+				}
+				continue;
+			}
+			result->append_part(clipped);
+		} while (ring != tail);
+
+		return true;
+	}
+
+	void clip(const geometry *geom, geometry *result) const {
+		result->set_type(geom->get_type());
+
+		switch (geom->get_type()) {
+		case geometry_type::POINT:
+			clip_point(geom, result);
+			return;
+		case geometry_type::LINESTRING:
+			// Collect the pieces of the line, and unwrap them again if there is at most one
+			result->set_type(geometry_type::MULTI_LINESTRING);
+			clip_line(geom, result);
+			if (result->get_count() <= 1) {
+				const auto piece = result->is_empty() ? nullptr : result->pop_first_part();
+				result->set_type(geometry_type::LINESTRING);
+				if (piece) {
+					result->set_vertex_data(piece->get_vertex_data(), piece->get_count());
+				}
+			}
+			return;
+		case geometry_type::POLYGON:
+			clip_polygon(geom, result);
+			return;
+		default:
+			break;
+		}
+
+		// Multi geometries, empty parts are removed
+		const auto tail = geom->get_last_part();
+		if (!tail) {
+			return;
+		}
+		auto part = tail;
+		do {
+			part = part->get_next();
+			switch (geom->get_type()) {
+			case geometry_type::MULTI_POINT: {
+				const auto point = new_part(geometry_type::POINT);
+				if (clip_point(part, point)) {
+					result->append_part(point);
+				}
+			} break;
+			case geometry_type::MULTI_LINESTRING:
+				clip_line(part, result);
+				break;
+			case geometry_type::MULTI_POLYGON: {
+				const auto poly = new_part(geometry_type::POLYGON);
+				if (clip_polygon(part, poly)) {
+					result->append_part(poly);
+				}
+			} break;
+			case geometry_type::MULTI_GEOMETRY: {
+				const auto clipped = new_part(part->get_type());
+				clip(part, clipped);
+				if (!clipped->is_empty()) {
+					result->append_part(clipped);
+				}
+			} break;
+			default:
+				SGL_ASSERT(false);
+				return;
+			}
+		} while (part != tail);
+	}
+};
+
+} // namespace
+
+void clip_by_box(allocator *alloc, const geometry *geom, const box_xy &box, geometry *result) {
+	const box_clipper clipper = {alloc, box, geom->has_z(), geom->has_m(),
+	                             static_cast<uint32_t>(geom->get_vertex_size() / sizeof(double))};
+	result->set_z(geom->has_z());
+	result->set_m(geom->has_m());
+	clipper.clip(geom, result);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 // Validity
 //----------------------------------------------------------------------------------------------------------------------
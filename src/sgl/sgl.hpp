@@ -212,6 +212,38 @@ struct affine_matrix {
     }
 };
 
+// Closed form projections between WGS84 longitude/latitude (in degrees) and the most common projected coordinate systems,
+// for when a general purpose projection library is too slow. These follow the same conventions as PROJ.
+struct projection {
+	enum class kind : uint8_t {
+		// Spherical mercator on the WGS84 semi-major axis (EPSG:3857)
+		WEB_MERCATOR = 0,
+		// Ellipsoidal transverse mercator on WGS84 (e.g. the UTM zones), using the 6th order Krueger series
+		TRANSVERSE_MERCATOR = 1,
+	};
+
+	kind type = kind::WEB_MERCATOR;
+	// Project back to longitude/latitude instead
+	bool inverse = false;
+	// Whether the longitude/latitude side has (latitude, longitude) axis order
+	bool lat_lon_order = false;
+
+	// Transverse mercator parameters
+	double lon_0 = 0;
+	double false_easting = 0;
+	double false_northing = 0;
+	// The scaled rectifying radius (k_0 * A), and the series coefficients
+	double radius = 0;
+	double alpha[6] = {};
+	double beta[6] = {};
+
+	static projection web_mercator(bool inverse, bool lat_lon_order);
+	static projection utm(int zone, bool south, bool inverse, bool lat_lon_order);
+
+	// Transform 'count' coordinates in place. 'stride' is the distance between two coordinates, in doubles
+	void apply(double *x, double *y, size_t count, size_t stride) const;
+};
+
 enum class geometry_type : uint8_t {
 	INVALID = 0,
 	POINT,
@@ -919,6 +951,9 @@ namespace ops {
 // If the allocator is null, transform in-place. Otherwise allocate new vertex data
 void affine_transform(sgl::allocator *alloc, sgl::geometry *geom, const sgl::affine_matrix *matrix);
 
+// Same as above, but for a projection
+void project(sgl::allocator *alloc, sgl::geometry *geom, const sgl::projection *proj);
+
 double area(const geometry *geom);
 double perimeter(const geometry *geom);
 double length(const geometry *geom);
@@ -993,6 +1028,10 @@ struct wkt_reader {
 bool wkt_reader_try_parse(wkt_reader *state, geometry *out);
 std::string wkt_reader_get_error_message(const wkt_reader *state);
 
+// Parse a decimal number from [beg, end) without reading past 'end'.
+// Returns a pointer past the end of the number, or nullptr if there is no number at 'beg'.
+const char *parse_double(const char *beg, const char *end, double *result);
+
 void extract_points(sgl::geometry *result, sgl::geometry *geom);
 void extract_linestrings(sgl::geometry *result, sgl::geometry *geom);
 void extract_polygons(sgl::geometry *result, sgl::geometry *geom);
@@ -1003,6 +1042,22 @@ bool is_valid(const sgl::geometry *geom);
 
 bool get_centroid(const sgl::geometry *geom, vertex_xyzm *out);
 
+// Simplify a run of vertices with the Douglas-Peucker algorithm, only considering the xy coordinates. The first and
+// last vertex are always kept, and a vertex is only dropped if it is within 'tolerance' of the segment replacing it.
+// The kept vertices are written to 'out', which may be the same buffer as 'vertices' to simplify in-place, and their
+// count is returned. The algorithm is iterative and uses 'stack' as scratch space, which must have room for 'count'
+// entries.
+uint32_t simplify_douglas_peucker(const uint8_t *vertices, uint32_t count, size_t vertex_size, double tolerance,
+                                  uint32_t *stack, uint8_t *out);
+
+// Clip a geometry to the box, only considering the xy coordinates. The other ordinates of the vertices created on the
+// border of the box are interpolated. Points outside the box are removed, linestrings are split into the pieces
+// inside the box, and polygon rings are clipped with Sutherland-Hodgman, which may leave edges running along the
+// border of the box, so that clipped polygons are not necessarily valid. Parts that end up empty are removed, and a
+// linestring split into multiple pieces becomes a multilinestring. The vertex data of parts completely inside the box
+// is shared with the input geometry.
+void clip_by_box(allocator *alloc, const geometry *geom, const box_xy &box, geometry *result);
+
 } // namespace ops
 
 } // namespace sgl
@@ -1081,6 +1136,70 @@ inline void affine_transform(sgl::allocator *alloc, sgl::geometry *geom, const s
 	}
 }
 
+inline void project(sgl::allocator *alloc, sgl::geometry *geom, const sgl::projection *proj) {
+	if (!geom) {
+		return;
+	}
+
+	geometry *part = geom;
+	geometry *root = part->get_parent();
+
+	while (true) {
+		switch (part->get_type()) {
+		case geometry_type::POINT:
+		case geometry_type::LINESTRING: {
+			const auto vertex_width = part->get_vertex_size();
+			const auto vertex_count = part->get_count();
+
+			if(vertex_count == 0) {
+				break;
+			}
+
+			// The vertices are transformed in place, so they have to be copied and aligned first
+			const auto old_vertex_data = part->get_vertex_data();
+			auto new_vertex_data = old_vertex_data;
+			if(alloc) {
+				new_vertex_data = static_cast<uint8_t*>(alloc->alloc(vertex_width * vertex_count));
+				memcpy(new_vertex_data, old_vertex_data, vertex_width * vertex_count);
+			}
+
+			const auto coords = reinterpret_cast<double*>(new_vertex_data);
+			proj->apply(coords, coords + 1, vertex_count, vertex_width / sizeof(double));
+
+			part->set_vertex_data(new_vertex_data, vertex_count);
+		}
+		break;
+		case geometry_type::POLYGON:
+		case geometry_type::MULTI_POINT:
+		case geometry_type::MULTI_LINESTRING:
+		case geometry_type::MULTI_POLYGON:
+		case geometry_type::MULTI_GEOMETRY:
+			if (!part->is_empty()) {
+				part = part->get_first_part();
+				continue;
+			}
+			break;
+		default:
+			SGL_ASSERT(false);
+			return;
+		}
+
+		while (true) {
+			const auto parent = part->get_parent();
+			if (parent == root) {
+				return;
+			}
+
+			if (part != parent->get_last_part()) {
+				part = part->get_next();
+				break;
+			}
+
+			part = parent;
+		}
+	}
+}
+
 
 inline double area(const geometry *geom) {
 	switch (geom->get_type()) {
@@ -1861,6 +1980,68 @@ inline uint32_t hilbert_f32_to_u32(float f) {
 	return res;
 }
 
+inline uint64_t hilbert_interleave_64(uint64_t x) {
+	x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+	x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+	x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	x = (x | (x << 2)) & 0x3333333333333333ULL;
+	x = (x | (x << 1)) & 0x5555555555555555ULL;
+	return x;
+}
+
+// Same as hilbert_encode, but with 32 bits per axis
+inline uint64_t hilbert_encode_64(uint32_t n, uint32_t x_bits, uint32_t y_bits) {
+	uint64_t x = static_cast<uint64_t>(x_bits) << (32 - n);
+	uint64_t y = static_cast<uint64_t>(y_bits) << (32 - n);
+	constexpr uint64_t mask = 0xFFFFFFFF;
+
+	// Initial prefix scan round, prime with x and y
+	uint64_t a = x ^ y;
+	uint64_t b = mask ^ a;
+	uint64_t c = mask ^ (x | y);
+	uint64_t d = x & (y ^ mask);
+	uint64_t A = a | (b >> 1);
+	uint64_t B = (a >> 1) ^ a;
+	uint64_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+	uint64_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+	for (uint32_t shift = 2; shift <= 8; shift <<= 1) {
+		a = A;
+		b = B;
+		c = C;
+		d = D;
+		A = ((a & (a >> shift)) ^ (b & (b >> shift)));
+		B = ((a & (b >> shift)) ^ (b & ((a ^ b) >> shift)));
+		C ^= ((a & (c >> shift)) ^ (b & (d >> shift)));
+		D ^= ((b & (c >> shift)) ^ ((a ^ b) & (d >> shift)));
+	}
+
+	// Final round and projection
+	a = A;
+	b = B;
+	c = C;
+	d = D;
+	C ^= ((a & (c >> 16)) ^ (b & (d >> 16)));
+	D ^= ((b & (c >> 16)) ^ ((a ^ b) & (d >> 16)));
+
+	// Undo transformation prefix scan
+	a = C ^ (C >> 1);
+	b = D ^ (D >> 1);
+
+	// Recover index bits
+	uint64_t i0 = x ^ y;
+	uint64_t i1 = b | (mask ^ (i0 | a));
+
+	return ((hilbert_interleave_64(i1) << 1) | hilbert_interleave_64(i0)) >> (64 - 2 * n);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Morton (Z-order) Curve Encoding
+//----------------------------------------------------------------------------------------------------------------------
+inline uint64_t morton_encode_64(uint32_t x, uint32_t y) {
+	return (hilbert_interleave_64(y) << 1) | hilbert_interleave_64(x);
+}
+
 } // namespace util
 
 } // namespace sgl
@@ -0,0 +1,678 @@
+#include "spatial/geometry/geojson_reader.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/storage/arena_allocator.hpp"
+
+namespace duckdb {
+
+GeoJSONReader::GeoJSONReader(ArenaAllocator &arena) : arena(arena), allocator(arena) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Entry Points
+//----------------------------------------------------------------------------------------------------------------------
+void GeoJSONReader::Reset(const char *data, idx_t size) {
+	beg = data;
+	pos = data;
+	end = data + size;
+	has_z = false;
+}
+
+void GeoJSONReader::Finalize(sgl::geometry &result) {
+	SkipWhitespace();
+	if (pos != end) {
+		SyntaxError("Unexpected content after the end of the object");
+	}
+	if (has_z) {
+		// Ensure the geometry has consistent Z values
+		sgl::ops::force_zm(allocator, &result, true, false, 0, 0);
+	}
+}
+
+void GeoJSONReader::ReadGeometry(const char *data, idx_t size, sgl::geometry &result) {
+	Reset(data, size);
+	ReadGeometryObject(result);
+	Finalize(result);
+}
+
+bool GeoJSONReader::ReadFeature(const char *data, idx_t size, sgl::geometry &result, const char *&properties_data,
+                                idx_t &properties_size) {
+	Reset(data, size);
+	properties_data = nullptr;
+	properties_size = 0;
+
+	SkipWhitespace();
+	const auto object_beg = pos;
+
+	bool has_type = false;
+	bool is_feature = false;
+	bool has_geometry = false;
+	bool has_properties = false;
+	const char *deferred_geometry = nullptr;
+
+	Expect('{');
+	while (!TryConsume('}')) {
+		const auto key = ReadString();
+		Expect(':');
+
+		if (!has_type && Equals(key, "type")) {
+			SkipWhitespace();
+			if (pos == end || *pos != '"') {
+				InvalidInput("GeoJSON input type field is not a string");
+			}
+			has_type = true;
+			is_feature = Equals(ReadString(), "Feature");
+			if (!is_feature) {
+				// Not a feature, but possibly a bare geometry
+				pos = object_beg;
+				ReadGeometryObject(result);
+				Finalize(result);
+				return true;
+			}
+		} else if (!has_geometry && !deferred_geometry && Equals(key, "geometry")) {
+			if (!has_type) {
+				// We dont know yet if this is a feature, come back to it later
+				SkipWhitespace();
+				deferred_geometry = pos;
+				SkipValue();
+			} else {
+				has_geometry = !TryConsumeNull();
+				if (has_geometry) {
+					ReadGeometryObject(result);
+				}
+			}
+		} else if (!has_properties && Equals(key, "properties")) {
+			has_properties = true;
+			if (!TryConsumeNull()) {
+				SkipWhitespace();
+				properties_data = pos;
+				SkipValue();
+				properties_size = static_cast<idx_t>(pos - properties_data);
+			}
+		} else {
+			SkipValue();
+		}
+
+		if (!TryConsume(',')) {
+			Expect('}');
+			break;
+		}
+	}
+
+	if (!has_type) {
+		InvalidInput("GeoJSON input does not have a type field");
+	}
+	if (!is_feature) {
+		// The type was not the first member, read the object again as a geometry
+		pos = object_beg;
+		ReadGeometryObject(result);
+		Finalize(result);
+		return true;
+	}
+	if (deferred_geometry) {
+		const auto object_end = pos;
+		pos = deferred_geometry;
+		has_geometry = !TryConsumeNull();
+		if (has_geometry) {
+			ReadGeometryObject(result);
+		}
+		pos = object_end;
+	}
+
+	if (!has_geometry) {
+		SkipWhitespace();
+		if (pos != end) {
+			SyntaxError("Unexpected content after the end of the object");
+		}
+		return false;
+	}
+
+	Finalize(result);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Errors
+//----------------------------------------------------------------------------------------------------------------------
+void GeoJSONReader::SyntaxError(const char *message) const {
+	const auto offset = static_cast<idx_t>(pos - beg);
+	throw InvalidInputException("Could not parse GeoJSON input: %s at position %llu, (%s)", message, offset,
+	                            string(beg, static_cast<size_t>(end - beg)));
+}
+
+void GeoJSONReader::InvalidInput(const char *message) const {
+	throw InvalidInputException("%s: %s", message, string(beg, static_cast<size_t>(end - beg)));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Tokens
+//----------------------------------------------------------------------------------------------------------------------
+void GeoJSONReader::SkipWhitespace() {
+	while (pos < end) {
+		const auto c = *pos;
+		if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+			pos++;
+			continue;
+		}
+		if (c != '/' || end - pos < 2) {
+			return;
+		}
+		if (pos[1] == '/') {
+			// Line comment
+			pos += 2;
+			while (pos < end && *pos != '\n') {
+				pos++;
+			}
+		} else if (pos[1] == '*') {
+			// Block comment
+			pos += 2;
+			while (pos < end && !(*pos == '*' && end - pos >= 2 && pos[1] == '/')) {
+				pos++;
+			}
+			if (pos == end) {
+				SyntaxError("Unterminated comment");
+			}
+			pos += 2;
+		} else {
+			return;
+		}
+	}
+}
+
+bool GeoJSONReader::TryConsume(char c) {
+	SkipWhitespace();
+	if (pos < end && *pos == c) {
+		pos++;
+		return true;
+	}
+	return false;
+}
+
+void GeoJSONReader::Expect(char c) {
+	if (!TryConsume(c)) {
+		switch (c) {
+		case '{':
+			SyntaxError("Expected '{'");
+		case '}':
+			SyntaxError("Expected '}' or ','");
+		case '[':
+			SyntaxError("Expected '['");
+		case ']':
+			SyntaxError("Expected ']' or ','");
+		case ':':
+			SyntaxError("Expected ':'");
+		default:
+			SyntaxError("Unexpected character");
+		}
+	}
+}
+
+bool GeoJSONReader::TryConsumeNull() {
+	SkipWhitespace();
+	if (end - pos >= 4 && memcmp(pos, "null", 4) == 0) {
+		pos += 4;
+		return true;
+	}
+	return false;
+}
+
+GeoJSONReader::StringRef GeoJSONReader::ReadString() {
+	SkipWhitespace();
+	if (pos == end || *pos != '"') {
+		SyntaxError("Expected string");
+	}
+	pos++;
+
+	StringRef result = {pos, 0, false};
+	while (true) {
+		if (pos == end) {
+			SyntaxError("Unterminated string");
+		}
+		const auto c = *pos;
+		if (c == '"') {
+			break;
+		}
+		if (c == '\\') {
+			result.escaped = true;
+			pos++;
+			if (pos == end) {
+				SyntaxError("Unterminated string");
+			}
+		}
+		pos++;
+	}
+	result.size = static_cast<idx_t>(pos - result.data);
+	pos++;
+	return result;
+}
+
+bool GeoJSONReader::Equals(const StringRef &str, const char *literal) {
+	const auto literal_size = strlen(literal);
+	if (!str.escaped) {
+		return str.size == literal_size && memcmp(str.data, literal, literal_size) == 0;
+	}
+
+	// We only ever compare against ASCII literals, so characters outside of ASCII are decoded as a placeholder
+	// that never matches instead of being converted to UTF-8
+	string_buffer.clear();
+	for (idx_t i = 0; i < str.size; i++) {
+		const auto c = str.data[i];
+		if (c != '\\') {
+			string_buffer.push_back(c);
+			continue;
+		}
+		i++;
+		switch (str.data[i]) {
+		case 'b':
+			string_buffer.push_back('\b');
+			break;
+		case 'f':
+			string_buffer.push_back('\f');
+			break;
+		case 'n':
+			string_buffer.push_back('\n');
+			break;
+		case 'r':
+			string_buffer.push_back('\r');
+			break;
+		case 't':
+			string_buffer.push_back('\t');
+			break;
+		case 'u': {
+			uint32_t code = 0;
+			for (idx_t j = 0; j < 4; j++) {
+				i++;
+				const auto h = i < str.size ? str.data[i] : '\0';
+				if (h >= '0' && h <= '9') {
+					code = code * 16 + static_cast<uint32_t>(h - '0');
+				} else if (h >= 'a' && h <= 'f') {
+					code = code * 16 + static_cast<uint32_t>(h - 'a' + 10);
+				} else if (h >= 'A' && h <= 'F') {
+					code = code * 16 + static_cast<uint32_t>(h - 'A' + 10);
+				} else {
+					SyntaxError("Invalid escape sequence in string");
+				}
+			}
+			string_buffer.push_back(code < 0x80 ? static_cast<char>(code) : '\x80');
+		} break;
+		default:
+			string_buffer.push_back(str.data[i]);
+			break;
+		}
+	}
+	return string_buffer.size() == literal_size && memcmp(string_buffer.data(), literal, literal_size) == 0;
+}
+
+void GeoJSONReader::SkipValue() {
+	SkipWhitespace();
+	if (pos == end) {
+		SyntaxError("Unexpected end of input");
+	}
+
+	switch (*pos) {
+	case '"':
+		ReadString();
+		return;
+	case '{':
+	case '[': {
+		// Skip the whole container without recursing, we only need to keep track of the nesting
+		idx_t depth = 0;
+		do {
+			SkipWhitespace();
+			if (pos == end) {
+				SyntaxError("Unexpected end of input");
+			}
+			const auto c = *pos;
+			if (c == '"') {
+				ReadString();
+				continue;
+			}
+			if (c == '{' || c == '[') {
+				depth++;
+			} else if (c == '}' || c == ']') {
+				depth--;
+			}
+			pos++;
+		} while (depth > 0);
+		return;
+	}
+	case 't':
+		if (end - pos >= 4 && memcmp(pos, "true", 4) == 0) {
+			pos += 4;
+			return;
+		}
+		break;
+	case 'f':
+		if (end - pos >= 5 && memcmp(pos, "false", 5) == 0) {
+			pos += 5;
+			return;
+		}
+		break;
+	case 'n':
+		if (TryConsumeNull()) {
+			return;
+		}
+		break;
+	default: {
+		double value;
+		const auto number_end = sgl::ops::parse_double(pos, end, &value);
+		if (number_end) {
+			pos = number_end;
+			return;
+		}
+	} break;
+	}
+	SyntaxError("Unexpected character");
+}
+
+double GeoJSONReader::ReadNumber() {
+	SkipWhitespace();
+	double value;
+	const auto number_end = sgl::ops::parse_double(pos, end, &value);
+	if (!number_end) {
+		InvalidInput("GeoJSON input coordinates field is not an array of numbers");
+	}
+	pos = number_end;
+	return value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Geometries
+//----------------------------------------------------------------------------------------------------------------------
+bool GeoJSONReader::ReadGeometryType(sgl::geometry_type &type) {
+	SkipWhitespace();
+	if (pos == end || *pos != '"') {
+		InvalidInput("GeoJSON input type field is not a string");
+	}
+	const auto str = ReadString();
+	if (Equals(str, "Point")) {
+		type = sgl::geometry_type::POINT;
+	} else if (Equals(str, "LineString")) {
+		type = sgl::geometry_type::LINESTRING;
+	} else if (Equals(str, "Polygon")) {
+		type = sgl::geometry_type::POLYGON;
+	} else if (Equals(str, "MultiPoint")) {
+		type = sgl::geometry_type::MULTI_POINT;
+	} else if (Equals(str, "MultiLineString")) {
+		type = sgl::geometry_type::MULTI_LINESTRING;
+	} else if (Equals(str, "MultiPolygon")) {
+		type = sgl::geometry_type::MULTI_POLYGON;
+	} else if (Equals(str, "GeometryCollection")) {
+		type = sgl::geometry_type::MULTI_GEOMETRY;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+sgl::geometry *GeoJSONReader::AllocatePart(sgl::geometry_type type) {
+	const auto mem = arena.AllocateAligned(sizeof(sgl::geometry));
+	return new (mem) sgl::geometry(type, false, false);
+}
+
+void GeoJSONReader::ReadGeometryObject(sgl::geometry &geom) {
+	SkipWhitespace();
+	if (pos == end || *pos != '{') {
+		InvalidInput("GeoJSON input is not an object");
+	}
+
+	auto type = sgl::geometry_type::INVALID;
+	bool has_type = false;
+	bool has_member = false;
+
+	// The position of the coordinates or geometries, if they come before the type
+	const char *deferred_coordinates = nullptr;
+	const char *deferred_geometries = nullptr;
+
+	Expect('{');
+	while (!TryConsume('}')) {
+		const auto key = ReadString();
+		Expect(':');
+
+		if (!has_type && Equals(key, "type")) {
+			if (!ReadGeometryType(type)) {
+				InvalidInput("GeoJSON input has invalid type field");
+			}
+			has_type = true;
+			geom.set_type(type);
+		} else if (Equals(key, "coordinates")) {
+			if (has_type && type != sgl::geometry_type::MULTI_GEOMETRY && !has_member) {
+				ReadCoordinates(geom);
+				has_member = true;
+			} else if (!has_type && !deferred_coordinates) {
+				SkipWhitespace();
+				deferred_coordinates = pos;
+				SkipValue();
+			} else {
+				SkipValue();
+			}
+		} else if (Equals(key, "geometries")) {
+			if (has_type && type == sgl::geometry_type::MULTI_GEOMETRY && !has_member) {
+				ReadCoordinates(geom);
+				has_member = true;
+			} else if (!has_type && !deferred_geometries) {
+				SkipWhitespace();
+				deferred_geometries = pos;
+				SkipValue();
+			} else {
+				SkipValue();
+			}
+		} else {
+			SkipValue();
+		}
+
+		if (!TryConsume(',')) {
+			Expect('}');
+			break;
+		}
+	}
+
+	if (!has_type) {
+		InvalidInput("GeoJSON input does not have a type field");
+	}
+	if (has_member) {
+		return;
+	}
+
+	const auto is_collection = type == sgl::geometry_type::MULTI_GEOMETRY;
+	const auto deferred = is_collection ? deferred_geometries : deferred_coordinates;
+	if (!deferred) {
+		InvalidInput(is_collection ? "GeoJSON input does not have a geometries field"
+		                           : "GeoJSON input does not have a coordinates field");
+	}
+
+	// Go back and read the member now that we know the type
+	const auto object_end = pos;
+	pos = deferred;
+	ReadCoordinates(geom);
+	pos = object_end;
+}
+
+void GeoJSONReader::ReadCoordinates(sgl::geometry &geom) {
+	SkipWhitespace();
+	if (pos == end || *pos != '[') {
+		if (geom.get_type() == sgl::geometry_type::MULTI_GEOMETRY) {
+			InvalidInput("GeoJSON input geometries field is not an array");
+		}
+		InvalidInput("GeoJSON input coordinates field is not an array");
+	}
+
+	switch (geom.get_type()) {
+	case sgl::geometry_type::POINT:
+		ReadPoint(geom, true);
+		break;
+	case sgl::geometry_type::LINESTRING:
+		ReadVertices(geom);
+		break;
+	case sgl::geometry_type::POLYGON:
+		ReadPolygon(geom);
+		break;
+	case sgl::geometry_type::MULTI_POINT:
+		Expect('[');
+		while (!TryConsume(']')) {
+			const auto point = AllocatePart(sgl::geometry_type::POINT);
+			ReadPoint(*point, false);
+			geom.append_part(point);
+			if (!TryConsume(',')) {
+				Expect(']');
+				break;
+			}
+		}
+		break;
+	case sgl::geometry_type::MULTI_LINESTRING:
+		Expect('[');
+		while (!TryConsume(']')) {
+			const auto line = AllocatePart(sgl::geometry_type::LINESTRING);
+			ReadVertices(*line);
+			geom.append_part(line);
+			if (!TryConsume(',')) {
+				Expect(']');
+				break;
+			}
+		}
+		break;
+	case sgl::geometry_type::MULTI_POLYGON:
+		Expect('[');
+		while (!TryConsume(']')) {
+			const auto polygon = AllocatePart(sgl::geometry_type::POLYGON);
+			ReadPolygon(*polygon);
+			geom.append_part(polygon);
+			if (!TryConsume(',')) {
+				Expect(']');
+				break;
+			}
+		}
+		break;
+	case sgl::geometry_type::MULTI_GEOMETRY:
+		Expect('[');
+		while (!TryConsume(']')) {
+			const auto part = AllocatePart(sgl::geometry_type::INVALID);
+			ReadGeometryObject(*part);
+			geom.append_part(part);
+			if (!TryConsume(',')) {
+				Expect(']');
+				break;
+			}
+		}
+		break;
+	default:
+		D_ASSERT(false);
+		break;
+	}
+}
+
+// Read a position into 'vertex', returns the number of ordinates read (0, 2 or 3). Ordinates after the third are
+// skipped, GeoJSON does not support M values.
+idx_t GeoJSONReader::ReadPosition(double *vertex) {
+	SkipWhitespace();
+	if (pos == end || *pos != '[') {
+		InvalidInput("GeoJSON input coordinates field is not an array of arrays");
+	}
+	Expect('[');
+
+	idx_t count = 0;
+	while (!TryConsume(']')) {
+		if (count < 3) {
+			vertex[count] = ReadNumber();
+		} else {
+			SkipValue();
+		}
+		count++;
+		if (!TryConsume(',')) {
+			Expect(']');
+			break;
+		}
+	}
+
+	if (count == 1) {
+		InvalidInput("GeoJSON input coordinates field is not an array of at least length 2");
+	}
+	return MinValue<idx_t>(count, 3);
+}
+
+void GeoJSONReader::ReadPoint(sgl::geometry &geom, bool allow_empty) {
+	double vertex[3];
+	const auto count = ReadPosition(vertex);
+	if (count == 0) {
+		if (!allow_empty) {
+			InvalidInput("GeoJSON input coordinates field is not an array of arrays of length >= 2");
+		}
+		return;
+	}
+
+	const auto mem = arena.AllocateAligned(sizeof(double) * count);
+	memcpy(mem, vertex, sizeof(double) * count);
+	geom.set_z(count == 3);
+	geom.set_vertex_data(mem, 1);
+	has_z |= count == 3;
+}
+
+void GeoJSONReader::ReadVertices(sgl::geometry &geom) {
+	SkipWhitespace();
+	if (pos == end || *pos != '[') {
+		InvalidInput("GeoJSON input coordinates field is not an array of arrays");
+	}
+	Expect('[');
+
+	// Collect the vertices with a Z value first, we dont know if any vertex has one until we have seen all of them
+	vertex_buffer.clear();
+	bool has_any_z = false;
+	while (!TryConsume(']')) {
+		const auto offset = vertex_buffer.size();
+		vertex_buffer.resize(offset + 3);
+		const auto vertex = vertex_buffer.data() + offset;
+		const auto count = ReadPosition(vertex);
+		if (count == 0) {
+			InvalidInput("GeoJSON input coordinates field is not an array of arrays of length >= 2");
+		}
+		if (count == 2) {
+			vertex[2] = 0;
+		} else {
+			has_any_z = true;
+		}
+		if (!TryConsume(',')) {
+			Expect(']');
+			break;
+		}
+	}
+
+	const auto vertex_count = vertex_buffer.size() / 3;
+	if (vertex_count == 0) {
+		return;
+	}
+
+	const auto width = has_any_z ? 3 : 2;
+	const auto mem = arena.AllocateAligned(sizeof(double) * width * vertex_count);
+	if (has_any_z) {
+		memcpy(mem, vertex_buffer.data(), sizeof(double) * 3 * vertex_count);
+	} else {
+		const auto ptr = reinterpret_cast<double *>(mem);
+		for (idx_t i = 0; i < vertex_count; i++) {
+			ptr[i * 2] = vertex_buffer[i * 3];
+			ptr[i * 2 + 1] = vertex_buffer[i * 3 + 1];
+		}
+	}
+
+	geom.set_z(has_any_z);
+	geom.set_vertex_data(mem, static_cast<uint32_t>(vertex_count));
+	has_z |= has_any_z;
+}
+
+void GeoJSONReader::ReadPolygon(sgl::geometry &geom) {
+	SkipWhitespace();
+	if (pos == end || *pos != '[') {
+		InvalidInput("GeoJSON input coordinates field is not an array of arrays");
+	}
+	Expect('[');
+	while (!TryConsume(']')) {
+		const auto ring = AllocatePart(sgl::geometry_type::LINESTRING);
+		ReadVertices(*ring);
+		geom.append_part(ring);
+		if (!TryConsume(',')) {
+			Expect(']');
+			break;
+		}
+	}
+}
+
+} // namespace duckdb
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "spatial/geometry/sgl.hpp"
+#include "duckdb/common/vector.hpp"
+
+namespace duckdb {
+
+class ArenaAllocator;
+
+// Reads GeoJSON text straight into a sgl::geometry, without parsing it into a JSON document first.
+// The text is walked once, members that are not needed are skipped without being materialized, and the coordinates
+// are parsed directly into vertex data allocated from the arena. Comments and trailing commas are accepted.
+class GeoJSONReader {
+public:
+	explicit GeoJSONReader(ArenaAllocator &arena);
+
+	// Read a GeoJSON geometry object. Throws an InvalidInputException if the input is not a valid geometry.
+	void ReadGeometry(const char *data, idx_t size, sgl::geometry &result);
+
+	// Read a GeoJSON feature object, or a bare geometry object. Returns false if the feature has a null geometry.
+	// The properties are returned as the raw JSON text of the "properties" member, they are empty if the feature has
+	// no (or null) properties.
+	bool ReadFeature(const char *data, idx_t size, sgl::geometry &result, const char *&properties_data,
+	                 idx_t &properties_size);
+
+private:
+	struct StringRef {
+		const char *data;
+		idx_t size;
+		bool escaped;
+	};
+
+	void Reset(const char *data, idx_t size);
+	void Finalize(sgl::geometry &result);
+
+	[[noreturn]] void SyntaxError(const char *message) const;
+	[[noreturn]] void InvalidInput(const char *message) const;
+
+	void SkipWhitespace();
+	bool TryConsume(char c);
+	void Expect(char c);
+	bool TryConsumeNull();
+
+	StringRef ReadString();
+	bool Equals(const StringRef &str, const char *literal);
+	void SkipValue();
+	double ReadNumber();
+
+	bool ReadGeometryType(sgl::geometry_type &type);
+	void ReadGeometryObject(sgl::geometry &geom);
+	void ReadCoordinates(sgl::geometry &geom);
+	idx_t ReadPosition(double *vertex);
+	void ReadPoint(sgl::geometry &geom, bool allow_empty);
+	void ReadVertices(sgl::geometry &geom);
+	void ReadPolygon(sgl::geometry &geom);
+	sgl::geometry *AllocatePart(sgl::geometry_type type);
+
+	ArenaAllocator &arena;
+	GeometryAllocator allocator;
+
+	const char *beg = nullptr;
+	const char *pos = nullptr;
+	const char *end = nullptr;
+
+	// Whether any vertex of the geometry being read has a Z value
+	bool has_z = false;
+
+	// Scratch space for the vertices of the linestring being read, always with a Z value
+	vector<double> vertex_buffer;
+	// Scratch space for decoding escaped strings
+	string string_buffer;
+};
+
+} // namespace duckdb
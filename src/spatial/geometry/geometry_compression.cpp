@@ -0,0 +1,382 @@
+#include "spatial/geometry/geometry_compression.hpp"
+#include "spatial/util/binary_reader.hpp"
+#include "spatial/util/binary_writer.hpp"
+#include "spatial/geometry/geometry_properties.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/helper.hpp"
+#include "duckdb/common/limits.hpp"
+
+#include <cmath>
+
+namespace duckdb {
+
+//----------------------------------------------------------------------------------------------------------------------
+// Layout
+//----------------------------------------------------------------------------------------------------------------------
+// A compressed geometry starts with a format byte:
+// - RAW: followed by the serialized geometry as it is
+// - ENCODED: followed by the size of the serialized geometry (u32), the offset of its vertex stream (u32), the bytes in
+//   front of the vertex stream as they are, and then for each ordinate the mode byte, the exponent byte (for the
+//   DECIMAL modes), the origin (i64, for DECIMAL32) and the encoded values of all vertices.
+
+namespace {
+
+enum class CompressedFormat : uint8_t { RAW = 0, ENCODED = 1 };
+
+enum class OrdinateMode : uint8_t { XOR = 0, DECIMAL = 1, DECIMAL32 = 2 };
+
+// The largest power of ten that is tried, and exactly representable as a double
+constexpr uint8_t MAX_EXPONENT = GeometryCompression::MAX_DECIMALS;
+// The integers of the DECIMAL mode are kept below 2^53, so they are exactly representable as doubles
+constexpr double MAX_DECIMAL = 9007199254740992.0;
+
+constexpr double POWERS_OF_TEN[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+double LoadOrdinate(const char *vertices, idx_t vertex_idx, idx_t vertex_size, idx_t ordinate) {
+	double value;
+	memcpy(&value, vertices + vertex_idx * vertex_size + ordinate * sizeof(double), sizeof(double));
+	return value;
+}
+
+uint64_t ToBits(double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(double));
+	return bits;
+}
+
+//! Find the smallest exponent e such that every value is exactly its integer multiple of 10^-e
+bool TryGetExponent(const char *vertices, idx_t count, idx_t vertex_size, idx_t ordinate, uint8_t &result) {
+	for (uint8_t exponent = 0; exponent <= MAX_EXPONENT; exponent++) {
+		const auto scale = POWERS_OF_TEN[exponent];
+		auto exact = true;
+		for (idx_t i = 0; i < count && exact; i++) {
+			const auto value = LoadOrdinate(vertices, i, vertex_size, ordinate);
+			const auto scaled = std::round(value * scale);
+			if (!(std::fabs(scaled) < MAX_DECIMAL)) {
+				exact = false;
+				break;
+			}
+			// Decode the way DecodeDecimal does and compare the bits, so that -0.0 is not considered exact
+			const auto decoded = static_cast<double>(static_cast<int64_t>(scaled)) / scale;
+			exact = ToBits(decoded) == ToBits(value);
+		}
+		if (exact) {
+			result = exponent;
+			return true;
+		}
+	}
+	return false;
+}
+
+void WriteVarint(BinaryWriter &writer, uint64_t value) {
+	while (value >= 0x80) {
+		writer.Write<uint8_t>(static_cast<uint8_t>(value) | 0x80);
+		value >>= 7;
+	}
+	writer.Write<uint8_t>(static_cast<uint8_t>(value));
+}
+
+uint64_t ReadVarint(BinaryReader &reader) {
+	uint64_t result = 0;
+	for (uint32_t shift = 0; shift < 64; shift += 7) {
+		const auto byte = reader.Read<uint8_t>();
+		result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return result;
+		}
+	}
+	throw InvalidInputException("Invalid compressed geometry: varint is too long");
+}
+
+int64_t LoadDecimal(const char *vertices, idx_t vertex_idx, idx_t vertex_size, idx_t ordinate, double scale) {
+	return static_cast<int64_t>(std::round(LoadOrdinate(vertices, vertex_idx, vertex_size, ordinate) * scale));
+}
+
+uint64_t ToZigzag(int64_t value) {
+	return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+idx_t GetVarintSize(uint64_t value) {
+	idx_t size = 1;
+	while (value >= 0x80) {
+		value >>= 7;
+		size++;
+	}
+	return size;
+}
+
+//! Returns true if the values are better stored as fixed width offsets from their minimum than as varint deltas
+bool UseFixedWidth(const char *vertices, idx_t count, idx_t vertex_size, idx_t ordinate, uint8_t exponent,
+                   int64_t &origin) {
+	const auto scale = POWERS_OF_TEN[exponent];
+	origin = NumericLimits<int64_t>::Maximum();
+	auto max = NumericLimits<int64_t>::Minimum();
+	idx_t varint_size = 0;
+	int64_t prev = 0;
+	for (idx_t i = 0; i < count; i++) {
+		const auto value = LoadDecimal(vertices, i, vertex_size, ordinate, scale);
+		origin = std::min(origin, value);
+		max = std::max(max, value);
+		varint_size += GetVarintSize(ToZigzag(value - prev));
+		prev = value;
+	}
+	const auto fixed_size = sizeof(int64_t) + count * sizeof(uint32_t);
+	return max - origin <= NumericLimits<uint32_t>::Maximum() && fixed_size < varint_size;
+}
+
+void EncodeDecimal(BinaryWriter &writer, const char *vertices, idx_t count, idx_t vertex_size, idx_t ordinate,
+                   uint8_t exponent) {
+	const auto scale = POWERS_OF_TEN[exponent];
+	int64_t prev = 0;
+	for (idx_t i = 0; i < count; i++) {
+		const auto value = LoadDecimal(vertices, i, vertex_size, ordinate, scale);
+		// Zigzag, so that small negative deltas are small too
+		WriteVarint(writer, ToZigzag(value - prev));
+		prev = value;
+	}
+}
+
+void EncodeDecimal32(BinaryWriter &writer, const char *vertices, idx_t count, idx_t vertex_size, idx_t ordinate,
+                     uint8_t exponent, int64_t origin) {
+	const auto scale = POWERS_OF_TEN[exponent];
+	writer.Write<int64_t>(origin);
+	for (idx_t i = 0; i < count; i++) {
+		const auto value = LoadDecimal(vertices, i, vertex_size, ordinate, scale);
+		writer.Write<uint32_t>(static_cast<uint32_t>(value - origin));
+	}
+}
+
+void DecodeDecimal(BinaryReader &reader, char *vertices, idx_t count, idx_t vertex_size, idx_t ordinate,
+                   uint8_t exponent) {
+	const auto scale = POWERS_OF_TEN[exponent];
+	int64_t prev = 0;
+	for (idx_t i = 0; i < count; i++) {
+		const auto zigzag = ReadVarint(reader);
+		const auto delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+		prev = static_cast<int64_t>(static_cast<uint64_t>(prev) + static_cast<uint64_t>(delta));
+		const auto value = static_cast<double>(prev) / scale;
+		memcpy(vertices + i * vertex_size + ordinate * sizeof(double), &value, sizeof(double));
+	}
+}
+
+void DecodeDecimal32(BinaryReader &reader, char *vertices, idx_t count, idx_t vertex_size, idx_t ordinate,
+                     uint8_t exponent) {
+	const auto scale = POWERS_OF_TEN[exponent];
+	const auto origin = reader.Read<int64_t>();
+	if (origin < -static_cast<int64_t>(MAX_DECIMAL) || origin > static_cast<int64_t>(MAX_DECIMAL)) {
+		throw InvalidInputException("Invalid compressed geometry: origin out of range");
+	}
+	const auto offsets = reader.Reserve(count * sizeof(uint32_t));
+	for (idx_t i = 0; i < count; i++) {
+		const auto offset = Load<uint32_t>(const_data_ptr_cast(offsets + i * sizeof(uint32_t)));
+		const auto value = static_cast<double>(origin + static_cast<int64_t>(offset)) / scale;
+		memcpy(vertices + i * vertex_size + ordinate * sizeof(double), &value, sizeof(double));
+	}
+}
+
+void EncodeXor(BinaryWriter &writer, const char *vertices, idx_t count, idx_t vertex_size, idx_t ordinate) {
+	uint64_t prev = 0;
+	for (idx_t i = 0; i < count; i++) {
+		const auto bits = ToBits(LoadOrdinate(vertices, i, vertex_size, ordinate));
+		auto diff = bits ^ prev;
+		prev = bits;
+
+		// The control byte holds the number of stored bytes, and the number of zero bytes below them
+		uint8_t trailing = 0;
+		uint8_t length = 0;
+		if (diff != 0) {
+			while ((diff & 0xFF) == 0) {
+				diff >>= 8;
+				trailing++;
+			}
+			for (auto rest = diff; rest != 0; rest >>= 8) {
+				length++;
+			}
+		}
+		writer.Write<uint8_t>(static_cast<uint8_t>(length << 4 | trailing));
+		for (uint8_t b = 0; b < length; b++) {
+			writer.Write<uint8_t>(static_cast<uint8_t>(diff >> (b * 8)));
+		}
+	}
+}
+
+void DecodeXor(BinaryReader &reader, char *vertices, idx_t count, idx_t vertex_size, idx_t ordinate) {
+	uint64_t prev = 0;
+	for (idx_t i = 0; i < count; i++) {
+		const auto control = reader.Read<uint8_t>();
+		const auto length = control >> 4;
+		const auto trailing = control & 0x0F;
+		if (length + trailing > 8) {
+			throw InvalidInputException("Invalid compressed geometry: corrupt ordinate stream");
+		}
+		uint64_t diff = 0;
+		for (uint8_t b = 0; b < length; b++) {
+			diff |= static_cast<uint64_t>(reader.Read<uint8_t>()) << (b * 8);
+		}
+		prev ^= diff << (trailing * 8);
+		memcpy(vertices + i * vertex_size + ordinate * sizeof(double), &prev, sizeof(double));
+	}
+}
+
+void CompressRaw(const char *blob, size_t blob_size, vector<char> &result) {
+	result.resize(1 + blob_size);
+	result[0] = static_cast<char>(CompressedFormat::RAW);
+	memcpy(result.data() + 1, blob, blob_size);
+}
+
+} // namespace
+
+void GeometryCompression::Compress(const char *blob, size_t blob_size, vector<char> &result) {
+	size_t vertex_offset;
+	size_t vertex_count;
+	if (blob_size > NumericLimits<uint32_t>::Maximum() ||
+	    !Serde::TryGetVertexStream(blob, blob_size, vertex_offset, vertex_count) || vertex_count == 0) {
+		CompressRaw(blob, blob_size, result);
+		return;
+	}
+
+	const auto props = Load<GeometryProperties>(const_data_ptr_cast(blob + 1));
+	const auto vertex_size = props.VertexSize();
+	const auto ordinate_count = vertex_size / sizeof(double);
+	const auto vertices = blob + vertex_offset;
+
+	// Worst case, every value takes a control byte and all 8 bytes (or 8 varint bytes for the 54 bit deltas)
+	const auto max_size = 1 + 4 + 4 + vertex_offset + ordinate_count * (2 + vertex_count * 9);
+	result.resize(max_size);
+
+	BinaryWriter writer(result.data(), max_size);
+	writer.Write<uint8_t>(static_cast<uint8_t>(CompressedFormat::ENCODED));
+	writer.Write<uint32_t>(static_cast<uint32_t>(blob_size));
+	writer.Write<uint32_t>(static_cast<uint32_t>(vertex_offset));
+	writer.Copy(blob, vertex_offset);
+
+	for (idx_t ordinate = 0; ordinate < ordinate_count; ordinate++) {
+		uint8_t exponent;
+		int64_t origin;
+		if (!TryGetExponent(vertices, vertex_count, vertex_size, ordinate, exponent)) {
+			writer.Write<uint8_t>(static_cast<uint8_t>(OrdinateMode::XOR));
+			writer.Write<uint8_t>(0);
+			EncodeXor(writer, vertices, vertex_count, vertex_size, ordinate);
+		} else if (UseFixedWidth(vertices, vertex_count, vertex_size, ordinate, exponent, origin)) {
+			writer.Write<uint8_t>(static_cast<uint8_t>(OrdinateMode::DECIMAL32));
+			writer.Write<uint8_t>(exponent);
+			EncodeDecimal32(writer, vertices, vertex_count, vertex_size, ordinate, exponent, origin);
+		} else {
+			writer.Write<uint8_t>(static_cast<uint8_t>(OrdinateMode::DECIMAL));
+			writer.Write<uint8_t>(exponent);
+			EncodeDecimal(writer, vertices, vertex_count, vertex_size, ordinate, exponent);
+		}
+	}
+
+	const auto encoded_size = static_cast<size_t>(writer.GetPtr() - writer.GetStart());
+	if (encoded_size >= 1 + blob_size) {
+		// Not worth it, e.g. for random coordinates
+		CompressRaw(blob, blob_size, result);
+		return;
+	}
+	result.resize(encoded_size);
+}
+
+void GeometryCompression::Quantize(char *blob, size_t blob_size, int32_t decimals) {
+	D_ASSERT(decimals >= 0 && decimals <= MAX_DECIMALS);
+	size_t vertex_offset;
+	size_t vertex_count;
+	if (!Serde::TryGetVertexStream(blob, blob_size, vertex_offset, vertex_count)) {
+		throw InternalException("Cannot quantize a geometry without a vertex stream");
+	}
+
+	const auto props = Load<GeometryProperties>(const_data_ptr_cast(blob + 1));
+	const auto ordinate_total = vertex_count * props.VertexSize() / sizeof(double);
+	const auto scale = POWERS_OF_TEN[decimals];
+	const auto ordinates = blob + vertex_offset;
+
+	for (idx_t i = 0; i < ordinate_total; i++) {
+		double value;
+		memcpy(&value, ordinates + i * sizeof(double), sizeof(double));
+		const auto scaled = std::round(value * scale);
+		// Values that can't be represented (NaN, infinities and huge values) are kept as they are
+		if (std::fabs(scaled) < MAX_DECIMAL) {
+			// The same expression as DecodeDecimal, so that the DECIMAL mode is picked for the result
+			value = static_cast<double>(static_cast<int64_t>(scaled)) / scale;
+			memcpy(ordinates + i * sizeof(double), &value, sizeof(double));
+		}
+	}
+
+	Serde::UpdateBounds(blob, blob_size);
+}
+
+size_t GeometryCompression::GetDecompressedSize(const char *buffer, size_t buffer_size) {
+	BinaryReader reader(buffer, buffer_size);
+	const auto format = static_cast<CompressedFormat>(reader.Read<uint8_t>());
+	switch (format) {
+	case CompressedFormat::RAW:
+		return buffer_size - 1;
+	case CompressedFormat::ENCODED:
+		return reader.Read<uint32_t>();
+	default:
+		throw NotImplementedException(
+		    "This compressed geometry seems to be written with a newer version of the DuckDB spatial library that is "
+		    "not compatible with this version. Please upgrade your DuckDB installation.");
+	}
+}
+
+void GeometryCompression::Decompress(const char *buffer, size_t buffer_size, char *result, size_t result_size) {
+	BinaryReader reader(buffer, buffer_size);
+	const auto format = static_cast<CompressedFormat>(reader.Read<uint8_t>());
+	if (format == CompressedFormat::RAW) {
+		D_ASSERT(result_size == buffer_size - 1);
+		memcpy(result, buffer + 1, buffer_size - 1);
+		return;
+	}
+	if (format != CompressedFormat::ENCODED) {
+		throw NotImplementedException("Unknown compressed geometry format %d", static_cast<int>(format));
+	}
+
+	const auto blob_size = reader.Read<uint32_t>();
+	const auto vertex_offset = reader.Read<uint32_t>();
+	D_ASSERT(result_size == blob_size);
+
+	// The header and the part words are stored as they are
+	if (vertex_offset < 8 || vertex_offset > blob_size) {
+		throw InvalidInputException("Invalid compressed geometry: vertex stream out of bounds");
+	}
+	memcpy(result, reader.Reserve(vertex_offset), vertex_offset);
+
+	const auto props = Load<GeometryProperties>(const_data_ptr_cast(result + 1));
+	const auto vertex_size = props.VertexSize();
+	const auto ordinate_count = vertex_size / sizeof(double);
+	if ((blob_size - vertex_offset) % vertex_size != 0) {
+		throw InvalidInputException("Invalid compressed geometry: vertex stream size mismatch");
+	}
+	const auto vertex_count = (blob_size - vertex_offset) / vertex_size;
+	const auto vertices = result + vertex_offset;
+
+	for (idx_t ordinate = 0; ordinate < ordinate_count; ordinate++) {
+		const auto mode = static_cast<OrdinateMode>(reader.Read<uint8_t>());
+		const auto exponent = reader.Read<uint8_t>();
+		switch (mode) {
+		case OrdinateMode::DECIMAL:
+			if (exponent > MAX_EXPONENT) {
+				throw InvalidInputException("Invalid compressed geometry: exponent out of range");
+			}
+			DecodeDecimal(reader, vertices, vertex_count, vertex_size, ordinate, exponent);
+			break;
+		case OrdinateMode::DECIMAL32:
+			if (exponent > MAX_EXPONENT) {
+				throw InvalidInputException("Invalid compressed geometry: exponent out of range");
+			}
+			DecodeDecimal32(reader, vertices, vertex_count, vertex_size, ordinate, exponent);
+			break;
+		case OrdinateMode::XOR:
+			DecodeXor(reader, vertices, vertex_count, vertex_size, ordinate);
+			break;
+		default:
+			throw InvalidInputException("Invalid compressed geometry: unknown ordinate mode");
+		}
+	}
+}
+
+} // namespace duckdb
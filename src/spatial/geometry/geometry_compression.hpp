@@ -0,0 +1,33 @@
+#pragma once
+
+#include "duckdb/common/typedefs.hpp"
+#include "duckdb/common/vector.hpp"
+
+namespace duckdb {
+
+//! A lossless compact encoding of serialized geometries, used to store the COMPRESSED_GEOMETRY type.
+//! The header, bounding box and part words are kept as they are, so the cached bounds survive compression, and only the
+//! vertex stream is encoded. Each ordinate (x, y, z, m) is encoded as its own stream over all vertices of the
+//! geometry, so that neighbouring vertices compress against each other:
+//! - DECIMAL: if all values of the stream are exactly some integer divided by 10^e (e.g. coordinates with a fixed
+//!   number of decimal digits), the integers are stored as zigzag varint deltas to the previous vertex.
+//! - DECIMAL32: like DECIMAL, but stored as fixed width 32-bit offsets from the smallest value, if that is shorter.
+//! - XOR: otherwise the bits of each value are xor:ed with the previous value, and only the non-zero bytes are stored.
+//! Geometries that don't get smaller, or that use the version 0 layout, are stored as they are.
+struct GeometryCompression {
+	//! The largest number of decimal digits of the DECIMAL modes
+	static constexpr int32_t MAX_DECIMALS = 15;
+
+	//! Compress a serialized geometry into the given buffer
+	static void Compress(const char *blob, size_t blob_size, vector<char> &result);
+	//! Round all ordinates of a serialized geometry with a vertex stream to the given number of decimal digits in place,
+	//! and update its bounds. The result compresses with one of the DECIMAL modes.
+	static void Quantize(char *blob, size_t blob_size, int32_t decimals);
+	//! The size of a compressed geometry once decompressed
+	static size_t GetDecompressedSize(const char *buffer, size_t buffer_size);
+	//! Decompress a compressed geometry into a buffer of GetDecompressedSize() bytes, byte-for-byte the same as the
+	//! serialized geometry that was compressed
+	static void Decompress(const char *buffer, size_t buffer_size, char *result, size_t result_size);
+};
+
+} // namespace duckdb
@@ -0,0 +1,272 @@
+#pragma once
+
+#include "spatial/util/binary_reader.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/geometry/geometry_properties.hpp"
+
+#include "duckdb/common/types/string_type.hpp"
+
+namespace duckdb {
+
+//! The vertices of a single point, linestring or polygon ring of a serialized geometry, pointing into the blob. The
+//! vertices are not necessarily aligned, so they have to be loaded through memcpy.
+struct VertexSpan {
+	const char *data = nullptr;
+	uint32_t count = 0;
+	uint32_t vertex_size = 0;
+
+	//! Load an ordinate of a vertex, where ordinate 0 is x, 1 is y, and 2 and 3 are z and/or m
+	double Get(const uint32_t vertex_idx, const uint32_t ordinate) const {
+		double value;
+		memcpy(&value, data + vertex_idx * vertex_size + ordinate * sizeof(double), sizeof(double));
+		return value;
+	}
+
+	sgl::vertex_xy GetXY(const uint32_t vertex_idx) const {
+		sgl::vertex_xy vertex;
+		memcpy(&vertex, data + vertex_idx * vertex_size, sizeof(sgl::vertex_xy));
+		return vertex;
+	}
+
+	//! The length of the vertices as a line, same as sgl::linestring::length
+	double Length() const {
+		double length = 0.0;
+		if (count < 2) {
+			return length;
+		}
+		auto prev = GetXY(0);
+		for (uint32_t i = 1; i < count; i++) {
+			const auto next = GetXY(i);
+			length += std::hypot(next.x - prev.x, next.y - prev.y);
+			prev = next;
+		}
+		return length;
+	}
+
+	//! The signed area of the vertices as a closed ring, same as sgl::linestring::signed_area
+	double SignedArea() const {
+		if (count < 3) {
+			return 0.0;
+		}
+		double area = 0.0;
+		const auto x0 = Get(0, 0);
+		for (uint32_t i = 1; i < count - 1; i++) {
+			area += (Get(i, 0) - x0) * (Get(i - 1, 1) - Get(i + 1, 1));
+		}
+		return area * 0.5;
+	}
+};
+
+//! A (sub)geometry of a serialized geometry, as produced by GeometryCursor
+struct GeometryPart {
+	//! The type of the part. The rings of polygons are produced as parts of type LINESTRING, with is_ring set
+	sgl::geometry_type type = sgl::geometry_type::INVALID;
+	bool is_ring = false;
+	//! The nesting level of the part, 0 for the root
+	uint32_t depth = 0;
+	//! The index of the part within its parent, for rings 0 is the shell
+	uint32_t index = 0;
+	//! The number of rings of a polygon, or the number of parts of a collection
+	uint32_t part_count = 0;
+	//! The vertices of points, linestrings and rings, empty for polygons and collections
+	VertexSpan vertices;
+};
+
+//! Walks the parts of a serialized geometry in preorder, straight from the blob. Unlike Serde::Deserialize this does
+//! not build a sgl::geometry and never allocates, and unlike GeometryProcessor it keeps an explicit stack instead of
+//! recursing. Both versions of the format are supported.
+class GeometryCursor {
+public:
+	//! The max nesting depth of collections, which is well above what the WKB reader accepts
+	static constexpr uint32_t MAX_DEPTH = 256;
+
+	explicit GeometryCursor(const string_t &blob) : GeometryCursor(blob.GetData(), blob.GetSize()) {
+	}
+
+	GeometryCursor(const char *buffer, const size_t buffer_size)
+	    : words(buffer, buffer_size), vertices(buffer, buffer_size) {
+		root_type = static_cast<sgl::geometry_type>(words.Read<uint8_t>() + 1);
+		props = words.Read<GeometryProperties>();
+		words.Skip(sizeof(uint16_t));
+		words.Skip(sizeof(uint32_t)); // padding
+
+		// Throws if the geometry was written with a newer version
+		props.CheckVersion();
+		words.Skip(props.BBoxSize());
+		vertex_size = props.VertexSize();
+
+		if (props.GetVersion() == 0) {
+			// Skip the type of the root, the vertices are interleaved with the part headers
+			words.Read<uint32_t>();
+			return;
+		}
+
+		// The part words are followed by the vertex stream
+		const auto word_count = words.Read<uint32_t>();
+		const auto words_end = static_cast<size_t>(words.GetPtr() - buffer) + word_count * sizeof(uint32_t);
+		vertices.Skip(GetGeometryVertexOffset(words_end));
+	}
+
+	sgl::geometry_type GetType() const {
+		return root_type;
+	}
+	bool HasZ() const {
+		return props.HasZ();
+	}
+	bool HasM() const {
+		return props.HasM();
+	}
+	uint32_t GetVertexSize() const {
+		return vertex_size;
+	}
+
+	//! Move to the next part, returns false once all parts have been visited
+	bool Next(GeometryPart &part) {
+		if (!started) {
+			started = true;
+			return ReadPart(root_type, 0, part);
+		}
+
+		while (depth > 0) {
+			auto &frame = stack[depth - 1];
+			if (frame.next == frame.count) {
+				depth--;
+				continue;
+			}
+
+			const auto index = frame.next++;
+			if (frame.type != sgl::geometry_type::POLYGON) {
+				const auto type = static_cast<sgl::geometry_type>(words.Read<uint32_t>() + 1);
+				return ReadPart(type, index, part);
+			}
+
+			uint32_t ring_count;
+			if (frame.ring_counts) {
+				memcpy(&ring_count, frame.ring_counts + index * sizeof(uint32_t), sizeof(uint32_t));
+			} else {
+				ring_count = words.Read<uint32_t>();
+			}
+			part.type = sgl::geometry_type::LINESTRING;
+			part.is_ring = true;
+			part.depth = depth;
+			part.index = index;
+			part.part_count = 0;
+			part.vertices = ReadVertices(ring_count);
+			return true;
+		}
+		return false;
+	}
+
+private:
+	struct Frame {
+		sgl::geometry_type type;
+		uint32_t count;
+		uint32_t next;
+		// Version 0 stores the ring counts of polygons in front of their vertices
+		const char *ring_counts;
+	};
+
+	VertexSpan ReadVertices(const uint32_t count) {
+		auto &reader = props.GetVersion() == 0 ? words : vertices;
+		VertexSpan span;
+		span.data = reader.Reserve(count * vertex_size);
+		span.count = count;
+		span.vertex_size = vertex_size;
+		return span;
+	}
+
+	bool ReadPart(const sgl::geometry_type type, const uint32_t index, GeometryPart &part) {
+		const auto count = words.Read<uint32_t>();
+
+		part.type = type;
+		part.is_ring = false;
+		part.depth = depth;
+		part.index = index;
+		part.part_count = 0;
+		part.vertices = VertexSpan();
+
+		switch (type) {
+		case sgl::geometry_type::POINT:
+		case sgl::geometry_type::LINESTRING:
+			part.vertices = ReadVertices(count);
+			return true;
+		case sgl::geometry_type::POLYGON:
+		case sgl::geometry_type::MULTI_POINT:
+		case sgl::geometry_type::MULTI_LINESTRING:
+		case sgl::geometry_type::MULTI_POLYGON:
+		case sgl::geometry_type::MULTI_GEOMETRY: {
+			if (depth == MAX_DEPTH) {
+				throw InvalidInputException("Geometry is nested more than %d levels deep", MAX_DEPTH);
+			}
+			part.part_count = count;
+
+			auto &frame = stack[depth++];
+			frame.type = type;
+			frame.count = count;
+			frame.next = 0;
+			frame.ring_counts = nullptr;
+			if (type == sgl::geometry_type::POLYGON && props.GetVersion() == 0) {
+				// The ring counts are padded to 8 bytes
+				frame.ring_counts = words.Reserve(count * sizeof(uint32_t) + (count % 2 == 1 ? 4 : 0));
+			}
+			return true;
+		}
+		default:
+			throw InvalidInputException("Invalid geometry type %d in serialized geometry", static_cast<int>(type));
+		}
+	}
+
+	BinaryReader words;
+	BinaryReader vertices;
+	GeometryProperties props;
+	sgl::geometry_type root_type;
+	uint32_t vertex_size;
+
+	bool started = false;
+	uint32_t depth = 0;
+	Frame stack[MAX_DEPTH];
+};
+
+//! Call the function with every point, linestring and polygon ring of a serialized geometry that has any vertices
+template <class F>
+void VisitVertexSpans(const string_t &blob, F &&func) {
+	GeometryCursor cursor(blob);
+	GeometryPart part;
+	while (cursor.Next(part)) {
+		if (part.vertices.count != 0) {
+			func(part);
+		}
+	}
+}
+
+//! Sum a value over every point, linestring and polygon ring of a serialized geometry. The values of the parts of each
+//! polygon and collection are added up before they are added to their parent, which is the order the sgl operations
+//! sum them in, so that e.g. an area computed this way is exactly the same as sgl::ops::area.
+template <class F>
+double SumVertexSpans(const string_t &blob, F &&func) {
+	// The running sum of the parts of the open (sub)geometry at each depth
+	double sums[GeometryCursor::MAX_DEPTH + 2];
+	uint32_t max_depth = 0;
+	sums[0] = 0.0;
+
+	GeometryCursor cursor(blob);
+	GeometryPart part;
+	while (cursor.Next(part)) {
+		// All parts that are deeper than this one are complete
+		for (; max_depth > part.depth; max_depth--) {
+			sums[max_depth - 1] += sums[max_depth];
+		}
+		max_depth = part.depth + 1;
+		sums[max_depth] = 0.0;
+
+		if (part.vertices.count != 0) {
+			sums[part.depth] += func(part);
+		}
+	}
+	for (; max_depth > 0; max_depth--) {
+		sums[max_depth - 1] += sums[max_depth];
+	}
+	return sums[0];
+}
+
+} // namespace duckdb
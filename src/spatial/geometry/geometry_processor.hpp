@@ -107,6 +107,8 @@ private:
 	uint32_t nesting_level = 0;
 	GeometryType current_type = GeometryType::POINT;
 	GeometryType parent_type = GeometryType::POINT;
+	// The next vertex in the vertex stream of version 1 geometries, null for version 0
+	const_data_ptr_t vertex_ptr = nullptr;
 
 protected:
 	bool HasZ() const {
@@ -228,23 +230,35 @@ public:
 		parent_type = GeometryType::POINT;
 
 		Cursor cursor(geom);
+		const auto start = cursor.GetPtr();
 
 		cursor.Skip<GeometryType>();
 		cursor.Skip<GeometryProperties>();
 		cursor.Skip<uint16_t>();
 		cursor.Skip<uint32_t>();
 
-		auto dims = 2 + (has_z ? 1 : 0) + (has_m ? 1 : 0);
-		auto has_bbox = geom.GetProperties().HasBBox();
-		auto bbox_size = has_bbox ? dims * 2 * sizeof(float) : 0;
-		cursor.Skip(bbox_size);
+		cursor.Skip(props.BBoxSize());
 
-		return ReadGeometry(cursor, args...);
+		if (props.GetVersion() == 0) {
+			vertex_ptr = nullptr;
+			return ReadGeometry(cursor, args...);
+		}
+
+		// The part words are followed by a single vertex stream for all parts, the type of the root is in the header
+		const auto word_count = cursor.Read<uint32_t>();
+		const auto words_end = static_cast<size_t>(cursor.GetPtr() - start) + word_count * sizeof(uint32_t);
+		vertex_ptr = start + GetGeometryVertexOffset(words_end);
+
+		return ReadPart(static_cast<SerializedGeometryType>(current_type), cursor, args...);
 	}
 
 private:
 	RESULT ReadGeometry(Cursor &cursor, ARGS... args) {
-		auto type = cursor.Peek<SerializedGeometryType>();
+		auto type = cursor.Read<SerializedGeometryType>();
+		return ReadPart(type, cursor, args...);
+	}
+
+	RESULT ReadPart(SerializedGeometryType type, Cursor &cursor, ARGS... args) {
 		switch (type) {
 		case SerializedGeometryType::POINT:
 			current_type = GeometryType::POINT;
@@ -272,34 +286,40 @@ private:
 		}
 	}
 
+	// Version 0 stores the vertices of a part right after its count, version 1 in the vertex stream
+	const_data_ptr_t ReadVertices(Cursor &cursor, uint32_t count) {
+		const auto byte_size = count * sizeof(double) * (2 + (HasZ() ? 1 : 0) + (HasM() ? 1 : 0));
+		if (vertex_ptr) {
+			const auto result = vertex_ptr;
+			vertex_ptr += byte_size;
+			return result;
+		}
+		const auto result = cursor.GetPtr();
+		cursor.Skip(byte_size);
+		return result;
+	}
+
 	RESULT ReadPoint(Cursor &cursor, ARGS... args) {
-		auto type = cursor.Read<SerializedGeometryType>();
-		D_ASSERT(type == SerializedGeometryType::POINT);
-		(void)type;
 		auto count = cursor.Read<uint32_t>();
-		VertexData data(cursor.GetPtr(), count, HasZ(), HasM());
-		cursor.Skip(data.ByteSize());
+		VertexData data(ReadVertices(cursor, count), count, HasZ(), HasM());
 		return ProcessPoint(data, args...);
 	}
 
 	RESULT ReadLineString(Cursor &cursor, ARGS... args) {
-		auto type = cursor.Read<SerializedGeometryType>();
-		D_ASSERT(type == SerializedGeometryType::LINESTRING);
-		(void)type;
 		auto count = cursor.Read<uint32_t>();
-		VertexData data(cursor.GetPtr(), count, HasZ(), HasM());
-		cursor.Skip(data.ByteSize());
+		VertexData data(ReadVertices(cursor, count), count, HasZ(), HasM());
 		return ProcessLineString(data, args...);
 	}
 
 	RESULT ReadPolygon(Cursor &cursor, ARGS... args) {
-		auto type = cursor.Read<SerializedGeometryType>();
-		D_ASSERT(type == SerializedGeometryType::POLYGON);
-		(void)type;
 		auto ring_count = cursor.Read<uint32_t>();
 		auto count_ptr = cursor.GetPtr();
-		cursor.Skip(ring_count * sizeof(uint32_t) + ((ring_count % 2) * sizeof(uint32_t)));
-		PolygonState state(ring_count, count_ptr, cursor.GetPtr(), *this);
+		cursor.Skip(ring_count * sizeof(uint32_t));
+		if (!vertex_ptr) {
+			// Version 0 pads the ring counts to 8 bytes
+			cursor.Skip((ring_count % 2) * sizeof(uint32_t));
+		}
+		PolygonState state(ring_count, count_ptr, vertex_ptr ? vertex_ptr : cursor.GetPtr(), *this);
 
 		ResultWrapper<RESULT> result([&]() { return ProcessPolygon(state, args...); });
 
@@ -309,15 +329,17 @@ private:
 				state.Next();
 			}
 		}
-		cursor.SetPtr(const_cast<data_ptr_t>(state.data_ptr));
+		if (vertex_ptr) {
+			vertex_ptr = state.data_ptr;
+		} else {
+			cursor.SetPtr(const_cast<data_ptr_t>(state.data_ptr));
+		}
 
 		return result.ReturnAndDestroy();
 	}
 
 	// NOLINTNEXTLINE
 	RESULT ReadCollection(Cursor &cursor, ARGS... args) {
-		auto type = cursor.Read<SerializedGeometryType>();
-		(void)type;
 		auto count = cursor.Read<uint32_t>();
 		CollectionState state(count, *this, cursor);
 
@@ -2,7 +2,25 @@
 
 namespace duckdb {
 
-static constexpr const uint8_t GEOMETRY_VERSION = 0;
+//! The latest version of the serialized geometry format. Version 0 interleaves the part headers with the vertices of
+//! each part. Version 1 stores all part headers in one block, followed by the vertices of all parts in a single 16-byte
+//! aligned stream, see geometry_serialization.hpp
+static constexpr const uint8_t GEOMETRY_VERSION = 1;
+
+//! In version 1 the vertex stream starts at the first 16-byte aligned offset (from the start of the blob) after the
+//! part words, so that vertex-wise functions can process it as one flat array of coordinates
+inline size_t GetGeometryVertexOffset(const size_t words_end) {
+	return (words_end + 15) & ~static_cast<size_t>(15);
+}
+
+//! The version to write a geometry in, given the version the caller asks for, its number of part words and where they
+//! end. Geometries are written in version 0 unless the caller asks for a newer version, so that they stay byte for byte
+//! equal to the same geometries in existing databases, which equality, grouping, joins and UNIQUE constraints compare.
+//! Geometries whose only part word is the count of the root (points, linestrings and empty geometries) and whose vertex
+//! stream needs no padding are laid out the same in both versions, and are always written in version 0.
+inline uint8_t GetGeometryWriteVersion(const uint8_t version, const size_t word_count, const size_t words_end) {
+	return word_count == 1 && GetGeometryVertexOffset(words_end) == words_end ? 0 : version;
+}
 
 struct GeometryProperties {
 private:
@@ -13,8 +31,9 @@ private:
 	// static constexpr const uint8_t EMPTY = 0x08;
 	// static constexpr const uint8_t GEODETIC = 0x10;
 	// static constexpr const uint8_t SOLID = 0x20;
-	static constexpr const uint8_t VERSION_1 = 0x40;
-	static constexpr const uint8_t VERSION_0 = 0x80;
+	// The version is stored in the two highest bits
+	static constexpr const uint8_t VERSION_MASK = 0xC0;
+	static constexpr const uint8_t VERSION_SHIFT = 6;
 	uint8_t flags = 0;
 
 public:
@@ -26,15 +45,20 @@ public:
 	}
 
 	inline void CheckVersion() const {
-		const auto v0 = (flags & VERSION_0);
-		const auto v1 = (flags & VERSION_1);
-		if ((v1 | v0) != GEOMETRY_VERSION) {
+		if (GetVersion() > GEOMETRY_VERSION) {
 			throw NotImplementedException(
 			    "This geometry seems to be written with a newer version of the DuckDB spatial library that is not "
 			    "compatible with this version. Please upgrade your DuckDB installation.");
 		}
 	}
 
+	inline uint8_t GetVersion() const {
+		return (flags & VERSION_MASK) >> VERSION_SHIFT;
+	}
+	inline void SetVersion(uint8_t version) {
+		flags = (flags & ~VERSION_MASK) | ((version << VERSION_SHIFT) & VERSION_MASK);
+	}
+
 	inline bool HasZ() const {
 		return (flags & Z) != 0;
 	}
@@ -57,6 +81,14 @@ public:
 	uint32_t VertexSize() const {
 		return sizeof(double) * (2 + HasZ() + HasM());
 	}
+
+	uint32_t BBoxSize() const {
+		return HasBBox() ? sizeof(float) * 2 * (2 + HasZ() + HasM()) : 0;
+	}
+
+	inline uint8_t GetFlags() const {
+		return flags;
+	}
 };
 
 } // namespace duckdb
\ No newline at end of file
@@ -2,74 +2,118 @@
 #include "spatial/util/binary_reader.hpp"
 #include "spatial/util/binary_writer.hpp"
 #include "spatial/util/math.hpp"
+#include "spatial/util/spatial_profiler.hpp"
+#include "spatial/geometry/geometry_properties.hpp"
 #include "spatial/geometry/sgl.hpp"
 
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/vector.hpp"
 #include "duckdb/storage/arena_allocator.hpp"
 
 namespace duckdb {
 
-// TODO: Make non-recursive
-
-static size_t GetRequiredSizeInternal(const sgl::geometry *geom) {
-	const auto vertex_size = geom->get_vertex_size();
-	const auto part_count = geom->get_count();
-
-	switch (geom->get_type()) {
-	case sgl::geometry_type::POINT:
-	case sgl::geometry_type::LINESTRING:
-		// 4 bytes for the type
-		// 4 bytes for the length
-		// sizeof(vertex) * count;
-		return 4 + 4 + part_count * vertex_size;
-	case sgl::geometry_type::POLYGON: {
-		// Polygons are special because they may pad between the rings and the ring data
-		// 4 bytes for the type
-		// 4 bytes for the length
-		// sizeof(vertex) * count;
-		size_t size = 4 + 4;
-
-		const auto tail = geom->get_last_part();
-		if (!tail) {
-			return size;
+//----------------------------------------------------------------------------------------------------------------------
+// Layout
+//----------------------------------------------------------------------------------------------------------------------
+// A serialized geometry (version 1) consists of:
+// - An 8 byte header: the type (u8), the flags (u8, see GeometryProperties), 2 unused bytes and 4 bytes of padding
+// - The bounding box as floats (xmin, ymin, xmax, ymax, [zmin, zmax], [mmin, mmax]), if the BBOX flag is set
+// - The number of part words (u32), followed by the part words (u32) describing the structure in preorder: the part
+//   count of the root, then the type and part count of every sub-geometry. Polygons are followed by the vertex count
+//   of each of their rings.
+// - Zero padding up to the next 16-byte aligned offset
+// - The vertices of all parts in preorder, until the end of the blob
+//
+// Version 0 instead writes the type and part count of every (sub)geometry in front of its own vertices, and pads the
+// ring counts of polygons to 8 bytes. The type of the root takes the place of the word count. This is the version that
+// is written, unless the caller asks for version 1 (see GetGeometryWriteVersion).
+
+namespace {
+
+//! Call the visitor on every (sub)geometry in preorder, without recursing. Polygon rings are not visited.
+template <class F>
+void VisitParts(const sgl::geometry &geom, F &&visit) {
+	const auto root = geom.get_parent();
+	auto part = &geom;
+
+	while (true) {
+		visit(*part);
+
+		if (part->is_collection() && !part->is_empty()) {
+			part = part->get_first_part();
+			continue;
 		}
-		auto part = tail;
-		do {
-			part = part->get_next();
-			size += 4 + part->get_count() * vertex_size;
-		} while (part != tail);
-
-		if (part_count % 2 == 1) {
-			size += 4;
+
+		while (true) {
+			const auto parent = part->get_parent();
+			if (parent == root) {
+				return;
+			}
+			if (part != parent->get_last_part()) {
+				part = part->get_next();
+				break;
+			}
+			part = parent;
 		}
-		return size;
 	}
-	case sgl::geometry_type::MULTI_POINT:
-	case sgl::geometry_type::MULTI_LINESTRING:
-	case sgl::geometry_type::MULTI_POLYGON:
-	case sgl::geometry_type::MULTI_GEOMETRY: {
-		// 4 bytes for the type
-		// 4 bytes for the length
-		// recursive call for each part
-		size_t size = 4 + 4;
-		const auto tail = geom->get_last_part();
-		if (!tail) {
-			return size;
+}
+
+struct PartLayout {
+	size_t word_count = 0;
+	size_t vertex_count = 0;
+	// The number of polygons with an odd number of rings, which are padded in version 0
+	size_t padding_count = 0;
+};
+
+PartLayout MeasureParts(const sgl::geometry &geom) {
+	PartLayout layout;
+	VisitParts(geom, [&](const sgl::geometry &part) {
+		const auto type = part.get_type();
+		if (type < sgl::geometry_type::POINT || type > sgl::geometry_type::MULTI_GEOMETRY) {
+			throw InvalidInputException("Cannot serialize geometry of type %d", static_cast<int>(type));
 		}
-		auto part = tail;
-		do {
-			part = part->get_next();
-			size += GetRequiredSizeInternal(part);
-		} while (part != tail);
-		return size;
-	}
-	default:
-		D_ASSERT(false);
-		return 0;
-	}
+
+		// The type of the root is already stored in the header
+		layout.word_count += &part == &geom ? 1 : 2;
+
+		switch (type) {
+		case sgl::geometry_type::POINT:
+		case sgl::geometry_type::LINESTRING:
+			layout.vertex_count += part.get_count();
+			break;
+		case sgl::geometry_type::POLYGON: {
+			layout.word_count += part.get_count();
+			layout.padding_count += part.get_count() % 2;
+			const auto tail = part.get_last_part();
+			if (!tail) {
+				break;
+			}
+			auto ring = tail;
+			do {
+				ring = ring->get_next();
+				layout.vertex_count += ring->get_count();
+			} while (ring != tail);
+		} break;
+		default:
+			break;
+		}
+	});
+	return layout;
 }
 
-size_t Serde::GetRequiredSize(const sgl::geometry &geom) {
+size_t GetWordsEnd(const size_t bbox_size, const size_t word_count) {
+	// header + bbox + word count + words
+	return 4 + 4 + bbox_size + 4 + word_count * 4;
+}
+
+// Where the vertices start in version 1, or where the blob ends without its vertices in version 0
+size_t GetVertexOffset(const uint8_t version, const size_t words_end, const PartLayout &layout) {
+	return version == 0 ? words_end + layout.padding_count * sizeof(uint32_t) : GetGeometryVertexOffset(words_end);
+}
+
+} // namespace
+
+size_t Serde::GetRequiredSize(const sgl::geometry &geom, const uint8_t version) {
 	const auto type = geom.get_type();
 
 	const auto has_bbox = type != sgl::geometry_type::POINT && !geom.is_empty();
@@ -77,12 +121,13 @@ size_t Serde::GetRequiredSize(const sgl::geometry &geom) {
 	const auto has_m = geom.has_m();
 
 	const auto dims = 2 + (has_z ? 1 : 0) + (has_m ? 1 : 0);
-
-	const auto head_size = 4 + 4; // type + props + padding
-	const auto geom_size = GetRequiredSizeInternal(&geom);
+	const auto vert_size = dims * sizeof(double);
 	const auto bbox_size = has_bbox ? dims * sizeof(float) * 2 : 0;
 
-	const auto full_size = head_size + geom_size + bbox_size;
+	const auto layout = MeasureParts(geom);
+	const auto words_end = GetWordsEnd(bbox_size, layout.word_count);
+	const auto write_version = GetGeometryWriteVersion(version, layout.word_count, words_end);
+	const auto full_size = GetVertexOffset(write_version, words_end, layout) + layout.vertex_count * vert_size;
 
 	// Check that the size is a multiple of 8
 	D_ASSERT(full_size % 8 == 0);
@@ -90,10 +135,24 @@ size_t Serde::GetRequiredSize(const sgl::geometry &geom) {
 	return full_size;
 }
 
-static void SerializeVertices(BinaryWriter &cursor, const sgl::geometry *geom, const uint32_t count, const bool has_z,
-                              const bool has_m, const bool has_bbox, const uint32_t vsize, sgl::box_xyzm &bbox) {
+static void ExpandBounds(const sgl::vertex_xyzm &vertex, const bool has_z, const bool has_m, sgl::box_xyzm &bbox) {
+	bbox.min.x = std::min(bbox.min.x, vertex.x);
+	bbox.min.y = std::min(bbox.min.y, vertex.y);
+	bbox.max.x = std::max(bbox.max.x, vertex.x);
+	bbox.max.y = std::max(bbox.max.y, vertex.y);
 
-	const auto verts = geom->get_vertex_data();
+	if (has_z) {
+		bbox.min.zm = std::min(bbox.min.zm, vertex.zm);
+		bbox.max.zm = std::max(bbox.max.zm, vertex.zm);
+	}
+	if (has_m) {
+		bbox.min.m = std::min(bbox.min.m, vertex.m);
+		bbox.max.m = std::max(bbox.max.m, vertex.m);
+	}
+}
+
+static void SerializeVertices(BinaryWriter &cursor, const uint8_t *verts, const uint32_t count, const bool has_z,
+                              const bool has_m, const bool has_bbox, const uint32_t vsize, sgl::box_xyzm &bbox) {
 
 	// Copy the vertices to the cursor
 	const auto dst = cursor.Reserve(count * vsize);
@@ -113,134 +172,219 @@ static void SerializeVertices(BinaryWriter &cursor, const sgl::geometry *geom, c
 		// Copy the vertex to the cursor
 		memcpy(dst + i * vsize, &vertex, vsize);
 
-		bbox.min.x = std::min(bbox.min.x, vertex.x);
-		bbox.min.y = std::min(bbox.min.y, vertex.y);
-		bbox.max.x = std::max(bbox.max.x, vertex.x);
-		bbox.max.y = std::max(bbox.max.y, vertex.y);
-
-		if (has_z) {
-			bbox.min.zm = std::min(bbox.min.zm, vertex.zm);
-			bbox.max.zm = std::max(bbox.max.zm, vertex.zm);
-		}
-		if (has_m) {
-			bbox.min.m = std::min(bbox.min.m, vertex.m);
-			bbox.max.m = std::max(bbox.max.m, vertex.m);
-		}
+		ExpandBounds(vertex, has_z, has_m, bbox);
 	}
 }
 
-static void SerializeRecursive(BinaryWriter &cursor, const sgl::geometry *geom, const bool has_z, const bool has_m,
-                               const bool has_bbox, const uint32_t vsize, sgl::box_xyzm &bbox) {
-	const auto type = geom->get_type();
-	const auto count = geom->get_count();
+static void SerializeBounds(BinaryWriter &cursor, const sgl::box_xyzm &bbox, const bool has_z, const bool has_m) {
+	cursor.Write<float>(MathUtil::DoubleToFloatDown(bbox.min.x)); // xmin
+	cursor.Write<float>(MathUtil::DoubleToFloatDown(bbox.min.y)); // ymin
+	cursor.Write<float>(MathUtil::DoubleToFloatUp(bbox.max.x));   // xmax
+	cursor.Write<float>(MathUtil::DoubleToFloatUp(bbox.max.y));   // ymax
 
-	if (type < sgl::geometry_type::POINT || type > sgl::geometry_type::MULTI_GEOMETRY) {
-		throw InvalidInputException("Cannot serialize geometry of type %d", static_cast<int>(type));
+	if (has_z) {
+		cursor.Write<float>(MathUtil::DoubleToFloatDown(bbox.min.zm)); // zmin
+		cursor.Write<float>(MathUtil::DoubleToFloatUp(bbox.max.zm));   // zmax
 	}
 
-	// The GeometryType enum used to start with POINT = 0
-	// but now it starts with INVALID = 0, so we need to subtract 1
-	cursor.Write<uint32_t>(static_cast<uint32_t>(type) - 1);
-	cursor.Write<uint32_t>(count);
-
-	switch (type) {
-	case sgl::geometry_type::POINT:
-	case sgl::geometry_type::LINESTRING:
-		SerializeVertices(cursor, geom, count, has_z, has_m, has_bbox, vsize, bbox);
-		break;
-	case sgl::geometry_type::POLYGON: {
-		auto ring_cursor = cursor;
-		cursor.Skip((count * 4) + (count % 2 == 1 ? 4 : 0), true);
-
-		const auto tail = geom->get_last_part();
-		if (!tail) {
-			break;
-		}
-
-		auto ring = tail;
-		do {
-			ring = ring->get_next();
-			ring_cursor.Write<uint32_t>(ring->get_count());
-			SerializeVertices(cursor, ring, ring->get_count(), has_z, has_m, has_bbox, vsize, bbox);
-		} while (ring != tail);
-
-	} break;
-	case sgl::geometry_type::MULTI_POINT:
-	case sgl::geometry_type::MULTI_LINESTRING:
-	case sgl::geometry_type::MULTI_POLYGON:
-	case sgl::geometry_type::MULTI_GEOMETRY: {
-		const auto tail = geom->get_last_part();
-		if (!tail) {
-			break;
-		}
-
-		auto part = tail;
-		do {
-			part = part->get_next();
-			SerializeRecursive(cursor, part, has_z, has_m, has_bbox, vsize, bbox);
-		} while (part != tail);
-	} break;
-	default:
-		D_ASSERT(false);
+	if (has_m) {
+		cursor.Write<float>(MathUtil::DoubleToFloatDown(bbox.min.m)); // mmin
+		cursor.Write<float>(MathUtil::DoubleToFloatUp(bbox.max.m));   // mmax
 	}
 }
 
-void Serde::Serialize(const sgl::geometry &geom, char *buffer, size_t buffer_size) {
+void Serde::Serialize(const sgl::geometry &geom, char *buffer, size_t buffer_size, const uint8_t requested_version) {
+	SpatialProfileScope profile(SpatialProfileCategory::SERIALIZE);
+
 	const auto type = geom.get_type();
 
 	const auto has_bbox = type != sgl::geometry_type::POINT && !geom.is_empty();
 	const auto has_z = geom.has_z();
 	const auto has_m = geom.has_m();
 
-	// Set flags
-	uint8_t flags = 0;
-	flags |= has_z ? 0x01 : 0;
-	flags |= has_m ? 0x02 : 0;
-	flags |= has_bbox ? 0x04 : 0;
-
-	BinaryWriter cursor(buffer, buffer_size);
-
 	if (type == sgl::geometry_type::INVALID) {
 		throw InvalidInputException("Cannot serialize geometry of type INVALID");
 	}
 
+	const auto dims = 2 + (has_z ? 1 : 0) + (has_m ? 1 : 0);
+	const auto vert_size = dims * sizeof(double);
+	const auto bbox_size = has_bbox ? dims * sizeof(float) * 2 : 0;
+
+	const auto layout = MeasureParts(geom);
+	const auto words_end = GetWordsEnd(bbox_size, layout.word_count);
+	const auto version = GetGeometryWriteVersion(requested_version, layout.word_count, words_end);
+	const auto vertex_offset = GetVertexOffset(version, words_end, layout);
+
+	// Set flags
+	GeometryProperties props(has_z, has_m);
+	props.SetBBox(has_bbox);
+	props.SetVersion(version);
+
+	BinaryWriter cursor(buffer, buffer_size);
+
 	// The GeometryType enum used to start with POINT = 0
 	// but now it starts with INVALID = 0, so we need to subtract 1
 	cursor.Write<uint8_t>(static_cast<uint8_t>(type) - 1);
-	cursor.Write<uint8_t>(flags);
+	cursor.Write<uint8_t>(props.GetFlags());
 	cursor.Write<uint16_t>(0); // unused for now
 	cursor.Write<uint32_t>(0); // padding
 
-	const auto dims = 2 + (has_z ? 1 : 0) + (has_m ? 1 : 0);
-	const auto vert_size = dims * sizeof(double);
-	const auto bbox_size = has_bbox ? dims * sizeof(float) * 2 : 0;
-
 	// Setup a bbox to store the min/max values
 	sgl::box_xyzm bbox = sgl::box_xyzm::smallest();
 
 	auto bbox_cursor = cursor;
 	cursor.Skip(bbox_size, true);
 
-	SerializeRecursive(cursor, &geom, has_z, has_m, has_bbox, vert_size, bbox);
+	// Version 0 stores the type of the root in place of the word count
+	cursor.Write<uint32_t>(version == 0 ? static_cast<uint32_t>(type) - 1 : static_cast<uint32_t>(layout.word_count));
 
-	if (has_bbox) {
-		bbox_cursor.Write<float>(MathUtil::DoubleToFloatDown(bbox.min.x)); // xmin
-		bbox_cursor.Write<float>(MathUtil::DoubleToFloatDown(bbox.min.y)); // ymin
-		bbox_cursor.Write<float>(MathUtil::DoubleToFloatUp(bbox.max.x));   // xmax
-		bbox_cursor.Write<float>(MathUtil::DoubleToFloatUp(bbox.max.y));   // ymax
-
-		if (has_z) {
-			bbox_cursor.Write<float>(MathUtil::DoubleToFloatDown(bbox.min.zm)); // zmin
-			bbox_cursor.Write<float>(MathUtil::DoubleToFloatUp(bbox.max.zm));   // zmax
+	// In version 1 the part words and the vertex stream are written in the same pass, through separate cursors
+	BinaryWriter stream_cursor(buffer + vertex_offset, buffer + buffer_size);
+	auto &vertex_cursor = version == 0 ? cursor : stream_cursor;
+
+	VisitParts(geom, [&](const sgl::geometry &part) {
+		const auto part_type = part.get_type();
+		const auto count = part.get_count();
+
+		if (&part != &geom) {
+			cursor.Write<uint32_t>(static_cast<uint32_t>(part_type) - 1);
 		}
+		cursor.Write<uint32_t>(count);
 
-		if (has_m) {
-			bbox_cursor.Write<float>(MathUtil::DoubleToFloatDown(bbox.min.m)); // mmin
-			bbox_cursor.Write<float>(MathUtil::DoubleToFloatUp(bbox.max.m));   // mmax
+		switch (part_type) {
+		case sgl::geometry_type::POINT:
+		case sgl::geometry_type::LINESTRING:
+			SerializeVertices(vertex_cursor, part.get_vertex_data(), count, has_z, has_m, has_bbox, vert_size, bbox);
+			break;
+		case sgl::geometry_type::POLYGON: {
+			const auto tail = part.get_last_part();
+			if (!tail) {
+				break;
+			}
+			// All ring counts come first, version 0 pads them to 8 bytes
+			auto ring = tail;
+			do {
+				ring = ring->get_next();
+				cursor.Write<uint32_t>(ring->get_count());
+			} while (ring != tail);
+			if (version == 0 && count % 2 == 1) {
+				cursor.Skip(sizeof(uint32_t), true);
+			}
+			do {
+				ring = ring->get_next();
+				SerializeVertices(vertex_cursor, ring->get_vertex_data(), ring->get_count(), has_z, has_m, has_bbox,
+				                  vert_size, bbox);
+			} while (ring != tail);
+		} break;
+		default:
+			break;
 		}
+	});
+
+	// Zero the padding in front of the vertex stream
+	if (version != 0) {
+		cursor.Skip(vertex_offset - words_end, true);
 	}
+
+	if (has_bbox) {
+		SerializeBounds(bbox_cursor, bbox, has_z, has_m);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Points
+//----------------------------------------------------------------------------------------------------------------------
+// A non-empty 2D point is always laid out the same: the 8 byte header, a single part word (the vertex count of 1) in
+// version 1 or the type (POINT = 0) in version 0, the vertex count, and the vertex right after it at offset 16. Points
+// are written in version 0 (see GetGeometryWriteVersion).
+
+// The first 16 bytes of every serialized (non-empty) 2D point
+static void SerializePointHeader(char *buffer) {
+	GeometryProperties props(false, false);
+	props.SetVersion(0);
+
+	BinaryWriter cursor(buffer, 16);
+	cursor.Write<uint8_t>(static_cast<uint8_t>(sgl::geometry_type::POINT) - 1);
+	cursor.Write<uint8_t>(props.GetFlags());
+	cursor.Write<uint16_t>(0); // unused for now
+	cursor.Write<uint32_t>(0); // padding
+	cursor.Write<uint32_t>(static_cast<uint32_t>(sgl::geometry_type::POINT) - 1); // type
+	cursor.Write<uint32_t>(1);                                                     // vertex count
 }
 
+void Serde::SerializePointsXY(Vector &x, Vector &y, Vector &result, size_t count, const ValidityMask *validity) {
+	SpatialProfileScope profile(SpatialProfileCategory::SERIALIZE);
+
+	const auto is_constant = x.GetVectorType() == VectorType::CONSTANT_VECTOR &&
+	                         y.GetVectorType() == VectorType::CONSTANT_VECTOR && !validity;
+	if (is_constant) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+		count = 1;
+	}
+	if (count == 0) {
+		return;
+	}
+
+	UnifiedVectorFormat x_format;
+	UnifiedVectorFormat y_format;
+	x.ToUnifiedFormat(count, x_format);
+	y.ToUnifiedFormat(count, y_format);
+	const auto x_data = UnifiedVectorFormat::GetData<double>(x_format);
+	const auto y_data = UnifiedVectorFormat::GetData<double>(y_format);
+
+	const auto result_data =
+	    is_constant ? ConstantVector::GetData<string_t>(result) : FlatVector::GetData<string_t>(result);
+	auto &result_validity = is_constant ? ConstantVector::Validity(result) : FlatVector::Validity(result);
+
+	// All the points have the same size and header, so allocate the blobs of the whole chunk at once
+	auto buffer = StringVector::EmptyString(result, count * POINT_XY_SIZE).GetDataWriteable();
+	char header[16];
+	SerializePointHeader(header);
+
+	for (idx_t i = 0; i < count; i++) {
+		const auto x_idx = x_format.sel->get_index(i);
+		const auto y_idx = y_format.sel->get_index(i);
+		if (!x_format.validity.RowIsValid(x_idx) || !y_format.validity.RowIsValid(y_idx) ||
+		    (validity && !validity->RowIsValid(i))) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+
+		const auto blob = buffer + i * POINT_XY_SIZE;
+		memcpy(blob, header, sizeof(header));
+		memcpy(blob + 16, &x_data[x_idx], sizeof(double));
+		memcpy(blob + 24, &y_data[y_idx], sizeof(double));
+		result_data[i] = string_t(blob, POINT_XY_SIZE);
+	}
+}
+
+bool Serde::TryGetPointXY(const char *buffer, size_t buffer_size, double &x, double &y) {
+	if (buffer_size != POINT_XY_SIZE) {
+		return false;
+	}
+
+	BinaryReader cursor(buffer, buffer_size);
+	const auto type = cursor.Read<uint8_t>();
+	const auto props = cursor.Read<GeometryProperties>();
+	cursor.Skip(sizeof(uint16_t));
+	cursor.Skip(sizeof(uint32_t)); // padding
+
+	props.CheckVersion();
+	if (type != static_cast<uint8_t>(sgl::geometry_type::POINT) - 1 || props.HasZ() || props.HasM() ||
+	    props.HasBBox()) {
+		return false;
+	}
+
+	cursor.Skip(sizeof(uint32_t)); // word count (version 1) or type (version 0)
+	if (cursor.Read<uint32_t>() != 1) {
+		return false;
+	}
+	x = cursor.Read<double>();
+	y = cursor.Read<double>();
+	return true;
+}
+
+// Version 0
 static void DeserializeRecursive(BinaryReader &cursor, sgl::geometry &geom, const bool has_z, const bool has_m,
                                  ArenaAllocator &arena) {
 	const auto count = cursor.Read<uint32_t>();
@@ -287,45 +431,549 @@ static void DeserializeRecursive(BinaryReader &cursor, sgl::geometry &geom, cons
 	}
 }
 
+// Version 1
+static void DeserializeParts(BinaryReader &words, BinaryReader &vertices, sgl::geometry &geom, const bool has_z,
+                             const bool has_m, ArenaAllocator &arena) {
+	const auto count = words.Read<uint32_t>();
+	switch (geom.get_type()) {
+	case sgl::geometry_type::POINT:
+	case sgl::geometry_type::LINESTRING: {
+		const auto verts = vertices.Reserve(count * geom.get_vertex_size());
+		geom.set_vertex_data(verts, count);
+	} break;
+	case sgl::geometry_type::POLYGON: {
+		for (uint32_t i = 0; i < count; i++) {
+			const auto ring_count = words.Read<uint32_t>();
+			const auto verts = vertices.Reserve(ring_count * geom.get_vertex_size());
+
+			auto ring_mem = arena.AllocateAligned(sizeof(sgl::geometry));
+			const auto ring = new (ring_mem) sgl::geometry(sgl::geometry_type::LINESTRING);
+
+			ring->set_z(has_z);
+			ring->set_m(has_m);
+			ring->set_vertex_data(verts, ring_count);
+
+			geom.append_part(ring);
+		}
+	} break;
+	case sgl::geometry_type::MULTI_POINT:
+	case sgl::geometry_type::MULTI_LINESTRING:
+	case sgl::geometry_type::MULTI_POLYGON:
+	case sgl::geometry_type::MULTI_GEOMETRY: {
+		for (uint32_t i = 0; i < count; i++) {
+			const auto part_type = static_cast<sgl::geometry_type>(words.Read<uint32_t>() + 1);
+			auto part_mem = arena.AllocateAligned(sizeof(sgl::geometry));
+			const auto part = new (part_mem) sgl::geometry(part_type);
+			part->set_z(has_z);
+			part->set_m(has_m);
+			DeserializeParts(words, vertices, *part, has_z, has_m, arena);
+
+			geom.append_part(part);
+		}
+	} break;
+	default:
+		break;
+	}
+}
+
+//! Read the part words of a version 1 geometry, and move the cursor to the start of the vertex stream
+static BinaryReader ReadPartWords(BinaryReader &cursor) {
+	const auto word_count = cursor.Read<uint32_t>();
+	const auto words_size = word_count * sizeof(uint32_t);
+	BinaryReader words(cursor.Reserve(words_size), words_size);
+
+	// Skip the padding in front of the vertex stream
+	const auto words_end = static_cast<size_t>(cursor.GetPtr() - cursor.GetStart());
+	cursor.Skip(GetGeometryVertexOffset(words_end) - words_end);
+	return words;
+}
+
 void Serde::Deserialize(sgl::geometry &result, ArenaAllocator &arena, const char *buffer, size_t buffer_size) {
+	SpatialProfileScope profile(SpatialProfileCategory::DESERIALIZE);
 
 	BinaryReader cursor(buffer, buffer_size);
 
 	const auto type = static_cast<sgl::geometry_type>(cursor.Read<uint8_t>() + 1);
-	const auto flags = cursor.Read<uint8_t>();
+	const auto props = cursor.Read<GeometryProperties>();
 	cursor.Skip(sizeof(uint16_t));
 	cursor.Skip(sizeof(uint32_t)); // padding
 
-	// Parse flags
-	const auto has_z = (flags & 0x01) != 0;
-	const auto has_m = (flags & 0x02) != 0;
-	const auto has_bbox = (flags & 0x04) != 0;
+	// Throws if the geometry was written with a newer version
+	props.CheckVersion();
 
-	const auto format_v1 = (flags & 0x40) != 0;
-	const auto format_v0 = (flags & 0x80) != 0;
+	// Parse flags
+	const auto has_z = props.HasZ();
+	const auto has_m = props.HasM();
 
-	if (format_v1 || format_v0) {
-		// Unsupported version, throw an error
-		throw NotImplementedException(
-		    "This geometry seems to be written with a newer version of the DuckDB spatial library that is not "
-		    "compatible with this version. Please upgrade your DuckDB installation.");
-	}
-
-	if (has_bbox) {
-		// Skip past bbox if present
-		cursor.Skip(sizeof(float) * 2 * (2 + has_z + has_m));
-	}
+	// Skip past bbox if present
+	cursor.Skip(props.BBoxSize());
 
 	// Create root geometry
 	result.set_type(type);
 	result.set_z(has_z);
 	result.set_m(has_m);
 
-	// Read the first type
-	cursor.Read<uint32_t>();
+	if (props.GetVersion() == 0) {
+		// Read the first type
+		cursor.Read<uint32_t>();
+
+		// Deserialize the geometry
+		DeserializeRecursive(cursor, result, has_z, has_m, arena);
+		return;
+	}
+
+	// Deserialize the geometry, the cursor is now at the start of the vertex stream
+	auto words = ReadPartWords(cursor);
+	DeserializeParts(words, cursor, result, has_z, has_m, arena);
+}
+
+static bool GetExtentVertices(BinaryReader &cursor, const size_t count, const size_t vertex_size,
+                              sgl::box_xy &result) {
+	const auto verts = cursor.Reserve(count * vertex_size);
+	for (size_t i = 0; i < count; i++) {
+		double x;
+		double y;
+		memcpy(&x, verts + i * vertex_size, sizeof(double));
+		memcpy(&y, verts + i * vertex_size + sizeof(double), sizeof(double));
+		result.min.x = std::min(result.min.x, x);
+		result.min.y = std::min(result.min.y, y);
+		result.max.x = std::max(result.max.x, x);
+		result.max.y = std::max(result.max.y, y);
+	}
+	return count != 0;
+}
+
+// Version 0
+static bool GetExtentRecursive(BinaryReader &cursor, const sgl::geometry_type type, const size_t vertex_size,
+                               sgl::box_xy &result) {
+	const auto count = cursor.Read<uint32_t>();
+	switch (type) {
+	case sgl::geometry_type::POINT:
+	case sgl::geometry_type::LINESTRING:
+		return GetExtentVertices(cursor, count, vertex_size, result);
+	case sgl::geometry_type::POLYGON: {
+		auto ring_cursor = cursor;
+		cursor.Skip((count * 4) + (count % 2 == 1 ? 4 : 0));
+		auto has_vertices = false;
+		for (uint32_t i = 0; i < count; i++) {
+			const auto ring_count = ring_cursor.Read<uint32_t>();
+			if (i == 0) {
+				has_vertices = GetExtentVertices(cursor, ring_count, vertex_size, result);
+			} else {
+				// The holes are within the shell, so they don't contribute to the extent
+				cursor.Skip(ring_count * vertex_size);
+			}
+		}
+		return has_vertices;
+	}
+	case sgl::geometry_type::MULTI_POINT:
+	case sgl::geometry_type::MULTI_LINESTRING:
+	case sgl::geometry_type::MULTI_POLYGON:
+	case sgl::geometry_type::MULTI_GEOMETRY: {
+		auto has_vertices = false;
+		for (uint32_t i = 0; i < count; i++) {
+			const auto part_type = static_cast<sgl::geometry_type>(cursor.Read<uint32_t>() + 1);
+			has_vertices |= GetExtentRecursive(cursor, part_type, vertex_size, result);
+		}
+		return has_vertices;
+	}
+	default:
+		return false;
+	}
+}
+
+bool Serde::TryGetExtentXY(const char *buffer, size_t buffer_size, sgl::box_xy &result) {
+	BinaryReader cursor(buffer, buffer_size);
+
+	const auto type = static_cast<sgl::geometry_type>(cursor.Read<uint8_t>() + 1);
+	const auto props = cursor.Read<GeometryProperties>();
+	cursor.Skip(sizeof(uint16_t));
+	cursor.Skip(sizeof(uint32_t)); // padding
+
+	props.CheckVersion();
+
+	// The cached bbox is rounded to floats, so we still have to look at the vertices for the exact extent
+	cursor.Skip(props.BBoxSize());
+
+	const auto vertex_size = props.VertexSize();
+
+	if (props.GetVersion() == 0) {
+		// Skip the type of the root geometry
+		cursor.Read<uint32_t>();
+		return GetExtentRecursive(cursor, type, vertex_size, result);
+	}
+
+	// The vertices of all parts are stored in one stream, so there is no need to look at the structure at all
+	ReadPartWords(cursor);
+	const auto vertex_count = static_cast<size_t>(cursor.GetEnd() - cursor.GetPtr()) / vertex_size;
+	return GetExtentVertices(cursor, vertex_count, vertex_size, result);
+}
+
+bool Serde::TryGetVertexStream(const char *buffer, size_t buffer_size, size_t &offset, size_t &count) {
+	BinaryReader cursor(buffer, buffer_size);
+
+	const auto type = static_cast<sgl::geometry_type>(cursor.Read<uint8_t>() + 1);
+	const auto props = cursor.Read<GeometryProperties>();
+	cursor.Skip(sizeof(uint16_t));
+	cursor.Skip(sizeof(uint32_t)); // padding
+
+	props.CheckVersion();
+	cursor.Skip(props.BBoxSize());
+
+	if (props.GetVersion() == 0) {
+		// Only points, linestrings and empty geometries have a single run of vertices after the root
+		cursor.Skip(sizeof(uint32_t)); // type
+		const auto root_count = cursor.Read<uint32_t>();
+		if (type != sgl::geometry_type::POINT && type != sgl::geometry_type::LINESTRING && root_count != 0) {
+			return false;
+		}
+	} else {
+		ReadPartWords(cursor);
+	}
+
+	offset = static_cast<size_t>(cursor.GetPtr() - buffer);
+	count = (buffer_size - offset) / props.VertexSize();
+	return true;
+}
+
+void Serde::UpdateBounds(char *buffer, size_t buffer_size) {
+	size_t offset;
+	size_t count;
+	if (!TryGetVertexStream(buffer, buffer_size, offset, count)) {
+		throw InternalException("Cannot update the bounds of a geometry without a vertex stream");
+	}
+
+	const auto props = Load<GeometryProperties>(const_data_ptr_cast(buffer + 1));
+
+	if (!props.HasBBox()) {
+		return;
+	}
+
+	const auto has_z = props.HasZ();
+	const auto has_m = props.HasM();
+	const auto vsize = props.VertexSize();
+
+	sgl::box_xyzm bbox = sgl::box_xyzm::smallest();
+	sgl::vertex_xyzm vertex = {0};
+	for (size_t i = 0; i < count; i++) {
+		memcpy(&vertex, buffer + offset + i * vsize, vsize);
+		ExpandBounds(vertex, has_z, has_m, bbox);
+	}
+
+	// The bounds directly follow the header
+	BinaryWriter bbox_cursor(buffer + 8, buffer + buffer_size);
+	SerializeBounds(bbox_cursor, bbox, has_z, has_m);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// WKB
+//----------------------------------------------------------------------------------------------------------------------
+// WKB is transcoded in two passes over the blob. The first pass only looks at the headers and counts to validate the
+// structure and compute the serialized size, the second pass writes the serialized geometry, copying the vertices
+// straight from the WKB. The output is byte-for-byte the same as parsing the WKB with sgl and calling Serialize.
+
+namespace {
+
+struct WKBLayout {
+	bool has_z;
+	bool has_m;
+	bool nan_as_empty;
+	uint32_t vertex_size;
+};
+
+class WKBCursor {
+public:
+	WKBCursor(const char *ptr, const char *end) : ptr(ptr), end(end) {
+	}
+
+	bool CanRead(const size_t size) const {
+		return static_cast<size_t>(end - ptr) >= size;
+	}
+
+	uint32_t ReadU32() {
+		uint32_t value;
+		memcpy(&value, ptr, sizeof(uint32_t));
+		ptr += sizeof(uint32_t);
+		return value;
+	}
+
+	const char *Reserve(const size_t size) {
+		const auto result = ptr;
+		ptr += size;
+		return result;
+	}
+
+	//! Read a geometry header. Only little-endian headers are accepted
+	bool TryReadHeader(sgl::geometry_type &type, bool &has_z, bool &has_m) {
+		if (!CanRead(sizeof(uint8_t) + sizeof(uint32_t)) || *ptr != 1) {
+			return false;
+		}
+		ptr++;
+
+		const auto type_id = ReadU32();
+		const auto type_code = (type_id & 0xffff) % 1000;
+		const auto flags = (type_id & 0xffff) / 1000;
+		has_z = (flags == 1) || (flags == 3) || ((type_id & 0x80000000) != 0);
+		has_m = (flags == 2) || (flags == 3) || ((type_id & 0x40000000) != 0);
+
+		if ((type_id & 0x20000000) != 0) {
+			// Skip the SRID
+			if (!CanRead(sizeof(uint32_t))) {
+				return false;
+			}
+			ptr += sizeof(uint32_t);
+		}
+
+		if (type_code < static_cast<uint32_t>(sgl::geometry_type::POINT) ||
+		    type_code > static_cast<uint32_t>(sgl::geometry_type::MULTI_GEOMETRY)) {
+			return false;
+		}
+		type = static_cast<sgl::geometry_type>(type_code);
+		return true;
+	}
+
+private:
+	const char *ptr;
+	const char *end;
+};
+
+//! The max nesting depth of collections, same as used with the sgl WKB reader
+constexpr uint32_t MAX_WKB_DEPTH = 128;
+
+bool IsEmptyPoint(const char *vertex, const WKBLayout &layout) {
+	if (!layout.nan_as_empty) {
+		return false;
+	}
+	for (uint32_t i = 0; i < layout.vertex_size; i += sizeof(double)) {
+		double value;
+		memcpy(&value, vertex + i, sizeof(double));
+		if (!std::isnan(value)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//! Validate the structure of a (sub)geometry and add its part words and vertices to the layout. The part count of the
+//! geometry is returned in 'count', for points this is the number of vertices.
+bool TryMeasureWKB(WKBCursor &cursor, const WKBLayout &layout, const sgl::geometry_type expected_type,
+                   const uint32_t depth, PartLayout &parts, uint32_t &count) {
+	sgl::geometry_type type;
+	bool has_z;
+	bool has_m;
+	if (!cursor.TryReadHeader(type, has_z, has_m)) {
+		return false;
+	}
+	// Mixed Z/M layouts have to be forced into the layout of the root first
+	if (has_z != layout.has_z || has_m != layout.has_m) {
+		return false;
+	}
+	if (expected_type != sgl::geometry_type::INVALID && type != expected_type) {
+		return false;
+	}
+
+	// type + count
+	parts.word_count += 2;
+
+	switch (type) {
+	case sgl::geometry_type::POINT: {
+		if (!cursor.CanRead(layout.vertex_size)) {
+			return false;
+		}
+		count = IsEmptyPoint(cursor.Reserve(layout.vertex_size), layout) ? 0 : 1;
+		parts.vertex_count += count;
+		return true;
+	}
+	case sgl::geometry_type::LINESTRING: {
+		if (!cursor.CanRead(sizeof(uint32_t))) {
+			return false;
+		}
+		count = cursor.ReadU32();
+		const auto byte_size = static_cast<size_t>(count) * layout.vertex_size;
+		if (!cursor.CanRead(byte_size)) {
+			return false;
+		}
+		cursor.Reserve(byte_size);
+		parts.vertex_count += count;
+		return true;
+	}
+	case sgl::geometry_type::POLYGON: {
+		if (!cursor.CanRead(sizeof(uint32_t))) {
+			return false;
+		}
+		count = cursor.ReadU32();
+		for (uint32_t ring_idx = 0; ring_idx < count; ring_idx++) {
+			if (!cursor.CanRead(sizeof(uint32_t))) {
+				return false;
+			}
+			const auto ring_count = cursor.ReadU32();
+			const auto byte_size = static_cast<size_t>(ring_count) * layout.vertex_size;
+			if (!cursor.CanRead(byte_size)) {
+				return false;
+			}
+			cursor.Reserve(byte_size);
+			parts.word_count++;
+			parts.vertex_count += ring_count;
+		}
+		parts.padding_count += count % 2;
+		return true;
+	}
+	case sgl::geometry_type::MULTI_POINT:
+	case sgl::geometry_type::MULTI_LINESTRING:
+	case sgl::geometry_type::MULTI_POLYGON:
+	case sgl::geometry_type::MULTI_GEOMETRY: {
+		if (depth >= MAX_WKB_DEPTH || !cursor.CanRead(sizeof(uint32_t))) {
+			return false;
+		}
+		count = cursor.ReadU32();
+
+		auto part_type = sgl::geometry_type::INVALID;
+		if (type == sgl::geometry_type::MULTI_POINT) {
+			part_type = sgl::geometry_type::POINT;
+		} else if (type == sgl::geometry_type::MULTI_LINESTRING) {
+			part_type = sgl::geometry_type::LINESTRING;
+		} else if (type == sgl::geometry_type::MULTI_POLYGON) {
+			part_type = sgl::geometry_type::POLYGON;
+		}
+
+		for (uint32_t part_idx = 0; part_idx < count; part_idx++) {
+			uint32_t part_count;
+			if (!TryMeasureWKB(cursor, layout, part_type, depth + 1, parts, part_count)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+//! Write a (sub)geometry that has already been validated by TryMeasureWKB. The part words go to the writer, and the
+//! vertices to the vertex writer, which is the same writer in version 0.
+void TranscodeWKB(WKBCursor &cursor, BinaryWriter &writer, BinaryWriter &vertex_writer, const WKBLayout &layout,
+                  const uint8_t version, const bool is_root, const bool has_bbox, sgl::box_xyzm &bbox) {
+	sgl::geometry_type type;
+	bool has_z;
+	bool has_m;
+	cursor.TryReadHeader(type, has_z, has_m);
+
+	// The type of the root is already stored in the header
+	if (!is_root) {
+		// The GeometryType enum used to start with POINT = 0
+		// but now it starts with INVALID = 0, so we need to subtract 1
+		writer.Write<uint32_t>(static_cast<uint32_t>(type) - 1);
+	}
+
+	switch (type) {
+	case sgl::geometry_type::POINT: {
+		const auto vertex = cursor.Reserve(layout.vertex_size);
+		const uint32_t count = IsEmptyPoint(vertex, layout) ? 0 : 1;
+		writer.Write<uint32_t>(count);
+		SerializeVertices(vertex_writer, reinterpret_cast<const uint8_t *>(vertex), count, layout.has_z, layout.has_m,
+		                  has_bbox, layout.vertex_size, bbox);
+	} break;
+	case sgl::geometry_type::LINESTRING: {
+		const auto count = cursor.ReadU32();
+		writer.Write<uint32_t>(count);
+		const auto verts = cursor.Reserve(static_cast<size_t>(count) * layout.vertex_size);
+		SerializeVertices(vertex_writer, reinterpret_cast<const uint8_t *>(verts), count, layout.has_z, layout.has_m,
+		                  has_bbox, layout.vertex_size, bbox);
+	} break;
+	case sgl::geometry_type::POLYGON: {
+		const auto count = cursor.ReadU32();
+		writer.Write<uint32_t>(count);
+
+		// The ring counts are interleaved with the vertices in WKB, but all come first here. Version 0 pads them.
+		auto ring_writer = writer;
+		writer.Skip(count * sizeof(uint32_t) + (version == 0 && count % 2 == 1 ? sizeof(uint32_t) : 0), true);
+		for (uint32_t ring_idx = 0; ring_idx < count; ring_idx++) {
+			const auto ring_count = cursor.ReadU32();
+			ring_writer.Write<uint32_t>(ring_count);
+			const auto verts = cursor.Reserve(static_cast<size_t>(ring_count) * layout.vertex_size);
+			SerializeVertices(vertex_writer, reinterpret_cast<const uint8_t *>(verts), ring_count, layout.has_z,
+			                  layout.has_m, has_bbox, layout.vertex_size, bbox);
+		}
+	} break;
+	default: {
+		const auto count = cursor.ReadU32();
+		writer.Write<uint32_t>(count);
+		for (uint32_t part_idx = 0; part_idx < count; part_idx++) {
+			TranscodeWKB(cursor, writer, vertex_writer, layout, version, false, has_bbox, bbox);
+		}
+	} break;
+	}
+}
+
+} // namespace
+
+bool Serde::TryFromWKB(const char *wkb, size_t wkb_size, bool nan_as_empty, Vector &result, string_t &blob,
+                       const uint8_t requested_version) {
+	const auto wkb_end = wkb + wkb_size;
+
+	// Read the root header to find out the vertex layout
+	sgl::geometry_type type;
+	WKBLayout layout = {};
+	layout.nan_as_empty = nan_as_empty;
+	if (!WKBCursor(wkb, wkb_end).TryReadHeader(type, layout.has_z, layout.has_m)) {
+		return false;
+	}
+	layout.vertex_size = static_cast<uint32_t>(sizeof(double) * (2 + layout.has_z + layout.has_m));
+
+	// First pass: validate and measure
+	WKBCursor measure_cursor(wkb, wkb_end);
+	PartLayout parts;
+	uint32_t root_count = 0;
+	if (!TryMeasureWKB(measure_cursor, layout, sgl::geometry_type::INVALID, 0, parts, root_count)) {
+		return false;
+	}
+	// The type of the root is stored in the header instead
+	parts.word_count--;
+
+	const auto has_bbox = type != sgl::geometry_type::POINT && root_count != 0;
+	const auto dims = 2 + (layout.has_z ? 1 : 0) + (layout.has_m ? 1 : 0);
+	const auto bbox_size = has_bbox ? dims * sizeof(float) * 2 : 0;
+	const auto words_end = GetWordsEnd(bbox_size, parts.word_count);
+	const auto version = GetGeometryWriteVersion(requested_version, parts.word_count, words_end);
+	const auto vertex_offset = GetVertexOffset(version, words_end, parts);
+	const auto size = vertex_offset + parts.vertex_count * layout.vertex_size;
+
+	// Second pass: write the serialized geometry
+	blob = StringVector::EmptyString(result, size);
+	BinaryWriter writer(blob.GetDataWriteable(), size);
+
+	GeometryProperties props(layout.has_z, layout.has_m);
+	props.SetBBox(has_bbox);
+	props.SetVersion(version);
+
+	writer.Write<uint8_t>(static_cast<uint8_t>(type) - 1);
+	writer.Write<uint8_t>(props.GetFlags());
+	writer.Write<uint16_t>(0); // unused for now
+	writer.Write<uint32_t>(0); // padding
+
+	auto bbox_writer = writer;
+	writer.Skip(bbox_size, true);
+
+	// Version 0 stores the type of the root here, version 1 the word count from the first pass
+	writer.Write<uint32_t>(version == 0 ? static_cast<uint32_t>(type) - 1 : static_cast<uint32_t>(parts.word_count));
+	BinaryWriter stream_writer(blob.GetDataWriteable() + vertex_offset, size - vertex_offset);
+	auto &vertex_writer = version == 0 ? writer : stream_writer;
+
+	sgl::box_xyzm bbox = sgl::box_xyzm::smallest();
+	WKBCursor write_cursor(wkb, wkb_end);
+	TranscodeWKB(write_cursor, writer, vertex_writer, layout, version, true, has_bbox, bbox);
+
+	// The part words and the vertex stream went through separate writers, zero the gap between them
+	if (version != 0) {
+		writer.Skip(vertex_offset - words_end, true);
+	}
+
+	if (has_bbox) {
+		SerializeBounds(bbox_writer, bbox, layout.has_z, layout.has_m);
+	}
 
-	// Deserialize the geometry
-	DeserializeRecursive(cursor, result, has_z, has_m, arena);
+	blob.Finalize();
+	return true;
 }
 
-} // namespace duckdb
\ No newline at end of file
+} // namespace duckdb
@@ -1,20 +1,52 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 namespace sgl {
 class geometry;
+struct box_xy;
 }
 
 namespace duckdb {
 
 class ArenaAllocator;
+class Vector;
+struct string_t;
+struct ValidityMask;
 
 // todo:
 struct Serde {
-	static size_t GetRequiredSize(const sgl::geometry &geom);
-	static void Serialize(const sgl::geometry &geom, char *buffer, size_t buffer_size);
+	//! Geometries are written in version 0, unless a newer version is asked for (see GetGeometryWriteVersion). The same
+	//! version has to be passed to both.
+	static size_t GetRequiredSize(const sgl::geometry &geom, uint8_t version = 0);
+	static void Serialize(const sgl::geometry &geom, char *buffer, size_t buffer_size, uint8_t version = 0);
 	static void Deserialize(sgl::geometry &result, ArenaAllocator &arena, const char *buffer, size_t buffer_size);
+	//! Compute the exact xy extent of a serialized geometry by scanning its vertices in place, without allocating.
+	//! Grows the given box, and returns false if the geometry has no vertices.
+	static bool TryGetExtentXY(const char *buffer, size_t buffer_size, sgl::box_xy &result);
+	//! Locate the vertex stream of a serialized geometry, which holds the vertices of all parts in preorder. Returns
+	//! false for polygons and non-empty collections in version 0, where the vertices are interleaved with the part
+	//! headers.
+	static bool TryGetVertexStream(const char *buffer, size_t buffer_size, size_t &offset, size_t &count);
+	//! Recompute the cached bounding box of a serialized geometry after its vertex stream was modified in place
+	static void UpdateBounds(char *buffer, size_t buffer_size);
+	//! Convert a WKB blob directly into a serialized geometry in the result vector, without building an sgl::geometry.
+	//! Only handles little-endian WKB where all parts share the vertex layout of the root. Returns false for anything
+	//! else, including invalid WKB, which then has to go through the sgl WKB reader instead.
+	static bool TryFromWKB(const char *wkb, size_t wkb_size, bool nan_as_empty, Vector &result, string_t &blob,
+	                       uint8_t version = 0);
+
+	//! The size of a serialized (non-empty) 2D point, which is the same in both versions
+	static constexpr size_t POINT_XY_SIZE = 32;
+	//! Serialize the 2D points (x[i], y[i]) into the result vector, byte-for-byte the same as Serialize(), but in a
+	//! single allocation for all of them. Rows where x or y is NULL, or that are not valid in the given validity, are
+	//! NULL. If both x and y are constant, so is the result.
+	static void SerializePointsXY(Vector &x, Vector &y, Vector &result, size_t count,
+	                              const ValidityMask *validity = nullptr);
+	//! Read the coordinates of a serialized, non-empty 2D point at their fixed offsets, without deserializing it.
+	//! Returns false for anything else (other types, empty points, points with Z or M), which has to be deserialized.
+	static bool TryGetPointXY(const char *buffer, size_t buffer_size, double &x, double &y);
 };
 
 } // namespace duckdb
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "spatial/geometry/geometry_stats.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/spatial_types.hpp"
+
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/storage/statistics/string_stats.hpp"
+
+namespace duckdb {
+
+//------------------------------------------------------------------------
+// Statistics -> GeometryStats
+//------------------------------------------------------------------------
+// The min/max strings are cut off at the first zero byte, so an empty
+// string means that the first byte (the geometry type) is zero, i.e. POINT
+static GeometryType GetTypeFromPrefix(const string &prefix) {
+	if (prefix.empty()) {
+		return GeometryType::POINT;
+	}
+	const auto type = static_cast<uint8_t>(prefix[0]);
+	if (type > static_cast<uint8_t>(GeometryType::GEOMETRYCOLLECTION)) {
+		return GeometryType::GEOMETRYCOLLECTION;
+	}
+	return static_cast<GeometryType>(type);
+}
+
+GeometryStats GeometryStats::FromStatistics(const BaseStatistics &stats) {
+	GeometryStats result;
+	if (stats.GetStatsType() != StatisticsType::STRING_STATS) {
+		return result;
+	}
+	const auto min = StringStats::Min(stats);
+	const auto max = StringStats::Max(stats);
+	result.min_type = GetTypeFromPrefix(min);
+	result.max_type = GetTypeFromPrefix(max);
+	if (StringStats::HasMaxStringLength(stats)) {
+		result.max_size = StringStats::MaxStringLength(stats);
+	}
+	result.can_have_null = stats.CanHaveNull();
+
+	// If all geometries have the same type, the flags of every geometry lie between those of the min and max. The
+	// bounding box flag sits right above the Z and M flags, so if the min and max only differ in those, and the min
+	// has a bounding box, so does every geometry. Which means that none of them is empty.
+	if (min.size() > 1 && max.size() > 1 && min[0] == max[0]) {
+		const auto min_flags = static_cast<uint8_t>(min[1]);
+		const auto max_flags = static_cast<uint8_t>(max[1]);
+		if ((min_flags >> 2) == (max_flags >> 2) && GeometryProperties(min_flags).HasBBox()) {
+			result.can_have_empty = false;
+		}
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------
+// Function Statistics
+//------------------------------------------------------------------------
+unique_ptr<BaseStatistics> GeometryStats::CreateStatistics(const sgl::geometry &geom,
+                                                           const vector<BaseStatistics> &args) {
+	// Serialize the example geometry, a point or an envelope only takes a few bytes
+	vector<char> buffer(Serde::GetRequiredSize(geom));
+	Serde::Serialize(geom, buffer.data(), buffer.size());
+
+	auto stats = StringStats::CreateEmpty(GeoTypes::GEOMETRY());
+	StringStats::Update(stats, string_t(buffer.data(), UnsafeNumericCast<uint32_t>(buffer.size())));
+
+	auto can_have_null = false;
+	for (auto &arg : args) {
+		can_have_null |= arg.CanHaveNull();
+	}
+	stats.Set(can_have_null ? StatsInfo::CAN_HAVE_NULL_AND_VALID_VALUES : StatsInfo::CANNOT_HAVE_NULL_VALUES);
+	return stats.ToUnique();
+}
+
+//------------------------------------------------------------------------
+// Plan Statistics
+//------------------------------------------------------------------------
+static unique_ptr<BaseStatistics> GetColumnStatistics(ClientContext &context, LogicalOperator &op,
+                                                      const ColumnBinding &binding);
+
+static unique_ptr<BaseStatistics> GetExpressionStatistics(ClientContext &context, LogicalOperator &op,
+                                                          Expression &expr) {
+	switch (expr.GetExpressionClass()) {
+	case ExpressionClass::BOUND_COLUMN_REF:
+		return GetColumnStatistics(context, op, expr.Cast<BoundColumnRefExpression>().binding);
+	case ExpressionClass::BOUND_FUNCTION: {
+		auto &func = expr.Cast<BoundFunctionExpression>();
+		if (!func.function.statistics) {
+			return nullptr;
+		}
+		// The geometry functions with statistics do not depend on the statistics of their arguments, other than
+		// for their validity, so dont bother deriving those
+		vector<BaseStatistics> child_stats;
+		for (auto &child : func.children) {
+			child_stats.push_back(BaseStatistics::CreateUnknown(child->return_type));
+		}
+		FunctionStatisticsInput input(func, func.bind_info.get(), child_stats, nullptr);
+		return func.function.statistics(context, input);
+	}
+	default:
+		return nullptr;
+	}
+}
+
+static unique_ptr<BaseStatistics> GetColumnStatistics(ClientContext &context, LogicalOperator &op,
+                                                      const ColumnBinding &binding) {
+	switch (op.type) {
+	case LogicalOperatorType::LOGICAL_GET: {
+		auto &get = op.Cast<LogicalGet>();
+		if (get.table_index != binding.table_index || !get.function.statistics) {
+			return nullptr;
+		}
+		auto &column_ids = get.GetColumnIds();
+		if (binding.column_index >= column_ids.size() || column_ids[binding.column_index].IsRowIdColumn()) {
+			return nullptr;
+		}
+		return get.function.statistics(context, get.bind_data.get(),
+		                               column_ids[binding.column_index].GetPrimaryIndex());
+	}
+	case LogicalOperatorType::LOGICAL_PROJECTION: {
+		auto &proj = op.Cast<LogicalProjection>();
+		if (proj.table_index != binding.table_index) {
+			break;
+		}
+		if (binding.column_index >= proj.expressions.size()) {
+			return nullptr;
+		}
+		return GetExpressionStatistics(context, *proj.children[0], *proj.expressions[binding.column_index]);
+	}
+	default:
+		break;
+	}
+
+	// Bindings are unique within a plan, so look for the operator that produces it. Filters, joins etc. pass the
+	// columns of their children through unchanged, and only ever remove values, so the statistics still hold.
+	for (auto &child : op.children) {
+		auto stats = GetColumnStatistics(context, *child, binding);
+		if (stats) {
+			return stats;
+		}
+	}
+	return nullptr;
+}
+
+unique_ptr<BaseStatistics> GeometryStats::GetStatistics(ClientContext &context, LogicalOperator &op, Expression &expr) {
+	return GetExpressionStatistics(context, op, expr);
+}
+
+bool GeometryStats::TryGetStatistics(ClientContext &context, LogicalOperator &op, Expression &expr,
+                                     GeometryStats &result) {
+	if (expr.return_type != GeoTypes::GEOMETRY()) {
+		return false;
+	}
+	const auto stats = GetExpressionStatistics(context, op, expr);
+	if (!stats) {
+		return false;
+	}
+	result = FromStatistics(*stats);
+	return true;
+}
+
+} // namespace duckdb
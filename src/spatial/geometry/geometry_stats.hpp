@@ -0,0 +1,60 @@
+#pragma once
+
+#include "spatial/geometry/geometry_type.hpp"
+#include "duckdb/common/unique_ptr.hpp"
+#include "duckdb/common/vector.hpp"
+
+namespace sgl {
+class geometry;
+}
+
+namespace duckdb {
+
+class BaseStatistics;
+class ClientContext;
+class Expression;
+class LogicalOperator;
+
+//------------------------------------------------------------------------
+// GeometryStats
+//------------------------------------------------------------------------
+// GEOMETRY is a BLOB, so the statistics DuckDB keeps for geometry columns
+// are string statistics. Their min/max cover the first bytes of the
+// serialized geometries, which start with the geometry type, so they
+// bound the set of geometry types in the column. Together with the
+// maximum blob size, this tells e.g. whether a column only holds points
+// (and how large they are) without looking at the data. The flags that
+// follow the type tell whether the geometries have a bounding box, which
+// all geometries but points and empty geometries have.
+//------------------------------------------------------------------------
+struct GeometryStats {
+	//! The range of geometry types that may occur
+	GeometryType min_type = GeometryType::POINT;
+	GeometryType max_type = GeometryType::GEOMETRYCOLLECTION;
+	//! The maximum size of a serialized geometry, or 0 if unknown
+	idx_t max_size = 0;
+	//! Whether there may be NULL values
+	bool can_have_null = true;
+	//! Whether there may be empty geometries
+	bool can_have_empty = true;
+
+	bool IsPointsOnly() const {
+		return max_type == GeometryType::POINT;
+	}
+
+	//! Interpret the (string) statistics of a GEOMETRY column or expression
+	static GeometryStats FromStatistics(const BaseStatistics &stats);
+
+	//! Create the statistics of a function that always returns geometries with the same type and size as the given
+	//! one, and returns NULL if any of its arguments is NULL
+	static unique_ptr<BaseStatistics> CreateStatistics(const sgl::geometry &geom, const vector<BaseStatistics> &args);
+
+	//! Try to derive the statistics of a GEOMETRY expression evaluated on top of the given operator, either from
+	//! the statistics of the table column it references, or from the statistics of the function that produces it.
+	static bool TryGetStatistics(ClientContext &context, LogicalOperator &op, Expression &expr,
+	                             GeometryStats &result);
+	//! Like TryGetStatistics, but returns the statistics of an expression of any type as they are, or nullptr
+	static unique_ptr<BaseStatistics> GetStatistics(ClientContext &context, LogicalOperator &op, Expression &expr);
+};
+
+} // namespace duckdb
@@ -125,10 +125,17 @@ public:
 		if (header_type == GeometryType::POINT) {
 			cursor.Skip(4); // skip padding
 
-			// Read the point
-			auto type = cursor.Read<SerializedGeometryType>();
-			D_ASSERT(type == SerializedGeometryType::POINT);
-			(void)type;
+			if (properties.GetVersion() == 0) {
+				// Read the point
+				auto type = cursor.Read<SerializedGeometryType>();
+				D_ASSERT(type == SerializedGeometryType::POINT);
+				(void)type;
+			} else {
+				// Points only have a single part word (the vertex count), so the vertex stream starts right after it
+				auto word_count = cursor.Read<uint32_t>();
+				D_ASSERT(word_count == 1);
+				(void)word_count;
+			}
 
 			auto count = cursor.Read<uint32_t>();
 			if (count == 0) {
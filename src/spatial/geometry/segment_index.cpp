@@ -0,0 +1,265 @@
+#include "spatial/geometry/segment_index.hpp"
+#include "spatial/geometry/geometry_cursor.hpp"
+
+#include "duckdb/common/algorithm.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// The max number of layers of a tree over less than 2^32 segments, plus one for the segments
+constexpr idx_t MAX_LAYER_COUNT = 10;
+
+// The relative slack when pruning nodes by their distance, as the distances of the boxes and segments are rounded
+constexpr double DISTANCE_SLACK = 1e-9;
+
+struct StackEntry {
+	idx_t layer_idx;
+	idx_t entry_idx;
+};
+
+} // namespace
+
+SegmentIndex::SegmentIndex(const string_t &blob) {
+	GeometryCursor cursor(blob);
+	is_polygonal =
+	    cursor.GetType() == sgl::geometry_type::POLYGON || cursor.GetType() == sgl::geometry_type::MULTI_POLYGON;
+
+	GeometryPart part;
+	while (cursor.Next(part)) {
+		const auto &span = part.vertices;
+		switch (part.type) {
+		case sgl::geometry_type::POLYGON:
+			polygon_count++;
+			break;
+		case sgl::geometry_type::POINT:
+			if (span.count != 0) {
+				// Points are zero-length segments, which are at the same distance as the point itself
+				const auto vertex = span.GetXY(0);
+				const PointXY<double> p(vertex.x, vertex.y);
+				segments.push_back({p, p, NO_RING});
+			}
+			break;
+		case sgl::geometry_type::LINESTRING: {
+			auto ring = NO_RING;
+			if (part.is_ring) {
+				ring = UnsafeNumericCast<uint32_t>(rings.size());
+				rings.push_back({UnsafeNumericCast<uint32_t>(polygon_count - 1), part.index == 0});
+			}
+			for (uint32_t i = 1; i < span.count; i++) {
+				const auto a = span.GetXY(i - 1);
+				const auto b = span.GetXY(i);
+				segments.push_back({PointXY<double>(a.x, a.y), PointXY<double>(b.x, b.y), ring});
+			}
+		} break;
+		default:
+			// Collections have no vertices of their own
+			break;
+		}
+	}
+
+	Build();
+}
+
+void SegmentIndex::Build() {
+	const auto segment_count = segments.size();
+	if (segment_count == 0) {
+		return;
+	}
+
+	// Sort the segments along the hilbert curve through the centers of their boxes
+	Box2D<double> extent;
+	for (const auto &segment : segments) {
+		extent.Union(GetBox(segment));
+	}
+
+	constexpr auto max_hilbert = static_cast<double>(NumericLimits<uint16_t>::Maximum());
+	const auto width = extent.max.x - extent.min.x;
+	const auto height = extent.max.y - extent.min.y;
+	const auto scale_x = width > 0 ? max_hilbert / width : 0.0;
+	const auto scale_y = height > 0 ? max_hilbert / height : 0.0;
+
+	vector<std::pair<uint32_t, uint32_t>> curve(segment_count);
+	for (idx_t i = 0; i < segment_count; i++) {
+		const auto center = GetBox(segments[i]).Center();
+		const auto hx = std::min(max_hilbert, std::max(0.0, scale_x * (center.x - extent.min.x)));
+		const auto hy = std::min(max_hilbert, std::max(0.0, scale_y * (center.y - extent.min.y)));
+		curve[i] = {sgl::util::hilbert_encode(16, static_cast<uint32_t>(hx), static_cast<uint32_t>(hy)),
+		            UnsafeNumericCast<uint32_t>(i)};
+	}
+	std::sort(curve.begin(), curve.end());
+
+	vector<Segment> sorted;
+	sorted.reserve(segment_count);
+	for (const auto &entry : curve) {
+		sorted.push_back(segments[entry.second]);
+	}
+	segments = std::move(sorted);
+
+	// Pack the node layers bottom-up, until there is a single root
+	layer_sizes.push_back(segment_count);
+	while (layer_sizes.back() > 1) {
+		const auto layer_idx = layer_sizes.size() - 1;
+		const auto child_count = layer_sizes.back();
+		const auto node_count = (child_count + NODE_SIZE - 1) / NODE_SIZE;
+
+		layer_offsets.push_back(node_boxes.size());
+		for (idx_t node_idx = 0; node_idx < node_count; node_idx++) {
+			Box2D<double> node_box;
+			const auto child_end = MinValue((node_idx + 1) * NODE_SIZE, child_count);
+			for (auto child_idx = node_idx * NODE_SIZE; child_idx < child_end; child_idx++) {
+				node_box.Union(GetEntryBox(layer_idx, child_idx));
+			}
+			node_boxes.push_back(node_box);
+		}
+		layer_sizes.push_back(node_count);
+	}
+	D_ASSERT(layer_sizes.size() <= MAX_LAYER_COUNT);
+}
+
+NativeLocation SegmentIndex::Locate(const PointXY<double> &p) const {
+	if (rings.empty()) {
+		return NativeLocation::EXTERIOR;
+	}
+
+	// Collect the rings crossed by the ray to the right of the point, by visiting all segments whose box the ray hits
+	vector<uint32_t> crossings;
+
+	StackEntry stack[MAX_LAYER_COUNT * NODE_SIZE];
+	idx_t depth = 0;
+	stack[depth++] = {layer_sizes.size() - 1, 0};
+
+	while (depth > 0) {
+		const auto entry = stack[--depth];
+		const auto box = GetEntryBox(entry.layer_idx, entry.entry_idx);
+		if (box.max.x < p.x || box.min.y > p.y || box.max.y < p.y) {
+			continue;
+		}
+
+		if (entry.layer_idx == 0) {
+			const auto &segment = segments[entry.entry_idx];
+			if (segment.ring == NO_RING) {
+				continue;
+			}
+			const auto location = TestRayCrossing(p, segment.a, segment.b);
+			if (location == NativeLocation::BOUNDARY || location == NativeLocation::UNKNOWN) {
+				return location;
+			}
+			if (location == NativeLocation::INTERIOR) {
+				crossings.push_back(segment.ring);
+			}
+			continue;
+		}
+
+		const auto child_layer = entry.layer_idx - 1;
+		const auto child_end = MinValue((entry.entry_idx + 1) * NODE_SIZE, layer_sizes[child_layer]);
+		for (auto child_idx = entry.entry_idx * NODE_SIZE; child_idx < child_end; child_idx++) {
+			stack[depth++] = {child_layer, child_idx};
+		}
+	}
+
+	// The point is inside a ring if the ray crosses it an odd number of times. The rings of a polygon are numbered
+	// consecutively, so after sorting the crossed rings of each polygon are next to each other.
+	std::sort(crossings.begin(), crossings.end());
+
+	auto polygon = NO_RING;
+	auto in_shell = false;
+	auto in_hole = false;
+	for (idx_t i = 0; i < crossings.size();) {
+		const auto ring_idx = crossings[i];
+		auto j = i;
+		while (j < crossings.size() && crossings[j] == ring_idx) {
+			j++;
+		}
+		if ((j - i) % 2 == 1) {
+			const auto &ring = rings[ring_idx];
+			if (ring.polygon != polygon) {
+				if (in_shell && !in_hole) {
+					return NativeLocation::INTERIOR;
+				}
+				polygon = ring.polygon;
+				in_shell = false;
+				in_hole = false;
+			}
+			if (ring.is_shell) {
+				in_shell = true;
+			} else {
+				in_hole = true;
+			}
+		}
+		i = j;
+	}
+	return in_shell && !in_hole ? NativeLocation::INTERIOR : NativeLocation::EXTERIOR;
+}
+
+bool SegmentIndex::TryGetDistance(const PointXY<double> &p, double &result) const {
+	if (segments.empty()) {
+		return false;
+	}
+
+	// GEOS considers the distance to be zero if the point is inside a polygon
+	const auto location = Locate(p);
+	if (location == NativeLocation::UNKNOWN) {
+		return false;
+	}
+	if (location != NativeLocation::EXTERIOR) {
+		result = 0.0;
+		return true;
+	}
+
+	// Visit the nodes depth-first, nearest child first, skipping the nodes further away than the nearest segment so far.
+	// All segments that may be the nearest are visited, so the minimum is the same as the one GEOS computes.
+	auto min_distance = NumericLimits<double>::Maximum();
+	auto max_distance_sq = NumericLimits<double>::Maximum();
+
+	StackEntry stack[MAX_LAYER_COUNT * NODE_SIZE];
+	idx_t depth = 0;
+	stack[depth++] = {layer_sizes.size() - 1, 0};
+
+	while (depth > 0) {
+		const auto entry = stack[--depth];
+
+		if (entry.layer_idx == 0) {
+			const auto &segment = segments[entry.entry_idx];
+			if (GetDistanceSquared(p, GetBox(segment)) > max_distance_sq) {
+				continue;
+			}
+			const auto distance = PointToSegmentDistance(p, segment.a, segment.b);
+			if (distance < min_distance) {
+				min_distance = distance;
+				if (min_distance == 0.0) {
+					break;
+				}
+				max_distance_sq = min_distance * min_distance * (1 + DISTANCE_SLACK);
+			}
+			continue;
+		}
+
+		if (GetDistanceSquared(p, GetEntryBox(entry.layer_idx, entry.entry_idx)) > max_distance_sq) {
+			continue;
+		}
+
+		// Push the children in order of decreasing distance, so that the nearest one is visited first
+		const auto child_layer = entry.layer_idx - 1;
+		const auto child_beg = entry.entry_idx * NODE_SIZE;
+		const auto child_end = MinValue(child_beg + NODE_SIZE, layer_sizes[child_layer]);
+
+		std::pair<double, idx_t> children[NODE_SIZE];
+		idx_t child_count = 0;
+		for (auto child_idx = child_beg; child_idx < child_end; child_idx++) {
+			const auto distance_sq = GetDistanceSquared(p, GetEntryBox(child_layer, child_idx));
+			if (distance_sq <= max_distance_sq) {
+				children[child_count++] = {distance_sq, child_idx};
+			}
+		}
+		std::sort(children, children + child_count);
+		for (idx_t i = child_count; i-- > 0;) {
+			stack[depth++] = {child_layer, children[i].second};
+		}
+	}
+
+	result = min_distance;
+	return true;
+}
+
+} // namespace duckdb
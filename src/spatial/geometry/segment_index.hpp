@@ -0,0 +1,233 @@
+#pragma once
+
+#include "spatial/geometry/bbox.hpp"
+#include "spatial/geometry/vertex.hpp"
+
+#include "duckdb/common/types/string_type.hpp"
+#include "duckdb/common/vector.hpp"
+
+namespace duckdb {
+
+//! The location of a point relative to the areal parts of a geometry
+enum class NativeLocation : uint8_t { INTERIOR, BOUNDARY, EXTERIOR, UNKNOWN };
+
+//! The orientation of q relative to the segment p1-p2, using the floating point filter of GEOS' orientation index.
+//! Returns false if the filter can't decide the orientation.
+inline bool TryGetOrientation(const PointXY<double> &p1, const PointXY<double> &p2, const PointXY<double> &q,
+                              int32_t &result) {
+	const auto detleft = (p1.x - q.x) * (p2.y - q.y);
+	const auto detright = (p1.y - q.y) * (p2.x - q.x);
+	const auto det = detleft - detright;
+	const auto sign = (det > 0) - (det < 0);
+
+	double detsum;
+	if (detleft > 0) {
+		if (detright <= 0) {
+			result = sign;
+			return true;
+		}
+		detsum = detleft + detright;
+	} else if (detleft < 0) {
+		if (detright >= 0) {
+			result = sign;
+			return true;
+		}
+		detsum = -detleft - detright;
+	} else {
+		result = sign;
+		return true;
+	}
+
+	static constexpr double DP_SAFE_EPSILON = 1e-15;
+	const auto errbound = DP_SAFE_EPSILON * detsum;
+	if (det >= errbound || -det >= errbound) {
+		result = sign;
+		return true;
+	}
+	return false;
+}
+
+//! The ray crossing test of a single ring segment p1-p2 for the point p, the same way GEOS counts crossings of a ray
+//! to the right. Returns BOUNDARY if p is on the segment, UNKNOWN if the orientation filter can't decide, and
+//! INTERIOR if the ray crosses the segment, EXTERIOR otherwise.
+inline NativeLocation TestRayCrossing(const PointXY<double> &p, const PointXY<double> &p1, const PointXY<double> &p2) {
+	// The segment is entirely to the left of the point
+	if (p1.x < p.x && p2.x < p.x) {
+		return NativeLocation::EXTERIOR;
+	}
+	if (p.x == p2.x && p.y == p2.y) {
+		return NativeLocation::BOUNDARY;
+	}
+	// Horizontal segments only matter if the point is on them
+	if (p1.y == p.y && p2.y == p.y) {
+		if (p.x >= std::min(p1.x, p2.x) && p.x <= std::max(p1.x, p2.x)) {
+			return NativeLocation::BOUNDARY;
+		}
+		return NativeLocation::EXTERIOR;
+	}
+	if ((p1.y > p.y && p2.y <= p.y) || (p2.y > p.y && p1.y <= p.y)) {
+		int32_t orientation;
+		if (!TryGetOrientation(p1, p2, p, orientation)) {
+			return NativeLocation::UNKNOWN;
+		}
+		if (orientation == 0) {
+			return NativeLocation::BOUNDARY;
+		}
+		if (p2.y < p1.y) {
+			orientation = -orientation;
+		}
+		if (orientation > 0) {
+			return NativeLocation::INTERIOR;
+		}
+	}
+	return NativeLocation::EXTERIOR;
+}
+
+//! Locate a point relative to a ring of 'count' vertices by counting crossings of a ray to the right, the same way GEOS
+//! does. The vertices are fetched with get_vertex(i).
+template <class GET_VERTEX>
+NativeLocation LocateInRing(const PointXY<double> &p, const idx_t count, GET_VERTEX &&get_vertex) {
+	idx_t crossings = 0;
+	for (idx_t i = 1; i < count; i++) {
+		const auto location = TestRayCrossing(p, get_vertex(i - 1), get_vertex(i));
+		if (location == NativeLocation::BOUNDARY || location == NativeLocation::UNKNOWN) {
+			return location;
+		}
+		if (location == NativeLocation::INTERIOR) {
+			crossings++;
+		}
+	}
+	return crossings % 2 == 1 ? NativeLocation::INTERIOR : NativeLocation::EXTERIOR;
+}
+
+//! Locate a point relative to a polygon of 'ring_count' rings, the shell first. locate_ring(i) locates the point
+//! relative to ring i, and is only called for the rings that are needed.
+template <class LOCATE_RING>
+NativeLocation LocateInRings(const uint32_t ring_count, LOCATE_RING &&locate_ring) {
+	if (ring_count == 0) {
+		return NativeLocation::EXTERIOR;
+	}
+	for (uint32_t ring_idx = 0; ring_idx < ring_count; ring_idx++) {
+		const auto location = locate_ring(ring_idx);
+		if (location == NativeLocation::UNKNOWN || location == NativeLocation::BOUNDARY) {
+			return location;
+		}
+		if (ring_idx == 0) {
+			// Outside the shell
+			if (location == NativeLocation::EXTERIOR) {
+				return location;
+			}
+		} else if (location == NativeLocation::INTERIOR) {
+			// Inside a hole
+			return NativeLocation::EXTERIOR;
+		}
+	}
+	return NativeLocation::INTERIOR;
+}
+
+inline double PointToPointDistance(const PointXY<double> &p, const PointXY<double> &q) {
+	const auto dx = p.x - q.x;
+	const auto dy = p.y - q.y;
+	return std::sqrt(dx * dx + dy * dy);
+}
+
+//! The distance from p to the segment a-b, same as geos::algorithm::Distance::pointToSegment
+inline double PointToSegmentDistance(const PointXY<double> &p, const PointXY<double> &a, const PointXY<double> &b) {
+	if (a.x == b.x && a.y == b.y) {
+		return PointToPointDistance(p, a);
+	}
+	const auto len2 = (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y);
+	const auto r = ((p.x - a.x) * (b.x - a.x) + (p.y - a.y) * (b.y - a.y)) / len2;
+	if (r <= 0.0) {
+		return PointToPointDistance(p, a);
+	}
+	if (r >= 1.0) {
+		return PointToPointDistance(p, b);
+	}
+	const auto s = ((a.y - p.y) * (b.x - a.x) - (a.x - p.x) * (b.y - a.y)) / len2;
+	return std::fabs(s) * std::sqrt(len2);
+}
+
+//! A packed Hilbert R-tree over the segments of a serialized geometry, to evaluate point-in-polygon tests and point
+//! distances against a huge constant geometry (e.g. a coastline) without looking at all of its vertices.
+//! The layout is the same as the FlatRTree of the spatial join: the segments are sorted along the hilbert curve and
+//! form the leaf layer, and the node layers are stored bottom-up in a single array, with node i of a layer covering
+//! the entries [i * NODE_SIZE, (i + 1) * NODE_SIZE) of the layer below. The index is immutable once built, so it can
+//! be shared by all threads.
+class SegmentIndex {
+public:
+	static constexpr idx_t NODE_SIZE = 16;
+	//! The ring of segments that are not part of a polygon
+	static constexpr uint32_t NO_RING = NumericLimits<uint32_t>::Maximum();
+
+	//! Build the index over all linestrings, polygon rings and points (as zero-length segments) of the geometry
+	explicit SegmentIndex(const string_t &blob);
+
+	idx_t GetSegmentCount() const {
+		return segments.size();
+	}
+
+	//! The number of bytes allocated by the index
+	idx_t GetMemoryUsage() const {
+		return sizeof(SegmentIndex) + segments.capacity() * sizeof(Segment) +
+		       node_boxes.capacity() * sizeof(Box2D<double>) + rings.capacity() * sizeof(Ring);
+	}
+
+	//! Whether the geometry is a polygon or multipolygon, i.e. only has areal parts
+	bool IsPolygonal() const {
+		return is_polygonal;
+	}
+
+	//! Locate a point relative to the polygons of the geometry, the same way as GEOS does. Like GEOS, a point is in the
+	//! interior of a polygon if it is inside the shell but not inside any of the holes. Returns UNKNOWN if GEOS would
+	//! need extended precision to decide.
+	NativeLocation Locate(const PointXY<double> &p) const;
+
+	//! The distance from a point to the geometry, computed the same way as GEOS does. Returns false if the point is so
+	//! close to the boundary of a polygon that GEOS has to decide whether it is inside
+	bool TryGetDistance(const PointXY<double> &p, double &result) const;
+
+private:
+	struct Segment {
+		PointXY<double> a;
+		PointXY<double> b;
+		uint32_t ring;
+	};
+
+	struct Ring {
+		uint32_t polygon;
+		bool is_shell;
+	};
+
+	static Box2D<double> GetBox(const Segment &segment) {
+		return Box2D<double>(PointXY<double>(std::min(segment.a.x, segment.b.x), std::min(segment.a.y, segment.b.y)),
+		                     PointXY<double>(std::max(segment.a.x, segment.b.x), std::max(segment.a.y, segment.b.y)));
+	}
+
+	//! The smallest squared distance between a point and a box
+	static double GetDistanceSquared(const PointXY<double> &p, const Box2D<double> &box) {
+		const auto dx = std::max(0.0, std::max(box.min.x - p.x, p.x - box.max.x));
+		const auto dy = std::max(0.0, std::max(box.min.y - p.y, p.y - box.max.y));
+		return dx * dx + dy * dy;
+	}
+
+	void Build();
+
+	//! The box of an entry of the given layer, where layer 0 are the segments
+	Box2D<double> GetEntryBox(idx_t layer_idx, idx_t entry_idx) const {
+		return layer_idx == 0 ? GetBox(segments[entry_idx]) : node_boxes[layer_offsets[layer_idx - 1] + entry_idx];
+	}
+
+	//! The number of entries of each layer, from the segments up to the root
+	vector<idx_t> layer_sizes;
+	//! The offset of each node layer (i.e. layer 1 and up) in node_boxes
+	vector<idx_t> layer_offsets;
+	vector<Box2D<double>> node_boxes;
+	vector<Segment> segments;
+
+	vector<Ring> rings;
+	idx_t polygon_count = 0;
+	bool is_polygonal = false;
+};
+
+} // namespace duckdb
@@ -0,0 +1,135 @@
+#include "spatial/geometry/segment_index_cache.hpp"
+#include "spatial/geometry/geometry_cursor.hpp"
+
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+namespace duckdb {
+
+namespace {
+
+template <class ENTRY>
+bool IsSameGeometry(const ENTRY &entry, const string_t &blob) {
+	return entry.blob.size() == blob.GetSize() && memcmp(entry.blob.data(), blob.GetData(), blob.GetSize()) == 0;
+}
+
+} // namespace
+
+SegmentIndexCache::SegmentIndexCache(BufferPool &pool)
+    : capacity(DEFAULT_CAPACITY), reservation(MemoryTag::EXTENSION, pool) {
+}
+
+SegmentIndexCache::~SegmentIndexCache() {
+	lock_guard<mutex> guard(lock);
+	Shrink(0);
+}
+
+shared_ptr<SegmentIndexCache> SegmentIndexCache::Get(ClientContext &context) {
+	auto &object_cache = ObjectCache::GetObjectCache(context);
+	auto result = object_cache.GetOrCreate<SegmentIndexCache>(
+	    ObjectType(), BufferManager::GetBufferManager(context).GetBufferPool());
+
+	Value capacity_value;
+	if (context.TryGetCurrentSetting(SETTING_NAME, capacity_value)) {
+		const auto new_capacity = capacity_value.GetValue<idx_t>();
+		if (new_capacity != result->capacity.load()) {
+			result->SetCapacity(new_capacity);
+		}
+	}
+	return result;
+}
+
+void SegmentIndexCache::Register(DatabaseInstance &db) {
+	db.config.AddExtensionOption(SETTING_NAME,
+	                             "The number of bytes of spatial indexes over large geometries that are cached across "
+	                             "queries. 0 disables the cache",
+	                             LogicalType::UBIGINT, Value::UBIGINT(DEFAULT_CAPACITY));
+}
+
+void SegmentIndexCache::SetCapacity(idx_t capacity_p) {
+	lock_guard<mutex> guard(lock);
+	capacity = capacity_p;
+	Shrink(capacity_p);
+}
+
+shared_ptr<SegmentIndex> SegmentIndexCache::GetIndex(const string_t &blob, bool always_build) {
+	// Skip the geometries that are obviously too small before looking at them
+	if (blob.GetSize() < MIN_VERTEX_COUNT * 2 * sizeof(double)) {
+		return nullptr;
+	}
+	idx_t vertex_count = 0;
+	VisitVertexSpans(blob, [&](const GeometryPart &part) { vertex_count += part.vertices.count; });
+	if (vertex_count < MIN_VERTEX_COUNT) {
+		return nullptr;
+	}
+
+	const auto hash = Hash(blob.GetData(), blob.GetSize());
+	const auto current_capacity = capacity.load();
+	if (current_capacity != 0) {
+		lock_guard<mutex> guard(lock);
+		const auto range = lookup.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it) {
+			const auto entry = it->second;
+			if (IsSameGeometry(*entry, blob)) {
+				// Move the entry to the front
+				entries.splice(entries.begin(), entries, entry);
+				return entry->index;
+			}
+		}
+		if (!always_build && seen.insert(hash).second) {
+			// Wait for the geometry to be seen again
+			if (seen.size() > MAX_SEEN_COUNT) {
+				seen.clear();
+			}
+			return nullptr;
+		}
+		seen.erase(hash);
+	} else if (!always_build) {
+		return nullptr;
+	}
+
+	// Build the index outside of the lock, other threads may build the same index concurrently
+	auto index = make_shared_ptr<SegmentIndex>(blob);
+	const auto size = index->GetMemoryUsage() + blob.GetSize();
+	if (size > current_capacity) {
+		return index;
+	}
+
+	lock_guard<mutex> guard(lock);
+	const auto range = lookup.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it) {
+		const auto entry = it->second;
+		if (IsSameGeometry(*entry, blob)) {
+			// Another thread was faster
+			return entry->index;
+		}
+	}
+
+	Shrink(capacity.load() - MinValue(size, capacity.load()));
+	entries.push_front(Entry {hash, string(blob.GetData(), blob.GetSize()), index, size});
+	lookup.emplace(hash, entries.begin());
+	used += size;
+	reservation.Resize(used);
+	return index;
+}
+
+void SegmentIndexCache::Shrink(idx_t capacity_p) {
+	while (used > capacity_p && !entries.empty()) {
+		auto &entry = entries.back();
+		const auto range = lookup.equal_range(entry.hash);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (&*it->second == &entry) {
+				lookup.erase(it);
+				break;
+			}
+		}
+		used -= entry.size;
+		entries.pop_back();
+	}
+	reservation.Resize(used);
+}
+
+} // namespace duckdb
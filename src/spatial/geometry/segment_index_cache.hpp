@@ -0,0 +1,77 @@
+#pragma once
+
+#include "spatial/geometry/segment_index.hpp"
+
+#include "duckdb/common/atomic.hpp"
+#include "duckdb/common/list.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "duckdb/common/unordered_set.hpp"
+#include "duckdb/storage/buffer/block_handle.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+namespace duckdb {
+
+class ClientContext;
+class DatabaseInstance;
+
+//! A database-wide LRU cache of the segment indexes of large geometries, keyed by the serialized geometry. Reference
+//! geometries that are checked against over and over (e.g. a table of admin boundaries) are then only indexed once,
+//! instead of once per query and thread. The indexes are immutable, so they are shared by all threads.
+//! The memory of the cached indexes is accounted for with the buffer pool, so it shows up in duckdb_memory().
+class SegmentIndexCache final : public ObjectCacheEntry {
+public:
+	static constexpr auto SETTING_NAME = "geometry_index_cache_size";
+	//! The default number of bytes of cached indexes
+	static constexpr idx_t DEFAULT_CAPACITY = 128 * 1024 * 1024;
+	//! Only geometries with at least this many vertices are indexed
+	static constexpr idx_t MIN_VERTEX_COUNT = 64;
+	//! The number of recently seen geometries remembered to decide which ones to index, see GetIndex
+	static constexpr idx_t MAX_SEEN_COUNT = 4096;
+
+	explicit SegmentIndexCache(BufferPool &pool);
+	~SegmentIndexCache() override;
+
+	static string ObjectType() {
+		return "spatial_segment_index_cache";
+	}
+
+	string GetObjectType() override {
+		return ObjectType();
+	}
+
+	static shared_ptr<SegmentIndexCache> Get(ClientContext &context);
+	static void Register(DatabaseInstance &db);
+
+	//! Get the index of a geometry, or nullptr if the geometry is too small to be worth indexing. A geometry that isn't
+	//! cached yet is only indexed when it is seen for the second time, so that a stream of distinct geometries doesn't
+	//! build (and evict) an index for each of them, unless always_build is set.
+	shared_ptr<SegmentIndex> GetIndex(const string_t &blob, bool always_build);
+
+	//! Set the number of bytes of cached indexes, evicting the least recently used ones over the new capacity
+	void SetCapacity(idx_t capacity);
+
+private:
+	struct Entry {
+		hash_t hash;
+		string blob;
+		shared_ptr<SegmentIndex> index;
+		idx_t size;
+	};
+
+	//! Evict the least recently used indexes until the cache fits in the capacity, the lock must be held
+	void Shrink(idx_t capacity);
+
+	mutex lock;
+	//! The cached indexes, the most recently used first
+	list<Entry> entries;
+	unordered_multimap<hash_t, list<Entry>::iterator> lookup;
+	//! The hashes of geometries seen once, which are indexed when they are seen again
+	unordered_set<hash_t> seen;
+
+	atomic<idx_t> capacity;
+	idx_t used = 0;
+	BufferPoolReservation reservation;
+};
+
+} // namespace duckdb
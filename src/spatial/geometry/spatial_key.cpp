@@ -0,0 +1,112 @@
+#include "spatial/geometry/spatial_key.hpp"
+#include "spatial/geometry/geometry_stats.hpp"
+#include "spatial/spatial_types.hpp"
+
+#include "duckdb/common/types/value.hpp"
+#include "duckdb/storage/statistics/numeric_stats.hpp"
+#include "duckdb/storage/statistics/struct_stats.hpp"
+
+namespace duckdb {
+
+bool SpatialKey::TryGetType(const LogicalType &type, SpatialKeyType &result) {
+	if (type == GeoTypes::GEOMETRY()) {
+		result = SpatialKeyType::GEOMETRY;
+	} else if (type == GeoTypes::POINT_2D()) {
+		result = SpatialKeyType::POINT_2D;
+	} else if (type == GeoTypes::BOX_2D()) {
+		result = SpatialKeyType::BOX_2D;
+	} else if (type == GeoTypes::BOX_2DF()) {
+		result = SpatialKeyType::BOX_2DF;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+bool SpatialKey::IsKeyType(const LogicalType &type) {
+	SpatialKeyType key_type;
+	return TryGetType(type, key_type);
+}
+
+bool SpatialKey::TryGetBounds(const LogicalType &type, const Value &value, Box2D<float> &bounds) {
+	SpatialKeyType key_type;
+	if (value.IsNull() || !TryGetType(type, key_type)) {
+		return false;
+	}
+	if (key_type == SpatialKeyType::GEOMETRY) {
+		const geometry_t blob(value.GetValueUnsafe<string_t>());
+		return blob.TryGetCachedBounds(bounds);
+	}
+
+	const auto &children = StructValue::GetChildren(value);
+	for (const auto &child : children) {
+		if (child.IsNull()) {
+			return false;
+		}
+	}
+	switch (key_type) {
+	case SpatialKeyType::POINT_2D: {
+		const auto x = children[0].GetValue<double>();
+		const auto y = children[1].GetValue<double>();
+		return TryGetBounds(x, y, x, y, bounds);
+	}
+	case SpatialKeyType::BOX_2D:
+		return TryGetBounds(children[0].GetValue<double>(), children[1].GetValue<double>(),
+		                    children[2].GetValue<double>(), children[3].GetValue<double>(), bounds);
+	case SpatialKeyType::BOX_2DF:
+		return TryGetBounds(children[0].GetValue<float>(), children[1].GetValue<float>(),
+		                    children[2].GetValue<float>(), children[3].GetValue<float>(), bounds);
+	default:
+		return false;
+	}
+}
+
+bool SpatialKey::AlwaysHasBounds(const LogicalType &type, const BaseStatistics &stats) {
+	SpatialKeyType key_type;
+	if (stats.CanHaveNull() || !TryGetType(type, key_type)) {
+		return false;
+	}
+	if (key_type == SpatialKeyType::GEOMETRY) {
+		const auto geom_stats = GeometryStats::FromStatistics(stats);
+		return !geom_stats.can_have_null && !geom_stats.can_have_empty;
+	}
+
+	// NaN is larger than any other value, so there are no NaN coordinates if the maximum is not NaN
+	for (idx_t i = 0; i < StructType::GetChildCount(type); i++) {
+		const auto &child = StructStats::GetChildStats(stats, i);
+		if (child.CanHaveNull() || !NumericStats::HasMax(child) ||
+		    std::isnan(NumericStats::Max(child).DefaultCastAs(LogicalType::DOUBLE).GetValue<double>())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void SpatialKeyReader::Initialize(const LogicalType &type, Vector &keys, idx_t count) {
+	if (!SpatialKey::TryGetType(type, key_type)) {
+		throw InternalException("Unsupported spatial key type: %s", type.ToString());
+	}
+
+	if (key_type == SpatialKeyType::GEOMETRY) {
+		keys.ToUnifiedFormat(count, geom_format);
+		geom_data = UnifiedVectorFormat::GetData<geometry_t>(geom_format);
+		return;
+	}
+
+	keys.Flatten(count);
+	validity = &FlatVector::Validity(keys);
+
+	const auto &children = StructVector::GetEntries(keys);
+	child_count = children.size();
+	D_ASSERT(child_count <= 4);
+	for (idx_t i = 0; i < child_count; i++) {
+		child_validity[i] = &FlatVector::Validity(*children[i]);
+		if (key_type == SpatialKeyType::BOX_2DF) {
+			float_data[i] = FlatVector::GetData<float>(*children[i]);
+		} else {
+			double_data[i] = FlatVector::GetData<double>(*children[i]);
+		}
+	}
+}
+
+} // namespace duckdb
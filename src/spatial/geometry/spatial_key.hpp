@@ -0,0 +1,114 @@
+#pragma once
+
+#include "spatial/geometry/bbox.hpp"
+#include "spatial/geometry/geometry_type.hpp"
+#include "spatial/util/math.hpp"
+
+#include "duckdb/common/types/vector.hpp"
+
+namespace duckdb {
+
+class BaseStatistics;
+
+//------------------------------------------------------------------------
+// SpatialKey
+//------------------------------------------------------------------------
+// The RTREE index and the spatial joins only look at the approximate
+// (float) bounds of their keys, so besides geometries they also accept
+// points and boxes as they are, without converting them to geometries.
+// Geometries are bounded by their cached bounding box, points and boxes
+// are rounded outwards to floats. NULL keys, empty geometries and points
+// or boxes with NaN coordinates have no bounds, and never match.
+//------------------------------------------------------------------------
+enum class SpatialKeyType : uint8_t { GEOMETRY, POINT_2D, BOX_2D, BOX_2DF };
+
+struct SpatialKey {
+	//! Returns false if the type can not be used as a key
+	static bool TryGetType(const LogicalType &type, SpatialKeyType &result);
+	//! Whether the type is GEOMETRY, POINT_2D, BOX_2D or BOX_2DF
+	static bool IsKeyType(const LogicalType &type);
+	//! Get the bounds of a key value of the given type, returns false if it has none
+	static bool TryGetBounds(const LogicalType &type, const Value &value, Box2D<float> &bounds);
+	//! Whether the statistics of a key of the given type rule out keys without bounds
+	static bool AlwaysHasBounds(const LogicalType &type, const BaseStatistics &stats);
+
+	template <class T>
+	static bool TryGetBounds(T min_x, T min_y, T max_x, T max_y, Box2D<float> &bounds) {
+		if (std::isnan(min_x) || std::isnan(min_y) || std::isnan(max_x) || std::isnan(max_y)) {
+			return false;
+		}
+		bounds.min.x = MathUtil::DoubleToFloatDown(static_cast<double>(min_x));
+		bounds.min.y = MathUtil::DoubleToFloatDown(static_cast<double>(min_y));
+		bounds.max.x = MathUtil::DoubleToFloatUp(static_cast<double>(max_x));
+		bounds.max.y = MathUtil::DoubleToFloatUp(static_cast<double>(max_y));
+		return true;
+	}
+};
+
+//! Reads the bounds of a vector of keys. Points and boxes are read straight from the struct child vectors.
+class SpatialKeyReader {
+public:
+	SpatialKeyReader() = default;
+	SpatialKeyReader(const LogicalType &type, Vector &keys, idx_t count) {
+		Initialize(type, keys, count);
+	}
+
+	// Not copyable
+	SpatialKeyReader(const SpatialKeyReader &) = delete;
+	SpatialKeyReader &operator=(const SpatialKeyReader &) = delete;
+
+	//! Prepare reading the first 'count' keys of the vector. Vectors of points or boxes are flattened.
+	void Initialize(const LogicalType &type, Vector &keys, idx_t count);
+
+	//! Get the bounds of the key in the given row, returns false if it has none
+	bool TryGetBounds(idx_t row_idx, Box2D<float> &bounds) const {
+		switch (key_type) {
+		case SpatialKeyType::GEOMETRY: {
+			const auto geom_idx = geom_format.sel->get_index(row_idx);
+			return geom_format.validity.RowIsValid(geom_idx) && geom_data[geom_idx].TryGetCachedBounds(bounds);
+		}
+		case SpatialKeyType::POINT_2D:
+			return IsValid(row_idx) && SpatialKey::TryGetBounds(double_data[0][row_idx], double_data[1][row_idx],
+			                                                    double_data[0][row_idx], double_data[1][row_idx],
+			                                                    bounds);
+		case SpatialKeyType::BOX_2D:
+			return IsValid(row_idx) && SpatialKey::TryGetBounds(double_data[0][row_idx], double_data[1][row_idx],
+			                                                    double_data[2][row_idx], double_data[3][row_idx],
+			                                                    bounds);
+		case SpatialKeyType::BOX_2DF:
+			return IsValid(row_idx) && SpatialKey::TryGetBounds(float_data[0][row_idx], float_data[1][row_idx],
+			                                                    float_data[2][row_idx], float_data[3][row_idx],
+			                                                    bounds);
+		default:
+			return false;
+		}
+	}
+
+private:
+	bool IsValid(idx_t row_idx) const {
+		if (!validity->RowIsValid(row_idx)) {
+			return false;
+		}
+		for (idx_t i = 0; i < child_count; i++) {
+			if (!child_validity[i]->RowIsValid(row_idx)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	SpatialKeyType key_type = SpatialKeyType::GEOMETRY;
+
+	// GEOMETRY
+	UnifiedVectorFormat geom_format;
+	const geometry_t *geom_data = nullptr;
+
+	// POINT_2D, BOX_2D and BOX_2DF, after flattening
+	const ValidityMask *validity = nullptr;
+	const ValidityMask *child_validity[4] = {};
+	const double *double_data[4] = {};
+	const float *float_data[4] = {};
+	idx_t child_count = 0;
+};
+
+} // namespace duckdb
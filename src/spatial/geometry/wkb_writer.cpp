@@ -1,148 +1,93 @@
 #include "spatial/geometry/wkb_writer.hpp"
-#include "spatial/geometry/geometry_processor.hpp"
+#include "spatial/geometry/geometry_cursor.hpp"
+#include "spatial/util/binary_writer.hpp"
 
 #include "duckdb/common/types/vector.hpp"
+#include "duckdb/storage/arena_allocator.hpp"
 
 namespace duckdb {
 
-namespace {
-
 //------------------------------------------------------------------------------
-// Size Calculator
+// Transcoder
 //------------------------------------------------------------------------------
-class WKBSizeCalculator final : GeometryProcessor<uint32_t> {
-	uint32_t ProcessPoint(const VertexData &vertices) override {
-		// <byte order> + <type> + <x> + <y> (+ <z> + <m>)
-		// WKB Points always write points even if empty
-		return sizeof(uint8_t) + sizeof(uint32_t) + sizeof(double) * (2 + (HasZ() ? 1 : 0) + (HasM() ? 1 : 0));
-	}
-
-	uint32_t ProcessLineString(const VertexData &vertices) override {
-		// <byte order> + <type> + <count> + <points>
-		return sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t) + vertices.ByteSize();
-	}
-
-	uint32_t ProcessPolygon(PolygonState &state) override {
-		// <byte order> + <type> + <ring_count> + <rings>
-		uint32_t size = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t);
-		while (!state.IsDone()) {
-			// <count> + <points>
-			size += sizeof(uint32_t) + state.Next().ByteSize();
-		}
-		return size;
-	}
+// Both the serialized geometry and WKB store the vertices of each point, linestring and ring as contiguous runs of
+// (little-endian) doubles with the same ordinate layout, so the transcoder only has to write the WKB part headers in
+// between and can copy every run of vertices with a single memcpy. The size of the WKB can be computed from the part
+// structure alone, without touching the vertices.
 
-	uint32_t ProcessCollection(CollectionState &state) override {
-		// <byte order> + <type> + <geometry_count>
-		uint32_t size = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t);
-		while (!state.IsDone()) {
-			// + <geometry>
-			size += state.Next();
-		}
-		return size;
-	}
+namespace {
 
-public:
-	virtual ~WKBSizeCalculator() = default;
+constexpr uint32_t WKB_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
 
-	uint32_t Execute(const geometry_t &geometry) {
-		return Process(geometry);
-	}
-};
+uint32_t GetWKBSize(const string_t &geometry) {
+	GeometryCursor cursor(geometry);
+	const auto vertex_size = cursor.GetVertexSize();
 
-//------------------------------------------------------------------------------
-// Serializer
-//------------------------------------------------------------------------------
-class WKBSerializer final : GeometryProcessor<void, Cursor &> {
-
-	void WriteHeader(Cursor &cursor) {
-		// <byte order>
-		cursor.Write<uint8_t>(1);
-		uint32_t type_id = static_cast<uint32_t>(CurrentType()) + 1;
-		if (HasZ()) {
-			type_id += 1000;
+	uint32_t size = 0;
+	GeometryPart part;
+	while (cursor.Next(part)) {
+		if (part.is_ring) {
+			// <count> + <points>
+			size += sizeof(uint32_t) + part.vertices.count * vertex_size;
+			continue;
 		}
-		if (HasM()) {
-			type_id += 2000;
+		if (part.type == sgl::geometry_type::POINT) {
+			// <byte order> + <type> + <vertex>, WKB Points always write a vertex even if empty
+			size += WKB_HEADER_SIZE + vertex_size;
+			continue;
 		}
-		// <type>
-		cursor.Write<uint32_t>(type_id);
+		// <byte order> + <type> + <count> (+ <points>)
+		size += WKB_HEADER_SIZE + sizeof(uint32_t) + part.vertices.count * vertex_size;
 	}
+	return size;
+}
 
-	void ProcessPoint(const VertexData &vertices, Cursor &cursor) override {
-		WriteHeader(cursor);
-		if (vertices.IsEmpty()) {
-			cursor.Write(std::numeric_limits<double>::quiet_NaN());
-			cursor.Write(std::numeric_limits<double>::quiet_NaN());
-			if (HasZ()) {
-				cursor.Write(std::numeric_limits<double>::quiet_NaN());
-			}
-			if (HasM()) {
-				cursor.Write(std::numeric_limits<double>::quiet_NaN());
-			}
-		} else {
-			cursor.Write(Load<double>(vertices.data[0]));
-			cursor.Write(Load<double>(vertices.data[1]));
-			if (HasZ()) {
-				cursor.Write(Load<double>(vertices.data[2]));
-			}
-			if (HasM()) {
-				cursor.Write(Load<double>(vertices.data[3]));
-			}
-		}
-	}
+void WriteWKB(const string_t &geometry, char *buffer, const uint32_t size) {
+	GeometryCursor cursor(geometry);
+	const auto vertex_size = cursor.GetVertexSize();
 
-	void ProcessVertices(const VertexData &vertices, Cursor &cursor) {
-		bool has_z = HasZ();
-		bool has_m = HasM();
-		for (uint32_t i = 0; i < vertices.count; i++) {
-			cursor.Write(Load<double>(vertices.data[0] + i * vertices.stride[0]));
-			cursor.Write(Load<double>(vertices.data[1] + i * vertices.stride[1]));
-			if (has_z) {
-				cursor.Write(Load<double>(vertices.data[2] + i * vertices.stride[2]));
-			}
-			if (has_m) {
-				cursor.Write(Load<double>(vertices.data[3] + i * vertices.stride[3]));
-			}
-		}
+	uint32_t type_offset = 0;
+	if (cursor.HasZ()) {
+		type_offset += 1000;
 	}
-
-	void ProcessLineString(const VertexData &vertices, Cursor &cursor) override {
-		WriteHeader(cursor);
-		cursor.Write<uint32_t>(vertices.count);
-		ProcessVertices(vertices, cursor);
+	if (cursor.HasM()) {
+		type_offset += 2000;
 	}
 
-	void ProcessPolygon(PolygonState &state, Cursor &cursor) override {
-		WriteHeader(cursor);
-		cursor.Write<uint32_t>(state.RingCount());
-		while (!state.IsDone()) {
-			auto vertices = state.Next();
-			cursor.Write<uint32_t>(vertices.count);
-			ProcessVertices(vertices, cursor);
+	BinaryWriter writer(buffer, size);
+	GeometryPart part;
+	while (cursor.Next(part)) {
+		const auto &vertices = part.vertices;
+		if (!part.is_ring) {
+			// <byte order> + <type>
+			writer.Write<uint8_t>(1);
+			writer.Write<uint32_t>(static_cast<uint32_t>(part.type) + type_offset);
 		}
-	}
 
-	void ProcessCollection(CollectionState &state, Cursor &cursor) override {
-		WriteHeader(cursor);
-		cursor.Write<uint32_t>(state.ItemCount());
-		while (!state.IsDone()) {
-			state.Next(cursor);
+		switch (part.type) {
+		case sgl::geometry_type::POINT:
+			if (vertices.count == 0) {
+				const auto nan = std::numeric_limits<double>::quiet_NaN();
+				for (uint32_t i = 0; i < vertex_size / sizeof(double); i++) {
+					writer.Write<double>(nan);
+				}
+			} else {
+				writer.Copy(vertices.data, vertex_size);
+			}
+			break;
+		case sgl::geometry_type::LINESTRING:
+			// Linestrings and polygon rings
+			writer.Write<uint32_t>(vertices.count);
+			writer.Copy(vertices.data, vertices.count * vertex_size);
+			break;
+		default:
+			// Polygons and collections
+			writer.Write<uint32_t>(part.part_count);
+			break;
 		}
 	}
-
-public:
-	virtual ~WKBSerializer() = default;
-	void Execute(const geometry_t &geometry, data_ptr_t start, data_ptr_t end) {
-		Cursor cursor(start, end);
-		Process(geometry, cursor);
-	}
-	void Execute(const geometry_t &geometry, string_t &blob) {
-		Cursor cursor(blob);
-		Process(geometry, cursor);
-		blob.Finalize();
-	}
-};
+	D_ASSERT(writer.GetPtr() == writer.GetEnd());
+}
 
 } // namespace
 
@@ -150,45 +95,93 @@ public:
 // WKB Writer
 //------------------------------------------------------------------------------
 string_t WKBWriter::Write(const geometry_t &geometry, Vector &result) {
-	WKBSizeCalculator size_processor;
-	WKBSerializer serializer;
-	auto size = size_processor.Execute(geometry);
-	auto blob = StringVector::EmptyString(result, size);
-	serializer.Execute(geometry, blob);
-	return blob;
+	return Write(static_cast<string_t>(geometry), result);
 }
 
 string_t WKBWriter::Write(const string_t &geometry, Vector &result) {
-	const geometry_t geom(geometry);
-	return Write(geom, result);
+	const auto size = GetWKBSize(geometry);
+	auto blob = StringVector::EmptyString(result, size);
+	WriteWKB(geometry, blob.GetDataWriteable(), size);
+	blob.Finalize();
+	return blob;
 }
 
 void WKBWriter::Write(const geometry_t &geometry, vector<data_t> &buffer) {
-	WKBSizeCalculator size_processor;
-	WKBSerializer serializer;
-	auto size = size_processor.Execute(geometry);
-	buffer.resize(size);
-	serializer.Execute(geometry, buffer.data(), buffer.data() + size);
+	Write(static_cast<string_t>(geometry), buffer);
 }
 
 void WKBWriter::Write(const string_t &geometry, vector<data_t> &buffer) {
-	const geometry_t geom(geometry);
-	Write(geom, buffer);
+	const auto size = GetWKBSize(geometry);
+	buffer.resize(size);
+	WriteWKB(geometry, char_ptr_cast(buffer.data()), size);
 }
 
 const_data_ptr_t WKBWriter::Write(const geometry_t &geometry, uint32_t *size, ArenaAllocator &allocator) {
-	WKBSizeCalculator size_processor;
-	WKBSerializer serializer;
-	auto blob_size = size_processor.Execute(geometry);
+	return Write(static_cast<string_t>(geometry), size, allocator);
+}
+
+const_data_ptr_t WKBWriter::Write(const string_t &geometry, uint32_t *size, ArenaAllocator &allocator) {
+	const auto blob_size = GetWKBSize(geometry);
 	auto blob = allocator.AllocateAligned(blob_size);
-	serializer.Execute(geometry, blob, blob + blob_size);
+	WriteWKB(geometry, char_ptr_cast(blob), blob_size);
 	*size = blob_size;
 	return blob;
 }
 
-const_data_ptr_t WKBWriter::Write(const string_t &geometry, uint32_t *size, ArenaAllocator &allocator) {
-	const geometry_t geom(geometry);
-	return WKBWriter::Write(geom, size, allocator);
+void WKBWriter::Write(Vector &source, Vector &result, idx_t count) {
+	if (source.GetVectorType() == VectorType::CONSTANT_VECTOR) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+		count = 1;
+	} else {
+		result.SetVectorType(VectorType::FLAT_VECTOR);
+	}
+
+	UnifiedVectorFormat format;
+	source.ToUnifiedFormat(count, format);
+	const auto source_data = UnifiedVectorFormat::GetData<string_t>(format);
+
+	const auto is_constant = result.GetVectorType() == VectorType::CONSTANT_VECTOR;
+	const auto result_data =
+	    is_constant ? ConstantVector::GetData<string_t>(result) : FlatVector::GetData<string_t>(result);
+	auto &result_validity = is_constant ? ConstantVector::Validity(result) : FlatVector::Validity(result);
+
+	// Sizing pass, the sizes are stashed in the result until the blobs are written
+	idx_t total_size = 0;
+	for (idx_t i = 0; i < count; i++) {
+		const auto idx = format.sel->get_index(i);
+		if (!format.validity.RowIsValid(idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		const auto size = GetWKBSize(source_data[idx]);
+		result_data[i] = string_t(size);
+		total_size += size;
+	}
+
+	// Allocate the blobs of the whole chunk at once, and write them back to back. A blob can not be larger than
+	// 4GB though, so huge chunks are split over multiple allocations.
+	char *buffer = nullptr;
+	idx_t buffer_left = 0;
+	for (idx_t i = 0; i < count; i++) {
+		if (!result_validity.RowIsValid(i)) {
+			continue;
+		}
+		const auto size = result_data[i].GetSize();
+		if (size > buffer_left) {
+			// Small enough blobs are inlined, but the allocation itself has to end up on the heap
+			buffer_left = MinValue<idx_t>(total_size, NumericLimits<uint32_t>::Maximum());
+			buffer_left = MaxValue<idx_t>(buffer_left, string_t::INLINE_LENGTH + 1);
+			buffer = StringVector::EmptyString(result, buffer_left).GetDataWriteable();
+		}
+
+		const auto idx = format.sel->get_index(i);
+		WriteWKB(source_data[idx], buffer, size);
+		result_data[i] = string_t(buffer, size);
+
+		buffer += size;
+		buffer_left -= size;
+		total_size -= size;
+	}
 }
 
-} // namespace duckdb
\ No newline at end of file
+} // namespace duckdb
@@ -19,6 +19,10 @@ struct WKBWriter {
 	// Write a geometry to a WKB blob into an arena allocator
 	static const_data_ptr_t Write(const geometry_t &geometry, uint32_t *size, ArenaAllocator &allocator);
 	static const_data_ptr_t Write(const string_t &geometry, uint32_t *size, ArenaAllocator &allocator);
+
+	// Write a vector of geometries to WKB blobs in the result vector. The blobs of all rows are sized first and then
+	// written into a single allocation, copying the vertices straight from the serialized geometries.
+	static void Write(Vector &source, Vector &result, idx_t count);
 };
 
 } // namespace duckdb
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "spatial/index/rtree/rtree.hpp"
+#include "spatial/util/math.hpp"
 #include "duckdb/common/printer.hpp"
 
+#include <cmath>
+
 namespace duckdb {
 
 struct InsertResult {
@@ -31,6 +34,10 @@ RTreePointer RTree::MakePage(RTreeNodeType type) const {
 	auto &alloc = type == RTreeNodeType::LEAF_PAGE ? *leaf_allocator : *node_allocator;
 	pointer = alloc.New();
 	pointer.SetMetadata(static_cast<uint8_t>(type));
+	if (HasSnapshots()) {
+		// No snapshot can reach a new page, so it can be modified in place
+		private_pages.insert(pointer.Get());
+	}
 	return pointer;
 }
 
@@ -43,7 +50,11 @@ RTreePointer RTree::MakeRowId(row_t row_id) {
 
 RTreeNode &RTree::RefMutable(const RTreePointer &pointer) const {
 	auto &alloc = pointer.IsLeafPage() ? *leaf_allocator : *node_allocator;
-	return *alloc.Get<RTreeNode>(pointer, true);
+	auto &node = *alloc.Get<RTreeNode>(pointer, true);
+	if (HasSnapshots()) {
+		PreservePage(pointer, node);
+	}
+	return node;
 }
 
 const RTreeNode &RTree::Ref(const RTreePointer &pointer) const {
@@ -51,6 +62,217 @@ const RTreeNode &RTree::Ref(const RTreePointer &pointer) const {
 	return *alloc.Get<const RTreeNode>(pointer, false);
 }
 
+//------------------------------------------------------------------------------
+// Compressed Leaves
+//------------------------------------------------------------------------------
+// Quantizes coordinates to 16 bits on a grid spanning the leaf bounds. Decoded boxes always contain the box that was
+// encoded, and never extend past the leaf bounds.
+class RTreeQuantizer {
+public:
+	static constexpr uint16_t MAX_CELL = NumericLimits<uint16_t>::Maximum();
+
+	explicit RTreeQuantizer(const RTreeBounds &bounds_p) : bounds(bounds_p) {
+		for (idx_t axis = 0; axis < 2; axis++) {
+			step[axis] = (static_cast<double>(bounds.max[axis]) - bounds.min[axis]) / MAX_CELL;
+		}
+	}
+
+	float DecodeMin(const idx_t axis, const uint16_t cell) const {
+		if (cell == 0) {
+			return bounds.min[axis];
+		}
+		return MinValue(MathUtil::DoubleToFloatDown(bounds.min[axis] + cell * step[axis]), bounds.max[axis]);
+	}
+
+	float DecodeMax(const idx_t axis, const uint16_t cell) const {
+		if (cell == MAX_CELL) {
+			return bounds.max[axis];
+		}
+		return MinValue(MathUtil::DoubleToFloatUp(bounds.min[axis] + cell * step[axis]), bounds.max[axis]);
+	}
+
+	uint16_t EncodeMin(const idx_t axis, const float value) const {
+		auto cell = GetCell(std::floor(GetPosition(axis, value)));
+		// Make sure we round down
+		while (cell > 0 && DecodeMin(axis, cell) > value) {
+			cell--;
+		}
+		return cell;
+	}
+
+	uint16_t EncodeMax(const idx_t axis, const float value) const {
+		auto cell = GetCell(std::ceil(GetPosition(axis, value)));
+		// Make sure we round up
+		while (cell < MAX_CELL && DecodeMax(axis, cell) < value) {
+			cell++;
+		}
+		return cell;
+	}
+
+private:
+	double GetPosition(const idx_t axis, const float value) const {
+		return step[axis] == 0 ? 0 : (static_cast<double>(value) - bounds.min[axis]) / step[axis];
+	}
+
+	static uint16_t GetCell(const double position) {
+		return static_cast<uint16_t>(MinValue<double>(MaxValue<double>(position, 0), MAX_CELL));
+	}
+
+	RTreeBounds bounds;
+	double step[2];
+};
+
+static constexpr row_t MAX_COMPRESSED_ROW_ID_DELTA = (static_cast<row_t>(1) << 48) - 1;
+
+static void DecodeLeaf(const RTreeNode &page, RTreeNode &node) {
+	const auto &leaf = *reinterpret_cast<const RTreeCompressedLeaf *>(&page + 1);
+	const auto entries = reinterpret_cast<const RTreeCompressedEntry *>(&leaf + 1);
+	const RTreeQuantizer quantizer(leaf.bounds);
+
+	node.Clear();
+	for (idx_t i = 0; i < page.GetCount(); i++) {
+		const auto &src = entries[i];
+
+		RTreeEntry entry;
+		entry.bounds.min.x = quantizer.DecodeMin(0, src.bounds[0]);
+		entry.bounds.min.y = quantizer.DecodeMin(1, src.bounds[1]);
+		entry.bounds.max.x = quantizer.DecodeMax(0, src.bounds[2]);
+		entry.bounds.max.y = quantizer.DecodeMax(1, src.bounds[3]);
+
+		const auto delta = static_cast<row_t>(src.row_id[0]) | (static_cast<row_t>(src.row_id[1]) << 16) |
+		                   (static_cast<row_t>(src.row_id[2]) << 32);
+		entry.pointer = RTree::MakeRowId(leaf.base_row_id + delta);
+
+		node.PushEntry(entry);
+	}
+}
+
+static void EncodeLeaf(const RTreeNode &node, RTreeNode &page) {
+	auto &leaf = *reinterpret_cast<RTreeCompressedLeaf *>(&page + 1);
+	const auto entries = reinterpret_cast<RTreeCompressedEntry *>(&leaf + 1);
+
+	leaf.bounds = node.GetBounds();
+	leaf.base_row_id = NumericLimits<row_t>::Maximum();
+	for (const auto &entry : node) {
+		leaf.base_row_id = MinValue(leaf.base_row_id, entry.pointer.GetRowId());
+	}
+	const RTreeQuantizer quantizer(leaf.bounds);
+
+	for (idx_t i = 0; i < node.GetCount(); i++) {
+		const auto &src = node[i];
+		auto &dst = entries[i];
+
+		dst.bounds[0] = quantizer.EncodeMin(0, src.bounds.min.x);
+		dst.bounds[1] = quantizer.EncodeMin(1, src.bounds.min.y);
+		dst.bounds[2] = quantizer.EncodeMax(0, src.bounds.max.x);
+		dst.bounds[3] = quantizer.EncodeMax(1, src.bounds.max.y);
+
+		const auto delta = src.pointer.GetRowId() - leaf.base_row_id;
+		if (delta > MAX_COMPRESSED_ROW_ID_DELTA) {
+			throw InternalException("RTree: row ids in compressed leaf are too far apart");
+		}
+		dst.row_id[0] = static_cast<uint16_t>(delta);
+		dst.row_id[1] = static_cast<uint16_t>(delta >> 16);
+		dst.row_id[2] = static_cast<uint16_t>(delta >> 32);
+	}
+	page.SetCount(node.GetCount());
+}
+
+const RTreeNode &RTree::Ref(const RTreePointer &pointer, RTreeNodeBuffer &buffer) const {
+	if (!IsCompressed(pointer)) {
+		return Ref(pointer);
+	}
+	auto &node = buffer.Get(config.max_leaf_capacity);
+	DecodeLeaf(Ref(pointer), node);
+	return node;
+}
+
+RTreeNode &RTree::RefMutable(const RTreePointer &pointer, RTreeNodeBuffer &buffer) const {
+	if (!IsCompressed(pointer)) {
+		return RefMutable(pointer);
+	}
+	auto &node = buffer.Get(config.max_leaf_capacity);
+	DecodeLeaf(Ref(pointer), node);
+	return node;
+}
+
+void RTree::Write(const RTreePointer &pointer, RTreeNodeBuffer &buffer) const {
+	if (!IsCompressed(pointer)) {
+		return;
+	}
+	EncodeLeaf(buffer.Get(config.max_leaf_capacity), RefMutable(pointer));
+}
+
+//------------------------------------------------------------------------------
+// Snapshots
+//------------------------------------------------------------------------------
+// Pages are modified in place. But the first time a page is modified after a snapshot was taken, its old contents
+// are copied aside, and readers of that snapshot keep reading the copy. So a snapshot reader never needs to see a
+// consistent tree while it is not holding the lock, only the pages of the tree as it was when the snapshot was taken.
+RTreeSnapshot::~RTreeSnapshot() {
+	tree.ReleaseSnapshot(epoch);
+}
+
+shared_ptr<RTreeSnapshot> RTree::GetSnapshot() const {
+	// Everything modified from now on has to be preserved for this snapshot
+	epoch++;
+	private_pages.clear();
+	snapshot_epochs.insert(epoch);
+	return make_shared_ptr<RTreeSnapshot>(*this, epoch, root);
+}
+
+void RTree::ReleaseSnapshot(idx_t snapshot_epoch) const {
+	lock_guard<mutex> guard(lock);
+	snapshot_epochs.erase(snapshot_epochs.find(snapshot_epoch));
+
+	// Drop the versions that no remaining snapshot can see
+	const auto oldest = HasSnapshots() ? *snapshot_epochs.begin() : NumericLimits<idx_t>::Maximum();
+	for (auto it = page_versions.begin(); it != page_versions.end();) {
+		auto &versions = it->second;
+		idx_t expired = 0;
+		while (expired < versions.size() && versions[expired].epoch < oldest) {
+			expired++;
+		}
+		versions.erase(versions.begin(), versions.begin() + NumericCast<int64_t>(expired));
+		it = versions.empty() ? page_versions.erase(it) : std::next(it);
+	}
+	if (!HasSnapshots()) {
+		private_pages.clear();
+	}
+}
+
+void RTree::PreservePage(const RTreePointer &pointer, const RTreeNode &node) const {
+	if (!private_pages.insert(pointer.Get()).second) {
+		// Already preserved (or created) in this epoch
+		return;
+	}
+	const auto size = pointer.IsLeafPage() ? config.GetLeafByteSize() : config.GetNodeByteSize();
+	PageVersion version {epoch, make_unsafe_uniq_array<data_t>(size)};
+	memcpy(version.data.get(), &node, size);
+	page_versions[pointer.Get()].push_back(std::move(version));
+}
+
+const RTreeNode &RTree::Ref(const RTreePointer &pointer, RTreeNodeBuffer &buffer,
+                            const RTreeSnapshot &snapshot) const {
+	const auto entry = page_versions.find(pointer.Get());
+	if (entry != page_versions.end()) {
+		// The versions are ordered by epoch, the first one after the snapshot was taken holds what it saw
+		for (const auto &version : entry->second) {
+			if (version.epoch < snapshot.GetEpoch()) {
+				continue;
+			}
+			const auto &page = *reinterpret_cast<const RTreeNode *>(version.data.get());
+			if (!IsCompressed(pointer)) {
+				return page;
+			}
+			auto &node = buffer.Get(config.max_leaf_capacity);
+			DecodeLeaf(page, node);
+			return node;
+		}
+	}
+	return Ref(pointer, buffer);
+}
+
 void RTree::Free(RTreePointer &pointer) {
 	if (pointer.IsRowId()) {
 		pointer.Clear();
@@ -58,8 +280,10 @@ void RTree::Free(RTreePointer &pointer) {
 		return;
 	}
 	auto &node = RefMutable(pointer);
-	for (auto &entry : node) {
-		Free(entry.pointer);
+	if (pointer.IsBranchPage()) {
+		for (auto &entry : node) {
+			Free(entry.pointer);
+		}
 	}
 	node.Clear();
 	auto &alloc = pointer.IsLeafPage() ? *leaf_allocator : *node_allocator;
@@ -70,11 +294,12 @@ void RTree::Free(RTreePointer &pointer) {
 //------------------------------------------------------------------------------
 // Split
 //------------------------------------------------------------------------------
-void RTree::RebalanceSplitNodes(RTreeNode &src, RTreeNode &dst, bool split_axis, PointXY<float> &split_point) const {
+void RTree::RebalanceSplitNodes(RTreeNode &src, RTreeNode &dst, bool split_axis, PointXY<float> &split_point,
+                                idx_t min_capacity) const {
 	D_ASSERT(src.GetCount() > dst.GetCount());
 
 	// How many entries to we need to move until we have the minimum capacity?
-	const auto remaining = config.min_node_capacity - dst.GetCount();
+	const auto remaining = min_capacity - dst.GetCount();
 
 	// Setup a min heap to keep track of the entries that are closest to the split point
 	vector<pair<float, idx_t>> diff_heap;
@@ -112,9 +337,16 @@ void RTree::RebalanceSplitNodes(RTreeNode &src, RTreeNode &dst, bool split_axis,
 }
 
 RTreeEntry RTree::SplitNode(RTreeEntry &entry) const {
+	if (config.insert_strategy == RTreeInsertStrategy::RSTAR) {
+		return SplitNodeRStar(entry);
+	}
+
+	const auto max_capacity = config.GetMaxCapacity(entry.pointer.GetType());
+	const auto min_capacity = config.GetMinCapacity(entry.pointer.GetType());
 
-	auto &left_node = RefMutable(entry.pointer);
-	D_ASSERT(left_node.GetCount() == config.max_node_capacity);
+	RTreeNodeBuffer left_buffer;
+	auto &left_node = RefMutable(entry.pointer, left_buffer);
+	D_ASSERT(left_node.GetCount() == max_capacity);
 
 	/*
 	 *  C1 | C2
@@ -132,11 +364,11 @@ RTreeEntry RTree::SplitNode(RTreeEntry &entry) const {
 
 	idx_t q_counts[4] = {0, 0, 0, 0};
 	RTreeBounds q_bounds[4];
-	const auto q_assign = make_unsafe_uniq_array<uint8_t>(config.max_node_capacity);
+	const auto q_assign = make_unsafe_uniq_array<uint8_t>(max_capacity);
 	uint8_t q_node[4] = {0, 0, 0, 0};
 
 	// Figure out which quadrant each entry in the node belongs to
-	for (idx_t i = 0; i < config.max_node_capacity; i++) {
+	for (idx_t i = 0; i < max_capacity; i++) {
 		auto child_center = left_node[i].bounds.Center();
 		auto found = false;
 		for (idx_t q_idx = 0; q_idx < 4; q_idx++) {
@@ -154,14 +386,15 @@ RTreeEntry RTree::SplitNode(RTreeEntry &entry) const {
 
 	// Create a temporary node for the first split
 	// Create a buffer to hold all the entries we are going to move
-	const auto entry_buffer = make_unsafe_uniq_array<RTreeEntry>(config.max_node_capacity);
-	for (idx_t i = 0; i < config.max_node_capacity; i++) {
+	const auto entry_buffer = make_unsafe_uniq_array<RTreeEntry>(max_capacity);
+	for (idx_t i = 0; i < max_capacity; i++) {
 		entry_buffer[i] = left_node[i];
 	}
 	left_node.Clear();
 
 	auto right_ptr = MakePage(entry.pointer.GetType());
-	auto &right_node = RefMutable(right_ptr);
+	RTreeNodeBuffer right_buffer;
+	auto &right_node = RefMutable(right_ptr, right_buffer);
 
 	const reference<RTreeNode> node_ref[2] = {left_node, right_node};
 
@@ -219,7 +452,7 @@ RTreeEntry RTree::SplitNode(RTreeEntry &entry) const {
 	}
 
 	// Distribute the entries to the two nodes
-	for (idx_t i = 0; i < config.max_node_capacity; i++) {
+	for (idx_t i = 0; i < max_capacity; i++) {
 		const auto q_idx = q_assign[i];
 		const auto n_idx = q_node[q_idx];
 		auto &dst = node_ref[n_idx];
@@ -238,14 +471,14 @@ RTreeEntry RTree::SplitNode(RTreeEntry &entry) const {
 
 	// If one of the nodes have less than the minimum capacity, we need to move entries from the other node
 	// but do so by moving the entries that are closest to the splitting line
-	if (left_node.GetCount() < config.min_node_capacity) {
-		RebalanceSplitNodes(right_node, left_node, perp_split_axis, center);
-	} else if (right_node.GetCount() < config.min_node_capacity) {
-		RebalanceSplitNodes(left_node, right_node, perp_split_axis, center);
+	if (left_node.GetCount() < min_capacity) {
+		RebalanceSplitNodes(right_node, left_node, perp_split_axis, center, min_capacity);
+	} else if (right_node.GetCount() < min_capacity) {
+		RebalanceSplitNodes(left_node, right_node, perp_split_axis, center, min_capacity);
 	}
 
-	D_ASSERT(left_node.GetCount() >= config.min_node_capacity);
-	D_ASSERT(right_node.GetCount() >= config.min_node_capacity);
+	D_ASSERT(left_node.GetCount() >= min_capacity);
+	D_ASSERT(right_node.GetCount() >= min_capacity);
 
 	// TODO: Reuse q_bounds if we didnt have to rebalance the nodes
 	entry.bounds = left_node.GetBounds();
@@ -261,17 +494,132 @@ RTreeEntry RTree::SplitNode(RTreeEntry &entry) const {
 		right_node.SortEntriesByRowId();
 	}
 
-	left_node.Verify(config.max_node_capacity);
-	right_node.Verify(config.max_node_capacity);
+	left_node.Verify(max_capacity);
+	right_node.Verify(max_capacity);
+
+	Write(entry.pointer, left_buffer);
+	Write(right_ptr, right_buffer);
 
 	// Return a new entry for the second node
 	return RTreeEntry {right_ptr, right_node.GetBounds()};
 }
 
+// Split a node the R*-tree way: pick the axis where the distributions have the smallest total perimeter, and then
+// the distribution along that axis with the least overlap (or area, on ties)
+RTreeEntry RTree::SplitNodeRStar(RTreeEntry &entry) const {
+	const auto max_capacity = config.GetMaxCapacity(entry.pointer.GetType());
+
+	RTreeNodeBuffer left_buffer;
+	auto &left_node = RefMutable(entry.pointer, left_buffer);
+	const auto count = left_node.GetCount();
+	D_ASSERT(count == max_capacity);
+
+	// Each half must get at least this many entries
+	const auto min_count = MaxValue<idx_t>(config.GetMinCapacity(entry.pointer.GetType()), 1);
+	D_ASSERT(min_count * 2 <= count);
+
+	const auto entry_buffer = make_unsafe_uniq_array<RTreeEntry>(count);
+	const auto prefix_bounds = make_unsafe_uniq_array<RTreeBounds>(count);
+	const auto suffix_bounds = make_unsafe_uniq_array<RTreeBounds>(count);
+	for (idx_t i = 0; i < count; i++) {
+		entry_buffer[i] = left_node[i];
+	}
+
+	// Sort the entries along an axis, by either the min or max coordinate, and compute the bounds of every
+	// possible first and second half
+	const auto sort_entries = [&](const idx_t axis, const bool by_max) {
+		std::sort(entry_buffer.get(), entry_buffer.get() + count, [&](const RTreeEntry &a, const RTreeEntry &b) {
+			return by_max ? a.bounds.max[axis] < b.bounds.max[axis] : a.bounds.min[axis] < b.bounds.min[axis];
+		});
+		prefix_bounds[0] = entry_buffer[0].bounds;
+		for (idx_t i = 1; i < count; i++) {
+			prefix_bounds[i] = RTreeBounds::Union(prefix_bounds[i - 1], entry_buffer[i].bounds);
+		}
+		suffix_bounds[count - 1] = entry_buffer[count - 1].bounds;
+		for (idx_t i = count - 1; i > 0; i--) {
+			suffix_bounds[i - 1] = RTreeBounds::Union(suffix_bounds[i], entry_buffer[i - 1].bounds);
+		}
+	};
+
+	// Choose the split axis
+	idx_t split_axis = 0;
+	auto best_margin = NumericLimits<double>::Maximum();
+	for (idx_t axis = 0; axis < 2; axis++) {
+		double margin = 0;
+		for (const auto by_max : {false, true}) {
+			sort_entries(axis, by_max);
+			for (idx_t split = min_count; split <= count - min_count; split++) {
+				margin += prefix_bounds[split - 1].Perimeter() + suffix_bounds[split].Perimeter();
+			}
+		}
+		if (margin < best_margin) {
+			best_margin = margin;
+			split_axis = axis;
+		}
+	}
+
+	// Choose the split distribution along the axis
+	bool split_by_max = false;
+	idx_t split_idx = min_count;
+	auto best_overlap = NumericLimits<float>::Maximum();
+	auto best_area = NumericLimits<float>::Maximum();
+	for (const auto by_max : {false, true}) {
+		sort_entries(split_axis, by_max);
+		for (idx_t split = min_count; split <= count - min_count; split++) {
+			const auto &left_bounds = prefix_bounds[split - 1];
+			const auto &right_bounds = suffix_bounds[split];
+			const auto overlap = left_bounds.OverlapArea(right_bounds);
+			const auto area = left_bounds.Area() + right_bounds.Area();
+			if (overlap < best_overlap || (overlap <= best_overlap && area < best_area)) {
+				best_overlap = overlap;
+				best_area = area;
+				split_by_max = by_max;
+				split_idx = split;
+			}
+		}
+	}
+
+	// Distribute the entries to the two nodes
+	sort_entries(split_axis, split_by_max);
+
+	left_node.Clear();
+	auto right_ptr = MakePage(entry.pointer.GetType());
+	RTreeNodeBuffer right_buffer;
+	auto &right_node = RefMutable(right_ptr, right_buffer);
+
+	for (idx_t i = 0; i < count; i++) {
+		auto &dst = i < split_idx ? left_node : right_node;
+		dst.PushEntry(entry_buffer[i]);
+	}
+
+	entry.bounds = left_node.GetBounds();
+
+	if (entry.pointer.IsBranchPage()) {
+		left_node.SortEntriesByXMin();
+		right_node.SortEntriesByXMin();
+	} else {
+		left_node.SortEntriesByRowId();
+		right_node.SortEntriesByRowId();
+	}
+
+	left_node.Verify(max_capacity);
+	right_node.Verify(max_capacity);
+
+	Write(entry.pointer, left_buffer);
+	Write(right_ptr, right_buffer);
+
+	return RTreeEntry {right_ptr, right_node.GetBounds()};
+}
+
 //------------------------------------------------------------------------------
 // Insert
 //------------------------------------------------------------------------------
-RTreeEntry &RTree::PickSubtree(RTreeNode &node, const RTreeEntry &new_entry) const {
+// 'is_parent_level' is true if the picked child is the node that the new entry will be inserted into
+idx_t RTree::PickSubtree(const RTreeNode &node, const RTreeEntry &new_entry, bool is_parent_level) const {
+	if (config.insert_strategy == RTreeInsertStrategy::RSTAR) {
+		return PickSubtreeRStar(node, new_entry, is_parent_level);
+	}
+
 	idx_t best_match = 0;
 	float best_area = NumericLimits<float>::Maximum();
 	float best_diff = NumericLimits<float>::Maximum();
@@ -291,33 +639,132 @@ RTreeEntry &RTree::PickSubtree(RTreeNode &node, const RTreeEntry &new_entry) con
 			best_match = i;
 		}
 	}
-	return node[best_match];
+	return best_match;
 }
 
-// Insert a rowid into a node
-InsertResult RTree::NodeInsert(RTreeEntry &entry, const RTreeEntry &new_entry) {
-	D_ASSERT(new_entry.pointer.IsRowId());
+// Pick the child that needs the least overlap enlargement on the parent level, and the least area enlargement above it
+idx_t RTree::PickSubtreeRStar(const RTreeNode &node, const RTreeEntry &new_entry, bool is_parent_level) const {
+	const auto count = node.GetCount();
+
+	// The area enlargement of every child, and its index
+	pair<float, idx_t> candidates[256];
+	for (idx_t i = 0; i < count; i++) {
+		const auto &old_bounds = node[i].bounds;
+		const auto new_bounds = RTreeBounds::Union(new_entry.bounds, old_bounds);
+		candidates[i] = {new_bounds.Area() - old_bounds.Area(), i};
+	}
+
+	const auto by_enlargement = [&](const pair<float, idx_t> &a, const pair<float, idx_t> &b) {
+		if (a.first != b.first) {
+			return a.first < b.first;
+		}
+		return node[a.second].bounds.Area() < node[b.second].bounds.Area();
+	};
+
+	if (!is_parent_level) {
+		return std::min_element(candidates, candidates + count, by_enlargement)->second;
+	}
+
+	// Computing the overlap enlargement is quadratic, so like the R*-tree paper suggests, only consider the
+	// candidates with the smallest area enlargement
+	static constexpr idx_t MAX_OVERLAP_CANDIDATES = 32;
+	const auto candidate_count = MinValue(count, MAX_OVERLAP_CANDIDATES);
+	std::partial_sort(candidates, candidates + candidate_count, candidates + count, by_enlargement);
+
+	idx_t best_match = candidates[0].second;
+	auto best_diff = NumericLimits<float>::Maximum();
+	for (idx_t c = 0; c < candidate_count; c++) {
+		const auto idx = candidates[c].second;
+		const auto &old_bounds = node[idx].bounds;
+		const auto new_bounds = RTreeBounds::Union(new_entry.bounds, old_bounds);
+
+		float diff = 0;
+		for (idx_t i = 0; i < count; i++) {
+			if (i != idx) {
+				diff += new_bounds.OverlapArea(node[i].bounds) - old_bounds.OverlapArea(node[i].bounds);
+			}
+		}
+		// The candidates are sorted by area enlargement, so the first one wins ties
+		if (diff < best_diff) {
+			best_diff = diff;
+			best_match = idx;
+		}
+	}
+	return best_match;
+}
+
+// Evict the entries furthest from the center of an overflowing node, so that they can be reinserted elsewhere.
+// 'height' is the height of the node
+void RTree::ForceReinsert(RTreeEntry &entry, idx_t height) {
+	RTreeNodeBuffer buffer;
+	auto &node = RefMutable(entry.pointer, buffer);
+	const auto count = node.GetCount();
+
+	// The R*-tree paper found 30% to work best
+	const auto evict_count = MaxValue<idx_t>(count * 3 / 10, 1);
+
+	const auto center = entry.bounds.Center();
+	const auto entry_buffer = make_unsafe_uniq_array<RTreeEntry>(count);
+	for (idx_t i = 0; i < count; i++) {
+		entry_buffer[i] = node[i];
+	}
+	std::sort(entry_buffer.get(), entry_buffer.get() + count, [&](const RTreeEntry &a, const RTreeEntry &b) {
+		const auto a_diff = a.bounds.Center() - center;
+		const auto b_diff = b.bounds.Center() - center;
+		return a_diff.x * a_diff.x + a_diff.y * a_diff.y < b_diff.x * b_diff.x + b_diff.y * b_diff.y;
+	});
+
+	node.Clear();
+	for (idx_t i = 0; i < count - evict_count; i++) {
+		node.PushEntry(entry_buffer[i]);
+	}
+	if (entry.pointer.IsLeafPage()) {
+		node.SortEntriesByRowId();
+	} else {
+		node.SortEntriesByXMin();
+	}
+	node.Verify(config.GetMaxCapacity(entry.pointer.GetType()));
+	entry.bounds = node.GetBounds();
+	Write(entry.pointer, buffer);
+
+	// Queue the furthest entry first, the queue is processed from the back so the closest entries are reinserted first
+	for (idx_t i = count; i > count - evict_count; i--) {
+		reinsert_queue.emplace_back(entry_buffer[i - 1], height - 1);
+	}
+}
+
+// Insert an entry into a node, 'height' is the number of levels between the node and the new entry.
+// For row ids this is the height of the node, for subtrees it is the height of the node minus that of the subtree
+InsertResult RTree::NodeInsert(RTreeEntry &entry, const RTreeEntry &new_entry, idx_t height) {
 	D_ASSERT(entry.pointer.Get() != 0);
+	D_ASSERT(height != 0);
 
-	const auto is_leaf = entry.pointer.IsLeafPage();
-	return is_leaf ? LeafInsert(entry, new_entry) : BranchInsert(entry, new_entry);
+	return height == 1 ? LeafInsert(entry, new_entry) : BranchInsert(entry, new_entry, height);
 }
 
+// Insert directly into the node. This is a leaf page for row ids, and the parent level for subtrees
 InsertResult RTree::LeafInsert(RTreeEntry &entry, const RTreeEntry &new_entry) {
-	D_ASSERT(entry.pointer.IsLeafPage());
-
-	// Dereference the node
-	auto &node = RefMutable(entry.pointer);
+	D_ASSERT(entry.pointer.IsLeafPage() == new_entry.pointer.IsRowId());
 
-	// Is this leaf full?
-	if (node.GetCount() == config.max_node_capacity) {
+	// Is this node full?
+	if (Ref(entry.pointer).GetCount() == config.GetMaxCapacity(entry.pointer.GetType())) {
 		return InsertResult {true, false};
 	}
+
+	// Dereference the node
+	RTreeNodeBuffer buffer;
+	auto &node = RefMutable(entry.pointer, buffer);
+
 	// Otherwise, insert at the end
 	node.PushEntry(new_entry);
 
-	// Sort by rowid
-	node.SortEntriesByRowId();
+	if (entry.pointer.IsLeafPage()) {
+		// Sort by rowid
+		node.SortEntriesByRowId();
+	} else {
+		node.SortEntriesByXMin();
+	}
+	Write(entry.pointer, buffer);
 
 	// Do we need to grow the bounding box?
 	const auto grown = !entry.bounds.Contains(new_entry.bounds);
@@ -325,20 +772,32 @@ InsertResult RTree::LeafInsert(RTreeEntry &entry, const RTreeEntry &new_entry) {
 	return InsertResult {false, grown};
 }
 
-InsertResult RTree::BranchInsert(RTreeEntry &entry, const RTreeEntry &new_entry) {
+InsertResult RTree::BranchInsert(RTreeEntry &entry, const RTreeEntry &new_entry, idx_t height) {
 	D_ASSERT(entry.pointer.IsBranchPage());
 
-	// Dereference the node
-	auto &node = RefMutable(entry.pointer);
-
-	// Choose a subtree
-	auto &target = PickSubtree(node, new_entry);
+	// Choose a subtree. Insert into a copy of the child entry, so that this node is only dirtied if the child entry
+	// actually changes, and not on every insert that passes through it
+	const auto target_idx = PickSubtree(Ref(entry.pointer), new_entry, height == 2);
+	auto target = Ref(entry.pointer)[target_idx];
 
 	D_ASSERT(target.pointer.Get() != 0);
 
 	// Insert into the selected child
-	const auto result = NodeInsert(target, new_entry);
+	const auto result = NodeInsert(target, new_entry, height - 1);
 	if (result.split) {
+		auto &node = RefMutable(entry.pointer);
+		if (config.insert_strategy == RTreeInsertStrategy::RSTAR) {
+			// The first time a level overflows during an insert, reinsert some of its entries instead of splitting
+			const auto target_height = GetHeight(target);
+			const auto level_bit = static_cast<idx_t>(1) << target_height;
+			if ((reinserted_levels & level_bit) == 0) {
+				reinserted_levels |= level_bit;
+				ForceReinsert(target, target_height);
+				node[target_idx] = target;
+				return NodeInsert(entry, new_entry, height);
+			}
+		}
+
 		if (node.GetCount() == config.max_node_capacity) {
 			// This node is also full!, we need to split it first.
 			return InsertResult {true, false};
@@ -347,6 +806,7 @@ InsertResult RTree::BranchInsert(RTreeEntry &entry, const RTreeEntry &new_entry)
 		// Otherwise, split the selected child
 		auto &left = target;
 		auto right = SplitNode(left);
+		node[target_idx] = left;
 
 		// Insert the new right node into the current node
 		node.PushEntry(right);
@@ -354,12 +814,13 @@ InsertResult RTree::BranchInsert(RTreeEntry &entry, const RTreeEntry &new_entry)
 		node.SortEntriesByXMin();
 
 		// Now insert again
-		return NodeInsert(entry, new_entry);
+		return NodeInsert(entry, new_entry, height);
 	}
 
 	if (result.grown) {
 		// Update the bounding box of the child
 		target.bounds.Union(new_entry.bounds);
+		RefMutable(entry.pointer)[target_idx] = target;
 
 		// Do we need to grow the bounding box?
 		const auto grown = !entry.bounds.Contains(new_entry.bounds);
@@ -371,18 +832,61 @@ InsertResult RTree::BranchInsert(RTreeEntry &entry, const RTreeEntry &new_entry)
 	return InsertResult {false, false};
 }
 
-void RTree::RootInsert(RTreeEntry &root_entry, const RTreeEntry &new_entry) {
+void RTree::RootInsert(RTreeEntry &root_entry, const RTreeEntry &new_entry, idx_t new_height) {
 	// If there is no root node, create one and insert the new entry immediately
 	if (root_entry.pointer.Get() == 0) {
+		if (new_entry.pointer.IsPage()) {
+			// The subtree becomes the root
+			root_entry = new_entry;
+			return;
+		}
 		root_entry.pointer = MakePage(RTreeNodeType::LEAF_PAGE);
 		root_entry.bounds = new_entry.bounds;
 
-		RefMutable(root_entry.pointer).PushEntry(new_entry);
+		RTreeNodeBuffer buffer;
+		RefMutable(root_entry.pointer, buffer).PushEntry(new_entry);
+		Write(root_entry.pointer, buffer);
+		return;
+	}
+
+	const auto root_height = GetHeight(root_entry);
+	if (new_height >= root_height &&
+	    Ref(root_entry.pointer).GetCount() < config.GetMinCapacity(root_entry.pointer.GetType())) {
+		// The root would end up below or beside the subtree, but has fewer entries than other nodes must have.
+		// So free it, and insert its entries into the subtree instead
+		RTreeNodeBuffer buffer;
+		const auto &old_root = Ref(root_entry.pointer, buffer);
+		vector<RTreeEntry> old_entries(old_root.begin(), old_root.end());
+		RefMutable(root_entry.pointer).Clear();
+		Free(root_entry.pointer);
+
+		root_entry = new_entry;
+		for (const auto &old_entry : old_entries) {
+			RootInsert(root_entry, old_entry, root_height - 1);
+		}
+		return;
+	}
+	if (new_height > root_height) {
+		// The subtree is taller than the tree, so insert the tree into the subtree instead
+		const auto old_root = root_entry;
+		root_entry = new_entry;
+		RootInsert(root_entry, old_root, root_height);
+		return;
+	}
+	if (new_height == root_height) {
+		// The subtree is as tall as the tree, put them side by side under a new root
+		auto new_root_ptr = MakePage(RTreeNodeType::BRANCH_PAGE);
+		auto &new_root = RefMutable(new_root_ptr);
+		new_root.PushEntry(root_entry);
+		new_root.PushEntry(new_entry);
+		new_root.SortEntriesByXMin();
+		root_entry.pointer = new_root_ptr;
+		root_entry.bounds.Union(new_entry.bounds);
 		return;
 	}
 
 	// Insert the new entry into the root node
-	const auto result = NodeInsert(root_entry, new_entry);
+	const auto result = NodeInsert(root_entry, new_entry, root_height - new_height);
 	if (result.split) {
 		// The root node was split, we need to create a new root node
 		auto new_root_ptr = MakePage(RTreeNodeType::BRANCH_PAGE);
@@ -401,7 +905,7 @@ void RTree::RootInsert(RTreeEntry &root_entry, const RTreeEntry &new_entry) {
 		root_entry.pointer = new_root_ptr;
 
 		// Insert the new entry into the new root now that we have space
-		RootInsert(root_entry, new_entry);
+		RootInsert(root_entry, new_entry, new_height);
 	}
 
 	if (result.grown) {
@@ -410,6 +914,311 @@ void RTree::RootInsert(RTreeEntry &root_entry, const RTreeEntry &new_entry) {
 	}
 }
 
+void RTree::InsertEntry(const RTreeEntry &new_entry, idx_t new_height) {
+	reinserted_levels = 0;
+	RootInsert(root, new_entry, new_height);
+
+	// Reinsert the entries evicted by the R* overflow treatment. This may evict more entries, but only once per level
+	while (!reinsert_queue.empty()) {
+		const auto item = reinsert_queue.back();
+		reinsert_queue.pop_back();
+		RootInsert(root, item.first, item.second);
+	}
+}
+
+idx_t RTree::GetHeight(const RTreeEntry &entry) const {
+	idx_t height = 0;
+	auto pointer = entry.pointer;
+	while (pointer.IsBranchPage()) {
+		const auto &node = Ref(pointer);
+		D_ASSERT(node.GetCount() != 0);
+		pointer = node[0].pointer;
+		height++;
+	}
+	return pointer.IsLeafPage() ? height + 1 : height;
+}
+
+//------------------------------------------------------------------------------
+// Bulk Insert
+//------------------------------------------------------------------------------
+// Sort-tile-recursive packing: sort by x, cut into vertical slices of whole nodes, and sort each slice by y.
+// Afterwards, node 'i' of 'node_count' consists of the entries in [i * count / node_count, (i + 1) * count / node_count)
+static void SortTileRecursive(RTreeEntry *entries, idx_t count, idx_t node_count) {
+	const auto slice_count = static_cast<idx_t>(std::ceil(std::sqrt(static_cast<double>(node_count))));
+	const auto nodes_per_slice = (node_count + slice_count - 1) / slice_count;
+
+	std::sort(entries, entries + count, [&](const RTreeEntry &a, const RTreeEntry &b) {
+		return a.bounds.Center().x < b.bounds.Center().x;
+	});
+
+	for (idx_t node_beg = 0; node_beg < node_count; node_beg += nodes_per_slice) {
+		const auto node_end = MinValue(node_beg + nodes_per_slice, node_count);
+		const auto slice_beg = node_beg * count / node_count;
+		const auto slice_end = node_end * count / node_count;
+		std::sort(entries + slice_beg, entries + slice_end, [&](const RTreeEntry &a, const RTreeEntry &b) {
+			return a.bounds.Center().y < b.bounds.Center().y;
+		});
+	}
+}
+
+void RTree::BulkInsert(RTreeEntry *entries, idx_t count) {
+	const auto capacity = config.max_leaf_capacity;
+
+	// Only full leaves are packed, so that we dont litter the tree with small nodes.
+	const auto packed_count = count - count % capacity;
+	if (packed_count != 0) {
+		SortTileRecursive(entries, packed_count, packed_count / capacity);
+
+		RTreeNodeBuffer buffer;
+
+		// Now create a leaf for every run of entries, and insert it
+		for (idx_t leaf_beg = 0; leaf_beg < packed_count; leaf_beg += capacity) {
+			auto leaf_ptr = MakePage(RTreeNodeType::LEAF_PAGE);
+			auto &leaf = RefMutable(leaf_ptr, buffer);
+			for (idx_t i = leaf_beg; i < leaf_beg + capacity; i++) {
+				leaf.PushEntry(entries[i]);
+			}
+			leaf.SortEntriesByRowId();
+			leaf.Verify(capacity);
+			Write(leaf_ptr, buffer);
+
+			InsertEntry(RTreeEntry {leaf_ptr, leaf.GetBounds()}, 1);
+		}
+	}
+
+	// Insert the remaining entries one by one
+	for (idx_t i = packed_count; i < count; i++) {
+		InsertEntry(entries[i], 0);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Merge
+//------------------------------------------------------------------------------
+// Copy a subtree of another tree into this trees allocators
+RTreePointer RTree::CopySubtree(const RTree &other, const RTreePointer &pointer) {
+	if (pointer.IsRowId()) {
+		return pointer;
+	}
+	auto new_ptr = MakePage(pointer.GetType());
+	RTreeNodeBuffer src_buffer;
+	RTreeNodeBuffer dst_buffer;
+	const auto &src = other.Ref(pointer, src_buffer);
+	auto &dst = RefMutable(new_ptr, dst_buffer);
+	for (idx_t i = 0; i < src.GetCount(); i++) {
+		auto child = src[i];
+		child.pointer = CopySubtree(other, child.pointer);
+		dst.PushEntry(child);
+	}
+	Write(new_ptr, dst_buffer);
+	return new_ptr;
+}
+
+void RTree::MergeSubtree(const RTree &other, const RTreeEntry &entry, idx_t height) {
+	if (entry.pointer.IsRowId()) {
+		InsertEntry(entry, 0);
+		return;
+	}
+
+	// Move over the whole subtree if it fits below our root, and is full enough to not break the minimum capacity
+	const auto &node = other.Ref(entry.pointer);
+	if (node.GetCount() >= config.GetMinCapacity(entry.pointer.GetType()) && height < GetHeight(root)) {
+		const RTreeEntry copy(CopySubtree(other, entry.pointer), entry.bounds);
+		InsertEntry(copy, height);
+		return;
+	}
+
+	// Otherwise, merge the children one by one
+	RTreeNodeBuffer buffer;
+	const auto &children = other.Ref(entry.pointer, buffer);
+	const vector<RTreeEntry> child_entries(children.begin(), children.end());
+	for (const auto &child : child_entries) {
+		MergeSubtree(other, child, height - 1);
+	}
+}
+
+void RTree::Merge(const RTree &other) {
+	const auto &other_root = other.GetRoot();
+	if (!other_root.pointer.IsSet()) {
+		return;
+	}
+
+	const auto &other_config = other.GetConfig();
+	if (other_config.max_node_capacity > config.max_node_capacity ||
+	    other_config.min_node_capacity < config.min_node_capacity ||
+	    other_config.max_leaf_capacity > config.max_leaf_capacity ||
+	    other_config.min_leaf_capacity < config.min_leaf_capacity) {
+		// The nodes of the other tree dont fit into this one, insert all row ids one by one
+		vector<RTreeEntry> stack = {other_root};
+		while (!stack.empty()) {
+			const auto entry = stack.back();
+			stack.pop_back();
+			if (entry.pointer.IsRowId()) {
+				InsertEntry(entry, 0);
+				continue;
+			}
+			RTreeNodeBuffer buffer;
+			const auto &node = other.Ref(entry.pointer, buffer);
+			stack.insert(stack.end(), node.begin(), node.end());
+		}
+		return;
+	}
+
+	if (!root.pointer.IsSet()) {
+		// We are empty, just copy the whole tree
+		root = RTreeEntry(CopySubtree(other, other_root.pointer), other_root.bounds);
+		return;
+	}
+
+	MergeSubtree(other, other_root, other.GetHeight(other_root));
+}
+
+//------------------------------------------------------------------------------
+// Repack & Vacuum
+//------------------------------------------------------------------------------
+void RTree::Repack() {
+	if (!root.pointer.IsSet()) {
+		return;
+	}
+	if (HasSnapshots()) {
+		// Releasing the buffers would pull the pages out from under the readers
+		throw InvalidInputException("Can not repack an RTREE index while it is being scanned");
+	}
+
+	// Collect all the row ids in the tree
+	vector<RTreeEntry> layer;
+	vector<RTreePointer> stack;
+	RTreeNodeBuffer buffer;
+	stack.push_back(root.pointer);
+	while (!stack.empty()) {
+		const auto pointer = stack.back();
+		stack.pop_back();
+		for (const auto &entry : Ref(pointer, buffer)) {
+			if (entry.pointer.IsRowId()) {
+				layer.push_back(entry);
+			} else {
+				stack.push_back(entry.pointer);
+			}
+		}
+	}
+
+	// Throw away the old tree, this also releases all the buffers of the allocators
+	Reset();
+
+	if (layer.empty()) {
+		return;
+	}
+
+	// Now build the tree bottom-up, layer by layer. The entries of a layer are spread evenly over the nodes, so that
+	// there is no underfull node at the end of the layer.
+	auto node_type = RTreeNodeType::LEAF_PAGE;
+	vector<RTreeEntry> next_layer;
+	do {
+		const auto capacity = config.GetMaxCapacity(node_type);
+		const auto count = layer.size();
+		const auto node_count = (count + capacity - 1) / capacity;
+		SortTileRecursive(layer.data(), count, node_count);
+
+		next_layer.clear();
+		for (idx_t node_idx = 0; node_idx < node_count; node_idx++) {
+			auto node_ptr = MakePage(node_type);
+			auto &node = RefMutable(node_ptr, buffer);
+			for (idx_t i = node_idx * count / node_count; i < (node_idx + 1) * count / node_count; i++) {
+				node.PushEntry(layer[i]);
+			}
+			if (node_type == RTreeNodeType::LEAF_PAGE) {
+				node.SortEntriesByRowId();
+			} else {
+				node.SortEntriesByXMin();
+			}
+			node.Verify(capacity);
+			next_layer.emplace_back(node_ptr, node.GetBounds());
+			Write(node_ptr, buffer);
+		}
+
+		std::swap(layer, next_layer);
+		node_type = RTreeNodeType::BRANCH_PAGE;
+	} while (layer.size() != 1);
+
+	root = layer[0];
+}
+
+//------------------------------------------------------------------------------
+// Prefetch
+//------------------------------------------------------------------------------
+void RTree::Prefetch(idx_t levels) const {
+	if (!root.pointer.IsSet()) {
+		return;
+	}
+
+	// Walk the tree breadth-first, referencing a page is enough to load the buffer it lives in
+	vector<RTreePointer> layer = {root.pointer};
+	vector<RTreePointer> next_layer;
+	for (idx_t level = 0; level < levels && !layer.empty(); level++) {
+		next_layer.clear();
+		for (const auto &pointer : layer) {
+			const auto &node = Ref(pointer);
+			if (!pointer.IsBranchPage()) {
+				continue;
+			}
+			for (const auto &entry : node) {
+				next_layer.push_back(entry.pointer);
+			}
+		}
+		std::swap(layer, next_layer);
+	}
+}
+
+// Move the page, and all pages below it, out of the buffers that are being vacuumed
+void RTree::VacuumPointer(RTreePointer &pointer) {
+	auto &alloc = pointer.IsLeafPage() ? *leaf_allocator : *node_allocator;
+	if (alloc.NeedsVacuum(pointer)) {
+		// The new pointer has no metadata, so we need to set the type again
+		const auto type = pointer.GetType();
+		pointer = alloc.VacuumPointer(pointer);
+		pointer.SetMetadata(static_cast<uint8_t>(type));
+	}
+
+	if (!pointer.IsBranchPage()) {
+		return;
+	}
+
+	// Only dirty the branch if one of its children actually moved, so that vacuuming a few buffers does not force
+	// every branch page to be written at the next checkpoint
+	const auto &node = Ref(pointer);
+	for (idx_t i = 0; i < node.GetCount(); i++) {
+		auto child = node[i].pointer;
+		VacuumPointer(child);
+		if (child.Get() != node[i].pointer.Get()) {
+			RefMutable(pointer)[i].pointer = child;
+		}
+	}
+}
+
+void RTree::Vacuum() {
+	if (HasSnapshots()) {
+		// Moving pages would pull them out from under the readers, try again at the next checkpoint
+		return;
+	}
+	const auto vacuum_leaves = leaf_allocator->InitializeVacuum();
+	const auto vacuum_nodes = node_allocator->InitializeVacuum();
+	if (!vacuum_leaves && !vacuum_nodes) {
+		// Nothing to do
+		return;
+	}
+
+	if (root.pointer.IsSet()) {
+		VacuumPointer(root.pointer);
+	}
+
+	if (vacuum_leaves) {
+		leaf_allocator->FinalizeVacuum();
+	}
+	if (vacuum_nodes) {
+		node_allocator->FinalizeVacuum();
+	}
+}
+
 //------------------------------------------------------------------------------
 // Delete
 //------------------------------------------------------------------------------
@@ -424,12 +1233,15 @@ DeleteResult RTree::NodeDelete(RTreeEntry &entry, const RTreeEntry &target, vect
 DeleteResult RTree::BranchDelete(RTreeEntry &entry, const RTreeEntry &target, vector<RTreeEntry> &orphans) {
 	D_ASSERT(entry.pointer.IsBranchPage());
 
-	auto &node = RefMutable(entry.pointer);
+	// Search the children through a copy, the branch is only dirtied once we know the target is below it
+	const auto &search = Ref(entry.pointer);
 
 	DeleteResult result = {false, false, false};
+	RTreeEntry child;
 	idx_t child_idx;
-	for (child_idx = 0; child_idx < node.GetCount(); child_idx++) {
-		result = NodeDelete(node[child_idx], target, orphans);
+	for (child_idx = 0; child_idx < search.GetCount(); child_idx++) {
+		child = search[child_idx];
+		result = NodeDelete(child, target, orphans);
 		if (result.found) {
 			break;
 		}
@@ -440,6 +1252,9 @@ DeleteResult RTree::BranchDelete(RTreeEntry &entry, const RTreeEntry &target, ve
 		return result;
 	}
 
+	auto &node = RefMutable(entry.pointer);
+	node[child_idx] = child;
+
 	// Should we delete the child entirely?
 	if (result.remove) {
 		// Swap the removed entry with the last entry and clear it
@@ -487,31 +1302,32 @@ DeleteResult RTree::BranchDelete(RTreeEntry &entry, const RTreeEntry &target, ve
 DeleteResult RTree::LeafDelete(RTreeEntry &entry, const RTreeEntry &target, vector<RTreeEntry> &orphans) {
 	D_ASSERT(entry.pointer.IsLeafPage());
 
-	auto &node = RefMutable(entry.pointer);
+	RTreeNodeBuffer buffer;
+	const auto &search = Ref(entry.pointer, buffer);
 
 	// Do a binary search with std::lower_bound to find the matching rowid
 	// This is faster than a linear search
 	const auto it =
-	    std::lower_bound(node.begin(), node.end(), target.pointer.GetRowId(),
+	    std::lower_bound(search.begin(), search.end(), target.pointer.GetRowId(),
 	                     [](const RTreeEntry &item, const row_t &row) { return item.pointer.GetRowId() < row; });
-	if (it == node.end()) {
+	if (it == search.end()) {
 		// Not found in this leaf
 		return {false, false, false};
 	}
 
-	const auto &child = *it;
-
 	// Ok, did the binary search actually find the rowid?
-	if (child.pointer.GetRowId() != target.pointer.GetRowId()) {
+	if (it->pointer.GetRowId() != target.pointer.GetRowId()) {
 		return {false, false, false};
 	}
 
-	const auto child_idx = it - node.begin();
+	D_ASSERT(it->pointer.IsRowId());
+	const auto child_idx = it - search.begin();
 
-	D_ASSERT(child.pointer.IsRowId());
+	// Only now dirty the leaf, leaves that were merely searched stay clean for the next checkpoint
+	auto &node = RefMutable(entry.pointer, buffer);
 
 	// If we remove the entry, will this node now have too few children?
-	if (node.GetCount() - 1 < config.min_node_capacity) {
+	if (node.GetCount() - 1 < config.min_leaf_capacity) {
 		// Yes, orphan all children and signal that this node should be removed
 
 		// But first, remove the actual entry. We dont care about preserving the order here
@@ -520,12 +1336,14 @@ DeleteResult RTree::LeafDelete(RTreeEntry &entry, const RTreeEntry &target, vect
 
 		orphans.insert(orphans.end(), node.begin(), node.end());
 		node.Clear();
-		node.Verify(config.max_node_capacity);
+		node.Verify(config.max_leaf_capacity);
+		Write(entry.pointer, buffer);
 		return {true, true, true};
 	}
 
 	// Remove the entry and compact the node, taking care to preserve the order
 	node.CompactRemove(child_idx);
+	Write(entry.pointer, buffer);
 
 	// TODO: Check if we actually shrunk and need to update the bounds
 	// We can do this more efficiently by checking if the deleted entry bordered the bounds
@@ -545,10 +1363,11 @@ DeleteResult RTree::LeafDelete(RTreeEntry &entry, const RTreeEntry &target, vect
 
 void RTree::ReInsertNode(RTreeEntry &root, RTreeEntry &target) {
 	if (target.pointer.IsRowId()) {
-		RootInsert(root, target);
+		InsertEntry(target, 0);
 	} else {
 		D_ASSERT(target.pointer.IsPage());
-		auto &node = RefMutable(target.pointer);
+		RTreeNodeBuffer buffer;
+		auto &node = RefMutable(target.pointer, buffer);
 		for (auto &entry : node) {
 			ReInsertNode(root, entry);
 		}
@@ -582,7 +1401,8 @@ void RTree::RootDelete(RTreeEntry &root, const RTreeEntry &target) {
 	} else {
 		if (result.shrunk) {
 			// Update the root bounding box
-			root.bounds = Ref(root.pointer).GetBounds();
+			RTreeNodeBuffer buffer;
+			root.bounds = Ref(root.pointer, buffer).GetBounds();
 		}
 		// Reinsert orphans
 		for (auto &orphan : orphans) {
@@ -604,12 +1424,13 @@ string RTree::ToString() const {
 
 	vector<PrintState> stack;
 	idx_t level = 0;
+	RTreeNodeBuffer buffer;
 
 	stack.emplace_back(root.pointer);
 
 	while (!stack.empty()) {
 		auto &frame = stack.back();
-		const auto &node = Ref(frame.pointer);
+		const auto &node = Ref(frame.pointer, buffer);
 		const auto count = node.GetCount();
 
 		if (frame.pointer.IsLeafPage()) {
@@ -2,27 +2,82 @@
 
 #include "spatial/index/rtree/rtree_node.hpp"
 
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "duckdb/common/unordered_set.hpp"
 #include "duckdb/execution/index/fixed_size_allocator.hpp"
 #include "duckdb/storage/block_manager.hpp"
 
+#include <set>
+
 namespace duckdb {
 
 struct InsertResult;
 struct DeleteResult;
+struct RTree;
+
+//! A consistent view of the tree, for readers that traverse it in several steps while it is being modified. Pages that
+//! are modified while a snapshot is alive keep a copy of their old contents, until every snapshot that can still see
+//! them has been released.
+class RTreeSnapshot {
+public:
+	RTreeSnapshot(const RTree &tree_p, idx_t epoch_p, const RTreeEntry &root_p)
+	    : tree(tree_p), epoch(epoch_p), root(root_p) {
+	}
+	~RTreeSnapshot();
+
+	//! The root of the tree when the snapshot was taken
+	const RTreeEntry &GetRoot() const {
+		return root;
+	}
+	idx_t GetEpoch() const {
+		return epoch;
+	}
+
+private:
+	const RTree &tree;
+	idx_t epoch;
+	RTreeEntry root;
+};
+
+enum class RTreeInsertStrategy : uint8_t {
+	//! Pick subtrees by perimeter enlargement and split nodes into quadrants
+	DEFAULT = 0,
+	//! R*-tree insertion: overlap-minimizing subtree choice, margin-based splits and forced reinsertion
+	RSTAR = 1,
+};
+
+enum class RTreeLeafCompression : uint8_t {
+	//! Store leaf entries as they are
+	NONE = 0,
+	//! Quantize the leaf entry bounds relative to the leaf bounds, and delta-encode the row ids
+	QUANTIZED = 1,
+};
 
 struct RTreeConfig {
 	idx_t max_node_capacity = 128;
 	idx_t min_node_capacity = 50;
+	idx_t max_leaf_capacity = 128;
+	idx_t min_leaf_capacity = 50;
+	RTreeInsertStrategy insert_strategy = RTreeInsertStrategy::DEFAULT;
+	RTreeLeafCompression leaf_compression = RTreeLeafCompression::NONE;
 
-	// TODO: Allow setting leaf capacity separately
-	// idx_t max_leaf_capacity;
-	// idx_t min_leaf_capacity;
+	//! The capacity of a page, leaf pages hold row ids and branch pages hold other pages
+	idx_t GetMaxCapacity(const RTreeNodeType type) const {
+		return type == RTreeNodeType::LEAF_PAGE ? max_leaf_capacity : max_node_capacity;
+	}
+	idx_t GetMinCapacity(const RTreeNodeType type) const {
+		return type == RTreeNodeType::LEAF_PAGE ? min_leaf_capacity : min_node_capacity;
+	}
 
 	idx_t GetNodeByteSize() const {
 		return sizeof(RTreeNode) + (sizeof(RTreeEntry) * max_node_capacity);
 	}
 	idx_t GetLeafByteSize() const {
-		return sizeof(RTreeNode) + (sizeof(RTreeEntry) * max_node_capacity);
+		if (leaf_compression == RTreeLeafCompression::QUANTIZED) {
+			return sizeof(RTreeNode) + sizeof(RTreeCompressedLeaf) + (sizeof(RTreeCompressedEntry) * max_leaf_capacity);
+		}
+		return sizeof(RTreeNode) + (sizeof(RTreeEntry) * max_leaf_capacity);
 	}
 };
 
@@ -36,9 +91,30 @@ public:
 	}
 
 	void Insert(const RTreeEntry &entry) {
-		RootInsert(root, entry);
+		InsertEntry(entry, 0);
 	}
 
+	//! Insert a batch of row id entries. As many entries as possible are packed into full leaves (sort-tile-recursive)
+	//! which are then inserted as subtrees, the rest is inserted one by one. The entries are reordered in the process.
+	void BulkInsert(RTreeEntry *entries, idx_t count);
+
+	//! Insert all entries of another tree into this one, moving over whole subtrees where possible
+	void Merge(const RTree &other);
+
+	//! Rebuild the tree bottom-up from its own row ids, packing them into as few nodes as possible. This releases
+	//! all buffers of the old tree.
+	void Repack();
+
+	//! Compact the allocators by moving pages out of sparsely populated buffers
+	void Vacuum();
+
+	//! Load the pages of the top 'levels' levels of the tree into memory. Pages are otherwise only loaded from storage
+	//! once a scan or modification reaches them.
+	void Prefetch(idx_t levels) const;
+
+	//! The height of the subtree rooted at the entry. Row ids have height 0, leaf pages height 1.
+	idx_t GetHeight(const RTreeEntry &entry) const;
+
 	void Delete(const RTreeEntry &entry) {
 		RootDelete(root, entry);
 	}
@@ -64,7 +140,8 @@ public:
 		root.pointer.Set(root_ptr);
 		// Compute the bounds
 		if (root.pointer.Get() != 0) {
-			root.bounds = Ref(root.pointer).GetBounds();
+			RTreeNodeBuffer buffer;
+			root.bounds = Ref(root.pointer, buffer).GetBounds();
 		}
 	}
 
@@ -77,11 +154,38 @@ public:
 		leaf_allocator->Reset();
 		root.Clear();
 		root.bounds = RTreeBounds();
+		private_pages.clear();
+		page_versions.clear();
 	}
 
 	const RTreeNode &Ref(const RTreePointer &pointer) const;
 	RTreeNode &RefMutable(const RTreePointer &pointer) const;
 
+	//! Whether the page is stored compressed, and has to be accessed through a buffer
+	bool IsCompressed(const RTreePointer &pointer) const {
+		return pointer.IsLeafPage() && config.leaf_compression != RTreeLeafCompression::NONE;
+	}
+	//! Reference any page. Compressed pages are decoded into the buffer, all others are referenced in place
+	const RTreeNode &Ref(const RTreePointer &pointer, RTreeNodeBuffer &buffer) const;
+	//! Reference any page for modification. Changes have to be written back with Write afterwards
+	RTreeNode &RefMutable(const RTreePointer &pointer, RTreeNodeBuffer &buffer) const;
+	//! Write back a page referenced through RefMutable with the same buffer. This encodes compressed pages
+	void Write(const RTreePointer &pointer, RTreeNodeBuffer &buffer) const;
+
+	//! Guards the pages and the allocators. Writers hold it for the duration of a modification, readers only while
+	//! they traverse the tree, and can let go of it in between as long as they read through a snapshot.
+	mutex &GetLock() const {
+		return lock;
+	}
+	//! Take a snapshot of the current tree. The lock must be held
+	shared_ptr<RTreeSnapshot> GetSnapshot() const;
+	//! Whether any snapshot of the tree is still alive. The lock must be held
+	bool HasSnapshots() const {
+		return !snapshot_epochs.empty();
+	}
+	//! Reference any page as it was when the snapshot was taken. The lock must be held
+	const RTreeNode &Ref(const RTreePointer &pointer, RTreeNodeBuffer &buffer, const RTreeSnapshot &snapshot) const;
+
 	RTreePointer MakePage(RTreeNodeType type) const;
 	static RTreePointer MakeRowId(row_t row_id);
 
@@ -89,16 +193,28 @@ public:
 	void Print() const;
 
 private:
+	friend class RTreeSnapshot;
+	void ReleaseSnapshot(idx_t snapshot_epoch) const;
+	//! Copy the contents of a page before it is modified, if a snapshot can still see them
+	void PreservePage(const RTreePointer &pointer, const RTreeNode &node) const;
+
 	void Free(RTreePointer &pointer);
 
-	void RootInsert(RTreeEntry &root_entry, const RTreeEntry &new_entry);
-	InsertResult NodeInsert(RTreeEntry &entry, const RTreeEntry &new_entry);
+	void InsertEntry(const RTreeEntry &new_entry, idx_t new_height);
+	void RootInsert(RTreeEntry &root_entry, const RTreeEntry &new_entry, idx_t new_height);
+	InsertResult NodeInsert(RTreeEntry &entry, const RTreeEntry &new_entry, idx_t height);
 	InsertResult LeafInsert(RTreeEntry &entry, const RTreeEntry &new_entry);
-	InsertResult BranchInsert(RTreeEntry &entry, const RTreeEntry &new_entry);
-	RTreeEntry &PickSubtree(RTreeNode &node, const RTreeEntry &new_entry) const;
+	InsertResult BranchInsert(RTreeEntry &entry, const RTreeEntry &new_entry, idx_t height);
+	idx_t PickSubtree(const RTreeNode &node, const RTreeEntry &new_entry, bool is_parent_level) const;
+	idx_t PickSubtreeRStar(const RTreeNode &node, const RTreeEntry &new_entry, bool is_parent_level) const;
 
 	RTreeEntry SplitNode(RTreeEntry &entry) const;
-	void RebalanceSplitNodes(RTreeNode &src, RTreeNode &dst, bool split_axis, PointXY<float> &split_point) const;
+	RTreeEntry SplitNodeRStar(RTreeEntry &entry) const;
+	void ForceReinsert(RTreeEntry &entry, idx_t height);
+	void RebalanceSplitNodes(RTreeNode &src, RTreeNode &dst, bool split_axis, PointXY<float> &split_point,
+	                         idx_t min_capacity) const;
+
+	void VacuumPointer(RTreePointer &pointer);
 
 	void RootDelete(RTreeEntry &root, const RTreeEntry &target);
 	DeleteResult NodeDelete(RTreeEntry &entry, const RTreeEntry &target, vector<RTreeEntry> &orphans);
@@ -106,6 +222,9 @@ private:
 	DeleteResult BranchDelete(RTreeEntry &entry, const RTreeEntry &target, vector<RTreeEntry> &orphans);
 	void ReInsertNode(RTreeEntry &root, RTreeEntry &target);
 
+	RTreePointer CopySubtree(const RTree &other, const RTreePointer &pointer);
+	void MergeSubtree(const RTree &other, const RTreeEntry &entry, idx_t height);
+
 private:
 	unique_ptr<FixedSizeAllocator> node_allocator;
 	unique_ptr<FixedSizeAllocator> leaf_allocator;
@@ -113,6 +232,27 @@ private:
 	RTreeEntry root;
 
 	const RTreeConfig config;
+
+	//! R* forced reinsertion state of the current insert: the levels that already overflowed once, and the
+	//! entries (and their heights) that were evicted and still have to be reinserted
+	idx_t reinserted_levels = 0;
+	vector<pair<RTreeEntry, idx_t>> reinsert_queue;
+
+	//! The old contents of a page, as seen by the snapshots up to and including 'epoch'
+	struct PageVersion {
+		idx_t epoch;
+		unsafe_unique_array<data_t> data;
+	};
+
+	mutable mutex lock;
+	//! Incremented whenever a snapshot is taken, modifications made after that belong to the new epoch
+	mutable idx_t epoch = 0;
+	//! The epochs of the snapshots that are alive
+	mutable std::multiset<idx_t> snapshot_epochs;
+	//! The pages that no snapshot can see, either because they were created or already preserved in this epoch
+	mutable unordered_set<idx_t> private_pages;
+	//! The preserved contents of the pages that were modified while snapshots were alive, ordered by epoch
+	mutable unordered_map<idx_t, vector<PageVersion>> page_versions;
 };
 
 } // namespace duckdb
\ No newline at end of file
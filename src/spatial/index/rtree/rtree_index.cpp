@@ -7,6 +7,7 @@
 #include "duckdb/main/database.hpp"
 
 #include "spatial/geometry/geometry_type.hpp"
+#include "spatial/geometry/spatial_key.hpp"
 #include "spatial/index/rtree/rtree_module.hpp"
 #include "spatial/index/rtree/rtree_node.hpp"
 #include "spatial/index/rtree/rtree_scanner.hpp"
@@ -21,47 +22,135 @@ class RTreeIndexScanState final : public IndexScanState {
 public:
 	RTreeBounds query_bounds;
 	RTreeScanner scanner;
+
+	//! The version of the index that is scanned
+	shared_ptr<RTreeSnapshot> snapshot;
+
+	//! Entries intersecting any of these bounds are skipped, as they have already been returned by another scan
+	vector<RTreeBounds> excluded_bounds;
+
+	bool IsExcluded(const RTreeBounds &bounds) const {
+		for (const auto &excluded : excluded_bounds) {
+			if (excluded.Intersects(bounds)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool IsCoveredByExcluded(const RTreeBounds &bounds) const {
+		for (const auto &excluded : excluded_bounds) {
+			if (excluded.Contains(bounds)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//! Only used for k-nearest-neighbour scans
+	bool is_knn = false;
+	RTreeKNNScanner knn_scanner;
 };
 
 //------------------------------------------------------------------------------
 // RTree Configuration
 //------------------------------------------------------------------------------
 
-static RTreeConfig ParseOptions(const case_insensitive_map_t<Value> &options) {
-	RTreeConfig config = {};
-
-	const auto max_cap_param_search = options.find("max_node_capacity");
+static void ParseCapacityOptions(const case_insensitive_map_t<Value> &options, const char *max_name,
+                                 const char *min_name, idx_t &max_capacity, idx_t &min_capacity) {
+	const auto max_cap_param_search = options.find(max_name);
 	if (max_cap_param_search != options.end()) {
 		const auto val = max_cap_param_search->second.GetValue<int32_t>();
 		if (val < 4) {
-			throw InvalidInputException("RTree: max_node_capacity must be at least 4");
+			throw InvalidInputException("RTree: %s must be at least 4", max_name);
 		}
 		if (val > 255) {
-			throw InvalidInputException("RTree: max_node_capacity must be at most 255");
+			throw InvalidInputException("RTree: %s must be at most 255", max_name);
 		}
-		config.max_node_capacity = UnsafeNumericCast<idx_t>(val);
+		max_capacity = UnsafeNumericCast<idx_t>(val);
 	}
 
-	const auto min_cap_search = options.find("min_node_capacity");
+	const auto min_cap_search = options.find(min_name);
 	if (min_cap_search != options.end()) {
 		const auto val = min_cap_search->second.GetValue<int32_t>();
 		if (val < 0) {
-			throw InvalidInputException("RTree: min_node_capacity must be at least 0");
+			throw InvalidInputException("RTree: %s must be at least 0", min_name);
 		}
-		if (val > config.max_node_capacity / 2) {
-			throw InvalidInputException("RTree: min_node_capacity must be at most 'max_node_capacity / 2'");
+		if (val > max_capacity / 2) {
+			throw InvalidInputException("RTree: %s must be at most '%s / 2'", min_name, max_name);
 		}
-		config.min_node_capacity = UnsafeNumericCast<idx_t>(val);
+		min_capacity = UnsafeNumericCast<idx_t>(val);
 	} else {
 		// If no min capacity is set, set it to 40% of the max capacity
 		if (max_cap_param_search != options.end()) {
-			config.min_node_capacity = std::ceil(static_cast<double>(config.max_node_capacity) * 0.4);
+			min_capacity = std::ceil(static_cast<double>(max_capacity) * 0.4);
+		}
+	}
+}
+
+static RTreeConfig ParseOptions(const case_insensitive_map_t<Value> &options) {
+	RTreeConfig config = {};
+
+	ParseCapacityOptions(options, "max_node_capacity", "min_node_capacity", config.max_node_capacity,
+	                     config.min_node_capacity);
+
+	// Unless set explicitly, leaves have the same capacity as branches
+	config.max_leaf_capacity = config.max_node_capacity;
+	config.min_leaf_capacity = config.min_node_capacity;
+	ParseCapacityOptions(options, "max_leaf_capacity", "min_leaf_capacity", config.max_leaf_capacity,
+	                     config.min_leaf_capacity);
+
+	const auto strategy_search = options.find("insert_strategy");
+	if (strategy_search != options.end()) {
+		const auto val = StringValue::Get(strategy_search->second.DefaultCastAs(LogicalType::VARCHAR));
+		if (StringUtil::CIEquals(val, "default")) {
+			config.insert_strategy = RTreeInsertStrategy::DEFAULT;
+		} else if (StringUtil::CIEquals(val, "rstar")) {
+			config.insert_strategy = RTreeInsertStrategy::RSTAR;
+		} else {
+			throw InvalidInputException("RTree: insert_strategy must be either 'default' or 'rstar'");
+		}
+	}
+
+	const auto compression_search = options.find("compression");
+	if (compression_search != options.end()) {
+		const auto val = StringValue::Get(compression_search->second.DefaultCastAs(LogicalType::VARCHAR));
+		if (StringUtil::CIEquals(val, "none")) {
+			config.leaf_compression = RTreeLeafCompression::NONE;
+		} else if (StringUtil::CIEquals(val, "quantized")) {
+			config.leaf_compression = RTreeLeafCompression::QUANTIZED;
+		} else {
+			throw InvalidInputException("RTree: compression must be either 'none' or 'quantized'");
 		}
 	}
 
 	return config;
 }
 
+// Compute the index entries of a chunk of keys, skipping the keys without bounds. Returns the number of entries.
+static idx_t GetKeyEntries(const LogicalType &type, Vector &keys, Vector &rowid_vec, idx_t count,
+                           RTreeEntry entries[]) {
+	const SpatialKeyReader key_reader(type, keys, count);
+
+	UnifiedVectorFormat rowid_format;
+	rowid_vec.ToUnifiedFormat(count, rowid_format);
+	const auto rowid_data = UnifiedVectorFormat::GetData<row_t>(rowid_format);
+
+	idx_t entry_count = 0;
+	for (idx_t i = 0; i < count; i++) {
+		const auto rowid_idx = rowid_format.sel->get_index(i);
+		if (!rowid_format.validity.RowIsValid(rowid_idx)) {
+			continue;
+		}
+		Box2D<float> bounds;
+		if (!key_reader.TryGetBounds(i, bounds)) {
+			continue;
+		}
+		entries[entry_count++] = {RTree::MakeRowId(rowid_data[rowid_idx]), bounds};
+	}
+	return entry_count;
+}
+
 //------------------------------------------------------------------------------
 // RTreeIndex Methods
 //------------------------------------------------------------------------------
@@ -95,28 +184,203 @@ RTreeIndex::RTreeIndex(const string &name, IndexConstraintType index_constraint_
 
 	if (info.IsValid()) {
 		// This is an old index that needs to be loaded
-		// Initialize the allocators
+		// Make sure the pages were stored with the capacities we expect
+		if (info.allocator_infos[0].segment_size != config.GetLeafByteSize() ||
+		    info.allocator_infos[1].segment_size != config.GetNodeByteSize()) {
+			throw InternalException("Cannot load RTree index '%s': The stored node and/or leaf capacity does not match "
+			                        "the index options",
+			                        name);
+		}
+		// Initialize the allocators. This does not read the buffers yet, they are loaded once a page in them is used.
 		tree->GetLeafAllocator().Init(info.allocator_infos[0]);
 		tree->GetNodeAllocator().Init(info.allocator_infos[1]);
 		// Set the root node and recalculate the bounds
 		tree->SetRoot(info.root);
+
+		// Optionally load the upper levels of the tree up front
+		Value prefetch_value;
+		if (db.GetDatabase().TryGetCurrentSetting("rtree_index_prefetch_levels", prefetch_value) &&
+		    !prefetch_value.IsNull()) {
+			tree->Prefetch(UBigIntValue::Get(prefetch_value.DefaultCastAs(LogicalType::UBIGINT)));
+		}
 	}
 }
 
+shared_ptr<RTreeSnapshot> RTreeIndex::GetSnapshot() const {
+	lock_guard<mutex> guard(tree->GetLock());
+	return tree->GetSnapshot();
+}
+
 unique_ptr<IndexScanState> RTreeIndex::InitializeScan(const RTreeBounds &query) const {
+	const auto snapshot = GetSnapshot();
+	return InitializeScan(snapshot, query, snapshot->GetRoot());
+}
+
+unique_ptr<IndexScanState> RTreeIndex::InitializeScan(const shared_ptr<RTreeSnapshot> &snapshot,
+                                                      const RTreeBounds &query, const RTreeEntry &subtree,
+                                                      const vector<RTreeBounds> &excluded) const {
 	auto state = make_uniq<RTreeIndexScanState>();
 	state->query_bounds = query;
+	state->excluded_bounds = excluded;
+	state->snapshot = snapshot;
+	if (subtree.pointer.IsSet() && state->query_bounds.Intersects(subtree.bounds)) {
+		state->scanner.Init(subtree, snapshot.get());
+	}
+	return std::move(state);
+}
+
+void RTreeIndex::GetScanUnits(const RTreeSnapshot &snapshot, const RTreeBounds &query, idx_t count,
+                              vector<RTreeEntry> &units) const {
+	units.clear();
+	auto &root = snapshot.GetRoot();
+	if (!root.pointer.IsSet() || !query.Intersects(root.bounds)) {
+		return;
+	}
+
+	lock_guard<mutex> guard(tree->GetLock());
+	RTreeNodeBuffer buffer;
+
+	// Expand the branches one level at a time, until we have enough units or only leaves left
+	units.push_back(root);
+	while (units.size() < count) {
+		vector<RTreeEntry> next_units;
+		bool expanded = false;
+		for (auto &unit : units) {
+			if (!unit.pointer.IsBranchPage()) {
+				next_units.push_back(unit);
+				continue;
+			}
+			expanded = true;
+			for (auto &entry : tree->Ref(unit.pointer, buffer, snapshot)) {
+				if (query.Intersects(entry.bounds)) {
+					next_units.push_back(entry);
+				}
+			}
+		}
+		units = std::move(next_units);
+		if (!expanded) {
+			break;
+		}
+	}
+}
+
+// The fraction of the range [min, max] that overlaps [query_min, query_max]
+static double GetOverlapRatio(float min, float max, float query_min, float query_max) {
+	const auto extent = static_cast<double>(max) - min;
+	if (extent <= 0) {
+		// Degenerate, and we already know it intersects
+		return 1.0;
+	}
+	const auto overlap = static_cast<double>(MinValue(max, query_max)) - MaxValue(min, query_min);
+	return MaxValue(0.0, MinValue(1.0, overlap / extent));
+}
+
+static double EstimateEntrySelectivity(const RTree &tree, const RTreeEntry &entry, const RTreeBounds &query,
+                                       idx_t depth) {
+	if (!query.Intersects(entry.bounds)) {
+		return 0.0;
+	}
+	if (query.Contains(entry.bounds)) {
+		return 1.0;
+	}
+
+	// Only look at the upper levels of the tree, that is where the estimate is decided anyway
+	static constexpr idx_t MAX_ESTIMATE_DEPTH = 3;
+	if (entry.pointer.IsPage() && depth < MAX_ESTIMATE_DEPTH) {
+		RTreeNodeBuffer buffer;
+		const auto &node = tree.Ref(entry.pointer, buffer);
+		if (node.GetCount() == 0) {
+			return 0.0;
+		}
+		// Assume that every child holds roughly the same number of entries, which is true for packed trees
+		double sum = 0;
+		for (const auto &child : node) {
+			sum += EstimateEntrySelectivity(tree, child, query, depth + 1);
+		}
+		return sum / static_cast<double>(node.GetCount());
+	}
+
+	// Assume the entries are uniformly distributed within the bounds
+	return GetOverlapRatio(entry.bounds.min.x, entry.bounds.max.x, query.min.x, query.max.x) *
+	       GetOverlapRatio(entry.bounds.min.y, entry.bounds.max.y, query.min.y, query.max.y);
+}
+
+double RTreeIndex::EstimateSelectivity(const RTreeBounds &query) const {
+	lock_guard<mutex> guard(tree->GetLock());
 	auto &root = tree->GetRoot();
-	if (root.pointer.Get() != 0 && state->query_bounds.Intersects(root.bounds)) {
-		state->scanner.Init(root);
+	if (!root.pointer.IsSet()) {
+		return 0.0;
 	}
+	return EstimateEntrySelectivity(*tree, root, query, 0);
+}
+
+bool RTreeIndex::TryGetExtent(RTreeBounds &extent) const {
+	lock_guard<mutex> guard(tree->GetLock());
+	auto &root = tree->GetRoot();
+	if (!root.pointer.IsSet()) {
+		return false;
+	}
+	extent = root.bounds;
+	return true;
+}
+
+unique_ptr<IndexScanState> RTreeIndex::InitializeKNNScan(const RTreeBounds &query, idx_t k) const {
+	auto state = make_uniq<RTreeIndexScanState>();
+	state->query_bounds = query;
+	state->is_knn = true;
+	state->snapshot = GetSnapshot();
+	state->knn_scanner.Init(state->snapshot->GetRoot(), query, k, state->snapshot.get());
 	return std::move(state);
 }
 
+void RTreeIndex::ConfirmKNNScan(IndexScanState &state, const row_t *row_ids, idx_t count) const {
+	// This only touches the state of the scan, so there is no need to lock the tree
+	state.Cast<RTreeIndexScanState>().knn_scanner.Confirm(row_ids, count);
+}
+
+// Whether the exact extent of an entry certainly intersects the box, given only its leaf bounds. These always contain
+// the exact extent, so that is certain if they are contained in the box. Uncompressed leaf bounds are also the exact
+// extent rounded outwards to the next float, so the exact extent starts before the float after the minimum, and ends
+// after the float before the maximum.
+static bool ExtentIntersects(const RTreeBounds &bounds, const Box2D<double> &box, bool is_rounded) {
+	if (bounds.min.x >= box.min.x && bounds.min.y >= box.min.y && bounds.max.x <= box.max.x &&
+	    bounds.max.y <= box.max.y) {
+		return true;
+	}
+	if (!is_rounded) {
+		return false;
+	}
+	// Values beyond the float range are clamped to it instead
+	const auto limit = NumericLimits<float>::Maximum();
+	const auto lowest = NumericLimits<float>::Minimum();
+	if (!(bounds.min.x > lowest && bounds.min.y > lowest && bounds.max.x < limit && bounds.max.y < limit)) {
+		return false;
+	}
+	return std::nextafter(bounds.min.x, limit) <= box.max.x && std::nextafter(bounds.min.y, limit) <= box.max.y &&
+	       std::nextafter(bounds.max.x, lowest) >= box.min.x && std::nextafter(bounds.max.y, lowest) >= box.min.y;
+}
+
 idx_t RTreeIndex::Scan(IndexScanState &state, Vector &result) const {
+	vector<row_t> uncertain;
+	return Scan(state, result, Box2D<double>(), uncertain);
+}
+
+idx_t RTreeIndex::Scan(IndexScanState &state, Vector &result, const Box2D<double> &exact_box,
+                       vector<row_t> &uncertain) const {
 	auto &sstate = state.Cast<RTreeIndexScanState>();
 	const auto row_ids = FlatVector::GetData<row_t>(result);
 
+	// The scan reads through its snapshot, so writers only have to wait for the current batch
+	lock_guard<mutex> guard(tree->GetLock());
+
+	if (sstate.is_knn) {
+		return sstate.knn_scanner.Scan(*tree, row_ids, STANDARD_VECTOR_SIZE);
+	}
+
+	// An empty box means that there is no exact extent to check
+	const auto is_exact = exact_box.min.x <= exact_box.max.x;
+	const auto is_rounded = tree->GetConfig().leaf_compression == RTreeLeafCompression::NONE;
+
 	idx_t output_idx = 0;
 	sstate.scanner.Scan(*tree, [&](const RTreeEntry &entry, const idx_t &) {
 		// Does this entry intersect with the query bounds?
@@ -124,8 +388,16 @@ idx_t RTreeIndex::Scan(IndexScanState &state, Vector &result) const {
 			// No, skip it
 			return RTreeScanResult::SKIP;
 		}
+		// Has this entry (or the whole subtree) already been returned by another scan?
+		if (entry.pointer.IsRowId() ? sstate.IsExcluded(entry.bounds) : sstate.IsCoveredByExcluded(entry.bounds)) {
+			return RTreeScanResult::SKIP;
+		}
 		// Is this a row id?
 		if (entry.pointer.IsRowId()) {
+			if (is_exact && !ExtentIntersects(entry.bounds, exact_box, is_rounded)) {
+				uncertain.push_back(entry.pointer.GetRowId());
+				return RTreeScanResult::CONTINUE;
+			}
 			row_ids[output_idx++] = entry.pointer.GetRowId();
 			// Have we filled the result vector?
 			if (output_idx == STANDARD_VECTOR_SIZE) {
@@ -138,54 +410,24 @@ idx_t RTreeIndex::Scan(IndexScanState &state, Vector &result) const {
 	return output_idx;
 }
 
+idx_t RTreeIndex::GetScanNodeCount(IndexScanState &state) const {
+	auto &sstate = state.Cast<RTreeIndexScanState>();
+	return sstate.is_knn ? sstate.knn_scanner.GetNodeCount() : sstate.scanner.GetNodeCount();
+}
+
 void RTreeIndex::CommitDrop(IndexLock &index_lock) {
 	// TODO: Maybe we can drop these much earlier?
+	lock_guard<mutex> guard(tree->GetLock());
 	tree->Reset();
 }
 
 ErrorData RTreeIndex::Insert(IndexLock &lock, DataChunk &input, Vector &rowid_vec) {
-	// TODO: Dont flatten chunk
-	input.Flatten();
-
-	auto &geom_vec = input.data[0];
-	const auto &geom_data = FlatVector::GetData<geometry_t>(geom_vec);
-	const auto &rowid_data = FlatVector::GetData<row_t>(rowid_vec);
-
-	if (geom_data == nullptr || rowid_data == nullptr) {
-		return ErrorData {};
-	}
-
 	RTreeEntry entry_buffer[STANDARD_VECTOR_SIZE];
-	bool valid_buffer[STANDARD_VECTOR_SIZE];
-
-	for (idx_t i = 0; i < input.size(); i++) {
-		if (FlatVector::IsNull(geom_vec, i) || FlatVector::IsNull(rowid_vec, i)) {
-			valid_buffer[i] = false;
-			continue;
-		}
-
-		const auto rowid = rowid_data[i];
-
-		Box2D<float> bbox;
-		if (!geom_data[i].TryGetCachedBounds(bbox)) {
-			valid_buffer[i] = false;
-			continue;
-		}
-
-		entry_buffer[i] = {RTree::MakeRowId(rowid), bbox};
-		valid_buffer[i] = true;
-	}
+	const auto entry_count = GetKeyEntries(logical_types[0], input.data[0], rowid_vec, input.size(), entry_buffer);
 
-	// TODO: Investigate this more, is there a better way to insert multiple entries
-	// so that they produce a better tree?
-	// E.g. sort by x coordinate, or hilbert sort? or STR packing?
-	// Or insert by smallest first? or largest first?
-	// Or even create a separate subtree entirely, and then insert that into the root?
-	for (idx_t i = 0; i < input.size(); i++) {
-		if (valid_buffer[i]) {
-			tree->Insert(entry_buffer[i]);
-		}
-	}
+	// Pack the chunk into full leaves and insert those as subtrees, instead of inserting every row on its own
+	lock_guard<mutex> guard(tree->GetLock());
+	tree->BulkInsert(entry_buffer, entry_count);
 
 	return ErrorData {};
 }
@@ -198,41 +440,24 @@ ErrorData RTreeIndex::Append(IndexLock &lock, DataChunk &appended_data, Vector &
 }
 
 void RTreeIndex::Delete(IndexLock &lock, DataChunk &input, Vector &rowid_vec) {
-	const auto count = input.size();
-
 	DataChunk expr_chunk;
 	expr_chunk.Initialize(Allocator::DefaultAllocator(), logical_types);
 	ExecuteExpressions(input, expr_chunk);
 
-	UnifiedVectorFormat geom_format;
-	UnifiedVectorFormat rowid_format;
-
-	expr_chunk.data[0].ToUnifiedFormat(count, geom_format);
-	rowid_vec.ToUnifiedFormat(count, rowid_format);
-
-	for (idx_t i = 0; i < count; i++) {
-		const auto geom_idx = geom_format.sel->get_index(i);
-		const auto rowid_idx = rowid_format.sel->get_index(i);
-
-		if (!geom_format.validity.RowIsValid(geom_idx) || !rowid_format.validity.RowIsValid(rowid_idx)) {
-			continue;
-		}
-
-		auto &geom = UnifiedVectorFormat::GetData<geometry_t>(geom_format)[geom_idx];
-		auto &rowid = UnifiedVectorFormat::GetData<row_t>(rowid_format)[rowid_idx];
-
-		Box2D<float> approx_bounds;
-		if (!geom.TryGetCachedBounds(approx_bounds)) {
-			continue;
-		}
+	RTreeEntry entry_buffer[STANDARD_VECTOR_SIZE];
+	const auto entry_count =
+	    GetKeyEntries(logical_types[0], expr_chunk.data[0], rowid_vec, input.size(), entry_buffer);
 
-		RTreeEntry new_entry = {RTree::MakeRowId(rowid), approx_bounds};
-		tree->Delete(new_entry);
+	lock_guard<mutex> guard(tree->GetLock());
+	for (idx_t i = 0; i < entry_count; i++) {
+		tree->Delete(entry_buffer[i]);
 	}
 }
 
 IndexStorageInfo RTreeIndex::GetStorageInfo(const case_insensitive_map_t<Value> &options, const bool to_wal) {
 
+	lock_guard<mutex> guard(tree->GetLock());
+
 	IndexStorageInfo info;
 	info.name = name;
 	info.root = tree->GetRoot().pointer.Get();
@@ -241,13 +466,15 @@ IndexStorageInfo RTreeIndex::GetStorageInfo(const case_insensitive_map_t<Value>
 	auto &node_allocator = tree->GetNodeAllocator();
 
 	if (!to_wal) {
-		// use the partial block manager to serialize all allocator data
+		// use the partial block manager to serialize all allocator data. Buffers that are already on disk and were
+		// not dirtied since the last checkpoint are skipped, so the tree only dirties the pages it actually modifies.
 		auto &block_manager = table_io_manager.GetIndexBlockManager();
 		PartialBlockManager partial_block_manager(block_manager, PartialBlockType::FULL_CHECKPOINT);
 		leaf_allocator.SerializeBuffers(partial_block_manager);
 		node_allocator.SerializeBuffers(partial_block_manager);
 		partial_block_manager.FlushPartialBlocks();
 	} else {
+		// The WAL record has to be self-contained, so it always contains every buffer
 		info.buffers.push_back(leaf_allocator.InitSerializationToWAL());
 		info.buffers.push_back(node_allocator.InitSerializationToWAL());
 	}
@@ -259,16 +486,27 @@ IndexStorageInfo RTreeIndex::GetStorageInfo(const case_insensitive_map_t<Value>
 }
 
 idx_t RTreeIndex::GetInMemorySize(IndexLock &state) {
+	lock_guard<mutex> guard(tree->GetLock());
 	const auto &leaf_alloc = tree->GetLeafAllocator();
 	const auto &node_alloc = tree->GetNodeAllocator();
 	return leaf_alloc.GetInMemorySize() + node_alloc.GetInMemorySize();
 }
 
 bool RTreeIndex::MergeIndexes(IndexLock &state, BoundIndex &other_index) {
-	throw NotImplementedException("RTreeIndex::MergeIndexes() not implemented");
+	auto &other = other_index.Cast<RTreeIndex>();
+	lock_guard<mutex> guard(tree->GetLock());
+	tree->Merge(*other.tree);
+	return true;
 }
 
 void RTreeIndex::Vacuum(IndexLock &state) {
+	lock_guard<mutex> guard(tree->GetLock());
+	tree->Vacuum();
+}
+
+void RTreeIndex::Repack(IndexLock &state) {
+	lock_guard<mutex> guard(tree->GetLock());
+	tree->Repack();
 }
 
 string RTreeIndex::VerifyAndToString(IndexLock &state, const bool only_verify) {
@@ -294,6 +532,11 @@ void RTreeModule::RegisterIndex(DatabaseInstance &db) {
 
 	// Register the index type
 	db.config.GetIndexTypes().RegisterIndexType(index_type);
+
+	db.config.AddExtensionOption("rtree_index_prefetch_levels",
+	                             "The number of levels of a persisted RTREE index to load into memory when the index is "
+	                             "loaded. Other pages are read from storage once a query reaches them",
+	                             LogicalType::UBIGINT, Value::UBIGINT(0));
 }
 
 } // namespace duckdb
\ No newline at end of file
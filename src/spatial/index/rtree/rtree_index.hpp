@@ -25,8 +25,38 @@ public:
 
 	unique_ptr<RTree> tree;
 
+	//! Take a snapshot of the index. Scans through a snapshot see the index as it was when the snapshot was taken, and
+	//! do not block modifications of the index in between the calls to Scan
+	shared_ptr<RTreeSnapshot> GetSnapshot() const;
+
 	unique_ptr<IndexScanState> InitializeScan(const Box2D<float> &query) const;
+	//! Initialize a scan of the subtree rooted at the given entry of the snapshot. Entries that intersect any of the
+	//! excluded boxes are skipped, so that scans of several overlapping query boxes return each row only once
+	unique_ptr<IndexScanState> InitializeScan(const shared_ptr<RTreeSnapshot> &snapshot, const Box2D<float> &query,
+	                                          const RTreeEntry &subtree,
+	                                          const vector<Box2D<float>> &excluded = {}) const;
+	//! Split the part of the snapshot that intersects the query into (at least) 'count' disjoint subtrees, if
+	//! possible. Each subtree can then be scanned separately.
+	void GetScanUnits(const RTreeSnapshot &snapshot, const Box2D<float> &query, idx_t count,
+	                  vector<RTreeEntry> &units) const;
+	//! Estimate the fraction of the indexed entries that intersect the query, from the bounds of the upper levels
+	double EstimateSelectivity(const Box2D<float> &query) const;
+	//! Get the bounds of all entries in the index, false if it is empty. Deleted rows may still be included, until
+	//! they are removed from the index
+	bool TryGetExtent(Box2D<float> &extent) const;
+	//! Initialize a scan for the k nearest entries to the query box. This returns a superset of the k nearest rows
+	//! that still has to be ordered by the exact distance (see RTreeKNNScanner)
+	unique_ptr<IndexScanState> InitializeKNNScan(const Box2D<float> &query, idx_t k) const;
+	//! Confirm which of the rows returned by the last Scan of a nearest neighbour scan are visible to the transaction.
+	//! Only these count towards the k nearest rows
+	void ConfirmKNNScan(IndexScanState &state, const row_t *row_ids, idx_t count) const;
 	idx_t Scan(IndexScanState &state, Vector &result) const;
+	//! Scan for the rows whose exact extent intersects the box. The leaf bounds are rounded outwards, so rows where
+	//! they can not decide this are not returned, but added to 'uncertain' instead, and have to be checked separately
+	idx_t Scan(IndexScanState &state, Vector &result, const Box2D<double> &exact_box,
+	           vector<row_t> &uncertain) const;
+	//! The number of index nodes visited by a scan so far
+	idx_t GetScanNodeCount(IndexScanState &state) const;
 
 	static unique_ptr<BoundIndex> Create(CreateIndexInput &input) {
 		auto res = make_uniq<RTreeIndex>(input.name, input.constraint_type, input.column_ids, input.table_io_manager,
@@ -57,6 +87,9 @@ public:
 	//! Traverses an RTreeIndex and vacuums the qualifying nodes. The lock obtained from InitializeLock must be held
 	void Vacuum(IndexLock &state) override;
 
+	//! Rebuilds the RTreeIndex bottom-up from its own entries. The lock obtained from InitializeLock must be held
+	void Repack(IndexLock &state);
+
 	//! Returns the string representation of the RTreeIndex, or only traverses and verifies the index
 	string VerifyAndToString(IndexLock &state, const bool only_verify) override;
 
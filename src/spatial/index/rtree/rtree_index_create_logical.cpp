@@ -1,6 +1,7 @@
 #include "spatial/index/rtree/rtree_index_create_logical.hpp"
 #include "spatial/index/rtree/rtree_index.hpp"
 #include "spatial/index/rtree/rtree_index_create_physical.hpp"
+#include "spatial/geometry/spatial_key.hpp"
 #include "spatial/spatial_types.hpp"
 
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
@@ -43,12 +44,18 @@ static PhysicalOperator &CreateNullFilter(PhysicalPlanGenerator &generator, cons
                                           const vector<LogicalType> &types, ClientContext &context) {
 	vector<unique_ptr<Expression>> filter_select_list;
 
-	// Filter NOT NULL on the GEOMETRY column
+	// Filter NOT NULL on the key column
 	auto is_not_null_expr =
 	    make_uniq<BoundOperatorExpression>(ExpressionType::OPERATOR_IS_NOT_NULL, LogicalType::BOOLEAN);
 	auto bound_ref = make_uniq<BoundReferenceExpression>(types[0], 0);
 	is_not_null_expr->children.push_back(bound_ref->Copy());
 
+	if (types[0] != GeoTypes::GEOMETRY()) {
+		// Points and boxes are never empty
+		filter_select_list.push_back(std::move(is_not_null_expr));
+		return generator.Make<PhysicalFilter>(types, std::move(filter_select_list), op.estimated_cardinality);
+	}
+
 	// Filter IS_NOT_EMPTY on the GEOMETRY column
 	auto &catalog = Catalog::GetSystemCatalog(context);
 	auto &is_empty_entry = catalog.GetEntry(context, CatalogType::SCALAR_FUNCTION_ENTRY, DEFAULT_SCHEMA, "ST_IsEmpty")
@@ -72,16 +79,17 @@ static PhysicalOperator &CreateNullFilter(PhysicalPlanGenerator &generator, cons
 }
 
 static PhysicalOperator &CreateBoundingBoxProjection(PhysicalPlanGenerator &planner, const LogicalOperator &op,
-                                                     const vector<LogicalType> &types, ClientContext &context) {
+                                                     const LogicalType &key_type, const vector<LogicalType> &types,
+                                                     ClientContext &context) {
 	auto &catalog = Catalog::GetSystemCatalog(context);
 
 	// Get the bounding box function
 	auto &bbox_func_entry =
 	    catalog.GetEntry(context, CatalogType::SCALAR_FUNCTION_ENTRY, DEFAULT_SCHEMA, "ST_Extent_Approx")
 	        .Cast<ScalarFunctionCatalogEntry>();
-	auto bbox_func = bbox_func_entry.functions.GetFunctionByArguments(context, {GeoTypes::GEOMETRY()});
+	auto bbox_func = bbox_func_entry.functions.GetFunctionByArguments(context, {key_type});
 
-	auto geom_ref_expr = make_uniq_base<Expression, BoundReferenceExpression>(GeoTypes::GEOMETRY(), 0);
+	auto geom_ref_expr = make_uniq_base<Expression, BoundReferenceExpression>(key_type, 0);
 	vector<unique_ptr<Expression>> bbox_args;
 	bbox_args.push_back(std::move(geom_ref_expr));
 
@@ -150,9 +158,9 @@ PhysicalOperator &RTreeIndex::CreatePlan(PlanIndexInput &input) {
 
 	auto &expr = op.unbound_expressions[0];
 
-	// Validate that we have the right type of expression (float array)
-	if (expr->return_type != GeoTypes::GEOMETRY()) {
-		throw BinderException("RTree indexes can only be created over GEOMETRY columns.");
+	// Validate that we have the right type of expression
+	if (!SpatialKey::IsKeyType(expr->return_type)) {
+		throw BinderException("RTree indexes can only be created over GEOMETRY, POINT_2D, BOX_2D or BOX_2DF columns.");
 	}
 
 	// Validate that the expression does not have side effects
@@ -179,13 +187,13 @@ PhysicalOperator &RTreeIndex::CreatePlan(PlanIndexInput &input) {
 	    planner.Make<PhysicalProjection>(new_column_types, std::move(select_list), op.estimated_cardinality);
 	projection.children.push_back(table_scan);
 
-	// Filter operator for (IS_NOT_NULL) and (NOT ST_IsEmpty) on the geometry column
+	// Filter operator for (IS_NOT_NULL) and (NOT ST_IsEmpty) on the key column
 	auto &null_filter = CreateNullFilter(planner, op, new_column_types, context);
 	null_filter.children.push_back(projection);
 
 	// Project the bounding box and the row ID
 	vector<LogicalType> projected_types = {GeoTypes::BOX_2DF(), LogicalType::ROW_TYPE};
-	auto &bbox_proj = CreateBoundingBoxProjection(planner, op, projected_types, context);
+	auto &bbox_proj = CreateBoundingBoxProjection(planner, op, new_column_types[0], projected_types, context);
 	bbox_proj.children.push_back(null_filter);
 
 	// Create an ORDER_BY operator to sort the bounding boxes by the xmin value
@@ -217,9 +225,9 @@ PhysicalOperator &LogicalCreateRTreeIndex::CreatePlan(ClientContext &context, Ph
 
 	auto &expr = op.unbound_expressions[0];
 
-	// Validate that we have the right type of expression (float array)
-	if (expr->return_type != GeoTypes::GEOMETRY()) {
-		throw BinderException("RTree indexes can only be created over GEOMETRY columns.");
+	// Validate that we have the right type of expression
+	if (!SpatialKey::IsKeyType(expr->return_type)) {
+		throw BinderException("RTree indexes can only be created over GEOMETRY, POINT_2D, BOX_2D or BOX_2DF columns.");
 	}
 
 	// Validate that the expression does not have side effects
@@ -256,13 +264,13 @@ PhysicalOperator &LogicalCreateRTreeIndex::CreatePlan(ClientContext &context, Ph
 	    planner.Make<PhysicalProjection>(new_column_types, std::move(select_list), op.estimated_cardinality);
 	projection.children.push_back(table_scan);
 
-	// Filter operator for (IS_NOT_NULL) and (NOT ST_IsEmpty) on the geometry column
+	// Filter operator for (IS_NOT_NULL) and (NOT ST_IsEmpty) on the key column
 	auto &null_filter = CreateNullFilter(planner, op, new_column_types, context);
 	null_filter.children.push_back(projection);
 
 	// Project the bounding box and the row ID
 	vector<LogicalType> projected_types = {GeoTypes::BOX_2DF(), LogicalType::ROW_TYPE};
-	auto &bbox_proj = CreateBoundingBoxProjection(planner, op, projected_types, context);
+	auto &bbox_proj = CreateBoundingBoxProjection(planner, op, new_column_types[0], projected_types, context);
 	bbox_proj.children.push_back(null_filter);
 
 	// Create an ORDER_BY operator to sort the bounding boxes by the xmin value
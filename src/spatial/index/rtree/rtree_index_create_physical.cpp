@@ -61,6 +61,7 @@ public:
 
 	idx_t entry_idx;
 	idx_t max_node_capacity;
+	idx_t max_leaf_capacity;
 
 	explicit CreateRTreeIndexGlobalState(ClientContext &context)
 	    : curr_layer(BufferManager::GetBufferManager(context)), next_layer(BufferManager::GetBufferManager(context)),
@@ -82,6 +83,7 @@ unique_ptr<GlobalSinkState> PhysicalCreateRTreeIndex::GetGlobalSinkState(ClientC
 	                          info->options, IndexStorageInfo(), estimated_cardinality);
 
 	gstate->max_node_capacity = gstate->rtree->tree->GetConfig().max_node_capacity;
+	gstate->max_leaf_capacity = gstate->rtree->tree->GetConfig().max_leaf_capacity;
 	gstate->entry_idx = gstate->max_node_capacity;
 
 	gstate->curr_layer.InitializeAppend(gstate->append_state);
@@ -111,9 +113,14 @@ SinkResultType PhysicalCreateRTreeIndex::Sink(ExecutionContext &context, DataChu
 	const auto max_y_data = FlatVector::GetData<float>(*bbox_vecs[3]);
 
 	// Vectorized conversion from columnar to row-wise
+	// Keys without bounds (e.g. points with NaN coordinates) have a NULL box, and are not indexed
 	RTreeEntry entries[STANDARD_VECTOR_SIZE];
+	idx_t entry_count = 0;
 	for (idx_t elem_idx = 0; elem_idx < chunk.size(); elem_idx++) {
-		auto &entry = entries[elem_idx];
+		if (FlatVector::IsNull(chunk.data[0], elem_idx)) {
+			continue;
+		}
+		auto &entry = entries[entry_count++];
 		entry.pointer = RTree::MakeRowId(rowid_data[elem_idx]);
 		entry.bounds.min.x = min_x_data[elem_idx];
 		entry.bounds.min.y = min_y_data[elem_idx];
@@ -122,10 +129,10 @@ SinkResultType PhysicalCreateRTreeIndex::Sink(ExecutionContext &context, DataChu
 	}
 
 	// Append the chunk to the current layer
-	gstate.curr_layer.Append(gstate.append_state, entries, entries + chunk.size());
+	gstate.curr_layer.Append(gstate.append_state, entries, entries + entry_count);
 
 	// Count the number of entries
-	gstate.rtree_size += chunk.size();
+	gstate.rtree_size += entry_count;
 
 	return SinkResultType::NEED_MORE_INPUT;
 }
@@ -140,8 +147,14 @@ static TaskExecutionResult BuildRTreeBottomUp(CreateRTreeIndexGlobalState &state
 	auto slice_begin = reinterpret_cast<RTreeEntry *>(state.slice_buffer.get());
 	auto slice_end = slice_begin + state.slice_size;
 
+	// Scratch space for compressed leaves
+	RTreeNodeBuffer buffer;
+
 	// Now, we have our base layer with all the leaves, we need to build the rest of the tree layer by layer
 	while (state.curr_layer_ptr->Count() != 1) {
+		// The first layer we build consists of leaves, the rest of branches
+		const auto capacity = state.rtree_level == 0 ? state.max_leaf_capacity : state.max_node_capacity;
+
 		if (state.scan_state.IsDone()) {
 
 			// Swap the layers and initialize the next layer
@@ -153,14 +166,13 @@ static TaskExecutionResult BuildRTreeBottomUp(CreateRTreeIndexGlobalState &state
 			}
 
 			// Current layer size, divided by the node capacity (rounded up)
-			const auto next_layer_size =
-			    (state.curr_layer_ptr->Count() + state.max_node_capacity - 1) / state.max_node_capacity;
+			const auto next_layer_size = (state.curr_layer_ptr->Count() + capacity - 1) / capacity;
 			state.next_layer_ptr->Clear();
 			state.next_layer_ptr->InitializeAppend(state.append_state, next_layer_size);
 			state.curr_layer_ptr->InitializeScan(state.scan_state, true);
 		}
 
-		idx_t child_idx = state.max_node_capacity;
+		idx_t child_idx = capacity;
 		RTreePointer current_ptr;
 		bool needs_insertion = false;
 
@@ -178,25 +190,25 @@ static TaskExecutionResult BuildRTreeBottomUp(CreateRTreeIndexGlobalState &state
 			while (scan_idx < scan_count) {
 
 				// Initialize a new node if we have to
-				if (child_idx == state.max_node_capacity) {
+				if (child_idx == capacity) {
 					auto node_type = state.rtree_level == 0 ? RTreeNodeType::LEAF_PAGE : RTreeNodeType::BRANCH_PAGE;
 					current_ptr = tree.MakePage(node_type);
 					child_idx = 0;
 					needs_insertion = true;
 				}
 
-				const auto remaining_capacity = state.max_node_capacity - child_idx;
+				const auto remaining_capacity = capacity - child_idx;
 				const auto remaining_elements = scan_count - scan_idx;
 
 				// Dereference the current node
-				auto &node = tree.RefMutable(current_ptr);
+				auto &node = tree.RefMutable(current_ptr, buffer);
 
 				for (idx_t j = 0; j < MinValue<idx_t>(remaining_capacity, remaining_elements); j++) {
 					node.PushEntry(slice_begin[scan_idx++]);
 					child_idx++;
 				}
 
-				if (child_idx == state.max_node_capacity) {
+				if (child_idx == capacity) {
 					// Append the current node to the layer
 					if (current_ptr.GetType() == RTreeNodeType::LEAF_PAGE) {
 						// If the node is a leaf node, sort it by row id
@@ -206,8 +218,10 @@ static TaskExecutionResult BuildRTreeBottomUp(CreateRTreeIndexGlobalState &state
 					state.next_layer_ptr->Append(state.append_state, RTreeEntry {current_ptr, node_bounds});
 					needs_insertion = false;
 
-					node.Verify(state.max_node_capacity);
+					node.Verify(capacity);
 				}
+
+				tree.Write(current_ptr, buffer);
 			}
 
 			// Scan the next batch
@@ -216,11 +230,12 @@ static TaskExecutionResult BuildRTreeBottomUp(CreateRTreeIndexGlobalState &state
 
 		// If the layer was exhausted before we filled the last node, we need to insert it now
 		if (needs_insertion) {
-			auto &node = tree.RefMutable(current_ptr);
+			auto &node = tree.RefMutable(current_ptr, buffer);
 			if (current_ptr.GetType() == RTreeNodeType::LEAF_PAGE) {
 				// If the node is a leaf node, sort it by row id
 				node.SortEntriesByRowId();
 			}
+			tree.Write(current_ptr, buffer);
 			auto node_bounds = node.GetBounds();
 			state.next_layer_ptr->Append(state.append_state, RTreeEntry {current_ptr, node_bounds});
 			needs_insertion = false;
@@ -241,8 +256,9 @@ static TaskExecutionResult BuildRTreeBottomUp(CreateRTreeIndexGlobalState &state
 	if (root.pointer.GetType() == RTreeNodeType::ROW_ID) {
 		// Create a leaf node to hold this row id
 		auto root_leaf_ptr = tree.MakePage(RTreeNodeType::LEAF_PAGE);
-		auto &node = tree.RefMutable(root_leaf_ptr);
+		auto &node = tree.RefMutable(root_leaf_ptr, buffer);
 		node.PushEntry(RTreeEntry {root.pointer, root.bounds});
+		tree.Write(root_leaf_ptr, buffer);
 		tree.SetRoot(RTreeEntry {root_leaf_ptr, root.bounds});
 	} else {
 		// Else, just set the root node
@@ -345,10 +361,10 @@ SinkFinalizeType PhysicalCreateRTreeIndex::Finalize(Pipeline &pipeline, Event &e
 	// Otherwise, we need to build the RTree
 
 	// Calculate the vertical slice size
-	// square root of the total number of entries divide by the capacity of a node, rounded up
+	// square root of the total number of entries divide by the capacity of a leaf, rounded up
 	gstate.slice_size = ExactNumericCast<idx_t>(std::ceil(
-	                        std::sqrt((gstate.rtree_size + gstate.max_node_capacity - 1) / gstate.max_node_capacity))) *
-	                    gstate.max_node_capacity;
+	                        std::sqrt((gstate.rtree_size + gstate.max_leaf_capacity - 1) / gstate.max_leaf_capacity))) *
+	                    gstate.max_leaf_capacity;
 
 	// Allocate a buffer for the vertical slice
 	// (this can get quite large, so we allocate it on the buffer manager)
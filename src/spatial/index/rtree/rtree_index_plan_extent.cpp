@@ -0,0 +1,274 @@
+#include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/optimizer/optimizer.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+#include "duckdb/planner/expression/bound_aggregate_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/operator/logical_aggregate.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/storage/data_table.hpp"
+#include "duckdb/storage/table/scan_state.hpp"
+#include "duckdb/transaction/local_storage.hpp"
+
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/index/rtree/rtree_index.hpp"
+#include "spatial/index/rtree/rtree_module.hpp"
+#include "spatial/spatial_types.hpp"
+
+namespace duckdb {
+
+//-----------------------------------------------------------------------------
+// Index Extent Scan
+//-----------------------------------------------------------------------------
+// Replaces the table scan below an ungrouped ST_Extent_Agg_Approx over an RTREE indexed column. Instead of the rows of
+// the table, it returns a single polygon spanning the bounds of the root of the index, which are the union of the
+// (float) bounds of all indexed geometries, followed by the rows that the transaction appended itself and that are not
+// in the index yet. The aggregate on top then computes the same extent as it would over the whole table.
+//
+// The bounds are read when the scan starts, not when the query is planned, so that prepared statements do not return
+// stale bounds. Rows are only removed from the index once their deletion is committed and cleaned up, so until then
+// they still count towards the extent. That is fine for an approximation, which only has to contain the exact extent.
+
+namespace {
+
+struct RTreeIndexExtentBindData final : public TableFunctionData {
+	RTreeIndexExtentBindData(DuckTableEntry &table, Index &index) : table(table), index(index) {
+	}
+
+	//! The table whose scan is replaced
+	DuckTableEntry &table;
+
+	//! The index to take the bounds from
+	Index &index;
+
+public:
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<RTreeIndexExtentBindData>();
+		return &other.table == &table && &other.index == &index;
+	}
+};
+
+struct RTreeIndexExtentGlobalState final : public GlobalTableFunctionState {
+	TableScanState local_storage_state;
+	vector<StorageIndex> column_ids;
+	bool finished = false;
+};
+
+unique_ptr<GlobalTableFunctionState> RTreeIndexExtentInitGlobal(ClientContext &context,
+                                                                TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<RTreeIndexExtentBindData>();
+	auto result = make_uniq<RTreeIndexExtentGlobalState>();
+
+	for (auto &id : input.column_ids) {
+		result->column_ids.emplace_back(bind_data.table.GetColumn(LogicalIndex(id)).StorageOid());
+	}
+
+	auto &local_storage = LocalStorage::Get(context, bind_data.table.catalog);
+	result->local_storage_state.Initialize(result->column_ids, context, input.filters);
+	local_storage.InitializeScan(bind_data.table.GetStorage(), result->local_storage_state.local_state, input.filters);
+	return std::move(result);
+}
+
+void RTreeIndexExtentExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind_data = data_p.bind_data->Cast<RTreeIndexExtentBindData>();
+	auto &gstate = data_p.global_state->Cast<RTreeIndexExtentGlobalState>();
+
+	if (gstate.finished) {
+		output.SetCardinality(0);
+		return;
+	}
+
+	// First the rows appended by this transaction
+	auto &local_storage = LocalStorage::Get(context, bind_data.table.catalog);
+	local_storage.Scan(gstate.local_storage_state.local_state, gstate.column_ids, output);
+	if (output.size() != 0) {
+		return;
+	}
+
+	// Then the bounds of everything in the index
+	gstate.finished = true;
+
+	Box2D<float> extent;
+	if (!bind_data.index.Cast<RTreeIndex>().TryGetExtent(extent)) {
+		output.SetCardinality(0);
+		return;
+	}
+
+	double buf[10];
+	buf[0] = extent.min.x;
+	buf[1] = extent.min.y;
+
+	buf[2] = extent.min.x;
+	buf[3] = extent.max.y;
+
+	buf[4] = extent.max.x;
+	buf[5] = extent.max.y;
+
+	buf[6] = extent.max.x;
+	buf[7] = extent.min.y;
+
+	buf[8] = extent.min.x;
+	buf[9] = extent.min.y;
+
+	sgl::geometry ring(sgl::geometry_type::LINESTRING, false, false);
+	ring.set_vertex_data(reinterpret_cast<const char *>(buf), 5);
+
+	sgl::geometry bbox(sgl::geometry_type::POLYGON, false, false);
+	bbox.append_part(&ring);
+
+	// The vertices are floats already, so the cached bounds of the polygon are exactly the bounds of the index
+	const auto size = Serde::GetRequiredSize(bbox);
+	auto blob = StringVector::EmptyString(output.data[0], size);
+	Serde::Serialize(bbox, blob.GetDataWriteable(), size);
+	blob.Finalize();
+
+	FlatVector::GetData<string_t>(output.data[0])[0] = blob;
+	output.SetCardinality(1);
+}
+
+unique_ptr<NodeStatistics> RTreeIndexExtentCardinality(ClientContext &context, const FunctionData *bind_data_p) {
+	auto &bind_data = bind_data_p->Cast<RTreeIndexExtentBindData>();
+	auto &local_storage = LocalStorage::Get(context, bind_data.table.catalog);
+	const auto row_count = 1 + local_storage.AddedRows(bind_data.table.GetStorage());
+	return make_uniq<NodeStatistics>(row_count, row_count);
+}
+
+InsertionOrderPreservingMap<string> RTreeIndexExtentToString(TableFunctionToStringInput &input) {
+	auto &bind_data = input.bind_data->Cast<RTreeIndexExtentBindData>();
+	InsertionOrderPreservingMap<string> result;
+	result["Table"] = bind_data.table.name;
+	result["Index"] = bind_data.index.GetIndexName();
+	return result;
+}
+
+TableFunction GetExtentFunction() {
+	TableFunction func("rtree_index_extent", {}, RTreeIndexExtentExecute);
+	func.init_global = RTreeIndexExtentInitGlobal;
+	func.cardinality = RTreeIndexExtentCardinality;
+	func.to_string = RTreeIndexExtentToString;
+	func.projection_pushdown = true;
+	return func;
+}
+
+//-----------------------------------------------------------------------------
+// Plan rewriter
+//-----------------------------------------------------------------------------
+class RTreeIndexExtentOptimizer : public OptimizerExtension {
+public:
+	RTreeIndexExtentOptimizer() {
+		optimize_function = RTreeIndexExtentOptimizer::Optimize;
+	}
+
+	static bool TryOptimize(ClientContext &context, LogicalAggregate &agg) {
+		// Only a single, ungrouped aggregate, so that the scan has no other consumers
+		if (!agg.groups.empty() || agg.expressions.size() != 1 ||
+		    agg.expressions[0]->GetExpressionClass() != ExpressionClass::BOUND_AGGREGATE) {
+			return false;
+		}
+		auto &aggr = agg.expressions[0]->Cast<BoundAggregateExpression>();
+		if (aggr.function.name != "ST_Extent_Agg_Approx" || aggr.children.size() != 1 || aggr.filter ||
+		    (aggr.order_bys && !aggr.order_bys->orders.empty())) {
+			return false;
+		}
+
+		// The argument is usually a column of the scan, but may be passed through a projection first
+		optional_ptr<Expression> arg_expr = aggr.children[0].get();
+		optional_ptr<LogicalOperator> get_op = agg.children[0].get();
+		if (get_op->type == LogicalOperatorType::LOGICAL_PROJECTION) {
+			auto &proj = get_op->Cast<LogicalProjection>();
+			if (arg_expr->type != ExpressionType::BOUND_COLUMN_REF) {
+				return false;
+			}
+			auto &colref = arg_expr->Cast<BoundColumnRefExpression>();
+			if (colref.binding.table_index != proj.table_index || colref.depth != 0) {
+				return false;
+			}
+			arg_expr = proj.expressions[colref.binding.column_index].get();
+			get_op = proj.children[0].get();
+		}
+
+		if (get_op->type != LogicalOperatorType::LOGICAL_GET || arg_expr->type != ExpressionType::BOUND_COLUMN_REF) {
+			return false;
+		}
+		auto &get = get_op->Cast<LogicalGet>();
+		if (get.function.name != "seq_scan") {
+			return false;
+		}
+
+		// Filters would remove rows from the extent
+		if (!get.table_filters.filters.empty() || (get.dynamic_filters && get.dynamic_filters->HasFilters())) {
+			return false;
+		}
+
+		// The scan must only return the aggregated column
+		auto &colref = arg_expr->Cast<BoundColumnRefExpression>();
+		auto &get_column_ids = get.GetColumnIds();
+		if (colref.binding.table_index != get.table_index || colref.depth != 0 || get_column_ids.size() != 1 ||
+		    colref.binding.column_index != 0 || get_column_ids[0].IsRowIdColumn() ||
+		    colref.return_type != GeoTypes::GEOMETRY()) {
+			return false;
+		}
+		const auto column_idx = get_column_ids[0].GetPrimaryIndex();
+
+		auto &table = *get.GetTable();
+		if (!table.IsDuckTable()) {
+			return false;
+		}
+		auto &duck_table = table.Cast<DuckTableEntry>();
+		auto &table_info = *table.GetStorage().GetDataTableInfo();
+
+		// Find an index on exactly this column
+		unique_ptr<RTreeIndexExtentBindData> bind_data = nullptr;
+		table_info.GetIndexes().BindAndScan<RTreeIndex>(context, table_info, [&](RTreeIndex &index_entry) {
+			auto &index_expr = *index_entry.unbound_expressions[0];
+			if (index_expr.type != ExpressionType::BOUND_COLUMN_REF || index_expr.return_type != GeoTypes::GEOMETRY()) {
+				return false;
+			}
+			const auto &index_colref = index_expr.Cast<BoundColumnRefExpression>();
+			if (index_entry.GetColumnIds()[index_colref.binding.column_index] != column_idx) {
+				return false;
+			}
+			bind_data = make_uniq<RTreeIndexExtentBindData>(duck_table, index_entry);
+			return true;
+		});
+
+		if (!bind_data) {
+			return false;
+		}
+
+		get.function = GetExtentFunction();
+		const auto cardinality = get.function.cardinality(context, bind_data.get());
+		get.has_estimated_cardinality = cardinality->has_estimated_cardinality;
+		get.estimated_cardinality = cardinality->estimated_cardinality;
+		get.bind_data = std::move(bind_data);
+		return true;
+	}
+
+	static void OptimizeRecursive(ClientContext &context, unique_ptr<LogicalOperator> &plan) {
+		if (plan->type == LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY &&
+		    TryOptimize(context, plan->Cast<LogicalAggregate>())) {
+			return;
+		}
+		for (auto &child : plan->children) {
+			OptimizeRecursive(context, child);
+		}
+	}
+
+	static void Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+		OptimizeRecursive(input.context, plan);
+	}
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Register
+//-----------------------------------------------------------------------------
+void RTreeModule::RegisterIndexPlanExtent(DatabaseInstance &db) {
+	db.config.optimizer_extensions.push_back(RTreeIndexExtentOptimizer());
+}
+
+} // namespace duckdb
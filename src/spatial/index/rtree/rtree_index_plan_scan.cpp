@@ -6,19 +6,25 @@
 #include "duckdb/optimizer/optimizer.hpp"
 #include "duckdb/optimizer/optimizer_extension.hpp"
 #include "duckdb/optimizer/remove_unused_columns.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
 #include "duckdb/planner/expression/bound_constant_expression.hpp"
 #include "duckdb/planner/expression/bound_function_expression.hpp"
 #include "duckdb/planner/expression/bound_reference_expression.hpp"
 #include "duckdb/planner/operator/logical_filter.hpp"
 #include "duckdb/planner/operator/logical_get.hpp"
 #include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_top_n.hpp"
 #include "duckdb/planner/operator_extension.hpp"
 #include "duckdb/storage/data_table.hpp"
 #include "duckdb/planner/filter/expression_filter.hpp"
 #include "duckdb/main/database.hpp"
 
 #include "spatial/geometry/bbox.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/geometry_stats.hpp"
 #include "spatial/geometry/geometry_type.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/geometry/spatial_key.hpp"
 #include "spatial/index/rtree/rtree_index.hpp"
 #include "spatial/index/rtree/rtree_index_create_logical.hpp"
 #include "spatial/index/rtree/rtree_index_scan.hpp"
@@ -27,11 +33,33 @@
 #include "spatial/util/math.hpp"
 
 namespace duckdb {
+//-----------------------------------------------------------------------------
+// Scan Invariant Matcher
+//-----------------------------------------------------------------------------
+// Whether the expression does not depend on the scanned rows, and can be evaluated once when the scan starts.
+// This includes constants, but also expressions over prepared statement parameters.
+static bool IsScanInvariant(const Expression &expr) {
+	return expr.IsScalar() && !expr.IsVolatile() && !expr.HasSubquery();
+}
+
+class ScanInvariantExpressionMatcher final : public ExpressionMatcher {
+public:
+	bool Match(Expression &expr, vector<reference<Expression>> &bindings) override {
+		if (!IsScanInvariant(expr)) {
+			return false;
+		}
+		bindings.push_back(expr);
+		return true;
+	}
+};
+
 //-----------------------------------------------------------------------------
 // Plan rewriter
 //-----------------------------------------------------------------------------
 class RTreeIndexScanOptimizer : public OptimizerExtension {
 public:
+	static constexpr double DEFAULT_SELECTIVITY_THRESHOLD = 0.2;
+
 	RTreeIndexScanOptimizer() {
 		optimize_function = RTreeIndexScanOptimizer::Optimize;
 	}
@@ -75,21 +103,19 @@ public:
 		});
 	}
 
+	// Whether the predicate can only hold if the bounds of its arguments intersect. All predicates in the set have that
+	// property for every combination of the index key types (geometries, points and boxes)
 	static bool IsSpatialPredicate(const ScalarFunction &function, const unordered_set<string> &predicates) {
 
 		if (predicates.find(function.name) == predicates.end()) {
 			return false;
 		}
-		if (function.arguments.size() < 2) {
+		if (function.arguments.size() != 2) {
 			// We can only optimize if there are two children
 			return false;
 		}
-		if (function.arguments[0] != GeoTypes::GEOMETRY()) {
-			// We can only optimize if the first child is a GEOMETRY
-			return false;
-		}
-		if (function.arguments[1] != GeoTypes::GEOMETRY()) {
-			// We can only optimize if the second child is a GEOMETRY
+		if (!SpatialKey::IsKeyType(function.arguments[0]) || !SpatialKey::IsKeyType(function.arguments[1])) {
+			// We can only optimize if both children are GEOMETRY, POINT_2D, BOX_2D or BOX_2DF
 			return false;
 		}
 		if (function.return_type != LogicalType::BOOLEAN) {
@@ -99,12 +125,88 @@ public:
 		return true;
 	}
 
-	static bool TryGetBoundingBox(const Value &value, Box2D<float> &bbox) {
-		const auto str = value.GetValueUnsafe<string_t>();
-		const geometry_t blob(str);
-		if (!blob.TryGetCachedBounds(bbox)) {
+	// Collect the query boxes that the rows matching the expression have to intersect. Disjunctions need a box for
+	// each of their children, conjunctions only for one of them. Query geometries that are not constant are collected
+	// separately, their bounds are only known once the scan starts.
+	static bool TryGetQueryBoxes(FunctionExpressionMatcher &matcher, const unordered_set<string> &predicates,
+	                             Expression &expr, vector<Box2D<float>> &boxes,
+	                             vector<unique_ptr<Expression>> &box_exprs) {
+		if (expr.type == ExpressionType::CONJUNCTION_OR) {
+			for (auto &child : expr.Cast<BoundConjunctionExpression>().children) {
+				if (!TryGetQueryBoxes(matcher, predicates, *child, boxes, box_exprs)) {
+					return false;
+				}
+			}
+			return true;
+		}
+		if (expr.type == ExpressionType::CONJUNCTION_AND) {
+			const auto box_count = boxes.size();
+			const auto box_expr_count = box_exprs.size();
+			for (auto &child : expr.Cast<BoundConjunctionExpression>().children) {
+				if (TryGetQueryBoxes(matcher, predicates, *child, boxes, box_exprs)) {
+					return true;
+				}
+				boxes.resize(box_count);
+				box_exprs.resize(box_expr_count);
+			}
+			return false;
+		}
+
+		vector<reference<Expression>> bindings;
+		if (!matcher.Match(expr, bindings)) {
 			return false;
 		}
+
+		// 		bindings[0] = the expression
+		// 		bindings[1] = the index expression
+		// 		bindings[2] = the query geometry
+
+		if (!IsSpatialPredicate(bindings[0].get().Cast<BoundFunctionExpression>().function, predicates)) {
+			return false;
+		}
+
+		auto &query_expr = bindings[2].get();
+		if (query_expr.type != ExpressionType::VALUE_CONSTANT) {
+			box_exprs.push_back(query_expr.Copy());
+			return true;
+		}
+
+		// Compute the bounding box
+		auto constant_value = query_expr.Cast<BoundConstantExpression>().value;
+		Box2D<float> bbox;
+		if (!SpatialKey::TryGetBounds(query_expr.return_type, constant_value, bbox)) {
+			return false;
+		}
+		boxes.push_back(bbox);
+		return true;
+	}
+
+	// Whether the expression is ST_Intersects_Extent(<key>, <constant>), with the exact extent of the constant. The index
+	// scan can evaluate that by itself, from the leaf bounds where it can and from the keys where it can not.
+	static bool TryGetExactExtent(const Expression &expr, const Expression &index_expr, Box2D<double> &box) {
+		if (expr.type != ExpressionType::BOUND_FUNCTION) {
+			return false;
+		}
+		auto &func = expr.Cast<BoundFunctionExpression>();
+		if (func.function.name != "ST_Intersects_Extent" || func.children.size() != 2) {
+			return false;
+		}
+		const auto const_idx = func.children[0]->type == ExpressionType::VALUE_CONSTANT ? 0 : 1;
+		auto &constant_expr = *func.children[const_idx];
+		if (constant_expr.type != ExpressionType::VALUE_CONSTANT || !func.children[1 - const_idx]->Equals(index_expr) ||
+		    constant_expr.return_type != GeoTypes::GEOMETRY()) {
+			return false;
+		}
+		const auto &value = constant_expr.Cast<BoundConstantExpression>().value;
+		if (value.IsNull()) {
+			return false;
+		}
+		const auto &blob = StringValue::Get(value);
+		auto extent = sgl::box_xy::smallest();
+		if (!Serde::TryGetExtentXY(blob.data(), blob.size(), extent)) {
+			return false;
+		}
+		box = Box2D<double>(PointXY<double>(extent.min.x, extent.min.y), PointXY<double>(extent.max.x, extent.max.y));
 		return true;
 	}
 
@@ -119,17 +221,23 @@ public:
 			// Look for a spatial predicate
 			auto &filter = op.Cast<LogicalFilter>();
 
-			if (filter.expressions.size() != 1) {
-				// We can only optimize if there is a single expression right now
-				return false;
-			}
-			auto &filter_expr = filter.expressions[0];
 			// Look for a table scan
 			if (filter.children.front()->type != LogicalOperatorType::LOGICAL_GET) {
 				return false;
 			}
 			auto &get_ptr = filter.children.front();
-			return TryOptimizeGet(binder, context, get_ptr, root, filter, optional_idx(), filter_expr);
+
+			// The filter is kept on top of the index scan, so it is enough if any of the conjuncts can use the index
+			for (auto &filter_expr : filter.expressions) {
+				if (TryOptimizeGet(binder, context, get_ptr, root, filter, optional_idx(), filter_expr)) {
+					return true;
+				}
+			}
+			return false;
+		}
+		if (op.type == LogicalOperatorType::LOGICAL_TOP_N) {
+			// Look for a ORDER BY ST_Distance(geom, <constant>) LIMIT k
+			return TryOptimizeKNN(context, op.Cast<LogicalTopN>());
 		}
 		if (op.type == LogicalOperatorType::LOGICAL_GET) {
 			// this is a LogicalGet - check if there is an ExpressionFilter
@@ -175,9 +283,16 @@ public:
 		auto &table_info = *table.GetStorage().GetDataTableInfo();
 		unique_ptr<RTreeIndexScanBindData> bind_data = nullptr;
 
-		unordered_set<string> spatial_predicates = {"ST_Equals",    "ST_Intersects",      "ST_Touches",  "ST_Crosses",
-		                                            "ST_Within",    "ST_Contains",        "ST_Overlaps", "ST_Covers",
-		                                            "ST_CoveredBy", "ST_ContainsProperly"};
+		unordered_set<string> spatial_predicates = {
+		    "ST_Equals",   "ST_Intersects", "ST_Touches",   "ST_Crosses",          "ST_Within",           "ST_Contains",
+		    "ST_Overlaps", "ST_Covers",     "ST_CoveredBy", "ST_ContainsProperly", "ST_Intersects_Extent"};
+
+		auto selectivity_threshold = DEFAULT_SELECTIVITY_THRESHOLD;
+		Value threshold_value;
+		if (context.TryGetCurrentSetting("rtree_index_scan_max_selectivity", threshold_value) &&
+		    !threshold_value.IsNull()) {
+			selectivity_threshold = threshold_value.GetValue<double>();
+		}
 
 		table_info.GetIndexes().BindAndScan<RTreeIndex>(context, table_info, [&](RTreeIndex &index_entry) {
 			// Create the bind data for this index given the bounding box
@@ -200,25 +315,34 @@ public:
 			matcher.policy = SetMatcher::Policy::UNORDERED;
 
 			matcher.matchers.push_back(make_uniq<ExpressionEqualityMatcher>(*index_expr));
-			matcher.matchers.push_back(make_uniq<ConstantExpressionMatcher>());
+			matcher.matchers.push_back(make_uniq<ScanInvariantExpressionMatcher>());
 
-			vector<reference<Expression>> bindings;
-			if (!matcher.Match(*filter_expr, bindings)) {
+			vector<Box2D<float>> boxes;
+			vector<unique_ptr<Expression>> box_exprs;
+			if (!TryGetQueryBoxes(matcher, spatial_predicates, *filter_expr, boxes, box_exprs)) {
 				return false;
 			}
 
-			// 		bindings[0] = the expression
-			// 		bindings[1] = the index expression
-			// 		bindings[2] = the constant
-
-			// Compute the bounding box
-			auto constant_value = bindings[2].get().Cast<BoundConstantExpression>().value;
-			Box2D<float> bbox;
-			if (!TryGetBoundingBox(constant_value, bbox)) {
+			// If the query covers a large part of the index, a sequential scan is cheaper than fetching through it.
+			// The bounds of the non-constant query geometries are unknown at this point, so those always use the index.
+			double selectivity = 0;
+			for (const auto &bbox : boxes) {
+				selectivity += index_entry.EstimateSelectivity(bbox);
+			}
+			if (selectivity > selectivity_threshold) {
 				return false;
 			}
 
-			bind_data = make_uniq<RTreeIndexScanBindData>(duck_table, index_entry, bbox);
+			bind_data = make_uniq<RTreeIndexScanBindData>(duck_table, index_entry, std::move(boxes));
+			bind_data->box_expressions = std::move(box_exprs);
+
+			// If the extent filter on the indexed column is the only filter of the scan, the scan can evaluate it by
+			// itself, and the column is not needed anymore for the rows that the leaf bounds decide
+			const auto is_column_key = index_entry.unbound_expressions[0]->type == ExpressionType::BOUND_COLUMN_REF;
+			if (is_column_key && filter_column_idx.IsValid() && get.table_filters.filters.size() == 1 &&
+			    bind_data->boxes.size() == 1 && bind_data->box_expressions.empty()) {
+				bind_data->exact_extent = TryGetExactExtent(*filter_expr, *index_expr, bind_data->exact_box);
+			}
 			return true;
 		});
 
@@ -232,7 +356,12 @@ public:
 		const auto cardinality = get.function.cardinality(context, bind_data.get());
 		get.has_estimated_cardinality = cardinality->has_estimated_cardinality;
 		get.estimated_cardinality = cardinality->estimated_cardinality;
+		const auto exact_extent = bind_data->exact_extent;
 		get.bind_data = std::move(bind_data);
+		if (exact_extent) {
+			// The scan evaluates the filter by itself
+			get.table_filters.filters.clear();
+		}
 		if (get.table_filters.filters.empty()) {
 			return true;
 		}
@@ -274,6 +403,113 @@ public:
 		return true;
 	}
 
+	// Rewrite a TOP_N ordered by the distance to a constant geometry into a k-nearest-neighbour index scan.
+	// The TOP_N is kept, as the index scan only returns the candidates, ordered by their bounding box distance.
+	static bool TryOptimizeKNN(ClientContext &context, LogicalTopN &top_n) {
+		// Only the first order matters, any further orders just break ties between the candidates.
+		// The rows with a NULL distance are not in the index, so they have to come last.
+		if (top_n.orders.empty() || top_n.orders[0].type != OrderType::ASCENDING ||
+		    top_n.orders[0].null_order != OrderByNullType::NULLS_LAST) {
+			return false;
+		}
+
+		// The distance is usually computed in a projection below the TOP_N
+		auto &child = top_n.children[0];
+		optional_ptr<Expression> order_expr = top_n.orders[0].expression.get();
+		optional_ptr<LogicalOperator> get_op = child.get();
+		if (child->type == LogicalOperatorType::LOGICAL_PROJECTION) {
+			auto &proj = child->Cast<LogicalProjection>();
+			if (order_expr->type != ExpressionType::BOUND_COLUMN_REF) {
+				return false;
+			}
+			auto &colref = order_expr->Cast<BoundColumnRefExpression>();
+			if (colref.binding.table_index != proj.table_index || colref.depth != 0) {
+				return false;
+			}
+			order_expr = proj.expressions[colref.binding.column_index].get();
+			get_op = proj.children[0].get();
+		}
+
+		if (get_op->type != LogicalOperatorType::LOGICAL_GET) {
+			return false;
+		}
+		auto &get = get_op->Cast<LogicalGet>();
+		if (get.function.name != "seq_scan") {
+			return false;
+		}
+
+		// Any filter would remove candidates, so the nearest rows could be missed
+		if (!get.table_filters.filters.empty() || (get.dynamic_filters && get.dynamic_filters->HasFilters())) {
+			return false;
+		}
+
+		// The order must be ST_Distance(<key>, <constant>) (or the other way around)
+		if (order_expr->type != ExpressionType::BOUND_FUNCTION) {
+			return false;
+		}
+		auto &func = order_expr->Cast<BoundFunctionExpression>();
+		if (func.function.name != "ST_Distance" || func.children.size() != 2 ||
+		    !SpatialKey::IsKeyType(func.children[0]->return_type) ||
+		    !SpatialKey::IsKeyType(func.children[1]->return_type)) {
+			return false;
+		}
+		const auto const_idx = func.children[0]->type == ExpressionType::VALUE_CONSTANT ? 0 : 1;
+		if (func.children[const_idx]->type != ExpressionType::VALUE_CONSTANT) {
+			return false;
+		}
+		const auto &constant_value = func.children[const_idx]->Cast<BoundConstantExpression>().value;
+		const auto &geom_expr = *func.children[1 - const_idx];
+
+		Box2D<float> bbox;
+		if (!SpatialKey::TryGetBounds(func.children[const_idx]->return_type, constant_value, bbox)) {
+			return false;
+		}
+
+		// Keys without bounds are not in the index either. Empty geometries have a distance of 0, so they come first,
+		// and NULLs are still needed if there are fewer than k other rows. So only use the index if the statistics of
+		// the key rule them out.
+		const auto key_stats = GeometryStats::GetStatistics(context, get, const_cast<Expression &>(geom_expr));
+		if (!key_stats || !SpatialKey::AlwaysHasBounds(geom_expr.return_type, *key_stats)) {
+			return false;
+		}
+
+		// The limit (including the offset) decides how many neighbours we need
+		const auto k = top_n.limit + top_n.offset;
+		if (k == 0 || k < top_n.limit) {
+			return false;
+		}
+
+		auto &table = *get.GetTable();
+		if (!table.IsDuckTable()) {
+			return false;
+		}
+		auto &duck_table = table.Cast<DuckTableEntry>();
+		auto &table_info = *table.GetStorage().GetDataTableInfo();
+		unique_ptr<RTreeIndexScanBindData> bind_data = nullptr;
+
+		table_info.GetIndexes().BindAndScan<RTreeIndex>(context, table_info, [&](RTreeIndex &index_entry) {
+			bool rewrite_possible = true;
+			auto index_expr = index_entry.unbound_expressions[0]->Copy();
+			RewriteIndexExpression(index_entry, get, *index_expr, rewrite_possible);
+			if (!rewrite_possible || !index_expr->Equals(geom_expr)) {
+				return false;
+			}
+			bind_data = make_uniq<RTreeIndexScanBindData>(duck_table, index_entry, vector<Box2D<float>> {bbox}, k);
+			return true;
+		});
+
+		if (!bind_data) {
+			return false;
+		}
+
+		get.function = RTreeIndexScanFunction::GetFunction();
+		const auto cardinality = get.function.cardinality(context, bind_data.get());
+		get.has_estimated_cardinality = cardinality->has_estimated_cardinality;
+		get.estimated_cardinality = cardinality->estimated_cardinality;
+		get.bind_data = std::move(bind_data);
+		return true;
+	}
+
 	static void OptimizeRecursive(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan,
 	                              unique_ptr<LogicalOperator> &root) {
 		if (!TryOptimize(input.optimizer.binder, input.context, plan, root)) {
@@ -295,6 +531,11 @@ public:
 void RTreeModule::RegisterIndexPlanScan(DatabaseInstance &db) {
 	// Register the optimizer extension
 	db.config.optimizer_extensions.push_back(RTreeIndexScanOptimizer());
+
+	db.config.AddExtensionOption("rtree_index_scan_max_selectivity",
+	                             "The estimated fraction of an RTREE index that a query may cover and still use an index "
+	                             "scan. Above it, a sequential scan is used instead",
+	                             LogicalType::DOUBLE, Value::DOUBLE(RTreeIndexScanOptimizer::DEFAULT_SELECTIVITY_THRESHOLD));
 }
 
 } // namespace duckdb
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "duckdb/catalog/dependency_list.hpp"
 #include "duckdb/common/mutex.hpp"
 #include "duckdb/function/function_set.hpp"
+#include "duckdb/function/pragma_function.hpp"
 #include "duckdb/main/extension_util.hpp"
 #include "duckdb/optimizer/matcher/expression_matcher.hpp"
 #include "duckdb/planner/expression_iterator.hpp"
@@ -35,6 +36,15 @@ static unique_ptr<FunctionData> RTreeindexInfoBind(ClientContext &context, Table
 	names.emplace_back("table_name");
 	return_types.emplace_back(LogicalType::VARCHAR);
 
+	names.emplace_back("height");
+	return_types.emplace_back(LogicalType::BIGINT);
+
+	names.emplace_back("node_memory");
+	return_types.emplace_back(LogicalType::BIGINT);
+
+	names.emplace_back("leaf_memory");
+	return_types.emplace_back(LogicalType::BIGINT);
+
 	return nullptr;
 }
 
@@ -95,6 +105,14 @@ static void RTreeIndexInfoExecute(ClientContext &context, TableFunctionInput &da
 		output.data[col++].SetValue(row, Value(index_entry.name));
 		output.data[col++].SetValue(row, Value(table_entry.name));
 
+		IndexLock lock;
+		rtree_index->InitializeLock(lock);
+		auto &tree = *rtree_index->tree;
+		lock_guard<mutex> guard(tree.GetLock());
+		output.data[col++].SetValue(row, Value::BIGINT(NumericCast<int64_t>(tree.GetHeight(tree.GetRoot()))));
+		output.data[col++].SetValue(row, Value::BIGINT(NumericCast<int64_t>(tree.GetNodeAllocator().GetInMemorySize())));
+		output.data[col++].SetValue(row, Value::BIGINT(NumericCast<int64_t>(tree.GetLeafAllocator().GetInMemorySize())));
+
 		row++;
 	}
 	output.SetCardinality(row);
@@ -116,7 +134,7 @@ static optional_ptr<RTreeIndex> TryGetIndex(ClientContext &context, const string
 
 	auto &table_info = *storage.GetDataTableInfo();
 	table_info.GetIndexes().BindAndScan<RTreeIndex>(context, table_info, [&](RTreeIndex &index) {
-		if (index_entry.name == index_name) {
+		if (index.name == index_entry.name) {
 			rtree_index = &index;
 			return true;
 		}
@@ -164,6 +182,7 @@ struct RTreeIndexDumpStackFrame {
 
 struct RTreeIndexDumpState final : public GlobalTableFunctionState {
 	const RTreeIndex &index;
+	shared_ptr<RTreeSnapshot> snapshot;
 	RTreeScanner scanner;
 
 public:
@@ -180,10 +199,11 @@ static unique_ptr<GlobalTableFunctionState> RTreeIndexDumpInit(ClientContext &co
 	}
 
 	auto result = make_uniq<RTreeIndexDumpState>(*rtree_index);
-	const auto &root_entry = rtree_index->tree->GetRoot();
+	result->snapshot = rtree_index->GetSnapshot();
+	const auto &root_entry = result->snapshot->GetRoot();
 
 	if (root_entry.pointer.IsSet()) {
-		result->scanner.Init(root_entry);
+		result->scanner.Init(root_entry, result->snapshot.get());
 	}
 	return std::move(result);
 }
@@ -204,6 +224,7 @@ static void RTreeIndexDumpExecute(ClientContext &context, TableFunctionInput &da
 
 	const auto &tree = *state.index.tree;
 
+	lock_guard<mutex> guard(tree.GetLock());
 	state.scanner.Scan(tree, [&](const RTreeEntry &entry, const idx_t &level) {
 		level_data[output_idx] = UnsafeNumericCast<int32_t>(level);
 		xmin_data[output_idx] = entry.bounds.min.x;
@@ -226,6 +247,201 @@ static void RTreeIndexDumpExecute(ClientContext &context, TableFunctionInput &da
 	output.SetCardinality(output_idx);
 }
 
+//-------------------------------------------------------------------------
+// RTree Index Stats
+//-------------------------------------------------------------------------
+// BIND
+struct RTreeIndexStatsBindData final : public TableFunctionData {
+	string index_name;
+};
+
+static unique_ptr<FunctionData> RTreeIndexStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                    vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<RTreeIndexStatsBindData>();
+
+	result->index_name = input.inputs[0].GetValue<string>();
+
+	names.emplace_back("level");
+	return_types.emplace_back(LogicalType::INTEGER);
+
+	names.emplace_back("node_type");
+	return_types.emplace_back(LogicalType::VARCHAR);
+
+	names.emplace_back("node_count");
+	return_types.emplace_back(LogicalType::BIGINT);
+
+	names.emplace_back("entry_count");
+	return_types.emplace_back(LogicalType::BIGINT);
+
+	names.emplace_back("fill_factor");
+	return_types.emplace_back(LogicalType::DOUBLE);
+
+	names.emplace_back("node_area");
+	return_types.emplace_back(LogicalType::DOUBLE);
+
+	names.emplace_back("overlap_area");
+	return_types.emplace_back(LogicalType::DOUBLE);
+
+	names.emplace_back("avg_overlap_area");
+	return_types.emplace_back(LogicalType::DOUBLE);
+
+	names.emplace_back("dead_space");
+	return_types.emplace_back(LogicalType::DOUBLE);
+
+	return std::move(result);
+}
+
+// INIT
+struct RTreeIndexLevelStats {
+	bool is_leaf = false;
+	idx_t node_count = 0;
+	idx_t entry_count = 0;
+	// The number of entries the nodes of this level could hold
+	idx_t capacity = 0;
+	// The summed area of the bounds of the nodes
+	double node_area = 0;
+	// The summed area of the intersections of every pair of entries in the same node
+	double overlap_area = 0;
+	// The summed area of the nodes not covered by any of their entries
+	double dead_space = 0;
+};
+
+struct RTreeIndexStatsState final : public GlobalTableFunctionState {
+	vector<RTreeIndexLevelStats> levels;
+	idx_t offset = 0;
+};
+
+static double GetArea(const RTreeBounds &bounds) {
+	return (static_cast<double>(bounds.max.x) - bounds.min.x) * (static_cast<double>(bounds.max.y) - bounds.min.y);
+}
+
+// The summed area of the intersections of every pair of boxes. The boxes are sorted by their min x, so that each box
+// only has to be compared with the boxes that start before it ends.
+static double GetPairwiseOverlapArea(vector<RTreeBounds> &boxes) {
+	std::sort(boxes.begin(), boxes.end(),
+	          [](const RTreeBounds &lhs, const RTreeBounds &rhs) { return lhs.min.x < rhs.min.x; });
+	double result = 0;
+	for (idx_t i = 0; i < boxes.size(); i++) {
+		for (idx_t j = i + 1; j < boxes.size() && boxes[j].min.x <= boxes[i].max.x; j++) {
+			if (boxes[i].Intersects(boxes[j])) {
+				const auto dx = static_cast<double>(MinValue(boxes[i].max.x, boxes[j].max.x)) - boxes[j].min.x;
+				const auto dy = static_cast<double>(MinValue(boxes[i].max.y, boxes[j].max.y)) -
+				                MaxValue(boxes[i].min.y, boxes[j].min.y);
+				result += dx * dy;
+			}
+		}
+	}
+	return result;
+}
+
+static unique_ptr<GlobalTableFunctionState> RTreeIndexStatsInit(ClientContext &context, TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<RTreeIndexStatsBindData>();
+
+	auto rtree_index = TryGetIndex(context, bind_data.index_name);
+	if (!rtree_index) {
+		throw BinderException("Index %s not found", bind_data.index_name);
+	}
+
+	auto result = make_uniq<RTreeIndexStatsState>();
+
+	IndexLock lock;
+	rtree_index->InitializeLock(lock);
+
+	const auto &tree = *rtree_index->tree;
+	lock_guard<mutex> guard(tree.GetLock());
+	const auto &config = tree.GetConfig();
+	const auto &root = tree.GetRoot();
+	if (!root.pointer.IsSet()) {
+		return std::move(result);
+	}
+
+	// Visit every node of the tree once, depth first. Nodes are only aggregated, so this works on any size of index.
+	RTreeNodeBuffer buffer;
+	vector<pair<RTreeEntry, idx_t>> stack;
+	vector<RTreeBounds> boxes;
+	stack.emplace_back(root, 0);
+
+	while (!stack.empty()) {
+		const auto entry = stack.back().first;
+		const auto level = stack.back().second;
+		stack.pop_back();
+
+		if (level >= result->levels.size()) {
+			result->levels.resize(level + 1);
+		}
+		auto &stats = result->levels[level];
+
+		const auto is_leaf = entry.pointer.IsLeafPage();
+		const auto &node = tree.Ref(entry.pointer, buffer);
+
+		boxes.clear();
+		double entry_area = 0;
+		for (const auto &child : node) {
+			boxes.push_back(child.bounds);
+			entry_area += GetArea(child.bounds);
+			if (!is_leaf) {
+				stack.emplace_back(child, level + 1);
+			}
+		}
+
+		// The area covered by the entries, approximated by subtracting the pairwise overlaps
+		const auto node_area = GetArea(entry.bounds);
+		const auto overlap_area = GetPairwiseOverlapArea(boxes);
+		const auto covered_area = MaxValue(entry_area - overlap_area, 0.0);
+
+		stats.is_leaf = is_leaf;
+		stats.node_count++;
+		stats.entry_count += node.GetCount();
+		stats.capacity += config.GetMaxCapacity(is_leaf ? RTreeNodeType::LEAF_PAGE : RTreeNodeType::BRANCH_PAGE);
+		stats.node_area += node_area;
+		stats.overlap_area += overlap_area;
+		stats.dead_space += MaxValue(node_area - covered_area, 0.0);
+	}
+
+	return std::move(result);
+}
+
+// EXECUTE
+static void RTreeIndexStatsExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &state = data_p.global_state->Cast<RTreeIndexStatsState>();
+
+	idx_t row = 0;
+	while (state.offset < state.levels.size() && row < STANDARD_VECTOR_SIZE) {
+		const auto level = state.offset++;
+		const auto &stats = state.levels[level];
+
+		idx_t col = 0;
+		output.data[col++].SetValue(row, Value::INTEGER(NumericCast<int32_t>(level)));
+		output.data[col++].SetValue(row, Value(stats.is_leaf ? "LEAF" : "BRANCH"));
+		output.data[col++].SetValue(row, Value::BIGINT(NumericCast<int64_t>(stats.node_count)));
+		output.data[col++].SetValue(row, Value::BIGINT(NumericCast<int64_t>(stats.entry_count)));
+		output.data[col++].SetValue(row, Value::DOUBLE(static_cast<double>(stats.entry_count) /
+		                                               static_cast<double>(stats.capacity)));
+		output.data[col++].SetValue(row, Value::DOUBLE(stats.node_area));
+		output.data[col++].SetValue(row, Value::DOUBLE(stats.overlap_area));
+		output.data[col++].SetValue(row, Value::DOUBLE(stats.overlap_area / static_cast<double>(stats.node_count)));
+		output.data[col++].SetValue(row, Value::DOUBLE(stats.dead_space));
+		row++;
+	}
+	output.SetCardinality(row);
+}
+
+//-------------------------------------------------------------------------
+// RTree Index Repack
+//-------------------------------------------------------------------------
+static void RTreeIndexRepackPragma(ClientContext &context, const FunctionParameters &parameters) {
+	const auto index_name = parameters.values[0].GetValue<string>();
+
+	auto rtree_index = TryGetIndex(context, index_name);
+	if (!rtree_index) {
+		throw BinderException("Index %s not found", index_name);
+	}
+
+	IndexLock lock;
+	rtree_index->InitializeLock(lock);
+	rtree_index->Repack(lock);
+}
+
 //-------------------------------------------------------------------------
 // Register
 //-------------------------------------------------------------------------
@@ -240,6 +456,16 @@ void RTreeModule::RegisterIndexPragmas(DatabaseInstance &db) {
 	                            RTreeIndexDumpInit);
 
 	ExtensionUtil::RegisterFunction(db, dump_function);
+
+	TableFunction stats_function("rtree_index_stats", {LogicalType::VARCHAR}, RTreeIndexStatsExecute,
+	                             RTreeIndexStatsBind, RTreeIndexStatsInit);
+
+	ExtensionUtil::RegisterFunction(db, stats_function);
+
+	const auto repack_function =
+	    PragmaFunction::PragmaCall("rtree_index_repack", RTreeIndexRepackPragma, {LogicalType::VARCHAR});
+
+	ExtensionUtil::RegisterFunction(db, repack_function);
 }
 
 } // namespace duckdb
\ No newline at end of file
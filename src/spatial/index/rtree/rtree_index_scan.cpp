@@ -1,10 +1,17 @@
 #include "spatial/index/rtree/rtree_module.hpp"
 #include "spatial/index/rtree/rtree_index.hpp"
 #include "spatial/index/rtree/rtree_index_scan.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/geometry_type.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/geometry/spatial_key.hpp"
+#include "spatial/spatial_types.hpp"
 
 #include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
 #include "duckdb/catalog/dependency_list.hpp"
 #include "duckdb/common/mutex.hpp"
+#include "duckdb/common/profiler.hpp"
+#include "duckdb/execution/expression_executor.hpp"
 #include "duckdb/function/function_set.hpp"
 #include "duckdb/optimizer/matcher/expression_matcher.hpp"
 #include "duckdb/planner/expression_iterator.hpp"
@@ -12,7 +19,9 @@
 #include "duckdb/storage/table/scan_state.hpp"
 #include "duckdb/transaction/duck_transaction.hpp"
 #include "duckdb/transaction/local_storage.hpp"
+#include "duckdb/main/config.hpp"
 #include "duckdb/main/extension_util.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include "duckdb/catalog/catalog_entry/duck_index_entry.hpp"
 #include "duckdb/storage/data_table.hpp"
 
@@ -27,18 +36,43 @@ BindInfo RTreeIndexScanBindInfo(const optional_ptr<FunctionData> bind_data_p) {
 // Global State
 //-------------------------------------------------------------------------
 struct RTreeIndexScanGlobalState final : public GlobalTableFunctionState {
-	//! The DataChunk containing all read columns.
-	//! This includes filter columns, which are immediately removed.
-	DataChunk all_columns;
 	vector<idx_t> projection_ids;
+	vector<LogicalType> scanned_types;
 
-	ColumnFetchState fetch_state;
 	TableScanState local_storage_state;
 	vector<StorageIndex> column_ids;
 
-	// Index scan state
-	unique_ptr<IndexScanState> index_state;
-	Vector row_ids = Vector(LogicalType::ROW_TYPE);
+	// The indexed column and the row id, fetched to check the rows the index can not decide for an exact extent filter
+	vector<StorageIndex> extent_column_ids;
+
+	// The bounds to scan, including the ones evaluated when the scan started
+	vector<RTreeBounds> boxes;
+
+	// The version of the index that the units are taken from, and that all threads scan
+	shared_ptr<RTreeSnapshot> snapshot;
+
+	// The subtrees of the index to scan, and the query box they are scanned for. Each thread claims one at a time
+	vector<pair<idx_t, RTreeEntry>> scan_units;
+	idx_t next_unit = 0;
+
+	// Guards the claiming of units, and the traversal of the index itself.
+	// Fetching the rows from the table happens outside of the lock, in parallel.
+	mutex lock;
+
+	idx_t max_threads = 1;
+
+	// Whether to buffer and sort the row ids before fetching them
+	bool sort_row_ids = true;
+
+	// Profiling counters, summed over all threads when they are done. Guarded by the lock.
+	idx_t node_count = 0;
+	idx_t row_count = 0;
+	double index_time = 0;
+	double fetch_time = 0;
+
+	idx_t MaxThreads() const override {
+		return max_threads;
+	}
 };
 
 static unique_ptr<GlobalTableFunctionState> RTreeIndexScanInitGlobal(ClientContext &context,
@@ -59,15 +93,62 @@ static unique_ptr<GlobalTableFunctionState> RTreeIndexScanInitGlobal(ClientConte
 		result->column_ids.emplace_back(col_id);
 	}
 
+	if (bind_data.exact_extent) {
+		// The filter is evaluated by the scan itself, so the indexed column does not have to be fetched for the
+		// output, only separately for the rows that the index can not decide
+		const auto index_column = bind_data.index.GetColumnIds()[0];
+		const auto storage_column = bind_data.table.GetColumn(LogicalIndex(index_column)).StorageOid();
+		result->extent_column_ids = {StorageIndex(storage_column), StorageIndex(COLUMN_IDENTIFIER_ROW_ID)};
+
+		if (input.CanRemoveFilterColumns()) {
+			vector<StorageIndex> projected_ids;
+			for (const auto &projection_id : input.projection_ids) {
+				projected_ids.push_back(result->column_ids[projection_id]);
+			}
+			result->column_ids = std::move(projected_ids);
+		}
+	}
+
 	// Initialize the storage scan state
 	result->local_storage_state.Initialize(result->column_ids, context, input.filters);
 	local_storage.InitializeScan(bind_data.table.GetStorage(), result->local_storage_state.local_state, input.filters);
 
-	// Initialize the scan state for the index
-	result->index_state = bind_data.index.Cast<RTreeIndex>().InitializeScan(bind_data.bbox);
+	// Evaluate the query geometries that were not known when the query was planned. A NULL or empty geometry can not
+	// intersect anything, so it does not add any bounds.
+	result->boxes = bind_data.boxes;
+	for (auto &expr : bind_data.box_expressions) {
+		const auto value = ExpressionExecutor::EvaluateScalar(context, *expr, true);
+		RTreeBounds bbox;
+		if (SpatialKey::TryGetBounds(expr->return_type, value, bbox)) {
+			result->boxes.push_back(bbox);
+		}
+	}
+
+	Value sort_value;
+	if (context.TryGetCurrentSetting("rtree_index_scan_sort_row_ids", sort_value) && !sort_value.IsNull()) {
+		result->sort_row_ids = BooleanValue::Get(sort_value);
+	}
+
+	// Split the index into units of work for the threads.
+	// Nearest neighbour scans need to visit the index in order, so they are always single threaded.
+	if (bind_data.knn_limit == 0) {
+		static constexpr idx_t UNITS_PER_THREAD = 4;
+		const auto thread_count = NumericCast<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads());
+		auto &rtree_index = bind_data.index.Cast<RTreeIndex>();
+		result->snapshot = rtree_index.GetSnapshot();
+		vector<RTreeEntry> units;
+		for (idx_t box_idx = 0; box_idx < result->boxes.size(); box_idx++) {
+			rtree_index.GetScanUnits(*result->snapshot, result->boxes[box_idx], thread_count * UNITS_PER_THREAD,
+			                         units);
+			for (auto &unit : units) {
+				result->scan_units.emplace_back(box_idx, unit);
+			}
+		}
+		result->max_threads = MaxValue<idx_t>(MinValue(thread_count, result->scan_units.size()), 1);
+	}
 
 	// Early out if there is nothing to project
-	if (!input.CanRemoveFilterColumns()) {
+	if (!input.CanRemoveFilterColumns() || bind_data.exact_extent) {
 		return std::move(result);
 	}
 
@@ -76,48 +157,265 @@ static unique_ptr<GlobalTableFunctionState> RTreeIndexScanInitGlobal(ClientConte
 
 	auto &duck_table = bind_data.table.Cast<DuckTableEntry>();
 	const auto &columns = duck_table.GetColumns();
-	vector<LogicalType> scanned_types;
 	for (const auto &col_idx : input.column_indexes) {
 		if (col_idx.IsRowIdColumn()) {
-			scanned_types.emplace_back(LogicalType::ROW_TYPE);
+			result->scanned_types.emplace_back(LogicalType::ROW_TYPE);
 		} else {
-			scanned_types.push_back(columns.GetColumn(col_idx.ToLogical()).Type());
+			result->scanned_types.push_back(columns.GetColumn(col_idx.ToLogical()).Type());
 		}
 	}
-	result->all_columns.Initialize(context, scanned_types);
 
 	return std::move(result);
 }
 
+//-------------------------------------------------------------------------
+// Local State
+//-------------------------------------------------------------------------
+struct RTreeIndexScanLocalState final : public LocalTableFunctionState {
+	//! The DataChunk containing all read columns.
+	//! This includes filter columns, which are immediately removed.
+	DataChunk all_columns;
+	ColumnFetchState fetch_state;
+
+	// Index scan state, for the unit currently being scanned
+	unique_ptr<IndexScanState> index_state;
+	Vector row_ids = Vector(LogicalType::ROW_TYPE);
+
+	// Row ids buffered (and sorted) before being fetched, only used when sorting row ids
+	vector<row_t> row_id_buffer;
+	idx_t row_id_buffer_offset = 0;
+
+	// The rows whose extent the index could not decide, checked once the index is exhausted
+	vector<row_t> uncertain_row_ids;
+	idx_t uncertain_offset = 0;
+	DataChunk extent_chunk;
+	ColumnFetchState extent_fetch_state;
+
+	// The row ids of a nearest neighbour scan that are visible to the transaction
+	DataChunk visible_chunk;
+	ColumnFetchState visible_fetch_state;
+
+	// Profiling counters, flushed to the global state once the scan is exhausted
+	idx_t node_count = 0;  // the number of index nodes visited by the finished units
+	idx_t row_count = 0;   // the number of rows fetched from the table
+	double index_time = 0; // the time spent scanning the index (and sorting the row ids)
+	double fetch_time = 0; // the time spent fetching the rows from the table
+};
+
+static unique_ptr<LocalTableFunctionState> RTreeIndexScanInitLocal(ExecutionContext &context,
+                                                                   TableFunctionInitInput &input,
+                                                                   GlobalTableFunctionState *gstate_p) {
+	auto &bind_data = input.bind_data->Cast<RTreeIndexScanBindData>();
+	auto &gstate = gstate_p->Cast<RTreeIndexScanGlobalState>();
+	auto result = make_uniq<RTreeIndexScanLocalState>();
+
+	if (bind_data.knn_limit != 0 && !gstate.boxes.empty()) {
+		// There is only a single thread, which scans the whole index
+		auto &rtree_index = bind_data.index.Cast<RTreeIndex>();
+		result->index_state = rtree_index.InitializeKNNScan(gstate.boxes[0], bind_data.knn_limit);
+		result->visible_chunk.Initialize(context.client, {LogicalType::ROW_TYPE});
+	}
+
+	if (!gstate.projection_ids.empty()) {
+		result->all_columns.Initialize(context.client, gstate.scanned_types);
+	}
+	if (bind_data.exact_extent) {
+		result->extent_chunk.Initialize(context.client, {GeoTypes::GEOMETRY(), LogicalType::ROW_TYPE});
+	}
+	return std::move(result);
+}
+
 //-------------------------------------------------------------------------
 // Execute
 //-------------------------------------------------------------------------
+static idx_t RTreeIndexScanIndex(const RTreeIndexScanBindData &bind_data, RTreeIndexScanGlobalState &gstate,
+                                RTreeIndexScanLocalState &lstate) {
+	auto &rtree_index = bind_data.index.Cast<RTreeIndex>();
+
+	lock_guard<mutex> guard(gstate.lock);
+	while (true) {
+		if (lstate.index_state) {
+			const auto row_count =
+			    bind_data.exact_extent
+			        ? rtree_index.Scan(*lstate.index_state, lstate.row_ids, bind_data.exact_box, lstate.uncertain_row_ids)
+			        : rtree_index.Scan(*lstate.index_state, lstate.row_ids);
+			if (row_count != 0) {
+				return row_count;
+			}
+			lstate.node_count += rtree_index.GetScanNodeCount(*lstate.index_state);
+			lstate.index_state.reset();
+		}
+
+		// Nearest neighbour scans only have a single unit
+		if (bind_data.knn_limit != 0 || gstate.next_unit >= gstate.scan_units.size()) {
+			return 0;
+		}
+
+		// Claim the next unit. Skip the rows that are returned by the scans of the previous boxes
+		const auto &unit = gstate.scan_units[gstate.next_unit++];
+		const auto &boxes = gstate.boxes;
+		const vector<RTreeBounds> excluded(boxes.begin(), boxes.begin() + NumericCast<int64_t>(unit.first));
+		lstate.index_state = rtree_index.InitializeScan(gstate.snapshot, boxes[unit.first], unit.second, excluded);
+	}
+}
+
+// The index returns row ids in tree order, which jumps around the table. Fetching them in that order causes the same
+// row groups to be visited (and decompressed) over and over again. Instead, buffer a large batch of row ids and sort
+// them, so that they are fetched in storage order.
+static idx_t RTreeIndexScanNext(const RTreeIndexScanBindData &bind_data, RTreeIndexScanGlobalState &gstate,
+                                RTreeIndexScanLocalState &lstate) {
+	if (!gstate.sort_row_ids) {
+		return RTreeIndexScanIndex(bind_data, gstate, lstate);
+	}
+
+	static constexpr idx_t ROW_ID_BUFFER_SIZE = STANDARD_VECTOR_SIZE * 64;
+
+	auto &buffer = lstate.row_id_buffer;
+	if (lstate.row_id_buffer_offset == buffer.size()) {
+		buffer.clear();
+		lstate.row_id_buffer_offset = 0;
+
+		const auto row_ids = FlatVector::GetData<row_t>(lstate.row_ids);
+		while (buffer.size() < ROW_ID_BUFFER_SIZE) {
+			const auto row_count = RTreeIndexScanIndex(bind_data, gstate, lstate);
+			if (row_count == 0) {
+				break;
+			}
+			buffer.insert(buffer.end(), row_ids, row_ids + row_count);
+		}
+		std::sort(buffer.begin(), buffer.end());
+	}
+
+	const auto row_count = MinValue<idx_t>(buffer.size() - lstate.row_id_buffer_offset, STANDARD_VECTOR_SIZE);
+	memcpy(FlatVector::GetData<row_t>(lstate.row_ids), buffer.data() + lstate.row_id_buffer_offset,
+	       row_count * sizeof(row_t));
+	lstate.row_id_buffer_offset += row_count;
+	return row_count;
+}
+
+// A nearest neighbour scan only stops once it has found k rows that are visible to the transaction, so the index has
+// to know which of the rows it returns are. Fetch just their row ids for that, and only return the visible rows.
+static idx_t RTreeIndexScanNearest(DuckTransaction &transaction, const RTreeIndexScanBindData &bind_data,
+                                   RTreeIndexScanGlobalState &gstate, RTreeIndexScanLocalState &lstate) {
+	auto &rtree_index = bind_data.index.Cast<RTreeIndex>();
+	const vector<StorageIndex> column_ids = {StorageIndex(COLUMN_IDENTIFIER_ROW_ID)};
+	const auto row_ids = FlatVector::GetData<row_t>(lstate.row_ids);
+
+	while (lstate.index_state) {
+		const auto row_count = RTreeIndexScanIndex(bind_data, gstate, lstate);
+		if (row_count == 0) {
+			break;
+		}
+		lstate.visible_chunk.Reset();
+		bind_data.table.GetStorage().Fetch(transaction, lstate.visible_chunk, column_ids, lstate.row_ids, row_count,
+		                                   lstate.visible_fetch_state);
+
+		const auto visible_count = lstate.visible_chunk.size();
+		const auto visible_ids = FlatVector::GetData<row_t>(lstate.visible_chunk.data[0]);
+		rtree_index.ConfirmKNNScan(*lstate.index_state, visible_ids, visible_count);
+		if (visible_count != 0) {
+			memcpy(row_ids, visible_ids, visible_count * sizeof(row_t));
+			return visible_count;
+		}
+	}
+	return 0;
+}
+
+// Check the rows that the index could not decide for an exact extent filter against their geometry. The leaf bounds are
+// rounded, so this is only needed for rows that lie right on the border of the query box.
+static idx_t RTreeIndexScanUncertain(DuckTransaction &transaction, const RTreeIndexScanBindData &bind_data,
+                                     const RTreeIndexScanGlobalState &gstate, RTreeIndexScanLocalState &lstate) {
+	auto &uncertain = lstate.uncertain_row_ids;
+	const auto row_ids = FlatVector::GetData<row_t>(lstate.row_ids);
+	const sgl::box_xy query = {{bind_data.exact_box.min.x, bind_data.exact_box.min.y},
+	                           {bind_data.exact_box.max.x, bind_data.exact_box.max.y}};
+
+	while (lstate.uncertain_offset < uncertain.size()) {
+		const auto count = MinValue<idx_t>(uncertain.size() - lstate.uncertain_offset, STANDARD_VECTOR_SIZE);
+		Vector candidates(LogicalType::ROW_TYPE, data_ptr_cast(uncertain.data() + lstate.uncertain_offset));
+		lstate.uncertain_offset += count;
+
+		// Only the rows visible to the transaction are fetched, so fetch their row ids along
+		lstate.extent_chunk.Reset();
+		bind_data.table.GetStorage().Fetch(transaction, lstate.extent_chunk, gstate.extent_column_ids, candidates, count,
+		                                   lstate.extent_fetch_state);
+
+		const auto &geom_vec = lstate.extent_chunk.data[0];
+		const auto geom_data = FlatVector::GetData<string_t>(geom_vec);
+		const auto fetched_ids = FlatVector::GetData<row_t>(lstate.extent_chunk.data[1]);
+
+		idx_t result_count = 0;
+		for (idx_t i = 0; i < lstate.extent_chunk.size(); i++) {
+			if (!FlatVector::Validity(geom_vec).RowIsValid(i)) {
+				continue;
+			}
+			auto extent = sgl::box_xy::smallest();
+			if (Serde::TryGetExtentXY(geom_data[i].GetData(), geom_data[i].GetSize(), extent) &&
+			    extent.intersects(query)) {
+				row_ids[result_count++] = fetched_ids[i];
+			}
+		}
+		if (result_count != 0) {
+			return result_count;
+		}
+	}
+	return 0;
+}
+
+static void FlushCounters(RTreeIndexScanGlobalState &gstate, RTreeIndexScanLocalState &lstate) {
+	lock_guard<mutex> guard(gstate.lock);
+	gstate.node_count += lstate.node_count;
+	gstate.row_count += lstate.row_count;
+	gstate.index_time += lstate.index_time;
+	gstate.fetch_time += lstate.fetch_time;
+	lstate.node_count = 0;
+	lstate.row_count = 0;
+	lstate.index_time = 0;
+	lstate.fetch_time = 0;
+}
+
 static void RTreeIndexScanExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
 
 	auto &bind_data = data_p.bind_data->Cast<RTreeIndexScanBindData>();
-	auto &state = data_p.global_state->Cast<RTreeIndexScanGlobalState>();
+	auto &gstate = data_p.global_state->Cast<RTreeIndexScanGlobalState>();
+	auto &lstate = data_p.local_state->Cast<RTreeIndexScanLocalState>();
 	auto &transaction = DuckTransaction::Get(context, bind_data.table.catalog);
 
 	// Scan the index for row id's
-	auto row_count = bind_data.index.Cast<RTreeIndex>().Scan(*state.index_state, state.row_ids);
+	Profiler timer;
+	timer.Start();
+	auto row_count = bind_data.knn_limit != 0 ? RTreeIndexScanNearest(transaction, bind_data, gstate, lstate)
+	                                          : RTreeIndexScanNext(bind_data, gstate, lstate);
+	if (row_count == 0 && bind_data.exact_extent) {
+		row_count = RTreeIndexScanUncertain(transaction, bind_data, gstate, lstate);
+	}
+	timer.End();
+	lstate.index_time += timer.Elapsed();
+
 	if (row_count == 0) {
 		// Short-circuit if the index had no more rows
 		output.SetCardinality(0);
+		FlushCounters(gstate, lstate);
 		return;
 	}
 
+	lstate.row_count += row_count;
+	timer.Start();
+
 	// Fetch the data from the local storage given the row ids
-	if (state.projection_ids.empty()) {
-		bind_data.table.GetStorage().Fetch(transaction, output, state.column_ids, state.row_ids, row_count,
-		                                   state.fetch_state);
-		return;
+	if (gstate.projection_ids.empty()) {
+		bind_data.table.GetStorage().Fetch(transaction, output, gstate.column_ids, lstate.row_ids, row_count,
+		                                   lstate.fetch_state);
+	} else {
+		// Otherwise, we need to first fetch into our scan chunk, and then project out the result
+		lstate.all_columns.Reset();
+		bind_data.table.GetStorage().Fetch(transaction, lstate.all_columns, gstate.column_ids, lstate.row_ids,
+		                                   row_count, lstate.fetch_state);
+		output.ReferenceColumns(lstate.all_columns, gstate.projection_ids);
 	}
 
-	// Otherwise, we need to first fetch into our scan chunk, and then project out the result
-	state.all_columns.Reset();
-	bind_data.table.GetStorage().Fetch(transaction, state.all_columns, state.column_ids, state.row_ids, row_count,
-	                                   state.fetch_state);
-	output.ReferenceColumns(state.all_columns, state.projection_ids);
+	timer.End();
+	lstate.fetch_time += timer.Elapsed();
 }
 
 //-------------------------------------------------------------------------
@@ -153,6 +451,9 @@ unique_ptr<NodeStatistics> RTreeIndexScanCardinality(ClientContext &context, con
 	const auto &storage = bind_data.table.GetStorage();
 	idx_t table_rows = storage.GetTotalRows();
 	idx_t estimated_cardinality = table_rows + local_storage.AddedRows(bind_data.table.GetStorage());
+	if (bind_data.knn_limit != 0) {
+		estimated_cardinality = MinValue(estimated_cardinality, bind_data.knn_limit);
+	}
 	return make_uniq<NodeStatistics>(table_rows, estimated_cardinality);
 }
 
@@ -165,6 +466,27 @@ static InsertionOrderPreservingMap<string> RTreeIndexScanToString(TableFunctionT
 	auto &bind_data = input.bind_data->Cast<RTreeIndexScanBindData>();
 	result["Table"] = bind_data.table.name;
 	result["Index"] = bind_data.index.GetIndexName();
+	if (bind_data.knn_limit != 0) {
+		result["Nearest"] = to_string(bind_data.knn_limit);
+	}
+	if (bind_data.exact_extent) {
+		result["Filter"] = "Exact Extent";
+	}
+	return result;
+}
+
+// Reports how much work the scan did when profiling, summed over all threads
+static InsertionOrderPreservingMap<string> RTreeIndexScanDynamicToString(TableFunctionDynamicToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	if (!input.global_state) {
+		return result;
+	}
+	auto &gstate = input.global_state->Cast<RTreeIndexScanGlobalState>();
+	lock_guard<mutex> guard(gstate.lock);
+	result["Nodes Visited"] = to_string(gstate.node_count);
+	result["Rows Fetched"] = to_string(gstate.row_count);
+	result["Index Time"] = StringUtil::Format("%.4fs", gstate.index_time);
+	result["Fetch Time"] = StringUtil::Format("%.4fs", gstate.fetch_time);
 	return result;
 }
 
@@ -179,12 +501,27 @@ static void RTreeScanSerialize(Serializer &serializer, const optional_ptr<Functi
 	serializer.WriteProperty(102, "table", bind_data.table.name);
 	serializer.WriteProperty(103, "index_name", bind_data.index.GetIndexName());
 
-	serializer.WriteObject(104, "bbox", [&](Serializer &ser) {
-		ser.WriteProperty<float>(10, "min_x", bind_data.bbox.min.x);
-		ser.WriteProperty<float>(11, "min_y", bind_data.bbox.min.y);
-		ser.WriteProperty<float>(20, "max_x", bind_data.bbox.max.x);
-		ser.WriteProperty<float>(21, "max_y", bind_data.bbox.max.y);
+	serializer.WriteList(104, "boxes", bind_data.boxes.size(), [&](Serializer::List &list, idx_t i) {
+		const auto &bbox = bind_data.boxes[i];
+		list.WriteObject([&](Serializer &ser) {
+			ser.WriteProperty<float>(10, "min_x", bbox.min.x);
+			ser.WriteProperty<float>(11, "min_y", bbox.min.y);
+			ser.WriteProperty<float>(20, "max_x", bbox.max.x);
+			ser.WriteProperty<float>(21, "max_y", bbox.max.y);
+		});
 	});
+	serializer.WritePropertyWithDefault<idx_t>(105, "knn_limit", bind_data.knn_limit, 0);
+	serializer.WritePropertyWithDefault(106, "box_expressions", bind_data.box_expressions);
+	serializer.WritePropertyWithDefault<bool>(107, "exact_extent", bind_data.exact_extent, false);
+	if (bind_data.exact_extent) {
+		const auto &bbox = bind_data.exact_box;
+		serializer.WriteObject(108, "exact_box", [&](Serializer &ser) {
+			ser.WriteProperty<double>(10, "min_x", bbox.min.x);
+			ser.WriteProperty<double>(11, "min_y", bbox.min.y);
+			ser.WriteProperty<double>(20, "max_x", bbox.max.x);
+			ser.WriteProperty<double>(21, "max_y", bbox.max.y);
+		});
+	}
 }
 
 static unique_ptr<FunctionData> RTreeScanDeserialize(Deserializer &deserializer, TableFunction &function) {
@@ -200,13 +537,29 @@ static unique_ptr<FunctionData> RTreeScanDeserialize(Deserializer &deserializer,
 
 	// Now also lookup the index by name
 	const auto index_name = deserializer.ReadProperty<string>(103, "index_name");
-	RTreeBounds bbox;
-	deserializer.ReadObject(104, "bbox", [&](Deserializer &ser) {
-		bbox.min.x = ser.ReadProperty<float>(10, "min_x");
-		bbox.min.y = ser.ReadProperty<float>(11, "min_y");
-		bbox.max.x = ser.ReadProperty<float>(20, "max_x");
-		bbox.max.y = ser.ReadProperty<float>(21, "max_y");
+	vector<RTreeBounds> boxes;
+	deserializer.ReadList(104, "boxes", [&](Deserializer::List &list, idx_t i) {
+		RTreeBounds bbox;
+		list.ReadObject([&](Deserializer &ser) {
+			bbox.min.x = ser.ReadProperty<float>(10, "min_x");
+			bbox.min.y = ser.ReadProperty<float>(11, "min_y");
+			bbox.max.x = ser.ReadProperty<float>(20, "max_x");
+			bbox.max.y = ser.ReadProperty<float>(21, "max_y");
+		});
+		boxes.push_back(bbox);
 	});
+	const auto knn_limit = deserializer.ReadPropertyWithExplicitDefault<idx_t>(105, "knn_limit", 0);
+	auto box_expressions = deserializer.ReadPropertyWithDefault<vector<unique_ptr<Expression>>>(106, "box_expressions");
+	const auto exact_extent = deserializer.ReadPropertyWithExplicitDefault<bool>(107, "exact_extent", false);
+	Box2D<double> exact_box;
+	if (exact_extent) {
+		deserializer.ReadObject(108, "exact_box", [&](Deserializer &ser) {
+			exact_box.min.x = ser.ReadProperty<double>(10, "min_x");
+			exact_box.min.y = ser.ReadProperty<double>(11, "min_y");
+			exact_box.max.x = ser.ReadProperty<double>(20, "max_x");
+			exact_box.max.y = ser.ReadProperty<double>(21, "max_y");
+		});
+	}
 
 	auto &duck_table = catalog_entry.Cast<DuckTableEntry>();
 	auto &table_info = *catalog_entry.GetStorage().GetDataTableInfo();
@@ -215,7 +568,10 @@ static unique_ptr<FunctionData> RTreeScanDeserialize(Deserializer &deserializer,
 
 	table_info.GetIndexes().BindAndScan<RTreeIndex>(context, table_info, [&](RTreeIndex &index_entry) {
 		if (index_entry.GetIndexName() == index_name) {
-			result = make_uniq<RTreeIndexScanBindData>(duck_table, index_entry, bbox);
+			result = make_uniq<RTreeIndexScanBindData>(duck_table, index_entry, std::move(boxes), knn_limit);
+			result->box_expressions = std::move(box_expressions);
+			result->exact_extent = exact_extent;
+			result->exact_box = exact_box;
 			return true;
 		}
 		return false;
@@ -232,13 +588,14 @@ static unique_ptr<FunctionData> RTreeScanDeserialize(Deserializer &deserializer,
 //-------------------------------------------------------------------------
 TableFunction RTreeIndexScanFunction::GetFunction() {
 	TableFunction func("rtree_index_scan", {}, RTreeIndexScanExecute);
-	func.init_local = nullptr;
+	func.init_local = RTreeIndexScanInitLocal;
 	func.init_global = RTreeIndexScanInitGlobal;
 	func.statistics = RTreeIndexScanStatistics;
 	func.dependency = RTreeIndexScanDependency;
 	func.cardinality = RTreeIndexScanCardinality;
 	func.pushdown_complex_filter = nullptr;
 	func.to_string = RTreeIndexScanToString;
+	func.dynamic_to_string = RTreeIndexScanDynamicToString;
 	func.table_scan_progress = nullptr;
 	func.projection_pushdown = true;
 	func.filter_pushdown = false;
@@ -254,6 +611,12 @@ TableFunction RTreeIndexScanFunction::GetFunction() {
 //-------------------------------------------------------------------------
 void RTreeModule::RegisterIndexScan(DatabaseInstance &db) {
 	ExtensionUtil::RegisterFunction(db, RTreeIndexScanFunction::GetFunction());
+
+	auto &config = DBConfig::GetConfig(db);
+	config.AddExtensionOption("rtree_index_scan_sort_row_ids",
+	                          "Sort the row ids returned by RTREE index scans in batches, so that the rows are fetched "
+	                          "in storage order",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(true));
 }
 
 } // namespace duckdb
\ No newline at end of file
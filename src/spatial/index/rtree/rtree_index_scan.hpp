@@ -2,6 +2,7 @@
 
 #include "spatial/index/rtree/rtree_node.hpp"
 #include "duckdb/function/table_function.hpp"
+#include "duckdb/planner/expression.hpp"
 
 namespace duckdb {
 class DuckTableEntry;
@@ -9,8 +10,9 @@ class Index;
 
 // This is created by the optimizer rule
 struct RTreeIndexScanBindData final : public TableFunctionData {
-	explicit RTreeIndexScanBindData(DuckTableEntry &table, Index &index, const RTreeBounds &bbox)
-	    : table(table), index(index), bbox(bbox) {
+	explicit RTreeIndexScanBindData(DuckTableEntry &table, Index &index, vector<RTreeBounds> boxes_p,
+	                                idx_t knn_limit = 0)
+	    : table(table), index(index), boxes(std::move(boxes_p)), knn_limit(knn_limit) {
 	}
 
 	//! The table to scan
@@ -19,8 +21,21 @@ struct RTreeIndexScanBindData final : public TableFunctionData {
 	//! The index to use
 	Index &index;
 
-	//! The bounds to scan
-	RTreeBounds bbox;
+	//! The bounds to scan. Rows intersecting more than one of them are only returned once
+	vector<RTreeBounds> boxes;
+
+	//! Geometries whose bounds are scanned as well, but that are only known once the scan starts (e.g. prepared
+	//! statement parameters). These are evaluated when the scan is initialized.
+	vector<unique_ptr<Expression>> box_expressions;
+
+	//! If set, scan for the k nearest entries to the (single) bounds, instead of the entries intersecting them
+	idx_t knn_limit;
+
+	//! If set, the scan evaluates an ST_Intersects_Extent filter with a constant geometry by itself, and only returns
+	//! the rows whose extent intersects this box. The rows the leaf bounds can not decide are checked against their
+	//! geometry, the others are returned without reading the indexed column.
+	bool exact_extent = false;
+	Box2D<double> exact_box;
 
 public:
 	bool Equals(const FunctionData &other_p) const override {
@@ -8,6 +8,7 @@ struct RTreeModule {
 	static void RegisterIndex(DatabaseInstance &db);
 	static void RegisterIndexScan(DatabaseInstance &db);
 	static void RegisterIndexPlanScan(DatabaseInstance &db);
+	static void RegisterIndexPlanExtent(DatabaseInstance &db);
 	static void RegisterIndexPragmas(DatabaseInstance &db);
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "spatial/geometry/bbox.hpp"
+#include "duckdb/common/helper.hpp"
 #include "duckdb/execution/index/index_pointer.hpp"
 
 #include <algorithm>
@@ -102,6 +103,11 @@ public:
 		count = 0;
 	}
 
+	//! Only used by compressed leaf pages, which lay out their entries differently
+	void SetCount(const idx_t count_p) {
+		count = UnsafeNumericCast<uint32_t>(count_p);
+	}
+
 	void PushEntry(const RTreeEntry &entry) {
 		begin()[count++] = entry;
 	}
@@ -189,4 +195,40 @@ public:
 	uint8_t _unused[20] = {};
 };
 
+static_assert(sizeof(RTreeNode) == sizeof(RTreeEntry), "RTreeNode must be the same size as an RTreeEntry");
+
+//-------------------------------------------------------------
+// RTree Compressed Leaf
+//-------------------------------------------------------------
+// A compressed leaf page starts with the RTreeNode, followed by the header and then the entries. The entry bounds are
+// quantized to 16 bits on a grid spanning the leaf bounds, and the row ids are stored as 48 bit offsets from the
+// smallest row id in the leaf.
+
+struct RTreeCompressedLeaf {
+	RTreeBounds bounds;
+	row_t base_row_id;
+};
+
+struct RTreeCompressedEntry {
+	uint16_t bounds[4];
+	uint16_t row_id[3];
+};
+
+//! Scratch space that a compressed leaf page is decoded into while it is being worked on
+class RTreeNodeBuffer {
+public:
+	RTreeNode &Get(const idx_t capacity) {
+		if (capacity > buffer_capacity) {
+			// The node itself takes up the first slot
+			buffer = make_unsafe_uniq_array<RTreeEntry>(capacity + 1);
+			buffer_capacity = capacity;
+		}
+		return *reinterpret_cast<RTreeNode *>(buffer.get());
+	}
+
+private:
+	unsafe_unique_array<RTreeEntry> buffer;
+	idx_t buffer_capacity = 0;
+};
+
 } // namespace duckdb
\ No newline at end of file
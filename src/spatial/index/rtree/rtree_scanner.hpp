@@ -2,15 +2,28 @@
 
 #include "spatial/index/rtree/rtree.hpp"
 
+#include "duckdb/common/optional_ptr.hpp"
+#include "duckdb/common/unordered_map.hpp"
+
+#include <limits>
+#include <queue>
+
 namespace duckdb {
 
 class RTreeScanner {
 public:
-	void Init(const RTreeEntry &root);
+	//! Scan the subtree rooted at the entry. If a snapshot is given, the pages are read as they were when it was taken.
+	//! In that case the tree lock only has to be held while scanning, otherwise it has to be held from here on.
+	void Init(const RTreeEntry &root, optional_ptr<const RTreeSnapshot> snapshot = nullptr);
 	template <class FUNC>
 	void Scan(const RTree &tree, FUNC &&handler);
 	void Reset();
 
+	//! The number of nodes visited since the last Init, including the root
+	idx_t GetNodeCount() const {
+		return node_count;
+	}
+
 private:
 	struct NodeScanState {
 		RTreePointer pointer;
@@ -20,12 +33,17 @@ private:
 	};
 	vector<NodeScanState> stack;
 	idx_t level = 0;
+	idx_t node_count = 0;
+	RTreeNodeBuffer buffer;
+	optional_ptr<const RTreeSnapshot> snapshot;
 };
 
-inline void RTreeScanner::Init(const RTreeEntry &root) {
+inline void RTreeScanner::Init(const RTreeEntry &root, optional_ptr<const RTreeSnapshot> snapshot_p) {
+	snapshot = snapshot_p;
 	stack.clear();
 	stack.emplace_back(root.pointer);
 	level = 0;
+	node_count = 1;
 }
 
 enum class RTreeScanResult : uint8_t {
@@ -39,7 +57,7 @@ inline void RTreeScanner::Scan(const RTree &tree, FUNC &&handler) {
 	// Depth-first scan of all nodes in the RTree with an explicit stack
 	while (!stack.empty()) {
 		auto &frame = stack.back();
-		const auto &node = tree.Ref(frame.pointer);
+		const auto &node = snapshot ? tree.Ref(frame.pointer, buffer, *snapshot) : tree.Ref(frame.pointer, buffer);
 
 		if (frame.pointer.IsLeafPage()) {
 			while (frame.entry_idx < node.GetCount()) {
@@ -68,6 +86,7 @@ inline void RTreeScanner::Scan(const RTree &tree, FUNC &&handler) {
 
 				level++;
 				stack.emplace_back(entry.pointer);
+				node_count++;
 
 				if (result == RTreeScanResult::YIELD) {
 					// Yield!
@@ -82,4 +101,162 @@ inline void RTreeScanner::Scan(const RTree &tree, FUNC &&handler) {
 	}
 }
 
-} // namespace duckdb
\ No newline at end of file
+//----------------------------------------------------------------------------------------------------------------------
+// K-Nearest-Neighbour Scanner
+//----------------------------------------------------------------------------------------------------------------------
+// Best-first scan of the RTree, yielding row ids in order of increasing bounding box distance to the query box.
+// The distance between two geometries is at least the minimum, and at most the maximum distance between their bounding
+// boxes. So once the minimum distance of the next entry exceeds the k-th smallest maximum distance of the rows returned
+// so far, no remaining entry can be among the k nearest and the scan stops. The emitted rows are candidates, and still
+// have to be ordered by their exact distance.
+// The index still contains rows that are deleted, or not visible to the transaction, which must not count towards the
+// k rows. So the caller has to Confirm which of the returned rows it can see before the next Scan.
+class RTreeKNNScanner {
+public:
+	//! Like RTreeScanner::Init, the pages are read through the snapshot if one is given
+	void Init(const RTreeEntry &root, const RTreeBounds &query, idx_t k,
+	          optional_ptr<const RTreeSnapshot> snapshot = nullptr);
+	idx_t Scan(const RTree &tree, row_t *row_ids, idx_t capacity);
+	//! Confirm the rows of the last Scan that are visible, only their distances are used to stop the scan
+	void Confirm(const row_t *row_ids, idx_t count);
+	void Reset();
+
+	//! The number of nodes expanded since the last Reset, the nearest rows can take several Scan calls
+	idx_t GetNodeCount() const {
+		return node_count;
+	}
+
+private:
+	struct QueueEntry {
+		double distance;
+		// The maximum distance, only set for row ids
+		double max_distance;
+		RTreePointer pointer;
+		bool operator>(const QueueEntry &other) const {
+			return distance > other.distance;
+		}
+	};
+
+	// The (squared) minimum distance between the query box and the given box
+	double GetMinDistance(const RTreeBounds &bounds) const;
+	// The (squared) maximum distance between the query box and the given box
+	double GetMaxDistance(const RTreeBounds &bounds) const;
+	// The k-th smallest maximum distance seen so far
+	double GetCutoff() const;
+	void AddMaxDistance(double distance);
+
+	RTreeBounds query;
+	idx_t k = 0;
+
+	// Min-heap of entries to visit, ordered by their minimum distance
+	std::priority_queue<QueueEntry, vector<QueueEntry>, std::greater<QueueEntry>> queue;
+	// Max-heap of the k smallest maximum distances of the confirmed row ids
+	std::priority_queue<double> max_distances;
+	// The maximum distances of the row ids returned by the last scan, until they are confirmed
+	unordered_map<row_t, double> pending;
+
+	idx_t node_count = 0;
+	RTreeNodeBuffer buffer;
+	optional_ptr<const RTreeSnapshot> snapshot;
+};
+
+inline void RTreeKNNScanner::Init(const RTreeEntry &root, const RTreeBounds &query_p, idx_t k_p,
+                                  optional_ptr<const RTreeSnapshot> snapshot_p) {
+	Reset();
+	snapshot = snapshot_p;
+	query = query_p;
+	k = k_p;
+	if (k != 0 && root.pointer.IsSet()) {
+		queue.push({GetMinDistance(root.bounds), 0, root.pointer});
+	}
+}
+
+inline void RTreeKNNScanner::Reset() {
+	queue = decltype(queue)();
+	max_distances = decltype(max_distances)();
+	pending.clear();
+	node_count = 0;
+}
+
+inline double RTreeKNNScanner::GetMinDistance(const RTreeBounds &bounds) const {
+	const auto dx = MaxValue(0.0, MaxValue(static_cast<double>(query.min.x) - bounds.max.x,
+	                                       static_cast<double>(bounds.min.x) - query.max.x));
+	const auto dy = MaxValue(0.0, MaxValue(static_cast<double>(query.min.y) - bounds.max.y,
+	                                       static_cast<double>(bounds.min.y) - query.max.y));
+	return dx * dx + dy * dy;
+}
+
+inline double RTreeKNNScanner::GetMaxDistance(const RTreeBounds &bounds) const {
+	const auto dx = MaxValue(std::abs(static_cast<double>(bounds.max.x) - query.min.x),
+	                         std::abs(static_cast<double>(query.max.x) - bounds.min.x));
+	const auto dy = MaxValue(std::abs(static_cast<double>(bounds.max.y) - query.min.y),
+	                         std::abs(static_cast<double>(query.max.y) - bounds.min.y));
+	return dx * dx + dy * dy;
+}
+
+inline double RTreeKNNScanner::GetCutoff() const {
+	if (max_distances.size() < k) {
+		return std::numeric_limits<double>::infinity();
+	}
+	return max_distances.top();
+}
+
+inline void RTreeKNNScanner::AddMaxDistance(double distance) {
+	if (max_distances.size() < k) {
+		max_distances.push(distance);
+	} else if (distance < max_distances.top()) {
+		max_distances.pop();
+		max_distances.push(distance);
+	}
+}
+
+inline void RTreeKNNScanner::Confirm(const row_t *row_ids, idx_t count) {
+	for (idx_t i = 0; i < count; i++) {
+		const auto entry = pending.find(row_ids[i]);
+		if (entry != pending.end()) {
+			AddMaxDistance(entry->second);
+		}
+	}
+	pending.clear();
+}
+
+inline idx_t RTreeKNNScanner::Scan(const RTree &tree, row_t *row_ids, idx_t capacity) {
+	// Until there are k confirmed rows, there is no cutoff. So only return as many rows as are still missing, instead
+	// of everything up to the capacity.
+	if (max_distances.size() < k) {
+		capacity = MinValue(capacity, k - max_distances.size());
+	}
+	pending.clear();
+
+	idx_t count = 0;
+	while (!queue.empty() && count < capacity) {
+		const auto top = queue.top();
+		if (top.distance > GetCutoff()) {
+			// Nothing left can be among the k nearest
+			queue = decltype(queue)();
+			break;
+		}
+		queue.pop();
+
+		if (top.pointer.IsRowId()) {
+			pending[top.pointer.GetRowId()] = top.max_distance;
+			row_ids[count++] = top.pointer.GetRowId();
+			continue;
+		}
+
+		// Push the children of this node
+		const auto &node = snapshot ? tree.Ref(top.pointer, buffer, *snapshot) : tree.Ref(top.pointer, buffer);
+		node_count++;
+		for (const auto &entry : node) {
+			const auto distance = GetMinDistance(entry.bounds);
+			if (distance > GetCutoff()) {
+				continue;
+			}
+			const auto max_distance = entry.pointer.IsRowId() ? GetMaxDistance(entry.bounds) : 0;
+			queue.push({distance, max_distance, entry.pointer});
+		}
+	}
+	return count;
+}
+
+} // namespace duckdb
@@ -0,0 +1,1342 @@
+#include "spatial/modules/flatgeobuf/flatgeobuf_module.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/spatial_types.hpp"
+
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+
+#include "utf8proc_wrapper.hpp"
+
+namespace duckdb {
+
+namespace {
+
+//######################################################################################################################
+// FlatGeobuf Format
+//######################################################################################################################
+//
+// A FlatGeobuf file consists of
+//  - 8 magic bytes, "fgb", the major version, "fgb" and the patch version
+//  - the header, a size prefixed flatbuffer table describing the geometry type and the columns
+//  - an optional packed Hilbert R-tree over the bounds of all features
+//  - the features, size prefixed flatbuffer tables that are stored in the same order as the leaves of the R-tree
+//
+// See https://github.com/flatgeobuf/flatgeobuf for the schemas of the tables.
+//
+
+constexpr idx_t FGB_MAGIC_SIZE = 8;
+constexpr data_t FGB_MAGIC[] = {'f', 'g', 'b', 3, 'f', 'g', 'b'};
+constexpr idx_t FGB_MAX_HEADER_SIZE = 64 * 1024 * 1024;
+
+// Every R-tree node is its bounds (min x, min y, max x, max y) followed by an offset. The offset of a leaf is the byte
+// offset of its feature (relative to the first feature), the offset of a branch is the index of its first child.
+constexpr idx_t FGB_NODE_SIZE = 4 * sizeof(double) + sizeof(uint64_t);
+constexpr idx_t FGB_NODE_OFFSET = 4 * sizeof(double);
+
+// How much to read at once when scanning the features of a file without an index
+constexpr idx_t FGB_STREAM_BUFFER_SIZE = 1024 * 1024;
+
+// Geometry collections can be nested, but not infinitely
+constexpr idx_t FGB_MAX_GEOMETRY_DEPTH = 128;
+
+enum class FGBGeometryType : uint8_t {
+	UNKNOWN = 0,
+	POINT = 1,
+	LINESTRING = 2,
+	POLYGON = 3,
+	MULTIPOINT = 4,
+	MULTILINESTRING = 5,
+	MULTIPOLYGON = 6,
+	GEOMETRYCOLLECTION = 7,
+};
+
+enum class FGBColumnType : uint8_t {
+	BYTE = 0,
+	UBYTE = 1,
+	BOOL = 2,
+	SHORT = 3,
+	USHORT = 4,
+	INT = 5,
+	UINT = 6,
+	LONG = 7,
+	ULONG = 8,
+	FLOAT = 9,
+	DOUBLE = 10,
+	STRING = 11,
+	JSON = 12,
+	DATETIME = 13,
+	BINARY = 14,
+};
+
+// The ids of the fields we need, i.e. their position in the table schemas
+enum FGBHeaderField : idx_t {
+	HEADER_GEOMETRY_TYPE = 2,
+	HEADER_HAS_Z = 3,
+	HEADER_HAS_M = 4,
+	HEADER_COLUMNS = 7,
+	HEADER_FEATURES_COUNT = 8,
+	HEADER_INDEX_NODE_SIZE = 9,
+};
+
+enum FGBColumnField : idx_t {
+	COLUMN_NAME = 0,
+	COLUMN_TYPE = 1,
+};
+
+enum FGBFeatureField : idx_t {
+	FEATURE_GEOMETRY = 0,
+	FEATURE_PROPERTIES = 1,
+	FEATURE_COLUMNS = 2,
+};
+
+enum FGBGeometryField : idx_t {
+	GEOMETRY_ENDS = 0,
+	GEOMETRY_XY = 1,
+	GEOMETRY_Z = 2,
+	GEOMETRY_M = 3,
+	GEOMETRY_TYPE = 6,
+	GEOMETRY_PARTS = 7,
+};
+
+InvalidInputException CorruptError() {
+	return InvalidInputException("Invalid or corrupt FlatGeobuf data");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Flatbuffer Tables
+//----------------------------------------------------------------------------------------------------------------------
+// A minimal reader for the flatbuffer tables of a FlatGeobuf file. Every access is bounds checked against the buffer,
+// as the files are not trusted. Absent fields fall back to the default of the schema.
+class FlatBufferTable {
+public:
+	FlatBufferTable() = default;
+
+	// The root table of a buffer
+	static FlatBufferTable Root(const_data_ptr_t buffer, idx_t size) {
+		return FlatBufferTable(buffer, size, 0);
+	}
+
+	bool IsValid() const {
+		return buffer != nullptr;
+	}
+
+	template <class T>
+	T GetScalar(idx_t field, T default_value) const {
+		const auto pos = GetFieldPosition(field);
+		if (pos == 0) {
+			return default_value;
+		}
+		Check(pos, sizeof(T));
+		return Load<T>(buffer + pos);
+	}
+
+	// Get a vector of fixed size elements, returns false if the field is absent
+	bool GetVector(idx_t field, idx_t element_size, const_data_ptr_t &data, idx_t &count) const {
+		idx_t pos;
+		if (!GetVectorPosition(field, element_size, pos, count)) {
+			return false;
+		}
+		data = buffer + pos;
+		return true;
+	}
+
+	bool GetString(idx_t field, string &result) const {
+		const_data_ptr_t data;
+		idx_t count;
+		if (!GetVector(field, sizeof(char), data, count)) {
+			return false;
+		}
+		result = string(const_char_ptr_cast(data), count);
+		return true;
+	}
+
+	// Get a nested table, the result is invalid if the field is absent
+	FlatBufferTable GetTable(idx_t field) const {
+		const auto pos = GetFieldPosition(field);
+		return pos == 0 ? FlatBufferTable() : FlatBufferTable(buffer, size, pos);
+	}
+
+	// Get the number of tables in a vector of tables
+	idx_t GetTableCount(idx_t field) const {
+		idx_t pos;
+		idx_t count;
+		return GetVectorPosition(field, sizeof(uint32_t), pos, count) ? count : 0;
+	}
+
+	// Get a table in a vector of tables
+	FlatBufferTable GetTable(idx_t field, idx_t index) const {
+		idx_t pos;
+		idx_t count;
+		if (!GetVectorPosition(field, sizeof(uint32_t), pos, count) || index >= count) {
+			throw CorruptError();
+		}
+		return FlatBufferTable(buffer, size, pos + index * sizeof(uint32_t));
+	}
+
+private:
+	// Reference the table pointed to by the offset at the given position
+	FlatBufferTable(const_data_ptr_t buffer_p, idx_t size_p, idx_t offset_pos) : buffer(buffer_p), size(size_p) {
+		Check(offset_pos, sizeof(uint32_t));
+		table = offset_pos + Load<uint32_t>(buffer + offset_pos);
+		Check(table, sizeof(int32_t));
+
+		const auto vtable_pos = static_cast<int64_t>(table) - Load<int32_t>(buffer + table);
+		if (vtable_pos < 0) {
+			throw CorruptError();
+		}
+		vtable = static_cast<idx_t>(vtable_pos);
+		Check(vtable, sizeof(uint16_t));
+		vtable_size = Load<uint16_t>(buffer + vtable);
+		Check(vtable, vtable_size);
+	}
+
+	// Returns the position of a field in the buffer, or 0 if the field is absent
+	idx_t GetFieldPosition(idx_t field) const {
+		// The vtable starts with its own size and the size of the table
+		const auto entry = (2 + field) * sizeof(uint16_t);
+		if (entry + sizeof(uint16_t) > vtable_size) {
+			return 0;
+		}
+		const auto offset = Load<uint16_t>(buffer + vtable + entry);
+		return offset == 0 ? 0 : table + offset;
+	}
+
+	bool GetVectorPosition(idx_t field, idx_t element_size, idx_t &pos, idx_t &count) const {
+		const auto field_pos = GetFieldPosition(field);
+		if (field_pos == 0) {
+			return false;
+		}
+		Check(field_pos, sizeof(uint32_t));
+		const auto vector_pos = field_pos + Load<uint32_t>(buffer + field_pos);
+		Check(vector_pos, sizeof(uint32_t));
+		count = Load<uint32_t>(buffer + vector_pos);
+		pos = vector_pos + sizeof(uint32_t);
+		Check(pos, count * element_size);
+		return true;
+	}
+
+	void Check(idx_t pos, idx_t len) const {
+		if (pos > size || len > size - pos) {
+			throw CorruptError();
+		}
+	}
+
+	const_data_ptr_t buffer = nullptr;
+	idx_t size = 0;
+	idx_t table = 0;
+	idx_t vtable = 0;
+	idx_t vtable_size = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Utilities
+//----------------------------------------------------------------------------------------------------------------------
+sgl::box_xy GetNodeBounds(const_data_ptr_t node) {
+	sgl::box_xy bounds;
+	bounds.min.x = Load<double>(node);
+	bounds.min.y = Load<double>(node + sizeof(double));
+	bounds.max.x = Load<double>(node + 2 * sizeof(double));
+	bounds.max.y = Load<double>(node + 3 * sizeof(double));
+	return bounds;
+}
+
+LogicalType GetColumnLogicalType(FGBColumnType type) {
+	switch (type) {
+	case FGBColumnType::BYTE:
+		return LogicalType::TINYINT;
+	case FGBColumnType::UBYTE:
+		return LogicalType::UTINYINT;
+	case FGBColumnType::BOOL:
+		return LogicalType::BOOLEAN;
+	case FGBColumnType::SHORT:
+		return LogicalType::SMALLINT;
+	case FGBColumnType::USHORT:
+		return LogicalType::USMALLINT;
+	case FGBColumnType::INT:
+		return LogicalType::INTEGER;
+	case FGBColumnType::UINT:
+		return LogicalType::UINTEGER;
+	case FGBColumnType::LONG:
+		return LogicalType::BIGINT;
+	case FGBColumnType::ULONG:
+		return LogicalType::UBIGINT;
+	case FGBColumnType::FLOAT:
+		return LogicalType::FLOAT;
+	case FGBColumnType::DOUBLE:
+		return LogicalType::DOUBLE;
+	case FGBColumnType::STRING:
+	case FGBColumnType::JSON:
+		return LogicalType::VARCHAR;
+	case FGBColumnType::DATETIME:
+		return LogicalType::TIMESTAMP;
+	case FGBColumnType::BINARY:
+		return LogicalType::BLOB;
+	default:
+		throw NotImplementedException("FlatGeobuf column type %d not supported", static_cast<int>(type));
+	}
+}
+
+// The size of a property value, or 0 if the value is variable sized (prefixed by its size)
+idx_t GetColumnValueSize(FGBColumnType type) {
+	switch (type) {
+	case FGBColumnType::BYTE:
+	case FGBColumnType::UBYTE:
+	case FGBColumnType::BOOL:
+		return 1;
+	case FGBColumnType::SHORT:
+	case FGBColumnType::USHORT:
+		return 2;
+	case FGBColumnType::INT:
+	case FGBColumnType::UINT:
+	case FGBColumnType::FLOAT:
+		return 4;
+	case FGBColumnType::LONG:
+	case FGBColumnType::ULONG:
+	case FGBColumnType::DOUBLE:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+//######################################################################################################################
+// ST_ReadFGB
+//######################################################################################################################
+//
+// Reads FlatGeobuf files without going through GDAL. If the file has an index, the features are handed out to the
+// threads in batches of leaves of the R-tree, and a bounding box filter is pushed into the index so that only the
+// leaves (and features) that intersect it are read. Files without an index are read sequentially.
+//
+struct ST_ReadFGB {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Bind
+	//------------------------------------------------------------------------------------------------------------------
+	struct FGBColumn {
+		string name;
+		FGBColumnType type;
+	};
+
+	struct FGBBindData final : TableFunctionData {
+		string file_name;
+		idx_t file_size = 0;
+
+		FGBGeometryType geometry_type = FGBGeometryType::UNKNOWN;
+		bool has_z = false;
+		bool has_m = false;
+		vector<FGBColumn> columns;
+
+		// The number of features, 0 if unknown (only possible without an index)
+		idx_t features_count = 0;
+		// The node size of the R-tree, 0 if there is no index
+		idx_t index_node_size = 0;
+		// The [start, end) node indices of every level of the R-tree, starting at the leaves
+		vector<pair<idx_t, idx_t>> index_levels;
+
+		idx_t index_offset = 0;
+		idx_t features_offset = 0;
+
+		// Only return features whose bounds intersect the filter
+		bool has_spatial_filter = false;
+		sgl::box_xy spatial_filter = {};
+
+		explicit FGBBindData(string file_name_p) : file_name(std::move(file_name_p)) {
+		}
+
+		bool HasIndex() const {
+			return index_node_size != 0;
+		}
+
+		// The geometry is always the last column
+		idx_t GeometryColumnIndex() const {
+			return columns.size();
+		}
+	};
+
+	static void ReadHeader(FileHandle &handle, FGBBindData &data) {
+		data.file_size = handle.GetFileSize();
+
+		data_t preamble[FGB_MAGIC_SIZE + sizeof(uint32_t)];
+		if (data.file_size < sizeof(preamble)) {
+			throw InvalidInputException("File '%s' is not a FlatGeobuf file", data.file_name);
+		}
+		handle.Read(preamble, sizeof(preamble), 0);
+
+		// Ignore the patch version, it is backwards compatible
+		if (memcmp(preamble, FGB_MAGIC, sizeof(FGB_MAGIC)) != 0) {
+			throw InvalidInputException("File '%s' is not a FlatGeobuf (version 3) file", data.file_name);
+		}
+
+		const auto header_size = static_cast<idx_t>(Load<uint32_t>(preamble + FGB_MAGIC_SIZE));
+		if (header_size > FGB_MAX_HEADER_SIZE || sizeof(preamble) + header_size > data.file_size) {
+			throw InvalidInputException("Invalid header in FlatGeobuf file '%s'", data.file_name);
+		}
+		auto header_buffer = make_unsafe_uniq_array<data_t>(header_size);
+		handle.Read(header_buffer.get(), header_size, sizeof(preamble));
+
+		const auto header = FlatBufferTable::Root(header_buffer.get(), header_size);
+
+		const auto geometry_type = header.GetScalar<uint8_t>(HEADER_GEOMETRY_TYPE, 0);
+		if (geometry_type > static_cast<uint8_t>(FGBGeometryType::GEOMETRYCOLLECTION)) {
+			throw NotImplementedException("FlatGeobuf geometry type %d not supported", geometry_type);
+		}
+		data.geometry_type = static_cast<FGBGeometryType>(geometry_type);
+		data.has_z = header.GetScalar<uint8_t>(HEADER_HAS_Z, 0) != 0;
+		data.has_m = header.GetScalar<uint8_t>(HEADER_HAS_M, 0) != 0;
+
+		const auto column_count = header.GetTableCount(HEADER_COLUMNS);
+		for (idx_t i = 0; i < column_count; i++) {
+			const auto column = header.GetTable(HEADER_COLUMNS, i);
+			FGBColumn result;
+			if (!column.GetString(COLUMN_NAME, result.name)) {
+				throw InvalidInputException("Invalid header in FlatGeobuf file '%s'", data.file_name);
+			}
+			result.type = static_cast<FGBColumnType>(column.GetScalar<uint8_t>(COLUMN_TYPE, 0));
+			data.columns.push_back(std::move(result));
+		}
+
+		data.features_count = header.GetScalar<uint64_t>(HEADER_FEATURES_COUNT, 0);
+		const auto node_size = static_cast<idx_t>(header.GetScalar<uint16_t>(HEADER_INDEX_NODE_SIZE, 16));
+
+		data.index_offset = sizeof(preamble) + header_size;
+		data.features_offset = data.index_offset;
+
+		if (data.features_count == 0 || node_size == 0) {
+			// No index
+			return;
+		}
+		if (node_size < 2 || data.features_count > data.file_size / FGB_NODE_SIZE) {
+			throw InvalidInputException("Invalid index in FlatGeobuf file '%s'", data.file_name);
+		}
+
+		// Compute the layout of the R-tree, every level has one node for every 'node_size' nodes of the level below
+		vector<idx_t> level_sizes;
+		idx_t level_size = data.features_count;
+		idx_t node_count = level_size;
+		level_sizes.push_back(level_size);
+		do {
+			level_size = (level_size + node_size - 1) / node_size;
+			level_sizes.push_back(level_size);
+			node_count += level_size;
+		} while (level_size != 1);
+
+		// The levels are stored top down, so the leaves are at the end
+		idx_t level_end = node_count;
+		for (const auto size : level_sizes) {
+			data.index_levels.emplace_back(level_end - size, level_end);
+			level_end -= size;
+		}
+
+		const auto index_size = node_count * FGB_NODE_SIZE;
+		if (data.index_offset + index_size > data.file_size) {
+			throw InvalidInputException("Invalid index in FlatGeobuf file '%s'", data.file_name);
+		}
+		data.index_node_size = node_size;
+		data.features_offset = data.index_offset + index_size;
+	}
+
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names) {
+
+		auto file_name = StringValue::Get(input.inputs[0]);
+		auto result = make_uniq<FGBBindData>(file_name);
+
+		auto &fs = FileSystem::GetFileSystem(context);
+		auto handle = fs.OpenFile(file_name, FileFlags::FILE_FLAGS_READ);
+		ReadHeader(*handle, *result);
+
+		for (auto &kv : input.named_parameters) {
+			if (kv.first == "spatial_filter_box") {
+				auto &children = StructValue::GetChildren(kv.second);
+				result->has_spatial_filter = true;
+				result->spatial_filter.min.x = DoubleValue::Get(children[0]);
+				result->spatial_filter.min.y = DoubleValue::Get(children[1]);
+				result->spatial_filter.max.x = DoubleValue::Get(children[2]);
+				result->spatial_filter.max.y = DoubleValue::Get(children[3]);
+			}
+		}
+
+		for (const auto &column : result->columns) {
+			names.push_back(column.name);
+			return_types.push_back(GetColumnLogicalType(column.type));
+		}
+
+		// Always return geometry last
+		return_types.push_back(GeoTypes::GEOMETRY());
+		names.push_back("geom");
+
+		// Deduplicate field names if necessary
+		for (size_t i = 0; i < names.size(); i++) {
+			idx_t count = 1;
+			for (size_t j = i + 1; j < names.size(); j++) {
+				if (names[i] == names[j]) {
+					names[j] += "_" + std::to_string(count++);
+				}
+			}
+		}
+
+		return std::move(result);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Filter Pushdown
+	//------------------------------------------------------------------------------------------------------------------
+	// Spatial predicates between the geometry column and a constant geometry imply that the bounds of the features
+	// intersect the bounds of the constant, which is pushed into the index. The predicates themselves are kept.
+
+	static bool TryGetFilterBounds(const LogicalGet &get, const FGBBindData &data, const Expression &expr,
+	                               sgl::box_xy &bounds) {
+		static const case_insensitive_set_t spatial_predicates = {
+		    "ST_Equals",   "ST_Intersects", "ST_Touches",   "ST_Crosses",          "ST_Within",         "ST_Contains",
+		    "ST_Overlaps", "ST_Covers",     "ST_CoveredBy", "ST_ContainsProperly", "ST_WithinProperly", "ST_DWithin",
+		    "ST_Intersects_Extent"};
+
+		if (expr.GetExpressionClass() != ExpressionClass::BOUND_FUNCTION) {
+			return false;
+		}
+		auto &func = expr.Cast<BoundFunctionExpression>();
+		if (spatial_predicates.find(func.function.name) == spatial_predicates.end()) {
+			return false;
+		}
+		const auto is_distance = StringUtil::CIEquals(func.function.name, "ST_DWithin");
+		if (func.children.size() != (is_distance ? 3 : 2)) {
+			return false;
+		}
+
+		// One side has to be the geometry column, and the other a constant
+		auto &lhs = *func.children[0];
+		auto &rhs = *func.children[1];
+		auto &column_expr = lhs.GetExpressionClass() == ExpressionClass::BOUND_COLUMN_REF ? lhs : rhs;
+		auto &constant_expr = &column_expr == &lhs ? rhs : lhs;
+		if (column_expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF ||
+		    constant_expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT ||
+		    constant_expr.return_type != GeoTypes::GEOMETRY()) {
+			return false;
+		}
+		auto &column = column_expr.Cast<BoundColumnRefExpression>();
+		const auto &column_ids = get.GetColumnIds();
+		if (column.binding.table_index != get.table_index || column.binding.column_index >= column_ids.size() ||
+		    column_ids[column.binding.column_index].GetPrimaryIndex() != data.GeometryColumnIndex()) {
+			return false;
+		}
+
+		auto &constant = constant_expr.Cast<BoundConstantExpression>().value;
+		if (constant.IsNull()) {
+			return false;
+		}
+		const auto &blob = StringValue::Get(constant);
+		bounds = sgl::box_xy::smallest();
+		if (!Serde::TryGetExtentXY(blob.data(), blob.size(), bounds)) {
+			return false;
+		}
+
+		if (is_distance) {
+			auto &distance_expr = *func.children[2];
+			if (distance_expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+				return false;
+			}
+			auto &distance_value = distance_expr.Cast<BoundConstantExpression>().value;
+			if (distance_value.IsNull()) {
+				return false;
+			}
+			const auto distance = distance_value.GetValue<double>();
+			if (!(distance >= 0)) {
+				return false;
+			}
+			bounds.min.x -= distance;
+			bounds.min.y -= distance;
+			bounds.max.x += distance;
+			bounds.max.y += distance;
+		}
+		return true;
+	}
+
+	static void PushdownComplexFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+	                                  vector<unique_ptr<Expression>> &filters) {
+		auto &data = bind_data_p->Cast<FGBBindData>();
+		if (data.has_spatial_filter) {
+			// Dont override an explicit spatial filter
+			return;
+		}
+
+		// The filters are all AND'ed together, so intersect the bounds of all predicates
+		for (const auto &filter : filters) {
+			sgl::box_xy bounds = {};
+			if (!TryGetFilterBounds(get, data, *filter, bounds)) {
+				continue;
+			}
+			if (!data.has_spatial_filter) {
+				data.has_spatial_filter = true;
+				data.spatial_filter = bounds;
+			} else {
+				data.spatial_filter.min.x = MaxValue(data.spatial_filter.min.x, bounds.min.x);
+				data.spatial_filter.min.y = MaxValue(data.spatial_filter.min.y, bounds.min.y);
+				data.spatial_filter.max.x = MinValue(data.spatial_filter.max.x, bounds.max.x);
+				data.spatial_filter.max.y = MinValue(data.spatial_filter.max.y, bounds.max.y);
+			}
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Init Global
+	//------------------------------------------------------------------------------------------------------------------
+	// A run of consecutive leaves (i.e. features) of the R-tree
+	struct LeafSpan {
+		idx_t start;
+		idx_t count;
+	};
+
+	struct FGBGlobalState final : GlobalTableFunctionState {
+		vector<idx_t> column_ids;
+		idx_t max_threads = 1;
+
+		// Indexed files: the spans of leaves to read, grouped into batches of at most one vector of features.
+		// Batch 'i' consists of the spans [batch_starts[i], batch_starts[i + 1])
+		vector<LeafSpan> spans;
+		vector<idx_t> batch_starts;
+		atomic<idx_t> next_batch;
+
+		// Files without an index are read sequentially
+		mutex stream_lock;
+		idx_t stream_offset = 0;
+		idx_t stream_batch = 0;
+
+		explicit FGBGlobalState(vector<idx_t> column_ids_p) : column_ids(std::move(column_ids_p)), next_batch(0) {
+		}
+
+		idx_t MaxThreads() const override {
+			return max_threads;
+		}
+
+		idx_t BatchCount() const {
+			return batch_starts.empty() ? 0 : batch_starts.size() - 1;
+		}
+
+		// Claim the next batch, returns false once all batches have been claimed
+		bool GetNextBatch(idx_t &batch_idx) {
+			batch_idx = next_batch.fetch_add(1);
+			return batch_idx < BatchCount();
+		}
+
+		// Split the (ordered) spans into batches
+		void SetSpans(const vector<LeafSpan> &leaf_spans) {
+			idx_t batch_size = 0;
+			batch_starts.push_back(0);
+			for (auto span : leaf_spans) {
+				while (span.count > 0) {
+					if (batch_size == STANDARD_VECTOR_SIZE) {
+						batch_starts.push_back(spans.size());
+						batch_size = 0;
+					}
+					const auto count = MinValue<idx_t>(span.count, STANDARD_VECTOR_SIZE - batch_size);
+					spans.push_back({span.start, count});
+					span.start += count;
+					span.count -= count;
+					batch_size += count;
+				}
+			}
+			if (spans.empty()) {
+				batch_starts.clear();
+			} else {
+				batch_starts.push_back(spans.size());
+			}
+		}
+	};
+
+	// Search the branch levels of the R-tree for the leaves whose parents intersect the filter. The nodes of a level
+	// are only read where their parent intersects the filter, and sibling groups next to each other are read at once.
+	static vector<LeafSpan> SearchIndex(FileHandle &handle, const FGBBindData &data) {
+		const auto &levels = data.index_levels;
+		const auto node_size = data.index_node_size;
+
+		// The first node of every group of siblings to visit on the current level, starting at the root
+		vector<idx_t> groups = {0};
+		vector<data_t> buffer;
+
+		for (idx_t level = levels.size() - 1; level > 0; level--) {
+			const auto level_end = levels[level].second;
+			const auto &child_level = levels[level - 1];
+
+			vector<idx_t> child_groups;
+			idx_t group_idx = 0;
+			while (group_idx < groups.size()) {
+				const auto run_start = groups[group_idx];
+				auto run_end = MinValue(run_start + node_size, level_end);
+				for (group_idx++; group_idx < groups.size() && groups[group_idx] == run_end; group_idx++) {
+					run_end = MinValue(run_end + node_size, level_end);
+				}
+
+				buffer.resize((run_end - run_start) * FGB_NODE_SIZE);
+				handle.Read(buffer.data(), buffer.size(), data.index_offset + run_start * FGB_NODE_SIZE);
+
+				for (idx_t node_idx = 0; node_idx < run_end - run_start; node_idx++) {
+					const auto node = buffer.data() + node_idx * FGB_NODE_SIZE;
+					if (!GetNodeBounds(node).intersects(data.spatial_filter)) {
+						continue;
+					}
+					const auto child = Load<uint64_t>(node + FGB_NODE_OFFSET);
+					if (child < child_level.first || child >= child_level.second) {
+						throw InvalidInputException("Invalid index in FlatGeobuf file '%s'", data.file_name);
+					}
+					child_groups.push_back(child);
+				}
+			}
+			groups = std::move(child_groups);
+		}
+
+		// The groups are now on the leaf level, whose nodes are in the same order as the features
+		std::sort(groups.begin(), groups.end());
+
+		const auto leaf_start = levels[0].first;
+		vector<LeafSpan> result;
+		for (const auto group : groups) {
+			const auto start = group - leaf_start;
+			const auto end = MinValue(start + node_size, data.features_count);
+			if (!result.empty() && result.back().start + result.back().count >= start) {
+				auto &last = result.back();
+				last.count = MaxValue(last.start + last.count, end) - last.start;
+			} else {
+				result.push_back({start, end - start});
+			}
+		}
+		return result;
+	}
+
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+		auto &bind_data = input.bind_data->Cast<FGBBindData>();
+		auto result = make_uniq<FGBGlobalState>(input.column_ids);
+
+		if (!bind_data.HasIndex()) {
+			result->stream_offset = bind_data.features_offset;
+			return std::move(result);
+		}
+
+		if (bind_data.has_spatial_filter) {
+			auto &fs = FileSystem::GetFileSystem(context);
+			auto handle = fs.OpenFile(bind_data.file_name, FileFlags::FILE_FLAGS_READ);
+			result->SetSpans(SearchIndex(*handle, bind_data));
+		} else {
+			result->SetSpans({{0, bind_data.features_count}});
+		}
+
+		// Every thread opens its own handle, so dont use more threads than batches
+		result->max_threads = MaxValue<idx_t>(MinValue<idx_t>(context.db->NumberOfThreads(), result->BatchCount()), 1);
+		return std::move(result);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Init Local
+	//------------------------------------------------------------------------------------------------------------------
+	struct FGBLocalState final : LocalTableFunctionState {
+		unique_ptr<FileHandle> handle;
+		ArenaAllocator arena;
+		// The batch currently being read
+		idx_t batch_index = 0;
+
+		// The output column of every column of the file, or INVALID_INDEX if the column is not projected
+		vector<idx_t> column_outputs;
+		idx_t geometry_output = DConstants::INVALID_INDEX;
+		bool read_properties = false;
+
+		explicit FGBLocalState(ClientContext &context) : arena(BufferAllocator::Get(context)) {
+		}
+	};
+
+	static unique_ptr<LocalTableFunctionState> InitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+	                                                     GlobalTableFunctionState *global_state) {
+		auto &bind_data = input.bind_data->Cast<FGBBindData>();
+
+		auto result = make_uniq<FGBLocalState>(context.client);
+		auto &fs = FileSystem::GetFileSystem(context.client);
+		result->handle = fs.OpenFile(bind_data.file_name, FileFlags::FILE_FLAGS_READ);
+
+		result->column_outputs.resize(bind_data.columns.size(), DConstants::INVALID_INDEX);
+		for (idx_t output_idx = 0; output_idx < input.column_ids.size(); output_idx++) {
+			const auto column_id = input.column_ids[output_idx];
+			if (column_id == bind_data.GeometryColumnIndex()) {
+				result->geometry_output = output_idx;
+			} else if (column_id < bind_data.columns.size()) {
+				result->column_outputs[column_id] = output_idx;
+				result->read_properties = true;
+			}
+		}
+		return std::move(result);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Geometry Conversion
+	//------------------------------------------------------------------------------------------------------------------
+	// The vertices of a geometry table. Without Z and M the interleaved x/y doubles are referenced in place, otherwise
+	// the separate Z and M arrays are interleaved into a new buffer.
+	struct FGBVertices {
+		const_data_ptr_t data = nullptr;
+		idx_t count = 0;
+		idx_t width = 0;
+
+		const_data_ptr_t Vertex(idx_t vertex_idx) const {
+			return data + vertex_idx * width;
+		}
+	};
+
+	static FGBVertices GetVertices(const FGBBindData &data, const FlatBufferTable &table, ArenaAllocator &arena) {
+		FGBVertices result;
+		result.width = sizeof(double) * (2 + data.has_z + data.has_m);
+
+		const_data_ptr_t xy;
+		idx_t xy_count;
+		if (!table.GetVector(GEOMETRY_XY, sizeof(double), xy, xy_count)) {
+			return result;
+		}
+		if (xy_count % 2 != 0) {
+			throw CorruptError();
+		}
+		result.count = xy_count / 2;
+
+		if (!data.has_z && !data.has_m) {
+			result.data = xy;
+			return result;
+		}
+
+		const_data_ptr_t z = nullptr;
+		const_data_ptr_t m = nullptr;
+		idx_t count;
+		if (data.has_z && (!table.GetVector(GEOMETRY_Z, sizeof(double), z, count) || count != result.count)) {
+			throw CorruptError();
+		}
+		if (data.has_m && (!table.GetVector(GEOMETRY_M, sizeof(double), m, count) || count != result.count)) {
+			throw CorruptError();
+		}
+
+		const auto buffer = arena.AllocateAligned(result.count * result.width);
+		for (idx_t i = 0; i < result.count; i++) {
+			auto vertex = buffer + i * result.width;
+			memcpy(vertex, xy + i * 2 * sizeof(double), 2 * sizeof(double));
+			vertex += 2 * sizeof(double);
+			if (z) {
+				memcpy(vertex, z + i * sizeof(double), sizeof(double));
+				vertex += sizeof(double);
+			}
+			if (m) {
+				memcpy(vertex, m + i * sizeof(double), sizeof(double));
+			}
+		}
+		result.data = buffer;
+		return result;
+	}
+
+	static sgl::geometry *MakePart(const FGBBindData &data, sgl::geometry_type type, const FGBVertices &vertices,
+	                               idx_t start, idx_t end, ArenaAllocator &arena) {
+		const auto part_mem = arena.AllocateAligned(sizeof(sgl::geometry));
+		const auto part = new (part_mem) sgl::geometry(type, data.has_z, data.has_m);
+		part->set_vertex_data(vertices.Vertex(start), static_cast<uint32_t>(end - start));
+		return part;
+	}
+
+	// Split the vertices into parts at the 'ends' of the geometry, which are the (exclusive) end vertex of every part.
+	// Without ends, all vertices are a single part.
+	static void AppendParts(const FGBBindData &data, const FlatBufferTable &table, const FGBVertices &vertices,
+	                        sgl::geometry_type part_type, sgl::geometry &geom, ArenaAllocator &arena) {
+		const_data_ptr_t ends;
+		idx_t end_count;
+		if (!table.GetVector(GEOMETRY_ENDS, sizeof(uint32_t), ends, end_count)) {
+			if (vertices.count != 0) {
+				geom.append_part(MakePart(data, part_type, vertices, 0, vertices.count, arena));
+			}
+			return;
+		}
+
+		idx_t start = 0;
+		for (idx_t i = 0; i < end_count; i++) {
+			const auto end = static_cast<idx_t>(Load<uint32_t>(ends + i * sizeof(uint32_t)));
+			if (end < start || end > vertices.count) {
+				throw CorruptError();
+			}
+			geom.append_part(MakePart(data, part_type, vertices, start, end, arena));
+			start = end;
+		}
+	}
+
+	static void ConvertGeometry(const FGBBindData &data, const FlatBufferTable &table, FGBGeometryType type,
+	                            sgl::geometry &geom, ArenaAllocator &arena, idx_t depth) {
+		if (depth > FGB_MAX_GEOMETRY_DEPTH) {
+			throw InvalidInputException("FlatGeobuf geometry nested too deeply");
+		}
+
+		// If the type is not known from the header (or the parent), it is stored in the geometry itself
+		if (type == FGBGeometryType::UNKNOWN) {
+			const auto geometry_type = table.GetScalar<uint8_t>(GEOMETRY_TYPE, 0);
+			if (geometry_type == 0 || geometry_type > static_cast<uint8_t>(FGBGeometryType::GEOMETRYCOLLECTION)) {
+				throw NotImplementedException("FlatGeobuf geometry type %d not supported", geometry_type);
+			}
+			type = static_cast<FGBGeometryType>(geometry_type);
+		}
+
+		geom.set_z(data.has_z);
+		geom.set_m(data.has_m);
+
+		switch (type) {
+		case FGBGeometryType::POINT: {
+			geom.set_type(sgl::geometry_type::POINT);
+			const auto vertices = GetVertices(data, table, arena);
+			if (vertices.count > 1) {
+				throw CorruptError();
+			}
+			geom.set_vertex_data(vertices.data, static_cast<uint32_t>(vertices.count));
+		} break;
+		case FGBGeometryType::LINESTRING: {
+			geom.set_type(sgl::geometry_type::LINESTRING);
+			const auto vertices = GetVertices(data, table, arena);
+			geom.set_vertex_data(vertices.data, static_cast<uint32_t>(vertices.count));
+		} break;
+		case FGBGeometryType::POLYGON: {
+			geom.set_type(sgl::geometry_type::POLYGON);
+			const auto vertices = GetVertices(data, table, arena);
+			AppendParts(data, table, vertices, sgl::geometry_type::LINESTRING, geom, arena);
+		} break;
+		case FGBGeometryType::MULTIPOINT: {
+			geom.set_type(sgl::geometry_type::MULTI_POINT);
+			const auto vertices = GetVertices(data, table, arena);
+			for (idx_t i = 0; i < vertices.count; i++) {
+				geom.append_part(MakePart(data, sgl::geometry_type::POINT, vertices, i, i + 1, arena));
+			}
+		} break;
+		case FGBGeometryType::MULTILINESTRING: {
+			geom.set_type(sgl::geometry_type::MULTI_LINESTRING);
+			const auto vertices = GetVertices(data, table, arena);
+			AppendParts(data, table, vertices, sgl::geometry_type::LINESTRING, geom, arena);
+		} break;
+		case FGBGeometryType::MULTIPOLYGON:
+		case FGBGeometryType::GEOMETRYCOLLECTION: {
+			// The polygons of a multi polygon and the members of a collection are stored as separate parts
+			const auto is_multi_polygon = type == FGBGeometryType::MULTIPOLYGON;
+			geom.set_type(is_multi_polygon ? sgl::geometry_type::MULTI_POLYGON : sgl::geometry_type::MULTI_GEOMETRY);
+			const auto part_type = is_multi_polygon ? FGBGeometryType::POLYGON : FGBGeometryType::UNKNOWN;
+
+			const auto part_count = table.GetTableCount(GEOMETRY_PARTS);
+			for (idx_t i = 0; i < part_count; i++) {
+				const auto part_mem = arena.AllocateAligned(sizeof(sgl::geometry));
+				const auto part = new (part_mem) sgl::geometry();
+				ConvertGeometry(data, table.GetTable(GEOMETRY_PARTS, i), part_type, *part, arena, depth + 1);
+				geom.append_part(part);
+			}
+		} break;
+		default:
+			throw NotImplementedException("FlatGeobuf geometry type %d not supported", static_cast<int>(type));
+		}
+	}
+
+	// Expand the bounds by all vertices of the geometry, returns false if the geometry is empty
+	static bool GetGeometryBounds(const FlatBufferTable &table, sgl::box_xy &bounds, idx_t depth) {
+		if (depth > FGB_MAX_GEOMETRY_DEPTH) {
+			throw InvalidInputException("FlatGeobuf geometry nested too deeply");
+		}
+
+		bool has_vertices = false;
+		const_data_ptr_t xy;
+		idx_t xy_count;
+		if (table.GetVector(GEOMETRY_XY, sizeof(double), xy, xy_count)) {
+			for (idx_t i = 0; i + 1 < xy_count; i += 2) {
+				const auto x = Load<double>(xy + i * sizeof(double));
+				const auto y = Load<double>(xy + (i + 1) * sizeof(double));
+				bounds.min.x = MinValue(bounds.min.x, x);
+				bounds.min.y = MinValue(bounds.min.y, y);
+				bounds.max.x = MaxValue(bounds.max.x, x);
+				bounds.max.y = MaxValue(bounds.max.y, y);
+				has_vertices = true;
+			}
+		}
+
+		const auto part_count = table.GetTableCount(GEOMETRY_PARTS);
+		for (idx_t i = 0; i < part_count; i++) {
+			has_vertices |= GetGeometryBounds(table.GetTable(GEOMETRY_PARTS, i), bounds, depth + 1);
+		}
+		return has_vertices;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Property Conversion
+	//------------------------------------------------------------------------------------------------------------------
+	template <class T>
+	static void SetValue(Vector &result, idx_t row_idx, const_data_ptr_t value) {
+		FlatVector::GetData<T>(result)[row_idx] = Load<T>(value);
+	}
+
+	static void SetProperty(const FGBColumn &column, Vector &result, idx_t row_idx, const_data_ptr_t value,
+	                        idx_t value_size) {
+		switch (column.type) {
+		case FGBColumnType::BYTE:
+			SetValue<int8_t>(result, row_idx, value);
+			break;
+		case FGBColumnType::UBYTE:
+			SetValue<uint8_t>(result, row_idx, value);
+			break;
+		case FGBColumnType::BOOL:
+			FlatVector::GetData<bool>(result)[row_idx] = Load<uint8_t>(value) != 0;
+			break;
+		case FGBColumnType::SHORT:
+			SetValue<int16_t>(result, row_idx, value);
+			break;
+		case FGBColumnType::USHORT:
+			SetValue<uint16_t>(result, row_idx, value);
+			break;
+		case FGBColumnType::INT:
+			SetValue<int32_t>(result, row_idx, value);
+			break;
+		case FGBColumnType::UINT:
+			SetValue<uint32_t>(result, row_idx, value);
+			break;
+		case FGBColumnType::LONG:
+			SetValue<int64_t>(result, row_idx, value);
+			break;
+		case FGBColumnType::ULONG:
+			SetValue<uint64_t>(result, row_idx, value);
+			break;
+		case FGBColumnType::FLOAT:
+			SetValue<float>(result, row_idx, value);
+			break;
+		case FGBColumnType::DOUBLE:
+			SetValue<double>(result, row_idx, value);
+			break;
+		case FGBColumnType::STRING:
+		case FGBColumnType::JSON: {
+			const auto str = const_char_ptr_cast(value);
+			if (!Utf8Proc::IsValid(str, value_size)) {
+				throw InvalidInputException("Invalid UTF-8 string in column '%s' of FlatGeobuf file", column.name);
+			}
+			FlatVector::GetData<string_t>(result)[row_idx] = StringVector::AddString(result, str, value_size);
+		} break;
+		case FGBColumnType::DATETIME: {
+			// Stored as an ISO 8601 string
+			const string_t str(const_char_ptr_cast(value), static_cast<uint32_t>(value_size));
+			timestamp_t timestamp;
+			if (!TryCast::Operation<string_t, timestamp_t>(str, timestamp, false)) {
+				// Leave unparseable values NULL
+				return;
+			}
+			FlatVector::GetData<timestamp_t>(result)[row_idx] = timestamp;
+		} break;
+		case FGBColumnType::BINARY:
+			FlatVector::GetData<string_t>(result)[row_idx] =
+			    StringVector::AddStringOrBlob(result, const_char_ptr_cast(value), value_size);
+			break;
+		default:
+			throw NotImplementedException("FlatGeobuf column type %d not supported", static_cast<int>(column.type));
+		}
+		FlatVector::Validity(result).SetValid(row_idx);
+	}
+
+	// The properties are a sequence of column indices, each followed by the value of the column
+	static void ConvertProperties(const FGBBindData &data, const FGBLocalState &lstate, const_data_ptr_t properties,
+	                              idx_t size, DataChunk &output, idx_t row_idx) {
+		idx_t pos = 0;
+		while (pos < size) {
+			if (size - pos < sizeof(uint16_t)) {
+				throw CorruptError();
+			}
+			const auto column_idx = Load<uint16_t>(properties + pos);
+			pos += sizeof(uint16_t);
+			if (column_idx >= data.columns.size()) {
+				throw CorruptError();
+			}
+			const auto &column = data.columns[column_idx];
+
+			auto value_size = GetColumnValueSize(column.type);
+			if (value_size == 0) {
+				if (size - pos < sizeof(uint32_t)) {
+					throw CorruptError();
+				}
+				value_size = Load<uint32_t>(properties + pos);
+				pos += sizeof(uint32_t);
+			}
+			if (size - pos < value_size) {
+				throw CorruptError();
+			}
+
+			const auto output_idx = lstate.column_outputs[column_idx];
+			if (output_idx != DConstants::INVALID_INDEX) {
+				SetProperty(column, output.data[output_idx], row_idx, properties + pos, value_size);
+			}
+			pos += value_size;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Execute
+	//------------------------------------------------------------------------------------------------------------------
+	// Convert a single feature into the given row of the output. If 'check_bounds' is set, features that dont
+	// intersect the spatial filter are skipped, returns false if so.
+	static bool ConvertFeature(const FGBBindData &data, FGBLocalState &lstate, const_data_ptr_t feature_data,
+	                           idx_t feature_size, bool check_bounds, DataChunk &output, idx_t row_idx) {
+		const auto feature = FlatBufferTable::Root(feature_data, feature_size);
+		const auto geometry = feature.GetTable(FEATURE_GEOMETRY);
+
+		if (check_bounds) {
+			auto bounds = sgl::box_xy::smallest();
+			if (!geometry.IsValid() || !GetGeometryBounds(geometry, bounds, 0) ||
+			    !bounds.intersects(data.spatial_filter)) {
+				return false;
+			}
+		}
+
+		if (lstate.geometry_output != DConstants::INVALID_INDEX) {
+			auto &result = output.data[lstate.geometry_output];
+			if (!geometry.IsValid()) {
+				FlatVector::SetNull(result, row_idx, true);
+			} else {
+				sgl::geometry geom;
+				ConvertGeometry(data, geometry, data.geometry_type, geom, lstate.arena, 0);
+
+				// Serialize into a blob
+				const auto size = Serde::GetRequiredSize(geom);
+				auto blob = StringVector::EmptyString(result, size);
+				Serde::Serialize(geom, blob.GetDataWriteable(), size);
+				blob.Finalize();
+
+				FlatVector::GetData<string_t>(result)[row_idx] = blob;
+			}
+		}
+
+		if (!lstate.read_properties) {
+			return true;
+		}
+
+		// Columns without a property are NULL
+		for (const auto output_idx : lstate.column_outputs) {
+			if (output_idx != DConstants::INVALID_INDEX) {
+				FlatVector::SetNull(output.data[output_idx], row_idx, true);
+			}
+		}
+		if (feature.GetTableCount(FEATURE_COLUMNS) != 0) {
+			throw NotImplementedException("FlatGeobuf features with their own columns are not supported");
+		}
+		const_data_ptr_t properties;
+		idx_t properties_size;
+		if (feature.GetVector(FEATURE_PROPERTIES, sizeof(uint8_t), properties, properties_size)) {
+			ConvertProperties(data, lstate, properties, properties_size, output, row_idx);
+		}
+		return true;
+	}
+
+	// Read the features of a span of leaves that intersect the spatial filter. Runs of consecutive matching features
+	// are read at once.
+	static void ReadSpan(const FGBBindData &data, FGBLocalState &lstate, const LeafSpan &span, DataChunk &output,
+	                     idx_t &output_idx) {
+		// Also read the leaf of the next feature, to know where the last feature ends
+		const auto has_next = span.start + span.count < data.features_count;
+		const auto node_count = span.count + (has_next ? 1 : 0);
+		const auto leaf_start = data.index_levels[0].first;
+
+		const auto nodes = lstate.arena.AllocateAligned(node_count * FGB_NODE_SIZE);
+		lstate.handle->Read(nodes, node_count * FGB_NODE_SIZE,
+		                    data.index_offset + (leaf_start + span.start) * FGB_NODE_SIZE);
+
+		const auto features_size = data.file_size - data.features_offset;
+		const auto get_feature_offset = [&](idx_t leaf_idx) {
+			const auto offset = Load<uint64_t>(nodes + leaf_idx * FGB_NODE_SIZE + FGB_NODE_OFFSET);
+			if (offset > features_size) {
+				throw InvalidInputException("Invalid index in FlatGeobuf file '%s'", data.file_name);
+			}
+			return static_cast<idx_t>(offset);
+		};
+		const auto matches = [&](idx_t leaf_idx) {
+			return !data.has_spatial_filter ||
+			       GetNodeBounds(nodes + leaf_idx * FGB_NODE_SIZE).intersects(data.spatial_filter);
+		};
+
+		idx_t leaf_idx = 0;
+		while (leaf_idx < span.count) {
+			if (!matches(leaf_idx)) {
+				leaf_idx++;
+				continue;
+			}
+			const auto run_start = leaf_idx;
+			for (leaf_idx++; leaf_idx < span.count && matches(leaf_idx); leaf_idx++) {
+			}
+
+			const auto begin = get_feature_offset(run_start);
+			const auto end = leaf_idx < node_count ? get_feature_offset(leaf_idx) : features_size;
+			if (end < begin) {
+				throw InvalidInputException("Invalid index in FlatGeobuf file '%s'", data.file_name);
+			}
+			const auto size = end - begin;
+			const auto buffer = lstate.arena.AllocateAligned(size);
+			lstate.handle->Read(buffer, size, data.features_offset + begin);
+
+			for (auto feature_idx = run_start; feature_idx < leaf_idx; feature_idx++) {
+				const auto offset = get_feature_offset(feature_idx);
+				if (offset < begin || offset > end || end - offset < sizeof(uint32_t)) {
+					throw CorruptError();
+				}
+				const auto pos = offset - begin;
+				const auto feature_size = static_cast<idx_t>(Load<uint32_t>(buffer + pos));
+				if (size - pos - sizeof(uint32_t) < feature_size) {
+					throw CorruptError();
+				}
+				ConvertFeature(data, lstate, buffer + pos + sizeof(uint32_t), feature_size, false, output,
+				               output_idx++);
+			}
+		}
+	}
+
+	static idx_t ExecuteIndexed(const FGBBindData &data, FGBGlobalState &gstate, FGBLocalState &lstate,
+	                            DataChunk &output) {
+		// Batches can be empty if none of their features intersect the spatial filter, so keep going until we find
+		// one that is not
+		idx_t output_idx = 0;
+		while (output_idx == 0) {
+			idx_t batch_idx;
+			if (!gstate.GetNextBatch(batch_idx)) {
+				break;
+			}
+			lstate.batch_index = batch_idx;
+			lstate.arena.Reset();
+
+			for (auto span_idx = gstate.batch_starts[batch_idx]; span_idx < gstate.batch_starts[batch_idx + 1];
+			     span_idx++) {
+				ReadSpan(data, lstate, gstate.spans[span_idx], output, output_idx);
+			}
+		}
+		return output_idx;
+	}
+
+	static idx_t ExecuteStream(const FGBBindData &data, FGBGlobalState &gstate, FGBLocalState &lstate,
+	                           DataChunk &output) {
+		lock_guard<mutex> guard(gstate.stream_lock);
+		lstate.batch_index = gstate.stream_batch++;
+		lstate.arena.Reset();
+
+		idx_t output_idx = 0;
+		while (output_idx < STANDARD_VECTOR_SIZE && gstate.stream_offset < data.file_size) {
+			// Read a window of features, and convert all features that are completely inside it
+			auto window_size = MinValue(FGB_STREAM_BUFFER_SIZE, data.file_size - gstate.stream_offset);
+			auto buffer = lstate.arena.AllocateAligned(window_size);
+			lstate.handle->Read(buffer, window_size, gstate.stream_offset);
+
+			idx_t pos = 0;
+			while (output_idx < STANDARD_VECTOR_SIZE && window_size - pos >= sizeof(uint32_t)) {
+				const auto feature_size = static_cast<idx_t>(Load<uint32_t>(buffer + pos));
+				if (window_size - pos - sizeof(uint32_t) < feature_size) {
+					break;
+				}
+				if (ConvertFeature(data, lstate, buffer + pos + sizeof(uint32_t), feature_size,
+				                   data.has_spatial_filter, output, output_idx)) {
+					output_idx++;
+				}
+				pos += sizeof(uint32_t) + feature_size;
+			}
+
+			if (pos == 0) {
+				// The feature is larger than the window, read it on its own
+				if (window_size < sizeof(uint32_t)) {
+					throw CorruptError();
+				}
+				const auto feature_size = static_cast<idx_t>(Load<uint32_t>(buffer));
+				window_size = sizeof(uint32_t) + feature_size;
+				if (window_size > data.file_size - gstate.stream_offset) {
+					throw CorruptError();
+				}
+				buffer = lstate.arena.AllocateAligned(window_size);
+				lstate.handle->Read(buffer, window_size, gstate.stream_offset);
+				if (ConvertFeature(data, lstate, buffer + sizeof(uint32_t), feature_size, data.has_spatial_filter,
+				                   output, output_idx)) {
+					output_idx++;
+				}
+				pos = window_size;
+			}
+			gstate.stream_offset += pos;
+		}
+		return output_idx;
+	}
+
+	static void Execute(ClientContext &context, TableFunctionInput &input, DataChunk &output) {
+		auto &bind_data = input.bind_data->Cast<FGBBindData>();
+		auto &gstate = input.global_state->Cast<FGBGlobalState>();
+		auto &lstate = input.local_state->Cast<FGBLocalState>();
+
+		const auto count = bind_data.HasIndex() ? ExecuteIndexed(bind_data, gstate, lstate, output)
+		                                        : ExecuteStream(bind_data, gstate, lstate, output);
+		output.SetCardinality(count);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Progress and Cardinality
+	//------------------------------------------------------------------------------------------------------------------
+	static double GetProgress(ClientContext &context, const FunctionData *bind_data_p,
+	                          const GlobalTableFunctionState *global_state) {
+		auto &bind_data = bind_data_p->Cast<FGBBindData>();
+		auto &gstate = global_state->Cast<FGBGlobalState>();
+
+		if (!bind_data.HasIndex()) {
+			const auto size = bind_data.file_size - bind_data.features_offset;
+			if (size == 0) {
+				return 100;
+			}
+			const auto read = MinValue(gstate.stream_offset, bind_data.file_size) - bind_data.features_offset;
+			return 100 * static_cast<double>(read) / static_cast<double>(size);
+		}
+
+		const auto batch_count = gstate.BatchCount();
+		if (batch_count == 0) {
+			return 100;
+		}
+		const auto claimed = MinValue<idx_t>(gstate.next_batch.load(), batch_count);
+		return 100 * static_cast<double>(claimed) / static_cast<double>(batch_count);
+	}
+
+	static OperatorPartitionData GetPartitionData(ClientContext &context, TableFunctionGetPartitionInput &input) {
+		if (input.partition_info.RequiresPartitionColumns()) {
+			throw InternalException("ST_ReadFGB::GetPartitionData: partition columns not supported");
+		}
+		// The batches are claimed in order, so their index preserves the order of the features
+		auto &lstate = input.local_state->Cast<FGBLocalState>();
+		return OperatorPartitionData(lstate.batch_index);
+	}
+
+	static unique_ptr<NodeStatistics> GetCardinality(ClientContext &context, const FunctionData *data) {
+		auto &bind_data = data->Cast<FGBBindData>();
+		auto result = make_uniq<NodeStatistics>();
+
+		if (bind_data.features_count != 0) {
+			result->has_max_cardinality = true;
+			result->max_cardinality = bind_data.features_count;
+			if (!bind_data.has_spatial_filter) {
+				result->has_estimated_cardinality = true;
+				result->estimated_cardinality = bind_data.features_count;
+			}
+		}
+		return result;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		TableFunction read_func("ST_ReadFGB", {LogicalType::VARCHAR}, Execute, Bind, InitGlobal, InitLocal);
+
+		read_func.named_parameters["spatial_filter_box"] = GeoTypes::BOX_2D();
+		read_func.table_scan_progress = GetProgress;
+		read_func.get_partition_data = GetPartitionData;
+		read_func.cardinality = GetCardinality;
+		read_func.pushdown_complex_filter = PushdownComplexFilter;
+		read_func.projection_pushdown = true;
+		ExtensionUtil::RegisterFunction(db, read_func);
+	}
+};
+
+} // namespace
+
+//######################################################################################################################
+// Module Registration
+//######################################################################################################################
+
+void RegisterFlatGeobufModule(DatabaseInstance &db) {
+	ST_ReadFGB::Register(db);
+}
+
+} // namespace duckdb
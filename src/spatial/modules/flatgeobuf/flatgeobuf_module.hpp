@@ -0,0 +1,9 @@
+#pragma once
+
+namespace duckdb {
+
+class DatabaseInstance;
+
+void RegisterFlatGeobufModule(DatabaseInstance &db);
+
+} // namespace duckdb
@@ -1,4 +1,5 @@
 #include "spatial/modules/gdal/gdal_module.hpp"
+#include "spatial/modules/proj/proj_module.hpp"
 
 // Spatial
 #include "spatial/spatial_types.hpp"
@@ -10,15 +11,28 @@
 // DuckDB
 #include "duckdb/main/database.hpp"
 #include "duckdb/common/enums/file_glob_options.hpp"
+#include "duckdb/common/hive_partitioning.hpp"
+#include "duckdb/common/list.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/common/multi_file/multi_file_reader.hpp"
 #include "duckdb/function/table/arrow.hpp"
 #include "duckdb/main/extension_util.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
 #include "duckdb/common/types/uuid.hpp"
+#include "duckdb/common/thread.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
 #include "duckdb/function/copy_function.hpp"
 #include "duckdb/parser/tableref/table_function_ref.hpp"
 #include "duckdb/parser/parsed_expression.hpp"
 #include "duckdb/parser/expression/function_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/expression_iterator.hpp"
+#include "duckdb/execution/expression_executor.hpp"
 
 // GDAL
 #include "cpl_string.h"
@@ -130,9 +144,318 @@ public:
 		return 0;
 	}
 
-	// int ReadMultiRange(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes) override;
-	// void AdviseRead(int nRanges, const vsi_l_offset *panOffsets, const size_t *panSizes) override;
-	// VSIRangeStatus GetRangeStatus(vsi_l_offset nOffset, vsi_l_offset nLength) override;
+};
+
+//--------------------------------------------------------------------------
+// Remote file handle
+//--------------------------------------------------------------------------
+// Remote files are read through positional reads on the DuckDB file handle, where every read is a round trip. To
+// avoid issuing a request for each of the many small reads GDAL drivers do, reads go through a small cache of
+// fixed-size blocks with read-ahead for sequential access, and the multi-range reads and read hints of GDAL are
+// coalesced into as few requests as possible, which are then issued in parallel.
+
+//! The size of a cached block
+constexpr idx_t CACHE_BLOCK_SIZE = 64 * 1024;
+//! The max number of cached blocks, per handle
+constexpr idx_t MAX_CACHED_BLOCKS = 64;
+//! The max number of blocks to read ahead when reading sequentially
+constexpr idx_t MAX_READ_AHEAD_BLOCKS = 16;
+//! Ranges that are at most this far apart are read with a single request
+constexpr idx_t MAX_COALESCE_GAP = 64 * 1024;
+//! The max number of requests to issue at the same time
+constexpr idx_t MAX_PARALLEL_REQUESTS = 8;
+
+class DuckDBRemoteFileHandle final : public VSIVirtualHandle {
+private:
+	struct CachedBlock {
+		idx_t block_idx;
+		idx_t last_used;
+		unique_ptr<data_t[]> data;
+	};
+
+	struct ReadSpan {
+		idx_t offset;
+		idx_t size;
+		data_ptr_t buffer;
+	};
+
+	unique_ptr<FileHandle> file_handle;
+	idx_t file_size;
+	idx_t position = 0;
+	bool is_eof = false;
+
+	vector<CachedBlock> blocks;
+	idx_t access_counter = 0;
+
+	//! The block of the last cache miss and the current read-ahead, which grows while the misses are sequential
+	idx_t last_miss_block = DConstants::INVALID_INDEX;
+	idx_t read_ahead_blocks = 1;
+
+public:
+	explicit DuckDBRemoteFileHandle(unique_ptr<FileHandle> file_handle_p)
+	    : file_handle(std::move(file_handle_p)), file_size(file_handle->GetFileSize()) {
+	}
+
+	vsi_l_offset Tell() override {
+		return static_cast<vsi_l_offset>(position);
+	}
+
+	int Seek(vsi_l_offset nOffset, int nWhence) override {
+		is_eof = false;
+		switch (nWhence) {
+		case SEEK_SET:
+			position = nOffset;
+			break;
+		case SEEK_CUR:
+			position += nOffset;
+			break;
+		case SEEK_END:
+			position = file_size + nOffset;
+			break;
+		default:
+			throw InternalException("Unknown seek type");
+		}
+		return 0;
+	}
+
+	size_t Read(void *pBuffer, size_t nSize, size_t nCount) override {
+		if (nSize == 0 || nCount == 0) {
+			return 0;
+		}
+		const auto requested = static_cast<idx_t>(nSize * nCount);
+		const auto available = position < file_size ? file_size - position : 0;
+		const auto read_size = MinValue(requested, available);
+
+		try {
+			ReadCached(static_cast<data_ptr_t>(pBuffer), position, read_size);
+		} catch (...) {
+			return 0;
+		}
+		position += read_size;
+
+		if (read_size < requested) {
+			is_eof = true;
+		}
+		return read_size / nSize;
+	}
+
+	int ReadMultiRange(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes) override {
+		vector<ReadSpan> ranges;
+		for (int i = 0; i < nRanges; i++) {
+			if (panOffsets[i] + panSizes[i] > file_size) {
+				return -1;
+			}
+			ranges.push_back({panOffsets[i], panSizes[i], static_cast<data_ptr_t>(ppData[i])});
+		}
+		std::sort(ranges.begin(), ranges.end(),
+		          [](const ReadSpan &a, const ReadSpan &b) { return a.offset < b.offset; });
+
+		// Coalesce ranges that are close to each other into spans, and read each span into a temporary buffer
+		vector<ReadSpan> spans;
+		for (auto &range : ranges) {
+			if (!spans.empty() && range.offset <= spans.back().offset + spans.back().size + MAX_COALESCE_GAP) {
+				auto &span = spans.back();
+				span.size = MaxValue(span.size, range.offset + range.size - span.offset);
+			} else {
+				spans.push_back({range.offset, range.size, nullptr});
+			}
+		}
+
+		vector<unique_ptr<data_t[]>> span_buffers;
+		for (auto &span : spans) {
+			span_buffers.emplace_back(new data_t[span.size]);
+			span.buffer = span_buffers.back().get();
+		}
+
+		try {
+			ReadSpans(spans);
+		} catch (...) {
+			return -1;
+		}
+
+		// Copy the ranges out of the spans
+		idx_t span_idx = 0;
+		for (auto &range : ranges) {
+			while (range.offset + range.size > spans[span_idx].offset + spans[span_idx].size) {
+				span_idx++;
+			}
+			auto &span = spans[span_idx];
+			memcpy(range.buffer, span.buffer + (range.offset - span.offset), range.size);
+		}
+		return 0;
+	}
+
+	void AdviseRead(int nRanges, const vsi_l_offset *panOffsets, const size_t *panSizes) override {
+		// Find the blocks that are not cached yet, as many as fit into half of the cache
+		vector<idx_t> missing;
+		for (int i = 0; i < nRanges && missing.size() < MAX_CACHED_BLOCKS / 2; i++) {
+			if (panSizes[i] == 0 || panOffsets[i] >= file_size) {
+				continue;
+			}
+			const auto first_block = panOffsets[i] / CACHE_BLOCK_SIZE;
+			const auto last_block = (MinValue<idx_t>(panOffsets[i] + panSizes[i], file_size) - 1) / CACHE_BLOCK_SIZE;
+			for (auto block_idx = first_block; block_idx <= last_block; block_idx++) {
+				if (!FindBlock(block_idx) && missing.size() < MAX_CACHED_BLOCKS / 2) {
+					missing.push_back(block_idx);
+				}
+			}
+		}
+		std::sort(missing.begin(), missing.end());
+		missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+		// Read consecutive runs of blocks with a single request
+		vector<pair<idx_t, idx_t>> runs;
+		for (auto block_idx : missing) {
+			if (!runs.empty() && runs.back().first + runs.back().second == block_idx) {
+				runs.back().second++;
+			} else {
+				runs.emplace_back(block_idx, 1);
+			}
+		}
+
+		try {
+			FetchBlocks(runs);
+		} catch (...) {
+			// This is just a hint, the reads will be retried when the data is actually requested
+		}
+	}
+
+	int Eof() override {
+		return is_eof ? TRUE : FALSE;
+	}
+
+	size_t Write(const void *pBuffer, size_t nSize, size_t nCount) override {
+		return 0;
+	}
+
+	int Close() override {
+		file_handle->Close();
+		return 0;
+	}
+
+private:
+	CachedBlock *FindBlock(idx_t block_idx) {
+		for (auto &block : blocks) {
+			if (block.block_idx == block_idx) {
+				block.last_used = ++access_counter;
+				return &block;
+			}
+		}
+		return nullptr;
+	}
+
+	void AddBlock(idx_t block_idx, unique_ptr<data_t[]> data) {
+		if (blocks.size() < MAX_CACHED_BLOCKS) {
+			blocks.push_back({block_idx, ++access_counter, std::move(data)});
+			return;
+		}
+		// Evict the least recently used block
+		auto &victim = *std::min_element(blocks.begin(), blocks.end(), [](const CachedBlock &a, const CachedBlock &b) {
+			return a.last_used < b.last_used;
+		});
+		victim.block_idx = block_idx;
+		victim.last_used = ++access_counter;
+		victim.data = std::move(data);
+	}
+
+	idx_t GetBlockSize(idx_t block_idx) const {
+		return MinValue(CACHE_BLOCK_SIZE, file_size - block_idx * CACHE_BLOCK_SIZE);
+	}
+
+	void ReadCached(data_ptr_t buffer, idx_t offset, idx_t size) {
+		while (size > 0) {
+			const auto block_idx = offset / CACHE_BLOCK_SIZE;
+			auto block = FindBlock(block_idx);
+			if (!block) {
+				// Grow the read-ahead while the misses are sequential
+				if (last_miss_block != DConstants::INVALID_INDEX && block_idx == last_miss_block + 1) {
+					read_ahead_blocks = MinValue(read_ahead_blocks * 2, MAX_READ_AHEAD_BLOCKS);
+				} else {
+					read_ahead_blocks = 1;
+				}
+
+				// Read at least the blocks needed for this read, but stop at the first cached one
+				const auto needed_blocks = (offset + size - 1) / CACHE_BLOCK_SIZE - block_idx + 1;
+				const auto total_blocks = (file_size + CACHE_BLOCK_SIZE - 1) / CACHE_BLOCK_SIZE;
+				auto run_size = MinValue(MaxValue(needed_blocks, read_ahead_blocks), MAX_CACHED_BLOCKS / 2);
+				run_size = MinValue(run_size, total_blocks - block_idx);
+				idx_t run_end = block_idx + 1;
+				while (run_end < block_idx + run_size && !FindBlock(run_end)) {
+					run_end++;
+				}
+				FetchBlocks({{block_idx, run_end - block_idx}});
+				last_miss_block = run_end - 1;
+
+				block = FindBlock(block_idx);
+				D_ASSERT(block);
+			}
+
+			const auto block_offset = offset - block_idx * CACHE_BLOCK_SIZE;
+			const auto copy_size = MinValue(size, GetBlockSize(block_idx) - block_offset);
+			memcpy(buffer, block->data.get() + block_offset, copy_size);
+
+			buffer += copy_size;
+			offset += copy_size;
+			size -= copy_size;
+		}
+	}
+
+	//! Read runs of (first block, block count) into the cache
+	void FetchBlocks(const vector<pair<idx_t, idx_t>> &runs) {
+		vector<ReadSpan> spans;
+		vector<unique_ptr<data_t[]>> span_buffers;
+		for (auto &run : runs) {
+			const auto offset = run.first * CACHE_BLOCK_SIZE;
+			const auto size = MinValue(run.second * CACHE_BLOCK_SIZE, file_size - offset);
+			span_buffers.emplace_back(new data_t[size]);
+			spans.push_back({offset, size, span_buffers.back().get()});
+		}
+
+		ReadSpans(spans);
+
+		for (idx_t run_idx = 0; run_idx < runs.size(); run_idx++) {
+			for (idx_t i = 0; i < runs[run_idx].second; i++) {
+				const auto block_idx = runs[run_idx].first + i;
+				const auto block_size = GetBlockSize(block_idx);
+				unique_ptr<data_t[]> data(new data_t[block_size]);
+				memcpy(data.get(), spans[run_idx].buffer + i * CACHE_BLOCK_SIZE, block_size);
+				AddBlock(block_idx, std::move(data));
+			}
+		}
+	}
+
+	//! Read all spans, issuing the requests for multiple spans in parallel
+	void ReadSpans(const vector<ReadSpan> &spans) {
+		if (spans.size() == 1) {
+			file_handle->Read(spans[0].buffer, spans[0].size, spans[0].offset);
+			return;
+		}
+
+		for (idx_t batch_start = 0; batch_start < spans.size(); batch_start += MAX_PARALLEL_REQUESTS) {
+			const auto batch_end = MinValue<idx_t>(batch_start + MAX_PARALLEL_REQUESTS, spans.size());
+
+			vector<std::exception_ptr> errors(batch_end - batch_start);
+			vector<thread> threads;
+			for (idx_t span_idx = batch_start; span_idx < batch_end; span_idx++) {
+				threads.emplace_back([&, span_idx]() {
+					try {
+						auto &span = spans[span_idx];
+						file_handle->Read(span.buffer, span.size, span.offset);
+					} catch (...) {
+						errors[span_idx - batch_start] = std::current_exception();
+					}
+				});
+			}
+			for (auto &t : threads) {
+				t.join();
+			}
+			for (auto &error : errors) {
+				if (error) {
+					std::rethrow_exception(error);
+				}
+			}
+		}
+	}
 };
 
 //--------------------------------------------------------------------------
@@ -218,10 +541,13 @@ public:
 			// If the file is remote and NOT in write mode, we can cache it.
 			if (FileSystem::IsRemoteFile(file_name_str) && !flags.OpenForWriting() && !flags.OpenForAppending()) {
 
-				// Pass the direct IO flag to the file system since we use GDAL's caching instead
+				// Pass the direct IO flag to the file system since we do our own caching instead
 				flags |= FileFlags::FILE_FLAGS_DIRECT_IO;
 
 				auto file = fs.OpenFile(file_name, flags | FileCompressionType::AUTO_DETECT);
+				if (file->CanSeek() && !file->IsPipe()) {
+					return new DuckDBRemoteFileHandle(std::move(file));
+				}
 				return VSICreateCachedFile(new DuckDBFileHandle(std::move(file)));
 			} else {
 				auto file = fs.OpenFile(file_name, flags | FileCompressionType::AUTO_DETECT);
@@ -381,8 +707,9 @@ public:
 		return files.StealList();
 	}
 
-	int HasOptimizedReadMultiRange(const char *pszPath) override {
-		return 0;
+	int HasOptimizedReadMultiRange(const char *prefixed_file_name) override {
+		// Remote files coalesce the ranges and read them in parallel
+		return FileSystem::IsRemoteFile(StripPrefix(prefixed_file_name)) ? TRUE : FALSE;
 	}
 
 	int Unlink(const char *prefixed_file_name) override {
@@ -397,6 +724,267 @@ public:
 	}
 };
 
+//######################################################################################################################
+// Dataset Cache
+//######################################################################################################################
+// Opening a dataset is often the most expensive part of a query over a small (or remote) file, as GDAL has to probe the
+// drivers and read the headers and metadata. So when a read-only dataset is no longer used, it is kept open in a cache
+// of the client, together with the schemas of the layers that were read from it, so that the next read of the same
+// file (with the same open options) can use it right away.
+//
+// The cached datasets are validated against the size and last modification time of the file, which are looked up
+// once when a query is bound. A dataset is only used by one scan at a time: it is taken out of the cache while it is
+// used and put back (with its layers reset) afterwards, so a file may have several idle datasets in the cache.
+
+//! The schema of the arrow stream of a layer
+struct LayerSchema {
+	//! The column names, renamed if they are empty or duplicates
+	vector<string> names;
+	//! The field names as reported by GDAL, before they are renamed
+	vector<string> field_names;
+	vector<LogicalType> types;
+	ArrowTableType arrow_table;
+	unordered_set<idx_t> geometry_column_ids;
+};
+
+//! Identifies the version of a file, to find out if the cached datasets and schemas of the file are stale
+struct GDALFileStamp {
+	int64_t last_modified = 0;
+	idx_t size = 0;
+
+	bool operator==(const GDALFileStamp &other) const {
+		return last_modified == other.last_modified && size == other.size;
+	}
+	bool operator!=(const GDALFileStamp &other) const {
+		return !(*this == other);
+	}
+
+	//! Get the stamp of a file, returns false if the path is not a (regular) file, e.g. a directory, a GDAL
+	//! connection string or a path with a VSI prefix, in which case its datasets are not cached
+	static bool TryGet(ClientContext &context, const string &file_name, GDALFileStamp &result) {
+		if (StringUtil::StartsWith(file_name, "/vsi")) {
+			return false;
+		}
+		auto &fs = FileSystem::GetFileSystem(context);
+		unique_ptr<FileHandle> file;
+		try {
+			file = fs.OpenFile(file_name, FileFlags::FILE_FLAGS_READ | FileFlags::FILE_FLAGS_NULL_IF_NOT_EXISTS);
+			if (!file || file->GetType() != FileType::FILE_TYPE_REGULAR) {
+				return false;
+			}
+			result.last_modified = static_cast<int64_t>(fs.GetLastModifiedTime(*file));
+			result.size = fs.GetFileSize(*file);
+		} catch (std::exception &ex) {
+			return false;
+		}
+		return true;
+	}
+};
+
+class GDALDatasetCache {
+public:
+	static constexpr auto SETTING_NAME = "gdal_dataset_cache_size";
+	static constexpr idx_t DEFAULT_CAPACITY = 8;
+
+	void SetCapacity(idx_t capacity_p) {
+		lock_guard<mutex> guard(lock);
+		capacity = capacity_p;
+		while (datasets.size() > capacity) {
+			datasets.pop_back();
+		}
+		while (schemas.size() > capacity) {
+			EvictSchema();
+		}
+	}
+
+	idx_t GetCapacity() {
+		lock_guard<mutex> guard(lock);
+		return capacity;
+	}
+
+	//! Take an idle dataset of the file out of the cache, returns nullptr if there is none
+	GDALDatasetUniquePtr Acquire(const string &key, const GDALFileStamp &stamp) {
+		lock_guard<mutex> guard(lock);
+		GDALDatasetUniquePtr result;
+		for (auto it = datasets.begin(); it != datasets.end();) {
+			if (it->key != key) {
+				++it;
+				continue;
+			}
+			if (it->stamp != stamp) {
+				// The file has changed since the dataset was opened
+				it = datasets.erase(it);
+				continue;
+			}
+			if (!result) {
+				result = std::move(it->dataset);
+				it = datasets.erase(it);
+				continue;
+			}
+			++it;
+		}
+		return result;
+	}
+
+	//! Put a dataset that is no longer used back into the cache, evicting the least recently used one if it is full
+	void Release(const string &key, const GDALFileStamp &stamp, GDALDatasetUniquePtr dataset) {
+		// Drop the filters and the read positions of the last scan
+		for (int layer_idx = 0; layer_idx < dataset->GetLayerCount(); layer_idx++) {
+			const auto layer = dataset->GetLayer(layer_idx);
+			layer->SetSpatialFilter(nullptr);
+			layer->SetAttributeFilter(nullptr);
+			layer->ResetReading();
+		}
+
+		lock_guard<mutex> guard(lock);
+		if (closed || capacity == 0) {
+			return;
+		}
+		datasets.push_front(DatasetEntry {key, stamp, std::move(dataset)});
+		if (datasets.size() > capacity) {
+			datasets.pop_back();
+		}
+	}
+
+	//! Get the cached schema of a layer, returns false if it has not been read from this version of the file yet
+	bool TryGetSchema(const string &key, const GDALFileStamp &stamp, LayerSchema &result) {
+		lock_guard<mutex> guard(lock);
+		const auto entry = schemas.find(key);
+		if (entry == schemas.end()) {
+			return false;
+		}
+		if (entry->second.stamp != stamp) {
+			schemas.erase(entry);
+			return false;
+		}
+		entry->second.last_used = ++clock;
+		result = entry->second.schema;
+		return true;
+	}
+
+	void AddSchema(const string &key, const GDALFileStamp &stamp, const LayerSchema &schema) {
+		lock_guard<mutex> guard(lock);
+		if (closed || capacity == 0) {
+			return;
+		}
+		if (schemas.find(key) == schemas.end() && schemas.size() >= capacity) {
+			EvictSchema();
+		}
+		auto &entry = schemas[key];
+		entry.stamp = stamp;
+		entry.schema = schema;
+		entry.last_used = ++clock;
+	}
+
+	//! Close all cached datasets
+	void Clear() {
+		lock_guard<mutex> guard(lock);
+		datasets.clear();
+		schemas.clear();
+	}
+
+	//! Close all cached datasets, and stop caching new ones
+	void Close() {
+		lock_guard<mutex> guard(lock);
+		closed = true;
+		datasets.clear();
+		schemas.clear();
+	}
+
+private:
+	//! Evict the least recently used schema, the lock must be held
+	void EvictSchema() {
+		auto lru_entry = schemas.end();
+		for (auto it = schemas.begin(); it != schemas.end(); ++it) {
+			if (lru_entry == schemas.end() || it->second.last_used < lru_entry->second.last_used) {
+				lru_entry = it;
+			}
+		}
+		if (lru_entry != schemas.end()) {
+			schemas.erase(lru_entry);
+		}
+	}
+
+	struct DatasetEntry {
+		string key;
+		GDALFileStamp stamp;
+		GDALDatasetUniquePtr dataset;
+	};
+
+	struct SchemaEntry {
+		GDALFileStamp stamp;
+		LayerSchema schema;
+		idx_t last_used = 0;
+	};
+
+	mutex lock;
+	//! The idle datasets, the most recently used first
+	list<DatasetEntry> datasets;
+	unordered_map<string, SchemaEntry> schemas;
+
+	idx_t capacity = DEFAULT_CAPACITY;
+	idx_t clock = 0;
+	bool closed = false;
+};
+
+//! A dataset that is used by a scan, and put back into the cache it was taken from (if any) when the scan is done
+class GDALCachedDataset {
+public:
+	GDALCachedDataset() = default;
+
+	explicit GDALCachedDataset(GDALDatasetUniquePtr dataset_p) : dataset(std::move(dataset_p)) {
+	}
+
+	GDALCachedDataset(shared_ptr<GDALDatasetCache> cache_p, string key_p, const GDALFileStamp &stamp_p,
+	                  GDALDatasetUniquePtr dataset_p)
+	    : cache(std::move(cache_p)), key(std::move(key_p)), stamp(stamp_p), dataset(std::move(dataset_p)) {
+	}
+
+	GDALCachedDataset(GDALCachedDataset &&other) noexcept = default;
+
+	GDALCachedDataset &operator=(GDALCachedDataset &&other) noexcept {
+		if (this != &other) {
+			Reset();
+			cache = std::move(other.cache);
+			key = std::move(other.key);
+			stamp = other.stamp;
+			dataset = std::move(other.dataset);
+		}
+		return *this;
+	}
+
+	~GDALCachedDataset() {
+		Reset();
+	}
+
+	void Reset() {
+		if (cache && dataset) {
+			cache->Release(key, stamp, std::move(dataset));
+		}
+		cache = nullptr;
+		dataset = nullptr;
+	}
+
+	GDALDataset *get() const {
+		return dataset.get();
+	}
+	GDALDataset *operator->() const {
+		return dataset.get();
+	}
+	GDALDataset &operator*() const {
+		return *dataset;
+	}
+	explicit operator bool() const {
+		return dataset != nullptr;
+	}
+
+private:
+	shared_ptr<GDALDatasetCache> cache;
+	string key;
+	GDALFileStamp stamp;
+	GDALDatasetUniquePtr dataset;
+};
+
 //######################################################################################################################
 // Context State
 //######################################################################################################################
@@ -407,12 +995,16 @@ class GDALClientContextState final : public ClientContextState {
 	ClientContext &context;
 	string client_prefix;
 	DuckDBFileSystemHandler *fs_handler;
+	//! The datasets opened through the file handler of this client, which are kept open between queries
+	shared_ptr<GDALDatasetCache> dataset_cache;
 
 public:
 	explicit GDALClientContextState(ClientContext &context);
 	~GDALClientContextState() override;
 	void QueryEnd() override;
 	string GetPrefix(const string &value) const;
+	//! Get the dataset cache of this client, with the capacity of the current setting
+	shared_ptr<GDALDatasetCache> GetDatasetCache() const;
 	static GDALClientContextState &GetOrCreate(ClientContext &context);
 };
 
@@ -428,9 +1020,15 @@ GDALClientContextState::GDALClientContextState(ClientContext &context) : context
 	VSIFileManager::InstallHandler(client_prefix, fs_handler);
 
 	// Also pass a reference to the client context
+
+	// Keep the datasets of this client open between queries
+	dataset_cache = make_shared_ptr<GDALDatasetCache>();
 }
 
 GDALClientContextState::~GDALClientContextState() {
+	// The cached datasets read through the file handler, so close them first
+	dataset_cache->Close();
+
 	// Uninstall the file handler for this prefix
 	VSIFileManager::RemoveHandler(client_prefix);
 
@@ -452,30 +1050,95 @@ string GDALClientContextState::GetPrefix(const string &value) const {
 	return client_prefix + value;
 }
 
+shared_ptr<GDALDatasetCache> GDALClientContextState::GetDatasetCache() const {
+	Value capacity_value;
+	if (context.TryGetCurrentSetting(GDALDatasetCache::SETTING_NAME, capacity_value)) {
+		dataset_cache->SetCapacity(capacity_value.GetValue<idx_t>());
+	}
+	return dataset_cache;
+}
+
 GDALClientContextState &GDALClientContextState::GetOrCreate(ClientContext &context) {
 	auto gdal_state = context.registered_state->GetOrCreate<GDALClientContextState>("gdal", context);
 	return *gdal_state;
 }
 
 //######################################################################################################################
-// Functions
+// Initialization
 //######################################################################################################################
+// Registering the GDAL drivers takes a while, so it is deferred until a GDAL function is first bound, instead of
+// slowing down every LOAD of the extension. GDAL uses PROJ, so the PROJ database has to be set up first.
 
-//======================================================================================================================
-// ST_Read
-//======================================================================================================================
-
-struct ST_Read : ArrowTableFunction {
+void InitializeGDAL() {
+	InitializeProjModule();
 
-	//------------------------------------------------------------------------------------------------------------------
-	// Misc
-	//------------------------------------------------------------------------------------------------------------------
-	enum class SpatialFilterType { Wkb, Rectangle };
+	static std::once_flag loaded;
+	std::call_once(loaded, []() {
+		// Register all embedded drivers (dont go looking for plugins)
+		OGRRegisterAllInternal();
 
-	struct SpatialFilter {
-		SpatialFilterType type;
-		explicit SpatialFilter(SpatialFilterType type_p) : type(type_p) {};
-	};
+		// Set GDAL error handler
+		CPLSetErrorHandler([](CPLErr e, int code, const char *raw_msg) {
+			// DuckDB doesnt do warnings, so we only throw on errors
+			if (e != CE_Failure && e != CE_Fatal) {
+				return;
+			}
+
+			// If the error contains a /vsiduckdb-<uuid>/ prefix,
+			// try to strip it off to make the errors more readable
+			auto msg = string(raw_msg);
+			auto path_pos = msg.find("/vsiduckdb-");
+			if (path_pos != string::npos) {
+				// We found a path, strip it off
+				msg.erase(path_pos, 48);
+			}
+
+			switch (code) {
+			case CPLE_NoWriteAccess:
+				throw PermissionException("GDAL Error (%d): %s", code, msg);
+			case CPLE_UserInterrupt:
+				throw InterruptException();
+			case CPLE_OutOfMemory:
+				throw OutOfMemoryException("GDAL Error (%d): %s", code, msg);
+			case CPLE_NotSupported:
+				throw NotImplementedException("GDAL Error (%d): %s", code, msg);
+			case CPLE_AssertionFailed:
+			case CPLE_ObjectNull:
+				throw InternalException("GDAL Error (%d): %s", code, msg);
+			case CPLE_IllegalArg:
+				throw InvalidInputException("GDAL Error (%d): %s", code, msg);
+			case CPLE_AppDefined:
+			case CPLE_HttpResponse:
+			case CPLE_FileIO:
+			case CPLE_OpenFailed:
+			default:
+				throw IOException("GDAL Error (%d): %s", code, msg);
+			}
+		});
+	});
+}
+
+//######################################################################################################################
+// Functions
+//######################################################################################################################
+
+//======================================================================================================================
+// ST_Read
+//======================================================================================================================
+
+struct ST_Read : ArrowTableFunction {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Misc
+	//------------------------------------------------------------------------------------------------------------------
+	enum class SpatialFilterType { Wkb, Rectangle };
+
+	struct SpatialFilter {
+		SpatialFilterType type;
+		//! The index of the OGR geometry field to filter on
+		int geom_field = 0;
+		explicit SpatialFilter(SpatialFilterType type_p) : type(type_p) {};
+	};
 
 	struct RectangleSpatialFilter : SpatialFilter {
 		double min_x, min_y, max_x, max_y;
@@ -502,17 +1165,30 @@ struct ST_Read : ArrowTableFunction {
 		if (spatial_filter != nullptr) {
 			if (spatial_filter->type == SpatialFilterType::Rectangle) {
 				auto &rect = static_cast<RectangleSpatialFilter &>(*spatial_filter);
-				layer->SetSpatialFilterRect(rect.min_x, rect.min_y, rect.max_x, rect.max_y);
+				layer->SetSpatialFilterRect(rect.geom_field, rect.min_x, rect.min_y, rect.max_x, rect.max_y);
 			} else if (spatial_filter->type == SpatialFilterType::Wkb) {
 				auto &filter = static_cast<WKBSpatialFilter &>(*spatial_filter);
-				layer->SetSpatialFilter(OGRGeometry::FromHandle(filter.geom));
+				layer->SetSpatialFilter(filter.geom_field, OGRGeometry::FromHandle(filter.geom));
 			}
 		}
 	}
 
+	static void TryApplyAttributeFilter(OGRLayer *layer, const string &attribute_filter) {
+		if (!attribute_filter.empty() && layer->SetAttributeFilter(attribute_filter.c_str()) != OGRERR_NONE) {
+			throw IOException("Could not set attribute filter '%s' on layer", attribute_filter);
+		}
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// Bind
 	//------------------------------------------------------------------------------------------------------------------
+	struct DatasetFile {
+		string raw_name;
+		string prefixed_name;
+		//! The values of the hive partition columns, from the path of the file
+		vector<Value> partition_values;
+	};
+
 	struct BindData final : TableFunctionData {
 
 		int layer_idx = 0;
@@ -520,6 +1196,8 @@ struct ST_Read : ArrowTableFunction {
 		bool keep_wkb = false;
 		unordered_set<idx_t> geometry_column_ids = {};
 		unique_ptr<SpatialFilter> spatial_filter = nullptr;
+		//! OGR SQL attribute filter on the layer, pushed down from the query filters
+		string attribute_filter;
 
 		// before they are renamed
 		vector<string> all_names = {};
@@ -534,10 +1212,264 @@ struct ST_Read : ArrowTableFunction {
 		CPLStringList dataset_allowed_drivers;
 		CPLStringList dataset_sibling_files;
 		CPLStringList layer_creation_options;
+
+		//! A single file is read through the dataset cache of the client, unless the key is empty
+		string dataset_cache_key;
+		//! The version of the file when it was bound, the cached datasets of other versions are not used
+		GDALFileStamp file_stamp;
+
+		//! When reading multiple files (from a list or a glob), each thread reads whole files through its own dataset
+		//! handle, and the columns of each file are matched with the bound columns by name
+		bool multi_file = false;
+		bool union_by_name = false;
+		vector<DatasetFile> files;
+		//! The layer to read from each file, if selected by name
+		string layer_name;
+		//! The (renamed) names of the columns read from the files
+		vector<string> column_names;
+		//! The filename and hive partition columns come after the columns of the files
+		idx_t filename_column_idx = DConstants::INVALID_INDEX;
+		idx_t partition_column_idx = DConstants::INVALID_INDEX;
+		vector<string> partition_names;
+
+		//! Whether the column is read from the layer of each file
+		bool IsLayerColumn(idx_t column_idx) const {
+			return column_idx < column_names.size();
+		}
+
+		//! Whether the column is the filename or a hive partition column, which has a single value per file
+		bool IsFilenameOrPartitionColumn(idx_t column_idx) const {
+			return !IsLayerColumn(column_idx) && column_idx < all_types.size();
+		}
+
+		//! Get the value of the filename or a hive partition column for a file
+		Value GetFileColumnValue(const DatasetFile &file, idx_t column_idx) const {
+			if (column_idx == filename_column_idx) {
+				return Value(file.raw_name);
+			}
+			return file.partition_values[column_idx - partition_column_idx];
+		}
 	};
 
+	static void GetStreamSchema(ClientContext &context, bool keep_wkb, ArrowArrayStream &stream,
+	                            LayerSchema &result) {
+		struct ArrowSchema schema;
+		if (stream.get_schema(&stream, &schema) != 0) {
+			throw IOException("Could not get arrow schema from layer");
+		}
+
+		// The Arrow API will return attributes in this order
+		// 1. FID column
+		// 2. all ogr field attributes
+		// 3. all geometry columns
+
+		auto attribute_count = schema.n_children;
+		auto attributes = schema.children;
+
+		result.field_names.reserve(attribute_count + 1);
+		result.names.reserve(attribute_count + 1);
+
+		for (idx_t col_idx = 0; col_idx < (idx_t)attribute_count; col_idx++) {
+			auto &attribute = *attributes[col_idx];
+
+			const char ogc_flag[] = {'\x01', '\0', '\0', '\0', '\x14', '\0', '\0', '\0', 'A', 'R', 'R', 'O', 'W',
+			                         ':',    'e',  'x',  't',  'e',    'n',  's',  'i',  'o', 'n', ':', 'n', 'a',
+			                         'm',    'e',  '\a', '\0', '\0',   '\0', 'o',  'g',  'c', '.', 'w', 'k', 'b'};
+
+			auto arrow_type = ArrowType::GetArrowLogicalType(DBConfig::GetConfig(context), attribute);
+
+			auto column_name = string(attribute.name);
+			auto duckdb_type = arrow_type->GetDuckType();
+
+			if (duckdb_type.id() == LogicalTypeId::BLOB && attribute.metadata != nullptr &&
+			    strncmp(attribute.metadata, ogc_flag, sizeof(ogc_flag)) == 0) {
+				// This is a WKB geometry blob
+				result.arrow_table.AddColumn(col_idx, std::move(arrow_type));
+
+				if (keep_wkb) {
+					result.types.emplace_back(GeoTypes::WKB_BLOB());
+				} else {
+					result.types.emplace_back(GeoTypes::GEOMETRY());
+					if (column_name == "wkb_geometry") {
+						column_name = "geom";
+					}
+				}
+				result.geometry_column_ids.insert(col_idx);
+
+			} else if (attribute.dictionary) {
+				auto dictionary_type = ArrowType::GetArrowLogicalType(DBConfig::GetConfig(context), attribute);
+				result.types.emplace_back(dictionary_type->GetDuckType());
+				arrow_type->SetDictionary(std::move(dictionary_type));
+				result.arrow_table.AddColumn(col_idx, std::move(arrow_type));
+			} else {
+				result.types.emplace_back(arrow_type->GetDuckType());
+				result.arrow_table.AddColumn(col_idx, std::move(arrow_type));
+			}
+
+			// keep these around for projection/filter pushdown later
+			// does GDAL even allow duplicate/missing names?
+			result.field_names.push_back(column_name);
+
+			if (column_name.empty()) {
+				result.names.push_back("v" + to_string(col_idx));
+			} else {
+				result.names.push_back(column_name);
+			}
+		}
+
+		schema.release(&schema);
+
+		// Rename columns if they are duplicates
+		unordered_map<string, idx_t> name_map;
+		for (auto &column_name : result.names) {
+			// put it all lower_case
+			auto low_column_name = StringUtil::Lower(column_name);
+			if (name_map.find(low_column_name) == name_map.end()) {
+				// Name does not exist yet
+				name_map[low_column_name]++;
+			} else {
+				// Name already exists, we add _x where x is the repetition number
+				string new_column_name = column_name + "_" + std::to_string(name_map[low_column_name]);
+				auto new_column_name_low = StringUtil::Lower(new_column_name);
+				while (name_map.find(new_column_name_low) != name_map.end()) {
+					// This name is already here due to a previous definition
+					name_map[low_column_name]++;
+					new_column_name = column_name + "_" + std::to_string(name_map[low_column_name]);
+					new_column_name_low = StringUtil::Lower(new_column_name);
+				}
+				column_name = new_column_name;
+				name_map[new_column_name_low]++;
+			}
+		}
+	}
+
+	//! Find a column by name (case-insensitive), returns DConstants::INVALID_INDEX if there is none
+	static idx_t FindColumn(const vector<string> &names, const string &name) {
+		for (idx_t col_idx = 0; col_idx < names.size(); col_idx++) {
+			if (StringUtil::CIEquals(names[col_idx], name)) {
+				return col_idx;
+			}
+		}
+		return DConstants::INVALID_INDEX;
+	}
+
+	//! Add the columns of another file to the schema, for union_by_name
+	static void MergeSchema(LayerSchema &result, const LayerSchema &other, const string &file_name) {
+		for (idx_t other_idx = 0; other_idx < other.names.size(); other_idx++) {
+			const auto other_is_geometry = other.geometry_column_ids.count(other_idx) != 0;
+			const auto col_idx = FindColumn(result.names, other.names[other_idx]);
+			if (col_idx == DConstants::INVALID_INDEX) {
+				if (other_is_geometry) {
+					result.geometry_column_ids.insert(result.names.size());
+				}
+				result.names.push_back(other.names[other_idx]);
+				result.field_names.push_back(other.field_names[other_idx]);
+				result.types.push_back(other.types[other_idx]);
+				continue;
+			}
+			const auto is_geometry = result.geometry_column_ids.count(col_idx) != 0;
+			if (is_geometry != other_is_geometry) {
+				throw BinderException("Column \"%s\" of file \"%s\" is %sa geometry column, but not in other files",
+				                      other.names[other_idx], file_name, other_is_geometry ? "" : "not ");
+			}
+			if (!is_geometry && result.types[col_idx] != other.types[other_idx]) {
+				result.types[col_idx] = LogicalType::ForceMaxLogicalType(result.types[col_idx], other.types[other_idx]);
+			}
+		}
+	}
+
+	static GDALDatasetUniquePtr OpenDataset(const BindData &data, const string &raw_file_name,
+	                                        const string &prefixed_file_name) {
+		auto dataset = GDALDatasetUniquePtr(GDALDataset::Open(
+		    prefixed_file_name.c_str(), GDAL_OF_VECTOR | GDAL_OF_VERBOSE_ERROR | GDAL_OF_READONLY,
+		    data.dataset_allowed_drivers, data.dataset_open_options, data.dataset_sibling_files));
+		if (dataset == nullptr) {
+			const auto error = string(CPLGetLastErrorMsg());
+			throw IOException("Could not open file: " + raw_file_name + " (" + error + ")");
+		}
+		return dataset;
+	}
+
+	static GDALDatasetUniquePtr OpenDataset(const BindData &data) {
+		return OpenDataset(data, data.raw_file_name, data.prefixed_file_name);
+	}
+
+	static void AppendCacheKey(string &key, const CPLStringList &list) {
+		for (int i = 0; i < list.Count(); i++) {
+			key += '\n';
+			key += list[i];
+		}
+		key += '\0';
+	}
+
+	//! The datasets of a file can only be shared by scans that open the file with the same options
+	static string GetDatasetCacheKey(const BindData &data) {
+		auto key = data.prefixed_file_name;
+		key += '\0';
+		AppendCacheKey(key, data.dataset_open_options);
+		AppendCacheKey(key, data.dataset_allowed_drivers);
+		AppendCacheKey(key, data.dataset_sibling_files);
+		return key;
+	}
+
+	//! Get a dataset of the (single) file, from the dataset cache of the client if possible
+	static GDALCachedDataset AcquireDataset(ClientContext &context, const BindData &data) {
+		if (data.dataset_cache_key.empty()) {
+			return GDALCachedDataset(OpenDataset(data));
+		}
+		auto cache = GDALClientContextState::GetOrCreate(context).GetDatasetCache();
+		auto dataset = cache->Acquire(data.dataset_cache_key, data.file_stamp);
+		if (!dataset) {
+			dataset = OpenDataset(data);
+		}
+		return GDALCachedDataset(std::move(cache), data.dataset_cache_key, data.file_stamp, std::move(dataset));
+	}
+
+	//! Get the layer to read from a dataset
+	static OGRLayer *OpenLayer(const BindData &data, GDALDataset &dataset) {
+		auto layer_idx = data.layer_idx;
+		if (!data.layer_name.empty()) {
+			// When reading multiple files, the layer is found by name in each of them
+			layer_idx = -1;
+			for (int i = 0; i < dataset.GetLayerCount(); i++) {
+				if (strcmp(dataset.GetLayer(i)->GetName(), data.layer_name.c_str()) == 0) {
+					layer_idx = i;
+					break;
+				}
+			}
+			if (layer_idx < 0) {
+				throw IOException("Layer '%s' could not be found in dataset", data.layer_name);
+			}
+		}
+
+		OGRLayer *layer = nullptr;
+		if (data.sequential_layer_scan) {
+			// Get the layer from the dataset by scanning through the layers
+			for (int i = 0; i < dataset.GetLayerCount(); i++) {
+				layer = dataset.GetLayer(i);
+				if (i == layer_idx) {
+					// desired layer found
+					break;
+				}
+				// else scan through and empty the layer
+				OGRFeature *feature;
+				while ((feature = layer->GetNextFeature()) != nullptr) {
+					OGRFeature::DestroyFeature(feature);
+				}
+			}
+		} else {
+			// Otherwise get the layer directly
+			layer = dataset.GetLayer(layer_idx);
+		}
+		if (!layer) {
+			throw IOException("Could not get layer");
+		}
+		return layer;
+	}
+
 	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
 	                                     vector<LogicalType> &return_types, vector<string> &names) {
+		InitializeGDAL();
 
 		// Result
 		auto result = make_uniq<BindData>();
@@ -566,18 +1498,59 @@ struct ST_Read : ArrowTableFunction {
 			}
 		}
 
-		result->raw_file_name = input.inputs[0].GetValue<string>();
-		result->prefixed_file_name = ctx_state.GetPrefix(result->raw_file_name);
+		bool add_filename = false;
+		bool hive_partitioning = false;
+		for (auto &kv : input.named_parameters) {
+			auto loption = StringUtil::Lower(kv.first);
+			if (loption == "filename") {
+				add_filename = BooleanValue::Get(kv.second);
+			}
+			if (loption == "hive_partitioning") {
+				hive_partitioning = BooleanValue::Get(kv.second);
+			}
+			if (loption == "union_by_name") {
+				result->union_by_name = BooleanValue::Get(kv.second);
+			}
+			if (loption == "sequential_layer_scan") {
+				result->sequential_layer_scan = BooleanValue::Get(kv.second);
+			}
+		}
+
+		// A list of files or a glob is expanded through the DuckDB file system. Other paths are passed to GDAL as is,
+		// as they are not necessarily files (e.g. database connection strings or GDAL virtual file systems)
+		vector<string> file_names;
+		const auto &path = input.inputs[0];
+		if (path.type().id() == LogicalTypeId::LIST || FileSystem::HasGlob(path.GetValue<string>())) {
+			const auto mfreader = MultiFileReader::Create(input.table_function);
+			const auto mflist = mfreader->CreateFileList(context, path, FileGlobOptions::DISALLOW_EMPTY);
+			for (const auto &file : mflist->GetAllFiles()) {
+				file_names.push_back(file.path);
+			}
+		} else {
+			file_names.push_back(path.GetValue<string>());
+		}
 
-		auto dataset = GDALDatasetUniquePtr(GDALDataset::Open(
-		    result->prefixed_file_name.c_str(), GDAL_OF_VECTOR | GDAL_OF_VERBOSE_ERROR, result->dataset_allowed_drivers,
-		    result->dataset_open_options, result->dataset_sibling_files));
+		result->multi_file = file_names.size() > 1 || add_filename || hive_partitioning;
+		for (const auto &file_name : file_names) {
+			DatasetFile file;
+			file.raw_name = file_name;
+			file.prefixed_name = ctx_state.GetPrefix(file_name);
+			result->files.push_back(std::move(file));
+		}
 
-		if (dataset == nullptr) {
-			auto error = string(CPLGetLastErrorMsg());
-			throw IOException("Could not open file: " + result->raw_file_name + " (" + error + ")");
+		result->raw_file_name = result->files[0].raw_name;
+		result->prefixed_file_name = result->files[0].prefixed_name;
+
+		// A single file is read through the dataset cache, if it is a file whose version can be checked. Sequential
+		// layer scans read through the other layers, so they always use a new dataset.
+		const auto dataset_cache = ctx_state.GetDatasetCache();
+		if (!result->multi_file && !result->sequential_layer_scan && dataset_cache->GetCapacity() != 0 &&
+		    GDALFileStamp::TryGet(context, result->raw_file_name, result->file_stamp)) {
+			result->dataset_cache_key = GetDatasetCacheKey(*result);
 		}
 
+		auto dataset = AcquireDataset(context, *result);
+
 		// Double check that the dataset have any layers
 		if (dataset->GetLayerCount() <= 0) {
 			throw IOException("Dataset does not contain any layers");
@@ -616,6 +1589,9 @@ struct ST_Read : ArrowTableFunction {
 					if (!found) {
 						throw BinderException(StringUtil::Format("Layer '%s' could not be found in dataset", name));
 					}
+					if (result->multi_file) {
+						result->layer_name = name;
+					}
 				}
 			}
 
@@ -639,10 +1615,6 @@ struct ST_Read : ArrowTableFunction {
 				result->spatial_filter = make_uniq<WKBSpatialFilter>(wkb);
 			}
 
-			if (loption == "sequential_layer_scan") {
-				result->sequential_layer_scan = BooleanValue::Get(kv.second);
-			}
-
 			if (loption == "max_batch_size") {
 				auto max_batch_size = IntegerValue::Get(kv.second);
 				if (max_batch_size <= 0) {
@@ -683,175 +1655,184 @@ struct ST_Read : ArrowTableFunction {
 			}
 		}
 
-		struct ArrowArrayStream stream;
-		if (!layer->GetArrowStream(&stream, result->layer_creation_options)) {
-			// layer is owned by GDAL, we do not need to destory it
-			throw IOException("Could not get arrow stream from layer");
+		// Getting the schema requires creating an arrow stream, so it is cached along with the dataset
+		LayerSchema schema;
+		auto schema_cache_key = result->dataset_cache_key;
+		if (!schema_cache_key.empty()) {
+			schema_cache_key += to_string(result->layer_idx) + (result->keep_wkb ? "\nkeep_wkb" : "") + '\0';
+			AppendCacheKey(schema_cache_key, result->layer_creation_options);
 		}
 
-		struct ArrowSchema schema;
-		if (stream.get_schema(&stream, &schema) != 0) {
-			if (stream.release) {
-				stream.release(&stream);
+		if (schema_cache_key.empty() || !dataset_cache->TryGetSchema(schema_cache_key, result->file_stamp, schema)) {
+			struct ArrowArrayStream stream;
+			if (!layer->GetArrowStream(&stream, result->layer_creation_options)) {
+				// layer is owned by GDAL, we do not need to destory it
+				throw IOException("Could not get arrow stream from layer");
 			}
-			throw IOException("Could not get arrow schema from layer");
-		}
 
-		// The Arrow API will return attributes in this order
-		// 1. FID column
-		// 2. all ogr field attributes
-		// 3. all geometry columns
+			try {
+				GetStreamSchema(context, result->keep_wkb, stream, schema);
+			} catch (...) {
+				if (stream.release) {
+					stream.release(&stream);
+				}
+				throw;
+			}
+			stream.release(&stream);
 
-		auto attribute_count = schema.n_children;
-		auto attributes = schema.children;
+			if (!schema_cache_key.empty()) {
+				dataset_cache->AddSchema(schema_cache_key, result->file_stamp, schema);
+			}
+		}
 
-		result->all_names.reserve(attribute_count + 1);
-		names.reserve(attribute_count + 1);
+		if (result->multi_file && result->union_by_name) {
+			// Every file has to be opened to get the union of their columns
+			for (idx_t file_idx = 1; file_idx < result->files.size(); file_idx++) {
+				const auto &file = result->files[file_idx];
+				auto file_dataset = OpenDataset(*result, file.raw_name, file.prefixed_name);
+				auto file_layer = OpenLayer(*result, *file_dataset);
 
-		for (idx_t col_idx = 0; col_idx < (idx_t)attribute_count; col_idx++) {
-			auto &attribute = *attributes[col_idx];
+				ArrowArrayStreamWrapper file_stream;
+				if (!file_layer->GetArrowStream(&file_stream.arrow_array_stream, result->layer_creation_options)) {
+					throw IOException("Could not get arrow stream from layer of file: " + file.raw_name);
+				}
+				LayerSchema file_schema;
+				GetStreamSchema(context, result->keep_wkb, file_stream.arrow_array_stream, file_schema);
+				MergeSchema(schema, file_schema, file.raw_name);
+			}
+		}
 
-			const char ogc_flag[] = {'\x01', '\0', '\0', '\0', '\x14', '\0', '\0', '\0', 'A', 'R', 'R', 'O', 'W',
-			                         ':',    'e',  'x',  't',  'e',    'n',  's',  'i',  'o', 'n', ':', 'n', 'a',
-			                         'm',    'e',  '\a', '\0', '\0',   '\0', 'o',  'g',  'c', '.', 'w', 'k', 'b'};
+		names = schema.names;
+		return_types = schema.types;
+		result->column_names = std::move(schema.names);
+		result->all_names = std::move(schema.field_names);
+		result->geometry_column_ids = std::move(schema.geometry_column_ids);
+		result->arrow_table = std::move(schema.arrow_table);
 
-			auto arrow_type = ArrowType::GetArrowLogicalType(DBConfig::GetConfig(context), attribute);
-
-			auto column_name = string(attribute.name);
-			auto duckdb_type = arrow_type->GetDuckType();
-
-			if (duckdb_type.id() == LogicalTypeId::BLOB && attribute.metadata != nullptr &&
-			    strncmp(attribute.metadata, ogc_flag, sizeof(ogc_flag)) == 0) {
-				// This is a WKB geometry blob
-				result->arrow_table.AddColumn(col_idx, std::move(arrow_type));
-
-				if (result->keep_wkb) {
-					return_types.emplace_back(GeoTypes::WKB_BLOB());
-				} else {
-					return_types.emplace_back(GeoTypes::GEOMETRY());
-					if (column_name == "wkb_geometry") {
-						column_name = "geom";
-					}
-				}
-				result->geometry_column_ids.insert(col_idx);
-
-			} else if (attribute.dictionary) {
-				auto dictionary_type = ArrowType::GetArrowLogicalType(DBConfig::GetConfig(context), attribute);
-				return_types.emplace_back(dictionary_type->GetDuckType());
-				arrow_type->SetDictionary(std::move(dictionary_type));
-				result->arrow_table.AddColumn(col_idx, std::move(arrow_type));
-			} else {
-				return_types.emplace_back(arrow_type->GetDuckType());
-				result->arrow_table.AddColumn(col_idx, std::move(arrow_type));
-			}
-
-			// keep these around for projection/filter pushdown later
-			// does GDAL even allow duplicate/missing names?
-			result->all_names.push_back(column_name);
-
-			if (column_name.empty()) {
-				names.push_back("v" + to_string(col_idx));
-			} else {
-				names.push_back(column_name);
-			}
-		}
+		// The filename and hive partition columns come after the columns of the files
+		if (add_filename) {
+			if (FindColumn(names, "filename") != DConstants::INVALID_INDEX) {
+				throw BinderException("Cannot add a \"filename\" column, the file already has a column with that name");
+			}
+			result->filename_column_idx = names.size();
+			names.emplace_back("filename");
+			return_types.push_back(LogicalType::VARCHAR);
+		}
+		if (hive_partitioning) {
+			result->partition_column_idx = names.size();
+			for (const auto &partition : HivePartitioning::Parse(result->raw_file_name)) {
+				if (FindColumn(names, partition.first) != DConstants::INVALID_INDEX) {
+					throw BinderException("Cannot add hive partition column \"%s\", the file already has a column "
+					                      "with that name",
+					                      partition.first);
+				}
+				names.push_back(partition.first);
+				return_types.push_back(LogicalType::VARCHAR);
+				result->partition_names.push_back(partition.first);
+			}
+			for (auto &file : result->files) {
+				const auto partitions = HivePartitioning::Parse(file.raw_name);
+				for (const auto &partition_name : result->partition_names) {
+					const auto entry = partitions.find(partition_name);
+					file.partition_values.push_back(entry == partitions.end() ? Value(LogicalType::VARCHAR)
+					                                                          : Value(entry->second));
+				}
+			}
+		}
 
 		result->all_types = return_types;
 
-		schema.release(&schema);
-		stream.release(&stream);
-
-		// Rename columns if they are duplicates
-		unordered_map<string, idx_t> name_map;
-		for (auto &column_name : names) {
-			// put it all lower_case
-			auto low_column_name = StringUtil::Lower(column_name);
-			if (name_map.find(low_column_name) == name_map.end()) {
-				// Name does not exist yet
-				name_map[low_column_name]++;
-			} else {
-				// Name already exists, we add _x where x is the repetition number
-				string new_column_name = column_name + "_" + std::to_string(name_map[low_column_name]);
-				auto new_column_name_low = StringUtil::Lower(new_column_name);
-				while (name_map.find(new_column_name_low) != name_map.end()) {
-					// This name is already here due to a previous definition
-					name_map[low_column_name]++;
-					new_column_name = column_name + "_" + std::to_string(name_map[low_column_name]);
-					new_column_name_low = StringUtil::Lower(new_column_name);
-				}
-				column_name = new_column_name;
-				name_map[new_column_name_low]++;
-			}
-		}
-
 		return std::move(result);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
 	// Init Global
 	//------------------------------------------------------------------------------------------------------------------
+	//! The number of FIDs in each range when reading a layer in parallel
+	static constexpr int64_t FID_RANGE_SIZE = 122880;
+
 	struct GlobalState final : ArrowScanGlobalState {
-		GDALDatasetUniquePtr dataset;
+		GDALCachedDataset dataset;
 		atomic<idx_t> lines_read;
 
-		explicit GlobalState(GDALDatasetUniquePtr dataset) : dataset(std::move(dataset)), lines_read(0) {
-		}
-	};
+		//! For drivers that can filter on the FID through an index (GPKG), the layer is read in parallel by FID
+		//! ranges, with each thread opening its own dataset handle. The ranges are claimed in order.
+		bool read_fid_ranges = false;
+		string fid_column;
+		int64_t min_fid = 0;
+		idx_t fid_range_count = 0;
+		atomic<idx_t> next_fid_range;
 
-	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
-		auto &data = input.bind_data->Cast<BindData>();
+		//! When reading multiple files, the files are claimed in order
+		atomic<idx_t> next_file;
 
-		auto dataset = GDALDatasetUniquePtr(GDALDataset::Open(
-		    data.prefixed_file_name.c_str(), GDAL_OF_VECTOR | GDAL_OF_VERBOSE_ERROR | GDAL_OF_READONLY,
-		    data.dataset_allowed_drivers, data.dataset_open_options, data.dataset_sibling_files));
-		if (dataset == nullptr) {
-			const auto error = string(CPLGetLastErrorMsg());
-			throw IOException("Could not open file: " + data.raw_file_name + " (" + error + ")");
+		explicit GlobalState(GDALCachedDataset dataset)
+		    : dataset(std::move(dataset)), lines_read(0), next_fid_range(0), next_file(0) {
 		}
 
-		auto global_state = make_uniq<GlobalState>(std::move(dataset));
-		auto &gstate = *global_state;
+		~GlobalState() override {
+			// The stream reads from the dataset, which may be handed to another scan once it is back in the cache
+			stream.reset();
+			dataset.Reset();
+		}
+	};
 
-		// Open the layer
-		OGRLayer *layer = nullptr;
+	static string QuoteIdentifier(const string &identifier) {
+		return "\"" + StringUtil::Replace(identifier, "\"", "\"\"") + "\"";
+	}
+
+	//! Check if the layer can be read in parallel by FID ranges, and if so, set up the ranges
+	static void TryInitFIDRanges(const BindData &data, GlobalState &gstate, OGRLayer &layer) {
 		if (data.sequential_layer_scan) {
-			// Get the layer from the dataset by scanning through the layers
-			for (int i = 0; i < gstate.dataset->GetLayerCount(); i++) {
-				layer = gstate.dataset->GetLayer(i);
-				if (i == data.layer_idx) {
-					// desired layer found
-					break;
-				}
-				// else scan through and empty the layer
-				OGRFeature *feature;
-				while ((feature = layer->GetNextFeature()) != nullptr) {
-					OGRFeature::DestroyFeature(feature);
-				}
-			}
-		} else {
-			// Otherwise get the layer directly
-			layer = gstate.dataset->GetLayer(data.layer_idx);
+			return;
 		}
-		if (!layer) {
-			throw IOException("Could not get layer");
+
+		// Only GeoPackage evaluates FID filters through an index (the FID is the rowid of the table), other drivers
+		// would scan the whole layer on each thread.
+		const auto driver = gstate.dataset->GetDriver();
+		if (!driver || strcmp(driver->GetDescription(), "GPKG") != 0) {
+			return;
+		}
+		const string fid_column = layer.GetFIDColumn();
+		if (fid_column.empty()) {
+			return;
 		}
 
-		// Apply spatial filter (if we got one)
-		TryApplySpatialFilter(layer, data.spatial_filter.get());
-		// TODO: Apply projection pushdown
+		const auto sql = StringUtil::Format("SELECT MIN(%s), MAX(%s) FROM %s", QuoteIdentifier(fid_column),
+		                                    QuoteIdentifier(fid_column), QuoteIdentifier(layer.GetName()));
+		const auto result = gstate.dataset->ExecuteSQL(sql.c_str(), nullptr, nullptr);
+		if (!result) {
+			return;
+		}
 
-		// Create arrow stream from layer
+		int64_t min_fid = 0;
+		int64_t max_fid = 0;
+		bool has_range = false;
+		const auto feature = OGRFeatureUniquePtr(result->GetNextFeature());
+		if (feature && feature->IsFieldSetAndNotNull(0) && feature->IsFieldSetAndNotNull(1)) {
+			min_fid = feature->GetFieldAsInteger64(0);
+			max_fid = feature->GetFieldAsInteger64(1);
+			has_range = true;
+		}
+		gstate.dataset->ReleaseResultSet(result);
 
-		gstate.stream = make_uniq<ArrowArrayStreamWrapper>();
+		if (!has_range) {
+			return;
+		}
 
-		// set layer options
-		if (!layer->GetArrowStream(&gstate.stream->arrow_array_stream, data.layer_creation_options)) {
-			throw IOException("Could not get arrow stream");
+		const auto range_count = static_cast<idx_t>((max_fid - min_fid) / FID_RANGE_SIZE + 1);
+		if (range_count < 2) {
+			// Not worth opening the dataset on multiple threads
+			return;
 		}
 
-		// Set max 1 thread
-		gstate.max_threads = 1;
+		gstate.read_fid_ranges = true;
+		gstate.fid_column = fid_column;
+		gstate.min_fid = min_fid;
+		gstate.fid_range_count = range_count;
+	}
 
+	static void InitProjection(const BindData &data, GlobalState &gstate, TableFunctionInitInput &input) {
 		if (input.CanRemoveFilterColumns()) {
 			gstate.projection_ids = input.projection_ids;
 			for (const auto &col_idx : input.column_ids) {
@@ -862,7 +1843,49 @@ struct ST_Read : ArrowTableFunction {
 				}
 			}
 		}
+	}
+
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+		auto &data = input.bind_data->Cast<BindData>();
+
+		if (data.multi_file) {
+			// Each thread opens the files it claims itself
+			auto global_state = make_uniq<GlobalState>(GDALCachedDataset());
+			global_state->max_threads = MaxValue<idx_t>(data.files.size(), 1);
+			InitProjection(data, *global_state, input);
+			return std::move(global_state);
+		}
+
+		auto global_state = make_uniq<GlobalState>(AcquireDataset(context, data));
+		auto &gstate = *global_state;
+
+		// Open the layer
+		const auto layer = OpenLayer(data, *gstate.dataset);
+
+		// Apply spatial and attribute filters (if we got any)
+		TryApplySpatialFilter(layer, data.spatial_filter.get());
+		TryApplyAttributeFilter(layer, data.attribute_filter);
+		// TODO: Apply projection pushdown
 
+		TryInitFIDRanges(data, gstate, *layer);
+
+		if (gstate.read_fid_ranges) {
+			// Each thread creates its own arrow streams
+			gstate.max_threads = gstate.fid_range_count;
+		} else {
+			// Create arrow stream from layer
+			gstate.stream = make_uniq<ArrowArrayStreamWrapper>();
+
+			// set layer options
+			if (!layer->GetArrowStream(&gstate.stream->arrow_array_stream, data.layer_creation_options)) {
+				throw IOException("Could not get arrow stream");
+			}
+
+			// Set max 1 thread
+			gstate.max_threads = 1;
+		}
+
+		InitProjection(data, gstate, input);
 		return std::move(global_state);
 	}
 
@@ -877,6 +1900,21 @@ struct ST_Read : ArrowTableFunction {
 		uint32_t wkb_stack[MAX_WKB_STACK_DEPTH] = {};
 		sgl::ops::wkb_reader wkb_reader = {};
 
+		//! When reading FID ranges in parallel, the dataset handle of this thread and the stream of the current range
+		GDALCachedDataset dataset;
+		OGRLayer *layer = nullptr;
+		unique_ptr<ArrowArrayStreamWrapper> stream;
+
+		//! When reading multiple files, the file this thread is reading, and the columns of its arrow stream
+		idx_t file_idx = 0;
+		ArrowTableType file_arrow_table;
+		unordered_set<idx_t> file_geometry_column_ids;
+		//! The columns to scan, the column ids of the arrow scan are those of the file
+		vector<column_t> scan_column_ids;
+		//! For each scanned column, the column of the file chunk it is read from, or INVALID_INDEX if there is none
+		vector<idx_t> file_column_map;
+		DataChunk file_chunk;
+
 		explicit LocalState(unique_ptr<ArrowArrayWrapper> current_chunk, ClientContext &context)
 		    : ArrowScanLocalState(std::move(current_chunk), context), arena(BufferAllocator::Get(context)),
 		      alloc(arena) {
@@ -898,6 +1936,13 @@ struct ST_Read : ArrowTableFunction {
 			arena.Reset();
 
 			UnaryExecutor::Execute<string_t, string_t>(source, target, count, [&](const string_t &wkb) {
+				// OGR exports little-endian WKB, which usually maps onto our format as is. Keep NaN coordinates, like the
+				// reader below does for the features it has to parse.
+				string_t blob;
+				if (Serde::TryFromWKB(wkb.GetDataUnsafe(), wkb.GetSize(), false, target, blob)) {
+					return blob;
+				}
+
 				wkb_reader.buf = wkb.GetDataUnsafe();
 				wkb_reader.end = wkb_reader.buf + wkb.GetSize();
 
@@ -915,87 +1960,655 @@ struct ST_Read : ArrowTableFunction {
 
 				// Serialize the geometry into a blob
 				const auto size = Serde::GetRequiredSize(geom);
-				auto blob = StringVector::EmptyString(target, size);
+				blob = StringVector::EmptyString(target, size);
 				Serde::Serialize(geom, blob.GetDataWriteable(), size);
 				blob.Finalize();
 				return blob;
 			});
 		}
-	};
+	};
+
+	//! Claim the next file, open it and match its columns with the scanned columns. Returns false once all files have
+	//! been claimed.
+	static bool OpenNextFile(ClientContext &context, const BindData &data, LocalState &state, GlobalState &gstate) {
+		const auto file_idx = gstate.next_file++;
+		if (file_idx >= data.files.size()) {
+			return false;
+		}
+		const auto &file = data.files[file_idx];
+
+		state.layer = nullptr;
+		state.dataset = GDALCachedDataset(OpenDataset(data, file.raw_name, file.prefixed_name));
+		state.layer = OpenLayer(data, *state.dataset);
+		TryApplySpatialFilter(state.layer, data.spatial_filter.get());
+		TryApplyAttributeFilter(state.layer, data.attribute_filter);
+
+		state.stream = make_uniq<ArrowArrayStreamWrapper>();
+		if (!state.layer->GetArrowStream(&state.stream->arrow_array_stream, data.layer_creation_options)) {
+			throw IOException("Could not get arrow stream from layer of file: " + file.raw_name);
+		}
+		LayerSchema schema;
+		GetStreamSchema(context, data.keep_wkb, state.stream->arrow_array_stream, schema);
+
+		state.file_idx = file_idx;
+		state.file_arrow_table = std::move(schema.arrow_table);
+		state.file_geometry_column_ids = std::move(schema.geometry_column_ids);
+
+		// Only the file columns that are scanned are converted from arrow
+		vector<LogicalType> file_types;
+		state.column_ids.clear();
+		state.file_column_map.clear();
+		for (const auto column_idx : state.scan_column_ids) {
+			if (!data.IsLayerColumn(column_idx)) {
+				state.file_column_map.push_back(DConstants::INVALID_INDEX);
+				continue;
+			}
+			const auto &name = data.column_names[column_idx];
+			const auto file_column_idx = FindColumn(schema.names, name);
+			if (file_column_idx == DConstants::INVALID_INDEX) {
+				if (!data.union_by_name) {
+					throw InvalidInputException("File \"%s\" does not have a column named \"%s\", set union_by_name "
+					                            "to true to read files with different columns",
+					                            file.raw_name, name);
+				}
+				state.file_column_map.push_back(DConstants::INVALID_INDEX);
+				continue;
+			}
+			if (state.file_geometry_column_ids.count(file_column_idx) !=
+			    data.geometry_column_ids.count(column_idx)) {
+				throw InvalidInputException("Column \"%s\" of file \"%s\" is %sa geometry column, but not in other "
+				                            "files",
+				                            name, file.raw_name,
+				                            data.geometry_column_ids.count(column_idx) ? "not " : "");
+			}
+			state.file_column_map.push_back(state.column_ids.size());
+			state.column_ids.push_back(file_column_idx);
+			file_types.push_back(schema.types[file_column_idx]);
+		}
+
+		state.file_chunk.Destroy();
+		if (!file_types.empty()) {
+			state.file_chunk.Initialize(context, file_types);
+		}
+
+		// The files are claimed in order, so they also order the output
+		state.batch_index = file_idx;
+		return true;
+	}
+
+	//! Convert the next rows of the current file, and map them onto the scanned columns
+	static void ConvertFileChunk(ClientContext &context, const BindData &data, LocalState &state, DataChunk &output,
+	                             idx_t count) {
+		auto &file_chunk = state.file_chunk;
+		if (file_chunk.ColumnCount() != 0) {
+			file_chunk.Reset();
+			file_chunk.SetCardinality(count);
+			ArrowTableFunction::ArrowToDuckDB(state, state.file_arrow_table.GetColumns(), file_chunk, 0, false);
+
+			if (!data.keep_wkb) {
+				for (idx_t col_idx = 0; col_idx < file_chunk.ColumnCount(); col_idx++) {
+					if (state.file_geometry_column_ids.count(state.column_ids[col_idx])) {
+						Vector geom_vec(GeoTypes::GEOMETRY(), count);
+						state.ConvertWKB(file_chunk.data[col_idx], geom_vec, count);
+						file_chunk.data[col_idx].ReferenceAndSetType(geom_vec);
+					}
+				}
+			}
+		}
+
+		const auto &file = data.files[state.file_idx];
+		for (idx_t col_idx = 0; col_idx < output.ColumnCount(); col_idx++) {
+			auto &target = output.data[col_idx];
+			const auto column_idx = state.scan_column_ids[col_idx];
+			const auto file_col_idx = state.file_column_map[col_idx];
+			if (data.IsFilenameOrPartitionColumn(column_idx)) {
+				target.Reference(data.GetFileColumnValue(file, column_idx));
+			} else if (file_col_idx == DConstants::INVALID_INDEX) {
+				// Columns that are missing in this file are NULL
+				target.Reference(Value(target.GetType()));
+			} else if (file_chunk.data[file_col_idx].GetType() == target.GetType()) {
+				target.Reference(file_chunk.data[file_col_idx]);
+			} else {
+				VectorOperations::Cast(context, file_chunk.data[file_col_idx], target, count);
+			}
+		}
+	}
+
+	//! Move the local state to the next arrow chunk, returns false once the layer is exhausted
+	static bool NextChunk(ClientContext &context, const BindData &data, LocalState &state, GlobalState &gstate) {
+		if (!gstate.read_fid_ranges && !data.multi_file) {
+			return ArrowTableFunction::ArrowScanParallelStateNext(context, &data, state, gstate);
+		}
+
+		while (true) {
+			if (state.stream) {
+				auto chunk = state.stream->GetNextChunk();
+				if (chunk->arrow_array.release) {
+					if (chunk->arrow_array.length == 0) {
+						continue;
+					}
+					state.Reset();
+					state.chunk = std::move(chunk);
+					return true;
+				}
+				// Done with this range (or file)
+				state.stream.reset();
+			}
+
+			if (data.multi_file) {
+				if (!OpenNextFile(context, data, state, gstate)) {
+					return false;
+				}
+				continue;
+			}
+
+			// Claim the next FID range
+			const auto range_idx = gstate.next_fid_range++;
+			if (range_idx >= gstate.fid_range_count) {
+				return false;
+			}
+
+			const auto range_min = gstate.min_fid + static_cast<int64_t>(range_idx) * FID_RANGE_SIZE;
+			const auto range_max = range_min + FID_RANGE_SIZE;
+			const auto fid_column = QuoteIdentifier(gstate.fid_column);
+			auto filter = StringUtil::Format("%s >= %d AND %s < %d", fid_column, range_min, fid_column, range_max);
+			if (!data.attribute_filter.empty()) {
+				filter = "(" + data.attribute_filter + ") AND " + filter;
+			}
+			if (state.layer->SetAttributeFilter(filter.c_str()) != OGRERR_NONE) {
+				throw IOException("Could not set FID filter on layer");
+			}
+
+			state.stream = make_uniq<ArrowArrayStreamWrapper>();
+			if (!state.layer->GetArrowStream(&state.stream->arrow_array_stream, data.layer_creation_options)) {
+				throw IOException("Could not get arrow stream");
+			}
+
+			// The ranges are in FID order, so they also order the output
+			state.batch_index = range_idx;
+		}
+	}
+
+	static unique_ptr<LocalTableFunctionState> InitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+	                                                     GlobalTableFunctionState *gstate_p) {
+
+		auto &data = input.bind_data->Cast<BindData>();
+		auto &gstate = gstate_p->Cast<GlobalState>();
+		auto current_chunk = make_uniq<ArrowArrayWrapper>();
+		auto result = make_uniq<LocalState>(std::move(current_chunk), context.client);
+
+		result->column_ids = input.column_ids;
+		result->scan_column_ids = input.column_ids;
+		result->filters = input.filters.get();
+
+		if (input.CanRemoveFilterColumns()) {
+			result->all_columns.Initialize(context.client, gstate.scanned_types);
+		}
+
+		if (gstate.read_fid_ranges) {
+			// Open a dataset handle for this thread
+			result->dataset = AcquireDataset(context.client, data);
+			result->layer = OpenLayer(data, *result->dataset);
+			TryApplySpatialFilter(result->layer, data.spatial_filter.get());
+		}
+
+		if (!NextChunk(context.client, data, *result, gstate)) {
+			return nullptr;
+		}
+
+		return std::move(result);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Execute
+	//------------------------------------------------------------------------------------------------------------------
+	static void Execute(ClientContext &context, TableFunctionInput &input, DataChunk &output) {
+		if (!input.local_state) {
+			return;
+		}
+
+		auto &data = input.bind_data->Cast<BindData>();
+		auto &state = input.local_state->Cast<LocalState>();
+		auto &gstate = input.global_state->Cast<GlobalState>();
+
+		//! Out of tuples in this chunk
+		if (state.chunk_offset >= static_cast<idx_t>(state.chunk->arrow_array.length)) {
+			if (!NextChunk(context, data, state, gstate)) {
+				return;
+			}
+		}
+
+		auto output_size = MinValue<idx_t>(STANDARD_VECTOR_SIZE, state.chunk->arrow_array.length - state.chunk_offset);
+		gstate.lines_read += output_size;
+
+		if (data.multi_file) {
+			if (gstate.CanRemoveFilterColumns()) {
+				state.all_columns.Reset();
+				state.all_columns.SetCardinality(output_size);
+				ConvertFileChunk(context, data, state, state.all_columns, output_size);
+				output.ReferenceColumns(state.all_columns, gstate.projection_ids);
+			} else {
+				output.SetCardinality(output_size);
+				ConvertFileChunk(context, data, state, output, output_size);
+			}
+			output.Verify();
+			state.chunk_offset += output.size();
+			return;
+		}
+
+		if (gstate.CanRemoveFilterColumns()) {
+			state.all_columns.Reset();
+			state.all_columns.SetCardinality(output_size);
+			ArrowTableFunction::ArrowToDuckDB(state, data.arrow_table.GetColumns(), state.all_columns,
+			                                  gstate.lines_read - output_size, false);
+			output.ReferenceColumns(state.all_columns, gstate.projection_ids);
+		} else {
+			output.SetCardinality(output_size);
+			ArrowTableFunction::ArrowToDuckDB(state, data.arrow_table.GetColumns(), output,
+			                                  gstate.lines_read - output_size, false);
+		}
+
+		if (!data.keep_wkb) {
+			// Find the geometry columns
+			for (idx_t col_idx = 0; col_idx < state.column_ids.size(); col_idx++) {
+				auto mapped_idx = state.column_ids[col_idx];
+				if (data.geometry_column_ids.find(mapped_idx) != data.geometry_column_ids.end()) {
+					// Found a geometry column
+					// Convert the WKB columns to a geometry column
+
+					Vector geom_vec(GeoTypes::GEOMETRY(), output_size);
+					state.ConvertWKB(output.data[col_idx], geom_vec, output_size);
+
+					output.data[col_idx].ReferenceAndSetType(geom_vec);
+				}
+			}
+		}
+
+		output.Verify();
+		state.chunk_offset += output.size();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Filter Pushdown
+	//------------------------------------------------------------------------------------------------------------------
+	// Spatial predicates between a geometry column and a constant geometry become an OGR spatial filter on the bounds
+	// of the constant, so that drivers with a spatial index (e.g. GPKG, FlatGeobuf, Shapefile) can skip features.
+	// The filters themselves are kept, as OGR only guarantees that the features it returns intersect the bounds.
+
+	//! Check if the filter is a spatial predicate on a geometry column and a constant, and if so, get the OGR geometry
+	//! field and the bounds the column has to intersect
+	static bool TryGetFilterBounds(const LogicalGet &get, const BindData &data, const Expression &expr,
+	                               int &geom_field, sgl::box_xy &bounds) {
+		// All of these imply bounding box intersection
+		static const case_insensitive_set_t spatial_predicates = {
+		    "ST_Equals",   "ST_Intersects", "ST_Touches",   "ST_Crosses",          "ST_Within",         "ST_Contains",
+		    "ST_Overlaps", "ST_Covers",     "ST_CoveredBy", "ST_ContainsProperly", "ST_WithinProperly", "ST_DWithin",
+		    "ST_Intersects_Extent"};
+
+		if (expr.GetExpressionClass() != ExpressionClass::BOUND_FUNCTION) {
+			return false;
+		}
+		auto &func = expr.Cast<BoundFunctionExpression>();
+		if (spatial_predicates.find(func.function.name) == spatial_predicates.end()) {
+			return false;
+		}
+
+		const auto is_distance = StringUtil::CIEquals(func.function.name, "ST_DWithin");
+		if (func.children.size() != (is_distance ? 3 : 2)) {
+			return false;
+		}
+
+		// One side has to be a geometry column of this scan, and the other a constant
+		auto &lhs = *func.children[0];
+		auto &rhs = *func.children[1];
+		const auto lhs_is_column = lhs.GetExpressionClass() == ExpressionClass::BOUND_COLUMN_REF;
+		auto &column_expr = lhs_is_column ? lhs : rhs;
+		auto &constant_expr = lhs_is_column ? rhs : lhs;
+		if (column_expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF ||
+		    constant_expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT ||
+		    column_expr.return_type != GeoTypes::GEOMETRY() || constant_expr.return_type != GeoTypes::GEOMETRY()) {
+			return false;
+		}
+
+		auto &column = column_expr.Cast<BoundColumnRefExpression>();
+		if (column.binding.table_index != get.table_index) {
+			return false;
+		}
+		const auto &column_ids = get.GetColumnIds();
+		if (column.binding.column_index >= column_ids.size()) {
+			return false;
+		}
+		const auto column_idx = column_ids[column.binding.column_index].GetPrimaryIndex();
+		if (data.geometry_column_ids.find(column_idx) == data.geometry_column_ids.end()) {
+			return false;
+		}
+
+		// The geometry columns are in the same order as the geometry fields of the layer
+		geom_field = 0;
+		for (const auto &geometry_column_idx : data.geometry_column_ids) {
+			if (geometry_column_idx < column_idx) {
+				geom_field++;
+			}
+		}
+
+		auto &constant = constant_expr.Cast<BoundConstantExpression>().value;
+		if (constant.IsNull()) {
+			return false;
+		}
+		const auto &blob = StringValue::Get(constant);
+		bounds = sgl::box_xy::smallest();
+		if (!Serde::TryGetExtentXY(blob.data(), blob.size(), bounds)) {
+			// Empty geometries dont intersect anything, but leave that to the filter itself
+			return false;
+		}
+
+		if (is_distance) {
+			auto &distance_expr = *func.children[2];
+			if (distance_expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+				return false;
+			}
+			auto &distance_value = distance_expr.Cast<BoundConstantExpression>().value;
+			if (distance_value.IsNull()) {
+				return false;
+			}
+			const auto distance = distance_value.GetValue<double>();
+			if (!(distance >= 0)) {
+				return false;
+			}
+			bounds.min.x -= distance;
+			bounds.min.y -= distance;
+			bounds.max.x += distance;
+			bounds.max.y += distance;
+		}
+		return true;
+	}
+
+	static void PushdownSpatialFilter(const LogicalGet &get, BindData &data,
+	                                  const vector<unique_ptr<Expression>> &filters) {
+		if (data.spatial_filter || data.keep_wkb) {
+			// Dont override an explicit spatial filter
+			return;
+		}
+
+		// The filters are all AND'ed together, so intersect the bounds of all predicates on the same geometry field
+		bool has_bounds = false;
+		int filter_field = 0;
+		sgl::box_xy filter_bounds = {};
+		for (const auto &filter : filters) {
+			int geom_field;
+			sgl::box_xy bounds = {};
+			if (!TryGetFilterBounds(get, data, *filter, geom_field, bounds)) {
+				continue;
+			}
+			if (!has_bounds) {
+				has_bounds = true;
+				filter_field = geom_field;
+				filter_bounds = bounds;
+			} else if (geom_field == filter_field) {
+				filter_bounds.min.x = MaxValue(filter_bounds.min.x, bounds.min.x);
+				filter_bounds.min.y = MaxValue(filter_bounds.min.y, bounds.min.y);
+				filter_bounds.max.x = MinValue(filter_bounds.max.x, bounds.max.x);
+				filter_bounds.max.y = MinValue(filter_bounds.max.y, bounds.max.y);
+			}
+		}
+
+		if (!has_bounds) {
+			return;
+		}
+
+		data.spatial_filter = make_uniq<RectangleSpatialFilter>(filter_bounds.min.x, filter_bounds.min.y,
+		                                                        filter_bounds.max.x, filter_bounds.max.y);
+		data.spatial_filter->geom_field = filter_field;
+	}
+
+	// Simple comparisons between an attribute column and constants are also translated into an OGR SQL attribute
+	// filter, which database backed drivers evaluate at the source. These filters are kept as well, so the attribute
+	// filter only has to let through every feature that matches, which rules out some types and operators.
+
+	//! Get the OGR field name of an attribute column of this scan, if the column is of a type we can filter on
+	static bool TryGetFilterColumn(const LogicalGet &get, const BindData &data, const Expression &expr,
+	                               string &field_name) {
+		if (expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+			return false;
+		}
+		auto &column = expr.Cast<BoundColumnRefExpression>();
+		if (column.binding.table_index != get.table_index) {
+			return false;
+		}
+		const auto &column_ids = get.GetColumnIds();
+		if (column.binding.column_index >= column_ids.size()) {
+			return false;
+		}
+		const auto column_idx = column_ids[column.binding.column_index].GetPrimaryIndex();
+		if (column_idx >= data.all_names.size() ||
+		    data.geometry_column_ids.find(column_idx) != data.geometry_column_ids.end()) {
+			return false;
+		}
+		switch (data.all_types[column_idx].id()) {
+		case LogicalTypeId::TINYINT:
+		case LogicalTypeId::SMALLINT:
+		case LogicalTypeId::INTEGER:
+		case LogicalTypeId::BIGINT:
+		case LogicalTypeId::DOUBLE:
+		case LogicalTypeId::VARCHAR:
+			break;
+		default:
+			return false;
+		}
+		if (expr.return_type != data.all_types[column_idx] || data.all_names[column_idx].empty()) {
+			return false;
+		}
+		field_name = QuoteIdentifier(data.all_names[column_idx]);
+		return true;
+	}
 
-	static unique_ptr<LocalTableFunctionState> InitLocal(ExecutionContext &context, TableFunctionInitInput &input,
-	                                                     GlobalTableFunctionState *gstate_p) {
+	//! Format a constant as an OGR SQL literal of the same type as the column it is compared with
+	static bool TryGetFilterLiteral(const Expression &column, const Expression &expr, string &literal) {
+		if (expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT || expr.return_type != column.return_type) {
+			return false;
+		}
+		auto &value = expr.Cast<BoundConstantExpression>().value;
+		if (value.IsNull()) {
+			return false;
+		}
+		switch (value.type().id()) {
+		case LogicalTypeId::VARCHAR:
+			literal = "'" + StringUtil::Replace(StringValue::Get(value), "'", "''") + "'";
+			return true;
+		case LogicalTypeId::DOUBLE:
+			if (!Value::IsFinite(value.GetValue<double>())) {
+				return false;
+			}
+			literal = value.ToString();
+			return true;
+		default:
+			literal = value.ToString();
+			return true;
+		}
+	}
 
-		auto &gstate = gstate_p->Cast<ArrowScanGlobalState>();
-		auto current_chunk = make_uniq<ArrowArrayWrapper>();
-		auto result = make_uniq<LocalState>(std::move(current_chunk), context.client);
+	static bool TryGetAttributeFilter(const LogicalGet &get, const BindData &data, const Expression &expr,
+	                                  string &result) {
+		switch (expr.GetExpressionClass()) {
+		case ExpressionClass::BOUND_COMPARISON: {
+			auto &comparison = expr.Cast<BoundComparisonExpression>();
+			auto type = comparison.GetExpressionType();
+			const Expression *column = comparison.left.get();
+			const Expression *constant = comparison.right.get();
+			if (column->GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+				std::swap(column, constant);
+				type = FlipComparisonExpression(type);
+			}
 
-		result->column_ids = input.column_ids;
-		result->filters = input.filters.get();
+			string op;
+			switch (type) {
+			case ExpressionType::COMPARE_EQUAL:
+				op = "=";
+				break;
+			case ExpressionType::COMPARE_NOTEQUAL:
+				op = "<>";
+				break;
+			case ExpressionType::COMPARE_LESSTHAN:
+				op = "<";
+				break;
+			case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+				op = "<=";
+				break;
+			case ExpressionType::COMPARE_GREATERTHAN:
+				op = ">";
+				break;
+			case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+				op = ">=";
+				break;
+			default:
+				return false;
+			}
 
-		if (input.CanRemoveFilterColumns()) {
-			result->all_columns.Initialize(context.client, gstate.scanned_types);
-		}
+			string field_name;
+			string literal;
+			if (!TryGetFilterColumn(get, data, *column, field_name) ||
+			    !TryGetFilterLiteral(*column, *constant, literal)) {
+				return false;
+			}
 
-		if (!ArrowTableFunction::ArrowScanParallelStateNext(context.client, input.bind_data.get(), *result, gstate)) {
-			return nullptr;
+			// The attribute filter may let through more features than the query filter, but never fewer
+			const auto column_type = column->return_type.id();
+			if (column_type == LogicalTypeId::VARCHAR && type != ExpressionType::COMPARE_EQUAL) {
+				// OGR SQL does not necessarily compare strings case-sensitively
+				return false;
+			}
+			if (column_type == LogicalTypeId::DOUBLE && type != ExpressionType::COMPARE_EQUAL &&
+			    type != ExpressionType::COMPARE_LESSTHAN && type != ExpressionType::COMPARE_LESSTHANOREQUALTO) {
+				// DuckDB orders NaN above all other values
+				return false;
+			}
+			result = field_name + " " + op + " " + literal;
+			return true;
+		}
+		case ExpressionClass::BOUND_OPERATOR: {
+			auto &op = expr.Cast<BoundOperatorExpression>();
+			if (op.children.empty()) {
+				return false;
+			}
+			string field_name;
+			if (!TryGetFilterColumn(get, data, *op.children[0], field_name)) {
+				return false;
+			}
+			switch (op.GetExpressionType()) {
+			case ExpressionType::OPERATOR_IS_NULL:
+				result = field_name + " IS NULL";
+				return true;
+			case ExpressionType::OPERATOR_IS_NOT_NULL:
+				result = field_name + " IS NOT NULL";
+				return true;
+			case ExpressionType::COMPARE_IN: {
+				vector<string> literals;
+				for (idx_t i = 1; i < op.children.size(); i++) {
+					string literal;
+					if (!TryGetFilterLiteral(*op.children[0], *op.children[i], literal)) {
+						return false;
+					}
+					literals.push_back(literal);
+				}
+				result = field_name + " IN (" + StringUtil::Join(literals, ", ") + ")";
+				return true;
+			}
+			default:
+				return false;
+			}
+		}
+		default:
+			return false;
 		}
-
-		return std::move(result);
 	}
 
-	//------------------------------------------------------------------------------------------------------------------
-	// Execute
-	//------------------------------------------------------------------------------------------------------------------
-	static void Execute(ClientContext &context, TableFunctionInput &input, DataChunk &output) {
-		if (!input.local_state) {
+	static void PushdownAttributeFilter(const LogicalGet &get, BindData &data,
+	                                    const vector<unique_ptr<Expression>> &filters) {
+		if (!data.attribute_filter.empty()) {
+			// Already pushed down
 			return;
 		}
-
-		auto &data = input.bind_data->Cast<BindData>();
-		auto &state = input.local_state->Cast<LocalState>();
-		auto &gstate = input.global_state->Cast<GlobalState>();
-
-		//! Out of tuples in this chunk
-		if (state.chunk_offset >= static_cast<idx_t>(state.chunk->arrow_array.length)) {
-			if (!ArrowTableFunction::ArrowScanParallelStateNext(context, input.bind_data.get(), state, gstate)) {
-				return;
+		if (data.multi_file && data.union_by_name) {
+			// The fields of the filter are not necessarily in every file
+			return;
+		}
+		vector<string> conditions;
+		for (const auto &filter : filters) {
+			string condition;
+			if (TryGetAttributeFilter(get, data, *filter, condition)) {
+				conditions.push_back(condition);
 			}
 		}
+		data.attribute_filter = StringUtil::Join(conditions, " AND ");
+	}
 
-		auto output_size = MinValue<idx_t>(STANDARD_VECTOR_SIZE, state.chunk->arrow_array.length - state.chunk_offset);
-		gstate.lines_read += output_size;
+	// Filters that only reference the filename and hive partition columns are evaluated for every file at bind time,
+	// and the files for which they are not true are skipped entirely.
 
-		if (gstate.CanRemoveFilterColumns()) {
-			state.all_columns.Reset();
-			state.all_columns.SetCardinality(output_size);
-			ArrowTableFunction::ArrowToDuckDB(state, data.arrow_table.GetColumns(), state.all_columns,
-			                                  gstate.lines_read - output_size, false);
-			output.ReferenceColumns(state.all_columns, gstate.projection_ids);
-		} else {
-			output.SetCardinality(output_size);
-			ArrowTableFunction::ArrowToDuckDB(state, data.arrow_table.GetColumns(), output,
-			                                  gstate.lines_read - output_size, false);
+	//! Check if the filter only references the filename and hive partition columns of this scan
+	static bool IsFileFilter(const LogicalGet &get, const BindData &data, const Expression &expr) {
+		if (expr.GetExpressionClass() == ExpressionClass::BOUND_COLUMN_REF) {
+			auto &column = expr.Cast<BoundColumnRefExpression>();
+			const auto &column_ids = get.GetColumnIds();
+			if (column.binding.table_index != get.table_index || column.binding.column_index >= column_ids.size()) {
+				return false;
+			}
+			const auto column_idx = column_ids[column.binding.column_index].GetPrimaryIndex();
+			return data.IsFilenameOrPartitionColumn(column_idx);
 		}
+		if (expr.IsVolatile() || expr.GetExpressionClass() == ExpressionClass::BOUND_SUBQUERY) {
+			return false;
+		}
+		bool result = true;
+		ExpressionIterator::EnumerateChildren(expr, [&](const Expression &child) {
+			result = result && IsFileFilter(get, data, child);
+		});
+		return result;
+	}
 
-		if (!data.keep_wkb) {
-			// Find the geometry columns
-			for (idx_t col_idx = 0; col_idx < state.column_ids.size(); col_idx++) {
-				auto mapped_idx = state.column_ids[col_idx];
-				if (data.geometry_column_ids.find(mapped_idx) != data.geometry_column_ids.end()) {
-					// Found a geometry column
-					// Convert the WKB columns to a geometry column
-
-					Vector geom_vec(GeoTypes::GEOMETRY(), output_size);
-					state.ConvertWKB(output.data[col_idx], geom_vec, output_size);
+	//! Replace the column references of a file filter with the values of a file
+	static void BindFileFilter(const LogicalGet &get, const BindData &data, const DatasetFile &file,
+	                           unique_ptr<Expression> &expr) {
+		if (expr->GetExpressionClass() == ExpressionClass::BOUND_COLUMN_REF) {
+			auto &column = expr->Cast<BoundColumnRefExpression>();
+			const auto column_idx = get.GetColumnIds()[column.binding.column_index].GetPrimaryIndex();
+			expr = make_uniq<BoundConstantExpression>(data.GetFileColumnValue(file, column_idx));
+			return;
+		}
+		ExpressionIterator::EnumerateChildren(
+		    *expr, [&](unique_ptr<Expression> &child) { BindFileFilter(get, data, file, child); });
+	}
 
-					output.data[col_idx].ReferenceAndSetType(geom_vec);
+	static void PushdownFileFilter(ClientContext &context, const LogicalGet &get, BindData &data,
+	                               const vector<unique_ptr<Expression>> &filters) {
+		if (!data.multi_file) {
+			return;
+		}
+		for (const auto &filter : filters) {
+			if (!IsFileFilter(get, data, *filter)) {
+				continue;
+			}
+			vector<DatasetFile> files;
+			for (auto &file : data.files) {
+				auto file_filter = filter->Copy();
+				BindFileFilter(get, data, file, file_filter);
+				Value result;
+				if (ExpressionExecutor::TryEvaluateScalar(context, *file_filter, result) &&
+				    (result.IsNull() || (result.type() == LogicalType::BOOLEAN && !BooleanValue::Get(result)))) {
+					continue;
 				}
+				files.push_back(std::move(file));
 			}
+			data.files = std::move(files);
 		}
+	}
 
-		output.Verify();
-		state.chunk_offset += output.size();
+	static void PushdownComplexFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+	                                  vector<unique_ptr<Expression>> &filters) {
+		auto &data = bind_data_p->Cast<BindData>();
+		PushdownFileFilter(context, get, data, filters);
+		PushdownSpatialFilter(get, data, filters);
+		PushdownAttributeFilter(get, data, filters);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
@@ -1006,8 +2619,43 @@ struct ST_Read : ArrowTableFunction {
 		auto result = make_uniq<NodeStatistics>();
 
 		if (bind_data.has_approximate_feature_count) {
+			// When reading multiple files, assume they are about as large as the first
 			result->has_estimated_cardinality = true;
-			result->estimated_cardinality = bind_data.approximate_feature_count;
+			result->estimated_cardinality = bind_data.approximate_feature_count * bind_data.files.size();
+		}
+		return result;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// ToString
+	//------------------------------------------------------------------------------------------------------------------
+	static InsertionOrderPreservingMap<string> ToString(TableFunctionToStringInput &input) {
+		InsertionOrderPreservingMap<string> result;
+		result["Function"] = "ST_READ";
+		auto &data = input.bind_data->Cast<BindData>();
+		if (data.spatial_filter && data.spatial_filter->type == SpatialFilterType::Rectangle) {
+			auto &rect = static_cast<RectangleSpatialFilter &>(*data.spatial_filter);
+			result["Spatial Filter"] = StringUtil::Format(
+			    "BOX(%s %s, %s %s)", Value::DOUBLE(rect.min_x).ToString(), Value::DOUBLE(rect.min_y).ToString(),
+			    Value::DOUBLE(rect.max_x).ToString(), Value::DOUBLE(rect.max_y).ToString());
+		} else if (data.spatial_filter) {
+			result["Spatial Filter"] = "Geometry";
+		}
+		if (!data.attribute_filter.empty()) {
+			result["Attribute Filter"] = data.attribute_filter;
+		}
+		return result;
+	}
+
+	// Reports how the layer was split up for reading in parallel when profiling
+	static InsertionOrderPreservingMap<string> DynamicToString(TableFunctionDynamicToStringInput &input) {
+		InsertionOrderPreservingMap<string> result;
+		if (!input.global_state) {
+			return result;
+		}
+		auto &gstate = input.global_state->Cast<GlobalState>();
+		if (gstate.read_fid_ranges) {
+			result["FID Ranges"] = to_string(gstate.fid_range_count);
 		}
 		return result;
 	}
@@ -1046,7 +2694,7 @@ struct ST_Read : ArrowTableFunction {
 
 	    | Parameter | Type | Description |
 	    | --------- | -----| ----------- |
-	    | `path` | VARCHAR | The path to the file to read. Mandatory |
+	    | `path` | VARCHAR or VARCHAR[] | The path to the file to read, a glob pattern or a list of files. Mandatory |
 	    | `sequential_layer_scan` | BOOLEAN | If set to true, the table function will scan through all layers sequentially and return the first layer that matches the given layer name. This is required for some drivers to work properly, e.g., the OSM driver. |
 	    | `spatial_filter` | WKB_BLOB | If set to a WKB blob, the table function will only return rows that intersect with the given WKB geometry. Some drivers may support efficient spatial filtering natively, in which case it will be pushed down. Otherwise the filtering is done by GDAL which may be much slower. |
 	    | `open_options` | VARCHAR[] | A list of key-value pairs that are passed to the GDAL driver to control the opening of the file. E.g., the GeoJSON driver supports a FLATTEN_NESTED_ATTRIBUTES=YES option to flatten nested attributes. |
@@ -1055,8 +2703,13 @@ struct ST_Read : ArrowTableFunction {
 	    | `sibling_files` | VARCHAR[] | A list of sibling files that are required to open the file. E.g., the ESRI Shapefile driver requires a .shx file to be present. Although most of the time these can be discovered automatically. |
 	    | `spatial_filter_box` | BOX_2D | If set to a BOX_2D, the table function will only return rows that intersect with the given bounding box. Similar to spatial_filter. |
 	    | `keep_wkb` | BOOLEAN | If set, the table function will return geometries in a wkb_geometry column with the type WKB_BLOB (which can be cast to BLOB) instead of GEOMETRY. This is useful if you want to use DuckDB with more exotic geometry subtypes that DuckDB spatial doesnt support representing in the GEOMETRY type yet. |
+	    | `filename` | BOOLEAN | If set, a `filename` column with the path of the file each row was read from is added. |
+	    | `hive_partitioning` | BOOLEAN | If set, the `key=value` directories of the file paths are added as VARCHAR columns. Filters on these columns skip the files that can not match. |
+	    | `union_by_name` | BOOLEAN | When reading multiple files, return the union of the columns of all files, matched by name. Columns that are missing in a file are NULL. Otherwise the columns of the first file are returned, and every file must have them. |
 
-	    Note that GDAL is single-threaded, so this table function will not be able to make full use of parallelism.
+	    Note that GDAL is single-threaded, so this table function will usually not be able to make full use of parallelism. GeoPackage layers are the exception, they are read in parallel by splitting them into ranges of feature ids. When reading multiple files, the files are read in parallel instead, with each thread opening the files it reads itself.
+
+	    When a single file is read, its dataset is kept open after the query, so that reading the same file again (with the same options) does not have to open it again. The cached datasets are reopened once the size or the modification time of the file changes. Each connection keeps up to `gdal_dataset_cache_size` datasets open, `SET gdal_dataset_cache_size = 0` disables the cache.
 
 	    By using `ST_Read`, the spatial extension also provides “replacement scans” for common geospatial file formats, allowing you to query files of these formats as if they were tables directly.
 
@@ -1081,6 +2734,9 @@ struct ST_Read : ArrowTableFunction {
 
 		-- Read a GeoJSON file
 		CREATE TABLE my_geojson_table AS SELECT * FROM ST_Read('some/file/path/filename.json');
+
+		-- Read all GeoPackages of a hive partitioned directory, skipping the files of other years
+		SELECT * FROM ST_Read('tiles/*/*.gpkg', hive_partitioning = true, filename = true) WHERE year = '2024';
 	)";
 
 	//------------------------------------------------------------------------------------------------------------------
@@ -1091,8 +2747,11 @@ struct ST_Read : ArrowTableFunction {
 
 		func.cardinality = Cardinality;
 		func.get_partition_data = ArrowTableFunction::ArrowGetPartitionData;
+		func.to_string = ToString;
+		func.dynamic_to_string = DynamicToString;
 
 		func.projection_pushdown = true;
+		func.pushdown_complex_filter = PushdownComplexFilter;
 
 		func.named_parameters["open_options"] = LogicalType::LIST(LogicalType::VARCHAR);
 		func.named_parameters["allowed_drivers"] = LogicalType::LIST(LogicalType::VARCHAR);
@@ -1103,7 +2762,10 @@ struct ST_Read : ArrowTableFunction {
 		func.named_parameters["sequential_layer_scan"] = LogicalType::BOOLEAN;
 		func.named_parameters["max_batch_size"] = LogicalType::INTEGER;
 		func.named_parameters["keep_wkb"] = LogicalType::BOOLEAN;
-		ExtensionUtil::RegisterFunction(db, func);
+		func.named_parameters["filename"] = LogicalType::BOOLEAN;
+		func.named_parameters["hive_partitioning"] = LogicalType::BOOLEAN;
+		func.named_parameters["union_by_name"] = LogicalType::BOOLEAN;
+		ExtensionUtil::RegisterFunction(db, MultiFileReader::CreateFunctionSet(func));
 
 		InsertionOrderPreservingMap<string> tags;
 		tags.insert("ext", "spatial");
@@ -1112,6 +2774,12 @@ struct ST_Read : ArrowTableFunction {
 		// Replacement scan
 		auto &config = DBConfig::GetConfig(db);
 		config.replacement_scans.emplace_back(ReplacementScan);
+
+		config.AddExtensionOption(GDALDatasetCache::SETTING_NAME,
+		                          "The number of datasets opened by ST_Read (and of their layer schemas) that each "
+		                          "connection keeps open between queries, so that reading the same file again does not "
+		                          "have to open it again. 0 disables the cache",
+		                          LogicalType::UBIGINT, Value::UBIGINT(GDALDatasetCache::DEFAULT_CAPACITY));
 	}
 };
 
@@ -1163,6 +2831,7 @@ struct ST_Read_Meta {
 
 	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
 	                                     vector<LogicalType> &return_types, vector<string> &names) {
+		InitializeGDAL();
 
 		names.push_back("file_name");
 		return_types.push_back(LogicalType::VARCHAR);
@@ -1355,6 +3024,7 @@ struct ST_Drivers {
 
 	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
 	                                     vector<LogicalType> &return_types, vector<string> &names) {
+		InitializeGDAL();
 
 		return_types.emplace_back(LogicalType::VARCHAR);
 		return_types.emplace_back(LogicalType::VARCHAR);
@@ -1464,8 +3134,7 @@ struct ST_Drivers {
 //======================================================================================================================
 // ST_Write
 //======================================================================================================================
-// TODO: This currently uses slow "Value" row-by-row conversions. GDAL now supports writing through arrow, so we should
-// move into using that in the future.
+// TODO: GDAL now supports writing through arrow, so we should move into using that in the future.
 
 struct ST_Write {
 
@@ -1492,6 +3161,7 @@ struct ST_Write {
 
 	static unique_ptr<FunctionData> Bind(ClientContext &context, CopyFunctionBindInput &input,
 	                                     const vector<string> &names, const vector<LogicalType> &sql_types) {
+		InitializeGDAL();
 
 		auto bind_data = make_uniq<BindData>(input.info.file_path, sql_types, names);
 
@@ -1612,13 +3282,50 @@ struct ST_Write {
 	// Global State
 	//------------------------------------------------------------------------------------------------------------------
 	struct GlobalState final : GlobalFunctionData {
+		//! The number of features written per transaction, for drivers that support transactions (e.g. GPKG)
+		static constexpr idx_t TRANSACTION_SIZE = 100000;
+
 		mutex lock;
 		GDALDatasetUniquePtr dataset;
 		OGRLayer *layer;
+		OGRFeatureDefn *layer_defn;
 		vector<unique_ptr<OGRFieldDefn>> field_defs;
 
-		GlobalState(GDALDatasetUniquePtr dataset, OGRLayer *layer, vector<unique_ptr<OGRFieldDefn>> field_defs)
-		    : dataset(std::move(dataset)), layer(layer), field_defs(std::move(field_defs)) {
+		bool use_transactions;
+		bool in_transaction = false;
+		idx_t transaction_features = 0;
+
+		GlobalState(GDALDatasetUniquePtr dataset_p, OGRLayer *layer, vector<unique_ptr<OGRFieldDefn>> field_defs)
+		    : dataset(std::move(dataset_p)), layer(layer), layer_defn(layer->GetLayerDefn()),
+		      field_defs(std::move(field_defs)) {
+			use_transactions = dataset->TestCapability(ODsCTransactions);
+		}
+
+		//! Write a feature to the layer, must be called while holding the lock
+		void WriteFeature(OGRFeature &feature) {
+			if (use_transactions && !in_transaction) {
+				if (dataset->StartTransaction() != OGRERR_NONE) {
+					throw IOException("Could not start transaction");
+				}
+				in_transaction = true;
+			}
+			if (layer->CreateFeature(&feature) != OGRERR_NONE) {
+				throw IOException("Could not create feature");
+			}
+			if (in_transaction && ++transaction_features >= TRANSACTION_SIZE) {
+				CommitTransaction();
+			}
+		}
+
+		void CommitTransaction() {
+			if (!in_transaction) {
+				return;
+			}
+			in_transaction = false;
+			transaction_features = 0;
+			if (dataset->CommitTransaction() != OGRERR_NONE) {
+				throw IOException("Could not commit transaction");
+			}
 		}
 	};
 
@@ -1722,6 +3429,11 @@ struct ST_Write {
 		// Create the dataset
 		auto &client_ctx = GDALClientContextState::GetOrCreate(context);
 		auto prefixed_path = client_ctx.GetPrefix(file_path);
+
+		// The file may be overwritten within the resolution of its modification time, so the cached datasets can not
+		// tell that they are stale. Close them, as writes are rare compared to reads.
+		client_ctx.GetDatasetCache()->Clear();
+
 		auto dataset = GDALDatasetUniquePtr(
 		    driver->Create(prefixed_path.c_str(), 0, 0, 0, GDT_Unknown, gdal_data.dataset_creation_options));
 		if (!dataset) {
@@ -1774,6 +3486,7 @@ struct ST_Write {
 	//------------------------------------------------------------------------------------------------------------------
 	struct LocalState final : public LocalFunctionData {
 		ArenaAllocator arena;
+		vector<OGRFeatureUniquePtr> features;
 		explicit LocalState(ClientContext &context) : arena(BufferAllocator::Get(context)) {
 		}
 	};
@@ -1786,14 +3499,17 @@ struct ST_Write {
 	//------------------------------------------------------------------------------------------------------------------
 	// Sink
 	//------------------------------------------------------------------------------------------------------------------
-	static OGRGeometryUniquePtr OGRGeometryFromValue(const LogicalType &type, const Value &value,
-	                                                 ArenaAllocator &arena) {
-		if (value.IsNull()) {
+	// The features are created from the (flattened) vectors by each thread on its own, only writing them to the layer
+	// happens while holding the lock.
+
+	static OGRGeometryUniquePtr OGRGeometryFromVector(const LogicalType &type, Vector &vector, idx_t row_idx,
+	                                                  ArenaAllocator &arena) {
+		if (FlatVector::IsNull(vector, row_idx)) {
 			return nullptr;
 		}
 
 		if (type == GeoTypes::WKB_BLOB()) {
-			const auto str = value.GetValueUnsafe<string_t>();
+			const auto str = FlatVector::GetData<string_t>(vector)[row_idx];
 			OGRGeometry *ptr;
 			size_t consumed;
 			const auto ok = OGRGeometryFactory::createFromWkb(str.GetDataUnsafe(), nullptr, &ptr, str.GetSize(),
@@ -1806,7 +3522,7 @@ struct ST_Write {
 		}
 
 		if (type == GeoTypes::GEOMETRY()) {
-			const auto blob = value.GetValueUnsafe<string_t>();
+			const auto blob = FlatVector::GetData<string_t>(vector)[row_idx];
 			uint32_t size;
 			const auto wkb = WKBWriter::Write(blob, &size, arena);
 			OGRGeometry *ptr;
@@ -1818,9 +3534,9 @@ struct ST_Write {
 		}
 
 		if (type == GeoTypes::POINT_2D()) {
-			auto children = StructValue::GetChildren(value);
-			auto x = children[0].GetValue<double>();
-			auto y = children[1].GetValue<double>();
+			auto &children = StructVector::GetEntries(vector);
+			auto x = FlatVector::GetData<double>(*children[0])[row_idx];
+			auto y = FlatVector::GetData<double>(*children[1])[row_idx];
 			auto ogr_point = new OGRPoint(x, y);
 			return OGRGeometryUniquePtr(ogr_point);
 		}
@@ -1828,112 +3544,85 @@ struct ST_Write {
 		throw NotImplementedException("Unsupported geometry type");
 	}
 
-	static void SetOgrFieldFromValue(OGRFeature *feature, int field_idx, const LogicalType &type, const Value &value) {
-		// TODO: Set field by index always instead of by name for performance.
-		if (value.IsNull()) {
+	static void SetOgrDateTimeField(OGRFeature *feature, int field_idx, timestamp_t timestamp) {
+		auto date = Timestamp::GetDate(timestamp);
+		auto time = Timestamp::GetTime(timestamp);
+		auto year = Date::ExtractYear(date);
+		auto month = Date::ExtractMonth(date);
+		auto day = Date::ExtractDay(date);
+		auto hour = static_cast<int>((time.micros % Interval::MICROS_PER_DAY) / Interval::MICROS_PER_HOUR);
+		auto minute = static_cast<int>((time.micros % Interval::MICROS_PER_HOUR) / Interval::MICROS_PER_MINUTE);
+		auto second = static_cast<float>(static_cast<double>(time.micros % Interval::MICROS_PER_MINUTE) /
+		                                 static_cast<double>(Interval::MICROS_PER_SEC));
+		feature->SetField(field_idx, year, month, day, hour, minute, second, 0);
+	}
+
+	static void SetOgrFieldFromVector(OGRFeature *feature, int field_idx, const LogicalType &type, Vector &vector,
+	                                  idx_t row_idx) {
+		if (FlatVector::IsNull(vector, row_idx)) {
 			feature->SetFieldNull(field_idx);
 			return;
 		}
 		switch (type.id()) {
 		case LogicalTypeId::BOOLEAN:
-			feature->SetField(field_idx, value.GetValue<bool>());
+			feature->SetField(field_idx, FlatVector::GetData<bool>(vector)[row_idx]);
 			break;
 		case LogicalTypeId::TINYINT:
-			feature->SetField(field_idx, value.GetValue<int8_t>());
+			feature->SetField(field_idx, FlatVector::GetData<int8_t>(vector)[row_idx]);
 			break;
 		case LogicalTypeId::SMALLINT:
-			feature->SetField(field_idx, value.GetValue<int16_t>());
+			feature->SetField(field_idx, FlatVector::GetData<int16_t>(vector)[row_idx]);
 			break;
 		case LogicalTypeId::INTEGER:
-			feature->SetField(field_idx, value.GetValue<int32_t>());
+			feature->SetField(field_idx, FlatVector::GetData<int32_t>(vector)[row_idx]);
 			break;
 		case LogicalTypeId::BIGINT:
-			feature->SetField(field_idx, (GIntBig)value.GetValue<int64_t>());
+			feature->SetField(field_idx, static_cast<GIntBig>(FlatVector::GetData<int64_t>(vector)[row_idx]));
 			break;
 		case LogicalTypeId::FLOAT:
-			feature->SetField(field_idx, value.GetValue<float>());
+			feature->SetField(field_idx, FlatVector::GetData<float>(vector)[row_idx]);
 			break;
 		case LogicalTypeId::DOUBLE:
-			feature->SetField(field_idx, value.GetValue<double>());
+			feature->SetField(field_idx, FlatVector::GetData<double>(vector)[row_idx]);
 			break;
 		case LogicalTypeId::VARCHAR:
 		case LogicalTypeId::BLOB: {
-			auto str = value.GetValueUnsafe<string_t>();
+			auto str = FlatVector::GetData<string_t>(vector)[row_idx];
 			feature->SetField(field_idx, (int)str.GetSize(), str.GetDataUnsafe());
 		} break;
 		case LogicalTypeId::DATE: {
-			auto date = value.GetValueUnsafe<date_t>();
+			auto date = FlatVector::GetData<date_t>(vector)[row_idx];
 			auto year = Date::ExtractYear(date);
 			auto month = Date::ExtractMonth(date);
 			auto day = Date::ExtractDay(date);
 			feature->SetField(field_idx, year, month, day, 0, 0, 0, 0);
 		} break;
 		case LogicalTypeId::TIME: {
-			auto time = value.GetValueUnsafe<dtime_t>();
+			auto time = FlatVector::GetData<dtime_t>(vector)[row_idx];
 			auto hour = static_cast<int>(time.micros / Interval::MICROS_PER_HOUR);
 			auto minute = static_cast<int>((time.micros % Interval::MICROS_PER_HOUR) / Interval::MICROS_PER_MINUTE);
 			auto second = static_cast<float>(static_cast<double>(time.micros % Interval::MICROS_PER_MINUTE) /
 			                                 static_cast<double>(Interval::MICROS_PER_SEC));
 			feature->SetField(field_idx, 0, 0, 0, hour, minute, second, 0);
 		} break;
-		case LogicalTypeId::TIMESTAMP: {
-			auto timestamp = value.GetValueUnsafe<timestamp_t>();
-			auto date = Timestamp::GetDate(timestamp);
-			auto time = Timestamp::GetTime(timestamp);
-			auto year = Date::ExtractYear(date);
-			auto month = Date::ExtractMonth(date);
-			auto day = Date::ExtractDay(date);
-			auto hour = static_cast<int>((time.micros % Interval::MICROS_PER_DAY) / Interval::MICROS_PER_HOUR);
-			auto minute = static_cast<int>((time.micros % Interval::MICROS_PER_HOUR) / Interval::MICROS_PER_MINUTE);
-			auto second = static_cast<float>(static_cast<double>(time.micros % Interval::MICROS_PER_MINUTE) /
-			                                 static_cast<double>(Interval::MICROS_PER_SEC));
-			feature->SetField(field_idx, year, month, day, hour, minute, second, 0);
-		} break;
+		case LogicalTypeId::TIMESTAMP:
+			SetOgrDateTimeField(feature, field_idx, FlatVector::GetData<timestamp_t>(vector)[row_idx]);
+			break;
 		case LogicalTypeId::TIMESTAMP_NS: {
-			auto timestamp = value.GetValueUnsafe<timestamp_t>();
-			timestamp = Timestamp::FromEpochNanoSeconds(timestamp.value);
-			auto date = Timestamp::GetDate(timestamp);
-			auto time = Timestamp::GetTime(timestamp);
-			auto year = Date::ExtractYear(date);
-			auto month = Date::ExtractMonth(date);
-			auto day = Date::ExtractDay(date);
-			auto hour = static_cast<int>((time.micros % Interval::MICROS_PER_DAY) / Interval::MICROS_PER_HOUR);
-			auto minute = static_cast<int>((time.micros % Interval::MICROS_PER_HOUR) / Interval::MICROS_PER_MINUTE);
-			auto second = static_cast<float>(static_cast<double>(time.micros % Interval::MICROS_PER_MINUTE) /
-			                                 static_cast<double>(Interval::MICROS_PER_SEC));
-			feature->SetField(field_idx, year, month, day, hour, minute, second, 0);
+			auto timestamp = FlatVector::GetData<timestamp_t>(vector)[row_idx];
+			SetOgrDateTimeField(feature, field_idx, Timestamp::FromEpochNanoSeconds(timestamp.value));
 		} break;
 		case LogicalTypeId::TIMESTAMP_MS: {
-			auto timestamp = value.GetValueUnsafe<timestamp_t>();
-			timestamp = Timestamp::FromEpochMs(timestamp.value);
-			auto date = Timestamp::GetDate(timestamp);
-			auto time = Timestamp::GetTime(timestamp);
-			auto year = Date::ExtractYear(date);
-			auto month = Date::ExtractMonth(date);
-			auto day = Date::ExtractDay(date);
-			auto hour = static_cast<int>((time.micros % Interval::MICROS_PER_DAY) / Interval::MICROS_PER_HOUR);
-			auto minute = static_cast<int>((time.micros % Interval::MICROS_PER_HOUR) / Interval::MICROS_PER_MINUTE);
-			auto second = static_cast<float>(static_cast<double>(time.micros % Interval::MICROS_PER_MINUTE) /
-			                                 static_cast<double>(Interval::MICROS_PER_SEC));
-			feature->SetField(field_idx, year, month, day, hour, minute, second, 0);
+			auto timestamp = FlatVector::GetData<timestamp_t>(vector)[row_idx];
+			SetOgrDateTimeField(feature, field_idx, Timestamp::FromEpochMs(timestamp.value));
 		} break;
 		case LogicalTypeId::TIMESTAMP_SEC: {
-			auto timestamp = value.GetValueUnsafe<timestamp_t>();
-			timestamp = Timestamp::FromEpochSeconds(timestamp.value);
-			auto date = Timestamp::GetDate(timestamp);
-			auto time = Timestamp::GetTime(timestamp);
-			auto year = Date::ExtractYear(date);
-			auto month = Date::ExtractMonth(date);
-			auto day = Date::ExtractDay(date);
-			auto hour = static_cast<int>((time.micros % Interval::MICROS_PER_DAY) / Interval::MICROS_PER_HOUR);
-			auto minute = static_cast<int>((time.micros % Interval::MICROS_PER_HOUR) / Interval::MICROS_PER_MINUTE);
-			auto second = static_cast<float>(static_cast<double>(time.micros % Interval::MICROS_PER_MINUTE) /
-			                                 static_cast<double>(Interval::MICROS_PER_SEC));
-			feature->SetField(field_idx, year, month, day, hour, minute, second, 0);
+			auto timestamp = FlatVector::GetData<timestamp_t>(vector)[row_idx];
+			SetOgrDateTimeField(feature, field_idx, Timestamp::FromEpochSeconds(timestamp.value));
 		} break;
 		case LogicalTypeId::TIMESTAMP_TZ: {
 			// Not sure what to with the timezone, just let GDAL parse it?
-			auto timestamp = value.GetValueUnsafe<timestamp_t>();
+			auto timestamp = FlatVector::GetData<timestamp_t>(vector)[row_idx];
 			auto time_str = Timestamp::ToString(timestamp);
 			feature->SetField(field_idx, time_str.c_str());
 		} break;
@@ -1943,32 +3632,22 @@ struct ST_Write {
 		}
 	}
 
-	static void Sink(ExecutionContext &context, FunctionData &bdata, GlobalFunctionData &gstate,
-	                 LocalFunctionData &lstate, DataChunk &input) {
-
-		auto &bind_data = bdata.Cast<BindData>();
-		auto &global_state = gstate.Cast<GlobalState>();
-		auto &local_state = lstate.Cast<LocalState>();
-		local_state.arena.Reset();
-
-		lock_guard<mutex> d_lock(global_state.lock);
-		auto layer = global_state.layer;
-
-		// Create the feature
+	static void CreateFeatures(const BindData &bind_data, const GlobalState &global_state, DataChunk &input,
+	                           ArenaAllocator &arena, vector<OGRFeatureUniquePtr> &features) {
 		input.Flatten();
 		for (idx_t row_idx = 0; row_idx < input.size(); row_idx++) {
 
-			auto feature = OGRFeatureUniquePtr(OGRFeature::CreateFeature(layer->GetLayerDefn()));
+			auto feature = OGRFeatureUniquePtr(OGRFeature::CreateFeature(global_state.layer_defn));
 
 			// Geometry fields do not count towards the field index, so we need to keep track of them separately.
 			idx_t field_idx = 0;
 			for (idx_t col_idx = 0; col_idx < input.ColumnCount(); col_idx++) {
 				auto &type = bind_data.field_sql_types[col_idx];
-				auto value = input.GetValue(col_idx, row_idx);
+				auto &vector = input.data[col_idx];
 
 				if (IsGeometryType(type)) {
 					// TODO: check how many geometry fields there are and use the correct one.
-					auto geom = OGRGeometryFromValue(type, value, local_state.arena);
+					auto geom = OGRGeometryFromVector(type, vector, row_idx, arena);
 					if (geom && bind_data.geometry_type != wkbUnknown &&
 					    geom->getGeometryType() != bind_data.geometry_type) {
 						auto got_name = StringUtil::Replace(
@@ -1984,14 +3663,80 @@ struct ST_Write {
 						throw IOException("Could not set geometry");
 					}
 				} else {
-					SetOgrFieldFromValue(feature.get(), static_cast<int>(field_idx), type, value);
+					SetOgrFieldFromVector(feature.get(), static_cast<int>(field_idx), type, vector, row_idx);
 					field_idx++;
 				}
 			}
-			if (layer->CreateFeature(feature.get()) != OGRERR_NONE) {
-				throw IOException("Could not create feature");
-			}
+			features.push_back(std::move(feature));
+		}
+	}
+
+	static void Sink(ExecutionContext &context, FunctionData &bdata, GlobalFunctionData &gstate,
+	                 LocalFunctionData &lstate, DataChunk &input) {
+
+		auto &bind_data = bdata.Cast<BindData>();
+		auto &global_state = gstate.Cast<GlobalState>();
+		auto &local_state = lstate.Cast<LocalState>();
+		local_state.arena.Reset();
+
+		// Create the features
+		local_state.features.clear();
+		CreateFeatures(bind_data, global_state, input, local_state.arena, local_state.features);
+
+		// Write them
+		lock_guard<mutex> d_lock(global_state.lock);
+		for (auto &feature : local_state.features) {
+			global_state.WriteFeature(*feature);
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Batches
+	//------------------------------------------------------------------------------------------------------------------
+	// When the insertion order has to be preserved, the features of each batch are still created in parallel, and
+	// the batches are then written in order.
+
+	struct FeatureBatch final : public PreparedBatchData {
+		vector<OGRFeatureUniquePtr> features;
+	};
+
+	static unique_ptr<PreparedBatchData> PrepareBatch(ClientContext &context, FunctionData &bdata,
+	                                                  GlobalFunctionData &gstate,
+	                                                  unique_ptr<ColumnDataCollection> collection) {
+		auto &bind_data = bdata.Cast<BindData>();
+		auto &global_state = gstate.Cast<GlobalState>();
+
+		auto result = make_uniq<FeatureBatch>();
+		result->features.reserve(collection->Count());
+
+		ArenaAllocator arena(BufferAllocator::Get(context));
+		for (auto &chunk : collection->Chunks()) {
+			CreateFeatures(bind_data, global_state, chunk, arena, result->features);
+			arena.Reset();
+		}
+		return std::move(result);
+	}
+
+	static void FlushBatch(ClientContext &context, FunctionData &bdata, GlobalFunctionData &gstate,
+	                       PreparedBatchData &batch) {
+		auto &global_state = gstate.Cast<GlobalState>();
+		auto &feature_batch = batch.Cast<FeatureBatch>();
+
+		lock_guard<mutex> d_lock(global_state.lock);
+		for (auto &feature : feature_batch.features) {
+			global_state.WriteFeature(*feature);
+		}
+		feature_batch.features.clear();
+	}
+
+	static CopyFunctionExecutionMode GetExecutionMode(bool preserve_insertion_order, bool supports_batch_index) {
+		if (!preserve_insertion_order) {
+			return CopyFunctionExecutionMode::PARALLEL_COPY_TO_FILE;
+		}
+		if (supports_batch_index) {
+			return CopyFunctionExecutionMode::BATCH_COPY_TO_FILE;
 		}
+		return CopyFunctionExecutionMode::REGULAR_COPY_TO_FILE;
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
@@ -2005,7 +3750,8 @@ struct ST_Write {
 	// Finalize
 	//------------------------------------------------------------------------------------------------------------------
 	static void Finalize(ClientContext &context, FunctionData &bind_data, GlobalFunctionData &gstate) {
-		const auto &global_state = gstate.Cast<GlobalState>();
+		auto &global_state = gstate.Cast<GlobalState>();
+		global_state.CommitTransaction();
 		global_state.dataset->FlushCache();
 		global_state.dataset->Close();
 	}
@@ -2021,6 +3767,9 @@ struct ST_Write {
 		info.copy_to_sink = Sink;
 		info.copy_to_combine = Combine;
 		info.copy_to_finalize = Finalize;
+		info.execution_mode = GetExecutionMode;
+		info.prepare_batch = PrepareBatch;
+		info.flush_batch = FlushBatch;
 		info.extension = "gdal";
 		ExtensionUtil::RegisterFunction(db, info);
 	}
@@ -2032,53 +3781,6 @@ struct ST_Write {
 // Register Module
 //######################################################################################################################
 void RegisterGDALModule(DatabaseInstance &db) {
-
-	// Load GDAL (once)
-	static std::once_flag loaded;
-	std::call_once(loaded, [&]() {
-		// Register all embedded drivers (dont go looking for plugins)
-		OGRRegisterAllInternal();
-
-		// Set GDAL error handler
-		CPLSetErrorHandler([](CPLErr e, int code, const char *raw_msg) {
-			// DuckDB doesnt do warnings, so we only throw on errors
-			if (e != CE_Failure && e != CE_Fatal) {
-				return;
-			}
-
-			// If the error contains a /vsiduckdb-<uuid>/ prefix,
-			// try to strip it off to make the errors more readable
-			auto msg = string(raw_msg);
-			auto path_pos = msg.find("/vsiduckdb-");
-			if (path_pos != string::npos) {
-				// We found a path, strip it off
-				msg.erase(path_pos, 48);
-			}
-
-			switch (code) {
-			case CPLE_NoWriteAccess:
-				throw PermissionException("GDAL Error (%d): %s", code, msg);
-			case CPLE_UserInterrupt:
-				throw InterruptException();
-			case CPLE_OutOfMemory:
-				throw OutOfMemoryException("GDAL Error (%d): %s", code, msg);
-			case CPLE_NotSupported:
-				throw NotImplementedException("GDAL Error (%d): %s", code, msg);
-			case CPLE_AssertionFailed:
-			case CPLE_ObjectNull:
-				throw InternalException("GDAL Error (%d): %s", code, msg);
-			case CPLE_IllegalArg:
-				throw InvalidInputException("GDAL Error (%d): %s", code, msg);
-			case CPLE_AppDefined:
-			case CPLE_HttpResponse:
-			case CPLE_FileIO:
-			case CPLE_OpenFailed:
-			default:
-				throw IOException("GDAL Error (%d): %s", code, msg);
-			}
-		});
-	});
-
 	ST_Read::Register(db);
 	ST_Read_Meta::Register(db);
 	ST_Drivers::Register(db);
@@ -0,0 +1,523 @@
+#include "spatial/modules/geojson/geojson_module.hpp"
+#include "spatial/geometry/geojson_reader.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/spatial_types.hpp"
+
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+namespace {
+
+//######################################################################################################################
+// GeoJSON Files
+//######################################################################################################################
+//
+// Two kinds of files are supported
+//  - a FeatureCollection, a single object with a "features" array
+//  - a GeoJSON text sequence (RFC 8142) or newline delimited GeoJSON, where every feature is on its own line,
+//    optionally prefixed with a record separator
+//
+// The file is split into blocks of complete features by a cheap scan that only looks at line breaks, or for feature
+// collections, at strings and nesting. This is the only part that happens sequentially, the features in the blocks
+// are then parsed in parallel.
+//
+
+// The amount of data read from the file at once
+constexpr idx_t GEOJSON_BLOCK_SIZE = 4 * 1024 * 1024;
+constexpr char GEOJSON_RECORD_SEPARATOR = '\x1e';
+constexpr char GEOJSON_FEATURES_KEY[] = "features";
+constexpr idx_t GEOJSON_FEATURES_KEY_SIZE = sizeof(GEOJSON_FEATURES_KEY) - 1;
+
+enum class GeoJSONFileFormat : uint8_t { SEQUENCE, FEATURE_COLLECTION };
+
+// A range of bytes in a block
+struct GeoJSONSpan {
+	idx_t start;
+	idx_t end;
+};
+
+// Incrementally scans a feature collection for the spans of its features. Keeps track of the nesting depth and
+// whether we are in a string, so that the input can be fed to it in arbitrary pieces.
+class FeatureCollectionScanner {
+public:
+	// Scan the bytes [offset, size) of the buffer, adding the spans of the features that end in it
+	void Scan(const char *data, idx_t offset, idx_t size, vector<GeoJSONSpan> &features) {
+		for (auto i = offset; i < size; i++) {
+			const auto c = data[i];
+
+			if (in_string) {
+				if (escaped) {
+					escaped = false;
+				} else if (c == '\\') {
+					escaped = true;
+				} else if (c == '"') {
+					in_string = false;
+					if (key_state == KeyState::MATCHING) {
+						key_state = key_match == GEOJSON_FEATURES_KEY_SIZE ? KeyState::AFTER_KEY : KeyState::NONE;
+					}
+				} else if (key_state == KeyState::MATCHING) {
+					if (key_match < GEOJSON_FEATURES_KEY_SIZE && c == GEOJSON_FEATURES_KEY[key_match]) {
+						key_match++;
+					} else {
+						key_state = KeyState::NONE;
+					}
+				}
+				continue;
+			}
+
+			switch (c) {
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				break;
+			case '"':
+				in_string = true;
+				if (depth == 1) {
+					key_state = KeyState::MATCHING;
+					key_match = 0;
+				}
+				break;
+			case ':':
+				key_state = key_state == KeyState::AFTER_KEY ? KeyState::AFTER_COLON : KeyState::NONE;
+				break;
+			case '{':
+			case '[':
+				if (c == '[' && key_state == KeyState::AFTER_COLON) {
+					in_features = true;
+				}
+				key_state = KeyState::NONE;
+				if (in_features && depth == 2 && c == '{') {
+					feature_start = i;
+				}
+				depth++;
+				break;
+			case '}':
+			case ']':
+				key_state = KeyState::NONE;
+				if (depth == 0) {
+					throw InvalidInputException("Unexpected '%c' in GeoJSON feature collection", c);
+				}
+				depth--;
+				if (in_features && depth == 2 && c == '}') {
+					features.push_back({feature_start, i + 1});
+					feature_start = DConstants::INVALID_INDEX;
+				} else if (in_features && depth == 1) {
+					// The end of the features array, we are done
+					in_features = false;
+					finished = true;
+					return;
+				} else if (depth == 0) {
+					// The top level object closed without a features array
+					finished = true;
+					return;
+				}
+				break;
+			default:
+				key_state = KeyState::NONE;
+				break;
+			}
+		}
+	}
+
+	bool InFeatures() const {
+		return in_features;
+	}
+
+	bool Finished() const {
+		return finished;
+	}
+
+	// The start of the feature that is currently being scanned, or INVALID_INDEX if we are not in a feature
+	idx_t FeatureStart() const {
+		return feature_start;
+	}
+
+	// Move the start of the current feature, when the buffer is shifted
+	void SetFeatureStart(idx_t start) {
+		feature_start = start;
+	}
+
+private:
+	// Tracks if we are looking at a "features" key (and its ':') in the top level object
+	enum class KeyState : uint8_t { NONE, MATCHING, AFTER_KEY, AFTER_COLON };
+
+	idx_t depth = 0;
+	bool in_string = false;
+	bool escaped = false;
+	bool in_features = false;
+	bool finished = false;
+
+	KeyState key_state = KeyState::NONE;
+	idx_t key_match = 0;
+
+	idx_t feature_start = DConstants::INVALID_INDEX;
+};
+
+// A block of complete features, claimed by a single thread
+struct GeoJSONBlock {
+	vector<char> data;
+	// The features in the block. For text sequences this is a single span of complete lines.
+	vector<GeoJSONSpan> spans;
+	idx_t batch_index = 0;
+};
+
+//######################################################################################################################
+// ST_ReadGeoJSON
+//######################################################################################################################
+
+struct ST_ReadGeoJSON {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Bind
+	//------------------------------------------------------------------------------------------------------------------
+	struct GeoJSONBindData final : TableFunctionData {
+		string file_name;
+		idx_t file_size = 0;
+		GeoJSONFileFormat format = GeoJSONFileFormat::SEQUENCE;
+
+		explicit GeoJSONBindData(string file_name_p) : file_name(std::move(file_name_p)) {
+		}
+	};
+
+	// Decide if the file is a feature collection or a sequence, by checking if the first object has a "features"
+	// array. Only scans as far as needed to tell.
+	static GeoJSONFileFormat DetectFormat(FileHandle &handle, const GeoJSONBindData &data) {
+		FeatureCollectionScanner scanner;
+		vector<GeoJSONSpan> features;
+		vector<char> buffer;
+
+		idx_t offset = 0;
+		bool first = true;
+		while (offset < data.file_size) {
+			const auto size = MinValue(GEOJSON_BLOCK_SIZE, data.file_size - offset);
+			buffer.resize(size);
+			handle.Read(buffer.data(), size, offset);
+			offset += size;
+
+			idx_t start = 0;
+			if (first) {
+				while (start < size && (StringUtil::CharacterIsSpace(buffer[start]) ||
+				                        buffer[start] == GEOJSON_RECORD_SEPARATOR)) {
+					start++;
+				}
+				if (start == size) {
+					continue;
+				}
+				if (buffer[start] != '{') {
+					throw InvalidInputException("File '%s' is not a GeoJSON file", data.file_name);
+				}
+				first = false;
+			}
+
+			scanner.Scan(buffer.data(), start, size, features);
+			if (scanner.InFeatures()) {
+				return GeoJSONFileFormat::FEATURE_COLLECTION;
+			}
+			if (scanner.Finished()) {
+				return GeoJSONFileFormat::SEQUENCE;
+			}
+			features.clear();
+		}
+		// Empty, or a single incomplete object. Treat it as a sequence and let the parser report any errors.
+		return GeoJSONFileFormat::SEQUENCE;
+	}
+
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names) {
+		auto file_name = StringValue::Get(input.inputs[0]);
+		auto result = make_uniq<GeoJSONBindData>(file_name);
+
+		auto &fs = FileSystem::GetFileSystem(context);
+		auto handle = fs.OpenFile(file_name, FileFlags::FILE_FLAGS_READ);
+		result->file_size = handle->GetFileSize();
+		result->format = DetectFormat(*handle, *result);
+
+		names.push_back("properties");
+		return_types.push_back(LogicalType::JSON());
+		names.push_back("geom");
+		return_types.push_back(GeoTypes::GEOMETRY());
+
+		return std::move(result);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Init Global
+	//------------------------------------------------------------------------------------------------------------------
+	struct GeoJSONGlobalState final : GlobalTableFunctionState {
+		unique_ptr<FileHandle> handle;
+		idx_t max_threads = 1;
+
+		mutex lock;
+		// The offset of the next byte to read from the file
+		idx_t file_offset = 0;
+		// The data after the last complete feature of the previous block
+		vector<char> remainder;
+		FeatureCollectionScanner scanner;
+		idx_t next_batch = 0;
+		bool finished = false;
+
+		idx_t MaxThreads() const override {
+			return max_threads;
+		}
+
+		// Read the next block of complete features, returns false once the file has been read completely
+		bool GetNextBlock(const GeoJSONBindData &data, GeoJSONBlock &block) {
+			lock_guard<mutex> guard(lock);
+
+			block.data = std::move(remainder);
+			remainder.clear();
+			block.spans.clear();
+
+			while (block.spans.empty() && !finished) {
+				if (file_offset >= data.file_size) {
+					finished = true;
+					if (data.format == GeoJSONFileFormat::SEQUENCE && !block.data.empty()) {
+						// The last line does not need to end with a line break
+						block.spans.push_back({0, block.data.size()});
+					} else if (data.format == GeoJSONFileFormat::FEATURE_COLLECTION &&
+					           scanner.FeatureStart() != DConstants::INVALID_INDEX) {
+						throw InvalidInputException("Unexpected end of GeoJSON file '%s'", data.file_name);
+					}
+					break;
+				}
+
+				const auto scan_offset = block.data.size();
+				const auto size = MinValue(GEOJSON_BLOCK_SIZE, data.file_size - file_offset);
+				block.data.resize(scan_offset + size);
+				handle->Read(block.data.data() + scan_offset, size, file_offset);
+				file_offset += size;
+
+				if (data.format == GeoJSONFileFormat::SEQUENCE) {
+					FindLines(block, scan_offset);
+				} else {
+					FindFeatures(block, scan_offset);
+				}
+			}
+
+			if (block.spans.empty()) {
+				return false;
+			}
+			block.batch_index = next_batch++;
+			return true;
+		}
+
+		// Split off the data after the last line break (or record separator) as the remainder. The data before the
+		// newly read part never contains a line break, so only that part has to be searched.
+		void FindLines(GeoJSONBlock &block, idx_t scan_offset) {
+			auto end = block.data.size();
+			while (end > scan_offset && block.data[end - 1] != '\n' &&
+			       block.data[end - 1] != GEOJSON_RECORD_SEPARATOR) {
+				end--;
+			}
+			if (end == scan_offset) {
+				// No complete line yet, keep reading
+				return;
+			}
+			remainder.assign(block.data.begin() + static_cast<int64_t>(end), block.data.end());
+			block.data.resize(end);
+			block.spans.push_back({0, end});
+		}
+
+		// Scan the newly read data for complete features, and split off the incomplete feature as the remainder
+		void FindFeatures(GeoJSONBlock &block, idx_t scan_offset) {
+			scanner.Scan(block.data.data(), scan_offset, block.data.size(), block.spans);
+			if (scanner.Finished()) {
+				// Nothing after the features array is relevant, so stop reading
+				finished = true;
+				return;
+			}
+			if (block.spans.empty()) {
+				// No complete feature yet, keep reading
+				return;
+			}
+
+			const auto feature_start = scanner.FeatureStart();
+			if (feature_start != DConstants::INVALID_INDEX) {
+				remainder.assign(block.data.begin() + static_cast<int64_t>(feature_start), block.data.end());
+				scanner.SetFeatureStart(0);
+			}
+			block.data.resize(block.spans.back().end);
+		}
+	};
+
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+		auto &bind_data = input.bind_data->Cast<GeoJSONBindData>();
+		auto result = make_uniq<GeoJSONGlobalState>();
+
+		auto &fs = FileSystem::GetFileSystem(context);
+		result->handle = fs.OpenFile(bind_data.file_name, FileFlags::FILE_FLAGS_READ);
+
+		// Dont use more threads than there are blocks to parse
+		const auto block_count = bind_data.file_size / GEOJSON_BLOCK_SIZE + 1;
+		result->max_threads = MaxValue<idx_t>(MinValue<idx_t>(context.db->NumberOfThreads(), block_count), 1);
+		return std::move(result);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Init Local
+	//------------------------------------------------------------------------------------------------------------------
+	struct GeoJSONLocalState final : LocalTableFunctionState {
+		ArenaAllocator arena;
+		GeoJSONReader reader;
+
+		GeoJSONBlock block;
+		// The next span to read, and for text sequences, the offset of the next line in it
+		idx_t span_idx = 0;
+		idx_t line_offset = 0;
+
+		explicit GeoJSONLocalState(ClientContext &context) : arena(BufferAllocator::Get(context)), reader(arena) {
+		}
+
+		void SetBlock() {
+			span_idx = 0;
+			line_offset = block.spans.empty() ? 0 : block.spans[0].start;
+		}
+
+		// Get the next record in the block, returns false once the block is exhausted
+		bool GetNextRecord(const GeoJSONBindData &data, const char *&record, idx_t &record_size) {
+			if (data.format == GeoJSONFileFormat::FEATURE_COLLECTION) {
+				if (span_idx >= block.spans.size()) {
+					return false;
+				}
+				const auto &span = block.spans[span_idx++];
+				record = block.data.data() + span.start;
+				record_size = span.end - span.start;
+				return true;
+			}
+
+			// Text sequences, skip empty lines
+			while (span_idx < block.spans.size()) {
+				const auto span_end = block.spans[span_idx].end;
+				while (line_offset < span_end) {
+					auto line_start = line_offset;
+					auto line_end = line_start;
+					while (line_end < span_end && block.data[line_end] != '\n' &&
+					       block.data[line_end] != GEOJSON_RECORD_SEPARATOR) {
+						line_end++;
+					}
+					line_offset = line_end + 1;
+
+					while (line_start < line_end && StringUtil::CharacterIsSpace(block.data[line_start])) {
+						line_start++;
+					}
+					if (line_start < line_end) {
+						record = block.data.data() + line_start;
+						record_size = line_end - line_start;
+						return true;
+					}
+				}
+				span_idx++;
+				if (span_idx < block.spans.size()) {
+					line_offset = block.spans[span_idx].start;
+				}
+			}
+			return false;
+		}
+	};
+
+	static unique_ptr<LocalTableFunctionState> InitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+	                                                     GlobalTableFunctionState *global_state) {
+		return make_uniq<GeoJSONLocalState>(context.client);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Execute
+	//------------------------------------------------------------------------------------------------------------------
+	static void Execute(ClientContext &context, TableFunctionInput &input, DataChunk &output) {
+		auto &bind_data = input.bind_data->Cast<GeoJSONBindData>();
+		auto &gstate = input.global_state->Cast<GeoJSONGlobalState>();
+		auto &lstate = input.local_state->Cast<GeoJSONLocalState>();
+
+		lstate.arena.Reset();
+
+		auto &properties_vec = output.data[0];
+		auto &geom_vec = output.data[1];
+
+		idx_t output_idx = 0;
+		while (output_idx < STANDARD_VECTOR_SIZE) {
+			const char *record;
+			idx_t record_size;
+			if (!lstate.GetNextRecord(bind_data, record, record_size)) {
+				// Dont mix features of different blocks in the same chunk, they belong to different batches
+				if (output_idx != 0 || !gstate.GetNextBlock(bind_data, lstate.block)) {
+					break;
+				}
+				lstate.SetBlock();
+				continue;
+			}
+
+			sgl::geometry geom(sgl::geometry_type::INVALID);
+			const char *properties;
+			idx_t properties_size;
+			const auto has_geom = lstate.reader.ReadFeature(record, record_size, geom, properties, properties_size);
+
+			if (properties) {
+				FlatVector::GetData<string_t>(properties_vec)[output_idx] =
+				    StringVector::AddString(properties_vec, properties, properties_size);
+			} else {
+				FlatVector::SetNull(properties_vec, output_idx, true);
+			}
+
+			if (has_geom) {
+				const auto size = Serde::GetRequiredSize(geom);
+				auto blob = StringVector::EmptyString(geom_vec, size);
+				Serde::Serialize(geom, blob.GetDataWriteable(), size);
+				blob.Finalize();
+				FlatVector::GetData<string_t>(geom_vec)[output_idx] = blob;
+			} else {
+				FlatVector::SetNull(geom_vec, output_idx, true);
+			}
+
+			output_idx++;
+		}
+		output.SetCardinality(output_idx);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Progress and Partitioning
+	//------------------------------------------------------------------------------------------------------------------
+	static double GetProgress(ClientContext &context, const FunctionData *bind_data_p,
+	                          const GlobalTableFunctionState *global_state) {
+		auto &bind_data = bind_data_p->Cast<GeoJSONBindData>();
+		auto &gstate = global_state->Cast<GeoJSONGlobalState>();
+		if (bind_data.file_size == 0) {
+			return 100;
+		}
+		return 100 * static_cast<double>(gstate.file_offset) / static_cast<double>(bind_data.file_size);
+	}
+
+	static OperatorPartitionData GetPartitionData(ClientContext &context, TableFunctionGetPartitionInput &input) {
+		if (input.partition_info.RequiresPartitionColumns()) {
+			throw InternalException("ST_ReadGeoJSON::GetPartitionData: partition columns not supported");
+		}
+		// The blocks are claimed in file order, so their index preserves the order of the features
+		auto &lstate = input.local_state->Cast<GeoJSONLocalState>();
+		return OperatorPartitionData(lstate.block.batch_index);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		TableFunction read_func("ST_ReadGeoJSON", {LogicalType::VARCHAR}, Execute, Bind, InitGlobal, InitLocal);
+		read_func.table_scan_progress = GetProgress;
+		read_func.get_partition_data = GetPartitionData;
+		ExtensionUtil::RegisterFunction(db, read_func);
+	}
+};
+
+} // namespace
+
+//######################################################################################################################
+// Module Registration
+//######################################################################################################################
+
+void RegisterGeoJSONModule(DatabaseInstance &db) {
+	ST_ReadGeoJSON::Register(db);
+}
+
+} // namespace duckdb
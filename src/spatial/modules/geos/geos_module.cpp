@@ -1,12 +1,34 @@
 #include "spatial/modules/geos/geos_module.hpp"
+#include "spatial/geometry/geometry_type.hpp"
+#include "spatial/geometry/geometry_cursor.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/geometry/segment_index.hpp"
+#include "spatial/geometry/segment_index_cache.hpp"
+#include "spatial/util/binary_reader.hpp"
 #include "spatial/modules/geos/geos_geometry.hpp"
 #include "spatial/modules/geos/geos_serde.hpp"
+#include "spatial/operators/spatial_join_rtree.hpp"
 #include "spatial/spatial_types.hpp"
 #include "spatial/util/function_builder.hpp"
+#include "spatial/util/scratch_pool.hpp"
+#include "spatial/util/spatial_profiler.hpp"
 
+#include "duckdb/common/types/hash.hpp"
 #include "duckdb/common/vector_operations/senary_executor.hpp"
 #include "duckdb/common/vector_operations/generic_executor.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
 #include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_window_expression.hpp"
+#include "duckdb/planner/operator/logical_window.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/main/client_config.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/parallel/task_executor.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 
 namespace duckdb {
 
@@ -16,15 +38,166 @@ namespace duckdb {
 
 namespace {
 
+class LocalState;
+
+//! Prepared geometries for a non-constant argument whose values repeat, e.g. the build side of a join or the input of
+//! a LATERAL join. Only values that occur in consecutive rows are prepared, and only the most recently used are kept.
+class PreparedCache {
+public:
+	static constexpr idx_t CAPACITY = 8;
+
+	//! Returns the prepared geometry of the blob if it repeats, or nullptr
+	const PreparedGeosGeometry *TryGet(const LocalState &lstate, const string_t &blob);
+
+	//! The data pointer of the previous row is only valid within a chunk
+	void Reset() {
+		prev_ptr = nullptr;
+	}
+
+	void Clear() {
+		current = nullptr;
+		entries.clear();
+	}
+
+private:
+	struct Entry {
+		Entry(hash_t hash_p, const string_t &blob_p, GeosGeometry &&geom_p)
+		    : hash(hash_p), blob(blob_p.GetData(), blob_p.GetSize()), geom(std::move(geom_p)),
+		      prepared(geom.get_prepared()) {
+		}
+		hash_t hash;
+		string blob;
+		GeosGeometry geom;
+		PreparedGeosGeometry prepared;
+		idx_t last_used = 0;
+	};
+
+	vector<unique_ptr<Entry>> entries;
+	//! The entry of the previous row, if any
+	Entry *current = nullptr;
+	const char *prev_ptr = nullptr;
+	idx_t prev_size = 0;
+	hash_t prev_hash = 0;
+	idx_t clock = 0;
+};
+
+//! The geometries deserialized from the input vectors of the current chunk, shared by all GEOS functions of the same
+//! expression executor, so that e.g. "SELECT ST_IsValid(g), ST_IsSimple(g), ST_Envelope(g)" deserializes each
+//! geometry only once. Vectors are identified by their auxiliary (string) buffer, which is kept alive while their
+//! geometries are cached, so that the data pointers of its blobs can not be reused for other blobs in the meantime.
+class SharedGeometryCache {
+public:
+	static shared_ptr<SharedGeometryCache> Get(ExpressionState &state);
+
+	SharedGeometryCache() {
+		ctx = GEOS_init_r();
+		GEOSContext_setErrorMessageHandler_r(
+		    ctx, [](const char *message, void *) { throw InvalidInputException(message); }, nullptr);
+	}
+
+	~SharedGeometryCache() {
+		// Destroy the cached geometries before the context
+		slots.clear();
+		GEOS_finish_r(ctx);
+	}
+
+	//! The geometries cached for the vector, or nullptr if its geometries can not be cached
+	unordered_map<const char *, GeosGeometry> *GetGeometries(Vector &vector, idx_t capacity) {
+		const auto strings = vector.GetAuxiliary();
+		if (!strings) {
+			return nullptr;
+		}
+		for (auto &slot : slots) {
+			if (slot->strings == strings) {
+				slot->last_used = ++clock;
+				return &slot->geometries;
+			}
+		}
+
+		// Replace the least recently used vector, it most likely belongs to an earlier chunk
+		if (slots.size() >= capacity) {
+			idx_t lru_idx = 0;
+			for (idx_t i = 1; i < slots.size(); i++) {
+				if (slots[i]->last_used < slots[lru_idx]->last_used) {
+					lru_idx = i;
+				}
+			}
+			slots.erase(slots.begin() + static_cast<ptrdiff_t>(lru_idx));
+		}
+		auto slot = make_uniq<Slot>();
+		slot->strings = strings;
+		slot->last_used = ++clock;
+		slots.push_back(std::move(slot));
+		return &slots.back()->geometries;
+	}
+
+	GEOSContextHandle_t GetContext() const {
+		return ctx;
+	}
+
+private:
+	struct Slot {
+		buffer_ptr<VectorBuffer> strings;
+		unordered_map<const char *, GeosGeometry> geometries;
+		idx_t last_used = 0;
+	};
+
+	GEOSContextHandle_t ctx;
+	vector<unique_ptr<Slot>> slots;
+	idx_t clock = 0;
+};
+
+shared_ptr<SharedGeometryCache> SharedGeometryCache::Get(ExpressionState &state) {
+	// All functions of an executor are initialized together when it is created, on the same thread
+	static thread_local unordered_map<const void *, weak_ptr<SharedGeometryCache>> caches;
+
+	const auto &executor = state.root.executor;
+	if (!executor) {
+		return make_shared_ptr<SharedGeometryCache>();
+	}
+	const auto key = static_cast<const void *>(&*executor);
+
+	for (auto it = caches.begin(); it != caches.end();) {
+		if (it->second.expired()) {
+			it = caches.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	auto &entry = caches[key];
+	auto result = entry.lock();
+	if (!result) {
+		result = make_shared_ptr<SharedGeometryCache>();
+		entry = result;
+	}
+	return result;
+}
+
 class LocalState final : public FunctionLocalState {
 public:
 	static unique_ptr<FunctionLocalState> Init(ExpressionState &state, const BoundFunctionExpression &expr,
 	                                           FunctionData *bind_data) {
-		return make_uniq<LocalState>(state.GetContext());
+		auto result = make_uniq<LocalState>(state.GetContext());
+		result->shared_cache = SharedGeometryCache::Get(state);
+		return std::move(result);
 	}
 
 	static LocalState &ResetAndGet(ExpressionState &state) {
 		auto &local_state = ExecuteFunctionState::GetFunctionState(state)->Cast<LocalState>();
+		// The cached geometries reference blobs of the previous chunk
+		local_state.cache.clear();
+		for (auto &prepared_cache : local_state.prepared) {
+			prepared_cache.Reset();
+		}
+		for (auto &memo : local_state.indexes) {
+			memo.ptr = nullptr;
+		}
+		local_state.shared_geometries = nullptr;
+		local_state.shared_vector = nullptr;
+		if (local_state.arena) {
+			GeometryScratchPool::Reset(*local_state.arena);
+		}
 		return local_state;
 	}
 
@@ -33,10 +206,44 @@ public:
 	}
 
 	GeosGeometry Deserialize(const string_t &blob) const;
+	//! Deserialize a geometry, reusing the geometry of a blob that was already deserialized in the current chunk.
+	//! Blobs are identified by their data pointer, which repeats for repeated rows (e.g. the build side of a join)
+	const GeosGeometry &DeserializeCached(const string_t &blob) const;
+	//! Deserialize a geometry of the input vector, sharing it with the other functions of the expression executor
+	//! that take the same vector (e.g. the same column) as input. The geometry must not be modified, and is only valid
+	//! until the next call.
+	const GeosGeometry &DeserializeShared(Vector &input, const string_t &blob) const;
+	//! Get the prepared geometry of a non-constant argument, if its value repeats
+	const PreparedGeosGeometry *TryGetPrepared(idx_t arg_idx, const string_t &blob) const {
+		D_ASSERT(arg_idx < 2);
+		return prepared[arg_idx].TryGet(*this, blob);
+	}
+	//! Get the segment index of a large geometry from the database-wide cache, see SegmentIndexCache::GetIndex.
+	//! Repeated lookups of the same blob (e.g. a constant) within a chunk are answered without hashing it again
+	const SegmentIndex *TryGetIndex(idx_t arg_idx, const string_t &blob) const {
+		D_ASSERT(arg_idx < 2);
+		auto &memo = indexes[arg_idx];
+		if (memo.ptr != blob.GetData() || memo.size != blob.GetSize()) {
+			memo.ptr = blob.GetData();
+			memo.size = blob.GetSize();
+			memo.index = index_cache->GetIndex(blob, false);
+		}
+		return memo.index.get();
+	}
 	string_t Serialize(Vector &result, const GeosGeometry &geom) const;
 
-	// Most GEOS functions do not use an arena, so just use the default allocator
-	explicit LocalState(ClientContext &context) {
+	//! Get an arena for the functions that work on sgl geometries instead (e.g. to avoid a round trip through GEOS).
+	//! The arena is reset with the rest of the state at the start of every chunk.
+	ArenaAllocator &GetArena() const {
+		if (!arena) {
+			arena = make_uniq<ArenaAllocator>(pool->GetAllocator());
+		}
+		return *arena;
+	}
+
+	// Most GEOS functions do not use an arena, so it is only created on first use
+	explicit LocalState(ClientContext &context)
+	    : index_cache(SegmentIndexCache::Get(context)), pool(GeometryScratchPool::Get(context)) {
 		ctx = GEOS_init_r();
 
 		GEOSContext_setErrorMessageHandler_r(
@@ -44,14 +251,44 @@ public:
 	}
 
 	~LocalState() override {
+		// Destroy the cached geometries before the context
+		cache.clear();
+		scratch = GeosGeometry(nullptr, nullptr);
+		for (auto &prepared_cache : prepared) {
+			prepared_cache.Clear();
+		}
 		GEOS_finish_r(ctx);
 	}
 
 private:
 	GEOSContextHandle_t ctx;
+	mutable unordered_map<const char *, GeosGeometry> cache;
+	//! One prepared geometry cache per argument of a binary predicate
+	mutable PreparedCache prepared[2];
+
+	struct IndexMemo {
+		//! The data pointer of the blob is only valid within a chunk
+		const char *ptr = nullptr;
+		idx_t size = 0;
+		shared_ptr<SegmentIndex> index;
+	};
+	shared_ptr<SegmentIndexCache> index_cache;
+	mutable IndexMemo indexes[2];
+
+	shared_ptr<GeometryScratchPool> pool;
+	mutable unique_ptr<ArenaAllocator> arena;
+
+	shared_ptr<SharedGeometryCache> shared_cache;
+	//! The shared geometries of the input vector of the previous call, reset with every chunk
+	mutable const Vector *shared_vector = nullptr;
+	mutable unordered_map<const char *, GeosGeometry> *shared_geometries = nullptr;
+	//! The geometry of the previous call, if it could not be shared
+	mutable GeosGeometry scratch = GeosGeometry(nullptr, nullptr);
 };
 
 string_t LocalState::Serialize(Vector &result, const GeosGeometry &geom) const {
+	SpatialProfileScope profile(SpatialProfileCategory::GEOS_SERIALIZE);
+
 	// Get the size of the serialized geometry
 	const auto raw = geom.get_raw();
 	const auto size = GeosSerde::GetRequiredSize(ctx, raw);
@@ -69,6 +306,8 @@ string_t LocalState::Serialize(Vector &result, const GeosGeometry &geom) const {
 }
 
 GeosGeometry LocalState::Deserialize(const string_t &blob) const {
+	SpatialProfileScope profile(SpatialProfileCategory::GEOS_DESERIALIZE);
+
 	const auto blob_ptr = blob.GetData();
 	const auto blob_len = blob.GetSize();
 
@@ -81,6 +320,117 @@ GeosGeometry LocalState::Deserialize(const string_t &blob) const {
 	return GeosGeometry(ctx, geom);
 }
 
+const GeosGeometry &LocalState::DeserializeCached(const string_t &blob) const {
+	// Inlined blobs have no stable data pointer, but are too small to hold anything but an empty geometry anyway
+	D_ASSERT(!blob.IsInlined());
+
+	const auto blob_ptr = blob.GetData();
+	const auto entry = cache.find(blob_ptr);
+	if (entry != cache.end()) {
+		return entry->second;
+	}
+	return cache.emplace(blob_ptr, Deserialize(blob)).first->second;
+}
+
+const GeosGeometry &LocalState::DeserializeShared(Vector &input, const string_t &blob) const {
+	// Only worth it if another function may use the same geometries, and each of them adds at most one vector per chunk
+	const auto function_count = static_cast<idx_t>(shared_cache.use_count());
+	if (function_count > 1 && !blob.IsInlined()) {
+		if (shared_vector != &input) {
+			shared_vector = &input;
+			shared_geometries = shared_cache->GetGeometries(input, function_count);
+		}
+		if (shared_geometries) {
+			const auto entry = shared_geometries->find(blob.GetData());
+			if (entry != shared_geometries->end()) {
+				return entry->second;
+			}
+			SpatialProfileScope profile(SpatialProfileCategory::GEOS_DESERIALIZE);
+			const auto geom = GeosSerde::Deserialize(shared_cache->GetContext(), blob.GetData(), blob.GetSize());
+			if (geom == nullptr) {
+				throw InvalidInputException("Could not deserialize geometry");
+			}
+			return shared_geometries->emplace(blob.GetData(), GeosGeometry(shared_cache->GetContext(), geom))
+			    .first->second;
+		}
+	}
+	scratch = Deserialize(blob);
+	return scratch;
+}
+
+const PreparedGeosGeometry *PreparedCache::TryGet(const LocalState &lstate, const string_t &blob) {
+	// Inlined blobs have no stable data pointer, but are too small to hold anything worth preparing anyway
+	if (blob.IsInlined()) {
+		return nullptr;
+	}
+
+	const auto blob_ptr = blob.GetData();
+	const auto blob_len = blob.GetSize();
+
+	// The same blob as in the previous row, e.g. a repeated join match or the same dictionary entry
+	if (current && blob_ptr == prev_ptr && blob_len == prev_size) {
+		current->last_used = ++clock;
+		return &current->prepared;
+	}
+
+	const auto hash = Hash(blob_ptr, blob_len);
+	const auto repeats = hash == prev_hash;
+
+	prev_ptr = blob_ptr;
+	prev_size = blob_len;
+	prev_hash = hash;
+	current = nullptr;
+
+	for (auto &entry : entries) {
+		if (entry->hash == hash && entry->blob.size() == blob_len &&
+		    memcmp(entry->blob.data(), blob_ptr, blob_len) == 0) {
+			current = entry.get();
+			break;
+		}
+	}
+
+	if (!current) {
+		// Preparing a geometry that is only used once is slower than not preparing it at all
+		if (!repeats) {
+			return nullptr;
+		}
+
+		auto entry = make_uniq<Entry>(hash, blob, lstate.Deserialize(blob));
+		current = entry.get();
+
+		if (entries.size() < CAPACITY) {
+			entries.push_back(std::move(entry));
+		} else {
+			// Evict the least recently used entry
+			idx_t lru_idx = 0;
+			for (idx_t i = 1; i < entries.size(); i++) {
+				if (entries[i]->last_used < entries[lru_idx]->last_used) {
+					lru_idx = i;
+				}
+			}
+			entries[lru_idx] = std::move(entry);
+		}
+	}
+
+	current->last_used = ++clock;
+	return &current->prepared;
+}
+
+//! Aggregate states use a GEOS context per thread instead of one per state, as there can be millions of states. The
+//! states can move between threads, which is fine as GEOS geometries are not tied to the context that created them.
+GEOSContextHandle_t GetThreadContext() {
+	struct ThreadContext {
+		ThreadContext() : ctx(GEOS_init_r()) {
+		}
+		~ThreadContext() {
+			GEOS_finish_r(ctx);
+		}
+		GEOSContextHandle_t ctx;
+	};
+	static thread_local ThreadContext context;
+	return context.ctx;
+}
+
 } // namespace
 
 //------------------------------------------------------------------------------
@@ -89,9 +439,358 @@ GeosGeometry LocalState::Deserialize(const string_t &blob) const {
 
 namespace {
 
+enum class BoundsFilter : uint8_t {
+	//! The bounds don't tell anything about the result
+	NONE,
+	//! The result is false if the bounds are disjoint
+	FALSE_IF_DISJOINT,
+	//! The result is true if the bounds are disjoint
+	TRUE_IF_DISJOINT,
+};
+
+// Most predicates can only hold if the bounds of the two geometries intersect. If the bounds cached in the geometry
+// headers are disjoint, the result is known without deserializing either geometry.
+bool HaveDisjointBounds(const Box2D<float> &lhs_bounds, const string_t &rhs_blob) {
+	Box2D<float> rhs_bounds;
+	return geometry_t(rhs_blob).TryGetCachedBounds(rhs_bounds) && !lhs_bounds.Intersects(rhs_bounds);
+}
+
+bool HaveDisjointBounds(const string_t &lhs_blob, const string_t &rhs_blob) {
+	Box2D<float> lhs_bounds;
+	return geometry_t(lhs_blob).TryGetCachedBounds(lhs_bounds) && HaveDisjointBounds(lhs_bounds, rhs_blob);
+}
+
+//------------------------------------------------------------------------------
+// Native Predicates
+//------------------------------------------------------------------------------
+// Predicates between points, and between points and polygons, are evaluated directly on the serialized geometries
+// instead of building GEOS geometries. The orientation test uses the same floating point filter as GEOS, and whenever
+// GEOS would have to fall back to extended precision we give up and let GEOS evaluate the predicate instead, so the
+// results are the same.
+
+//! A point, linestring or polygon, referencing the vertex data of a serialized geometry
+struct NativeShape {
+	GeometryType type = GeometryType::POINT;
+	size_t vertex_size = 0;
+	//! The number of vertices of a point or linestring, or the number of rings of a polygon
+	uint32_t count = 0;
+	const char *ring_counts = nullptr;
+	const char *vertices = nullptr;
+
+	bool IsEmpty() const {
+		return count == 0;
+	}
+
+	PointXY<double> GetVertex(const idx_t idx) const {
+		PointXY<double> vertex;
+		memcpy(&vertex.x, vertices + idx * vertex_size, sizeof(double));
+		memcpy(&vertex.y, vertices + idx * vertex_size + sizeof(double), sizeof(double));
+		return vertex;
+	}
+
+	uint32_t GetRingCount(const idx_t ring_idx) const {
+		return Load<uint32_t>(const_data_ptr_cast(ring_counts + ring_idx * sizeof(uint32_t)));
+	}
+
+	static bool TryRead(const string_t &blob, NativeShape &shape) {
+		BinaryReader cursor(blob.GetDataUnsafe(), blob.GetSize());
+		shape.type = static_cast<GeometryType>(cursor.Read<uint8_t>());
+		if (shape.type != GeometryType::POINT && shape.type != GeometryType::LINESTRING &&
+		    shape.type != GeometryType::POLYGON) {
+			return false;
+		}
+
+		const auto props = cursor.Read<GeometryProperties>();
+		props.CheckVersion();
+		cursor.Skip(sizeof(uint16_t)); // hash
+		cursor.Skip(sizeof(uint32_t)); // padding
+
+		shape.vertex_size = props.VertexSize();
+		cursor.Skip(props.BBoxSize());
+
+		// Version 0 stores the type of the root, version 1 the number of part words instead
+		cursor.Skip(sizeof(uint32_t));
+		shape.count = cursor.Read<uint32_t>();
+
+		if (shape.type == GeometryType::POINT) {
+			// Points have a single part word, so the vertex stream of version 1 starts right after it
+			shape.vertices = cursor.Reserve(shape.count * shape.vertex_size);
+			return true;
+		}
+
+		if (shape.type == GeometryType::LINESTRING) {
+			if (props.GetVersion() != 0) {
+				// Depending on the bounding box, the vertex stream may be padded
+				const auto words_end = static_cast<size_t>(cursor.GetPtr() - cursor.GetStart());
+				cursor.Skip(GetGeometryVertexOffset(words_end) - words_end);
+			}
+			shape.vertices = cursor.Reserve(shape.count * shape.vertex_size);
+			return true;
+		}
+
+		shape.ring_counts = cursor.Reserve(shape.count * sizeof(uint32_t));
+		if (props.GetVersion() == 0) {
+			// The ring counts are padded to 8 bytes
+			if (shape.count % 2 == 1) {
+				cursor.Skip(sizeof(uint32_t));
+			}
+		} else {
+			// Skip the padding in front of the vertex stream
+			const auto words_end = static_cast<size_t>(cursor.GetPtr() - cursor.GetStart());
+			cursor.Skip(GetGeometryVertexOffset(words_end) - words_end);
+		}
+		idx_t vertex_count = 0;
+		for (uint32_t i = 0; i < shape.count; i++) {
+			vertex_count += shape.GetRingCount(i);
+		}
+		shape.vertices = cursor.Reserve(vertex_count * shape.vertex_size);
+		return true;
+	}
+};
+
+NativeLocation LocateInPolygon(const PointXY<double> &p, const NativeShape &polygon) {
+	idx_t offset = 0;
+	return LocateInRings(polygon.count, [&](uint32_t ring_idx) {
+		const auto ring_offset = offset;
+		const auto count = polygon.GetRingCount(ring_idx);
+		offset += count;
+		return LocateInRing(p, count, [&](idx_t i) { return polygon.GetVertex(ring_offset + i); });
+	});
+}
+
+enum class NativePredicate : uint8_t { INTERSECTS, CONTAINS };
+
+//! Try to evaluate a predicate without GEOS. Returns false if the geometries have to be handed to GEOS.
+bool TryExecuteNativePredicate(const NativePredicate predicate, const string_t &lhs_blob, const string_t &rhs_blob,
+                      bool &result) {
+	NativeShape lhs;
+	NativeShape rhs;
+	if (!NativeShape::TryRead(lhs_blob, lhs) || !NativeShape::TryRead(rhs_blob, rhs)) {
+		return false;
+	}
+	if (lhs.type == GeometryType::LINESTRING || rhs.type == GeometryType::LINESTRING) {
+		return false;
+	}
+
+	if (lhs.IsEmpty() || rhs.IsEmpty()) {
+		// Nothing intersects or contains an empty geometry
+		result = false;
+		return true;
+	}
+
+	if (lhs.type == GeometryType::POINT && rhs.type == GeometryType::POINT) {
+		const auto a = lhs.GetVertex(0);
+		const auto b = rhs.GetVertex(0);
+		result = a.x == b.x && a.y == b.y;
+		return true;
+	}
+
+	if (lhs.type == GeometryType::POLYGON && rhs.type == GeometryType::POLYGON) {
+		return false;
+	}
+
+	if (predicate == NativePredicate::CONTAINS && lhs.type == GeometryType::POINT) {
+		// Whether a point contains a polygon depends on whether the polygon is degenerate, leave that to GEOS
+		return false;
+	}
+
+	const auto &point = lhs.type == GeometryType::POINT ? lhs : rhs;
+	const auto &polygon = lhs.type == GeometryType::POINT ? rhs : lhs;
+
+	const auto location = LocateInPolygon(point.GetVertex(0), polygon);
+	switch (location) {
+	case NativeLocation::UNKNOWN:
+		return false;
+	case NativeLocation::INTERIOR:
+		result = true;
+		return true;
+	case NativeLocation::BOUNDARY:
+		// A polygon doesn't contain the points on its boundary
+		result = predicate == NativePredicate::INTERSECTS;
+		return true;
+	default:
+		result = false;
+		return true;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Native Distance
+//------------------------------------------------------------------------------
+// The distance between points, and between points and linestrings, is computed directly on the serialized geometries.
+// The arithmetic is the same as in GEOS' DistanceOp, so the results are identical.
+
+//! Try to compute the distance without GEOS. Returns false if the geometries have to be handed to GEOS.
+bool TryExecuteNativeDistance(const string_t &lhs_blob, const string_t &rhs_blob, double &result) {
+	NativeShape lhs;
+	NativeShape rhs;
+	if (!NativeShape::TryRead(lhs_blob, lhs) || !NativeShape::TryRead(rhs_blob, rhs)) {
+		return false;
+	}
+	// GEOS decides what the distance to an empty geometry is
+	if (lhs.IsEmpty() || rhs.IsEmpty()) {
+		return false;
+	}
+
+	if (lhs.type == GeometryType::POINT && rhs.type == GeometryType::POINT) {
+		result = PointToPointDistance(lhs.GetVertex(0), rhs.GetVertex(0));
+		return true;
+	}
+
+	const auto lhs_is_line = lhs.type == GeometryType::LINESTRING && rhs.type == GeometryType::POINT;
+	const auto rhs_is_line = rhs.type == GeometryType::LINESTRING && lhs.type == GeometryType::POINT;
+	if (!lhs_is_line && !rhs_is_line) {
+		return false;
+	}
+
+	const auto &point = lhs_is_line ? rhs : lhs;
+	const auto &line = lhs_is_line ? lhs : rhs;
+	if (line.count < 2) {
+		return false;
+	}
+
+	const auto p = point.GetVertex(0);
+	auto min_distance = std::numeric_limits<double>::infinity();
+	auto prev = line.GetVertex(0);
+	for (uint32_t i = 1; i < line.count; i++) {
+		const auto next = line.GetVertex(i);
+		const auto distance = PointToSegmentDistance(p, prev, next);
+		if (distance < min_distance) {
+			min_distance = distance;
+			if (min_distance == 0.0) {
+				break;
+			}
+		}
+		prev = next;
+	}
+	result = min_distance;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Segment Index
+//------------------------------------------------------------------------------
+// Constant geometry arguments with many vertices get a segment index at bind time, which is shared by all threads
+// evaluating the function. Points are then located in, or measured against, the constant geometry with the index
+// instead of a prepared GEOS geometry, which would have to be rebuilt for every chunk. Large geometries that are not
+// constant but repeat (e.g. reference polygons stored in a table) get their index from the database-wide cache.
+
+struct SegmentIndexBindData final : FunctionData {
+	//! The index of each of the two geometry arguments, if that argument is a large enough constant
+	shared_ptr<SegmentIndex> indexes[2];
+
+	unique_ptr<FunctionData> Copy() const override {
+		auto result = make_uniq<SegmentIndexBindData>();
+		result->indexes[0] = indexes[0];
+		result->indexes[1] = indexes[1];
+		return std::move(result);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		const auto &other = other_p.Cast<SegmentIndexBindData>();
+		return indexes[0] == other.indexes[0] && indexes[1] == other.indexes[1];
+	}
+
+	static unique_ptr<FunctionData> Bind(ClientContext &context, ScalarFunction &bound_function,
+	                                     vector<unique_ptr<Expression>> &arguments) {
+		auto result = make_uniq<SegmentIndexBindData>();
+		for (idx_t arg_idx = 0; arg_idx < 2; arg_idx++) {
+			const auto &arg = arguments[arg_idx];
+			if (!arg->IsFoldable() || arg->HasParameter()) {
+				continue;
+			}
+			// Errors are raised when the function is executed
+			Value value;
+			if (!ExpressionExecutor::TryEvaluateScalar(context, *arg, value) || value.IsNull()) {
+				continue;
+			}
+			const auto &blob_data = StringValue::Get(value);
+			const string_t blob(blob_data.c_str(), UnsafeNumericCast<uint32_t>(blob_data.size()));
+			result->indexes[arg_idx] = SegmentIndexCache::Get(context)->GetIndex(blob, true);
+		}
+		return std::move(result);
+	}
+
+	//! The segment index of a constant argument, or nullptr
+	static const SegmentIndex *Get(ExpressionState &state, const idx_t arg_idx) {
+		const auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+		if (!func_expr.bind_info) {
+			// e.g. predicates created by the spatial join optimizer
+			return nullptr;
+		}
+		return func_expr.bind_info->Cast<SegmentIndexBindData>().indexes[arg_idx].get();
+	}
+};
+
+//! Read the coordinates of a non-empty point. Returns false if the geometry is anything else
+bool TryGetPoint(const string_t &blob, PointXY<double> &result) {
+	NativeShape shape;
+	if (!NativeShape::TryRead(blob, shape) || shape.type != GeometryType::POINT || shape.IsEmpty()) {
+		return false;
+	}
+	result = shape.GetVertex(0);
+	return true;
+}
+
+//! Try to locate a point in an indexed polygonal geometry. Returns false if the geometries have to be handed to GEOS.
+bool TryLocateIndexed(const SegmentIndex &index, const string_t &point_blob, NativeLocation &result) {
+	PointXY<double> point;
+	if (!index.IsPolygonal() || !TryGetPoint(point_blob, point)) {
+		return false;
+	}
+	result = index.Locate(point);
+	return result != NativeLocation::UNKNOWN;
+}
+
+bool TryExecuteIndexedDistance(const SegmentIndex &index, const string_t &point_blob, double &result) {
+	PointXY<double> point;
+	return TryGetPoint(point_blob, point) && index.TryGetDistance(point, result);
+}
+
+// Count the time spent in a GEOS function when profiling. The nested (de)serialization is counted separately.
+scalar_function_t ProfileKernel(scalar_function_t function) {
+	return [function](DataChunk &args, ExpressionState &state, Vector &result) {
+		SpatialProfileScope profile(SpatialProfileCategory::GEOS_KERNEL);
+		function(args, state, result);
+	};
+}
+
 template <class IMPL, class RETURN_TYPE = bool>
 class SymmetricPreparedBinaryFunction {
 public:
+	//! What the cached bounds of the geometries tell about the result. Implementations can opt in to this
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::NONE;
+
+	//! Try to evaluate the predicate without building GEOS geometries. Returns false if GEOS is needed
+	static bool TryExecuteNative(const string_t &lhs_blob, const string_t &rhs_blob, RETURN_TYPE &result) {
+		return false;
+	}
+
+	//! Whether the implementation evaluates points against segment indexes, see TryExecuteIndexed
+	static constexpr bool USE_SEGMENT_INDEX = false;
+
+	//! Try to evaluate the predicate with the segment index of the other argument. Returns false if GEOS is needed
+	static bool TryExecuteIndexed(const SegmentIndex &index, const string_t &probe_blob, RETURN_TYPE &result) {
+		return false;
+	}
+
+	//! Try to evaluate the predicate with the cached segment index of one of the geometries, if the other is a point
+	static bool TryExecuteCached(const LocalState &lstate, const string_t &lhs_blob, const string_t &rhs_blob,
+	                             RETURN_TYPE &result) {
+		if (!IMPL::USE_SEGMENT_INDEX) {
+			return false;
+		}
+		if (geometry_t(rhs_blob).GetType() == GeometryType::POINT) {
+			const auto index = lstate.TryGetIndex(0, lhs_blob);
+			return index && IMPL::TryExecuteIndexed(*index, rhs_blob, result);
+		}
+		if (geometry_t(lhs_blob).GetType() == GeometryType::POINT) {
+			const auto index = lstate.TryGetIndex(1, rhs_blob);
+			return index && IMPL::TryExecuteIndexed(*index, lhs_blob, result);
+		}
+		return false;
+	}
+
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
@@ -108,6 +807,13 @@ public:
 			result.SetVectorType(VectorType::CONSTANT_VECTOR);
 			const auto &lhs_blob = ConstantVector::GetData<string_t>(lhs_vec)[0];
 			const auto &rhs_blob = ConstantVector::GetData<string_t>(rhs_vec)[0];
+			if (IMPL::BOUNDS_FILTER != BoundsFilter::NONE && HaveDisjointBounds(lhs_blob, rhs_blob)) {
+				ConstantVector::GetData<RETURN_TYPE>(result)[0] = IMPL::BOUNDS_FILTER == BoundsFilter::TRUE_IF_DISJOINT;
+				return;
+			}
+			if (IMPL::TryExecuteNative(lhs_blob, rhs_blob, ConstantVector::GetData<RETURN_TYPE>(result)[0])) {
+				return;
+			}
 			const auto lhs_geom = lstate.Deserialize(lhs_blob);
 			const auto rhs_geom = lstate.Deserialize(rhs_blob);
 			ConstantVector::GetData<RETURN_TYPE>(result)[0] = IMPL::ExecutePredicateNormal(lhs_geom, rhs_geom);
@@ -118,20 +824,78 @@ public:
 			auto &probe_vec = lhs_is_const ? rhs_vec : lhs_vec;
 
 			const auto &const_blob = ConstantVector::GetData<string_t>(const_vec)[0];
-			const auto const_geom = lstate.Deserialize(const_blob);
-			const auto const_prep = const_geom.get_prepared();
+			const auto const_idx = lhs_is_const ? 0 : 1;
+			auto index = SegmentIndexBindData::Get(state, const_idx);
+			if (!index && IMPL::USE_SEGMENT_INDEX) {
+				index = lstate.TryGetIndex(const_idx, const_blob);
+			}
+
+			// Only prepare the const geometry once a probe needs it
+			unique_ptr<GeosGeometry> const_geom;
+			unique_ptr<PreparedGeosGeometry> const_prep;
+			const auto get_prepared = [&]() -> const PreparedGeosGeometry & {
+				if (!const_prep) {
+					const_geom = make_uniq<GeosGeometry>(lstate.Deserialize(const_blob));
+					const_prep = make_uniq<PreparedGeosGeometry>(const_geom->get_prepared());
+				}
+				return *const_prep;
+			};
+
+			Box2D<float> const_bounds;
+			const auto check_bounds =
+			    IMPL::BOUNDS_FILTER != BoundsFilter::NONE && geometry_t(const_blob).TryGetCachedBounds(const_bounds);
+
+			// The prepared geometry is faster for anything but a constant point
+			const auto try_native = geometry_t(const_blob).GetType() == GeometryType::POINT;
 
 			UnaryExecutor::Execute<string_t, RETURN_TYPE>(
 			    probe_vec, result, args.size(), [&](const string_t &probe_blob) {
+				    if (check_bounds && HaveDisjointBounds(const_bounds, probe_blob)) {
+					    return RETURN_TYPE(IMPL::BOUNDS_FILTER == BoundsFilter::TRUE_IF_DISJOINT);
+				    }
+				    RETURN_TYPE native_result;
+				    if (index && IMPL::TryExecuteIndexed(*index, probe_blob, native_result)) {
+					    return native_result;
+				    }
+				    if (try_native && IMPL::TryExecuteNative(const_blob, probe_blob, native_result)) {
+					    return native_result;
+				    }
 				    const auto probe_geom = lstate.Deserialize(probe_blob);
-				    return IMPL::ExecutePredicatePrepared(const_prep, probe_geom);
+				    return IMPL::ExecutePredicatePrepared(get_prepared(), probe_geom);
 			    });
 		} else {
 			// Both are non-const, just execute normally
 			BinaryExecutor::Execute<string_t, string_t, RETURN_TYPE>(
 			    lhs_vec, rhs_vec, result, args.size(), [&](const string_t &lhs_blob, const string_t &rhs_blob) {
-				    const auto lhs = lstate.Deserialize(lhs_blob);
-				    const auto rhs = lstate.Deserialize(rhs_blob);
+				    if (IMPL::BOUNDS_FILTER != BoundsFilter::NONE && HaveDisjointBounds(lhs_blob, rhs_blob)) {
+					    return RETURN_TYPE(IMPL::BOUNDS_FILTER == BoundsFilter::TRUE_IF_DISJOINT);
+				    }
+				    RETURN_TYPE native_result;
+				    if (TryExecuteCached(lstate, lhs_blob, rhs_blob, native_result)) {
+					    return native_result;
+				    }
+				    if (IMPL::TryExecuteNative(lhs_blob, rhs_blob, native_result)) {
+					    return native_result;
+				    }
+				    // The predicate is symmetric, so either side can be prepared if it repeats
+				    const auto lhs_prep = lstate.TryGetPrepared(0, lhs_blob);
+				    if (lhs_prep) {
+					    const auto rhs = lstate.Deserialize(rhs_blob);
+					    return IMPL::ExecutePredicatePrepared(*lhs_prep, rhs);
+				    }
+				    const auto rhs_prep = lstate.TryGetPrepared(1, rhs_blob);
+				    if (rhs_prep) {
+					    const auto lhs = lstate.Deserialize(lhs_blob);
+					    return IMPL::ExecutePredicatePrepared(*rhs_prep, lhs);
+				    }
+				    if (lhs_blob.IsInlined() || rhs_blob.IsInlined()) {
+					    const auto lhs = lstate.Deserialize(lhs_blob);
+					    const auto rhs = lstate.Deserialize(rhs_blob);
+					    return IMPL::ExecutePredicateNormal(lhs, rhs);
+				    }
+				    // Join results repeat the same geometries many times, so only deserialize them once per chunk
+				    const auto &lhs = lstate.DeserializeCached(lhs_blob);
+				    const auto &rhs = lstate.DeserializeCached(rhs_blob);
 				    return IMPL::ExecutePredicateNormal(lhs, rhs);
 			    });
 		}
@@ -141,6 +905,47 @@ public:
 template <class IMPL, class RETURN_TYPE = bool>
 class AsymmetricPreparedBinaryFunction {
 public:
+	//! Defaults to no bounds filter, like SymmetricPreparedBinaryFunction::BOUNDS_FILTER
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::NONE;
+
+	//! Defaults to GEOS, like SymmetricPreparedBinaryFunction::TryExecuteNative
+	static bool TryExecuteNative(const string_t &lhs_blob, const string_t &rhs_blob, RETURN_TYPE &result) {
+		return false;
+	}
+
+	//! Whether the implementation evaluates points against segment indexes, see TryExecuteIndexedLeft/Right
+	static constexpr bool USE_SEGMENT_INDEX = false;
+
+	//! Try to evaluate the predicate with the segment index of the left argument. Returns false if GEOS is needed
+	static bool TryExecuteIndexedLeft(const SegmentIndex &lhs_index, const string_t &rhs_blob, RETURN_TYPE &result) {
+		return false;
+	}
+
+	//! Try to evaluate the predicate with the segment index of the right argument. Returns false if GEOS is needed
+	static bool TryExecuteIndexedRight(const string_t &lhs_blob, const SegmentIndex &rhs_index, RETURN_TYPE &result) {
+		return false;
+	}
+
+	//! Try to evaluate the predicate with the segment index of one of the geometries, if the other is a point. The
+	//! index of the right geometry is given if it is an indexed constant, otherwise the indexes come from the cache.
+	static bool TryExecuteCached(const LocalState &lstate, const SegmentIndex *rhs_index, const string_t &lhs_blob,
+	                             const string_t &rhs_blob, RETURN_TYPE &result) {
+		if (!IMPL::USE_SEGMENT_INDEX) {
+			return false;
+		}
+		if (geometry_t(rhs_blob).GetType() == GeometryType::POINT) {
+			const auto lhs_index = lstate.TryGetIndex(0, lhs_blob);
+			return lhs_index && IMPL::TryExecuteIndexedLeft(*lhs_index, rhs_blob, result);
+		}
+		if (geometry_t(lhs_blob).GetType() == GeometryType::POINT) {
+			if (!rhs_index) {
+				rhs_index = lstate.TryGetIndex(1, rhs_blob);
+			}
+			return rhs_index && IMPL::TryExecuteIndexedRight(lhs_blob, *rhs_index, result);
+		}
+		return false;
+	}
+
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
@@ -157,6 +962,13 @@ public:
 			result.SetVectorType(VectorType::CONSTANT_VECTOR);
 			const auto &lhs_blob = ConstantVector::GetData<string_t>(lhs_vec)[0];
 			const auto &rhs_blob = ConstantVector::GetData<string_t>(rhs_vec)[0];
+			if (IMPL::BOUNDS_FILTER != BoundsFilter::NONE && HaveDisjointBounds(lhs_blob, rhs_blob)) {
+				ConstantVector::GetData<RETURN_TYPE>(result)[0] = IMPL::BOUNDS_FILTER == BoundsFilter::TRUE_IF_DISJOINT;
+				return;
+			}
+			if (IMPL::TryExecuteNative(lhs_blob, rhs_blob, ConstantVector::GetData<RETURN_TYPE>(result)[0])) {
+				return;
+			}
 			const auto lhs_geom = lstate.Deserialize(lhs_blob);
 			const auto rhs_geom = lstate.Deserialize(rhs_blob);
 			ConstantVector::GetData<RETURN_TYPE>(result)[0] = IMPL::ExecutePredicateNormal(lhs_geom, rhs_geom);
@@ -165,19 +977,73 @@ public:
 			// Prepare the left const and run on the non-const right
 			// Because this predicate is not symmetric, we can't just swap the two, so we only prepare the left
 			const auto lhs_blob = ConstantVector::GetData<string_t>(lhs_vec)[0];
-			const auto lhs_geom = lstate.Deserialize(lhs_blob);
-			const auto lhs_prep = lhs_geom.get_prepared();
+			auto lhs_index = SegmentIndexBindData::Get(state, 0);
+			if (!lhs_index && IMPL::USE_SEGMENT_INDEX) {
+				lhs_index = lstate.TryGetIndex(0, lhs_blob);
+			}
+
+			// Only prepare the left geometry once a probe needs it
+			unique_ptr<GeosGeometry> lhs_geom;
+			unique_ptr<PreparedGeosGeometry> lhs_prep;
+			const auto get_prepared = [&]() -> const PreparedGeosGeometry & {
+				if (!lhs_prep) {
+					lhs_geom = make_uniq<GeosGeometry>(lstate.Deserialize(lhs_blob));
+					lhs_prep = make_uniq<PreparedGeosGeometry>(lhs_geom->get_prepared());
+				}
+				return *lhs_prep;
+			};
+
+			Box2D<float> lhs_bounds;
+			const auto check_bounds =
+			    IMPL::BOUNDS_FILTER != BoundsFilter::NONE && geometry_t(lhs_blob).TryGetCachedBounds(lhs_bounds);
+
+			// The prepared geometry is faster for anything but a constant point
+			const auto try_native = geometry_t(lhs_blob).GetType() == GeometryType::POINT;
 
 			UnaryExecutor::Execute<string_t, RETURN_TYPE>(rhs_vec, result, args.size(), [&](const string_t &rhs_blob) {
+				if (check_bounds && HaveDisjointBounds(lhs_bounds, rhs_blob)) {
+					return RETURN_TYPE(IMPL::BOUNDS_FILTER == BoundsFilter::TRUE_IF_DISJOINT);
+				}
+				RETURN_TYPE native_result;
+				if (lhs_index && IMPL::TryExecuteIndexedLeft(*lhs_index, rhs_blob, native_result)) {
+					return native_result;
+				}
+				if (try_native && IMPL::TryExecuteNative(lhs_blob, rhs_blob, native_result)) {
+					return native_result;
+				}
 				const auto rhs_geom = lstate.Deserialize(rhs_blob);
-				return IMPL::ExecutePredicatePrepared(lhs_prep, rhs_geom);
+				return IMPL::ExecutePredicatePrepared(get_prepared(), rhs_geom);
 			});
 		} else {
-			// Both are non-const, just execute normally
+			// The left side is non-const, only a const right side can be indexed
+			const auto rhs_index = rhs_is_const ? SegmentIndexBindData::Get(state, 1) : nullptr;
+
 			BinaryExecutor::Execute<string_t, string_t, RETURN_TYPE>(
 			    lhs_vec, rhs_vec, result, args.size(), [&](const string_t &lhs_blob, const string_t &rhs_blob) {
-				    const auto lhs = lstate.Deserialize(lhs_blob);
-				    const auto rhs = lstate.Deserialize(rhs_blob);
+				    if (IMPL::BOUNDS_FILTER != BoundsFilter::NONE && HaveDisjointBounds(lhs_blob, rhs_blob)) {
+					    return RETURN_TYPE(IMPL::BOUNDS_FILTER == BoundsFilter::TRUE_IF_DISJOINT);
+				    }
+				    RETURN_TYPE native_result;
+				    if (TryExecuteCached(lstate, rhs_index, lhs_blob, rhs_blob, native_result)) {
+					    return native_result;
+				    }
+				    if (IMPL::TryExecuteNative(lhs_blob, rhs_blob, native_result)) {
+					    return native_result;
+				    }
+				    // Only the left side can be prepared, as the predicate is not symmetric
+				    const auto lhs_prep = lstate.TryGetPrepared(0, lhs_blob);
+				    if (lhs_prep) {
+					    const auto rhs = lstate.Deserialize(rhs_blob);
+					    return IMPL::ExecutePredicatePrepared(*lhs_prep, rhs);
+				    }
+				    if (lhs_blob.IsInlined() || rhs_blob.IsInlined()) {
+					    const auto lhs = lstate.Deserialize(lhs_blob);
+					    const auto rhs = lstate.Deserialize(rhs_blob);
+					    return IMPL::ExecutePredicateNormal(lhs, rhs);
+				    }
+				    // Join results repeat the same geometries many times, so only deserialize them once per chunk
+				    const auto &lhs = lstate.DeserializeCached(lhs_blob);
+				    const auto &rhs = lstate.DeserializeCached(rhs_blob);
 				    return IMPL::ExecutePredicateNormal(lhs, rhs);
 			    });
 		}
@@ -198,7 +1064,7 @@ struct ST_Boundary {
 
 		UnaryExecutor::ExecuteWithNulls<string_t, string_t>(
 		    args.data[0], result, args.size(), [&](const string_t &geom_blob, ValidityMask &mask, idx_t row_idx) {
-			    const auto geom = lstate.Deserialize(geom_blob);
+			    const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			    if (geom.type() == GEOS_GEOMETRYCOLLECTION) {
 				    mask.SetInvalid(row_idx);
 				    return string_t {};
@@ -216,7 +1082,7 @@ struct ST_Boundary {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the \"boundary\" of a geometry");
@@ -228,26 +1094,104 @@ struct ST_Boundary {
 
 struct ST_Buffer {
 
+	//! The vertices of a unit circle with 4 * quad_segs segments, computed the same way as GEOS buffers a point with
+	//! round caps: clockwise, starting on the positive x axis
+	class CircleTable {
+	public:
+		static constexpr int32_t MAX_QUAD_SEGS = 1024;
+
+		void Init(const int32_t quad_segs_p) {
+			D_ASSERT(quad_segs_p > 0 && quad_segs_p <= MAX_QUAD_SEGS);
+			if (quad_segs == quad_segs_p) {
+				return;
+			}
+			quad_segs = quad_segs_p;
+
+			const auto total_angle = 2.0 * PI;
+			const auto angle_quantum = PI / 2.0 / quad_segs;
+			const auto count = static_cast<int32_t>(total_angle / angle_quantum + 0.5);
+			const auto angle_inc = total_angle / count;
+
+			cos_table.resize(count);
+			sin_table.resize(count);
+			for (int32_t i = 0; i < count; i++) {
+				const auto angle = -i * angle_inc;
+				cos_table[i] = std::cos(angle);
+				sin_table[i] = std::sin(angle);
+			}
+		}
+
+		idx_t Count() const {
+			return cos_table.size();
+		}
+
+		vector<double> cos_table;
+		vector<double> sin_table;
+
+	private:
+		int32_t quad_segs = 0;
+	};
+
+	//! Buffer a non-empty point without GEOS, which is a regular polygon around it. Returns false if GEOS is needed
+	static bool TryBufferPoint(const LocalState &lstate, CircleTable &table, const string_t &blob, double radius,
+	                           int32_t quad_segs, Vector &result, string_t &buffer) {
+		PointXY<double> center;
+		if (!(radius > 0) || quad_segs < 1 || quad_segs > CircleTable::MAX_QUAD_SEGS || !TryGetPoint(blob, center)) {
+			return false;
+		}
+		table.Init(quad_segs);
+
+		// Write the ring, and close it again
+		const auto count = table.Count();
+		const auto size = (count + 1) * 2 * sizeof(double);
+		const auto vertices = reinterpret_cast<double *>(lstate.GetArena().AllocateAligned(size));
+		for (idx_t i = 0; i < count; i++) {
+			vertices[i * 2] = center.x + radius * table.cos_table[i];
+			vertices[i * 2 + 1] = center.y + radius * table.sin_table[i];
+		}
+		vertices[count * 2] = vertices[0];
+		vertices[count * 2 + 1] = vertices[1];
+
+		sgl::geometry ring(sgl::geometry_type::LINESTRING, false, false);
+		ring.set_vertex_data(reinterpret_cast<const char *>(vertices), UnsafeNumericCast<uint32_t>(count + 1));
+		sgl::geometry poly(sgl::geometry_type::POLYGON, false, false);
+		poly.append_part(&ring);
+
+		const auto blob_size = Serde::GetRequiredSize(poly);
+		buffer = StringVector::EmptyString(result, blob_size);
+		Serde::Serialize(poly, buffer.GetDataWriteable(), blob_size);
+		buffer.Finalize();
+		return true;
+	}
+
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
-		BinaryExecutor::Execute<string_t, double, string_t>(args.data[0], args.data[1], result, args.size(),
-		                                                    [&](const string_t &blob, double radius) {
-			                                                    const auto geom = lstate.Deserialize(blob);
-			                                                    const auto buffer = geom.get_buffer(radius, 8);
-			                                                    return lstate.Serialize(result, buffer);
-		                                                    });
+		CircleTable table;
+		BinaryExecutor::Execute<string_t, double, string_t>(
+		    args.data[0], args.data[1], result, args.size(), [&](const string_t &blob, double radius) {
+			    string_t buffer;
+			    if (TryBufferPoint(lstate, table, blob, radius, 8, result, buffer)) {
+				    return buffer;
+			    }
+			    const auto geom = lstate.Deserialize(blob);
+			    return lstate.Serialize(result, geom.get_buffer(radius, 8));
+		    });
 	}
 
 	static void ExecuteWithSegments(DataChunk &args, ExpressionState &state, Vector &result) {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
+		CircleTable table;
 		TernaryExecutor::Execute<string_t, double, int32_t, string_t>(
 		    args.data[0], args.data[1], args.data[2], result, args.size(),
 		    [&](const string_t &blob, double radius, int32_t segments) {
+			    string_t buffer;
+			    if (TryBufferPoint(lstate, table, blob, radius, segments, result, buffer)) {
+				    return buffer;
+			    }
 			    const auto geom = lstate.Deserialize(blob);
-			    const auto buffer = geom.get_buffer(radius, segments);
-			    return lstate.Serialize(result, buffer);
+			    return lstate.Serialize(result, geom.get_buffer(radius, segments));
 		    });
 	}
 
@@ -315,7 +1259,7 @@ struct ST_Buffer {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
@@ -325,7 +1269,7 @@ struct ST_Buffer {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(ExecuteWithSegments);
+				variant.SetFunction(ProfileKernel(ExecuteWithSegments));
 			});
 
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
@@ -338,7 +1282,7 @@ struct ST_Buffer {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(ExecuteWithStyle);
+				variant.SetFunction(ProfileKernel(ExecuteWithStyle));
 			});
 
 			func.SetDescription(DESCRIPTION);
@@ -355,7 +1299,7 @@ struct ST_BuildArea {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto area = geom.get_built_area();
 			return lstate.Serialize(result, area);
 		});
@@ -373,7 +1317,7 @@ struct ST_BuildArea {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(DESCRIPTION);
@@ -384,6 +1328,23 @@ struct ST_BuildArea {
 };
 
 struct ST_Contains : AsymmetricPreparedBinaryFunction<ST_Contains> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+	static constexpr bool USE_SEGMENT_INDEX = true;
+
+	static bool TryExecuteNative(const string_t &lhs_blob, const string_t &rhs_blob, bool &result) {
+		return TryExecuteNativePredicate(NativePredicate::CONTAINS, lhs_blob, rhs_blob, result);
+	}
+
+	static bool TryExecuteIndexedLeft(const SegmentIndex &lhs_index, const string_t &rhs_blob, bool &result) {
+		NativeLocation location;
+		if (TryLocateIndexed(lhs_index, rhs_blob, location)) {
+			// A polygon doesn't contain the points on its boundary
+			result = location == NativeLocation::INTERIOR;
+			return true;
+		}
+		return false;
+	}
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.contains(rhs);
 	}
@@ -398,8 +1359,9 @@ struct ST_Contains : AsymmetricPreparedBinaryFunction<ST_Contains> {
 				variant.AddParameter("geom2", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
+				variant.SetBind(SegmentIndexBindData::Bind);
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(R"(
@@ -415,6 +1377,8 @@ struct ST_Contains : AsymmetricPreparedBinaryFunction<ST_Contains> {
 };
 
 struct ST_ContainsProperly : AsymmetricPreparedBinaryFunction<ST_ContainsProperly> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		// We have no choice but to prepare the left geometry
 		const auto lhs_prep = lhs.get_prepared();
@@ -433,7 +1397,7 @@ struct ST_ContainsProperly : AsymmetricPreparedBinaryFunction<ST_ContainsProperl
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(R"(
@@ -449,6 +1413,8 @@ struct ST_ContainsProperly : AsymmetricPreparedBinaryFunction<ST_ContainsProperl
 };
 
 struct ST_WithinProperly : AsymmetricPreparedBinaryFunction<ST_WithinProperly> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		// We have no choice but to prepare the right geometry
 		const auto rhs_prep = rhs.get_prepared();
@@ -467,7 +1433,7 @@ struct ST_WithinProperly : AsymmetricPreparedBinaryFunction<ST_WithinProperly> {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(R"(
@@ -488,7 +1454,7 @@ struct ST_ConcaveHull {
 		TernaryExecutor::Execute<string_t, double, bool, string_t>(
 		    args.data[0], args.data[1], args.data[2], result, args.size(),
 		    [&](const string_t &geom_blob, const double ratio, const bool allowHoles) {
-			    const auto geom = lstate.Deserialize(geom_blob);
+			    const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			    const auto hull = geom.get_concave_hull(ratio, allowHoles);
 			    return lstate.Serialize(result, hull);
 		    });
@@ -503,7 +1469,7 @@ struct ST_ConcaveHull {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(
@@ -522,7 +1488,7 @@ struct ST_ConvexHull {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto hull = geom.get_convex_hull();
 			return lstate.Serialize(result, hull);
 		});
@@ -535,7 +1501,7 @@ struct ST_ConvexHull {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the convex hull enclosing the geometry");
@@ -614,7 +1580,7 @@ struct ST_CoverageInvalidEdges {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
@@ -623,7 +1589,7 @@ struct ST_CoverageInvalidEdges {
 
 				variant.SetInit(LocalState::Init);
 				variant.SetBind(Bind);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(R"(
@@ -700,7 +1666,7 @@ struct ST_CoverageSimplify {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
@@ -710,7 +1676,7 @@ struct ST_CoverageSimplify {
 
 				variant.SetInit(LocalState::Init);
 				variant.SetBind(Bind);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(R"(
@@ -774,7 +1740,7 @@ struct ST_CoverageUnion {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(R"(
@@ -788,6 +1754,8 @@ struct ST_CoverageUnion {
 };
 
 struct ST_CoveredBy : AsymmetricPreparedBinaryFunction<ST_CoveredBy> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.covered_by(rhs);
 	}
@@ -802,7 +1770,7 @@ struct ST_CoveredBy : AsymmetricPreparedBinaryFunction<ST_CoveredBy> {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if geom1 is \"covered by\" geom2");
@@ -813,6 +1781,8 @@ struct ST_CoveredBy : AsymmetricPreparedBinaryFunction<ST_CoveredBy> {
 };
 
 struct ST_Covers : AsymmetricPreparedBinaryFunction<ST_Covers> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.covers(rhs);
 	}
@@ -827,7 +1797,7 @@ struct ST_Covers : AsymmetricPreparedBinaryFunction<ST_Covers> {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the geom1 \"covers\" geom2");
@@ -838,6 +1808,8 @@ struct ST_Covers : AsymmetricPreparedBinaryFunction<ST_Covers> {
 };
 
 struct ST_Crosses : SymmetricPreparedBinaryFunction<ST_Crosses> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.crosses(rhs);
 	}
@@ -852,7 +1824,7 @@ struct ST_Crosses : SymmetricPreparedBinaryFunction<ST_Crosses> {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if geom1 \"crosses\" geom2");
@@ -883,7 +1855,7 @@ struct ST_Difference {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the \"difference\" between two geometries");
@@ -894,6 +1866,26 @@ struct ST_Difference {
 };
 
 struct ST_Disjoint : SymmetricPreparedBinaryFunction<ST_Disjoint> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::TRUE_IF_DISJOINT;
+	static constexpr bool USE_SEGMENT_INDEX = true;
+
+	static bool TryExecuteNative(const string_t &lhs_blob, const string_t &rhs_blob, bool &result) {
+		if (TryExecuteNativePredicate(NativePredicate::INTERSECTS, lhs_blob, rhs_blob, result)) {
+			result = !result;
+			return true;
+		}
+		return false;
+	}
+
+	static bool TryExecuteIndexed(const SegmentIndex &index, const string_t &probe_blob, bool &result) {
+		NativeLocation location;
+		if (TryLocateIndexed(index, probe_blob, location)) {
+			result = location == NativeLocation::EXTERIOR;
+			return true;
+		}
+		return false;
+	}
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.disjoint(rhs);
 	}
@@ -907,8 +1899,9 @@ struct ST_Disjoint : SymmetricPreparedBinaryFunction<ST_Disjoint> {
 				variant.AddParameter("geom2", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
+				variant.SetBind(SegmentIndexBindData::Bind);
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the geometries are disjoint");
@@ -919,6 +1912,14 @@ struct ST_Disjoint : SymmetricPreparedBinaryFunction<ST_Disjoint> {
 };
 
 struct ST_Distance : SymmetricPreparedBinaryFunction<ST_Distance, double> {
+	static constexpr bool USE_SEGMENT_INDEX = true;
+
+	static bool TryExecuteNative(const string_t &lhs_blob, const string_t &rhs_blob, double &result) {
+		return TryExecuteNativeDistance(lhs_blob, rhs_blob, result);
+	}
+	static bool TryExecuteIndexed(const SegmentIndex &index, const string_t &probe_blob, double &result) {
+		return TryExecuteIndexedDistance(index, probe_blob, result);
+	}
 	static double ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.distance_to(rhs);
 	}
@@ -932,8 +1933,9 @@ struct ST_Distance : SymmetricPreparedBinaryFunction<ST_Distance, double> {
 				variant.AddParameter("geom2", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::DOUBLE);
 
+				variant.SetBind(SegmentIndexBindData::Bind);
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the planar distance between two geometries");
@@ -945,6 +1947,42 @@ struct ST_Distance : SymmetricPreparedBinaryFunction<ST_Distance, double> {
 
 struct ST_DistanceWithin {
 
+	//! Relative slack for comparing squared distances computed from the bounds
+	static constexpr double BOUNDS_DISTANCE_SLACK = 1e-9;
+
+	//! Try to decide the predicate from the cached bounds alone. The cached bounds enclose the geometries, so the
+	//! distance between the geometries lies between the smallest and largest distance between the bounds.
+	static bool TryExecuteBounds(const Box2D<float> &lhs, const string_t &rhs_blob, const double distance,
+	                             bool &result) {
+		Box2D<float> rhs;
+		if (!geometry_t(rhs_blob).TryGetCachedBounds(rhs)) {
+			return false;
+		}
+
+		const auto min_dx = std::max(0.0, std::max<double>(lhs.min.x - rhs.max.x, rhs.min.x - lhs.max.x));
+		const auto min_dy = std::max(0.0, std::max<double>(lhs.min.y - rhs.max.y, rhs.min.y - lhs.max.y));
+		const auto max_dx = std::max<double>(lhs.max.x - rhs.min.x, rhs.max.x - lhs.min.x);
+		const auto max_dy = std::max<double>(lhs.max.y - rhs.min.y, rhs.max.y - lhs.min.y);
+
+		// Only decide with some margin to the rounding of the squared distances, the exact check is done by GEOS
+		const auto distance_sq = distance * distance;
+		if (distance < 0 || min_dx * min_dx + min_dy * min_dy > distance_sq * (1 + BOUNDS_DISTANCE_SLACK)) {
+			result = false;
+			return true;
+		}
+		if (max_dx * max_dx + max_dy * max_dy < distance_sq * (1 - BOUNDS_DISTANCE_SLACK)) {
+			result = true;
+			return true;
+		}
+		return false;
+	}
+
+	static bool TryExecuteBounds(const string_t &lhs_blob, const string_t &rhs_blob, const double distance,
+	                             bool &result) {
+		Box2D<float> lhs;
+		return geometry_t(lhs_blob).TryGetCachedBounds(lhs) && TryExecuteBounds(lhs, rhs_blob, distance, result);
+	}
+
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		// Because this takes an extra argument, we cant reuse the SymmetricPreparedBinary...
 
@@ -967,6 +2005,9 @@ struct ST_DistanceWithin {
 			const auto &lhs_blob = ConstantVector::GetData<string_t>(lhs_vec)[0];
 			const auto &rhs_blob = ConstantVector::GetData<string_t>(rhs_vec)[0];
 			const auto &arg_dist = ConstantVector::GetData<double>(arg_vec)[0];
+			if (TryExecuteBounds(lhs_blob, rhs_blob, arg_dist, ConstantVector::GetData<bool>(result)[0])) {
+				return;
+			}
 			const auto lhs_geom = lstate.Deserialize(lhs_blob);
 			const auto rhs_geom = lstate.Deserialize(rhs_blob);
 
@@ -986,6 +2027,10 @@ struct ST_DistanceWithin {
 			const auto prep_geom = large_geom.get_prepared();
 
 			UnaryExecutor::Execute<double, bool>(arg_vec, result, args.size(), [&](const double arg_dist) {
+				bool bounds_result;
+				if (TryExecuteBounds(lhs_blob, rhs_blob, arg_dist, bounds_result)) {
+					return bounds_result;
+				}
 				return prep_geom.distance_within(probe_geom, arg_dist);
 			});
 
@@ -995,19 +2040,52 @@ struct ST_DistanceWithin {
 			auto &probe_vec = lhs_is_const ? rhs_vec : lhs_vec;
 
 			const auto &const_blob = ConstantVector::GetData<string_t>(const_vec)[0];
-			const auto const_geom = lstate.Deserialize(const_blob);
-			const auto const_prep = const_geom.get_prepared();
-
-			BinaryExecutor::Execute<string_t, double, bool>(probe_vec, arg_vec, result, args.size(),
-			                                                [&](const string_t &probe_blob, double distance) {
-				                                                const auto probe_geom = lstate.Deserialize(probe_blob);
-				                                                return const_prep.distance_within(probe_geom, distance);
-			                                                });
+			const auto const_idx = lhs_is_const ? 0 : 1;
+			auto index = SegmentIndexBindData::Get(state, const_idx);
+			if (!index) {
+				index = lstate.TryGetIndex(const_idx, const_blob);
+			}
+
+			// Only prepare the const geometry once a probe needs it
+			unique_ptr<GeosGeometry> const_geom;
+			unique_ptr<PreparedGeosGeometry> const_prep;
+			const auto get_prepared = [&]() -> const PreparedGeosGeometry & {
+				if (!const_prep) {
+					const_geom = make_uniq<GeosGeometry>(lstate.Deserialize(const_blob));
+					const_prep = make_uniq<PreparedGeosGeometry>(const_geom->get_prepared());
+				}
+				return *const_prep;
+			};
+
+			Box2D<float> const_bounds;
+			const auto check_bounds = geometry_t(const_blob).TryGetCachedBounds(const_bounds);
+
+			BinaryExecutor::Execute<string_t, double, bool>(
+			    probe_vec, arg_vec, result, args.size(), [&](const string_t &probe_blob, double distance) {
+				    bool bounds_result;
+				    if (check_bounds && TryExecuteBounds(const_bounds, probe_blob, distance, bounds_result)) {
+					    return bounds_result;
+				    }
+				    double probe_distance;
+				    if (index && TryExecuteIndexedDistance(*index, probe_blob, probe_distance)) {
+					    return probe_distance <= distance;
+				    }
+				    const auto probe_geom = lstate.Deserialize(probe_blob);
+				    return get_prepared().distance_within(probe_geom, distance);
+			    });
 		} else {
 			// Both are non-const, just execute normally
 			TernaryExecutor::Execute<string_t, string_t, double, bool>(
 			    lhs_vec, rhs_vec, arg_vec, result, args.size(),
 			    [&](const string_t &lhs_blob, const string_t &rhs_blob, double distance) {
+				    bool bounds_result;
+				    if (TryExecuteBounds(lhs_blob, rhs_blob, distance, bounds_result)) {
+					    return bounds_result;
+				    }
+				    double cached_distance;
+				    if (ST_Distance::TryExecuteCached(lstate, lhs_blob, rhs_blob, cached_distance)) {
+					    return cached_distance <= distance;
+				    }
 				    const auto lhs = lstate.Deserialize(lhs_blob);
 				    const auto rhs = lstate.Deserialize(rhs_blob);
 				    return lhs.distance_within(rhs, distance);
@@ -1023,8 +2101,9 @@ struct ST_DistanceWithin {
 				variant.AddParameter("distance", LogicalType::DOUBLE);
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
+				variant.SetBind(SegmentIndexBindData::Bind);
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(R"(
@@ -1056,7 +2135,7 @@ struct ST_Equals {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the geometries are \"equal\"");
@@ -1071,7 +2150,7 @@ struct ST_Envelope {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto envelope = geom.get_envelope();
 			return lstate.Serialize(result, envelope);
 		});
@@ -1084,7 +2163,7 @@ struct ST_Envelope {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the minimum bounding rectangle of a geometry as a polygon geometry");
@@ -1098,13 +2177,19 @@ struct ST_Intersection {
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
-		BinaryExecutor::Execute<string_t, string_t, string_t>(args.data[0], args.data[1], result, args.size(),
-		                                                      [&](const string_t &lhs_blob, const string_t &rhs_blob) {
-			                                                      const auto lhs = lstate.Deserialize(lhs_blob);
-			                                                      const auto rhs = lstate.Deserialize(rhs_blob);
-			                                                      const auto intersection = lhs.get_intersection(rhs);
-			                                                      return lstate.Serialize(result, intersection);
-		                                                      });
+		BinaryExecutor::Execute<string_t, string_t, string_t>(
+		    args.data[0], args.data[1], result, args.size(), [&](const string_t &lhs_blob, const string_t &rhs_blob) {
+			    if (lhs_blob.IsInlined() || rhs_blob.IsInlined()) {
+				    const auto lhs = lstate.Deserialize(lhs_blob);
+				    const auto rhs = lstate.Deserialize(rhs_blob);
+				    return lstate.Serialize(result, lhs.get_intersection(rhs));
+			    }
+			    // Join results (e.g. of ST_Overlay) repeat the same geometries many times, so only deserialize them
+			    // once per chunk
+			    const auto &lhs = lstate.DeserializeCached(lhs_blob);
+			    const auto &rhs = lstate.DeserializeCached(rhs_blob);
+			    return lstate.Serialize(result, lhs.get_intersection(rhs));
+		    });
 	}
 
 	static void Register(DatabaseInstance &db) {
@@ -1115,7 +2200,7 @@ struct ST_Intersection {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the intersection of two geometries");
@@ -1126,6 +2211,22 @@ struct ST_Intersection {
 };
 
 struct ST_Intersects : SymmetricPreparedBinaryFunction<ST_Intersects> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+	static constexpr bool USE_SEGMENT_INDEX = true;
+
+	static bool TryExecuteNative(const string_t &lhs_blob, const string_t &rhs_blob, bool &result) {
+		return TryExecuteNativePredicate(NativePredicate::INTERSECTS, lhs_blob, rhs_blob, result);
+	}
+
+	static bool TryExecuteIndexed(const SegmentIndex &index, const string_t &probe_blob, bool &result) {
+		NativeLocation location;
+		if (TryLocateIndexed(index, probe_blob, location)) {
+			result = location != NativeLocation::EXTERIOR;
+			return true;
+		}
+		return false;
+	}
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.intersects(rhs);
 	}
@@ -1141,8 +2242,9 @@ struct ST_Intersects : SymmetricPreparedBinaryFunction<ST_Intersects> {
 				variant.AddParameter("geom2", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
+				variant.SetBind(SegmentIndexBindData::Bind);
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the geometries intersect");
@@ -1156,7 +2258,7 @@ struct ST_IsRing {
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		const auto &lstate = LocalState::ResetAndGet(state);
 		UnaryExecutor::Execute<string_t, bool>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			return geom.is_ring();
 		});
 	}
@@ -1168,7 +2270,7 @@ struct ST_IsRing {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the geometry is a ring (both ST_IsClosed and ST_IsSimple).");
@@ -1182,7 +2284,7 @@ struct ST_IsSimple {
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		const auto &lstate = LocalState::ResetAndGet(state);
 		UnaryExecutor::Execute<string_t, bool>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			return geom.is_simple();
 		});
 	}
@@ -1194,7 +2296,7 @@ struct ST_IsSimple {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the geometry is simple");
@@ -1212,7 +2314,7 @@ struct ST_IsValid {
 			// GEOS can only construct geometries with a valid amount of vertices.
 			// So if deserialization fails, it cant be valid
 			try {
-				const auto geom = lstate.Deserialize(geom_blob);
+				const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 				return geom.is_valid();
 			} catch (...) {
 				return false;
@@ -1226,7 +2328,7 @@ struct ST_IsValid {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the geometry is valid");
@@ -1265,7 +2367,7 @@ struct ST_LineMerge {
 				variant.AddParameter("geom", GeoTypes::GEOMETRY());
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
@@ -1273,7 +2375,7 @@ struct ST_LineMerge {
 				variant.AddParameter("preserve_direction", LogicalType::BOOLEAN);
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(ExecuteWithDirection);
+				variant.SetFunction(ProfileKernel(ExecuteWithDirection));
 			});
 
 			func.SetDescription(R"("Merges" the input line geometry, optionally taking direction into account.)");
@@ -1288,7 +2390,7 @@ struct ST_MakeValid {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto valid = geom.get_made_valid();
 			return lstate.Serialize(result, valid);
 		});
@@ -1301,7 +2403,7 @@ struct ST_MakeValid {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns a valid representation of the geometry");
@@ -1381,7 +2483,7 @@ struct ST_MaximumInscribedCircle {
 				variant.AddParameter("geom", GeoTypes::GEOMETRY());
 				variant.SetReturnType(result_type);
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.AddVariant([&](ScalarFunctionVariantBuilder &variant) {
@@ -1389,7 +2491,7 @@ struct ST_MaximumInscribedCircle {
 				variant.AddParameter("tolerance", LogicalType::DOUBLE);
 				variant.SetReturnType(result_type);
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(ExecuteWithTolerance);
+				variant.SetFunction(ProfileKernel(ExecuteWithTolerance));
 			});
 
 			func.SetDescription(R"(
@@ -1410,7 +2512,7 @@ struct ST_MinimumRotatedRectangle {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto mrr = geom.get_minimum_rotated_rectangle();
 			return lstate.Serialize(result, mrr);
 		});
@@ -1423,7 +2525,7 @@ struct ST_MinimumRotatedRectangle {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the minimum rotated rectangle that bounds the input geometry, finding the "
@@ -1440,7 +2542,7 @@ struct ST_Node {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto node = geom.get_noded();
 			return lstate.Serialize(result, node);
 		});
@@ -1457,7 +2559,7 @@ struct ST_Node {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription(DESCRIPTION);
@@ -1483,7 +2585,7 @@ struct ST_Normalize {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the \"normalized\" representation of the geometry");
@@ -1494,6 +2596,8 @@ struct ST_Normalize {
 };
 
 struct ST_Overlaps : SymmetricPreparedBinaryFunction<ST_Overlaps> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.overlaps(rhs);
 	}
@@ -1509,7 +2613,7 @@ struct ST_Overlaps : SymmetricPreparedBinaryFunction<ST_Overlaps> {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the geometries overlap");
@@ -1524,7 +2628,7 @@ struct ST_PointOnSurface {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto point = geom.get_point_on_surface();
 			return lstate.Serialize(result, point);
 		});
@@ -1537,7 +2641,7 @@ struct ST_PointOnSurface {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns a point guaranteed to lie on the surface of the geometry");
@@ -1596,7 +2700,7 @@ struct ST_Polygonize {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns a polygonized representation of the input geometries");
@@ -1612,7 +2716,7 @@ struct ST_ReducePrecision {
 
 		BinaryExecutor::Execute<string_t, double, string_t>(
 		    args.data[0], args.data[1], result, args.size(), [&](const string_t &geom_blob, double precision) {
-			    const auto geom = lstate.Deserialize(geom_blob);
+			    const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			    const auto reduced = geom.get_reduced_precision(precision);
 			    return lstate.Serialize(result, reduced);
 		    });
@@ -1626,7 +2730,7 @@ struct ST_ReducePrecision {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the geometry with all vertices reduced to the given precision");
@@ -1641,7 +2745,7 @@ struct ST_RemoveRepeatedPoints {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto reduced = geom.get_without_repeated_points(0);
 			return lstate.Serialize(result, reduced);
 		});
@@ -1665,7 +2769,7 @@ struct ST_RemoveRepeatedPoints {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
@@ -1674,7 +2778,7 @@ struct ST_RemoveRepeatedPoints {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(ExecuteWithTolerance);
+				variant.SetFunction(ProfileKernel(ExecuteWithTolerance));
 			});
 
 			func.SetDescription("Returns the geometry with repeated points removed");
@@ -1689,7 +2793,7 @@ struct ST_Reverse {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto reversed = geom.get_reversed();
 			return lstate.Serialize(result, reversed);
 		});
@@ -1702,7 +2806,7 @@ struct ST_Reverse {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the geometry with the order of its vertices reversed");
@@ -1732,7 +2836,7 @@ struct ST_ShortestLine {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the shortest line between two geometries");
@@ -1743,14 +2847,83 @@ struct ST_ShortestLine {
 };
 
 struct ST_Simplify {
+	//! Simplify the vertices of every linestring in-place
+	static bool TrySimplifyLineal(const LocalState &lstate, sgl::geometry &geom, double tolerance) {
+		auto &arena = lstate.GetArena();
+		const auto vertex_size = geom.get_vertex_size();
+
+		const auto simplify = [&](sgl::geometry &line) {
+			const auto count = line.get_count();
+			if (count == 1) {
+				// Not a valid linestring, leave it to GEOS to complain
+				return false;
+			}
+			if (count < 3) {
+				return true;
+			}
+			// The vertices still point into the input blob, so the simplified vertices need a buffer of their own
+			const auto vertices = arena.AllocateAligned(count * vertex_size);
+			const auto stack = reinterpret_cast<uint32_t *>(arena.AllocateAligned(count * sizeof(uint32_t)));
+			const auto kept =
+			    sgl::ops::simplify_douglas_peucker(line.get_vertex_data(), count, vertex_size, tolerance, stack, vertices);
+			line.set_vertex_data(vertices, kept);
+			return true;
+		};
+
+		if (geom.get_type() == sgl::geometry_type::LINESTRING) {
+			return simplify(geom);
+		}
+
+		D_ASSERT(geom.get_type() == sgl::geometry_type::MULTI_LINESTRING);
+		const auto tail = geom.get_last_part();
+		if (!tail) {
+			return true;
+		}
+		auto part = tail;
+		do {
+			part = part->get_next();
+			if (part->is_empty()) {
+				// GEOS drops empty parts, which sgl can not do (yet)
+				return false;
+			}
+			if (!simplify(*part)) {
+				return false;
+			}
+		} while (part != tail);
+		return true;
+	}
+
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		const auto &lstate = LocalState::ResetAndGet(state);
-		BinaryExecutor::Execute<string_t, double, string_t>(args.data[0], args.data[1], result, args.size(),
-		                                                    [&](const string_t &geom_blob, double tolerance) {
-			                                                    const auto geom = lstate.Deserialize(geom_blob);
-			                                                    const auto simplified = geom.get_simplified(tolerance);
-			                                                    return lstate.Serialize(result, simplified);
-		                                                    });
+		BinaryExecutor::Execute<string_t, double, string_t>(
+		    args.data[0], args.data[1], result, args.size(), [&](const string_t &geom_blob, double tolerance) {
+			    // Linestrings are simplified natively, vertex by vertex, which only requires the same distance
+			    // computation as GEOS to give the same result. Polygons are repaired by GEOS after simplification,
+			    // and measures can not be serialized with GEOS, so those (and invalid tolerances) still go through it.
+			    const geometry_t geom_ref(geom_blob);
+			    const auto type = geom_ref.GetType();
+			    if ((type == GeometryType::LINESTRING || type == GeometryType::MULTILINESTRING) &&
+			        !geom_ref.GetProperties().HasM() && tolerance >= 0) {
+				    sgl::geometry geom;
+				    Serde::Deserialize(geom, lstate.GetArena(), geom_blob.GetData(), geom_blob.GetSize());
+				    if (TrySimplifyLineal(lstate, geom, tolerance)) {
+					    // A multilinestring with a single line becomes a linestring, like in GEOS
+					    const auto &out = geom.get_type() == sgl::geometry_type::MULTI_LINESTRING &&
+					                              geom.get_count() == 1
+					                          ? *geom.get_first_part()
+					                          : geom;
+					    const auto size = Serde::GetRequiredSize(out);
+					    auto blob = StringVector::EmptyString(result, size);
+					    Serde::Serialize(out, blob.GetDataWriteable(), size);
+					    blob.Finalize();
+					    return blob;
+				    }
+			    }
+
+			    const auto geom = lstate.Deserialize(geom_blob);
+			    const auto simplified = geom.get_simplified(tolerance);
+			    return lstate.Serialize(result, simplified);
+		    });
 	}
 	static void Register(DatabaseInstance &db) {
 		FunctionBuilder::RegisterScalar(db, "ST_Simplify", [](ScalarFunctionBuilder &func) {
@@ -1760,7 +2933,7 @@ struct ST_Simplify {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns a simplified version of the geometry");
@@ -1775,7 +2948,7 @@ struct ST_SimplifyPreserveTopology {
 		const auto &lstate = LocalState::ResetAndGet(state);
 		BinaryExecutor::Execute<string_t, double, string_t>(
 		    args.data[0], args.data[1], result, args.size(), [&](const string_t &geom_blob, double tolerance) {
-			    const auto geom = lstate.Deserialize(geom_blob);
+			    const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			    const auto simplified = geom.get_simplified_topo(tolerance);
 			    return lstate.Serialize(result, simplified);
 		    });
@@ -1789,7 +2962,7 @@ struct ST_SimplifyPreserveTopology {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns a simplified version of the geometry that preserves topology");
@@ -1800,6 +2973,8 @@ struct ST_SimplifyPreserveTopology {
 };
 
 struct ST_Touches : SymmetricPreparedBinaryFunction<ST_Touches> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.touches(rhs);
 	}
@@ -1814,7 +2989,7 @@ struct ST_Touches : SymmetricPreparedBinaryFunction<ST_Touches> {
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the geometries touch");
@@ -1844,7 +3019,7 @@ struct ST_Union {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the union of two geometries");
@@ -1859,7 +3034,7 @@ struct ST_VoronoiDiagram {
 		const auto &lstate = LocalState::ResetAndGet(state);
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &geom_blob) {
-			const auto geom = lstate.Deserialize(geom_blob);
+			const auto &geom = lstate.DeserializeShared(args.data[0], geom_blob);
 			const auto mrr = geom.get_voronoi_diagram();
 			return lstate.Serialize(result, mrr);
 		});
@@ -1872,7 +3047,7 @@ struct ST_VoronoiDiagram {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns the Voronoi diagram of the supplied MultiPoint geometry");
@@ -1883,6 +3058,22 @@ struct ST_VoronoiDiagram {
 };
 
 struct ST_Within : AsymmetricPreparedBinaryFunction<ST_Within> {
+	static constexpr auto BOUNDS_FILTER = BoundsFilter::FALSE_IF_DISJOINT;
+	static constexpr bool USE_SEGMENT_INDEX = true;
+
+	static bool TryExecuteNative(const string_t &lhs_blob, const string_t &rhs_blob, bool &result) {
+		return TryExecuteNativePredicate(NativePredicate::CONTAINS, rhs_blob, lhs_blob, result);
+	}
+
+	static bool TryExecuteIndexedRight(const string_t &lhs_blob, const SegmentIndex &rhs_index, bool &result) {
+		NativeLocation location;
+		if (TryLocateIndexed(rhs_index, lhs_blob, location)) {
+			result = location == NativeLocation::INTERIOR;
+			return true;
+		}
+		return false;
+	}
+
 	static bool ExecutePredicateNormal(const GeosGeometry &lhs, const GeosGeometry &rhs) {
 		return lhs.within(rhs);
 	}
@@ -1896,8 +3087,9 @@ struct ST_Within : AsymmetricPreparedBinaryFunction<ST_Within> {
 				variant.AddParameter("geom2", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
+				variant.SetBind(SegmentIndexBindData::Bind);
 				variant.SetInit(LocalState::Init);
-				variant.SetFunction(Execute);
+				variant.SetFunction(ProfileKernel(Execute));
 			});
 
 			func.SetDescription("Returns true if the first geometry is within the second");
@@ -1916,7 +3108,6 @@ struct ST_Within : AsymmetricPreparedBinaryFunction<ST_Within> {
 //======================================================================================================================
 struct GeosUnaryAggState {
 	GEOSGeometry *geom = nullptr;
-	GEOSContextHandle_t context = nullptr;
 };
 
 struct GeosUnaryAggFunction {
@@ -1946,7 +3137,6 @@ struct GeosUnaryAggFunction {
 	template <class STATE>
 	static void Initialize(STATE &state) {
 		state.geom = nullptr;
-		state.context = GEOS_init_r();
 	}
 
 	template <class STATE, class OP>
@@ -1955,24 +3145,24 @@ struct GeosUnaryAggFunction {
 			return;
 		}
 		if (!target.geom) {
-			target.geom = GEOSGeom_clone_r(target.context, source.geom);
+			target.geom = GEOSGeom_clone_r(GetThreadContext(), source.geom);
 			return;
 		}
 		auto curr = target.geom;
-		target.geom = OP::Merge(target.context, curr, source.geom);
-		GEOSGeom_destroy_r(target.context, curr);
+		target.geom = OP::Merge(GetThreadContext(), curr, source.geom);
+		GEOSGeom_destroy_r(GetThreadContext(), curr);
 	}
 
 	template <class INPUT_TYPE, class STATE, class OP>
 	static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &) {
 		if (!state.geom) {
-			state.geom = Deserialize(state.context, input);
+			state.geom = Deserialize(GetThreadContext(), input);
 		} else {
-			auto next = Deserialize(state.context, input);
+			auto next = Deserialize(GetThreadContext(), input);
 			auto curr = state.geom;
-			state.geom = OP::Merge(state.context, curr, next);
-			GEOSGeom_destroy_r(state.context, next);
-			GEOSGeom_destroy_r(state.context, curr);
+			state.geom = OP::Merge(GetThreadContext(), curr, next);
+			GEOSGeom_destroy_r(GetThreadContext(), next);
+			GEOSGeom_destroy_r(GetThreadContext(), curr);
 		}
 	}
 
@@ -1980,7 +3170,7 @@ struct GeosUnaryAggFunction {
 	static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &, idx_t) {
 		// There is no point in doing anything else, intersection and union is idempotent
 		if (!state.geom) {
-			state.geom = Deserialize(state.context, input);
+			state.geom = Deserialize(GetThreadContext(), input);
 		}
 	}
 
@@ -1989,20 +3179,16 @@ struct GeosUnaryAggFunction {
 		if (!state.geom) {
 			finalize_data.ReturnNull();
 		} else {
-			target = Serialize(state.context, finalize_data.result, state.geom);
+			target = Serialize(GetThreadContext(), finalize_data.result, state.geom);
 		}
 	}
 
 	template <class STATE>
 	static void Destroy(STATE &state, AggregateInputData &) {
 		if (state.geom) {
-			GEOSGeom_destroy_r(state.context, state.geom);
+			GEOSGeom_destroy_r(GetThreadContext(), state.geom);
 			state.geom = nullptr;
 		}
-		if (state.context) {
-			GEOS_finish_r(state.context);
-			state.context = nullptr;
-		}
 	}
 
 	static bool IgnoreNull() {
@@ -2010,30 +3196,6 @@ struct GeosUnaryAggFunction {
 	}
 };
 
-//======================================================================================================================
-// ST_Union_Agg
-//======================================================================================================================
-
-struct ST_Union_Agg : GeosUnaryAggFunction {
-	static GEOSGeometry *Merge(const GEOSContextHandle_t context, const GEOSGeometry *curr, const GEOSGeometry *next) {
-		return GEOSUnion_r(context, curr, next);
-	}
-
-	static void Register(DatabaseInstance &db) {
-		const auto agg =
-		    AggregateFunction::UnaryAggregateDestructor<GeosUnaryAggState, string_t, string_t, ST_Union_Agg>(
-		        GeoTypes::GEOMETRY(), GeoTypes::GEOMETRY());
-
-		FunctionBuilder::RegisterAggregate(db, "ST_Union_Agg", [&](AggregateFunctionBuilder &func) {
-			func.SetFunction(agg);
-			func.SetDescription("Computes the union of a set of input geometries");
-
-			func.SetTag("ext", "spatial");
-			func.SetTag("category", "construction");
-		});
-	}
-};
-
 //======================================================================================================================
 // ST_Intersection_Agg
 //======================================================================================================================
@@ -2061,22 +3223,92 @@ struct ST_Intersection_Agg : GeosUnaryAggFunction {
 //======================================================================================================================
 // Base GEOS-based coverage aggregate
 //======================================================================================================================
+// Buffers the input geometries of each group, and builds the result from all of them at once when finalizing.
+//
+// The geometries are buffered in their serialized form, which takes up much less memory than GEOS geometries, and are
+// only deserialized when finalizing. Large coverages can also be processed in tiles (see the SETTING_NAME setting):
+// the geometries are sorted along the hilbert curve over the centers of their bounds and split into tiles of
+// consecutive geometries, which are then processed in parallel on the threads of the database, and the results of the
+// tiles are stitched together.
 
 struct GEOSCoverageAggFunction {
 
+	static constexpr auto SETTING_NAME = "spatial_coverage_tile_size";
+
 	struct State {
-		GEOSContextHandle_t context = nullptr;
 		// This used to be a nice linked list.
 		// Unfortunately, there are issues when using custom destructors in combination with both window and aggregate
-		// functions. So we use a vector instead.
-		// We cant use a deque because we need to pass a contiguos array to GEOS.
-		vector<GEOSGeometry *> geoms;
+		// functions. So we use vectors instead, which are emptied (and their memory released) when destroying.
+
+		//! The serialized geometries, back to back
+		vector<char> data;
+		//! The end offset of each geometry in the data
+		vector<idx_t> offsets;
 
 		double tolerance = 0;
 		bool parameters_set = false;
 		bool simplify_boundary = false;
+
+		idx_t Count() const {
+			return offsets.size();
+		}
+
+		const char *GetData(idx_t geom_idx) const {
+			return data.data() + (geom_idx == 0 ? 0 : offsets[geom_idx - 1]);
+		}
+
+		idx_t GetSize(idx_t geom_idx) const {
+			return offsets[geom_idx] - (geom_idx == 0 ? 0 : offsets[geom_idx - 1]);
+		}
+
+		void Append(const string_t &blob) {
+			const auto ptr = blob.GetData();
+			data.insert(data.end(), ptr, ptr + blob.GetSize());
+			offsets.push_back(data.size());
+		}
+
+		void Append(const State &other) {
+			const auto base = data.size();
+			data.insert(data.end(), other.data.begin(), other.data.end());
+			for (const auto offset : other.offsets) {
+				offsets.push_back(base + offset);
+			}
+		}
+
+		void Clear() {
+			vector<char>().swap(data);
+			vector<idx_t>().swap(offsets);
+		}
 	};
 
+	//! The bind data of the aggregates that can be processed in tiles
+	struct BindData final : FunctionData {
+		DatabaseInstance &db;
+		//! The number of geometries per tile, or 0 to process all geometries at once
+		idx_t tile_size;
+
+		BindData(DatabaseInstance &db_p, idx_t tile_size_p) : db(db_p), tile_size(tile_size_p) {
+		}
+
+		unique_ptr<FunctionData> Copy() const override {
+			return make_uniq<BindData>(db, tile_size);
+		}
+
+		bool Equals(const FunctionData &other_p) const override {
+			auto &other = other_p.Cast<BindData>();
+			return &db == &other.db && tile_size == other.tile_size;
+		}
+	};
+
+	static unique_ptr<FunctionData> BindTileSize(ClientContext &context) {
+		Value tile_size;
+		idx_t tile_size_value = 0;
+		if (context.TryGetCurrentSetting(SETTING_NAME, tile_size) && !tile_size.IsNull()) {
+			tile_size_value = tile_size.GetValue<idx_t>();
+		}
+		return make_uniq<BindData>(DatabaseInstance::GetDatabase(context), tile_size_value);
+	}
+
 	// Serialize a GEOS geometry
 	static string_t Serialize(const GEOSContextHandle_t context, Vector &result, const GEOSGeometry *geom) {
 		D_ASSERT(geom);
@@ -2091,18 +3323,102 @@ struct GEOSCoverageAggFunction {
 		return blob;
 	}
 
-	// Deserialize a GEOS geometry
-	static GEOSGeometry *Deserialize(const GEOSContextHandle_t context, const string_t &blob) {
-		const auto ptr = blob.GetData();
-		const auto size = blob.GetSize();
+	//! Deserialize the given geometries of the state into a collection, which owns them
+	static GEOSGeometry *DeserializeCollection(const GEOSContextHandle_t context, const State &state,
+	                                           const idx_t *geom_ids, idx_t count) {
+		vector<GEOSGeometry *> geoms;
+		geoms.reserve(count);
+		try {
+			for (idx_t i = 0; i < count; i++) {
+				const auto geom_idx = geom_ids ? geom_ids[i] : i;
+				geoms.push_back(GeosSerde::Deserialize(context, state.GetData(geom_idx), state.GetSize(geom_idx)));
+			}
+		} catch (...) {
+			for (const auto geom : geoms) {
+				GEOSGeom_destroy_r(context, geom);
+			}
+			throw;
+		}
+		return GEOSGeom_createCollection_r(context, GEOS_GEOMETRYCOLLECTION, geoms.data(),
+		                                   static_cast<unsigned int>(geoms.size()));
+	}
 
-		return GeosSerde::Deserialize(context, ptr, size);
+	//! Split the geometries of the state into tiles of (at most) tile_size geometries that are close to each other
+	static vector<vector<idx_t>> GetTiles(const State &state, idx_t tile_size) {
+		const auto count = state.Count();
+
+		vector<sgl::box_xy> bounds(count, sgl::box_xy::smallest());
+		auto extent = sgl::box_xy::smallest();
+		for (idx_t geom_idx = 0; geom_idx < count; geom_idx++) {
+			auto &box = bounds[geom_idx];
+			if (!Serde::TryGetExtentXY(state.GetData(geom_idx), state.GetSize(geom_idx), box)) {
+				box.min = {0, 0};
+				box.max = {0, 0};
+			}
+			extent.min.x = std::min(extent.min.x, box.min.x);
+			extent.min.y = std::min(extent.min.y, box.min.y);
+			extent.max.x = std::max(extent.max.x, box.max.x);
+			extent.max.y = std::max(extent.max.y, box.max.y);
+		}
+
+		// Sort the geometries along the hilbert curve over the centers of their bounds
+		constexpr auto max_hilbert = std::numeric_limits<uint16_t>::max();
+		const auto width = extent.max.x - extent.min.x;
+		const auto height = extent.max.y - extent.min.y;
+		const auto hw = width > 0 ? max_hilbert / width : 0;
+		const auto hh = height > 0 ? max_hilbert / height : 0;
+
+		vector<std::pair<uint32_t, idx_t>> order;
+		order.reserve(count);
+		for (idx_t geom_idx = 0; geom_idx < count; geom_idx++) {
+			const auto &box = bounds[geom_idx];
+			const auto hx = static_cast<uint32_t>(hw * ((box.min.x + box.max.x) / 2 - extent.min.x));
+			const auto hy = static_cast<uint32_t>(hh * ((box.min.y + box.max.y) / 2 - extent.min.y));
+			order.emplace_back(sgl::util::hilbert_encode(16, hx, hy), geom_idx);
+		}
+		std::sort(order.begin(), order.end());
+
+		vector<vector<idx_t>> tiles;
+		for (idx_t i = 0; i < count; i++) {
+			if (i % tile_size == 0) {
+				tiles.emplace_back();
+				tiles.back().reserve(MinValue(tile_size, count - i));
+			}
+			tiles.back().push_back(order[i].second);
+		}
+		return tiles;
+	}
+
+	class TileTask final : public BaseExecutorTask {
+	public:
+		TileTask(TaskExecutor &executor, const std::function<void(idx_t)> &func_p, idx_t tile_idx_p)
+		    : BaseExecutorTask(executor), func(func_p), tile_idx(tile_idx_p) {
+		}
+
+		void ExecuteTask() override {
+			func(tile_idx);
+		}
+
+		string TaskType() const override {
+			return "CoverageTileTask";
+		}
+
+	private:
+		const std::function<void(idx_t)> &func;
+		idx_t tile_idx;
+	};
+
+	//! Run the function for every tile, in parallel on the threads of the database
+	static void ForEachTile(DatabaseInstance &db, idx_t tile_count, const std::function<void(idx_t)> &func) {
+		TaskExecutor executor(TaskScheduler::GetScheduler(db));
+		for (idx_t tile_idx = 0; tile_idx < tile_count; tile_idx++) {
+			executor.ScheduleTask(make_uniq<TileTask>(executor, func, tile_idx));
+		}
+		executor.WorkOnTasks();
 	}
 
 	static void Initialize(const AggregateFunction &, data_ptr_t state_mem) {
-		const auto state_ptr = new (state_mem) State();
-		auto &state = *state_ptr;
-		state.context = GEOS_init_r();
+		new (state_mem) State();
 	}
 
 	static void Absorb(Vector &state_vec, Vector &combined, AggregateInputData &aggr_input_data, idx_t count) {
@@ -2118,10 +3434,15 @@ struct GEOSCoverageAggFunction {
 			const auto state_idx = state_format.sel->get_index(raw_idx);
 			auto &state = *state_ptr[state_idx];
 
-			// Steal the list from the state and append it to the combined state
+			// Steal the geometries from the state and append them to the combined state
 			auto &combined_state = *combined_ptr[raw_idx];
-			combined_state.geoms.insert(combined_state.geoms.end(), state.geoms.begin(), state.geoms.end());
-			state.geoms.clear();
+			if (combined_state.Count() == 0) {
+				std::swap(combined_state.data, state.data);
+				std::swap(combined_state.offsets, state.offsets);
+			} else {
+				combined_state.Append(state);
+			}
+			state.Clear();
 
 			// Copy params
 			if (!combined_state.parameters_set && state.parameters_set) {
@@ -2150,12 +3471,9 @@ struct GEOSCoverageAggFunction {
 			const auto state_idx = state_format.sel->get_index(raw_idx);
 			const auto &state = *state_ptr[state_idx];
 
-			// We can't steal the list, we need to clone and append all elements
+			// We can't steal the geometries, we need to copy them
 			auto &combined_state = *combined_ptr[raw_idx];
-
-			for (auto &geom : state.geoms) {
-				combined_state.geoms.push_back(GEOSGeom_clone_r(combined_state.context, geom));
-			}
+			combined_state.Append(state);
 
 			// Copy params
 			if (!combined_state.parameters_set && state.parameters_set) {
@@ -2170,6 +3488,27 @@ struct GEOSCoverageAggFunction {
 		return sizeof(State);
 	}
 
+	template <class OP>
+	static void FinalizeState(const State &state, Vector &result, ValidityMask &mask, idx_t out_idx) {
+		const auto context = GetThreadContext();
+
+		// Now create a geometry collection out of all geometries
+		const auto collection = DeserializeCollection(context, state, nullptr, state.Count());
+
+		try {
+			// And perform the operation with the result
+			OP::Build(state, collection, result, mask, out_idx);
+
+			// Destroy the collection
+			GEOSGeom_destroy_r(context, collection);
+
+		} catch (...) {
+			// Destroy the collection, and rethrow the exception
+			GEOSGeom_destroy_r(context, collection);
+			throw;
+		}
+	}
+
 	template <class OP>
 	static void Finalize(Vector &state_vec, AggregateInputData &aggr_input_data, Vector &result, idx_t count,
 	                     idx_t offset) {
@@ -2181,29 +3520,33 @@ struct GEOSCoverageAggFunction {
 
 		auto &mask = FlatVector::Validity(result);
 
+		for (idx_t raw_idx = 0; raw_idx < count; raw_idx++) {
+			auto &state = *state_ptr[state_format.sel->get_index(raw_idx)];
+			FinalizeState<OP>(state, result, mask, raw_idx + offset);
+		}
+	}
+
+	//! Finalize the states with more geometries than the tile size of the bind data tile by tile
+	template <class OP>
+	static void FinalizeTiled(Vector &state_vec, AggregateInputData &aggr_input_data, Vector &result, idx_t count,
+	                          idx_t offset) {
+
+		auto &bind_data = aggr_input_data.bind_data->Cast<BindData>();
+
+		UnifiedVectorFormat state_format;
+		state_vec.ToUnifiedFormat(count, state_format);
+
+		const auto state_ptr = UnifiedVectorFormat::GetData<State *>(state_format);
+
+		auto &mask = FlatVector::Validity(result);
+
 		for (idx_t raw_idx = 0; raw_idx < count; raw_idx++) {
 			auto &state = *state_ptr[state_format.sel->get_index(raw_idx)];
 			const auto out_idx = raw_idx + offset;
-
-			// Now create a geometry collection out of all geometries
-			const auto collection = GEOSGeom_createCollection_r(state.context, GEOS_GEOMETRYCOLLECTION,
-			                                                    state.geoms.data(), state.geoms.size());
-
-			// If we manage to construct the collection, it takes ownership of the geometries
-			// So we need to leak the list or risk a double free
-			state.geoms.clear();
-
-			try {
-				// And perform the operation with the result
-				OP::Build(state, collection, result, mask, out_idx);
-
-				// Destroy the collection
-				GEOSGeom_destroy_r(state.context, collection);
-
-			} catch (...) {
-				// Destroy the collection, and rethrow the exception
-				GEOSGeom_destroy_r(state.context, collection);
-				throw;
+			if (bind_data.tile_size == 0 || state.Count() <= bind_data.tile_size) {
+				FinalizeState<OP>(state, result, mask, out_idx);
+			} else {
+				OP::BuildTiled(bind_data, state, result, mask, out_idx);
 			}
 		}
 	}
@@ -2218,12 +3561,7 @@ struct GEOSCoverageAggFunction {
 			if (state_format.validity.RowIsValid(row_idx)) {
 				auto &state = *state_ptr[row_idx];
 
-				state.geoms.clear();
-
-				if (state.context) {
-					GEOS_finish_r(state.context);
-					state.context = nullptr;
-				}
+				state.Clear();
 			}
 		}
 	}
@@ -2241,7 +3579,7 @@ struct ST_CoverageSimplify_Agg : GEOSCoverageAggFunction {
 			arguments.push_back(make_uniq_base<Expression, BoundConstantExpression>(Value::BOOLEAN(true)));
 			function.arguments.push_back(LogicalType::BOOLEAN);
 		}
-		return nullptr;
+		return BindTileSize(context);
 	}
 
 	static void Update(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count, Vector &state_vec,
@@ -2281,10 +3619,9 @@ struct ST_CoverageSimplify_Agg : GEOSCoverageAggFunction {
 				continue;
 			}
 
-			// Now, deserialize the geometry and append it to the list in each state
+			// Buffer the geometry in each state, the coverage is only deserialized and simplified when finalizing
 			auto &state = *state_ptr[state_idx];
-			const auto geom = Deserialize(state.context, geom_ptr[geom_idx]);
-			state.geoms.push_back(geom);
+			state.Append(geom_ptr[geom_idx]);
 
 			// Also set parameters
 			if (!state.parameters_set) {
@@ -2299,23 +3636,73 @@ struct ST_CoverageSimplify_Agg : GEOSCoverageAggFunction {
 	                  idx_t out_idx) {
 		// Compute the coverage
 		const auto simplified =
-		    GEOSCoverageSimplifyVW_r(state.context, collection, state.tolerance, !state.simplify_boundary);
+		    GEOSCoverageSimplifyVW_r(GetThreadContext(), collection, state.tolerance, !state.simplify_boundary);
 
 		// Serialize the result
 		const auto result_ptr = FlatVector::GetData<string_t>(result);
-		result_ptr[out_idx] = Serialize(state.context, result, simplified);
-		GEOSGeom_destroy_r(state.context, simplified);
+		result_ptr[out_idx] = Serialize(GetThreadContext(), result, simplified);
+		GEOSGeom_destroy_r(GetThreadContext(), simplified);
+	}
+
+	static void BuildTiled(const BindData &bind_data, const State &state, Vector &result, ValidityMask &,
+	                       idx_t out_idx) {
+		const auto tiles = GetTiles(state, bind_data.tile_size);
+
+		// Simplify each tile with its boundary preserved. The edges shared by two tiles are on the boundary of both,
+		// so they stay in place and the simplified tiles still fit together.
+		vector<GEOSGeometry *> simplified(state.Count(), nullptr);
+		const auto destroy_all = [&]() {
+			for (const auto geom : simplified) {
+				if (geom) {
+					GEOSGeom_destroy_r(GetThreadContext(), geom);
+				}
+			}
+		};
+
+		try {
+			ForEachTile(bind_data.db, tiles.size(), [&](idx_t tile_idx) {
+				const auto context = GetThreadContext();
+				const auto &tile = tiles[tile_idx];
+				const auto collection = DeserializeCollection(context, state, tile.data(), tile.size());
+				const auto tile_result = GEOSCoverageSimplifyVW_r(context, collection, state.tolerance, true);
+				GEOSGeom_destroy_r(context, collection);
+				if (!tile_result) {
+					throw InvalidInputException("Could not simplify the coverage");
+				}
+				for (idx_t i = 0; i < tile.size(); i++) {
+					simplified[tile[i]] = GEOSGeom_clone_r(context, GEOSGetGeometryN_r(context, tile_result, i));
+				}
+				GEOSGeom_destroy_r(context, tile_result);
+			});
+		} catch (...) {
+			destroy_all();
+			throw;
+		}
+
+		// Stitch the geometries back together in their original order, the collection takes ownership of them
+		const auto context = GetThreadContext();
+		const auto collection = GEOSGeom_createCollection_r(context, GEOS_GEOMETRYCOLLECTION, simplified.data(),
+		                                                    static_cast<unsigned int>(simplified.size()));
+
+		const auto result_ptr = FlatVector::GetData<string_t>(result);
+		result_ptr[out_idx] = Serialize(context, result, collection);
+		GEOSGeom_destroy_r(context, collection);
 	}
 
 	static void Register(DatabaseInstance &db) {
 		using SELF = ST_CoverageSimplify_Agg;
 
 		AggregateFunction agg({GeoTypes::GEOMETRY(), LogicalType::DOUBLE}, GeoTypes::GEOMETRY(), StateSize, Initialize,
-		                      Update, Combine, Finalize<SELF>, nullptr, Bind, Destroy);
+		                      Update, Combine, FinalizeTiled<SELF>, nullptr, Bind, Destroy);
 
 		FunctionBuilder::RegisterAggregate(db, "ST_CoverageSimplify_Agg", [&](AggregateFunctionBuilder &func) {
 			func.SetFunction(agg);
-			func.SetDescription("Simplifies a set of geometries while maintaining coverage");
+			func.SetDescription(
+			    "Simplifies a set of geometries while maintaining coverage\n\n"
+			    "Coverages with more geometries than the `spatial_coverage_tile_size` setting (if it is not 0) are "
+			    "split into tiles of that many geometries that are close to each other, which are simplified in "
+			    "parallel. The edges on the boundaries of the tiles are not simplified, so that the tiles still fit "
+			    "together.");
 
 			// TODO: this is a hack
 			agg.arguments.push_back(LogicalType::BOOLEAN);
@@ -2333,6 +3720,11 @@ struct ST_CoverageSimplify_Agg : GEOSCoverageAggFunction {
 
 struct ST_CoverageUnion_Agg : GEOSCoverageAggFunction {
 
+	static unique_ptr<FunctionData> Bind(ClientContext &context, AggregateFunction &function,
+	                                     vector<unique_ptr<Expression>> &arguments) {
+		return BindTileSize(context);
+	}
+
 	static void Update(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count, Vector &state_vec,
 	                   idx_t count) {
 
@@ -2355,10 +3747,9 @@ struct ST_CoverageUnion_Agg : GEOSCoverageAggFunction {
 				continue;
 			}
 
-			// Now, deserialize the geometry and append it to the list in each state
+			// Buffer the geometry in each state, the coverage is only deserialized and unioned when finalizing
 			auto &state = *state_ptr[state_idx];
-			const auto geom = Deserialize(state.context, geom_ptr[geom_idx]);
-			state.geoms.push_back(geom);
+			state.Append(geom_ptr[geom_idx]);
 
 			// Also set parameters
 			if (!state.parameters_set) {
@@ -2370,23 +3761,71 @@ struct ST_CoverageUnion_Agg : GEOSCoverageAggFunction {
 	static void Build(const State &state, const GEOSGeometry *collection, Vector &result, ValidityMask &,
 	                  idx_t out_idx) {
 		// Compute the union
-		const auto coverage = GEOSCoverageUnion_r(state.context, collection);
+		const auto coverage = GEOSCoverageUnion_r(GetThreadContext(), collection);
 
 		// Serialize the result
 		const auto result_ptr = FlatVector::GetData<string_t>(result);
-		result_ptr[out_idx] = Serialize(state.context, result, coverage);
-		GEOSGeom_destroy_r(state.context, coverage);
+		result_ptr[out_idx] = Serialize(GetThreadContext(), result, coverage);
+		GEOSGeom_destroy_r(GetThreadContext(), coverage);
+	}
+
+	static void BuildTiled(const BindData &bind_data, const State &state, Vector &result, ValidityMask &mask,
+	                       idx_t out_idx) {
+		const auto tiles = GetTiles(state, bind_data.tile_size);
+
+		// The union of a tile consists of the edges of its geometries, so the unions of all tiles are a coverage too
+		vector<GEOSGeometry *> unions(tiles.size(), nullptr);
+		const auto destroy_all = [&]() {
+			for (const auto geom : unions) {
+				if (geom) {
+					GEOSGeom_destroy_r(GetThreadContext(), geom);
+				}
+			}
+		};
+
+		try {
+			ForEachTile(bind_data.db, tiles.size(), [&](idx_t tile_idx) {
+				const auto context = GetThreadContext();
+				const auto &tile = tiles[tile_idx];
+				const auto collection = DeserializeCollection(context, state, tile.data(), tile.size());
+				unions[tile_idx] = GEOSCoverageUnion_r(context, collection);
+				GEOSGeom_destroy_r(context, collection);
+				if (!unions[tile_idx]) {
+					throw InvalidInputException("Could not compute the union of the coverage");
+				}
+			});
+		} catch (...) {
+			destroy_all();
+			throw;
+		}
+
+		// Stitch the tiles together, the collection takes ownership of their unions
+		const auto context = GetThreadContext();
+		const auto collection = GEOSGeom_createCollection_r(context, GEOS_GEOMETRYCOLLECTION, unions.data(),
+		                                                    static_cast<unsigned int>(unions.size()));
+		try {
+			Build(state, collection, result, mask, out_idx);
+			GEOSGeom_destroy_r(context, collection);
+		} catch (...) {
+			GEOSGeom_destroy_r(context, collection);
+			throw;
+		}
 	}
 
 	static void Register(DatabaseInstance &db) {
 		using SELF = ST_CoverageUnion_Agg;
 
 		const AggregateFunction agg({GeoTypes::GEOMETRY()}, GeoTypes::GEOMETRY(), StateSize, Initialize, Update,
-		                            Combine, Finalize<SELF>, nullptr, nullptr, Destroy);
+		                            Combine, FinalizeTiled<SELF>, nullptr, Bind, Destroy);
 
 		FunctionBuilder::RegisterAggregate(db, "ST_CoverageUnion_Agg", [&](AggregateFunctionBuilder &func) {
 			func.SetFunction(agg);
-			func.SetDescription("Unions a set of geometries while maintaining coverage");
+			func.SetDescription(
+			    "Unions a set of geometries while maintaining coverage\n\n"
+			    "Coverages with more geometries than the `spatial_coverage_tile_size` setting (if it is not 0) are "
+			    "split into tiles of that many geometries that are close to each other, which are unioned in parallel "
+			    "before the unions of the tiles are unioned. The result is the same as when unioning all geometries at "
+			    "once.");
 
 			func.SetTag("ext", "spatial");
 			func.SetTag("category", "construction");
@@ -2439,10 +3878,9 @@ struct ST_CoverageInvalidEdges_Agg : GEOSCoverageAggFunction {
 				continue;
 			}
 
-			// Now, deserialize the geometry and append it to the list in each state
+			// Buffer the geometry in each state, the edges are only checked when finalizing
 			auto &state = *state_ptr[state_idx];
-			const auto geom = Deserialize(state.context, geom_ptr[geom_idx]);
-			state.geoms.push_back(geom);
+			state.Append(geom_ptr[geom_idx]);
 
 			// Also set parameters
 			if (!state.parameters_set) {
@@ -2457,15 +3895,15 @@ struct ST_CoverageInvalidEdges_Agg : GEOSCoverageAggFunction {
 
 		// Check if there are any invalid edges
 		GEOSGeometry *edges;
-		GEOSCoverageIsValid_r(state.context, collection, state.tolerance, &edges);
-		if (GEOSisEmpty_r(state.context, edges)) {
+		GEOSCoverageIsValid_r(GetThreadContext(), collection, state.tolerance, &edges);
+		if (GEOSisEmpty_r(GetThreadContext(), edges)) {
 			mask.SetInvalid(out_idx);
 			return;
 		}
 		// Serialize the result
 		const auto result_ptr = FlatVector::GetData<string_t>(result);
-		result_ptr[out_idx] = Serialize(state.context, result, edges);
-		GEOSGeom_destroy_r(state.context, edges);
+		result_ptr[out_idx] = Serialize(GetThreadContext(), result, edges);
+		GEOSGeom_destroy_r(GetThreadContext(), edges);
 	}
 
 	static void Register(DatabaseInstance &db) {
@@ -2489,6 +3927,524 @@ struct ST_CoverageInvalidEdges_Agg : GEOSCoverageAggFunction {
 	}
 };
 
+//======================================================================================================================
+// ST_Union_Agg
+//======================================================================================================================
+
+struct ST_Union_Agg : GEOSCoverageAggFunction {
+
+	static void Update(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count, Vector &state_vec,
+	                   idx_t count) {
+
+		auto &geom_vec = inputs[0];
+
+		// The union is idempotent, so a constant input only has to be added once
+		if (geom_vec.GetVectorType() == VectorType::CONSTANT_VECTOR &&
+		    state_vec.GetVectorType() == VectorType::CONSTANT_VECTOR) {
+			count = 1;
+		}
+
+		UnifiedVectorFormat geom_format;
+		geom_vec.ToUnifiedFormat(count, geom_format);
+
+		UnifiedVectorFormat state_format;
+		state_vec.ToUnifiedFormat(count, state_format);
+
+		const auto state_ptr = UnifiedVectorFormat::GetData<State *>(state_format);
+		const auto geom_ptr = UnifiedVectorFormat::GetData<string_t>(geom_format);
+
+		for (idx_t raw_idx = 0; raw_idx < count; raw_idx++) {
+			const auto state_idx = state_format.sel->get_index(raw_idx);
+			const auto geom_idx = geom_format.sel->get_index(raw_idx);
+
+			if (!geom_format.validity.RowIsValid(geom_idx)) {
+				continue;
+			}
+
+			// Buffer the geometry, the union is computed in one go when finalizing
+			auto &state = *state_ptr[state_idx];
+			state.Append(geom_ptr[geom_idx]);
+		}
+	}
+
+	static void Build(const State &state, const GEOSGeometry *collection, Vector &result, ValidityMask &mask,
+	                  idx_t out_idx) {
+		if (GEOSGetNumGeometries_r(GetThreadContext(), collection) == 0) {
+			mask.SetInvalid(out_idx);
+			return;
+		}
+
+		// Compute the union of all geometries at once. GEOS uses a cascaded union here, which merges spatially
+		// close geometries first instead of growing a single result geometry one input at a time.
+		const auto united = GEOSUnaryUnion_r(GetThreadContext(), collection);
+
+		// Serialize the result
+		const auto result_ptr = FlatVector::GetData<string_t>(result);
+		result_ptr[out_idx] = Serialize(GetThreadContext(), result, united);
+		GEOSGeom_destroy_r(GetThreadContext(), united);
+	}
+
+	static void Register(DatabaseInstance &db) {
+		using SELF = ST_Union_Agg;
+
+		const AggregateFunction agg({GeoTypes::GEOMETRY()}, GeoTypes::GEOMETRY(), StateSize, Initialize, Update,
+		                            Combine, Finalize<SELF>, nullptr, nullptr, Destroy);
+
+		FunctionBuilder::RegisterAggregate(db, "ST_Union_Agg", [&](AggregateFunctionBuilder &func) {
+			func.SetFunction(agg);
+			func.SetDescription("Computes the union of a set of input geometries");
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "construction");
+		});
+	}
+};
+
+//======================================================================================================================
+// ST_ClusterDBSCAN
+//======================================================================================================================
+// A window function that returns the cluster of each geometry of its partition, according to DBSCAN. Geometries within
+// 'eps' of at least 'minpoints' geometries (including themselves) are core geometries, and core geometries within 'eps'
+// of each other belong to the same cluster. Other geometries within 'eps' of a core geometry join one of its clusters,
+// and the remaining geometries are noise, for which NULL is returned.
+//
+// The window callbacks are given a hash group, whose rows are sorted by the partition keys and may belong to many
+// partitions, but not the position of the row they evaluate. So the function does not take a frame, and the optimizer
+// below sets it to the whole partition, excluding the current row: then the sub frames of each row tell both the bounds
+// of its partition and its position in the hash group.
+//
+// When the window is initialized, we deserialize the geometries of the whole hash group once. The first row evaluated
+// for a partition then clusters it: we build a FlatRTree over the bounds of its geometries, and find the neighbours of
+// each geometry by probing the tree with its bounds expanded by 'eps'. We count the neighbours in a first pass, and
+// merge the clusters of the core geometries with a union-find in a second pass. The other rows of the partition (on any
+// thread) look up their cluster in the result.
+
+struct ST_ClusterDBSCAN {
+
+	struct BindData final : public FunctionData {
+		double eps = 0;
+		int32_t min_points = 0;
+
+		BindData(double eps_p, int32_t min_points_p) : eps(eps_p), min_points(min_points_p) {
+		}
+
+		unique_ptr<FunctionData> Copy() const override {
+			return make_uniq<BindData>(eps, min_points);
+		}
+
+		bool Equals(const FunctionData &other_p) const override {
+			auto &other = other_p.Cast<BindData>();
+			return eps == other.eps && min_points == other.min_points;
+		}
+	};
+
+	// The geometries of a hash group, in the order of their rows
+	struct Entry {
+		idx_t row_idx;
+		GEOSGeometry *geom;
+		bool is_point;
+		double x;
+		double y;
+	};
+
+	class Geometries {
+	public:
+		explicit Geometries(GEOSContextHandle_t ctx_p) : ctx(ctx_p) {
+		}
+
+		~Geometries() {
+			for (auto &entry : entries) {
+				GEOSGeom_destroy_r(ctx, entry.geom);
+			}
+		}
+
+		void Append(idx_t row_idx, const string_t &blob, const Box2D<float> &box) {
+			const auto geom = GeosSerde::Deserialize(ctx, blob.GetData(), blob.GetSize());
+			Entry entry = {row_idx, geom, false, 0, 0};
+			if (GEOSGeomTypeId_r(ctx, geom) == GEOS_POINT) {
+				entry.is_point = GEOSGeomGetX_r(ctx, geom, &entry.x) && GEOSGeomGetY_r(ctx, geom, &entry.y);
+			}
+			entries.push_back(entry);
+			boxes.push_back(box);
+		}
+
+		// Get the first entry at or after the row
+		idx_t LowerBound(idx_t row_idx) const {
+			const auto it = std::lower_bound(entries.begin(), entries.end(), row_idx,
+			                                 [](const Entry &entry, idx_t idx) { return entry.row_idx < idx; });
+			return NumericCast<idx_t>(it - entries.begin());
+		}
+
+		bool IsWithin(GEOSContextHandle_t thread_ctx, idx_t lhs_idx, idx_t rhs_idx, double eps) const {
+			auto &lhs = entries[lhs_idx];
+			auto &rhs = entries[rhs_idx];
+			if (lhs.is_point && rhs.is_point) {
+				const auto dx = lhs.x - rhs.x;
+				const auto dy = lhs.y - rhs.y;
+				return dx * dx + dy * dy <= eps * eps;
+			}
+			return GEOSDistanceWithin_r(thread_ctx, lhs.geom, rhs.geom, eps) == 1;
+		}
+
+		GEOSContextHandle_t ctx;
+		vector<Entry> entries;
+		vector<Box2D<float>> boxes;
+	};
+
+	// The clusters of a single partition, computed by the first thread that evaluates one of its rows
+	struct PartitionClusters {
+		mutex lock;
+		bool computed = false;
+		//! The cluster of each row of the partition, or -1 for noise
+		vector<int32_t> cluster_ids;
+	};
+
+	// Both the global state (the geometries and the clusters of all the partitions) and the local state of each thread
+	// (the partition it evaluated last), the window callbacks create both with the same functions.
+	struct State {
+		unique_ptr<Geometries> geoms;
+		mutable mutex lock;
+		//! The clusters of the partitions, by their first row
+		mutable unordered_map<idx_t, shared_ptr<PartitionClusters>> partitions;
+
+		idx_t last_partition_beg = 0;
+		shared_ptr<PartitionClusters> last_partition;
+	};
+
+	// Call the callback for every pair of entries in the range whose (expanded) bounds intersect, in both orders
+	template <class FUNC>
+	static void ForEachCandidate(const FlatRTree &tree, const Geometries &geoms, idx_t entry_beg, idx_t entry_end,
+	                             double eps, FUNC &&callback) {
+		FlatRTreeScanState scan;
+		for (idx_t batch_beg = entry_beg; batch_beg < entry_end; batch_beg += STANDARD_VECTOR_SIZE) {
+			const auto batch_end = MinValue<idx_t>(batch_beg + STANDARD_VECTOR_SIZE, entry_end);
+
+			scan.Reset();
+			for (idx_t i = batch_beg; i < batch_end; i++) {
+				scan.AddProbe(ExpandBox(geoms.boxes[i], eps), UnsafeNumericCast<sel_t>(i - batch_beg));
+			}
+			tree.InitScan(scan);
+
+			while (tree.Scan(scan)) {
+				for (idx_t i = 0; i < scan.matches_count; i++) {
+					callback(batch_beg + scan.matches_sel.get_index(i), entry_beg + scan.matches_pos[i]);
+				}
+			}
+		}
+	}
+
+	static idx_t Find(vector<idx_t> &parents, idx_t idx) {
+		while (parents[idx] != idx) {
+			// Path halving
+			parents[idx] = parents[parents[idx]];
+			idx = parents[idx];
+		}
+		return idx;
+	}
+
+	// Cluster the geometries of the partition of the rows [row_beg, row_end)
+	static void ClusterPartition(const BindData &bind_data, const Geometries &geoms, idx_t row_beg, idx_t row_end,
+	                             vector<int32_t> &cluster_ids) {
+		const auto eps = bind_data.eps;
+		const auto min_points = static_cast<idx_t>(bind_data.min_points);
+
+		cluster_ids.assign(row_end - row_beg, -1);
+
+		const auto entry_beg = geoms.LowerBound(row_beg);
+		const auto entry_end = geoms.LowerBound(row_end);
+		const auto count = entry_end - entry_beg;
+		if (count == 0) {
+			return;
+		}
+
+		const auto ctx = GetThreadContext();
+
+		FlatRTree tree(Allocator::DefaultAllocator(), UnsafeNumericCast<uint32_t>(count), GetRTreeNodeSize(count));
+		for (idx_t i = entry_beg; i < entry_end; i++) {
+			tree.Push(geoms.boxes[i], nullptr);
+		}
+		tree.Build();
+
+		// First count the neighbours of each geometry, which include the geometry itself
+		vector<idx_t> neighbours(count, 0);
+		ForEachCandidate(tree, geoms, entry_beg, entry_end, eps, [&](idx_t lhs_idx, idx_t rhs_idx) {
+			auto &lhs_neighbours = neighbours[lhs_idx - entry_beg];
+			if (lhs_neighbours < min_points && geoms.IsWithin(ctx, lhs_idx, rhs_idx, eps)) {
+				lhs_neighbours++;
+			}
+		});
+
+		// Then merge the clusters of neighbouring core geometries, and attach the others to a neighbouring core
+		constexpr auto NO_CORE = NumericLimits<idx_t>::Maximum();
+		vector<idx_t> parents(count);
+		vector<idx_t> border_core(count, NO_CORE);
+		for (idx_t i = 0; i < count; i++) {
+			parents[i] = i;
+		}
+
+		ForEachCandidate(tree, geoms, entry_beg, entry_end, eps, [&](idx_t lhs_idx, idx_t rhs_idx) {
+			const auto lhs_pos = lhs_idx - entry_beg;
+			const auto rhs_pos = rhs_idx - entry_beg;
+			if (neighbours[lhs_pos] < min_points) {
+				return;
+			}
+			const auto rhs_is_core = neighbours[rhs_pos] >= min_points;
+			if (rhs_is_core) {
+				// Each pair of core geometries is found twice, only look at it once
+				if (lhs_pos >= rhs_pos) {
+					return;
+				}
+				const auto lhs_root = Find(parents, lhs_pos);
+				const auto rhs_root = Find(parents, rhs_pos);
+				if (lhs_root != rhs_root && geoms.IsWithin(ctx, lhs_idx, rhs_idx, eps)) {
+					parents[MaxValue(lhs_root, rhs_root)] = MinValue(lhs_root, rhs_root);
+				}
+				return;
+			}
+			if (border_core[rhs_pos] == NO_CORE && geoms.IsWithin(ctx, lhs_idx, rhs_idx, eps)) {
+				border_core[rhs_pos] = lhs_pos;
+			}
+		});
+
+		// Number the clusters in the order of the rows they first appear in
+		vector<int32_t> root_ids(count, -1);
+		int32_t cluster_count = 0;
+		for (idx_t i = 0; i < count; i++) {
+			const auto core_pos = neighbours[i] >= min_points ? i : border_core[i];
+			if (core_pos == NO_CORE) {
+				continue;
+			}
+			auto &cluster_id = root_ids[Find(parents, core_pos)];
+			if (cluster_id < 0) {
+				cluster_id = cluster_count++;
+			}
+			cluster_ids[geoms.entries[entry_beg + i].row_idx - row_beg] = cluster_id;
+		}
+	}
+
+	static void WindowInit(AggregateInputData &aggr_input_data, const WindowPartitionInput &partition,
+	                       data_ptr_t g_state) {
+		auto &state = *reinterpret_cast<State *>(g_state);
+
+		// Collect the non-empty geometries of the hash group that pass the filter
+		state.geoms = make_uniq<Geometries>(GetThreadContext());
+		if (!partition.inputs || partition.count == 0) {
+			return;
+		}
+		auto &geoms = *state.geoms;
+
+		ColumnDataScanState scan_state;
+		DataChunk chunk;
+		partition.inputs->InitializeScan(scan_state, partition.column_ids);
+		partition.inputs->InitializeScanChunk(scan_state, chunk);
+
+		idx_t row_beg = 0;
+		while (partition.inputs->Scan(scan_state, chunk)) {
+			UnifiedVectorFormat geom_format;
+			chunk.data[0].ToUnifiedFormat(chunk.size(), geom_format);
+			const auto geom_data = UnifiedVectorFormat::GetData<string_t>(geom_format);
+
+			for (idx_t i = 0; i < chunk.size(); i++) {
+				const auto row_idx = row_beg + i;
+				const auto geom_idx = geom_format.sel->get_index(i);
+				if (!partition.filter_mask.RowIsValid(row_idx) || !geom_format.validity.RowIsValid(geom_idx)) {
+					continue;
+				}
+				Box2D<float> box;
+				if (!geometry_t(geom_data[geom_idx]).TryGetCachedBounds(box)) {
+					continue;
+				}
+				geoms.Append(row_idx, geom_data[geom_idx], box);
+			}
+			row_beg += chunk.size();
+		}
+	}
+
+	static void Window(AggregateInputData &aggr_input_data, const WindowPartitionInput &partition,
+	                   const_data_ptr_t g_state, data_ptr_t l_state, const SubFrames &frames, Vector &result,
+	                   idx_t rid) {
+		// The frame is the whole partition, and the current row is the gap between the sub frames around it
+		D_ASSERT(frames.size() == 2 && frames[1].start == frames[0].end + 1);
+		const auto partition_beg = frames.front().start;
+		const auto partition_end = frames.back().end;
+		const auto row_idx = frames[0].end;
+
+		auto &gstate = *reinterpret_cast<const State *>(g_state);
+		auto &lstate = *reinterpret_cast<State *>(l_state);
+
+		if (!lstate.last_partition || lstate.last_partition_beg != partition_beg) {
+			{
+				lock_guard<mutex> guard(gstate.lock);
+				auto &entry = gstate.partitions[partition_beg];
+				if (!entry) {
+					entry = make_shared_ptr<PartitionClusters>();
+				}
+				lstate.last_partition = entry;
+				lstate.last_partition_beg = partition_beg;
+			}
+
+			// Only lock the partition itself while clustering it, so that other partitions are clustered in parallel
+			auto &clusters = *lstate.last_partition;
+			lock_guard<mutex> guard(clusters.lock);
+			if (!clusters.computed) {
+				auto &bind_data = aggr_input_data.bind_data->Cast<BindData>();
+				ClusterPartition(bind_data, *gstate.geoms, partition_beg, partition_end, clusters.cluster_ids);
+				clusters.computed = true;
+			}
+		}
+
+		// Once computed, the clusters of a partition are never modified
+		const auto cluster_id = lstate.last_partition->cluster_ids[row_idx - partition_beg];
+		if (cluster_id < 0) {
+			FlatVector::SetNull(result, rid, true);
+			return;
+		}
+		FlatVector::GetData<int32_t>(result)[rid] = cluster_id;
+	}
+
+	static unique_ptr<FunctionData> Bind(ClientContext &context, AggregateFunction &function,
+	                                     vector<unique_ptr<Expression>> &arguments) {
+		if (!arguments[1]->IsFoldable() || !arguments[2]->IsFoldable()) {
+			throw BinderException("ST_ClusterDBSCAN: eps and minpoints must be constant");
+		}
+		const auto eps_value = ExpressionExecutor::EvaluateScalar(context, *arguments[1]);
+		const auto min_points_value = ExpressionExecutor::EvaluateScalar(context, *arguments[2]);
+		if (eps_value.IsNull() || min_points_value.IsNull()) {
+			throw BinderException("ST_ClusterDBSCAN: eps and minpoints must not be NULL");
+		}
+		const auto eps = eps_value.GetValue<double>();
+		const auto min_points = min_points_value.GetValue<int32_t>();
+		if (!(eps >= 0) || min_points < 1) {
+			throw BinderException("ST_ClusterDBSCAN: eps must not be negative, and minpoints must be at least 1");
+		}
+
+		// The position of the current row is only known once the optimizer below has set the frame
+		if (!ClientConfig::GetConfig(context).enable_optimizer ||
+		    DBConfig::GetConfig(context).options.disabled_optimizers.count(OptimizerType::EXTENSION)) {
+			throw BinderException("ST_ClusterDBSCAN can not be used with the extension optimizers disabled");
+		}
+
+		// Only the geometries are read from the partition
+		Function::EraseArgument(function, arguments, 2);
+		Function::EraseArgument(function, arguments, 1);
+		return make_uniq<BindData>(eps, min_points);
+	}
+
+	static idx_t StateSize(const AggregateFunction &) {
+		return sizeof(State);
+	}
+
+	static void Initialize(const AggregateFunction &, data_ptr_t state_mem) {
+		new (state_mem) State();
+	}
+
+	static void Update(Vector[], AggregateInputData &, idx_t, Vector &, idx_t) {
+		throw InvalidInputException("ST_ClusterDBSCAN can only be used as a window function");
+	}
+
+	static void Combine(Vector &, Vector &, AggregateInputData &, idx_t) {
+	}
+
+	static void Finalize(Vector &, AggregateInputData &, Vector &, idx_t, idx_t) {
+		throw InvalidInputException("ST_ClusterDBSCAN can only be used as a window function");
+	}
+
+	static void Destroy(Vector &state_vec, AggregateInputData &, idx_t count) {
+		UnifiedVectorFormat state_format;
+		state_vec.ToUnifiedFormat(count, state_format);
+
+		const auto state_ptr = UnifiedVectorFormat::GetData<State *>(state_format);
+		for (idx_t raw_idx = 0; raw_idx < count; raw_idx++) {
+			state_ptr[state_format.sel->get_index(raw_idx)]->~State();
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Optimizer
+	//------------------------------------------------------------------------------------------------------------------
+	// Evaluate the window over the whole partition excluding the current row, so that the window function knows both
+	// the bounds of the partition and the row it is evaluated for. The clusters are computed over the whole partition,
+	// so only the default frame is accepted, which without an ORDER BY is the whole partition as well.
+	static bool HasDefaultFrame(const BoundWindowExpression &window) {
+		return window.start == WindowBoundary::UNBOUNDED_PRECEDING &&
+		       (window.end == WindowBoundary::CURRENT_ROW_RANGE || window.end == WindowBoundary::UNBOUNDED_FOLLOWING) &&
+		       window.exclude_clause == WindowExcludeMode::NO_OTHER;
+	}
+
+	static void OptimizeRecursive(LogicalOperator &op) {
+		if (op.type == LogicalOperatorType::LOGICAL_WINDOW) {
+			for (auto &expr : op.expressions) {
+				if (expr->type != ExpressionType::WINDOW_AGGREGATE) {
+					continue;
+				}
+				auto &window = expr->Cast<BoundWindowExpression>();
+				if (!window.aggregate || window.aggregate->name != "ST_ClusterDBSCAN") {
+					continue;
+				}
+				if (!HasDefaultFrame(window)) {
+					throw BinderException("ST_ClusterDBSCAN clusters the whole partition, and does not take a frame or "
+					                      "an EXCLUDE clause");
+				}
+				window.start = WindowBoundary::UNBOUNDED_PRECEDING;
+				window.end = WindowBoundary::UNBOUNDED_FOLLOWING;
+				window.start_expr = nullptr;
+				window.end_expr = nullptr;
+				window.exclude_clause = WindowExcludeMode::CURRENT_ROW;
+			}
+		}
+		for (auto &child : op.children) {
+			OptimizeRecursive(*child);
+		}
+	}
+
+	static void Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+		OptimizeRecursive(*plan);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Returns the cluster of each geometry of the window partition, according to the DBSCAN algorithm.
+
+		Geometries within `eps` of at least `minpoints` geometries (counting themselves) are core geometries, and core
+		geometries within `eps` of each other belong to the same cluster. Other geometries within `eps` of a core geometry
+		are added to the cluster of one of them, the remaining geometries are noise and get `NULL`. The clusters are
+		numbered from 0, in the order of the rows they first appear in.
+
+		This function can only be used as a window function, and clusters all the rows of the partition. It does not
+		take a frame or an `EXCLUDE` clause.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT id, ST_ClusterDBSCAN(geom, 1.5, 2) OVER (PARTITION BY city) AS cluster
+		FROM (VALUES (1, 'a', ST_Point(0, 0)), (2, 'a', ST_Point(1, 0)), (3, 'a', ST_Point(5, 5))) t(id, city, geom);
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		AggregateFunction agg({GeoTypes::GEOMETRY(), LogicalType::DOUBLE, LogicalType::INTEGER}, LogicalType::INTEGER,
+		                      StateSize, Initialize, Update, Combine, Finalize, nullptr, Bind, Destroy, nullptr,
+		                      Window);
+		agg.window_init = WindowInit;
+
+		FunctionBuilder::RegisterAggregate(db, "ST_ClusterDBSCAN", [&](AggregateFunctionBuilder &func) {
+			func.SetFunction(agg);
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "relation");
+		});
+
+		OptimizerExtension optimizer;
+		optimizer.optimize_function = Optimize;
+		db.config.optimizer_extensions.push_back(optimizer);
+	}
+};
+
 } // namespace
 
 //######################################################################################################################
@@ -2497,6 +4453,8 @@ struct ST_CoverageInvalidEdges_Agg : GEOSCoverageAggFunction {
 
 void RegisterGEOSModule(DatabaseInstance &db) {
 
+	SegmentIndexCache::Register(db);
+
 	// Scalar Functions
 	ST_Boundary::Register(db);
 	ST_Buffer::Register(db);
@@ -2551,6 +4509,15 @@ void RegisterGEOSModule(DatabaseInstance &db) {
 	ST_CoverageInvalidEdges_Agg::Register(db);
 	ST_CoverageUnion_Agg::Register(db);
 	ST_CoverageSimplify_Agg::Register(db);
+
+	db.config.AddExtensionOption(GEOSCoverageAggFunction::SETTING_NAME,
+	                             "Process the coverages of ST_CoverageUnion_Agg and ST_CoverageSimplify_Agg with more "
+	                             "geometries than this in spatially sorted tiles of this many geometries, in parallel. "
+	                             "0 processes every coverage at once",
+	                             LogicalType::UBIGINT, Value::UBIGINT(0));
+
+	// Window Functions
+	ST_ClusterDBSCAN::Register(db);
 }
 
 } // namespace duckdb
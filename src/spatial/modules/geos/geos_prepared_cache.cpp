@@ -0,0 +1,195 @@
+#include "spatial/modules/geos/geos_prepared_cache.hpp"
+#include "spatial/modules/geos/geos_geometry.hpp"
+#include "spatial/modules/geos/geos_serde.hpp"
+
+#include "duckdb/common/string_util.hpp"
+
+namespace duckdb {
+
+// The predicates we can evaluate with a prepared build-side geometry, expressed from the point of view of the
+// build-side geometry. E.g. ST_Within(probe, build) is evaluated as prepared(build).contains(probe)
+enum class GeosJoinPredicate : uint8_t {
+	INTERSECTS,
+	TOUCHES,
+	CROSSES,
+	OVERLAPS,
+	CONTAINS,
+	CONTAINS_PROPERLY,
+	WITHIN,
+	COVERS,
+	COVERED_BY,
+};
+
+struct GeosPreparedJoinCache::Entry {
+	// How many times this build row has been probed
+	idx_t hits = 0;
+	// The geometry and its prepared version, created on the second hit
+	unique_ptr<GeosGeometry> geom;
+	unique_ptr<PreparedGeosGeometry> prepared;
+};
+
+// Upper bound on the (serialized) size of the geometries we keep prepared per thread
+static constexpr idx_t MAX_CACHED_BYTES = 64ULL * 1024ULL * 1024ULL;
+// Upper bound on the number of build rows we count the hits of per thread, most of which are never prepared
+static constexpr idx_t MAX_CACHED_ENTRIES = 256ULL * 1024ULL;
+
+unique_ptr<GeosPreparedJoinCache> GeosPreparedJoinCache::TryCreate(const string &predicate_name) {
+	// We prepare the build side, which is the second argument of the predicate, so the asymmetric predicates flip
+	static const case_insensitive_map_t<GeosJoinPredicate> predicates = {
+	    {"ST_Intersects", GeosJoinPredicate::INTERSECTS},
+	    {"ST_Touches", GeosJoinPredicate::TOUCHES},
+	    {"ST_Crosses", GeosJoinPredicate::CROSSES},
+	    {"ST_Overlaps", GeosJoinPredicate::OVERLAPS},
+	    {"ST_Within", GeosJoinPredicate::CONTAINS},                // build contains probe
+	    {"ST_WithinProperly", GeosJoinPredicate::CONTAINS_PROPERLY}, // build contains probe properly
+	    {"ST_Contains", GeosJoinPredicate::WITHIN},                // build within probe
+	    {"ST_CoveredBy", GeosJoinPredicate::COVERS},               // build covers probe
+	    {"ST_Covers", GeosJoinPredicate::COVERED_BY},              // build covered by probe
+	};
+
+	const auto it = predicates.find(predicate_name);
+	if (it == predicates.end()) {
+		return nullptr;
+	}
+	return make_uniq<GeosPreparedJoinCache>(it->second);
+}
+
+GeosPreparedJoinCache::GeosPreparedJoinCache(GeosJoinPredicate predicate_p) : predicate(predicate_p) {
+	ctx = GEOS_init_r();
+	GEOSContext_setErrorMessageHandler_r(
+	    ctx, [](const char *message, void *) { throw InvalidInputException(message); }, nullptr);
+}
+
+GeosPreparedJoinCache::~GeosPreparedJoinCache() {
+	// Make sure we destroy the geometries before the context
+	Clear();
+	GEOS_finish_r(ctx);
+}
+
+void GeosPreparedJoinCache::Clear() {
+	entries.clear();
+	cached_bytes = 0;
+}
+
+static GeosGeometry DeserializeGeometry(GEOSContextHandle_t ctx, const string_t &blob) {
+	const auto geom = GeosSerde::Deserialize(ctx, blob.GetData(), blob.GetSize());
+	if (geom == nullptr) {
+		throw InvalidInputException("Could not deserialize geometry");
+	}
+	return GeosGeometry(ctx, geom);
+}
+
+static bool EvaluatePrepared(GeosJoinPredicate predicate, const PreparedGeosGeometry &build,
+                             const GeosGeometry &probe) {
+	switch (predicate) {
+	case GeosJoinPredicate::INTERSECTS:
+		return build.intersects(probe);
+	case GeosJoinPredicate::TOUCHES:
+		return build.touches(probe);
+	case GeosJoinPredicate::CROSSES:
+		return build.crosses(probe);
+	case GeosJoinPredicate::OVERLAPS:
+		return build.overlaps(probe);
+	case GeosJoinPredicate::CONTAINS:
+		return build.contains(probe);
+	case GeosJoinPredicate::CONTAINS_PROPERLY:
+		return build.contains_properly(probe);
+	case GeosJoinPredicate::WITHIN:
+		return build.within(probe);
+	case GeosJoinPredicate::COVERS:
+		return build.covers(probe);
+	case GeosJoinPredicate::COVERED_BY:
+		return build.covered_by(probe);
+	default:
+		throw InternalException("Unknown spatial join predicate");
+	}
+}
+
+static bool EvaluateNormal(GeosJoinPredicate predicate, const GeosGeometry &build, const GeosGeometry &probe) {
+	switch (predicate) {
+	case GeosJoinPredicate::INTERSECTS:
+		return build.intersects(probe);
+	case GeosJoinPredicate::TOUCHES:
+		return build.touches(probe);
+	case GeosJoinPredicate::CROSSES:
+		return build.crosses(probe);
+	case GeosJoinPredicate::OVERLAPS:
+		return build.overlaps(probe);
+	case GeosJoinPredicate::CONTAINS:
+		return build.contains(probe);
+	case GeosJoinPredicate::CONTAINS_PROPERLY:
+		// No unprepared version of this predicate in GEOS
+		return build.get_prepared().contains_properly(probe);
+	case GeosJoinPredicate::WITHIN:
+		return build.within(probe);
+	case GeosJoinPredicate::COVERS:
+		return build.covers(probe);
+	case GeosJoinPredicate::COVERED_BY:
+		return build.covered_by(probe);
+	default:
+		throw InternalException("Unknown spatial join predicate");
+	}
+}
+
+idx_t GeosPreparedJoinCache::Select(Vector &probe_vec, Vector &build_vec, const data_ptr_t *build_rows, idx_t count,
+                                    SelectionVector &sel) {
+	UnifiedVectorFormat probe_format;
+	UnifiedVectorFormat build_format;
+	probe_vec.ToUnifiedFormat(count, probe_format);
+	build_vec.ToUnifiedFormat(count, build_format);
+
+	const auto probe_data = UnifiedVectorFormat::GetData<string_t>(probe_format);
+	const auto build_data = UnifiedVectorFormat::GetData<string_t>(build_format);
+
+	idx_t result_count = 0;
+	for (idx_t i = 0; i < count; i++) {
+		const auto probe_idx = probe_format.sel->get_index(i);
+		const auto build_idx = build_format.sel->get_index(i);
+		if (!probe_format.validity.RowIsValid(probe_idx) || !build_format.validity.RowIsValid(build_idx)) {
+			continue;
+		}
+
+		const auto &build_blob = build_data[build_idx];
+		const auto probe_geom = DeserializeGeometry(ctx, probe_data[probe_idx]);
+
+		auto entry_it = entries.find(build_rows[i]);
+		if (entry_it == entries.end()) {
+			if (entries.size() >= MAX_CACHED_ENTRIES) {
+				// Too many build rows to keep track of. Start over, with the byte budget of the prepared ones
+				Clear();
+			}
+			entry_it = entries.emplace(build_rows[i], make_uniq<Entry>()).first;
+		}
+		auto &entry = *entry_it->second;
+		entry.hits++;
+
+		bool matches;
+		if (entry.prepared) {
+			matches = EvaluatePrepared(predicate, *entry.prepared, probe_geom);
+		} else if (entry.hits == 1) {
+			// Preparing a geometry is expensive, so only do it once we know the build row is probed more than once
+			const auto build_geom = DeserializeGeometry(ctx, build_blob);
+			matches = EvaluateNormal(predicate, build_geom, probe_geom);
+		} else {
+			if (cached_bytes + build_blob.GetSize() > MAX_CACHED_BYTES) {
+				// We've run out of space. Start over, keeping only the current entry
+				auto hits = entry.hits;
+				Clear();
+				entries[build_rows[i]] = make_uniq<Entry>();
+				entries[build_rows[i]]->hits = hits;
+			}
+			auto &cached = *entries[build_rows[i]];
+			cached.geom = make_uniq<GeosGeometry>(DeserializeGeometry(ctx, build_blob));
+			cached.prepared = make_uniq<PreparedGeosGeometry>(ctx, *cached.geom);
+			cached_bytes += build_blob.GetSize();
+			matches = EvaluatePrepared(predicate, *cached.prepared, probe_geom);
+		}
+
+		if (matches) {
+			sel.set_index(result_count++, i);
+		}
+	}
+	return result_count;
+}
+
+} // namespace duckdb
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "duckdb/common/types/vector.hpp"
+#include "duckdb/common/unordered_map.hpp"
+
+// forward declaration from geos_c.h
+struct GEOSContextHandle_HS;
+typedef struct GEOSContextHandle_HS *GEOSContextHandle_t;
+
+namespace duckdb {
+
+enum class GeosJoinPredicate : uint8_t;
+
+// Evaluates a spatial join predicate between probe-side and build-side geometries, keeping the build-side geometries
+// prepared across calls. Build-side rows are identified by their row pointers, which stay pinned (and thus stable) for
+// the lifetime of the join. This is not thread-safe, each thread should have its own cache.
+class GeosPreparedJoinCache {
+public:
+	// Returns nullptr if the predicate can not be evaluated with a prepared build-side geometry
+	static unique_ptr<GeosPreparedJoinCache> TryCreate(const string &predicate_name);
+
+	explicit GeosPreparedJoinCache(GeosJoinPredicate predicate);
+	~GeosPreparedJoinCache();
+
+	// Evaluate the predicate for each (probe, build) pair, and select the rows that match
+	idx_t Select(Vector &probe_vec, Vector &build_vec, const data_ptr_t *build_rows, idx_t count,
+	             SelectionVector &sel);
+
+	// Drop all cached geometries. Must be called before the build rows are released, as their pointers may be reused
+	void Clear();
+
+private:
+	struct Entry;
+
+	GEOSContextHandle_t ctx;
+	GeosJoinPredicate predicate;
+
+	unordered_map<data_ptr_t, unique_ptr<Entry>> entries;
+	idx_t cached_bytes = 0;
+};
+
+} // namespace duckdb
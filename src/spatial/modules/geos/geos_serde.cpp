@@ -42,79 +42,77 @@ static size_t GetCoordSeqLength(const GEOSContextHandle_t ctx, const GEOSCoordSe
 	return len;
 }
 
-static size_t GetRequiredSizeInternal(const GEOSContextHandle_t ctx, const GEOSGeometry *geom) {
+namespace {
+
+// The number of part words and vertices of a GEOS geometry, see geometry_serialization.cpp for the layout
+struct PartLayout {
+	size_t word_count = 0;
+	size_t vertex_count = 0;
+	// The number of polygons with an odd number of rings, which are padded in version 0
+	size_t padding_count = 0;
+};
+
+} // namespace
+
+static void MeasureInternal(const GEOSContextHandle_t ctx, const GEOSGeometry *geom, const bool is_root,
+                            PartLayout &layout) {
 	const auto type = GEOSGeomTypeId_r(ctx, geom);
-	const bool has_z = GEOSHasZ_r(ctx, geom);
-	const bool has_m = GEOSHasM_r(ctx, geom);
 
-	const auto vsize = sizeof(double) * (2 + has_z + has_m);
+	// Throws on unsupported geometry types
+	StorageTypeFromGEOS<uint32_t>(type);
+
+	// The type of the root is stored in the header
+	layout.word_count += is_root ? 1 : 2;
 
 	switch (type) {
-	case GEOS_POINT: {
-		return 4 + 4 + (GEOSisEmpty_r(ctx, geom) ? 0 : vsize);
-	}
+	case GEOS_POINT:
 	case GEOS_LINESTRING: {
-		const auto line_seq = GEOSGeom_getCoordSeq_r(ctx, geom);
-		uint32_t line_len = 0;
-		GEOSCoordSeq_getSize_r(ctx, line_seq, &line_len);
-		return 4 + 4 + line_len * vsize;
+		if (GEOSisEmpty_r(ctx, geom)) {
+			return;
+		}
+		layout.vertex_count += GetCoordSeqLength(ctx, GEOSGeom_getCoordSeq_r(ctx, geom));
+		return;
 	}
 	case GEOS_POLYGON: {
-		// 4 bytes for type,
-		// 4 bytes for num rings
-		//   4 bytes for num points in shell,
-		//   vertex_size bytes per point in shell,
-		// 4 bytes for num holes,
-		//   4 bytes for num points in hole,
-		// 	 vertex_size bytes per point in hole
-		// 4 bytes padding if (shell + holes) % 2 == 1
-		size_t size = 4 + 4;
+		if (GEOSisEmpty_r(ctx, geom)) {
+			return;
+		}
+
+		// One word for the length of the shell and each hole
+		const auto num_rings = GEOSGetNumInteriorRings_r(ctx, geom);
+		layout.word_count += num_rings + 1;
+		layout.padding_count += (num_rings + 1) % 2;
 
 		const auto exterior_ptr = GEOSGetExteriorRing_r(ctx, geom);
-		const auto exterior_seq = GEOSGeom_getCoordSeq_r(ctx, exterior_ptr);
-		uint32_t exterior_len = 0;
-		GEOSCoordSeq_getSize_r(ctx, exterior_seq, &exterior_len);
-		size += 4 + exterior_len * vsize;
+		layout.vertex_count += GetCoordSeqLength(ctx, GEOSGeom_getCoordSeq_r(ctx, exterior_ptr));
 
-		const auto num_rings = GEOSGetNumInteriorRings_r(ctx, geom);
 		for (auto i = 0; i < num_rings; i++) {
 			const auto interior_ptr = GEOSGetInteriorRingN_r(ctx, geom, i);
-			const auto interior_seq = GEOSGeom_getCoordSeq_r(ctx, interior_ptr);
-			uint32_t interior_len = 0;
-			GEOSCoordSeq_getSize_r(ctx, interior_seq, &interior_len);
-			size += 4 + interior_len * vsize;
-		}
-
-		// We need to count the shell as well
-		if ((num_rings + 1) % 2 != 0) {
-			size += 4;
+			layout.vertex_count += GetCoordSeqLength(ctx, GEOSGeom_getCoordSeq_r(ctx, interior_ptr));
 		}
-		return size;
+		return;
 	}
-	case GEOS_MULTIPOINT:
-	case GEOS_MULTILINESTRING:
-	case GEOS_MULTIPOLYGON:
-	case GEOS_GEOMETRYCOLLECTION: {
-		size_t size = 4 + 4;
+	default: {
 		const auto num_items = GEOSGetNumGeometries_r(ctx, geom);
 		for (auto i = 0; i < num_items; i++) {
-			const auto item = GEOSGetGeometryN_r(ctx, geom, i);
-			const auto item_size = GetRequiredSizeInternal(ctx, item);
-			if (item_size == 0) {
-				// Unsupported geometry type
-				return 0;
-			}
-			size += item_size;
+			MeasureInternal(ctx, GEOSGetGeometryN_r(ctx, geom, i), false, layout);
 		}
-		return size;
+		return;
 	}
-	default:
-		// Unsupported geometry type
-		return 0;
 	}
 }
 
-size_t GeosSerde::GetRequiredSize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom) {
+static size_t GetWordsEnd(const size_t bbox_size, const size_t word_count) {
+	// header + bbox + word count + words
+	return 4 + 4 + bbox_size + 4 + word_count * 4;
+}
+
+// Where the vertices start in version 1, or where the blob ends without its vertices in version 0
+static size_t GetVertexOffset(const uint8_t version, const size_t words_end, const PartLayout &layout) {
+	return version == 0 ? words_end + layout.padding_count * sizeof(uint32_t) : GetGeometryVertexOffset(words_end);
+}
+
+size_t GeosSerde::GetRequiredSize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom, const uint8_t version) {
 	const auto is_point = (GEOSGeomTypeId_r(ctx, geom) == GEOS_POINT);
 	const auto is_empty = GEOSisEmpty_r(ctx, geom);
 
@@ -123,12 +121,15 @@ size_t GeosSerde::GetRequiredSize(GEOSContextHandle_t ctx, const GEOSGeom_t *geo
 	const auto has_m = GEOSHasM_r(ctx, geom);
 
 	const auto dims = 2 + (has_z ? 1 : 0) + (has_m ? 1 : 0);
-
-	const auto head_size = 4 + 4; // type + props + padding
-	const auto geom_size = GetRequiredSizeInternal(ctx, geom);
 	const auto bbox_size = has_bbox ? dims * sizeof(float) * 2 : 0;
 
-	const auto full_size = head_size + geom_size + bbox_size;
+	PartLayout layout;
+	MeasureInternal(ctx, geom, true, layout);
+
+	const auto words_end = GetWordsEnd(bbox_size, layout.word_count);
+	const auto vertex_offset =
+	    GetVertexOffset(GetGeometryWriteVersion(version, layout.word_count, words_end), words_end, layout);
+	const auto full_size = vertex_offset + layout.vertex_count * dims * sizeof(double);
 
 	// Check that the size is a multiple of 8
 	D_ASSERT(full_size % 8 == 0);
@@ -146,12 +147,17 @@ static void SerializeCoordSeq(const GEOSContextHandle_t ctx, const GEOSCoordSequ
 	GEOSCoordSeq_copyToBuffer_r(ctx, seq, reinterpret_cast<double *>(buffer), has_z, has_m);
 }
 
-static void SerializeInternal(const GEOSContextHandle_t ctx, const GEOSGeometry *geom, BinaryWriter &cursor) {
+// The vertex cursor is the same as the cursor in version 0
+static void SerializeInternal(const GEOSContextHandle_t ctx, const GEOSGeometry *geom, const uint8_t version,
+                              const bool is_root, BinaryWriter &cursor, BinaryWriter &vertex_cursor) {
 	const auto type = GEOSGeomTypeId_r(ctx, geom);
 	const bool has_z = GEOSHasZ_r(ctx, geom);
 	const bool has_m = GEOSHasM_r(ctx, geom);
 
-	cursor.Write(StorageTypeFromGEOS<uint32_t>(type));
+	// The type of the root is stored in the header
+	if (!is_root) {
+		cursor.Write(StorageTypeFromGEOS<uint32_t>(type));
+	}
 
 	switch (type) {
 	case GEOS_POINT:
@@ -163,7 +169,7 @@ static void SerializeInternal(const GEOSContextHandle_t ctx, const GEOSGeometry
 		const auto seq = GEOSGeom_getCoordSeq_r(ctx, geom);
 		const auto len = GetCoordSeqLength(ctx, seq);
 		cursor.Write<uint32_t>(len);
-		SerializeCoordSeq(ctx, seq, has_z, has_m, len, cursor);
+		SerializeCoordSeq(ctx, seq, has_z, has_m, len, vertex_cursor);
 		return;
 	}
 	case GEOS_POLYGON: {
@@ -174,36 +180,27 @@ static void SerializeInternal(const GEOSContextHandle_t ctx, const GEOSGeometry
 
 		const auto num_rings = GEOSGetNumInteriorRings_r(ctx, geom);
 
-		cursor.Write<uint32_t>(num_rings + 1);
+		const auto ring_count = static_cast<uint32_t>(num_rings + 1);
+		cursor.Write<uint32_t>(ring_count);
+
+		// Write both the lengths and the coordinates in one pass, starting with the exterior ring. The lengths all come
+		// before the coordinates, version 0 pads them to 8 bytes.
+		auto ring_cursor = cursor;
+		cursor.Skip(ring_count * sizeof(uint32_t) + (version == 0 && ring_count % 2 == 1 ? sizeof(uint32_t) : 0), true);
 
 		const auto exterior_ptr = GEOSGetExteriorRing_r(ctx, geom);
 		const auto exterior_seq = GEOSGeom_getCoordSeq_r(ctx, exterior_ptr);
 		const auto exterior_len = GetCoordSeqLength(ctx, exterior_seq);
-
-		// Save the cursor position to write the ring lengths later
-		BinaryWriter len_cursor = cursor;
-
-		// Jump over the ring lengths
-		cursor.Skip(sizeof(uint32_t) * (num_rings + 1));
-
-		// Add padding if odd number of rings
-		if ((num_rings + 1) % 2 != 0) {
-			cursor.Write<uint32_t>(0);
-		}
-
-		// Now write both the length and the coordinates in one pass
-
-		// Starting with the exterior ring
-		len_cursor.Write<uint32_t>(exterior_len);
-		SerializeCoordSeq(ctx, exterior_seq, has_z, has_m, exterior_len, cursor);
+		ring_cursor.Write<uint32_t>(exterior_len);
+		SerializeCoordSeq(ctx, exterior_seq, has_z, has_m, exterior_len, vertex_cursor);
 
 		// And for each interior ring
 		for (auto i = 0; i < num_rings; i++) {
 			const auto interior_ptr = GEOSGetInteriorRingN_r(ctx, geom, i);
 			const auto interior_seq = GEOSGeom_getCoordSeq_r(ctx, interior_ptr);
 			const auto interior_len = GetCoordSeqLength(ctx, interior_seq);
-			len_cursor.Write<uint32_t>(interior_len);
-			SerializeCoordSeq(ctx, interior_seq, has_z, has_m, interior_len, cursor);
+			ring_cursor.Write<uint32_t>(interior_len);
+			SerializeCoordSeq(ctx, interior_seq, has_z, has_m, interior_len, vertex_cursor);
 		}
 		return;
 	}
@@ -215,7 +212,7 @@ static void SerializeInternal(const GEOSContextHandle_t ctx, const GEOSGeometry
 		cursor.Write<uint32_t>(num_items);
 		for (auto i = 0; i < num_items; i++) {
 			const auto item = GEOSGetGeometryN_r(ctx, geom, i);
-			SerializeInternal(ctx, item, cursor);
+			SerializeInternal(ctx, item, version, false, cursor, vertex_cursor);
 		}
 		return;
 	}
@@ -354,7 +351,8 @@ inline void SerializeExtent(const GEOSContextHandle_t ctx, const GEOSGeometry *g
 	}
 }
 
-void GeosSerde::Serialize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom, char *buffer, size_t buffer_size) {
+void GeosSerde::Serialize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom, char *buffer, size_t buffer_size,
+                          const uint8_t requested_version) {
 	BinaryWriter cursor(buffer, buffer_size);
 
 	const auto type = GEOSGeomTypeId_r(ctx, geom);
@@ -367,14 +365,21 @@ void GeosSerde::Serialize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom, char
 	const auto has_z = GEOSHasZ_r(ctx, geom);
 	const auto has_m = GEOSHasM_r(ctx, geom);
 
+	PartLayout layout;
+	MeasureInternal(ctx, geom, true, layout);
+
+	const auto dims = 2 + (has_z ? 1 : 0) + (has_m ? 1 : 0);
+	const auto words_end = GetWordsEnd(has_bbox ? dims * sizeof(float) * 2 : 0, layout.word_count);
+	const auto version = GetGeometryWriteVersion(requested_version, layout.word_count, words_end);
+	const auto vertex_offset = GetVertexOffset(version, words_end, layout);
+
 	// Set flags
-	uint8_t flags = 0;
-	flags |= has_z ? 0x01 : 0;
-	flags |= has_m ? 0x02 : 0;
-	flags |= has_bbox ? 0x04 : 0;
+	GeometryProperties props(has_z, has_m);
+	props.SetBBox(has_bbox);
+	props.SetVersion(version);
 
 	cursor.Write<uint8_t>(StorageTypeFromGEOS<uint8_t>(type));
-	cursor.Write<uint8_t>(flags);
+	cursor.Write<uint8_t>(props.GetFlags());
 	cursor.Write<uint16_t>(0); // unused
 	cursor.Write<uint32_t>(0); // padding
 
@@ -382,8 +387,21 @@ void GeosSerde::Serialize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom, char
 		SerializeExtent(ctx, geom, has_z, has_m, cursor);
 	}
 
+	// Same root word as Serde::Serialize writes
+	const auto root_word = version == 0 ? StorageTypeFromGEOS<uint32_t>(type) : static_cast<uint32_t>(layout.word_count);
+	cursor.Write<uint32_t>(root_word);
+
+	// In version 1 the part words and the vertex stream are written in the same pass, through separate cursors
+	BinaryWriter stream_cursor(buffer + vertex_offset, buffer + buffer_size);
+	auto &vertex_cursor = version == 0 ? cursor : stream_cursor;
+
 	// Serialize the geometry
-	SerializeInternal(ctx, geom, cursor);
+	SerializeInternal(ctx, geom, version, true, cursor, vertex_cursor);
+
+	// The part words can end before the aligned vertex stream starts, zero the gap
+	if (version != 0) {
+		cursor.Skip(vertex_offset - words_end, true);
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -403,6 +421,8 @@ class GEOSDeserializer final : GeometryProcessor<GEOSGeometry *> {
 private:
 	GEOSContextHandle_t ctx;
 	vector<double> aligned_buffer;
+	// Polygons don't nest, so the rings of all polygons can share one buffer
+	vector<GEOSGeometry *> rings;
 
 private:
 	GEOSCoordSeq_t *HandleVertexData(const VertexData &vertices) {
@@ -454,16 +474,13 @@ private:
 		if (num_rings == 0) {
 			return GEOSGeom_createEmptyPolygon_r(ctx);
 		} else {
-			// TODO: Make a vector here instead of using new
-			auto geoms = new GEOSGeometry *[num_rings];
+			rings.clear();
 			for (uint32_t i = 0; i < num_rings; i++) {
 				auto vertices = state.Next();
 				auto seq = HandleVertexData(vertices);
-				geoms[i] = GEOSGeom_createLinearRing_r(ctx, seq);
+				rings.push_back(GEOSGeom_createLinearRing_r(ctx, seq));
 			}
-			auto result = GEOSGeom_createPolygon_r(ctx, geoms[0], geoms + 1, num_rings - 1);
-			delete[] geoms;
-			return result;
+			return GEOSGeom_createPolygon_r(ctx, rings[0], rings.data() + 1, num_rings - 1);
 		}
 	}
 
@@ -486,13 +503,13 @@ private:
 		if (item_count == 0) {
 			return GEOSGeom_createEmptyCollection_r(ctx, collection_type);
 		} else {
-			auto geoms = new GEOSGeometry *[item_count];
+			// Collections can nest, so each needs its own buffer
+			vector<GEOSGeometry *> geoms;
+			geoms.reserve(item_count);
 			for (uint32_t i = 0; i < item_count; i++) {
-				geoms[i] = state.Next();
+				geoms.push_back(state.Next());
 			}
-			auto result = GEOSGeom_createCollection_r(ctx, collection_type, geoms, item_count);
-			delete[] geoms;
-			return result;
+			return GEOSGeom_createCollection_r(ctx, collection_type, geoms.data(), item_count);
 		}
 	}
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 // forward declaration from geos_c.h
 struct GEOSGeom_t;
@@ -12,8 +13,10 @@ namespace duckdb {
 class ArenaAllocator;
 
 struct GeosSerde {
-	static size_t GetRequiredSize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom);
-	static void Serialize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom, char *buffer, size_t buffer_size);
+	//! Like Serde, geometries are written in version 0 unless a newer version is asked for
+	static size_t GetRequiredSize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom, uint8_t version = 0);
+	static void Serialize(GEOSContextHandle_t ctx, const GEOSGeom_t *geom, char *buffer, size_t buffer_size,
+	                      uint8_t version = 0);
 	static GEOSGeom_t *Deserialize(GEOSContextHandle_t ctx, const char *buffer, size_t buffer_size);
 };
 
@@ -45,12 +45,16 @@ struct ExtentAggFunction {
 	template <class INPUT_TYPE, class STATE, class OP>
 	static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &aggregate) {
 
-		// TODO: Vectorize this so we dont clear the arena after each row
-		sgl::geometry geom;
-		Serde::Deserialize(geom, aggregate.input.allocator, input.GetDataUnsafe(), input.GetSize());
+		// The cached bbox is rounded outwards to floats, so if it fits within the current extent, so does the geometry
+		Box2D<float> cached;
+		if (state.is_set && geometry_t(input).TryGetCachedBounds(cached) && state.xmin <= cached.min.x &&
+		    state.ymin <= cached.min.y && state.xmax >= cached.max.x && state.ymax >= cached.max.y) {
+			return;
+		}
 
+		// Otherwise, scan the vertices in place to get the exact extent
 		auto bbox = sgl::box_xy::smallest();
-		if (sgl::ops::try_get_extent_xy(&geom, &bbox)) {
+		if (Serde::TryGetExtentXY(input.GetDataUnsafe(), input.GetSize(), bbox)) {
 
 			if (!state.is_set) {
 				state.is_set = true;
@@ -65,12 +69,11 @@ struct ExtentAggFunction {
 				state.ymax = std::max(state.ymax, bbox.max.y);
 			}
 		}
-
-		aggregate.input.allocator.Reset();
 	}
 
 	template <class INPUT_TYPE, class STATE, class OP>
 	static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &agg, idx_t) {
+		// The extent doesn't change when the same geometry is added again
 		Operation<INPUT_TYPE, STATE, OP>(state, input, agg);
 	}
 
@@ -116,6 +119,66 @@ struct ExtentAggFunction {
 	}
 };
 
+//------------------------------------------------------------------------
+// APPROXIMATE EXTENT AGG
+//------------------------------------------------------------------------
+// The union of the cached bounding boxes of the geometries, as returned by ST_Extent_Approx. These are rounded
+// outwards to floats, and are the same bounds that an RTREE index stores for the geometries, so over a whole table
+// the result can be read from the root of the index instead (see rtree_index_plan_extent.cpp)
+struct ApproxExtentAggFunction : ExtentAggFunction {
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &) {
+		Box2D<float> bbox;
+		if (!geometry_t(input).TryGetCachedBounds(bbox)) {
+			return;
+		}
+		if (!state.is_set) {
+			state.is_set = true;
+			state.xmin = bbox.min.x;
+			state.xmax = bbox.max.x;
+			state.ymin = bbox.min.y;
+			state.ymax = bbox.max.y;
+		} else {
+			state.xmin = std::min<double>(state.xmin, bbox.min.x);
+			state.xmax = std::max<double>(state.xmax, bbox.max.x);
+			state.ymin = std::min<double>(state.ymin, bbox.min.y);
+			state.ymax = std::max<double>(state.ymax, bbox.max.y);
+		}
+	}
+
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &agg, idx_t) {
+		Operation<INPUT_TYPE, STATE, OP>(state, input, agg);
+	}
+
+	// The result is a BOX_2DF struct, so we write the fields of the result vector directly
+	static void Finalize(Vector &states, AggregateInputData &, Vector &result, idx_t count, idx_t offset) {
+		UnifiedVectorFormat sdata;
+		states.ToUnifiedFormat(count, sdata);
+		const auto state_ptrs = UnifiedVectorFormat::GetData<ExtentAggState *>(sdata);
+
+		const auto &entries = StructVector::GetEntries(result);
+		const auto min_x_data = FlatVector::GetData<float>(*entries[0]);
+		const auto min_y_data = FlatVector::GetData<float>(*entries[1]);
+		const auto max_x_data = FlatVector::GetData<float>(*entries[2]);
+		const auto max_y_data = FlatVector::GetData<float>(*entries[3]);
+
+		for (idx_t i = 0; i < count; i++) {
+			const auto &state = *state_ptrs[sdata.sel->get_index(i)];
+			const auto row_idx = i + offset;
+			if (!state.is_set) {
+				FlatVector::SetNull(result, row_idx, true);
+				continue;
+			}
+			// The extent is a union of floats, so this is exact
+			min_x_data[row_idx] = static_cast<float>(state.xmin);
+			min_y_data[row_idx] = static_cast<float>(state.ymin);
+			max_x_data[row_idx] = static_cast<float>(state.xmax);
+			max_y_data[row_idx] = static_cast<float>(state.ymax);
+		}
+	}
+};
+
 //------------------------------------------------------------------------------
 // Documentation
 //------------------------------------------------------------------------------
@@ -128,6 +191,22 @@ static constexpr const char *DOC_EXAMPLE = R"(
 	-- POLYGON ((1 1, 1 5, 5 5, 5 1, 1 1))
 )";
 
+static constexpr const char *DOC_APPROX_DESCRIPTION = R"(
+	Computes the approximate bounding box containing the set of input geometries.
+
+	This is the union of the cached bounding boxes of the geometries (see [ST_Extent_Approx](#st_extent_approx)),
+	which are rounded outwards to floats, so the result contains the exact extent but may be slightly larger.
+	Geometries without a cached bounding box, like empty geometries, are ignored.
+
+	When aggregating a whole table over a column with an RTREE index, the result is read from the bounds of the index
+	instead of scanning the table. Rows that were deleted recently may then still be included in the result, until
+	they are removed from the index.
+)";
+static constexpr const char *DOC_APPROX_EXAMPLE = R"(
+	SELECT ST_Extent_Agg_Approx(geom) FROM UNNEST([ST_Point(1,1), ST_Point(5,5)]) AS _(geom);
+	-- {'min_x': 1.0, 'min_y': 1.0, 'max_x': 5.0, 'max_y': 5.0}
+)";
+
 static constexpr const char *DOC_ALIAS_DESCRIPTION = R"(
 	Alias for [ST_Extent_Agg](#st_extent_agg).
 
@@ -154,6 +233,23 @@ void RegisterSpatialAggregateFunctions(DatabaseInstance &db) {
 		func.SetTag("category", "construction");
 	});
 
+	AggregateFunction approx_agg(
+	    {GeoTypes::GEOMETRY()}, GeoTypes::BOX_2DF(), AggregateFunction::StateSize<ExtentAggState>,
+	    AggregateFunction::StateInitialize<ExtentAggState, ApproxExtentAggFunction>,
+	    AggregateFunction::UnaryScatterUpdate<ExtentAggState, string_t, ApproxExtentAggFunction>,
+	    AggregateFunction::StateCombine<ExtentAggState, ApproxExtentAggFunction>, ApproxExtentAggFunction::Finalize,
+	    FunctionNullHandling::DEFAULT_NULL_HANDLING,
+	    AggregateFunction::UnaryUpdate<ExtentAggState, string_t, ApproxExtentAggFunction>);
+
+	FunctionBuilder::RegisterAggregate(db, "ST_Extent_Agg_Approx", [&](AggregateFunctionBuilder &func) {
+		func.SetFunction(approx_agg);
+		func.SetDescription(DOC_APPROX_DESCRIPTION);
+		func.SetExample(DOC_APPROX_EXAMPLE);
+
+		func.SetTag("ext", "spatial");
+		func.SetTag("category", "construction");
+	});
+
 	FunctionBuilder::RegisterAggregate(db, "ST_Envelope_Agg", [&](AggregateFunctionBuilder &func) {
 		func.SetFunction(agg);
 		func.SetDescription(DOC_ALIAS_DESCRIPTION);
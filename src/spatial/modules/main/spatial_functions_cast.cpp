@@ -2,8 +2,10 @@
 #include "spatial/geometry/geometry_processor.hpp"
 #include "spatial/geometry/sgl.hpp"
 #include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/geometry_compression.hpp"
 #include "spatial/spatial_types.hpp"
 #include "spatial/util/math.hpp"
+#include "spatial/util/scratch_pool.hpp"
 #include "spatial/geometry/wkb_writer.hpp"
 
 #include "duckdb/common/error_data.hpp"
@@ -25,7 +27,8 @@ namespace {
 
 class LocalState final : public FunctionLocalState {
 public:
-	explicit LocalState(ClientContext &context) : arena(BufferAllocator::Get(context)), allocator(arena) {
+	explicit LocalState(ClientContext &context)
+	    : pool(GeometryScratchPool::Get(context)), arena(pool->GetAllocator()), allocator(arena) {
 	}
 
 	static unique_ptr<FunctionLocalState> InitCast(CastLocalStateParameters &params);
@@ -43,6 +46,7 @@ public:
 	}
 
 private:
+	shared_ptr<GeometryScratchPool> pool;
 	ArenaAllocator arena;
 	GeometryAllocator allocator;
 };
@@ -53,7 +57,7 @@ unique_ptr<FunctionLocalState> LocalState::InitCast(CastLocalStateParameters &pa
 
 LocalState &LocalState::ResetAndGet(CastParameters &state) {
 	auto &local_state = state.local_state->Cast<LocalState>();
-	local_state.arena.Reset();
+	GeometryScratchPool::Reset(local_state.arena);
 	return local_state;
 }
 
@@ -129,8 +133,7 @@ struct GeometryCasts {
 	// GEOMETRY -> WKB_BLOB
 	//------------------------------------------------------------------------------------------------------------------
 	static bool ToWKBCast(Vector &source, Vector &result, idx_t count, CastParameters &) {
-		UnaryExecutor::Execute<string_t, string_t>(
-		    source, result, count, [&](const string_t &input) { return WKBWriter::Write(input, result); });
+		WKBWriter::Write(source, result, count);
 		return true;
 	}
 
@@ -208,6 +211,92 @@ struct GeometryCasts {
 	}
 };
 
+//======================================================================================================================
+// COMPRESSED_GEOMETRY Casts
+//======================================================================================================================
+
+struct CompressedGeometryCasts {
+
+	static void Compress(Vector &source, Vector &result, idx_t count) {
+		vector<char> buffer;
+		UnaryExecutor::Execute<string_t, string_t>(source, result, count, [&](const string_t &blob) {
+			GeometryCompression::Compress(blob.GetDataUnsafe(), blob.GetSize(), buffer);
+			return StringVector::AddStringOrBlob(result, buffer.data(), buffer.size());
+		});
+	}
+
+	static void Decompress(Vector &source, Vector &result, idx_t count) {
+		UnaryExecutor::Execute<string_t, string_t>(source, result, count, [&](const string_t &compressed) {
+			const auto size = GeometryCompression::GetDecompressedSize(compressed.GetDataUnsafe(), compressed.GetSize());
+			auto blob = StringVector::EmptyString(result, size);
+			GeometryCompression::Decompress(compressed.GetDataUnsafe(), compressed.GetSize(),
+			                                blob.GetDataWriteable(), size);
+			blob.Finalize();
+			return blob;
+		});
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// GEOMETRY -> COMPRESSED_GEOMETRY
+	//------------------------------------------------------------------------------------------------------------------
+	static bool FromGeometryCast(Vector &source, Vector &result, idx_t count, CastParameters &) {
+		Compress(source, result, count);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// COMPRESSED_GEOMETRY -> GEOMETRY
+	//------------------------------------------------------------------------------------------------------------------
+	static bool ToGeometryCast(Vector &source, Vector &result, idx_t count, CastParameters &) {
+		Decompress(source, result, count);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// COMPRESSED_GEOMETRY -> VARCHAR
+	//------------------------------------------------------------------------------------------------------------------
+	static bool ToVarcharCast(Vector &source, Vector &result, idx_t count, CastParameters &) {
+		Vector geometry(GeoTypes::GEOMETRY(), count);
+		Decompress(source, geometry, count);
+		CoreVectorOperations::GeometryToVarchar(geometry, result, count);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// VARCHAR -> COMPRESSED_GEOMETRY
+	//------------------------------------------------------------------------------------------------------------------
+	static bool FromVarcharCast(Vector &source, Vector &result, idx_t count, CastParameters &parameters) {
+		Vector geometry(GeoTypes::GEOMETRY(), count);
+		const auto success = GeometryCasts::FromVarcharCast(source, geometry, count, parameters);
+		Compress(geometry, result, count);
+		return success;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		const auto compressed_type = GeoTypes::COMPRESSED_GEOMETRY();
+		const auto geom_type = GeoTypes::GEOMETRY();
+
+		// Geometry -> Compressed geometry is explicitly castable, which is enough to insert into a column
+		ExtensionUtil::RegisterCastFunction(db, geom_type, compressed_type, BoundCastInfo(FromGeometryCast));
+
+		// Compressed geometry -> Geometry is implicitly castable, so all geometry functions accept it
+		ExtensionUtil::RegisterCastFunction(db, compressed_type, geom_type, BoundCastInfo(ToGeometryCast), 1);
+
+		// Compressed geometry -> VARCHAR is explicitly castable
+		ExtensionUtil::RegisterCastFunction(db, compressed_type, LogicalType::VARCHAR, BoundCastInfo(ToVarcharCast));
+
+		// VARCHAR -> Compressed geometry is explicitly castable
+		ExtensionUtil::RegisterCastFunction(db, LogicalType::VARCHAR, compressed_type,
+		                                    BoundCastInfo(FromVarcharCast, nullptr, LocalState::InitCast));
+
+		// Compressed geometry -> BLOB is explicitly castable
+		ExtensionUtil::RegisterCastFunction(db, compressed_type, LogicalType::BLOB, DefaultCasts::ReinterpretCast);
+	}
+};
+
 //======================================================================================================================
 // POINT_2D Casts
 //======================================================================================================================
@@ -226,18 +315,22 @@ struct PointCasts {
 	// POINT_2D -> GEOMETRY
 	//------------------------------------------------------------------------------------------------------------------
 	static bool ToGeometryCast(Vector &source, Vector &result, idx_t count, CastParameters &parameters) {
-		using POINT_TYPE = StructTypeBinary<double, double>;
-		using GEOMETRY_TYPE = PrimitiveType<string_t>;
-
-		auto &lstate = LocalState::ResetAndGet(parameters);
-
-		GenericExecutor::ExecuteUnary<POINT_TYPE, GEOMETRY_TYPE>(source, result, count, [&](const POINT_TYPE &point) {
-			const double buffer[2] = {point.a_val, point.b_val};
-			sgl::geometry geom(sgl::geometry_type::POINT, false, false);
-			geom.set_vertex_data(reinterpret_cast<const uint8_t *>(buffer), 1);
+		// Point blobs all have the same size and layout, so write them all at once
+		if (source.GetVectorType() == VectorType::CONSTANT_VECTOR) {
+			if (ConstantVector::IsNull(source)) {
+				result.SetVectorType(VectorType::CONSTANT_VECTOR);
+				ConstantVector::SetNull(result, true);
+				return true;
+			}
+			// The children of a constant struct are constant as well
+			auto &children = StructVector::GetEntries(source);
+			Serde::SerializePointsXY(*children[0], *children[1], result, count);
+			return true;
+		}
 
-			return lstate.Serialize(result, geom);
-		});
+		source.Flatten(count);
+		auto &children = StructVector::GetEntries(source);
+		Serde::SerializePointsXY(*children[0], *children[1], result, count, &FlatVector::Validity(source));
 		return true;
 	}
 
@@ -251,6 +344,13 @@ struct PointCasts {
 		auto &lstate = LocalState::ResetAndGet(parameters);
 
 		GenericExecutor::ExecuteUnary<GEOMETRY_TYPE, POINT_TYPE>(source, result, count, [&](const GEOMETRY_TYPE &blob) {
+			// Fast path: read the coordinates of 2D points at their fixed offsets
+			double x;
+			double y;
+			if (Serde::TryGetPointXY(blob.val.GetData(), blob.val.GetSize(), x, y)) {
+				return POINT_TYPE {x, y};
+			}
+
 			sgl::geometry geom;
 			lstate.Deserialize(blob.val, geom);
 
@@ -297,8 +397,7 @@ struct PointCasts {
 		ExtensionUtil::RegisterCastFunction(db, GeoTypes::POINT_2D(), LogicalType::VARCHAR,
 		                                    BoundCastInfo(ToVarcharCast), 1);
 		// POINT_2D -> GEOMETRY
-		ExtensionUtil::RegisterCastFunction(db, GeoTypes::POINT_2D(), GeoTypes::GEOMETRY(),
-		                                    BoundCastInfo(ToGeometryCast, nullptr, LocalState::InitCast), 1);
+		ExtensionUtil::RegisterCastFunction(db, GeoTypes::POINT_2D(), GeoTypes::GEOMETRY(), ToGeometryCast, 1);
 		// GEOMETRY -> POINT_2D
 		ExtensionUtil::RegisterCastFunction(db, GeoTypes::GEOMETRY(), GeoTypes::POINT_2D(),
 		                                    BoundCastInfo(FromGeometryCast, nullptr, LocalState::InitCast), 1);
@@ -947,6 +1046,7 @@ void CoreVectorOperations::GeometryToVarchar(Vector &source, Vector &result, idx
 
 void RegisterSpatialCastFunctions(DatabaseInstance &db) {
 	GeometryCasts::Register(db);
+	CompressedGeometryCasts::Register(db);
 	PointCasts::Register(db);
 	LinestringCasts::Register(db);
 	PolygonCasts::Register(db);
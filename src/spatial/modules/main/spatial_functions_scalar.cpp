@@ -1,12 +1,18 @@
 // Spatial
 #include "spatial/modules/main/spatial_functions.hpp"
+#include "spatial/geometry/geojson_reader.hpp"
+#include "spatial/geometry/geometry_compression.hpp"
+#include "spatial/geometry/geometry_cursor.hpp"
 #include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/geometry_stats.hpp"
 #include "spatial/geometry/sgl.hpp"
+#include "spatial/geometry/spatial_key.hpp"
 #include "spatial/geometry/wkb_writer.hpp"
 #include "spatial/spatial_types.hpp"
 #include "spatial/util/binary_reader.hpp"
 #include "spatial/util/function_builder.hpp"
 #include "spatial/util/math.hpp"
+#include "spatial/util/scratch_pool.hpp"
 
 // DuckDB
 #include "duckdb/common/types/blob.hpp"
@@ -32,7 +38,8 @@ namespace {
 
 class LocalState final : public FunctionLocalState {
 public:
-	explicit LocalState(ClientContext &context) : arena(BufferAllocator::Get(context)), allocator(arena) {
+	explicit LocalState(ClientContext &context)
+	    : pool(GeometryScratchPool::Get(context)), arena(pool->GetAllocator()), allocator(arena) {
 	}
 
 	static unique_ptr<FunctionLocalState> Init(ExpressionState &state, const BoundFunctionExpression &expr,
@@ -52,6 +59,7 @@ public:
 	}
 
 private:
+	shared_ptr<GeometryScratchPool> pool;
 	ArenaAllocator arena;
 	GeometryAllocator allocator;
 };
@@ -63,7 +71,7 @@ unique_ptr<FunctionLocalState> LocalState::Init(ExpressionState &state, const Bo
 
 LocalState &LocalState::ResetAndGet(ExpressionState &state) {
 	auto &local_state = ExecuteFunctionState::GetFunctionState(state)->Cast<LocalState>();
-	local_state.arena.Reset();
+	GeometryScratchPool::Reset(local_state.arena);
 	return local_state;
 }
 
@@ -188,10 +196,6 @@ struct ST_Affine {
 			    // Reset the arena after every iteration, to avoid holding onto too much memory
 			    lstate.GetArena().Reset();
 
-			    // Deserialize the geometry
-			    sgl::geometry geom;
-			    lstate.Deserialize(geom_blob, geom);
-
 			    // Setup the matrix
 			    auto matrix = sgl::affine_matrix::identity();
 			    matrix.v[0] = a;    // a
@@ -201,6 +205,31 @@ struct ST_Affine {
 			    matrix.v[5] = e;    // e
 			    matrix.v[7] = yoff; // yoff
 
+			    // The vertices of all parts are stored in one stream, so we can transform a copy of the blob in place
+			    size_t vertex_offset;
+			    size_t vertex_count;
+			    if (Serde::TryGetVertexStream(geom_blob.GetData(), geom_blob.GetSize(), vertex_offset, vertex_count)) {
+				    auto blob = StringVector::AddStringOrBlob(result, geom_blob);
+				    const auto data = blob.GetDataWriteable();
+				    const auto vertex_size = geometry_t(geom_blob).GetProperties().VertexSize();
+
+				    for (size_t i = 0; i < vertex_count; i++) {
+					    const auto vertex_ptr = data + vertex_offset + i * vertex_size;
+					    sgl::vertex_xy vertex;
+					    memcpy(&vertex, vertex_ptr, sizeof(sgl::vertex_xy));
+					    vertex = matrix.apply_xy(vertex);
+					    memcpy(vertex_ptr, &vertex, sizeof(sgl::vertex_xy));
+				    }
+
+				    Serde::UpdateBounds(data, blob.GetSize());
+				    blob.Finalize();
+				    return blob;
+			    }
+
+			    // Deserialize the geometry
+			    sgl::geometry geom;
+			    lstate.Deserialize(geom_blob, geom);
+
 			    // Transform the geometry
 			    sgl::ops::affine_transform(&alloc, &geom, &matrix);
 
@@ -333,13 +362,15 @@ struct ST_Area {
 	// GEOMETRY
 	//------------------------------------------------------------------------------------------------------------------
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
-
-		auto &lstate = LocalState::ResetAndGet(state);
-
 		UnaryExecutor::Execute<string_t, double>(args.data[0], result, args.size(), [&](const string_t &blob) {
-			sgl::geometry geom;
-			lstate.Deserialize(blob, geom);
-			return sgl::ops::area(&geom);
+			// Add the area of the shell and subtract the area of the holes of every polygon
+			return SumVertexSpans(blob, [](const GeometryPart &part) {
+				if (!part.is_ring) {
+					return 0.0;
+				}
+				const auto ring_area = std::abs(part.vertices.SignedArea());
+				return part.index == 0 ? ring_area : -ring_area;
+			});
 		});
 	}
 
@@ -457,7 +488,6 @@ struct ST_Area {
 				variant.AddParameter("geom", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::DOUBLE);
 
-				variant.SetInit(LocalState::Init);
 				variant.SetFunction(Execute);
 			});
 
@@ -508,227 +538,207 @@ struct ST_Area {
 
 using namespace duckdb_yyjson_spatial;
 
-class JSONAllocator {
-	// Stolen from the JSON extension :)
-public:
-	explicit JSONAllocator(ArenaAllocator &allocator)
-	    : allocator(allocator), yyjson_allocator({Allocate, Reallocate, Free, &allocator}) {
-	}
-	yyjson_alc *GetYYJSONAllocator() {
-		return &yyjson_allocator;
-	}
-	void Reset() {
-		allocator.Reset();
-	}
-
-private:
-	static void *Allocate(void *ctx, size_t size) {
-		const auto alloc = static_cast<ArenaAllocator *>(ctx);
-		return alloc->AllocateAligned(size);
-	}
-	static void *Reallocate(void *ctx, void *ptr, size_t old_size, size_t size) {
-		const auto alloc = static_cast<ArenaAllocator *>(ctx);
-		return alloc->ReallocateAligned(data_ptr_cast(ptr), old_size, size);
-	}
-	static void Free(void *ctx, void *ptr) {
-		// NOP because ArenaAllocator can't free
-	}
-	ArenaAllocator &allocator;
-	yyjson_alc yyjson_allocator;
-};
-
 struct ST_AsGeoJSON {
 
 	//------------------------------------------------------------------------------------------------------------------
 	// JSON Formatting Functions
 	//------------------------------------------------------------------------------------------------------------------
-	// TODO: Move these into SGL at some point, make non-recursive
-	static void FormatCoord(const sgl::geometry *geom, yyjson_mut_doc *doc, yyjson_mut_val *obj) {
-		const auto vertex_type = static_cast<sgl::vertex_type>(geom->has_z() + geom->has_m() * 2);
-		const auto vertex_count = geom->get_count();
-
-		if (vertex_count == 0) {
-			// Make empty
-			const auto coord = yyjson_mut_arr(doc);
-			yyjson_mut_obj_add_val(doc, obj, "coordinates", coord);
-			return;
+	// Writes the GeoJSON text directly into a reusable buffer in a single pass over the geometry, instead of building
+	// an intermediate yyjson document. Numbers are formatted with the yyjson shortest round-trip double writer, so the
+	// output is identical to what serializing a document would produce.
+	class GeoJSONWriter {
+	public:
+		explicit GeoJSONWriter(vector<char> &buffer_p) : buffer(buffer_p) {
 		}
 
-		// GeoJSON does not support M values, so we ignore them
-		switch (vertex_type) {
-		case sgl::vertex_type::XY:
-		case sgl::vertex_type::XYM: {
-			const auto coord = yyjson_mut_arr(doc);
-			const auto vert = geom->get_vertex_xy(0);
-			yyjson_mut_arr_add_real(doc, coord, vert.x);
-			yyjson_mut_arr_add_real(doc, coord, vert.y);
-			yyjson_mut_obj_add_val(doc, obj, "coordinates", coord);
-
-		} break;
-		case sgl::vertex_type::XYZ:
-		case sgl::vertex_type::XYZM: {
-			const auto coord = yyjson_mut_arr(doc);
-			const auto vert = geom->get_vertex_xyzm(0);
+		void SetPrecision(int32_t precision) {
+			if (precision < 0 || precision > 15) {
+				throw InvalidInputException("ST_AsGeoJSON: Precision must be between 0 and 15");
+			}
+			scale = std::pow(10.0, precision);
+		}
 
-			yyjson_mut_arr_add_real(doc, coord, vert.x);
-			yyjson_mut_arr_add_real(doc, coord, vert.y);
-			yyjson_mut_arr_add_real(doc, coord, vert.zm);
-			yyjson_mut_obj_add_val(doc, obj, "coordinates", coord);
+		void Write(const sgl::geometry *geom) {
+			const auto root = geom->get_parent();
+			auto curr = geom;
 
-		} break;
-		default:
-			D_ASSERT(false);
-			break;
-		}
-	}
+			while (true) {
+				switch (curr->get_type()) {
+				case sgl::geometry_type::POINT: {
+					WriteLiteral("{\"type\":\"Point\",\"coordinates\":");
+					if (curr->is_empty()) {
+						WriteLiteral("[]");
+					} else {
+						WriteVertex(curr, 0);
+					}
+					WriteChar('}');
+				} break;
+				case sgl::geometry_type::LINESTRING: {
+					WriteLiteral("{\"type\":\"LineString\",\"coordinates\":");
+					WriteVertices(curr);
+					WriteChar('}');
+				} break;
+				case sgl::geometry_type::POLYGON: {
+					WriteLiteral("{\"type\":\"Polygon\",\"coordinates\":");
+					WritePolygon(curr);
+					WriteChar('}');
+				} break;
+				case sgl::geometry_type::MULTI_POINT: {
+					WriteLiteral("{\"type\":\"MultiPoint\",\"coordinates\":[");
+					auto first = true;
+					ForEachPart(curr, [&](const sgl::geometry *part) {
+						// Empty points have no representation in a GeoJSON MultiPoint, skip them
+						if (part->is_empty()) {
+							return;
+						}
+						if (!first) {
+							WriteChar(',');
+						}
+						first = false;
+						WriteVertex(part, 0);
+					});
+					WriteLiteral("]}");
+				} break;
+				case sgl::geometry_type::MULTI_LINESTRING: {
+					WriteLiteral("{\"type\":\"MultiLineString\",\"coordinates\":[");
+					ForEachPart(curr, [&](const sgl::geometry *part) {
+						if (part != curr->get_first_part()) {
+							WriteChar(',');
+						}
+						WriteVertices(part);
+					});
+					WriteLiteral("]}");
+				} break;
+				case sgl::geometry_type::MULTI_POLYGON: {
+					WriteLiteral("{\"type\":\"MultiPolygon\",\"coordinates\":[");
+					ForEachPart(curr, [&](const sgl::geometry *part) {
+						if (part != curr->get_first_part()) {
+							WriteChar(',');
+						}
+						WritePolygon(part);
+					});
+					WriteLiteral("]}");
+				} break;
+				case sgl::geometry_type::MULTI_GEOMETRY: {
+					WriteLiteral("{\"type\":\"GeometryCollection\",\"geometries\":[");
+					if (!curr->is_empty()) {
+						// Descend into the collection, it is closed when we walk back up
+						curr = curr->get_first_part();
+						continue;
+					}
+					WriteLiteral("]}");
+				} break;
+				default:
+					D_ASSERT(false);
+					return;
+				}
 
-	static void FormatCoords(const sgl::geometry *geom, yyjson_mut_doc *doc, yyjson_mut_val *obj) {
-		const auto vertex_type = static_cast<sgl::vertex_type>(geom->has_z() + geom->has_m() * 2);
-		const auto vertex_count = geom->get_count();
+				while (true) {
+					const auto parent = curr->get_parent();
+					if (parent == root) {
+						return;
+					}
 
-		// GeoJSON does not support M values, so we ignore them
-		switch (vertex_type) {
-		case sgl::vertex_type::XY:
-		case sgl::vertex_type::XYM: {
-			for (uint32_t i = 0; i < vertex_count; i++) {
-				const auto coord = yyjson_mut_arr(doc);
-				const auto vert = geom->get_vertex_xy(i);
-				yyjson_mut_arr_add_real(doc, coord, vert.x);
-				yyjson_mut_arr_add_real(doc, coord, vert.y);
-				yyjson_mut_arr_append(obj, coord);
-			}
-		} break;
-		case sgl::vertex_type::XYZ:
-		case sgl::vertex_type::XYZM: {
-			for (uint32_t i = 0; i < vertex_count; i++) {
-				const auto coord = yyjson_mut_arr(doc);
-				const auto vert = geom->get_vertex_xyzm(i);
+					if (curr != parent->get_last_part()) {
+						// Go sideways
+						WriteChar(',');
+						curr = curr->get_next();
+						break;
+					}
 
-				yyjson_mut_arr_add_real(doc, coord, vert.x);
-				yyjson_mut_arr_add_real(doc, coord, vert.y);
-				yyjson_mut_arr_add_real(doc, coord, vert.zm);
-				yyjson_mut_arr_append(obj, coord);
+					// Go upwards, closing the collection
+					WriteLiteral("]}");
+					curr = parent;
+				}
 			}
-		} break;
-		default:
-			D_ASSERT(false);
-			break;
 		}
-	}
-
-	static void FormatRecursive(const sgl::geometry *geom, yyjson_mut_doc *doc, yyjson_mut_val *obj) {
-		switch (geom->get_type()) {
-		case sgl::geometry_type::POINT: {
-			yyjson_mut_obj_add_str(doc, obj, "type", "Point");
-			FormatCoord(geom, doc, obj);
-		} break;
-		case sgl::geometry_type::LINESTRING: {
-			yyjson_mut_obj_add_str(doc, obj, "type", "LineString");
-			const auto coords = yyjson_mut_arr(doc);
-			yyjson_mut_obj_add_val(doc, obj, "coordinates", coords);
-			FormatCoords(geom, doc, coords);
-		} break;
-		case sgl::geometry_type::POLYGON: {
-			yyjson_mut_obj_add_str(doc, obj, "type", "Polygon");
-			const auto coords = yyjson_mut_arr(doc);
-			yyjson_mut_obj_add_val(doc, obj, "coordinates", coords);
 
+	private:
+		template <class CALLBACK>
+		static void ForEachPart(const sgl::geometry *geom, CALLBACK &&callback) {
 			const auto tail = geom->get_last_part();
 			auto head = tail;
 			if (head) {
 				do {
 					head = head->get_next();
-					const auto ring = yyjson_mut_arr(doc);
-					FormatCoords(head, doc, ring);
-					yyjson_mut_arr_append(coords, ring);
+					callback(head);
 				} while (head != tail);
 			}
-		} break;
-		case sgl::geometry_type::MULTI_POINT: {
-			yyjson_mut_obj_add_str(doc, obj, "type", "MultiPoint");
+		}
 
-			const auto coords = yyjson_mut_arr(doc);
-			yyjson_mut_obj_add_val(doc, obj, "coordinates", coords);
+		void WriteChar(char c) {
+			buffer.push_back(c);
+		}
 
-			const auto tail = geom->get_last_part();
-			auto head = tail;
+		template <size_t N>
+		void WriteLiteral(const char (&str)[N]) {
+			buffer.insert(buffer.end(), str, str + N - 1);
+		}
 
-			if (head) {
-				do {
-					head = head->get_next();
-					FormatCoords(head, doc, coords);
-				} while (head != tail);
+		void WriteNumber(double value) {
+			if (scale != 0) {
+				// Round to the requested number of decimals. Values that are too large to be scaled exactly already
+				// have no fractional digits to round away. Adding zero turns a rounded negative zero into zero.
+				const auto scaled = value * scale;
+				if (std::abs(scaled) < 9007199254740992.0) {
+					value = std::round(scaled) / scale + 0.0;
+				}
 			}
-		} break;
-		case sgl::geometry_type::MULTI_LINESTRING: {
-			yyjson_mut_obj_add_str(doc, obj, "type", "MultiLineString");
-
-			const auto coords = yyjson_mut_arr(doc);
-			yyjson_mut_obj_add_val(doc, obj, "coordinates", coords);
 
-			const auto tail = geom->get_last_part();
-			auto head = tail;
+			// The yyjson writer requires 32 bytes of space
+			const auto offset = buffer.size();
+			buffer.resize(offset + 32);
+			const auto begin = buffer.data() + offset;
+			const auto end = yyjson_write_number_f64(value, begin, YYJSON_WRITE_INF_AND_NAN_AS_NULL);
+			buffer.resize(offset + static_cast<size_t>(end - begin));
+		}
 
-			if (head) {
-				do {
-					head = head->get_next();
-					const auto line = yyjson_mut_arr(doc);
-					FormatCoords(head, doc, line);
-					yyjson_mut_arr_append(coords, line);
-				} while (head != tail);
+		void WriteVertex(const sgl::geometry *geom, uint32_t i) {
+			// GeoJSON does not support M values, so we ignore them
+			WriteChar('[');
+			if (geom->has_z()) {
+				const auto vert = geom->get_vertex_xyzm(i);
+				WriteNumber(vert.x);
+				WriteChar(',');
+				WriteNumber(vert.y);
+				WriteChar(',');
+				WriteNumber(vert.zm);
+			} else {
+				const auto vert = geom->get_vertex_xy(i);
+				WriteNumber(vert.x);
+				WriteChar(',');
+				WriteNumber(vert.y);
 			}
-		} break;
-		case sgl::geometry_type::MULTI_POLYGON: {
-			yyjson_mut_obj_add_str(doc, obj, "type", "MultiPolygon");
-
-			const auto coords = yyjson_mut_arr(doc);
-			yyjson_mut_obj_add_val(doc, obj, "coordinates", coords);
-
-			const auto tail = geom->get_last_part();
-			auto head = tail;
+			WriteChar(']');
+		}
 
-			if (head) {
-				do {
-					head = head->get_next();
-					const auto poly = yyjson_mut_arr(doc);
-
-					const auto ring_tail = head->get_last_part();
-					auto ring_head = ring_tail;
-					if (ring_head) {
-						do {
-							ring_head = ring_head->get_next();
-							const auto ring = yyjson_mut_arr(doc);
-							FormatCoords(ring_head, doc, ring);
-							yyjson_mut_arr_append(poly, ring);
-						} while (ring_head != ring_tail);
-					}
-					yyjson_mut_arr_append(coords, poly);
-				} while (head != tail);
+		void WriteVertices(const sgl::geometry *geom) {
+			WriteChar('[');
+			const auto vertex_count = geom->get_count();
+			for (uint32_t i = 0; i < vertex_count; i++) {
+				if (i != 0) {
+					WriteChar(',');
+				}
+				WriteVertex(geom, i);
 			}
-		} break;
-		case sgl::geometry_type::MULTI_GEOMETRY: {
-			yyjson_mut_obj_add_str(doc, obj, "type", "GeometryCollection");
-
-			const auto geoms = yyjson_mut_arr(doc);
-			yyjson_mut_obj_add_val(doc, obj, "geometries", geoms);
-
-			const auto tail = geom->get_last_part();
-			auto head = tail;
+			WriteChar(']');
+		}
 
-			if (head) {
-				do {
-					head = head->get_next();
-					const auto sub_geom = yyjson_mut_obj(doc);
-					FormatRecursive(head, doc, sub_geom);
-					yyjson_mut_arr_append(geoms, sub_geom);
-				} while (head != tail);
-			}
-		} break;
-		default:
-			D_ASSERT(false);
-			break;
+		void WritePolygon(const sgl::geometry *geom) {
+			WriteChar('[');
+			ForEachPart(geom, [&](const sgl::geometry *ring) {
+				if (ring != geom->get_first_part()) {
+					WriteChar(',');
+				}
+				WriteVertices(ring);
+			});
+			WriteChar(']');
 		}
-	}
+
+		vector<char> &buffer;
+		// Scale factor used to round coordinates to a fixed number of decimals, zero if coordinates are not rounded
+		double scale = 0;
+	};
 
 	//------------------------------------------------------------------------------------------------------------------
 	// GEOMETRY
@@ -736,26 +746,41 @@ struct ST_AsGeoJSON {
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		auto &lstate = LocalState::ResetAndGet(state);
 
-		JSONAllocator allocator(lstate.GetArena());
+		vector<char> buffer;
+		GeoJSONWriter writer(buffer);
+
+		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &blob) {
+			buffer.clear();
 
-		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](string_t &blob) {
 			sgl::geometry geom;
 			lstate.Deserialize(blob, geom);
 
-			const auto doc = yyjson_mut_doc_new(allocator.GetYYJSONAllocator());
-			const auto obj = yyjson_mut_obj(doc);
-			yyjson_mut_doc_set_root(doc, obj);
+			writer.Write(&geom);
 
-			FormatRecursive(&geom, doc, obj);
-
-			size_t json_size = 0;
-			char *json_data = yyjson_mut_write_opts(doc, 0, allocator.GetYYJSONAllocator(), &json_size, nullptr);
-			// Because the arena allocator only resets after each pipeline invocation, we can safely just point into the
-			// arena here without needing to copy the data to the string heap with StringVector::AddString
-			return string_t {json_data, static_cast<uint32_t>(json_size)};
+			return StringVector::AddString(result, buffer.data(), buffer.size());
 		});
 	}
 
+	static void ExecuteWithPrecision(DataChunk &args, ExpressionState &state, Vector &result) {
+		auto &lstate = LocalState::ResetAndGet(state);
+
+		vector<char> buffer;
+		GeoJSONWriter writer(buffer);
+
+		BinaryExecutor::Execute<string_t, int32_t, string_t>(
+		    args.data[0], args.data[1], result, args.size(), [&](const string_t &blob, const int32_t precision) {
+			    buffer.clear();
+
+			    sgl::geometry geom;
+			    lstate.Deserialize(blob, geom);
+
+			    writer.SetPrecision(precision);
+			    writer.Write(&geom);
+
+			    return StringVector::AddString(result, buffer.data(), buffer.size());
+		    });
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// Documentation
 	//------------------------------------------------------------------------------------------------------------------
@@ -765,6 +790,10 @@ struct ST_AsGeoJSON {
 	    This does not return a complete GeoJSON document, only the geometry fragment.
 		To construct a complete GeoJSON document or feature, look into using the DuckDB JSON extension in conjunction with this function.
 		This function supports geometries with Z values, but not M values. M values are ignored.
+
+		The optional `precision` argument rounds the coordinates to the given number of decimal places (between 0 and 15),
+		otherwise coordinates are written with the shortest representation that round-trips to the same double.
+		Non-finite coordinates are written as `null`.
 	)";
 
 	static constexpr auto EXAMPLE = R"(
@@ -772,6 +801,10 @@ struct ST_AsGeoJSON {
 		----
 		{"type":"Polygon","coordinates":[[[0.0,0.0],[0.0,1.0],[1.0,1.0],[1.0,0.0],[0.0,0.0]]]}
 
+		select ST_AsGeoJSON('POINT(1.23456 7.891011)'::geometry, 2);
+		----
+		{"type":"Point","coordinates":[1.23,7.89]}
+
 		-- Convert a geometry into a full GeoJSON feature (requires the JSON extension to be loaded)
 		SELECT CAST({
 			type: 'Feature',
@@ -797,6 +830,15 @@ struct ST_AsGeoJSON {
 				variant.SetFunction(Execute);
 			});
 
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("geom", GeoTypes::GEOMETRY());
+				variant.AddParameter("precision", LogicalType::INTEGER);
+				variant.SetReturnType(LogicalType::JSON());
+
+				variant.SetInit(LocalState::Init);
+				variant.SetFunction(ExecuteWithPrecision);
+			});
+
 			func.SetDescription(DESCRIPTION);
 			func.SetExample(EXAMPLE);
 
@@ -937,9 +979,7 @@ struct ST_AsWKB {
 	// GEOMETRY
 	//------------------------------------------------------------------------------------------------------------------
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
-
-		UnaryExecutor::Execute<string_t, string_t>(
-		    args.data[0], result, args.size(), [&](const string_t &input) { return WKBWriter::Write(input, result); });
+		WKBWriter::Write(args.data[0], result, args.size());
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
@@ -1560,6 +1600,96 @@ struct ST_Centroid {
 	}
 };
 
+//======================================================================================================================
+// ST_ClipByBox2D
+//======================================================================================================================
+
+struct ST_ClipByBox2D {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Execute
+	//------------------------------------------------------------------------------------------------------------------
+	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
+		auto &lstate = LocalState::ResetAndGet(state);
+
+		using BOX_TYPE = StructTypeQuaternary<double, double, double, double>;
+		using GEOM_TYPE = PrimitiveType<string_t>;
+
+		GenericExecutor::ExecuteBinary<GEOM_TYPE, BOX_TYPE, GEOM_TYPE>(
+		    args.data[0], args.data[1], result, args.size(), [&](const GEOM_TYPE &geom_type, const BOX_TYPE &box) {
+			    const auto &blob = geom_type.val;
+			    const sgl::box_xy clip_box = {{box.a_val, box.b_val}, {box.c_val, box.d_val}};
+
+			    // The cached bounds are rounded outwards, so they can tell if the geometry is completely inside or
+			    // outside of the box without looking at the vertices
+			    const geometry_t geom_ref(blob);
+			    Box2D<float> bounds;
+			    if (geom_ref.TryGetCachedBounds(bounds)) {
+				    if (bounds.min.x >= clip_box.min.x && bounds.max.x <= clip_box.max.x &&
+				        bounds.min.y >= clip_box.min.y && bounds.max.y <= clip_box.max.y) {
+					    return GEOM_TYPE {blob};
+				    }
+				    if (bounds.min.x > clip_box.max.x || bounds.max.x < clip_box.min.x ||
+				        bounds.min.y > clip_box.max.y || bounds.max.y < clip_box.min.y) {
+					    const auto props = geom_ref.GetProperties();
+					    const auto type = static_cast<sgl::geometry_type>(static_cast<uint8_t>(geom_ref.GetType()) + 1);
+					    const sgl::geometry empty(type, props.HasZ(), props.HasM());
+					    return GEOM_TYPE {lstate.Serialize(result, empty)};
+				    }
+			    }
+
+			    sgl::geometry geom;
+			    lstate.Deserialize(blob, geom);
+
+			    sgl::geometry clipped;
+			    sgl::ops::clip_by_box(&lstate.GetAllocator(), &geom, clip_box, &clipped);
+			    return GEOM_TYPE {lstate.Serialize(result, clipped)};
+		    });
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Clips a geometry to a box, returning the part of the geometry inside the box.
+
+		This is a lot faster than computing the intersection with the polygon of the box using `ST_Intersection`, but
+		the clipped polygons are not guaranteed to be valid: a polygon that enters the box multiple times is clipped to a
+		single polygon with edges running along the border of the box, instead of being split into multiple polygons.
+		Points outside of the box are removed, and lines are split into the pieces inside the box. Parts
+		that end up empty are removed from the result. Z and M values of the new vertices on the border of the box are
+		interpolated.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT ST_AsText(ST_ClipByBox2D(ST_GeomFromText('LINESTRING (-1 1, 1 1, 1 3)'), ST_Extent(ST_MakeEnvelope(0, 0, 2, 2))));
+		----
+		LINESTRING (0 1, 1 1, 1 2)
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		FunctionBuilder::RegisterScalar(db, "ST_ClipByBox2D", [](ScalarFunctionBuilder &func) {
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("geom", GeoTypes::GEOMETRY());
+				variant.AddParameter("box", GeoTypes::BOX_2D());
+				variant.SetReturnType(GeoTypes::GEOMETRY());
+
+				variant.SetInit(LocalState::Init);
+				variant.SetFunction(Execute);
+			});
+
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "construction");
+		});
+	}
+};
+
 //======================================================================================================================
 // ST_Collect
 //======================================================================================================================
@@ -2054,6 +2184,22 @@ struct ST_Contains {
 		Operation(args.data[0], args.data[1], result, args.size());
 	}
 
+	//------------------------------------------------------------------------------------------------------------------
+	// BOX_2D -> POINT_2D
+	//------------------------------------------------------------------------------------------------------------------
+	// Points on the boundary of the box are not contained, as for the GEOMETRY overload
+	static void ExecuteBoxPoint(DataChunk &args, ExpressionState &state, Vector &result) {
+		using BOX_TYPE = StructTypeQuaternary<double, double, double, double>;
+		using POINT_TYPE = StructTypeBinary<double, double>;
+		using BOOL_TYPE = PrimitiveType<bool>;
+
+		GenericExecutor::ExecuteBinary<BOX_TYPE, POINT_TYPE, BOOL_TYPE>(
+		    args.data[0], args.data[1], result, args.size(), [&](BOX_TYPE &box, POINT_TYPE &point) {
+			    return box.a_val < point.a_val && point.a_val < box.c_val && box.b_val < point.b_val &&
+			           point.b_val < box.d_val;
+		    });
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// Documentation
 	//------------------------------------------------------------------------------------------------------------------
@@ -2075,6 +2221,14 @@ struct ST_Contains {
 				variant.SetFunction(Execute);
 			});
 
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("box", GeoTypes::BOX_2D());
+				variant.AddParameter("point", GeoTypes::POINT_2D());
+				variant.SetReturnType(LogicalType::BOOLEAN);
+
+				variant.SetFunction(ExecuteBoxPoint);
+			});
+
 			func.SetDescription(DESCRIPTION);
 			func.SetExample(EXAMPLE);
 
@@ -2186,28 +2340,72 @@ struct ST_Distance {
 	//------------------------------------------------------------------------------
 	// POINT_2D/POINT_2D
 	//------------------------------------------------------------------------------
+	// Compute the distances over plain arrays of coordinates, so that the loop is vectorized. A constant point is
+	// passed with a stride of 0 instead of being flattened.
+	template <idx_t LEFT_STRIDE, idx_t RIGHT_STRIDE>
+	static void PointPointOperation(const double *lx, const double *ly, const double *rx, const double *ry,
+	                                double *out, const idx_t count) {
+		for (idx_t i = 0; i < count; i++) {
+			const auto dx = lx[i * LEFT_STRIDE] - rx[i * RIGHT_STRIDE];
+			const auto dy = ly[i * LEFT_STRIDE] - ry[i * RIGHT_STRIDE];
+			out[i] = std::sqrt(dx * dx + dy * dy);
+		}
+	}
+
 	static void ExecutePointPoint(DataChunk &args, ExpressionState &state, Vector &result) {
 		D_ASSERT(args.data.size() == 2);
 		auto &left = args.data[0];
 		auto &right = args.data[1];
 		auto count = args.size();
 
-		left.Flatten(count);
-		right.Flatten(count);
+		const auto left_is_const = left.GetVectorType() == VectorType::CONSTANT_VECTOR;
+		const auto right_is_const = right.GetVectorType() == VectorType::CONSTANT_VECTOR;
 
-		auto &left_entries = StructVector::GetEntries(left);
-		auto &right_entries = StructVector::GetEntries(right);
+		if ((left_is_const && ConstantVector::IsNull(left)) || (right_is_const && ConstantVector::IsNull(right))) {
+			result.SetVectorType(VectorType::CONSTANT_VECTOR);
+			ConstantVector::SetNull(result, true);
+			return;
+		}
 
-		auto left_x = FlatVector::GetData<double>(*left_entries[0]);
-		auto left_y = FlatVector::GetData<double>(*left_entries[1]);
-		auto right_x = FlatVector::GetData<double>(*right_entries[0]);
-		auto right_y = FlatVector::GetData<double>(*right_entries[1]);
+		if (left_is_const && right_is_const) {
+			count = 1;
+		}
+		if (!left_is_const) {
+			left.Flatten(count);
+		}
+		if (!right_is_const) {
+			right.Flatten(count);
+		}
+
+		auto &left_entries = StructVector::GetEntries(left);
+		auto &right_entries = StructVector::GetEntries(right);
+
+		const auto left_x = FlatVector::GetData<double>(*left_entries[0]);
+		const auto left_y = FlatVector::GetData<double>(*left_entries[1]);
+		const auto right_x = FlatVector::GetData<double>(*right_entries[0]);
+		const auto right_y = FlatVector::GetData<double>(*right_entries[1]);
 
 		auto out_data = FlatVector::GetData<double>(result);
-		for (idx_t i = 0; i < count; i++) {
-			out_data[i] = std::sqrt(std::pow(left_x[i] - right_x[i], 2) + std::pow(left_y[i] - right_y[i], 2));
+		if (left_is_const) {
+			PointPointOperation<0, 1>(left_x, left_y, right_x, right_y, out_data, count);
+		} else if (right_is_const) {
+			PointPointOperation<1, 0>(left_x, left_y, right_x, right_y, out_data, count);
+		} else {
+			PointPointOperation<1, 1>(left_x, left_y, right_x, right_y, out_data, count);
 		}
 
+		if (left_is_const && right_is_const) {
+			result.SetVectorType(VectorType::CONSTANT_VECTOR);
+			return;
+		}
+
+		auto &result_validity = FlatVector::Validity(result);
+		if (!left_is_const) {
+			result_validity.Combine(FlatVector::Validity(left), count);
+		}
+		if (!right_is_const) {
+			result_validity.Combine(FlatVector::Validity(right), count);
+		}
 		if (count == 1) {
 			result.SetVectorType(VectorType::CONSTANT_VECTOR);
 		}
@@ -2723,6 +2921,39 @@ struct ST_Extent_Approx {
 		}
 	}
 
+	//------------------------------------------------------------------------------------------------------------------
+	// Execute (POINT_2D, BOX_2D, BOX_2DF)
+	//------------------------------------------------------------------------------------------------------------------
+	// The bounds are rounded outwards to floats. Points and boxes with NaN coordinates have no bounds.
+	static void ExecuteStruct(DataChunk &args, ExpressionState &state, Vector &result) {
+		const auto count = args.size();
+		auto &input = args.data[0];
+		const auto is_constant = input.GetVectorType() == VectorType::CONSTANT_VECTOR;
+		const SpatialKeyReader key_reader(input.GetType(), input, count);
+
+		const auto &struct_vec = StructVector::GetEntries(result);
+		const auto min_x_data = FlatVector::GetData<float>(*struct_vec[0]);
+		const auto min_y_data = FlatVector::GetData<float>(*struct_vec[1]);
+		const auto max_x_data = FlatVector::GetData<float>(*struct_vec[2]);
+		const auto max_y_data = FlatVector::GetData<float>(*struct_vec[3]);
+
+		for (idx_t i = 0; i < count; i++) {
+			Box2D<float> bbox;
+			if (key_reader.TryGetBounds(i, bbox)) {
+				min_x_data[i] = bbox.min.x;
+				min_y_data[i] = bbox.min.y;
+				max_x_data[i] = bbox.max.x;
+				max_y_data[i] = bbox.max.y;
+			} else {
+				FlatVector::SetNull(result, i, true);
+			}
+		}
+
+		if (is_constant) {
+			result.SetVectorType(VectorType::CONSTANT_VECTOR);
+		}
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// Documentation
 	//------------------------------------------------------------------------------------------------------------------
@@ -2740,6 +2971,27 @@ struct ST_Extent_Approx {
 				variant.SetFunction(Execute);
 			});
 
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("point", GeoTypes::POINT_2D());
+				variant.SetReturnType(GeoTypes::BOX_2DF());
+
+				variant.SetFunction(ExecuteStruct);
+			});
+
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("box", GeoTypes::BOX_2D());
+				variant.SetReturnType(GeoTypes::BOX_2DF());
+
+				variant.SetFunction(ExecuteStruct);
+			});
+
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("box", GeoTypes::BOX_2DF());
+				variant.SetReturnType(GeoTypes::BOX_2DF());
+
+				variant.SetFunction(ExecuteStruct);
+			});
+
 			func.SetDescription(R"(
 				Returns the approximate bounding box of a geometry, if available.
 
@@ -2753,6 +3005,51 @@ struct ST_Extent_Approx {
 	}
 };
 
+//======================================================================================================================
+// ST_CoveringBBox
+//======================================================================================================================
+
+struct ST_CoveringBBox {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Returns the cached bounding box of a geometry as a GeoParquet 1.1 "bbox" covering struct.
+
+		The bounds are rounded outwards to floats, so they always cover the geometry. Writing this as a `bbox` column
+		next to the geometry lets Parquet store the extent of every row group in the column statistics, which is used to
+		skip row groups when the file is filtered with a spatial predicate.
+	)";
+	static constexpr auto EXAMPLE = R"(
+		COPY (SELECT *, ST_CoveringBBox(geom) AS bbox FROM tbl ORDER BY ST_Hilbert(geom)) TO 'tbl.parquet';
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		FunctionBuilder::RegisterScalar(db, "ST_CoveringBBox", [](ScalarFunctionBuilder &func) {
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("geom", GeoTypes::GEOMETRY());
+				variant.SetReturnType(LogicalType::STRUCT({{"xmin", LogicalType::FLOAT},
+				                                           {"ymin", LogicalType::FLOAT},
+				                                           {"xmax", LogicalType::FLOAT},
+				                                           {"ymax", LogicalType::FLOAT}}));
+
+				// The covering has the same layout as a BOX_2DF, only the names of the fields differ
+				variant.SetFunction(ST_Extent_Approx::Execute);
+			});
+
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "property");
+		});
+	}
+};
+
 //======================================================================================================================
 // ST_ExteriorRing
 //======================================================================================================================
@@ -3693,368 +3990,18 @@ struct ST_GeomFromGeoJSON {
 	//------------------------------------------------------------------------------------------------------------------
 	// GEOJSON -> GEOMETRY
 	//------------------------------------------------------------------------------------------------------------------
-	// TODO: Move this into SGL and make non-recursive
-	// At least rewrite, its kind of a mess right now.
-
-	static void PointFromGeoJSON(sgl::geometry *geom, yyjson_val *coord_array, ArenaAllocator &arena,
-	                             const string_t &raw, bool &has_z) {
-
-		// Point
-		geom->set_type(sgl::geometry_type::POINT);
-		geom->set_z(has_z);
-
-		auto len = yyjson_arr_size(coord_array);
-		if (len == 0) {
-			// empty point, return
-			return;
-		}
-		if (len < 2) {
-			throw InvalidInputException("GeoJSON input coordinates field is not an array of at least length 2: %s",
-			                            raw.GetString());
-		}
-		auto x_val = yyjson_arr_get_first(coord_array);
-		if (!yyjson_is_num(x_val)) {
-			throw InvalidInputException("GeoJSON input coordinates field is not an array of numbers: %s",
-			                            raw.GetString());
-		}
-		auto y_val = yyjson_arr_get(coord_array, 1);
-		if (!yyjson_is_num(y_val)) {
-			throw InvalidInputException("GeoJSON input coordinates field is not an array of numbers: %s",
-			                            raw.GetString());
-		}
-
-		auto x = yyjson_get_num(x_val);
-		auto y = yyjson_get_num(y_val);
-
-		auto geom_has_z = len > 2;
-		if (geom_has_z) {
-			has_z = true;
-			auto z_val = yyjson_arr_get(coord_array, 2);
-			if (!yyjson_is_num(z_val)) {
-				throw InvalidInputException("GeoJSON input coordinates field is not an array of numbers: %s",
-				                            raw.GetString());
-			}
-			auto z = yyjson_get_num(z_val);
-			auto mem = arena.AllocateAligned(sizeof(double) * 3);
-			auto ptr = reinterpret_cast<double *>(mem);
-
-			ptr[0] = x;
-			ptr[1] = y;
-			ptr[2] = z;
-
-			geom->set_vertex_data(mem, 1);
-			geom->set_z(true);
-		} else {
-			auto mem = arena.AllocateAligned(sizeof(double) * 2);
-			auto ptr = reinterpret_cast<double *>(mem);
-
-			ptr[0] = x;
-			ptr[1] = y;
-
-			geom->set_vertex_data(mem, 1);
-		}
-	}
-
-	static void LineStringFromGeoJSON(sgl::geometry *geom, yyjson_val *coord_array, ArenaAllocator &arena,
-	                                  const string_t &raw, bool &has_z) {
-
-		geom->set_type(sgl::geometry_type::LINESTRING);
-		geom->set_z(has_z);
-
-		auto len = yyjson_arr_size(coord_array);
-		if (len == 0) {
-			// Empty, do nothing
-			return;
-		}
-
-		// Sniff the coordinates to see if we have Z
-		bool has_any_z = false;
-		size_t idx, max;
-		yyjson_val *coord;
-		yyjson_arr_foreach(coord_array, idx, max, coord) {
-			if (!yyjson_is_arr(coord)) {
-				throw InvalidInputException("GeoJSON input coordinates field is not an array of arrays: %s",
-				                            raw.GetString());
-			}
-			auto coord_len = yyjson_arr_size(coord);
-			if (coord_len > 2) {
-				has_any_z = true;
-			} else if (coord_len < 2) {
-				throw InvalidInputException(
-				    "GeoJSON input coordinates field is not an array of arrays of length >= 2: %s", raw.GetString());
-			}
-		}
-
-		if (has_any_z) {
-			has_z = true;
-			geom->set_z(true);
-		}
-
-		const auto vertex_size = has_any_z ? 3 : 2;
-		const auto vertex_mem = arena.AllocateAligned(sizeof(double) * vertex_size * len);
-		geom->set_vertex_data(vertex_mem, len);
-
-		const auto vertex_ptr = reinterpret_cast<double *>(vertex_mem);
-
-		yyjson_arr_foreach(coord_array, idx, max, coord) {
-			auto coord_len = yyjson_arr_size(coord);
-			auto x_val = yyjson_arr_get_first(coord);
-			if (!yyjson_is_num(x_val)) {
-				throw InvalidInputException("GeoJSON input coordinates field is not an array of arrays of numbers: %s",
-				                            raw.GetString());
-			}
-			auto y_val = yyjson_arr_get(coord, 1);
-			if (!yyjson_is_num(y_val)) {
-				throw InvalidInputException("GeoJSON input coordinates field is not an array of arrays of numbers: %s",
-				                            raw.GetString());
-			}
-			auto x = yyjson_get_num(x_val);
-			auto y = yyjson_get_num(y_val);
-			auto z = 0.0;
-
-			if (coord_len > 2) {
-				auto z_val = yyjson_arr_get(coord, 2);
-				if (!yyjson_is_num(z_val)) {
-					throw InvalidInputException(
-					    "GeoJSON input coordinates field is not an array of arrays of numbers: %s", raw.GetString());
-				}
-				z = yyjson_get_num(z_val);
-			}
-
-			vertex_ptr[idx * vertex_size] = x;
-			vertex_ptr[idx * vertex_size + 1] = y;
-			if (has_any_z) {
-				vertex_ptr[idx * vertex_size + 2] = z;
-			}
-		}
-	}
-
-	static void PolygonFromGeoJSON(sgl::geometry *geom, yyjson_val *coord_array, ArenaAllocator &arena,
-	                               const string_t &raw, bool &has_z) {
-		// Polygon
-		geom->set_type(sgl::geometry_type::POLYGON);
-		geom->set_z(has_z);
-
-		auto num_rings = yyjson_arr_size(coord_array);
-		if (num_rings == 0) {
-			// Empty, do nothig
-			return;
-		}
-
-		size_t idx, max;
-		yyjson_val *ring_val;
-		yyjson_arr_foreach(coord_array, idx, max, ring_val) {
-			if (!yyjson_is_arr(ring_val)) {
-				throw InvalidInputException("GeoJSON input coordinates field is not an array of arrays: %s",
-				                            raw.GetString());
-			}
-			const auto mem = arena.AllocateAligned(sizeof(sgl::geometry));
-			const auto ring = new (mem) sgl::geometry(sgl::geometry_type::LINESTRING, has_z, false);
-			LineStringFromGeoJSON(ring, ring_val, arena, raw, has_z);
-
-			geom->append_part(ring);
-		}
-	}
-
-	static void MultiPointFromGeoJSON(sgl::geometry *geom, yyjson_val *coord_array, ArenaAllocator &arena,
-	                                  const string_t &raw, bool &has_z) {
-
-		// MultiPoint
-		geom->set_type(sgl::geometry_type::MULTI_POINT);
-		geom->set_z(has_z);
-
-		auto num_points = yyjson_arr_size(coord_array);
-		if (num_points == 0) {
-			// Empty, do nothing
-			return;
-		}
-
-		// MultiPoint
-		size_t idx, max;
-		yyjson_val *point_val;
-		yyjson_arr_foreach(coord_array, idx, max, point_val) {
-			if (!yyjson_is_arr(point_val)) {
-				throw InvalidInputException("GeoJSON input coordinates field is not an array of arrays: %s",
-				                            raw.GetString());
-			}
-			if (yyjson_arr_size(point_val) < 2) {
-				throw InvalidInputException(
-				    "GeoJSON input coordinates field is not an array of arrays of length >= 2: %s", raw.GetString());
-			}
-
-			const auto mem = arena.AllocateAligned(sizeof(sgl::geometry));
-			const auto point = new (mem) sgl::geometry(sgl::geometry_type::POINT, has_z, false);
-			PointFromGeoJSON(point, point_val, arena, raw, has_z);
-
-			geom->append_part(point);
-		}
-	}
-
-	static void MultiLineStringFromGeoJSON(sgl::geometry *geom, yyjson_val *coord_array, ArenaAllocator &arena,
-	                                       const string_t &raw, bool &has_z) {
-		// MultiLineString
-		geom->set_type(sgl::geometry_type::MULTI_LINESTRING);
-		geom->set_z(has_z);
-
-		auto num_linestrings = yyjson_arr_size(coord_array);
-		if (num_linestrings == 0) {
-			// Empty, do nothing
-			return;
-		}
-
-		size_t idx, max;
-		yyjson_val *linestring_val;
-		yyjson_arr_foreach(coord_array, idx, max, linestring_val) {
-			if (!yyjson_is_arr(linestring_val)) {
-				throw InvalidInputException("GeoJSON input coordinates field is not an array of arrays: %s",
-				                            raw.GetString());
-			}
-			const auto mem = arena.AllocateAligned(sizeof(sgl::geometry));
-			const auto line = new (mem) sgl::geometry(sgl::geometry_type::LINESTRING, has_z, false);
-			LineStringFromGeoJSON(line, linestring_val, arena, raw, has_z);
-
-			geom->append_part(line);
-		}
-	}
-
-	static void MultiPolygonFromGeoJSON(sgl::geometry *geom, yyjson_val *coord_array, ArenaAllocator &arena,
-	                                    const string_t &raw, bool &has_z) {
-
-		// MultiPolygon
-		geom->set_type(sgl::geometry_type::MULTI_POLYGON);
-		geom->set_z(has_z);
-
-		auto num_polygons = yyjson_arr_size(coord_array);
-		if (num_polygons == 0) {
-			// Empty, do nothing
-			return;
-		}
-
-		size_t idx, max;
-		yyjson_val *polygon_val;
-		yyjson_arr_foreach(coord_array, idx, max, polygon_val) {
-			if (!yyjson_is_arr(polygon_val)) {
-				throw InvalidInputException("GeoJSON input coordinates field is not an array of arrays: %s",
-				                            raw.GetString());
-			}
-			const auto mem = arena.AllocateAligned(sizeof(sgl::geometry));
-			const auto polygon = new (mem) sgl::geometry(sgl::geometry_type::POLYGON, has_z, false);
-			PolygonFromGeoJSON(polygon, polygon_val, arena, raw, has_z);
-
-			geom->append_part(polygon);
-		}
-	}
-
-	static void GeometryCollectionFromGeoJSON(sgl::geometry *geom, yyjson_val *root, ArenaAllocator &arena,
-	                                          const string_t &raw, bool &has_z) {
-
-		geom->set_type(sgl::geometry_type::MULTI_GEOMETRY);
-		geom->set_z(has_z);
-
-		auto geometries_val = yyjson_obj_get(root, "geometries");
-		if (!geometries_val) {
-			throw InvalidInputException("GeoJSON input does not have a geometries field: %s", raw.GetString());
-		}
-		if (!yyjson_is_arr(geometries_val)) {
-			throw InvalidInputException("GeoJSON input geometries field is not an array: %s", raw.GetString());
-		}
-		auto num_geometries = yyjson_arr_size(geometries_val);
-		if (num_geometries == 0) {
-			// Empty, do nothing
-			return;
-		}
-
-		size_t idx, max;
-		yyjson_val *geometry_val;
-		yyjson_arr_foreach(geometries_val, idx, max, geometry_val) {
-			const auto mem = arena.AllocateAligned(sizeof(sgl::geometry));
-			const auto geometry = new (mem) sgl::geometry(sgl::geometry_type::INVALID, has_z, false);
-			FromGeoJSON(geometry, geometry_val, arena, raw, has_z);
-
-			geom->append_part(geometry);
-		}
-	}
-
-	static void FromGeoJSON(sgl::geometry *geom, yyjson_val *root, ArenaAllocator &arena, const string_t &raw,
-	                        bool &has_z) {
-		auto type_val = yyjson_obj_get(root, "type");
-		if (!type_val) {
-			throw InvalidInputException("GeoJSON input does not have a type field: %s", raw.GetString());
-		}
-		auto type_str = yyjson_get_str(type_val);
-		if (!type_str) {
-			throw InvalidInputException("GeoJSON input type field is not a string: %s", raw.GetString());
-		}
-
-		if (StringUtil::Equals(type_str, "GeometryCollection")) {
-			return GeometryCollectionFromGeoJSON(geom, root, arena, raw, has_z);
-		}
-
-		// Get the coordinates
-		auto coord_array = yyjson_obj_get(root, "coordinates");
-		if (!coord_array) {
-			throw InvalidInputException("GeoJSON input does not have a coordinates field: %s", raw.GetString());
-		}
-		if (!yyjson_is_arr(coord_array)) {
-			throw InvalidInputException("GeoJSON input coordinates field is not an array: %s", raw.GetString());
-		}
-
-		if (StringUtil::Equals(type_str, "Point")) {
-			return PointFromGeoJSON(geom, coord_array, arena, raw, has_z);
-		}
-		if (StringUtil::Equals(type_str, "LineString")) {
-			return LineStringFromGeoJSON(geom, coord_array, arena, raw, has_z);
-		}
-		if (StringUtil::Equals(type_str, "Polygon")) {
-			return PolygonFromGeoJSON(geom, coord_array, arena, raw, has_z);
-		}
-		if (StringUtil::Equals(type_str, "MultiPoint")) {
-			return MultiPointFromGeoJSON(geom, coord_array, arena, raw, has_z);
-		}
-		if (StringUtil::Equals(type_str, "MultiLineString")) {
-			return MultiLineStringFromGeoJSON(geom, coord_array, arena, raw, has_z);
-		}
-		if (StringUtil::Equals(type_str, "MultiPolygon")) {
-			return MultiPolygonFromGeoJSON(geom, coord_array, arena, raw, has_z);
-		}
-		throw InvalidInputException("GeoJSON input has invalid type field: %s", raw.GetString());
-	}
-
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
 		D_ASSERT(args.data.size() == 1);
 		auto &input = args.data[0];
 		auto count = args.size();
 
 		auto &lstate = LocalState::ResetAndGet(state);
-		auto &arena = lstate.GetArena();
-
-		JSONAllocator json_allocator(arena);
+		GeoJSONReader reader(lstate.GetArena());
 
 		UnaryExecutor::Execute<string_t, string_t>(input, result, count, [&](const string_t &input) {
-			yyjson_read_err err;
-			auto doc = yyjson_read_opts(const_cast<char *>(input.GetDataUnsafe()), input.GetSize(),
-			                            YYJSON_READ_ALLOW_TRAILING_COMMAS | YYJSON_READ_ALLOW_COMMENTS,
-			                            json_allocator.GetYYJSONAllocator(), &err);
-
-			if (err.code) {
-				throw InvalidInputException("Could not parse GeoJSON input: %s, (%s)", err.msg, input.GetString());
-			}
-
-			const auto root = yyjson_doc_get_root(doc);
-			if (!yyjson_is_obj(root)) {
-				throw InvalidInputException("Could not parse GeoJSON input: %s, (%s)", err.msg, input.GetString());
-			}
-
-			bool has_z = false;
+			// Parse straight into the geometry, without building a JSON document first
 			sgl::geometry geom(sgl::geometry_type::INVALID);
-
-			// Parse into the geometry
-			FromGeoJSON(&geom, root, arena, input, has_z);
-
-			if (has_z) {
-				// Ensure the geometries has consistent Z values
-				sgl::ops::force_zm(lstate.GetAllocator(), &geom, has_z, false, 0, 0);
-			}
+			reader.ReadGeometry(input.GetData(), input.GetSize(), geom);
 			D_ASSERT(geom.get_type() != sgl::geometry_type::INVALID);
 
 			return lstate.Serialize(result, geom);
@@ -4267,6 +4214,12 @@ struct ST_GeomFromWKB {
 		reader.stack_cap = MAX_STACK_DEPTH;
 
 		UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &wkb) {
+			// Only big-endian input, mixed vertex layouts and invalid blobs need the reader, which also reports the error
+			string_t blob;
+			if (Serde::TryFromWKB(wkb.GetDataUnsafe(), wkb.GetSize(), true, result, blob)) {
+				return blob;
+			}
+
 			reader.buf = wkb.GetDataUnsafe();
 			reader.end = reader.buf + wkb.GetSize();
 
@@ -5204,6 +5157,114 @@ struct ST_Distance_Sphere {
 	}
 };
 
+//======================================================================================================================
+// ST_DWithin_Sphere
+//======================================================================================================================
+
+struct ST_DWithin_Sphere {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// GEOMETRY
+	//------------------------------------------------------------------------------------------------------------------
+	static void ExecuteGeometry(DataChunk &args, ExpressionState &state, Vector &result) {
+		auto &lstate = LocalState::ResetAndGet(state);
+
+		TernaryExecutor::Execute<string_t, string_t, double, bool>(
+		    args.data[0], args.data[1], args.data[2], result, args.size(),
+		    [&](const string_t &l_blob, const string_t &r_blob, const double limit) {
+			    sgl::geometry lhs;
+			    sgl::geometry rhs;
+
+			    lstate.Deserialize(l_blob, lhs);
+			    lstate.Deserialize(r_blob, rhs);
+
+			    if (lhs.get_type() != sgl::geometry_type::POINT || rhs.get_type() != sgl::geometry_type::POINT) {
+				    throw InvalidInputException("ST_DWithin_Sphere only accepts POINT geometries");
+			    }
+
+			    if (lhs.is_empty() || rhs.is_empty()) {
+				    throw InvalidInputException("ST_DWithin_Sphere does not accept empty geometries");
+			    }
+
+			    const auto lv = lhs.get_vertex_xy(0);
+			    const auto rv = rhs.get_vertex_xy(0);
+
+			    return sgl::util::haversine_distance(lv.x, lv.y, rv.x, rv.y) <= limit;
+		    });
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// POINT_2D
+	//------------------------------------------------------------------------------------------------------------------
+	static void ExecutePoint(DataChunk &args, ExpressionState &state, Vector &result) {
+		D_ASSERT(args.data.size() == 3);
+
+		using POINT_TYPE = StructTypeBinary<double, double>;
+		using DISTANCE_TYPE = PrimitiveType<double>;
+		using BOOL_TYPE = PrimitiveType<bool>;
+
+		GenericExecutor::ExecuteTernary<POINT_TYPE, POINT_TYPE, DISTANCE_TYPE, BOOL_TYPE>(
+		    args.data[0], args.data[1], args.data[2], result, args.size(),
+		    [&](POINT_TYPE left, POINT_TYPE right, DISTANCE_TYPE limit) {
+			    return BOOL_TYPE {sgl::util::haversine_distance(left.a_val, left.b_val, right.a_val, right.b_val) <=
+			                      limit.val};
+		    });
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Returns if two geometries are within a target haversine (great circle) distance of each other.
+
+	    - Only supports POINT geometries.
+	    - The distance is in meters.
+	    - The input is expected to be in WGS84 (EPSG:4326) coordinates, using a [latitude, longitude] axis order.
+
+	    This is equivalent to `ST_Distance_Sphere(geom1, geom2) <= distance`, but can be used as the condition of a spatial join.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+	-- Note: the coordinates are in WGS84 and [latitude, longitude] axis order
+	-- Are JFK and AMS airport within 6000km of each other?
+	SELECT ST_DWithin_Sphere(ST_Point(40.6446, -73.7797), ST_Point(52.3130, 4.7725), 6000000);
+	----
+	true
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		FunctionBuilder::RegisterScalar(db, "ST_DWithin_Sphere", [](ScalarFunctionBuilder &func) {
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("geom1", GeoTypes::GEOMETRY());
+				variant.AddParameter("geom2", GeoTypes::GEOMETRY());
+				variant.AddParameter("distance", LogicalType::DOUBLE);
+				variant.SetReturnType(LogicalType::BOOLEAN);
+
+				variant.SetInit(LocalState::Init);
+				variant.SetFunction(ExecuteGeometry);
+			});
+
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("point1", GeoTypes::POINT_2D());
+				variant.AddParameter("point2", GeoTypes::POINT_2D());
+				variant.AddParameter("distance", LogicalType::DOUBLE);
+				variant.SetReturnType(LogicalType::BOOLEAN);
+
+				variant.SetFunction(ExecutePoint);
+			});
+
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "relation");
+		});
+	}
+};
+
 //======================================================================================================================
 // ST_Hilbert
 //======================================================================================================================
@@ -5310,91 +5371,339 @@ struct ST_Hilbert {
 				    throw InvalidInputException("ST_Hilbert(geom, bounds) does not support empty geometries");
 			    }
 
-			    const auto dx = geom_bounds.min.x + (geom_bounds.max.x - geom_bounds.min.x) / 2;
-			    const auto dy = geom_bounds.min.y + (geom_bounds.max.y - geom_bounds.min.y) / 2;
+			    const auto dx = geom_bounds.min.x + (geom_bounds.max.x - geom_bounds.min.x) / 2;
+			    const auto dy = geom_bounds.min.y + (geom_bounds.max.y - geom_bounds.min.y) / 2;
+
+			    const auto hilbert_width = max_hilbert / (bounds.c_val - bounds.a_val);
+			    const auto hilbert_height = max_hilbert / (bounds.d_val - bounds.b_val);
+			    // TODO: Check for overflow
+			    const auto hilbert_x = static_cast<uint32_t>((dx - bounds.a_val) * hilbert_width);
+			    const auto hilbert_y = static_cast<uint32_t>((dy - bounds.b_val) * hilbert_height);
+
+			    const auto h = sgl::util::hilbert_encode(16, hilbert_x, hilbert_y);
+			    return UINT32_TYPE {h};
+		    });
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Encodes the X and Y values as the hilbert curve index for a curve covering the given bounding box.
+		If a geometry is provided, the center of the approximate bounding box is used as the point to encode.
+		If no bounding box is provided, the hilbert curve index is mapped to the full range of a single-presicion float.
+		For the BOX_2D and BOX_2DF variants, the center of the box is used as the point to encode.
+	)";
+
+	// TODO: example
+	static constexpr auto EXAMPLE = "";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		// TODO: All of these needs examples and docs
+
+		FunctionBuilder::RegisterScalar(db, "ST_Hilbert", [](ScalarFunctionBuilder &func) {
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("x", LogicalType::DOUBLE);
+				variant.AddParameter("y", LogicalType::DOUBLE);
+				variant.AddParameter("bounds", GeoTypes::BOX_2D());
+				variant.SetReturnType(LogicalType::UINTEGER);
+
+				variant.SetFunction(ExecuteLonlat);
+			});
+
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("geom", GeoTypes::GEOMETRY());
+				variant.AddParameter("bounds", GeoTypes::BOX_2D());
+				variant.SetReturnType(LogicalType::UINTEGER);
+
+				variant.SetFunction(ExecuteGeometryWithBounds);
+				variant.SetInit(LocalState::Init);
+			});
+
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("geom", GeoTypes::GEOMETRY());
+				variant.SetReturnType(LogicalType::UINTEGER);
+
+				variant.SetFunction(ExecuteGeometry);
+				variant.SetInit(LocalState::Init);
+			});
+
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("box", GeoTypes::BOX_2D());
+				variant.AddParameter("bounds", GeoTypes::BOX_2D());
+				variant.SetReturnType(LogicalType::UINTEGER);
+
+				variant.SetFunction(ExecuteBox<double>);
+			});
+
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("box", GeoTypes::BOX_2DF());
+				variant.AddParameter("bounds", GeoTypes::BOX_2DF());
+				variant.SetReturnType(LogicalType::UINTEGER);
+
+				variant.SetFunction(ExecuteBox<float>);
+			});
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "property");
+
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+		});
+	}
+};
+
+//======================================================================================================================
+// ST_Hilbert64 / ST_Morton64
+//======================================================================================================================
+// 64-bit versions of the space filling curves, with 32 bits per axis. With 16 bits per axis (as in ST_Hilbert), large
+// tables get a lot of collisions, which makes sorting by the curve a poor way to cluster them in space.
+
+struct SpaceFillingCurve64 {
+
+	struct HilbertOp {
+		static uint64_t Encode(uint32_t x, uint32_t y) {
+			return sgl::util::hilbert_encode_64(32, x, y);
+		}
+	};
+
+	struct MortonOp {
+		static uint64_t Encode(uint32_t x, uint32_t y) {
+			return sgl::util::morton_encode_64(x, y);
+		}
+	};
+
+	// Map a value to its cell along an axis of the bounds, clamping values that are outside of the bounds
+	static uint32_t Quantize(double value, double min, double max) {
+		constexpr auto max_cell = static_cast<double>(std::numeric_limits<uint32_t>::max());
+		const auto cell = (value - min) / (max - min) * max_cell;
+		if (!(cell > 0)) {
+			// Also handles NaN, and empty bounds
+			return 0;
+		}
+		if (cell >= max_cell) {
+			return std::numeric_limits<uint32_t>::max();
+		}
+		return static_cast<uint32_t>(cell);
+	}
+
+	template <class OP, class BOX_TYPE>
+	static uint64_t Encode(double x, double y, const BOX_TYPE &bounds) {
+		return OP::Encode(Quantize(x, bounds.a_val, bounds.c_val), Quantize(y, bounds.b_val, bounds.d_val));
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// X/Y
+	//------------------------------------------------------------------------------------------------------------------
+	template <class OP>
+	static void ExecuteXY(DataChunk &args, ExpressionState &state, Vector &result) {
+		using DOUBLE_TYPE = PrimitiveType<double>;
+		using UINT64_TYPE = PrimitiveType<uint64_t>;
+		using BOX_TYPE = StructTypeQuaternary<double, double, double, double>;
+
+		GenericExecutor::ExecuteTernary<DOUBLE_TYPE, DOUBLE_TYPE, BOX_TYPE, UINT64_TYPE>(
+		    args.data[0], args.data[1], args.data[2], result, args.size(),
+		    [&](DOUBLE_TYPE x, DOUBLE_TYPE y, BOX_TYPE &bounds) {
+			    return UINT64_TYPE {Encode<OP>(x.val, y.val, bounds)};
+		    });
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// BOX_2D
+	//------------------------------------------------------------------------------------------------------------------
+	template <class OP>
+	static void ExecuteBox(DataChunk &args, ExpressionState &state, Vector &result) {
+		using BOX_TYPE = StructTypeQuaternary<double, double, double, double>;
+		using UINT64_TYPE = PrimitiveType<uint64_t>;
+
+		GenericExecutor::ExecuteBinary<BOX_TYPE, BOX_TYPE, UINT64_TYPE>(
+		    args.data[0], args.data[1], result, args.size(), [&](BOX_TYPE &box, BOX_TYPE &bounds) {
+			    const auto x = box.a_val + (box.c_val - box.a_val) / 2;
+			    const auto y = box.b_val + (box.d_val - box.b_val) / 2;
+			    return UINT64_TYPE {Encode<OP>(x, y, bounds)};
+		    });
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// GEOMETRY
+	//------------------------------------------------------------------------------------------------------------------
+	template <class OP>
+	static void ExecuteGeometryWithBounds(DataChunk &args, ExpressionState &state, Vector &result) {
+		auto &geom_vec = args.data[0];
+		auto &bounds_vec = args.data[1];
+		const auto count = args.size();
+
+		using BOX_TYPE = StructTypeQuaternary<double, double, double, double>;
+
+		UnifiedVectorFormat geom_format;
+		geom_vec.ToUnifiedFormat(count, geom_format);
+		const auto geom_data = UnifiedVectorFormat::GetData<string_t>(geom_format);
+
+		// The bounds are (almost always) constant
+		bounds_vec.Flatten(count);
+		const auto &bounds_entries = StructVector::GetEntries(bounds_vec);
+		const auto min_x_data = FlatVector::GetData<double>(*bounds_entries[0]);
+		const auto min_y_data = FlatVector::GetData<double>(*bounds_entries[1]);
+		const auto max_x_data = FlatVector::GetData<double>(*bounds_entries[2]);
+		const auto max_y_data = FlatVector::GetData<double>(*bounds_entries[3]);
+		const auto &bounds_validity = FlatVector::Validity(bounds_vec);
+
+		result.SetVectorType(VectorType::FLAT_VECTOR);
+		const auto result_data = FlatVector::GetData<uint64_t>(result);
+
+		for (idx_t i = 0; i < count; i++) {
+			const auto geom_idx = geom_format.sel->get_index(i);
+			if (!geom_format.validity.RowIsValid(geom_idx) || !bounds_validity.RowIsValid(i)) {
+				FlatVector::SetNull(result, i, true);
+				continue;
+			}
+
+			// Scan the vertices in place, without deserializing the geometry
+			const auto &blob = geom_data[geom_idx];
+			auto extent = sgl::box_xy::smallest();
+			if (!Serde::TryGetExtentXY(blob.GetData(), blob.GetSize(), extent)) {
+				// Empty geometries have no position on the curve
+				FlatVector::SetNull(result, i, true);
+				continue;
+			}
+
+			const auto x = extent.min.x + (extent.max.x - extent.min.x) / 2;
+			const auto y = extent.min.y + (extent.max.y - extent.min.y) / 2;
+			BOX_TYPE bounds;
+			bounds.a_val = min_x_data[i];
+			bounds.b_val = min_y_data[i];
+			bounds.c_val = max_x_data[i];
+			bounds.d_val = max_y_data[i];
+			result_data[i] = Encode<OP>(x, y, bounds);
+		}
+
+		if (count == 1) {
+			result.SetVectorType(VectorType::CONSTANT_VECTOR);
+		}
+	}
+
+	template <class OP>
+	static void ExecuteGeometry(DataChunk &args, ExpressionState &state, Vector &result) {
+		UnaryExecutor::ExecuteWithNulls<geometry_t, uint64_t>(
+		    args.data[0], result, args.size(),
+		    [&](const geometry_t &geom, ValidityMask &mask, idx_t out_idx) -> uint64_t {
+			    Box2D<float> bounds;
+			    if (!geom.TryGetCachedBounds(bounds)) {
+				    // No cached bounds, scan the vertices instead
+				    const auto blob = static_cast<string_t>(geom);
+				    auto extent = sgl::box_xy::smallest();
+				    if (!Serde::TryGetExtentXY(blob.GetData(), blob.GetSize(), extent)) {
+					    mask.SetInvalid(out_idx);
+					    return 0;
+				    }
+				    bounds.min.x = static_cast<float>(extent.min.x);
+				    bounds.min.y = static_cast<float>(extent.min.y);
+				    bounds.max.x = static_cast<float>(extent.max.x);
+				    bounds.max.y = static_cast<float>(extent.max.y);
+			    }
 
-			    const auto hilbert_width = max_hilbert / (bounds.c_val - bounds.a_val);
-			    const auto hilbert_height = max_hilbert / (bounds.d_val - bounds.b_val);
-			    // TODO: Check for overflow
-			    const auto hilbert_x = static_cast<uint32_t>((dx - bounds.a_val) * hilbert_width);
-			    const auto hilbert_y = static_cast<uint32_t>((dy - bounds.b_val) * hilbert_height);
+			    const auto x = bounds.min.x + (bounds.max.x - bounds.min.x) / 2;
+			    const auto y = bounds.min.y + (bounds.max.y - bounds.min.y) / 2;
 
-			    const auto h = sgl::util::hilbert_encode(16, hilbert_x, hilbert_y);
-			    return UINT32_TYPE {h};
+			    // Map the position to the full range of a single-precision float
+			    return OP::Encode(sgl::util::hilbert_f32_to_u32(x), sgl::util::hilbert_f32_to_u32(y));
 		    });
 	}
 
-	//------------------------------------------------------------------------------------------------------------------
-	// Documentation
-	//------------------------------------------------------------------------------------------------------------------
-	static constexpr auto DESCRIPTION = R"(
-		Encodes the X and Y values as the hilbert curve index for a curve covering the given bounding box.
-		If a geometry is provided, the center of the approximate bounding box is used as the point to encode.
-		If no bounding box is provided, the hilbert curve index is mapped to the full range of a single-presicion float.
-		For the BOX_2D and BOX_2DF variants, the center of the box is used as the point to encode.
-	)";
-
-	// TODO: example
-	static constexpr auto EXAMPLE = "";
-
 	//------------------------------------------------------------------------------------------------------------------
 	// Register
 	//------------------------------------------------------------------------------------------------------------------
-	static void Register(DatabaseInstance &db) {
-		// TODO: All of these needs examples and docs
-
-		FunctionBuilder::RegisterScalar(db, "ST_Hilbert", [](ScalarFunctionBuilder &func) {
+	template <class OP>
+	static void Register(DatabaseInstance &db, const char *name, const char *description, const char *example) {
+		FunctionBuilder::RegisterScalar(db, name, [&](ScalarFunctionBuilder &func) {
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
 				variant.AddParameter("x", LogicalType::DOUBLE);
 				variant.AddParameter("y", LogicalType::DOUBLE);
 				variant.AddParameter("bounds", GeoTypes::BOX_2D());
-				variant.SetReturnType(LogicalType::UINTEGER);
+				variant.SetReturnType(LogicalType::UBIGINT);
 
-				variant.SetFunction(ExecuteLonlat);
+				variant.SetFunction(ExecuteXY<OP>);
 			});
 
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
 				variant.AddParameter("geom", GeoTypes::GEOMETRY());
 				variant.AddParameter("bounds", GeoTypes::BOX_2D());
-				variant.SetReturnType(LogicalType::UINTEGER);
+				variant.SetReturnType(LogicalType::UBIGINT);
 
-				variant.SetFunction(ExecuteGeometryWithBounds);
-				variant.SetInit(LocalState::Init);
+				variant.SetFunction(ExecuteGeometryWithBounds<OP>);
 			});
 
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
 				variant.AddParameter("geom", GeoTypes::GEOMETRY());
-				variant.SetReturnType(LogicalType::UINTEGER);
+				variant.SetReturnType(LogicalType::UBIGINT);
 
-				variant.SetFunction(ExecuteGeometry);
-				variant.SetInit(LocalState::Init);
+				variant.SetFunction(ExecuteGeometry<OP>);
 			});
 
 			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
 				variant.AddParameter("box", GeoTypes::BOX_2D());
 				variant.AddParameter("bounds", GeoTypes::BOX_2D());
-				variant.SetReturnType(LogicalType::UINTEGER);
-
-				variant.SetFunction(ExecuteBox<double>);
-			});
-
-			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
-				variant.AddParameter("box", GeoTypes::BOX_2DF());
-				variant.AddParameter("bounds", GeoTypes::BOX_2DF());
-				variant.SetReturnType(LogicalType::UINTEGER);
+				variant.SetReturnType(LogicalType::UBIGINT);
 
-				variant.SetFunction(ExecuteBox<float>);
+				variant.SetFunction(ExecuteBox<OP>);
 			});
 
 			func.SetTag("ext", "spatial");
 			func.SetTag("category", "property");
 
-			func.SetDescription(DESCRIPTION);
-			func.SetExample(EXAMPLE);
+			func.SetDescription(description);
+			func.SetExample(example);
 		});
 	}
 };
 
+struct ST_Hilbert64 {
+	static constexpr auto DESCRIPTION = R"(
+		Encodes the X and Y values as the 64-bit hilbert curve index for a curve covering the given bounding box.
+
+		Like [ST_Hilbert](#st_hilbert), but with 32 bits of resolution per axis instead of 16, so that sorting large
+		tables by the curve does not end up with many rows sharing the same index. Values outside of the bounding box
+		are clamped to its edges.
+		If a geometry is provided, the center of its bounding box is used as the point to encode, empty geometries
+		return NULL. If no bounding box is provided, the hilbert curve index is mapped to the full range of a
+		single-precision float.
+		For the BOX_2D variant, the center of the box is used as the point to encode.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT * FROM cities ORDER BY ST_Hilbert64(geom, (SELECT ST_Extent(ST_Extent_Agg(geom)) FROM cities));
+	)";
+
+	static void Register(DatabaseInstance &db) {
+		SpaceFillingCurve64::Register<SpaceFillingCurve64::HilbertOp>(db, "ST_Hilbert64", DESCRIPTION, EXAMPLE);
+	}
+};
+
+struct ST_Morton64 {
+	static constexpr auto DESCRIPTION = R"(
+		Encodes the X and Y values as the 64-bit morton (z-order) curve index for a curve covering the given bounding box.
+
+		The morton index interleaves the bits of the X and Y cells, with 32 bits of resolution per axis. It is cheaper to
+		compute than the hilbert index, but keeps less of the locality. Values outside of the bounding box are clamped to
+		its edges.
+		If a geometry is provided, the center of its bounding box is used as the point to encode, empty geometries
+		return NULL. If no bounding box is provided, the morton curve index is mapped to the full range of a
+		single-precision float.
+		For the BOX_2D variant, the center of the box is used as the point to encode.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT ST_Morton64(1, 1, {min_x: 0, min_y: 0, max_x: 2, max_y: 2}::BOX_2D);
+	)";
+
+	static void Register(DatabaseInstance &db) {
+		SpaceFillingCurve64::Register<SpaceFillingCurve64::MortonOp>(db, "ST_Morton64", DESCRIPTION, EXAMPLE);
+	}
+};
+
 //======================================================================================================================
 // ST_Intersects
 //======================================================================================================================
@@ -5415,6 +5724,47 @@ struct ST_Intersects {
 		    });
 	}
 
+	//------------------------------------------------------------------------------------------------------------------
+	// BOX_2DF
+	//------------------------------------------------------------------------------------------------------------------
+	static void ExecuteBoxF(DataChunk &args, ExpressionState &state, Vector &result) {
+		using BOX_TYPE = StructTypeQuaternary<float, float, float, float>;
+		using BOOL_TYPE = PrimitiveType<bool>;
+
+		GenericExecutor::ExecuteBinary<BOX_TYPE, BOX_TYPE, BOOL_TYPE>(
+		    args.data[0], args.data[1], result, args.size(), [&](BOX_TYPE &left, BOX_TYPE &right) {
+			    return !(left.a_val > right.c_val || left.c_val < right.a_val || left.b_val > right.d_val ||
+			             left.d_val < right.b_val);
+		    });
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// BOX_2D -> POINT_2D
+	//------------------------------------------------------------------------------------------------------------------
+	static void ExecuteBoxPoint(DataChunk &args, ExpressionState &state, Vector &result) {
+		using BOX_TYPE = StructTypeQuaternary<double, double, double, double>;
+		using POINT_TYPE = StructTypeBinary<double, double>;
+		using BOOL_TYPE = PrimitiveType<bool>;
+
+		GenericExecutor::ExecuteBinary<BOX_TYPE, POINT_TYPE, BOOL_TYPE>(
+		    args.data[0], args.data[1], result, args.size(), [&](BOX_TYPE &box, POINT_TYPE &point) {
+			    return box.a_val <= point.a_val && point.a_val <= box.c_val && box.b_val <= point.b_val &&
+			           point.b_val <= box.d_val;
+		    });
+	}
+
+	static void ExecutePointBox(DataChunk &args, ExpressionState &state, Vector &result) {
+		using BOX_TYPE = StructTypeQuaternary<double, double, double, double>;
+		using POINT_TYPE = StructTypeBinary<double, double>;
+		using BOOL_TYPE = PrimitiveType<bool>;
+
+		GenericExecutor::ExecuteBinary<POINT_TYPE, BOX_TYPE, BOOL_TYPE>(
+		    args.data[0], args.data[1], result, args.size(), [&](POINT_TYPE &point, BOX_TYPE &box) {
+			    return box.a_val <= point.a_val && point.a_val <= box.c_val && box.b_val <= point.b_val &&
+			           point.b_val <= box.d_val;
+		    });
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// Documentation
 	//------------------------------------------------------------------------------------------------------------------
@@ -5435,6 +5785,30 @@ struct ST_Intersects {
 				variant.SetFunction(ExecuteBox);
 			});
 
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("box1", GeoTypes::BOX_2DF());
+				variant.AddParameter("box2", GeoTypes::BOX_2DF());
+				variant.SetReturnType(LogicalType::BOOLEAN);
+
+				variant.SetFunction(ExecuteBoxF);
+			});
+
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("box", GeoTypes::BOX_2D());
+				variant.AddParameter("point", GeoTypes::POINT_2D());
+				variant.SetReturnType(LogicalType::BOOLEAN);
+
+				variant.SetFunction(ExecuteBoxPoint);
+			});
+
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("point", GeoTypes::POINT_2D());
+				variant.AddParameter("box", GeoTypes::BOX_2D());
+				variant.SetReturnType(LogicalType::BOOLEAN);
+
+				variant.SetFunction(ExecutePointBox);
+			});
+
 			func.SetDescription(DESCRIPTION);
 			func.SetExample(EXAMPLE);
 
@@ -5580,14 +5954,17 @@ struct ST_IsEmpty {
 	// GEOMETRY
 	//------------------------------------------------------------------------------------------------------------------
 	static void ExecuteGeometry(DataChunk &args, ExpressionState &state, Vector &result) {
-		auto &lstate = LocalState::ResetAndGet(state);
-
 		UnaryExecutor::Execute<string_t, bool>(args.data[0], result, args.size(), [&](const string_t &blob) {
-			sgl::geometry geom;
-			lstate.Deserialize(blob, geom);
+			// The vertices of all parts are stored in one stream, so the geometry is empty if the stream is
+			size_t vertex_offset;
+			size_t vertex_count;
+			if (Serde::TryGetVertexStream(blob.GetData(), blob.GetSize(), vertex_offset, vertex_count)) {
+				return vertex_count == 0;
+			}
 
-			const auto vertex_count = sgl::ops::vertex_count(&geom);
-			return vertex_count == 0;
+			auto is_empty = true;
+			VisitVertexSpans(blob, [&](const GeometryPart &) { is_empty = false; });
+			return is_empty;
 		});
 	}
 
@@ -5624,7 +6001,6 @@ struct ST_IsEmpty {
 				variant.AddParameter("geom", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::BOOLEAN);
 
-				variant.SetInit(LocalState::Init);
 				variant.SetFunction(ExecuteGeometry);
 			});
 
@@ -5661,13 +6037,14 @@ struct ST_Length {
 	// GEOMETRY
 	//------------------------------------------------------------------------------------------------------------------
 	static void ExecuteGeometry(DataChunk &args, ExpressionState &state, Vector &result) {
-		auto &lstate = LocalState::ResetAndGet(state);
-
 		UnaryExecutor::Execute<string_t, double>(args.data[0], result, args.size(), [&](const string_t &blob) {
-			sgl::geometry geom;
-			lstate.Deserialize(blob, geom);
-
-			return sgl::ops::length(&geom);
+			// Polygon rings do not count towards the length
+			return SumVertexSpans(blob, [](const GeometryPart &part) {
+				if (part.is_ring || part.type != sgl::geometry_type::LINESTRING) {
+					return 0.0;
+				}
+				return part.vertices.Length();
+			});
 		});
 	}
 
@@ -5723,7 +6100,6 @@ struct ST_Length {
 				variant.AddParameter("geom", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::DOUBLE);
 
-				variant.SetInit(LocalState::Init);
 				variant.SetFunction(ExecuteGeometry);
 			});
 
@@ -5785,6 +6161,22 @@ struct ST_MakeEnvelope {
 		    });
 	}
 
+	//------------------------------------------------------------------------------------------------------------------
+	// Statistics
+	//------------------------------------------------------------------------------------------------------------------
+	static unique_ptr<BaseStatistics> Statistics(ClientContext &context, FunctionStatisticsInput &input) {
+		// Every envelope is a polygon with a single ring of five vertices
+		const double buffer[10] = {0, 0, 0, 1, 1, 1, 1, 0, 0, 0};
+
+		sgl::geometry ring(sgl::geometry_type::LINESTRING, false, false);
+		ring.set_vertex_data(reinterpret_cast<const char *>(buffer), 5);
+
+		sgl::geometry poly(sgl::geometry_type::POLYGON, false, false);
+		poly.append_part(&ring);
+
+		return GeometryStats::CreateStatistics(poly, input.child_stats);
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// Documentation
 	//------------------------------------------------------------------------------------------------------------------
@@ -5807,6 +6199,7 @@ struct ST_MakeEnvelope {
 
 				variant.SetInit(LocalState::Init);
 				variant.SetFunction(Execute);
+				variant.SetStatistics(Statistics);
 			});
 
 			func.SetDescription(DESCRIPTION);
@@ -6488,12 +6881,17 @@ struct ST_NPoints {
 	// Execute (GEOMETRY)
 	//------------------------------------------------------------------------------------------------------------------
 	static void ExecuteGeometry(DataChunk &args, ExpressionState &state, Vector &result) {
-		auto &lstate = LocalState::ResetAndGet(state);
+		UnaryExecutor::Execute<string_t, uint32_t>(args.data[0], result, args.size(), [&](const string_t &blob) {
+			// The size of the vertex stream gives the vertex count without looking at the structure
+			size_t stream_offset;
+			size_t stream_count;
+			if (Serde::TryGetVertexStream(blob.GetData(), blob.GetSize(), stream_offset, stream_count)) {
+				return static_cast<uint32_t>(stream_count);
+			}
 
-		UnaryExecutor::Execute<string_t, int32_t>(args.data[0], result, args.size(), [&](const string_t &blob) {
-			sgl::geometry geom;
-			lstate.Deserialize(blob, geom);
-			return sgl::ops::vertex_count(&geom);
+			uint32_t vertex_count = 0;
+			VisitVertexSpans(blob, [&](const GeometryPart &part) { vertex_count += part.vertices.count; });
+			return vertex_count;
 		});
 	}
 
@@ -6518,7 +6916,6 @@ struct ST_NPoints {
 					variant.AddParameter("geom", GeoTypes::GEOMETRY());
 					variant.SetReturnType(LogicalType::UINTEGER);
 
-					variant.SetInit(LocalState::Init);
 					variant.SetFunction(ExecuteGeometry);
 				});
 
@@ -6623,12 +7020,10 @@ struct ST_Perimeter {
 	// Execute (GEOMETRY)
 	//------------------------------------------------------------------------------------------------------------------
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
-		auto &lstate = LocalState::ResetAndGet(state);
-
 		UnaryExecutor::Execute<string_t, double>(args.data[0], result, args.size(), [&](const string_t &blob) {
-			sgl::geometry geom;
-			lstate.Deserialize(blob, geom);
-			return sgl::ops::perimeter(&geom);
+			return SumVertexSpans(blob, [](const GeometryPart &part) {
+				return part.is_ring ? part.vertices.Length() : 0.0;
+			});
 		});
 	}
 
@@ -6651,7 +7046,6 @@ struct ST_Perimeter {
 				variant.AddParameter("geom", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::DOUBLE);
 
-				variant.SetInit(LocalState::Init);
 				variant.SetFunction(Execute);
 			});
 
@@ -6773,18 +7167,19 @@ struct ST_Point {
 	// Execute (GEOMETRY)
 	//------------------------------------------------------------------------------------------------------------------
 	static void ExecuteGeometry(DataChunk &args, ExpressionState &state, Vector &result) {
-		auto &lstate = LocalState::ResetAndGet(state);
-
-		BinaryExecutor::Execute<double, double, string_t>(
-		    args.data[0], args.data[1], result, args.size(), [&](const double x, const double y) {
-			    const double buffer[2] = {x, y};
-
-			    sgl::geometry geometry;
-			    geometry.set_type(sgl::geometry_type::POINT);
-			    geometry.set_vertex_data(reinterpret_cast<const uint8_t *>(buffer), 1);
+		// Point blobs all have the same size and layout, so write them all at once
+		Serde::SerializePointsXY(args.data[0], args.data[1], result, args.size());
+	}
 
-			    return lstate.Serialize(result, geometry);
-		    });
+	//------------------------------------------------------------------------------------------------------------------
+	// Statistics
+	//------------------------------------------------------------------------------------------------------------------
+	static unique_ptr<BaseStatistics> Statistics(ClientContext &context, FunctionStatisticsInput &input) {
+		// Every point has the same type and size
+		const double buffer[2] = {0, 0};
+		sgl::geometry geometry(sgl::geometry_type::POINT, false, false);
+		geometry.set_vertex_data(reinterpret_cast<const char *>(buffer), 1);
+		return GeometryStats::CreateStatistics(geometry, input.child_stats);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
@@ -6808,7 +7203,7 @@ struct ST_Point {
 				variant.SetReturnType(GeoTypes::GEOMETRY());
 
 				variant.SetFunction(ExecuteGeometry);
-				variant.SetInit(LocalState::Init);
+				variant.SetStatistics(Statistics);
 			});
 
 			func.SetDescription(DESCRIPTION);
@@ -7220,6 +7615,88 @@ struct ST_QuadKey {
 	}
 };
 
+//======================================================================================================================
+// ST_Quantize
+//======================================================================================================================
+
+struct ST_Quantize {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Execute
+	//------------------------------------------------------------------------------------------------------------------
+	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
+		auto &lstate = LocalState::ResetAndGet(state);
+
+		vector<char> buffer;
+		vector<char> compressed;
+
+		BinaryExecutor::Execute<string_t, int32_t, string_t>(
+		    args.data[0], args.data[1], result, args.size(), [&](const string_t &blob, const int32_t decimals) {
+			    if (decimals < 0 || decimals > GeometryCompression::MAX_DECIMALS) {
+				    throw InvalidInputException("ST_Quantize: decimals must be between 0 and %d",
+				                                GeometryCompression::MAX_DECIMALS);
+			    }
+
+			    // Round a copy of the vertex stream in place, the blob is read-only
+			    size_t vertex_offset;
+			    size_t vertex_count;
+			    if (Serde::TryGetVertexStream(blob.GetData(), blob.GetSize(), vertex_offset, vertex_count)) {
+				    buffer.assign(blob.GetData(), blob.GetData() + blob.GetSize());
+			    } else {
+				    // Polygons and collections are written in version 0, which has no vertex stream, so rewrite them in
+				    // the latest version. The rounded geometry is a new value, so it does not have to stay byte for byte
+				    // equal to the input.
+				    sgl::geometry geom;
+				    lstate.Deserialize(blob, geom);
+				    buffer.resize(Serde::GetRequiredSize(geom, GEOMETRY_VERSION));
+				    Serde::Serialize(geom, buffer.data(), buffer.size(), GEOMETRY_VERSION);
+			    }
+
+			    GeometryCompression::Quantize(buffer.data(), buffer.size(), decimals);
+			    GeometryCompression::Compress(buffer.data(), buffer.size(), compressed);
+			    return StringVector::AddStringOrBlob(result, compressed.data(), compressed.size());
+		    });
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Rounds all coordinates of the geometry to the given number of decimal digits and returns it as a `COMPRESSED_GEOMETRY`.
+
+		The rounded coordinates are stored as integers, either as deltas between neighbouring vertices or as 32-bit offsets from the smallest coordinate of the geometry, whichever is smaller. This typically takes a quarter to half of the space of the full `GEOMETRY`, e.g. for GPS coordinates at 7 decimals (about 1 cm) or projected coordinates at 2 decimals. Functions accept the result directly, and see the rounded coordinates.
+
+		`decimals` has to be between 0 and 15, inclusive. NaN and infinite coordinates are kept as they are.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT ST_Quantize(ST_Point(11.123456789, 49.987654321), 3)::GEOMETRY;
+		----
+		POINT (11.123 49.988)
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		FunctionBuilder::RegisterScalar(db, "ST_Quantize", [](ScalarFunctionBuilder &func) {
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("geom", GeoTypes::GEOMETRY());
+				variant.AddParameter("decimals", LogicalType::INTEGER);
+				variant.SetReturnType(GeoTypes::COMPRESSED_GEOMETRY());
+				variant.SetFunction(Execute);
+				variant.SetInit(LocalState::Init);
+			});
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "conversion");
+
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+		});
+	}
+};
+
 //======================================================================================================================
 // ST_RemoveRepeatedPoints
 //======================================================================================================================
@@ -7780,6 +8257,21 @@ struct ST_Within {
 		ST_Contains::Operation(point_in, polygon_in, result, args.size());
 	}
 
+	//------------------------------------------------------------------------------------------------------------------
+	// POINT_2D -> BOX_2D
+	//------------------------------------------------------------------------------------------------------------------
+	static void ExecutePointBox(DataChunk &args, ExpressionState &state, Vector &result) {
+		using BOX_TYPE = StructTypeQuaternary<double, double, double, double>;
+		using POINT_TYPE = StructTypeBinary<double, double>;
+		using BOOL_TYPE = PrimitiveType<bool>;
+
+		GenericExecutor::ExecuteBinary<POINT_TYPE, BOX_TYPE, BOOL_TYPE>(
+		    args.data[0], args.data[1], result, args.size(), [&](POINT_TYPE &point, BOX_TYPE &box) {
+			    return box.a_val < point.a_val && point.a_val < box.c_val && box.b_val < point.b_val &&
+			           point.b_val < box.d_val;
+		    });
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// Documentation
 	//------------------------------------------------------------------------------------------------------------------
@@ -7801,6 +8293,14 @@ struct ST_Within {
 				variant.SetFunction(Execute);
 			});
 
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("point", GeoTypes::POINT_2D());
+				variant.AddParameter("box", GeoTypes::BOX_2D());
+				variant.SetReturnType(LogicalType::BOOLEAN);
+
+				variant.SetFunction(ExecutePointBox);
+			});
+
 			func.SetDescription(DESCRIPTION);
 			func.SetExample(EXAMPLE);
 
@@ -7935,7 +8435,7 @@ struct VertexMaxAggOp {
 
 template <class OP, class AGG>
 struct VertexAggFunctionBase {
-	static size_t GetOrdinateOffset(const sgl::geometry &geom) {
+	static uint32_t GetOrdinateOffset(const GeometryProperties &props) {
 		switch (OP::ORDINATE) {
 		case VertexOrdinate::X:
 			return 0;
@@ -7944,43 +8444,79 @@ struct VertexAggFunctionBase {
 		case VertexOrdinate::Z:
 			return 2;
 		case VertexOrdinate::M:
-			return geom.has_z() ? 3 : 2;
+			return props.HasZ() ? 3 : 2;
 		default:
 			return 0;
 		}
 	}
 
+	// Reduce one ordinate of a run of vertices. The independent accumulators let the compiler vectorize the loop, as
+	// min/max does not depend on the order of the vertices.
+	static double Reduce(const char *vertices, const idx_t count, const idx_t vertex_size, const idx_t offset,
+	                     const double init) {
+		static constexpr idx_t LANES = 4;
+
+		double acc[LANES] = {init, init, init, init};
+		const auto ordinates = vertices + offset * sizeof(double);
+
+		idx_t i = 0;
+		for (; i + LANES <= count; i += LANES) {
+			for (idx_t lane = 0; lane < LANES; lane++) {
+				double value;
+				memcpy(&value, ordinates + (i + lane) * vertex_size, sizeof(double));
+				acc[lane] = AGG::Merge(acc[lane], value);
+			}
+		}
+		for (; i < count; i++) {
+			double value;
+			memcpy(&value, ordinates + i * vertex_size, sizeof(double));
+			acc[0] = AGG::Merge(acc[0], value);
+		}
+		return AGG::Merge(AGG::Merge(acc[0], acc[1]), AGG::Merge(acc[2], acc[3]));
+	}
+
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
-		auto &lstate = LocalState::ResetAndGet(state);
 		UnaryExecutor::ExecuteWithNulls<string_t, double>(
 		    args.data[0], result, args.size(), [&](const string_t &blob, ValidityMask &mask, const idx_t idx) {
-			    sgl::geometry geom;
-			    lstate.Deserialize(blob, geom);
+			    const auto props = geometry_t(blob).GetProperties();
 
-			    if (geom.is_empty()) {
-				    mask.SetInvalid(idx);
-				    return 0.0;
-			    }
-			    if (OP::ORDINATE == VertexOrdinate::Z && !geom.has_z()) {
+			    if (OP::ORDINATE == VertexOrdinate::Z && !props.HasZ()) {
 				    mask.SetInvalid(idx);
 				    return 0.0;
 			    }
-			    if (OP::ORDINATE == VertexOrdinate::M && !geom.has_m()) {
+			    if (OP::ORDINATE == VertexOrdinate::M && !props.HasM()) {
 				    mask.SetInvalid(idx);
 				    return 0.0;
 			    }
 
-			    const auto offset = GetOrdinateOffset(geom);
+			    const auto offset = GetOrdinateOffset(props);
+			    const auto vertex_size = props.VertexSize();
+
+			    // The cached bounds are rounded to floats, so they can not be used for the exact value. But the vertices
+			    // of all parts are stored in one stream, which we can scan without looking at the structure at all.
+			    size_t vertex_offset;
+			    size_t vertex_count;
+			    if (Serde::TryGetVertexStream(blob.GetData(), blob.GetSize(), vertex_offset, vertex_count)) {
+				    if (vertex_count == 0) {
+					    mask.SetInvalid(idx);
+					    return 0.0;
+				    }
+				    return Reduce(blob.GetData() + vertex_offset, vertex_count, vertex_size, offset, AGG::Init());
+			    }
 
+			    // Polygons and collections in version 0 interleave the vertices with the part headers
+			    auto is_empty = true;
 			    double res = AGG::Init();
 
-			    sgl::ops::visit_vertices(&geom, [&](const uint8_t *vertex) {
-				    double val = 0.0;
-				    memcpy(&val, vertex + offset * sizeof(double), sizeof(double));
-
-				    res = AGG::Merge(res, val);
+			    VisitVertexSpans(blob, [&](const GeometryPart &part) {
+				    res = Reduce(part.vertices.data, part.vertices.count, vertex_size, offset, res);
+				    is_empty = false;
 			    });
 
+			    if (is_empty) {
+				    mask.SetInvalid(idx);
+				    return 0.0;
+			    }
 			    return res;
 		    });
 	}
@@ -8111,7 +8647,6 @@ struct VertexAggFunctionBase {
 				variant.AddParameter("geom", GeoTypes::GEOMETRY());
 				variant.SetReturnType(LogicalType::DOUBLE);
 
-				variant.SetInit(LocalState::Init);
 				variant.SetFunction(Execute);
 			});
 
@@ -8261,6 +8796,7 @@ void RegisterSpatialScalarFunctions(DatabaseInstance &db) {
 	ST_AsHEXWKB::Register(db);
 	ST_AsSVG::Register(db);
 	ST_Centroid::Register(db);
+	ST_ClipByBox2D::Register(db);
 	ST_Collect::Register(db);
 	ST_CollectionExtract::Register(db);
 	ST_Contains::Register(db);
@@ -8270,6 +8806,7 @@ void RegisterSpatialScalarFunctions(DatabaseInstance &db) {
 	ST_EndPoint::Register(db);
 	ST_Extent::Register(db);
 	ST_Extent_Approx::Register(db);
+	ST_CoveringBBox::Register(db);
 	ST_ExteriorRing::Register(db);
 	ST_FlipCoordinates::Register(db);
 	ST_Force2D::Register(db);
@@ -8288,7 +8825,9 @@ void RegisterSpatialScalarFunctions(DatabaseInstance &db) {
 	ST_LineSubstring::Register(db);
 	ST_ZMFlag::Register(db);
 	ST_Distance_Sphere::Register(db);
+	ST_DWithin_Sphere::Register(db);
 	ST_Hilbert::Register(db);
+	ST_Hilbert64::Register(db);
 	ST_Intersects::Register(db);
 	ST_IntersectsExtent::Register(db);
 	ST_IsClosed::Register(db);
@@ -8297,6 +8836,7 @@ void RegisterSpatialScalarFunctions(DatabaseInstance &db) {
 	ST_MakeEnvelope::Register(db);
 	ST_MakeLine::Register(db);
 	ST_MakePolygon::Register(db);
+	ST_Morton64::Register(db);
 	ST_Multi::Register(db);
 	ST_NGeometries::Register(db);
 	ST_NInteriorRings::Register(db);
@@ -8306,6 +8846,7 @@ void RegisterSpatialScalarFunctions(DatabaseInstance &db) {
 	ST_PointN::Register(db);
 	ST_Points::Register(db);
 	ST_QuadKey::Register(db);
+	ST_Quantize::Register(db);
 	ST_RemoveRepeatedPoints::Register(db);
 	ST_StartPoint::Register(db);
 	ST_Within::Register(db);
@@ -1,5 +1,15 @@
+#include "duckdb/common/case_insensitive_map.hpp"
+#include "duckdb/common/random_engine.hpp"
 #include "duckdb/main/extension_util.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/statement/select_statement.hpp"
+#include "duckdb/parser/tableref/subqueryref.hpp"
+#include "duckdb/planner/binder.hpp"
 #include "spatial/geometry/bbox.hpp"
+#include "spatial/geometry/geometry_cursor.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
 #include "spatial/modules/main/spatial_functions.hpp"
 #include "spatial/spatial_types.hpp"
 
@@ -13,19 +23,433 @@ namespace {
 // Table Functions
 //######################################################################################################################
 
+//======================================================================================================================
+// ST_DumpParts / ST_DumpPoints
+//======================================================================================================================
+// Table in-out versions of ST_Dump and ST_Points, which explode every geometry of their input into one row per part or
+// per vertex. Unlike the scalar functions they never materialize a list per geometry: the parts are read straight from
+// the blob with a GeometryCursor, and the rows (and their paths) are produced one chunk at a time, so memory stays flat
+// even for geometries with millions of vertices. Being in-out functions, they run in parallel over their input.
+
+struct DumpLocalState final : LocalTableFunctionState {
+	explicit DumpLocalState(ClientContext &context) : arena(BufferAllocator::Get(context)) {
+	}
+
+	UnifiedVectorFormat input_format;
+	// Whether the input chunk is new, and the next row of it to dump
+	bool new_chunk = true;
+	idx_t row_idx = 0;
+
+	// The cursor over the geometry being dumped, null once all of its parts have been produced
+	unique_ptr<GeometryCursor> cursor;
+	// The current part, its path, and (for ST_DumpPoints) the next vertex of it to produce
+	GeometryPart part;
+	bool has_part = false;
+	vector<int32_t> path;
+	uint32_t vertex_idx = 0;
+
+	// The rings of the polygons of the current output chunk
+	ArenaAllocator arena;
+
+	// Move the path to the current part. The path holds the (1-based) index of the part and its ancestors, except the
+	// root, so every level of nesting descends one level deeper
+	void UpdatePath() {
+		path.resize(part.depth);
+		if (part.depth > 0) {
+			path.back() = UnsafeNumericCast<int32_t>(part.index + 1);
+		}
+	}
+};
+
+template <class OP>
+struct DumpFunction {
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names) {
+		return_types.push_back(GeoTypes::GEOMETRY());
+		names.push_back("geom");
+		return_types.push_back(LogicalType::LIST(LogicalType::INTEGER));
+		names.push_back("path");
+		return make_uniq<TableFunctionData>();
+	}
+
+	static unique_ptr<LocalTableFunctionState> InitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+	                                                     GlobalTableFunctionState *global_state) {
+		return make_uniq<DumpLocalState>(context.client);
+	}
+
+	static void WriteRow(DataChunk &output, const idx_t out_idx, const sgl::geometry &geom,
+	                     const vector<int32_t> &path, const int32_t *last) {
+		auto &geom_vec = output.data[0];
+		const auto size = Serde::GetRequiredSize(geom);
+		auto blob = StringVector::EmptyString(geom_vec, size);
+		Serde::Serialize(geom, blob.GetDataWriteable(), size);
+		blob.Finalize();
+		FlatVector::GetData<string_t>(geom_vec)[out_idx] = blob;
+
+		auto &path_vec = output.data[1];
+		const auto path_offset = ListVector::GetListSize(path_vec);
+		const auto path_length = path.size() + (last ? 1 : 0);
+		ListVector::Reserve(path_vec, path_offset + path_length);
+
+		const auto path_data = FlatVector::GetData<int32_t>(ListVector::GetEntry(path_vec));
+		std::copy(path.begin(), path.end(), path_data + path_offset);
+		if (last) {
+			path_data[path_offset + path.size()] = *last;
+		}
+		ListVector::SetListSize(path_vec, path_offset + path_length);
+		ListVector::GetData(path_vec)[out_idx] = list_entry_t(path_offset, path_length);
+	}
+
+	static OperatorResultType Execute(ExecutionContext &context, TableFunctionInput &data, DataChunk &input,
+	                                  DataChunk &output) {
+		auto &state = data.local_state->Cast<DumpLocalState>();
+		if (state.new_chunk) {
+			input.data[0].ToUnifiedFormat(input.size(), state.input_format);
+			state.new_chunk = false;
+			state.row_idx = 0;
+		}
+		state.arena.Reset();
+
+		idx_t out_idx = 0;
+		while (out_idx < STANDARD_VECTOR_SIZE) {
+			if (!state.cursor) {
+				if (state.row_idx == input.size()) {
+					break;
+				}
+				const auto row_idx = state.input_format.sel->get_index(state.row_idx++);
+				if (!state.input_format.validity.RowIsValid(row_idx)) {
+					continue;
+				}
+				const auto &blob = UnifiedVectorFormat::GetData<string_t>(state.input_format)[row_idx];
+				state.cursor = make_uniq<GeometryCursor>(blob);
+				state.has_part = false;
+			}
+			if (!OP::Produce(state, output, out_idx)) {
+				state.cursor.reset();
+			}
+		}
+		output.SetCardinality(out_idx);
+
+		if (state.cursor || state.row_idx < input.size()) {
+			return OperatorResultType::HAVE_MORE_OUTPUT;
+		}
+		state.new_chunk = true;
+		return OperatorResultType::NEED_MORE_INPUT;
+	}
+
+	static void Register(DatabaseInstance &db, const char *name, const char *description, const char *example) {
+		TableFunction func(name, {GeoTypes::GEOMETRY()}, nullptr, Bind, nullptr, InitLocal);
+		func.in_out_function = Execute;
+		ExtensionUtil::RegisterFunction(db, func);
+
+		InsertionOrderPreservingMap<string> tags;
+		tags.insert("ext", "spatial");
+		FunctionBuilder::AddTableFunctionDocs(db, name, description, example, tags);
+	}
+};
+
+struct ST_DumpParts {
+	// Produce the points, linestrings and polygons of the current geometry until the output is full. Returns false
+	// once the geometry is exhausted
+	static bool Produce(DumpLocalState &state, DataChunk &output, idx_t &out_idx) {
+		auto &cursor = *state.cursor;
+		auto &part = state.part;
+		const auto has_z = cursor.HasZ();
+		const auto has_m = cursor.HasM();
+
+		while (out_idx < STANDARD_VECTOR_SIZE) {
+			if (!cursor.Next(part)) {
+				return false;
+			}
+			state.UpdatePath();
+
+			sgl::geometry geom(part.type, has_z, has_m);
+			switch (part.type) {
+			case sgl::geometry_type::POINT:
+			case sgl::geometry_type::LINESTRING:
+				geom.set_vertex_data(part.vertices.data, part.vertices.count);
+				break;
+			case sgl::geometry_type::POLYGON: {
+				// The rings follow the polygon, gather them into the polygon before writing it
+				const auto ring_count = part.part_count;
+				GeometryPart ring_part;
+				for (uint32_t i = 0; i < ring_count; i++) {
+					cursor.Next(ring_part);
+					const auto ring_mem = state.arena.AllocateAligned(sizeof(sgl::geometry));
+					const auto ring = new (ring_mem) sgl::geometry(sgl::geometry_type::LINESTRING, has_z, has_m);
+					ring->set_vertex_data(ring_part.vertices.data, ring_part.vertices.count);
+					geom.append_part(ring);
+				}
+			} break;
+			default:
+				// Collections are not produced, only their parts
+				continue;
+			}
+			DumpFunction<ST_DumpParts>::WriteRow(output, out_idx++, geom, state.path, nullptr);
+		}
+		return true;
+	}
+
+	static constexpr auto DESCRIPTION = R"(
+		Dumps geometries into their sub-geometries and the "path" of each of them in the original geometry, one row per sub-geometry.
+
+		This is the table function version of [ST_Dump](#st_dump). Instead of returning a list per geometry, the points, linestrings and polygons are produced as rows, one chunk at a time, so that exploding huge (multi)geometries doesn't materialize them at once.
+		Pass a column of a table (as a lateral join) or a subquery to dump all of its geometries.
+	)";
+	static constexpr auto EXAMPLE = R"(
+		SELECT * FROM ST_DumpParts('MULTIPOINT(1 2,3 4)'::GEOMETRY);
+		----
+		┌─────────────┬─────────┐
+		│    geom     │  path   │
+		│  geometry   │ int32[] │
+		├─────────────┼─────────┤
+		│ POINT (1 2) │ [1]     │
+		│ POINT (3 4) │ [2]     │
+		└─────────────┴─────────┘
+
+		SELECT t.id, d.* FROM t, ST_DumpParts(t.geom) AS d;
+	)";
+
+	static void Register(DatabaseInstance &db) {
+		DumpFunction<ST_DumpParts>::Register(db, "ST_DumpParts", DESCRIPTION, EXAMPLE);
+	}
+};
+
+struct ST_DumpPoints {
+	// Produce the vertices of the current geometry until the output is full. Returns false once the geometry is
+	// exhausted
+	static bool Produce(DumpLocalState &state, DataChunk &output, idx_t &out_idx) {
+		auto &cursor = *state.cursor;
+		auto &part = state.part;
+		sgl::geometry point(sgl::geometry_type::POINT, cursor.HasZ(), cursor.HasM());
+
+		while (true) {
+			if (!state.has_part || state.vertex_idx == part.vertices.count) {
+				if (!cursor.Next(part)) {
+					return false;
+				}
+				state.UpdatePath();
+				state.has_part = true;
+				state.vertex_idx = 0;
+				continue;
+			}
+			if (out_idx == STANDARD_VECTOR_SIZE) {
+				return true;
+			}
+
+			const auto &vertices = part.vertices;
+			point.set_vertex_data(vertices.data + state.vertex_idx * vertices.vertex_size, 1);
+
+			// The path of a vertex ends with its index, unless the vertex is a point of its own
+			const auto vertex_number = UnsafeNumericCast<int32_t>(state.vertex_idx + 1);
+			const auto last = part.type == sgl::geometry_type::POINT ? nullptr : &vertex_number;
+			DumpFunction<ST_DumpPoints>::WriteRow(output, out_idx++, point, state.path, last);
+			state.vertex_idx++;
+		}
+	}
+
+	static constexpr auto DESCRIPTION = R"(
+		Dumps the vertices of geometries as points, with the "path" of each vertex in the original geometry, one row per vertex.
+
+		This is the table function version of [ST_Points](#st_points). The path holds the (1-based) index of the sub-geometry, the ring of a polygon, and the vertex itself.
+		The vertices are read straight from the geometry and produced one chunk at a time, so that exploding geometries with millions of vertices doesn't materialize them at once.
+		Pass a column of a table (as a lateral join) or a subquery to dump the vertices of all of its geometries.
+	)";
+	static constexpr auto EXAMPLE = R"(
+		SELECT * FROM ST_DumpPoints('POLYGON((0 0, 1 0, 1 1, 0 0))'::GEOMETRY);
+		----
+		┌─────────────┬─────────┐
+		│    geom     │  path   │
+		│  geometry   │ int32[] │
+		├─────────────┼─────────┤
+		│ POINT (0 0) │ [1, 1]  │
+		│ POINT (1 0) │ [1, 2]  │
+		│ POINT (1 1) │ [1, 3]  │
+		│ POINT (0 0) │ [1, 4]  │
+		└─────────────┴─────────┘
+	)";
+
+	static void Register(DatabaseInstance &db) {
+		DumpFunction<ST_DumpPoints>::Register(db, "ST_DumpPoints", DESCRIPTION, EXAMPLE);
+	}
+};
+
 //======================================================================================================================
 // ST_GeneratePoints
 //======================================================================================================================
 
 struct ST_GeneratePoints {
 
+	//------------------------------------------------------------------------------------------------------------------
+	// Random Numbers
+	//------------------------------------------------------------------------------------------------------------------
+	// The points are generated in parallel, so we use a counter-based random number generator (SplitMix64): the n-th
+	// number only depends on the seed and on n. Every point draws its numbers from its own row index, so a fixed seed
+	// gives the same points in the same order, whatever the number of threads or the vector size.
+	static uint64_t Mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	// Returns a random number in [0, 1)
+	static double GetRandom(const uint64_t key, const uint64_t counter) {
+		const auto z = Mix(key + (counter + 1) * 0x9E3779B97F4A7C15ULL);
+		return static_cast<double>(z >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Polygon Decomposition
+	//------------------------------------------------------------------------------------------------------------------
+	// To generate points uniformly inside a polygon without rejection sampling, we split it into horizontal slabs at
+	// every vertex. No edge starts or ends within a slab, so the part of the polygon inside a slab is a set of
+	// trapezoids between pairs of edges, each of which is split into two triangles. We then pick a triangle weighted
+	// by its area, and a uniformly distributed point inside it.
+	struct Trapezoid {
+		double min_y;
+		double max_y;
+		// The left and right edge, at the bottom and the top of the slab
+		double bottom_min_x;
+		double bottom_max_x;
+		double top_min_x;
+		double top_max_x;
+	};
+
+	struct Edge {
+		double min_x; // at min_y
+		double min_y;
+		double max_x; // at max_y
+		double max_y;
+
+		double GetX(const double y) const {
+			if (y <= min_y) {
+				return min_x;
+			}
+			if (y >= max_y) {
+				return max_x;
+			}
+			return min_x + (max_x - min_x) * (y - min_y) / (max_y - min_y);
+		}
+	};
+
+	static void CollectEdges(const sgl::geometry &geom, vector<Edge> &edges) {
+		sgl::ops::visit_by_dimension(&geom, 2, &edges, [](void *arg, const sgl::geometry *part) {
+			if (part->get_type() != sgl::geometry_type::POLYGON) {
+				return;
+			}
+			auto &edges = *static_cast<vector<Edge> *>(arg);
+
+			const auto tail = part->get_last_part();
+			auto ring = tail;
+			if (!ring) {
+				return;
+			}
+			do {
+				ring = ring->get_next();
+				const auto vertex_count = ring->get_count();
+				for (uint32_t i = 1; i < vertex_count; i++) {
+					const auto prev = ring->get_vertex_xy(i - 1);
+					const auto next = ring->get_vertex_xy(i);
+					// Horizontal edges never bound a slab from the left or right
+					if (prev.y == next.y) {
+						continue;
+					}
+					if (prev.y < next.y) {
+						edges.push_back({prev.x, prev.y, next.x, next.y});
+					} else {
+						edges.push_back({next.x, next.y, prev.x, prev.y});
+					}
+				}
+			} while (ring != tail);
+		});
+	}
+
+	// Decompose the (assumed to be valid) polygons of the geometry into trapezoids, returns the total area
+	static double Decompose(const sgl::geometry &geom, vector<Trapezoid> &trapezoids, vector<double> &cumulative_area) {
+		vector<Edge> edges;
+		CollectEdges(geom, edges);
+
+		std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) { return a.min_y < b.min_y; });
+
+		vector<double> slab_ys;
+		slab_ys.reserve(edges.size() * 2);
+		for (const auto &edge : edges) {
+			slab_ys.push_back(edge.min_y);
+			slab_ys.push_back(edge.max_y);
+		}
+		std::sort(slab_ys.begin(), slab_ys.end());
+		slab_ys.erase(std::unique(slab_ys.begin(), slab_ys.end()), slab_ys.end());
+
+		// The edges that span the current slab, ordered from left to right
+		vector<const Edge *> active;
+		vector<std::pair<double, const Edge *>> ordered;
+
+		double total_area = 0;
+		idx_t edge_idx = 0;
+
+		for (idx_t slab_idx = 0; slab_idx + 1 < slab_ys.size(); slab_idx++) {
+			const auto min_y = slab_ys[slab_idx];
+			const auto max_y = slab_ys[slab_idx + 1];
+
+			// Remove the edges that ended, and add the edges that start at this slab
+			active.erase(std::remove_if(active.begin(), active.end(),
+			                            [&](const Edge *edge) { return edge->max_y <= min_y; }),
+			             active.end());
+			while (edge_idx < edges.size() && edges[edge_idx].min_y <= min_y) {
+				active.push_back(&edges[edge_idx++]);
+			}
+
+			// The edges do not cross inside the slab, so we can order them by their x in the middle of the slab
+			const auto mid_y = min_y + (max_y - min_y) / 2;
+			ordered.clear();
+			for (const auto edge : active) {
+				ordered.emplace_back(edge->GetX(mid_y), edge);
+			}
+			std::sort(ordered.begin(), ordered.end(),
+			          [](const std::pair<double, const Edge *> &a, const std::pair<double, const Edge *> &b) {
+				          return a.first < b.first;
+			          });
+
+			// By the even-odd rule, the interior is between every other pair of edges
+			for (idx_t i = 0; i + 1 < ordered.size(); i += 2) {
+				const auto &left = *ordered[i].second;
+				const auto &right = *ordered[i + 1].second;
+
+				Trapezoid trapezoid;
+				trapezoid.min_y = min_y;
+				trapezoid.max_y = max_y;
+				trapezoid.bottom_min_x = left.GetX(min_y);
+				trapezoid.bottom_max_x = MaxValue(right.GetX(min_y), trapezoid.bottom_min_x);
+				trapezoid.top_min_x = left.GetX(max_y);
+				trapezoid.top_max_x = MaxValue(right.GetX(max_y), trapezoid.top_min_x);
+
+				const auto width = (trapezoid.bottom_max_x - trapezoid.bottom_min_x) +
+				                   (trapezoid.top_max_x - trapezoid.top_min_x);
+				const auto area = width * (max_y - min_y) / 2;
+				if (!(area > 0)) {
+					continue;
+				}
+
+				total_area += area;
+				trapezoids.push_back(trapezoid);
+				cumulative_area.push_back(total_area);
+			}
+		}
+
+		return total_area;
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// Bind
 	//------------------------------------------------------------------------------------------------------------------
 	struct GeneratePointsBindData final : TableFunctionData {
 		idx_t count = 0;
-		int64_t seed = -1;
+		uint64_t key = 0;
 		Box2D<double> bbox;
+
+		// Only used when generating points inside a polygon
+		vector<Trapezoid> trapezoids;
+		vector<double> cumulative_area;
 	};
 
 	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
@@ -35,13 +459,30 @@ struct ST_GeneratePoints {
 		return_types.push_back(GeoTypes::POINT_2D());
 		names.push_back("point");
 
-		// Extract the bounding box
-		const auto &box_value = input.inputs[0];
-		auto &box_components = StructValue::GetChildren(box_value);
-		result->bbox.min.x = box_components[0].GetValue<double>();
-		result->bbox.min.y = box_components[1].GetValue<double>();
-		result->bbox.max.x = box_components[2].GetValue<double>();
-		result->bbox.max.y = box_components[3].GetValue<double>();
+		// Extract the bounding box, or the polygon
+		const auto &area_value = input.inputs[0];
+		if (area_value.IsNull()) {
+			throw BinderException("The area to generate points in must not be NULL");
+		}
+		if (area_value.type() == GeoTypes::GEOMETRY()) {
+			const auto &blob = StringValue::Get(area_value);
+
+			ArenaAllocator arena(BufferAllocator::Get(context));
+			sgl::geometry geom;
+			Serde::Deserialize(geom, arena, blob.c_str(), blob.size());
+
+			const auto area = Decompose(geom, result->trapezoids, result->cumulative_area);
+			if (!(area > 0)) {
+				throw BinderException(
+				    "The geometry to generate points in must be a (multi)polygon with a non-zero area");
+			}
+		} else {
+			auto &box_components = StructValue::GetChildren(area_value);
+			result->bbox.min.x = box_components[0].GetValue<double>();
+			result->bbox.min.y = box_components[1].GetValue<double>();
+			result->bbox.max.x = box_components[2].GetValue<double>();
+			result->bbox.max.y = box_components[3].GetValue<double>();
+		}
 
 		// Extract the count
 		const auto &count_value = input.inputs[1];
@@ -51,10 +492,15 @@ struct ST_GeneratePoints {
 		}
 		result->count = UnsafeNumericCast<idx_t>(count);
 
-		// Extract the seed (optional)
+		// Extract the seed (optional), otherwise pick a random one
+		uint64_t seed;
 		if (input.inputs.size() == 3) {
-			result->seed = input.inputs[2].GetValue<int64_t>();
+			seed = static_cast<uint64_t>(input.inputs[2].GetValue<int64_t>());
+		} else {
+			RandomEngine rng;
+			seed = (static_cast<uint64_t>(rng.NextRandomInteger()) << 32) | rng.NextRandomInteger();
 		}
+		result->key = Mix(seed);
 
 		return std::move(result);
 	}
@@ -62,60 +508,146 @@ struct ST_GeneratePoints {
 	//------------------------------------------------------------------------------------------------------------------
 	// Init
 	//------------------------------------------------------------------------------------------------------------------
-	struct GeneratePointsState final : GlobalTableFunctionState {
-		RandomEngine rng;
-		idx_t current_idx;
+	struct GeneratePointsGlobalState final : GlobalTableFunctionState {
+		atomic<idx_t> next_idx;
+		idx_t max_threads;
+
+		explicit GeneratePointsGlobalState(idx_t max_threads_p) : next_idx(0), max_threads(max_threads_p) {
+		}
 
-		explicit GeneratePointsState(const int64_t seed) : rng(seed), current_idx(0) {
+		idx_t MaxThreads() const override {
+			return max_threads;
 		}
 	};
 
-	static unique_ptr<GlobalTableFunctionState> Init(ClientContext &context, TableFunctionInitInput &input) {
+	struct GeneratePointsLocalState final : LocalTableFunctionState {
+		// The index of the first point of the vector currently being generated
+		idx_t vector_start = 0;
+	};
+
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
 		auto &bind_data = input.bind_data->Cast<GeneratePointsBindData>();
-		auto result = make_uniq<GeneratePointsState>(bind_data.seed);
-		return std::move(result);
+		const auto vector_count = (bind_data.count + STANDARD_VECTOR_SIZE - 1) / STANDARD_VECTOR_SIZE;
+		return make_uniq<GeneratePointsGlobalState>(MaxValue<idx_t>(vector_count, 1));
+	}
+
+	static unique_ptr<LocalTableFunctionState> InitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+	                                                     GlobalTableFunctionState *global_state) {
+		return make_uniq<GeneratePointsLocalState>();
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
 	// Execute
 	//------------------------------------------------------------------------------------------------------------------
+	static void GenerateInBox(const GeneratePointsBindData &bind_data, idx_t start, idx_t count, double *x_data,
+	                          double *y_data) {
+		const auto &bbox = bind_data.bbox;
+		for (idx_t i = 0; i < count; i++) {
+			const auto counter = (start + i) * 2;
+			x_data[i] = bbox.min.x + GetRandom(bind_data.key, counter) * (bbox.max.x - bbox.min.x);
+			y_data[i] = bbox.min.y + GetRandom(bind_data.key, counter + 1) * (bbox.max.y - bbox.min.y);
+		}
+	}
+
+	static void GenerateInPolygon(const GeneratePointsBindData &bind_data, idx_t start, idx_t count, double *x_data,
+	                              double *y_data) {
+		const auto &cumulative_area = bind_data.cumulative_area;
+		const auto total_area = cumulative_area.back();
+
+		for (idx_t i = 0; i < count; i++) {
+			const auto counter = (start + i) * 4;
+
+			// Pick a trapezoid, weighted by its area
+			const auto target = GetRandom(bind_data.key, counter) * total_area;
+			const auto it = std::upper_bound(cumulative_area.begin(), cumulative_area.end(), target);
+			const auto trapezoid_idx = MinValue<idx_t>(it - cumulative_area.begin(), cumulative_area.size() - 1);
+			const auto &t = bind_data.trapezoids[trapezoid_idx];
+
+			// Pick one of its triangles, weighted by their area (which is proportional to their base)
+			const auto bottom_width = t.bottom_max_x - t.bottom_min_x;
+			const auto top_width = t.top_max_x - t.top_min_x;
+			const auto pick_bottom = GetRandom(bind_data.key, counter + 1) * (bottom_width + top_width) < bottom_width;
+
+			// The bottom triangle is (bottom left, bottom right, top right), the top one (bottom left, top right,
+			// top left). Both start at the bottom left corner.
+			const auto ax = t.bottom_min_x;
+			const auto ay = t.min_y;
+			const auto bx = pick_bottom ? t.bottom_max_x : t.top_max_x;
+			const auto by = pick_bottom ? t.min_y : t.max_y;
+			const auto cx = pick_bottom ? t.top_max_x : t.top_min_x;
+			const auto cy = t.max_y;
+
+			// Pick a point in the parallelogram spanned by the triangle, and fold it back into the triangle
+			auto u = GetRandom(bind_data.key, counter + 2);
+			auto v = GetRandom(bind_data.key, counter + 3);
+			if (u + v > 1) {
+				u = 1 - u;
+				v = 1 - v;
+			}
+			x_data[i] = ax + u * (bx - ax) + v * (cx - ax);
+			y_data[i] = ay + u * (by - ay) + v * (cy - ay);
+		}
+	}
+
 	static void Execute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
 		auto &bind_data = data_p.bind_data->Cast<GeneratePointsBindData>();
-		auto &state = data_p.global_state->Cast<GeneratePointsState>();
+		auto &gstate = data_p.global_state->Cast<GeneratePointsGlobalState>();
+		auto &lstate = data_p.local_state->Cast<GeneratePointsLocalState>();
+
+		// Claim the next vector of points
+		const auto start = gstate.next_idx.fetch_add(STANDARD_VECTOR_SIZE);
+		if (start >= bind_data.count) {
+			output.SetCardinality(0);
+			return;
+		}
+		lstate.vector_start = start;
 
 		const auto &point_vec = StructVector::GetEntries(output.data[0]);
-		const auto &x_data = FlatVector::GetData<double>(*point_vec[0]);
-		const auto &y_data = FlatVector::GetData<double>(*point_vec[1]);
-
-		const auto chunk_size = MinValue<idx_t>(STANDARD_VECTOR_SIZE, bind_data.count - state.current_idx);
-		for (idx_t i = 0; i < chunk_size; i++) {
-
-			x_data[i] = state.rng.NextRandom32(bind_data.bbox.min.x, bind_data.bbox.max.x);
-			y_data[i] = state.rng.NextRandom32(bind_data.bbox.min.y, bind_data.bbox.max.y);
-
-			state.current_idx++;
+		const auto x_data = FlatVector::GetData<double>(*point_vec[0]);
+		const auto y_data = FlatVector::GetData<double>(*point_vec[1]);
+
+		const auto chunk_size = MinValue<idx_t>(STANDARD_VECTOR_SIZE, bind_data.count - start);
+		if (bind_data.trapezoids.empty()) {
+			GenerateInBox(bind_data, start, chunk_size, x_data, y_data);
+		} else {
+			GenerateInPolygon(bind_data, start, chunk_size, x_data, y_data);
 		}
 		output.SetCardinality(chunk_size);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
-	// Cardinality
+	// Cardinality and Partition Data
 	//------------------------------------------------------------------------------------------------------------------
 	static unique_ptr<NodeStatistics> Cardinality(ClientContext &context, const FunctionData *bind_data_p) {
 		auto &bind_data = bind_data_p->Cast<GeneratePointsBindData>();
 		return make_uniq<NodeStatistics>(bind_data.count, bind_data.count);
 	}
 
+	static OperatorPartitionData GetPartitionData(ClientContext &context, TableFunctionGetPartitionInput &input) {
+		if (input.partition_info.RequiresPartitionColumns()) {
+			throw InternalException("ST_GeneratePoints::GetPartitionData: partition columns not supported");
+		}
+		// The vectors are claimed in order, so their index preserves the order of the points
+		auto &lstate = input.local_state->Cast<GeneratePointsLocalState>();
+		return OperatorPartitionData(lstate.vector_start / STANDARD_VECTOR_SIZE);
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// DOCUMENTATION
 	//------------------------------------------------------------------------------------------------------------------
 	static constexpr auto DESCRIPTION = R"(
-		Generates a set of random points within the specified bounding box.
+		Generates a set of random points within the specified bounding box, or inside the specified polygon.
+
+		Takes a bounding box (min_x, min_y, max_x, max_y) or a (multi)polygon geometry, a count of points to generate, and optionally a seed for the random number generator.
+
+		The points are generated in parallel. Given the same seed, the same points are generated in the same order, regardless of the number of threads.
+		Points inside a polygon are distributed uniformly over its area (holes excluded), the polygon is expected to be valid.
+	)";
+	static constexpr auto EXAMPLE = R"(
+		SELECT * FROM ST_GeneratePoints({min_x: 0, min_y:0, max_x:10, max_y:10}::BOX_2D, 5, 42);
 
-		Takes a bounding box (min_x, min_y, max_x, max_y), a count of points to generate, and optionally a seed for the random number generator.
+		SELECT * FROM ST_GeneratePoints(ST_GeomFromText('POLYGON((0 0, 10 0, 0 10, 0 0))'), 5, 42);
 	)";
-	static constexpr auto EXAMPLE =
-	    "SELECT * FROM ST_GeneratePoints({min_x: 0, min_y:0, max_x:10, max_y:10}::BOX_2D, 5, 42);";
 
 	//------------------------------------------------------------------------------------------------------------------
 	// Register
@@ -124,8 +656,10 @@ struct ST_GeneratePoints {
 		// TODO: Dont overload, make seed named parameter instead
 		TableFunctionSet set("ST_GeneratePoints");
 
-		TableFunction generate_points({GeoTypes::BOX_2D(), LogicalType::BIGINT}, Execute, Bind, Init);
+		TableFunction generate_points({GeoTypes::BOX_2D(), LogicalType::BIGINT}, Execute, Bind, InitGlobal,
+		                              InitLocal);
 		generate_points.cardinality = Cardinality;
+		generate_points.get_partition_data = GetPartitionData;
 
 		// Overload without seed
 		set.AddFunction(generate_points);
@@ -133,6 +667,13 @@ struct ST_GeneratePoints {
 		// Overload with seed
 		generate_points.arguments = {GeoTypes::BOX_2D(), LogicalType::BIGINT, LogicalType::BIGINT};
 		set.AddFunction(generate_points);
+
+		// Overloads inside a polygon
+		generate_points.arguments = {GeoTypes::GEOMETRY(), LogicalType::BIGINT};
+		set.AddFunction(generate_points);
+		generate_points.arguments = {GeoTypes::GEOMETRY(), LogicalType::BIGINT, LogicalType::BIGINT};
+		set.AddFunction(generate_points);
+
 		ExtensionUtil::RegisterFunction(db, set);
 
 		InsertionOrderPreservingMap<string> tags;
@@ -141,13 +682,242 @@ struct ST_GeneratePoints {
 	}
 };
 
+//======================================================================================================================
+// ST_SpatialCluster
+//======================================================================================================================
+// Returns the rows of a table sorted along a space filling curve over the extent of the table. Writing the result
+// (with CREATE TABLE AS or COPY) clusters the rows in space, so that the row groups (and their zone maps) cover small
+// areas. The function expands into a query, so that the extent is computed by the (parallel) ST_Extent_Agg aggregate
+// and the rows are ordered by the (parallel) sort.
+
+struct ST_SpatialCluster {
+
+	static unique_ptr<TableRef> BindReplace(ClientContext &context, TableFunctionBindInput &input) {
+		const auto &source = StringValue::Get(input.inputs[0]);
+
+		string geom_column = "geom";
+		string curve = "hilbert";
+
+		for (auto &param : input.named_parameters) {
+			if (param.second.IsNull()) {
+				throw InvalidInputException("ST_SpatialCluster: '%s' must not be NULL", param.first);
+			}
+			if (param.first == "geom_column") {
+				geom_column = StringValue::Get(param.second);
+			} else if (param.first == "curve") {
+				curve = StringUtil::Lower(StringValue::Get(param.second));
+			}
+		}
+
+		const char *curve_function;
+		if (curve == "hilbert") {
+			curve_function = "ST_Hilbert64";
+		} else if (curve == "morton") {
+			curve_function = "ST_Morton64";
+		} else {
+			throw InvalidInputException("ST_SpatialCluster: unknown curve '%s', expected 'hilbert' or 'morton'", curve);
+		}
+
+		const auto geom = KeywordHelper::WriteOptionallyQuoted(geom_column);
+		const auto table = KeywordHelper::WriteQuoted(source, '\'');
+
+		// The extent is an uncorrelated subquery, so it is only computed once
+		const auto query = StringUtil::Format(
+		    "SELECT * FROM query_table(%s) "
+		    "ORDER BY %s(%s, (SELECT ST_Extent(ST_Extent_Agg(%s)) FROM query_table(%s)))",
+		    table, curve_function, geom, geom, table);
+
+		Parser parser(context.GetParserOptions());
+		parser.ParseQuery(query);
+		D_ASSERT(parser.statements.size() == 1 && parser.statements[0]->type == StatementType::SELECT_STATEMENT);
+
+		auto select = unique_ptr_cast<SQLStatement, SelectStatement>(std::move(parser.statements[0]));
+		return make_uniq<SubqueryRef>(std::move(select));
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Returns the rows of a table ordered along a space filling curve, to cluster them in space.
+
+		Takes the name of a table (or view) and sorts its rows by the 64-bit curve index ([ST_Hilbert64](#st_hilbert64)
+		or [ST_Morton64](#st_morton64)) of their geometry, over the extent of the whole table. Creating a table from (or
+		exporting) the result stores nearby geometries in the same row groups, which makes the row group statistics and
+		an RTREE index on the table much more selective. Rows with a NULL or empty geometry come last.
+
+		The following named parameters are supported:
+		- `geom_column`: the name of the geometry column, `'geom'` by default
+		- `curve`: the curve to sort by, either `'hilbert'` (the default) or `'morton'`
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		CREATE TABLE roads_clustered AS SELECT * FROM ST_SpatialCluster('roads');
+
+		COPY (SELECT * FROM ST_SpatialCluster('roads', curve := 'morton')) TO 'roads.parquet';
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		TableFunction func("ST_SpatialCluster", {LogicalType::VARCHAR}, nullptr, nullptr);
+		func.bind_replace = BindReplace;
+		func.named_parameters["geom_column"] = LogicalType::VARCHAR;
+		func.named_parameters["curve"] = LogicalType::VARCHAR;
+		ExtensionUtil::RegisterFunction(db, func);
+
+		InsertionOrderPreservingMap<string> tags;
+		tags.insert("ext", "spatial");
+		FunctionBuilder::AddTableFunctionDocs(db, "ST_SpatialCluster", DESCRIPTION, EXAMPLE, tags);
+	}
+};
+
+//======================================================================================================================
+// ST_Overlay
+//======================================================================================================================
+// Intersects two polygon layers, returning the pieces where a polygon of the left table overlaps a polygon of the right
+// table together with the attributes of both. The function expands into a query, so that the candidate pairs are found
+// by the (parallel) spatial join with its R-tree, and the pieces are streamed out of it as they are computed. Join
+// results repeat the geometry of one side for all of its candidates, which ST_Intersection only deserializes once per
+// chunk. Each candidate pair takes a single intersection, pairs that only touch leave an empty piece which is dropped.
+
+struct ST_Overlay {
+
+	//! Get the names of the columns of a table or view
+	static vector<string> GetColumnNames(ClientContext &context, const string &source) {
+		Parser parser(context.GetParserOptions());
+		parser.ParseQuery(StringUtil::Format("SELECT * FROM query_table(%s)", KeywordHelper::WriteQuoted(source, '\'')));
+		auto binder = Binder::CreateBinder(context);
+		return binder->Bind(*parser.statements[0]).names;
+	}
+
+	//! Select the columns of one side, except for its geometry. Columns whose name also occurs on the other side (or
+	//! is the name of the result geometry) are prefixed with the side, so that the result has unique column names.
+	static void AddColumns(vector<string> &select_list, const string &alias, const string &prefix,
+	                       const vector<string> &names, const string &geom_column, const vector<string> &other_names,
+	                       const string &other_geom_column) {
+		case_insensitive_set_t taken = {"geom"};
+		for (auto &name : other_names) {
+			if (!StringUtil::CIEquals(name, other_geom_column)) {
+				taken.insert(name);
+			}
+		}
+		for (auto &name : names) {
+			if (StringUtil::CIEquals(name, geom_column)) {
+				continue;
+			}
+			const auto column = alias + "." + KeywordHelper::WriteOptionallyQuoted(name);
+			if (taken.find(name) == taken.end()) {
+				select_list.push_back(column);
+			} else {
+				select_list.push_back(column + " AS " + KeywordHelper::WriteOptionallyQuoted(prefix + name));
+			}
+		}
+	}
+
+	static unique_ptr<TableRef> BindReplace(ClientContext &context, TableFunctionBindInput &input) {
+		const auto &left_source = StringValue::Get(input.inputs[0]);
+		const auto &right_source = StringValue::Get(input.inputs[1]);
+
+		string left_geom_column = "geom";
+		string right_geom_column = "geom";
+
+		for (auto &param : input.named_parameters) {
+			if (param.second.IsNull()) {
+				throw InvalidInputException("ST_Overlay: '%s' must not be NULL", param.first);
+			}
+			if (param.first == "left_geom_column") {
+				left_geom_column = StringValue::Get(param.second);
+			} else if (param.first == "right_geom_column") {
+				right_geom_column = StringValue::Get(param.second);
+			}
+		}
+
+		const auto left_names = GetColumnNames(context, left_source);
+		const auto right_names = GetColumnNames(context, right_source);
+
+		vector<string> select_list;
+		AddColumns(select_list, "l", "left_", left_names, left_geom_column, right_names, right_geom_column);
+		AddColumns(select_list, "r", "right_", right_names, right_geom_column, left_names, left_geom_column);
+
+		const auto left_geom = KeywordHelper::WriteOptionallyQuoted(left_geom_column);
+		const auto right_geom = KeywordHelper::WriteOptionallyQuoted(right_geom_column);
+		const auto left_table = KeywordHelper::WriteQuoted(left_source, '\'');
+		const auto right_table = KeywordHelper::WriteQuoted(right_source, '\'');
+
+		// Only the polygonal part of the intersection belongs to the overlay. Polygons that only touch intersect in
+		// points or lines, which leaves nothing.
+		select_list.push_back(StringUtil::Format("ST_CollectionExtract(ST_Intersection(l.%s, r.%s), 3) AS geom",
+		                                         left_geom, right_geom));
+		const auto query = StringUtil::Format(
+		    "SELECT * FROM (SELECT %s FROM query_table(%s) AS l JOIN query_table(%s) AS r ON ST_Intersects(l.%s, r.%s)) "
+		    "WHERE NOT ST_IsEmpty(geom)",
+		    StringUtil::Join(select_list, ", "), left_table, right_table, left_geom, right_geom);
+
+		Parser parser(context.GetParserOptions());
+		parser.ParseQuery(query);
+		D_ASSERT(parser.statements.size() == 1 && parser.statements[0]->type == StatementType::SELECT_STATEMENT);
+
+		auto select = unique_ptr_cast<SQLStatement, SelectStatement>(std::move(parser.statements[0]));
+		return make_uniq<SubqueryRef>(std::move(select));
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Returns the overlay (intersection) of two polygon layers.
+
+		Takes the names of two tables (or views) and returns a row for every pair of a left and a right polygon whose
+		interiors overlap, with all columns of the left row, all columns of the right row and the polygonal
+		intersection of the two geometries as `geom`. The geometry columns of the inputs are not part of the result.
+		Columns that occur on both sides, or that are called `geom`, are prefixed with `left_` or `right_`.
+
+		The pairs are found by a spatial join, so the overlay runs in parallel and streams its result. Pairs that only
+		touch along their boundaries are skipped, and points or lines where the polygons touch besides overlapping are
+		removed from the pieces.
+
+		The following named parameters are supported:
+		- `left_geom_column`: the name of the geometry column of the left table, `'geom'` by default
+		- `right_geom_column`: the name of the geometry column of the right table, `'geom'` by default
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		CREATE TABLE landuse_by_zone AS SELECT * FROM ST_Overlay('landuse', 'zones');
+
+		SELECT zone_id, landuse_class, sum(ST_Area(geom)) AS area
+		FROM ST_Overlay('landuse', 'zones', right_geom_column := 'boundary')
+		GROUP BY ALL;
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		TableFunction func("ST_Overlay", {LogicalType::VARCHAR, LogicalType::VARCHAR}, nullptr, nullptr);
+		func.bind_replace = BindReplace;
+		func.named_parameters["left_geom_column"] = LogicalType::VARCHAR;
+		func.named_parameters["right_geom_column"] = LogicalType::VARCHAR;
+		ExtensionUtil::RegisterFunction(db, func);
+
+		InsertionOrderPreservingMap<string> tags;
+		tags.insert("ext", "spatial");
+		FunctionBuilder::AddTableFunctionDocs(db, "ST_Overlay", DESCRIPTION, EXAMPLE, tags);
+	}
+};
+
 } // namespace
 
 //######################################################################################################################
 // Register
 //######################################################################################################################
 void RegisterSpatialTableFunctions(DatabaseInstance &db) {
+	ST_DumpParts::Register(db);
+	ST_DumpPoints::Register(db);
 	ST_GeneratePoints::Register(db);
+	ST_SpatialCluster::Register(db);
+	ST_Overlay::Register(db);
 }
 
 } // namespace duckdb
\ No newline at end of file
@@ -0,0 +1,1856 @@
+#include "spatial/modules/mvt/mvt_module.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/spatial_types.hpp"
+#include "spatial/util/function_builder.hpp"
+#include "spatial/util/scratch_pool.hpp"
+
+#include "duckdb/common/vector_operations/ternary_executor.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/statement/select_statement.hpp"
+#include "duckdb/parser/tableref/subqueryref.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+
+namespace duckdb {
+
+namespace {
+
+constexpr int32_t MVT_DEFAULT_EXTENT = 4096;
+constexpr int32_t MVT_DEFAULT_BUFFER = 256;
+
+// Half the width of the web mercator world
+constexpr double MVT_WEB_MERCATOR_ORIGIN = 20037508.342789244;
+constexpr int32_t MVT_MAX_ZOOM = 30;
+// The most tiles a single geometry can be assigned to
+constexpr idx_t MVT_MAX_TILE_COVER = 1 << 24;
+
+//######################################################################################################################
+// Local State
+//######################################################################################################################
+
+class MVTLocalState final : public FunctionLocalState {
+public:
+	explicit MVTLocalState(ClientContext &context)
+	    : pool(GeometryScratchPool::Get(context)), arena(pool->GetAllocator()) {
+	}
+
+	static unique_ptr<FunctionLocalState> Init(ExpressionState &state, const BoundFunctionExpression &expr,
+	                                           FunctionData *bind_data) {
+		return make_uniq_base<FunctionLocalState, MVTLocalState>(state.GetContext());
+	}
+
+	static MVTLocalState &ResetAndGet(ExpressionState &state) {
+		auto &local_state = ExecuteFunctionState::GetFunctionState(state)->Cast<MVTLocalState>();
+		GeometryScratchPool::Reset(local_state.arena);
+		return local_state;
+	}
+
+	ArenaAllocator &GetArena() {
+		return arena;
+	}
+
+private:
+	shared_ptr<GeometryScratchPool> pool;
+	ArenaAllocator arena;
+};
+
+//######################################################################################################################
+// Tile Geometry
+//######################################################################################################################
+//
+// Geometries are transformed into the integer grid of a tile, with the origin in the top left corner and the y axis
+// pointing down. Every vertex is snapped to the grid, and buffered clipping is done in tile space, so that all
+// remaining vertices are integers. Parts that collapse when snapped (e.g. lines shorter than a grid cell, or rings
+// without area) are dropped.
+//
+
+using TileVertex = sgl::vertex_xy;
+using TileRing = vector<TileVertex>;
+
+struct TileTransform {
+	double min_x;
+	double max_y;
+	double scale_x;
+	double scale_y;
+
+	// The clip box, the same on both axes
+	double clip_min;
+	double clip_max;
+	bool clip;
+
+	TileTransform(const sgl::box_xy &bounds, int32_t extent, int32_t buffer, bool clip_p) : clip(clip_p) {
+		const auto width = bounds.max.x - bounds.min.x;
+		const auto height = bounds.max.y - bounds.min.y;
+		if (!(width > 0) || !(height > 0)) {
+			throw InvalidInputException("ST_AsMVTGeom: the bounds must have a positive width and height");
+		}
+		if (extent <= 0) {
+			throw InvalidInputException("ST_AsMVTGeom: the extent must be positive");
+		}
+		if (buffer < 0) {
+			throw InvalidInputException("ST_AsMVTGeom: the buffer must not be negative");
+		}
+		min_x = bounds.min.x;
+		max_y = bounds.max.y;
+		scale_x = extent / width;
+		scale_y = extent / height;
+		clip_min = -static_cast<double>(buffer);
+		clip_max = static_cast<double>(extent) + buffer;
+	}
+
+	TileVertex Apply(const TileVertex &vertex) const {
+		return {std::round((vertex.x - min_x) * scale_x), std::round((max_y - vertex.y) * scale_y)};
+	}
+
+	bool Contains(const TileVertex &vertex) const {
+		return vertex.x >= clip_min && vertex.x <= clip_max && vertex.y >= clip_min && vertex.y <= clip_max;
+	}
+};
+
+// Twice the signed area of a closed ring, positive if the ring is clockwise in tile space (y pointing down)
+double GetSignedArea(const TileRing &ring) {
+	double area = 0;
+	for (idx_t i = 0; i + 1 < ring.size(); i++) {
+		area += ring[i].x * ring[i + 1].y - ring[i + 1].x * ring[i].y;
+	}
+	return area;
+}
+
+class TileGeometry {
+public:
+	void Clear() {
+		points.clear();
+		lines.clear();
+		polygons.clear();
+	}
+
+	void Add(const sgl::geometry &geom, const TileTransform &transform) {
+		switch (geom.get_type()) {
+		case sgl::geometry_type::POINT:
+			AddPoint(geom, transform);
+			break;
+		case sgl::geometry_type::LINESTRING:
+			AddLine(geom, transform);
+			break;
+		case sgl::geometry_type::POLYGON:
+			AddPolygon(geom, transform);
+			break;
+		case sgl::geometry_type::MULTI_POINT:
+		case sgl::geometry_type::MULTI_LINESTRING:
+		case sgl::geometry_type::MULTI_POLYGON:
+		case sgl::geometry_type::MULTI_GEOMETRY: {
+			const auto tail = geom.get_last_part();
+			auto part = tail;
+			if (part) {
+				do {
+					part = part->get_next();
+					Add(*part, transform);
+				} while (part != tail);
+			}
+		} break;
+		default:
+			throw InvalidInputException("ST_AsMVTGeom: unsupported geometry type");
+		}
+	}
+
+	// Build the tile geometry. Vector tiles cant mix geometry types within a feature, so only the parts of the highest
+	// dimension are kept (as in a collection). Returns false if nothing is left.
+	bool TryBuild(ArenaAllocator &arena, sgl::geometry &result) const {
+		if (!polygons.empty()) {
+			if (polygons.size() == 1) {
+				result.set_type(sgl::geometry_type::POLYGON);
+				AppendRings(result, polygons[0], arena);
+				return true;
+			}
+			result.set_type(sgl::geometry_type::MULTI_POLYGON);
+			for (const auto &polygon : polygons) {
+				const auto part = MakePart(sgl::geometry_type::POLYGON, arena);
+				AppendRings(*part, polygon, arena);
+				result.append_part(part);
+			}
+			return true;
+		}
+		if (!lines.empty()) {
+			if (lines.size() == 1) {
+				result.set_type(sgl::geometry_type::LINESTRING);
+				SetVertices(result, lines[0], arena);
+				return true;
+			}
+			result.set_type(sgl::geometry_type::MULTI_LINESTRING);
+			for (const auto &line : lines) {
+				const auto part = MakePart(sgl::geometry_type::LINESTRING, arena);
+				SetVertices(*part, line, arena);
+				result.append_part(part);
+			}
+			return true;
+		}
+		if (!points.empty()) {
+			if (points.size() == 1) {
+				result.set_type(sgl::geometry_type::POINT);
+				SetVertices(result, points, arena);
+				return true;
+			}
+			result.set_type(sgl::geometry_type::MULTI_POINT);
+			for (const auto &point : points) {
+				const auto part = MakePart(sgl::geometry_type::POINT, arena);
+				SetVertices(*part, TileRing {point}, arena);
+				result.append_part(part);
+			}
+			return true;
+		}
+		return false;
+	}
+
+private:
+	// Transform and snap the vertices of a part, skipping repeated vertices
+	void Transform(const sgl::geometry &geom, const TileTransform &transform, TileRing &result) const {
+		result.clear();
+		for (uint32_t i = 0; i < geom.get_count(); i++) {
+			const auto vertex = transform.Apply(geom.get_vertex_xy(i));
+			if (result.empty() || !(result.back() == vertex)) {
+				result.push_back(vertex);
+			}
+		}
+	}
+
+	void AddPoint(const sgl::geometry &geom, const TileTransform &transform) {
+		if (geom.is_empty()) {
+			return;
+		}
+		const auto vertex = transform.Apply(geom.get_vertex_xy(0));
+		if (!transform.clip || transform.Contains(vertex)) {
+			points.push_back(vertex);
+		}
+	}
+
+	void AddLine(const sgl::geometry &geom, const TileTransform &transform) {
+		Transform(geom, transform, vertices);
+		if (vertices.size() < 2) {
+			return;
+		}
+		if (!transform.clip) {
+			lines.push_back(vertices);
+			return;
+		}
+		ClipLine(vertices, transform);
+	}
+
+	void AddPolygon(const sgl::geometry &geom, const TileTransform &transform) {
+		vector<TileRing> rings;
+
+		const auto tail = geom.get_last_part();
+		auto ring = tail;
+		if (!ring) {
+			return;
+		}
+		do {
+			ring = ring->get_next();
+			Transform(*ring, transform, vertices);
+			if (transform.clip) {
+				ClipRing(vertices, transform);
+			}
+
+			// Close the ring, and drop it if it has no area left
+			if (vertices.size() > 1 && vertices.front() == vertices.back()) {
+				vertices.pop_back();
+			}
+			const auto is_shell = ring == geom.get_first_part();
+			if (vertices.size() < 3) {
+				if (is_shell) {
+					// Without a shell, there is no polygon
+					return;
+				}
+				continue;
+			}
+			vertices.push_back(vertices.front());
+
+			const auto area = GetSignedArea(vertices);
+			if (area == 0) {
+				if (is_shell) {
+					return;
+				}
+				continue;
+			}
+
+			// The shell has to be clockwise, and the holes counter clockwise
+			if ((area > 0) != is_shell) {
+				std::reverse(vertices.begin(), vertices.end());
+			}
+			rings.push_back(vertices);
+		} while (ring != tail);
+
+		polygons.push_back(std::move(rings));
+	}
+
+	// Clip the segment to the clip box (Liang-Barsky), returns false if it is completely outside
+	static bool ClipSegment(const TileTransform &transform, TileVertex &a, TileVertex &b) {
+		const auto dx = b.x - a.x;
+		const auto dy = b.y - a.y;
+		const double p[4] = {-dx, dx, -dy, dy};
+		const double q[4] = {a.x - transform.clip_min, transform.clip_max - a.x, a.y - transform.clip_min,
+		                     transform.clip_max - a.y};
+
+		double t0 = 0;
+		double t1 = 1;
+		for (idx_t i = 0; i < 4; i++) {
+			if (p[i] == 0) {
+				if (q[i] < 0) {
+					return false;
+				}
+				continue;
+			}
+			const auto t = q[i] / p[i];
+			if (p[i] < 0) {
+				if (t > t1) {
+					return false;
+				}
+				t0 = MaxValue(t0, t);
+			} else {
+				if (t < t0) {
+					return false;
+				}
+				t1 = MinValue(t1, t);
+			}
+		}
+
+		const auto start = a;
+		if (t0 > 0) {
+			a = {std::round(start.x + t0 * dx), std::round(start.y + t0 * dy)};
+		}
+		if (t1 < 1) {
+			b = {std::round(start.x + t1 * dx), std::round(start.y + t1 * dy)};
+		}
+		return true;
+	}
+
+	// Clip a line, which is split into multiple lines wherever it leaves the clip box
+	void ClipLine(const TileRing &line, const TileTransform &transform) {
+		TileRing current;
+		const auto flush = [&]() {
+			if (current.size() > 1) {
+				lines.push_back(current);
+			}
+			current.clear();
+		};
+
+		for (idx_t i = 1; i < line.size(); i++) {
+			auto a = line[i - 1];
+			auto b = line[i];
+			if (!ClipSegment(transform, a, b)) {
+				flush();
+				continue;
+			}
+			if (!current.empty() && !(current.back() == a)) {
+				// The line entered the clip box again
+				flush();
+			}
+			if (current.empty()) {
+				current.push_back(a);
+			}
+			if (!(current.back() == b)) {
+				current.push_back(b);
+			}
+			if (!(b == line[i])) {
+				// The line left the clip box
+				flush();
+			}
+		}
+		flush();
+	}
+
+	// Clip a ring to the clip box (Sutherland-Hodgman). The result is not closed, and may have edges running along the
+	// border of the clip box, which is fine for rendering.
+	void ClipRing(TileRing &ring, const TileTransform &transform) {
+		// Skip rings that are completely inside
+		bool is_inside = true;
+		for (const auto &vertex : ring) {
+			if (!transform.Contains(vertex)) {
+				is_inside = false;
+				break;
+			}
+		}
+		if (is_inside) {
+			return;
+		}
+
+		if (ring.size() > 1 && ring.front() == ring.back()) {
+			ring.pop_back();
+		}
+
+		const auto lo = transform.clip_min;
+		const auto hi = transform.clip_max;
+
+		for (idx_t edge = 0; edge < 4 && !ring.empty(); edge++) {
+			const auto inside = [&](const TileVertex &v) {
+				switch (edge) {
+				case 0:
+					return v.x >= lo;
+				case 1:
+					return v.x <= hi;
+				case 2:
+					return v.y >= lo;
+				default:
+					return v.y <= hi;
+				}
+			};
+			const auto intersect = [&](const TileVertex &a, const TileVertex &b) {
+				const auto bound = edge == 0 || edge == 2 ? lo : hi;
+				if (edge < 2) {
+					const auto t = (bound - a.x) / (b.x - a.x);
+					return TileVertex {bound, std::round(a.y + t * (b.y - a.y))};
+				}
+				const auto t = (bound - a.y) / (b.y - a.y);
+				return TileVertex {std::round(a.x + t * (b.x - a.x)), bound};
+			};
+
+			clipped.clear();
+			for (idx_t i = 0; i < ring.size(); i++) {
+				const auto &prev = ring[i == 0 ? ring.size() - 1 : i - 1];
+				const auto &curr = ring[i];
+				const auto prev_inside = inside(prev);
+				const auto curr_inside = inside(curr);
+				if (curr_inside != prev_inside) {
+					const auto vertex = intersect(prev, curr);
+					if (clipped.empty() || !(clipped.back() == vertex)) {
+						clipped.push_back(vertex);
+					}
+				}
+				if (curr_inside && (clipped.empty() || !(clipped.back() == curr))) {
+					clipped.push_back(curr);
+				}
+			}
+			std::swap(ring, clipped);
+		}
+	}
+
+	static sgl::geometry *MakePart(sgl::geometry_type type, ArenaAllocator &arena) {
+		const auto part_mem = arena.AllocateAligned(sizeof(sgl::geometry));
+		return new (part_mem) sgl::geometry(type, false, false);
+	}
+
+	static void SetVertices(sgl::geometry &geom, const TileRing &vertices, ArenaAllocator &arena) {
+		const auto size = vertices.size() * sizeof(TileVertex);
+		const auto data = arena.AllocateAligned(size);
+		memcpy(data, vertices.data(), size);
+		geom.set_vertex_data(data, static_cast<uint32_t>(vertices.size()));
+	}
+
+	static void AppendRings(sgl::geometry &polygon, const vector<TileRing> &rings, ArenaAllocator &arena) {
+		for (const auto &ring : rings) {
+			const auto part = MakePart(sgl::geometry_type::LINESTRING, arena);
+			SetVertices(*part, ring, arena);
+			polygon.append_part(part);
+		}
+	}
+
+	TileRing points;
+	vector<TileRing> lines;
+	vector<vector<TileRing>> polygons;
+
+	// Scratch buffers
+	TileRing vertices;
+	TileRing clipped;
+};
+
+//######################################################################################################################
+// Protobuf Encoding
+//######################################################################################################################
+
+enum class WireType : uint8_t { VARINT = 0, I64 = 1, LEN = 2, I32 = 5 };
+
+class ProtobufWriter {
+public:
+	void WriteVarint(uint64_t value) {
+		while (value >= 0x80) {
+			buffer.push_back(static_cast<data_t>(value | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back(static_cast<data_t>(value));
+	}
+
+	void WriteTag(uint32_t field, WireType type) {
+		WriteVarint((static_cast<uint64_t>(field) << 3) | static_cast<uint8_t>(type));
+	}
+
+	void WriteVarintField(uint32_t field, uint64_t value) {
+		WriteTag(field, WireType::VARINT);
+		WriteVarint(value);
+	}
+
+	void WriteBytesField(uint32_t field, const_data_ptr_t data, idx_t size) {
+		WriteTag(field, WireType::LEN);
+		WriteVarint(size);
+		buffer.insert(buffer.end(), data, data + size);
+	}
+
+	void WriteBytesField(uint32_t field, const ProtobufWriter &message) {
+		WriteBytesField(field, message.GetData(), message.GetSize());
+	}
+
+	void WriteStringField(uint32_t field, const string &value) {
+		WriteBytesField(field, const_data_ptr_cast(value.data()), value.size());
+	}
+
+	template <class T>
+	void WriteFixedField(uint32_t field, T value) {
+		static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Fixed fields are 32 or 64 bits");
+		WriteTag(field, sizeof(T) == 4 ? WireType::I32 : WireType::I64);
+		data_t bytes[sizeof(T)];
+		Store<T>(value, bytes);
+		buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+	}
+
+	// A packed repeated field of varints
+	void WritePackedField(uint32_t field, const uint32_t *values, idx_t count) {
+		idx_t size = 0;
+		for (idx_t i = 0; i < count; i++) {
+			size += GetVarintSize(values[i]);
+		}
+		WriteTag(field, WireType::LEN);
+		WriteVarint(size);
+		for (idx_t i = 0; i < count; i++) {
+			WriteVarint(values[i]);
+		}
+	}
+
+	const_data_ptr_t GetData() const {
+		return buffer.data();
+	}
+	idx_t GetSize() const {
+		return buffer.size();
+	}
+	void Clear() {
+		buffer.clear();
+	}
+
+	static idx_t GetVarintSize(uint64_t value) {
+		idx_t size = 1;
+		while (value >= 0x80) {
+			value >>= 7;
+			size++;
+		}
+		return size;
+	}
+
+	static uint64_t ZigZag(int64_t value) {
+		return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+	}
+
+private:
+	vector<data_t> buffer;
+};
+
+//######################################################################################################################
+// Vector Tile Encoding
+//######################################################################################################################
+//
+// See https://github.com/mapbox/vector-tile-spec/tree/master/2.1 for the format. A tile holds layers, which hold
+// features, which hold a geometry (as a sequence of drawing commands) and tags referencing the keys and values of
+// the layer.
+//
+
+enum class MVTGeometryType : uint8_t { UNKNOWN = 0, POINT = 1, LINESTRING = 2, POLYGON = 3 };
+
+// The Tile, Layer, Feature and Value message fields
+enum MVTField : uint32_t {
+	TILE_LAYERS = 3,
+
+	LAYER_NAME = 1,
+	LAYER_FEATURES = 2,
+	LAYER_KEYS = 3,
+	LAYER_VALUES = 4,
+	LAYER_EXTENT = 5,
+	LAYER_VERSION = 15,
+
+	FEATURE_ID = 1,
+	FEATURE_TAGS = 2,
+	FEATURE_TYPE = 3,
+	FEATURE_GEOMETRY = 4,
+
+	VALUE_STRING = 1,
+	VALUE_FLOAT = 2,
+	VALUE_DOUBLE = 3,
+	VALUE_UINT = 5,
+	VALUE_SINT = 6,
+	VALUE_BOOL = 7,
+};
+
+// Encodes a geometry into drawing commands in a single pass over its vertices. Each command is followed by the zig-zag
+// encoded deltas of its vertices to the previous vertex, and the count of a command is patched in once known.
+class MVTGeometryEncoder {
+public:
+	// Returns the type of the encoded geometry, or UNKNOWN if nothing was left to encode
+	MVTGeometryType Encode(const sgl::geometry &geom, vector<uint32_t> &commands_p) {
+		commands = &commands_p;
+		cursor_x = 0;
+		cursor_y = 0;
+
+		const auto start = commands->size();
+		MVTGeometryType type;
+		switch (geom.get_type()) {
+		case sgl::geometry_type::POINT:
+		case sgl::geometry_type::MULTI_POINT:
+			EncodePoints(geom);
+			type = MVTGeometryType::POINT;
+			break;
+		case sgl::geometry_type::LINESTRING:
+			EncodeLine(geom, false);
+			type = MVTGeometryType::LINESTRING;
+			break;
+		case sgl::geometry_type::POLYGON:
+			EncodePolygon(geom);
+			type = MVTGeometryType::POLYGON;
+			break;
+		case sgl::geometry_type::MULTI_LINESTRING:
+		case sgl::geometry_type::MULTI_POLYGON: {
+			const auto is_polygon = geom.get_type() == sgl::geometry_type::MULTI_POLYGON;
+			const auto tail = geom.get_last_part();
+			auto part = tail;
+			if (part) {
+				do {
+					part = part->get_next();
+					if (is_polygon) {
+						EncodePolygon(*part);
+					} else {
+						EncodeLine(*part, false);
+					}
+				} while (part != tail);
+			}
+			type = is_polygon ? MVTGeometryType::POLYGON : MVTGeometryType::LINESTRING;
+		} break;
+		default:
+			throw InvalidInputException(
+			    "ST_AsMVT: geometry collections can not be encoded, use ST_AsMVTGeom to convert them first");
+		}
+		return commands->size() == start ? MVTGeometryType::UNKNOWN : type;
+	}
+
+private:
+	static constexpr uint32_t MOVE_TO = 1;
+	static constexpr uint32_t LINE_TO = 2;
+	static constexpr uint32_t CLOSE_PATH = 7;
+
+	static uint32_t Command(uint32_t id, idx_t count) {
+		return id | static_cast<uint32_t>(count << 3);
+	}
+
+	// Get the vertex as integer tile coordinates, returns false if it is the same as the previous vertex
+	bool GetDelta(const sgl::geometry &geom, uint32_t vertex_idx, int64_t &dx, int64_t &dy) const {
+		const auto vertex = geom.get_vertex_xy(vertex_idx);
+		const auto x = std::round(vertex.x);
+		const auto y = std::round(vertex.y);
+		// Keep the coordinates within what the (32 bit) deltas can represent
+		constexpr auto limit = static_cast<double>(1 << 30);
+		if (!(x > -limit && x < limit && y > -limit && y < limit)) {
+			throw InvalidInputException(
+			    "ST_AsMVT: geometry coordinates are out of range, use ST_AsMVTGeom to transform them into tile space");
+		}
+		dx = static_cast<int64_t>(x) - cursor_x;
+		dy = static_cast<int64_t>(y) - cursor_y;
+		return dx != 0 || dy != 0;
+	}
+
+	void Emit(int64_t dx, int64_t dy) {
+		commands->push_back(static_cast<uint32_t>(ProtobufWriter::ZigZag(dx)));
+		commands->push_back(static_cast<uint32_t>(ProtobufWriter::ZigZag(dy)));
+		cursor_x += dx;
+		cursor_y += dy;
+	}
+
+	void EncodePoints(const sgl::geometry &geom) {
+		const auto header = commands->size();
+		commands->push_back(0);
+
+		idx_t count = 0;
+		if (geom.get_type() == sgl::geometry_type::POINT) {
+			if (!geom.is_empty()) {
+				int64_t dx, dy;
+				GetDelta(geom, 0, dx, dy);
+				Emit(dx, dy);
+				count++;
+			}
+		} else {
+			const auto tail = geom.get_last_part();
+			auto part = tail;
+			if (part) {
+				do {
+					part = part->get_next();
+					if (!part->is_empty()) {
+						int64_t dx, dy;
+						GetDelta(*part, 0, dx, dy);
+						Emit(dx, dy);
+						count++;
+					}
+				} while (part != tail);
+			}
+		}
+
+		if (count == 0) {
+			commands->pop_back();
+			return;
+		}
+		(*commands)[header] = Command(MOVE_TO, count);
+	}
+
+	// Encode a line or a ring, returns false (emitting nothing) if it collapses
+	bool EncodeLine(const sgl::geometry &geom, bool is_ring) {
+		// Rings are closed by a command instead of their last vertex
+		const auto vertex_count = geom.get_count();
+		const auto end = is_ring ? vertex_count - 1 : vertex_count;
+		if (vertex_count < (is_ring ? 4U : 2U)) {
+			return false;
+		}
+
+		const auto start = commands->size();
+		const auto start_x = cursor_x;
+		const auto start_y = cursor_y;
+
+		int64_t dx, dy;
+		GetDelta(geom, 0, dx, dy);
+		commands->push_back(Command(MOVE_TO, 1));
+		Emit(dx, dy);
+
+		const auto header = commands->size();
+		commands->push_back(0);
+		idx_t count = 0;
+		for (uint32_t i = 1; i < end; i++) {
+			if (GetDelta(geom, i, dx, dy)) {
+				Emit(dx, dy);
+				count++;
+			}
+		}
+
+		if (count < (is_ring ? 2U : 1U)) {
+			// Nothing left, undo
+			commands->resize(start);
+			cursor_x = start_x;
+			cursor_y = start_y;
+			return false;
+		}
+		(*commands)[header] = Command(LINE_TO, count);
+		if (is_ring) {
+			commands->push_back(Command(CLOSE_PATH, 1));
+		}
+		return true;
+	}
+
+	void EncodePolygon(const sgl::geometry &geom) {
+		const auto tail = geom.get_last_part();
+		auto ring = tail;
+		if (!ring) {
+			return;
+		}
+		do {
+			ring = ring->get_next();
+			if (!EncodeLine(*ring, true) && ring == geom.get_first_part()) {
+				// Without a shell, the holes are meaningless
+				return;
+			}
+		} while (ring != tail);
+	}
+
+	vector<uint32_t> *commands = nullptr;
+	int64_t cursor_x = 0;
+	int64_t cursor_y = 0;
+};
+
+//######################################################################################################################
+// ST_AsMVTGeom
+//######################################################################################################################
+
+struct ST_AsMVTGeom {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Execute
+	//------------------------------------------------------------------------------------------------------------------
+	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
+		auto &lstate = MVTLocalState::ResetAndGet(state);
+		auto &arena = lstate.GetArena();
+
+		const auto count = args.size();
+		args.Flatten();
+
+		auto &geom_vec = args.data[0];
+		auto &bounds_vec = args.data[1];
+		auto &bounds_children = StructVector::GetEntries(bounds_vec);
+
+		const auto geom_data = FlatVector::GetData<string_t>(geom_vec);
+		const auto min_x_data = FlatVector::GetData<double>(*bounds_children[0]);
+		const auto min_y_data = FlatVector::GetData<double>(*bounds_children[1]);
+		const auto max_x_data = FlatVector::GetData<double>(*bounds_children[2]);
+		const auto max_y_data = FlatVector::GetData<double>(*bounds_children[3]);
+
+		const auto column_count = args.ColumnCount();
+		const auto extent_data = column_count > 2 ? FlatVector::GetData<int32_t>(args.data[2]) : nullptr;
+		const auto buffer_data = column_count > 3 ? FlatVector::GetData<int32_t>(args.data[3]) : nullptr;
+		const auto clip_data = column_count > 4 ? FlatVector::GetData<bool>(args.data[4]) : nullptr;
+
+		const auto result_data = FlatVector::GetData<string_t>(result);
+		auto &result_mask = FlatVector::Validity(result);
+
+		TileGeometry tile;
+
+		for (idx_t row_idx = 0; row_idx < count; row_idx++) {
+			bool is_valid = true;
+			for (idx_t col_idx = 0; col_idx < column_count; col_idx++) {
+				is_valid &= FlatVector::Validity(args.data[col_idx]).RowIsValid(row_idx);
+			}
+			for (const auto &child : bounds_children) {
+				is_valid &= FlatVector::Validity(*child).RowIsValid(row_idx);
+			}
+			if (!is_valid) {
+				result_mask.SetInvalid(row_idx);
+				continue;
+			}
+
+			sgl::box_xy bounds;
+			bounds.min.x = min_x_data[row_idx];
+			bounds.min.y = min_y_data[row_idx];
+			bounds.max.x = max_x_data[row_idx];
+			bounds.max.y = max_y_data[row_idx];
+
+			const auto extent = extent_data ? extent_data[row_idx] : MVT_DEFAULT_EXTENT;
+			const auto buffer = buffer_data ? buffer_data[row_idx] : MVT_DEFAULT_BUFFER;
+			const auto clip = clip_data ? clip_data[row_idx] : true;
+			const TileTransform transform(bounds, extent, buffer, clip);
+
+			const auto &blob = geom_data[row_idx];
+			sgl::geometry geom;
+			Serde::Deserialize(geom, arena, blob.GetDataUnsafe(), blob.GetSize());
+
+			tile.Clear();
+			tile.Add(geom, transform);
+
+			sgl::geometry tile_geom;
+			if (!tile.TryBuild(arena, tile_geom)) {
+				// Nothing is left within the tile
+				result_mask.SetInvalid(row_idx);
+				continue;
+			}
+
+			const auto size = Serde::GetRequiredSize(tile_geom);
+			auto tile_blob = StringVector::EmptyString(result, size);
+			Serde::Serialize(tile_geom, tile_blob.GetDataWriteable(), size);
+			tile_blob.Finalize();
+			result_data[row_idx] = tile_blob;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Transforms a geometry into the coordinate space of a vector tile.
+
+		The geometry is scaled from the `bounds` of the tile into a grid of `extent` by `extent` cells, with the origin
+		in the top left corner and the y axis pointing down, and every vertex is snapped to the grid. If `clip_geom` is
+		true (the default), the geometry is clipped to the tile, expanded by `buffer` cells on every side. Parts that
+		collapse in tile space are removed, and polygon rings are oriented as the vector tile specification requires.
+
+		Returns `NULL` if nothing of the geometry is left within the tile. Geometry collections are reduced to their
+		parts of the highest dimension.
+
+		The result is meant to be encoded into a tile with [ST_AsMVT](#st_asmvt).
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT ST_AsMVTGeom(
+			ST_GeomFromText('POLYGON((0 0, 10 0, 10 10, 0 10, 0 0))'),
+			{'min_x': 0, 'min_y': 0, 'max_x': 10, 'max_y': 10}::BOX_2D,
+			10, 0
+		);
+		----
+		POLYGON ((0 10, 0 0, 10 0, 10 10, 0 10))
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		FunctionBuilder::RegisterScalar(db, "ST_AsMVTGeom", [](ScalarFunctionBuilder &func) {
+			for (idx_t arg_count = 2; arg_count <= 5; arg_count++) {
+				func.AddVariant([&](ScalarFunctionVariantBuilder &variant) {
+					variant.AddParameter("geom", GeoTypes::GEOMETRY());
+					variant.AddParameter("bounds", GeoTypes::BOX_2D());
+					if (arg_count > 2) {
+						variant.AddParameter("extent", LogicalType::INTEGER);
+					}
+					if (arg_count > 3) {
+						variant.AddParameter("buffer", LogicalType::INTEGER);
+					}
+					if (arg_count > 4) {
+						variant.AddParameter("clip_geom", LogicalType::BOOLEAN);
+					}
+					variant.SetReturnType(GeoTypes::GEOMETRY());
+
+					variant.SetInit(MVTLocalState::Init);
+					variant.SetFunction(Execute);
+				});
+			}
+
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "conversion");
+		});
+	}
+};
+
+//######################################################################################################################
+// ST_AsMVT
+//######################################################################################################################
+
+struct ST_AsMVT {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Bind
+	//------------------------------------------------------------------------------------------------------------------
+	struct BindData final : FunctionData {
+		string layer_name = "default";
+		uint32_t extent = MVT_DEFAULT_EXTENT;
+
+		// The fields of the input row holding the geometry, and the (optional) feature id
+		idx_t geometry_field = 0;
+		optional_idx feature_id_field;
+
+		// The fields that become the properties of the features, and their names (the keys of the layer)
+		vector<idx_t> property_fields;
+		vector<string> keys;
+
+		unique_ptr<FunctionData> Copy() const override {
+			auto result = make_uniq<BindData>();
+			result->layer_name = layer_name;
+			result->extent = extent;
+			result->geometry_field = geometry_field;
+			result->feature_id_field = feature_id_field;
+			result->property_fields = property_fields;
+			result->keys = keys;
+			return std::move(result);
+		}
+
+		bool Equals(const FunctionData &other_p) const override {
+			auto &other = other_p.Cast<BindData>();
+			return layer_name == other.layer_name && extent == other.extent && geometry_field == other.geometry_field &&
+			       feature_id_field == other.feature_id_field && property_fields == other.property_fields;
+		}
+	};
+
+	static Value GetConstantArgument(ClientContext &context, Expression &arg, const char *name) {
+		if (arg.HasParameter()) {
+			throw BinderException("ST_AsMVT: parameters are not supported for the %s", name);
+		}
+		if (!arg.IsFoldable()) {
+			throw BinderException("ST_AsMVT: the %s must be a constant", name);
+		}
+		auto value = ExpressionExecutor::EvaluateScalar(context, arg);
+		if (value.IsNull()) {
+			throw BinderException("ST_AsMVT: the %s must not be NULL", name);
+		}
+		return value;
+	}
+
+	static unique_ptr<FunctionData> Bind(ClientContext &context, AggregateFunction &function,
+	                                     vector<unique_ptr<Expression>> &arguments) {
+		auto &row_type = arguments[0]->return_type;
+		if (row_type.id() != LogicalTypeId::STRUCT) {
+			throw BinderException("ST_AsMVT: the first argument must be a row (STRUCT) holding a geometry");
+		}
+
+		auto result = make_uniq<BindData>();
+		if (arguments.size() > 1) {
+			result->layer_name = StringValue::Get(GetConstantArgument(context, *arguments[1], "layer name"));
+		}
+		if (arguments.size() > 2) {
+			const auto extent = IntegerValue::Get(GetConstantArgument(context, *arguments[2], "extent"));
+			if (extent <= 0) {
+				throw BinderException("ST_AsMVT: the extent must be positive");
+			}
+			result->extent = static_cast<uint32_t>(extent);
+		}
+		string geometry_name;
+		if (arguments.size() > 3) {
+			geometry_name = StringValue::Get(GetConstantArgument(context, *arguments[3], "geometry column name"));
+		}
+		string feature_id_name;
+		if (arguments.size() > 4) {
+			feature_id_name = StringValue::Get(GetConstantArgument(context, *arguments[4], "feature id column name"));
+		}
+
+		// Find the geometry, by default the first geometry field
+		const auto &fields = StructType::GetChildTypes(row_type);
+		optional_idx geometry_field;
+		for (idx_t field_idx = 0; field_idx < fields.size(); field_idx++) {
+			const auto &field = fields[field_idx];
+			const auto is_match = geometry_name.empty() ? field.second == GeoTypes::GEOMETRY()
+			                                            : StringUtil::CIEquals(field.first, geometry_name);
+			if (is_match) {
+				geometry_field = field_idx;
+				break;
+			}
+		}
+		if (!geometry_field.IsValid()) {
+			if (geometry_name.empty()) {
+				throw BinderException("ST_AsMVT: the row does not have a geometry column");
+			}
+			throw BinderException("ST_AsMVT: the row does not have a column named '%s'", geometry_name);
+		}
+		result->geometry_field = geometry_field.GetIndex();
+		if (fields[result->geometry_field].second != GeoTypes::GEOMETRY()) {
+			throw BinderException("ST_AsMVT: the column '%s' is not a geometry", fields[result->geometry_field].first);
+		}
+
+		if (!feature_id_name.empty()) {
+			for (idx_t field_idx = 0; field_idx < fields.size(); field_idx++) {
+				if (StringUtil::CIEquals(fields[field_idx].first, feature_id_name)) {
+					result->feature_id_field = field_idx;
+					break;
+				}
+			}
+			if (!result->feature_id_field.IsValid()) {
+				throw BinderException("ST_AsMVT: the row does not have a column named '%s'", feature_id_name);
+			}
+			if (!fields[result->feature_id_field.GetIndex()].second.IsIntegral()) {
+				throw BinderException("ST_AsMVT: the feature id column '%s' must be an integer", feature_id_name);
+			}
+		}
+
+		// Everything else becomes a property
+		for (idx_t field_idx = 0; field_idx < fields.size(); field_idx++) {
+			if (field_idx == result->geometry_field ||
+			    (result->feature_id_field.IsValid() && field_idx == result->feature_id_field.GetIndex())) {
+				continue;
+			}
+			result->property_fields.push_back(field_idx);
+			result->keys.push_back(fields[field_idx].first);
+		}
+
+		function.arguments[0] = row_type;
+		return std::move(result);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// State
+	//------------------------------------------------------------------------------------------------------------------
+	// The features of a group, encoded as far as they can be without knowing all values of the layer. The values are
+	// deduplicated once the tile is built, so that combining states is just appending.
+	struct Feature {
+		uint64_t id;
+		bool has_id;
+		MVTGeometryType type;
+		// The range of the commands of the geometry
+		idx_t commands_offset;
+		idx_t commands_count;
+		// The range of the tags of the feature
+		idx_t tags_offset;
+		idx_t tags_count;
+	};
+
+	struct Tag {
+		uint32_t key;
+		// The encoded Value message
+		idx_t value_offset;
+		idx_t value_size;
+	};
+
+	struct State {
+		vector<Feature> features;
+		vector<uint32_t> commands;
+		vector<Tag> tags;
+		vector<data_t> values;
+
+		void Append(const State &other) {
+			const auto commands_offset = commands.size();
+			const auto tags_offset = tags.size();
+			const auto values_offset = values.size();
+
+			commands.insert(commands.end(), other.commands.begin(), other.commands.end());
+			values.insert(values.end(), other.values.begin(), other.values.end());
+			for (auto tag : other.tags) {
+				tag.value_offset += values_offset;
+				tags.push_back(tag);
+			}
+			for (auto feature : other.features) {
+				feature.commands_offset += commands_offset;
+				feature.tags_offset += tags_offset;
+				features.push_back(feature);
+			}
+		}
+	};
+
+	static idx_t StateSize(const AggregateFunction &) {
+		return sizeof(State);
+	}
+
+	static void Initialize(const AggregateFunction &, data_ptr_t state_mem) {
+		new (state_mem) State();
+	}
+
+	static void Destroy(Vector &state_vec, AggregateInputData &, idx_t count) {
+		UnifiedVectorFormat state_format;
+		state_vec.ToUnifiedFormat(count, state_format);
+
+		const auto state_ptr = UnifiedVectorFormat::GetData<State *>(state_format);
+		for (idx_t raw_idx = 0; raw_idx < count; raw_idx++) {
+			state_ptr[state_format.sel->get_index(raw_idx)]->~State();
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Update
+	//------------------------------------------------------------------------------------------------------------------
+	// Encode a property as a Value message, returns false if the value can not be (or does not need to be) encoded
+	static bool TryEncodeValue(Vector &vec, const UnifiedVectorFormat &format, idx_t row_idx, idx_t value_idx,
+	                           ProtobufWriter &writer) {
+		if (!format.validity.RowIsValid(value_idx)) {
+			return false;
+		}
+
+		const auto write_integer = [&](int64_t value) {
+			if (value < 0) {
+				writer.WriteVarintField(VALUE_SINT, ProtobufWriter::ZigZag(value));
+			} else {
+				writer.WriteVarintField(VALUE_UINT, static_cast<uint64_t>(value));
+			}
+		};
+
+		switch (vec.GetType().id()) {
+		case LogicalTypeId::BOOLEAN:
+			writer.WriteVarintField(VALUE_BOOL, UnifiedVectorFormat::GetData<bool>(format)[value_idx] ? 1 : 0);
+			break;
+		case LogicalTypeId::TINYINT:
+			write_integer(UnifiedVectorFormat::GetData<int8_t>(format)[value_idx]);
+			break;
+		case LogicalTypeId::SMALLINT:
+			write_integer(UnifiedVectorFormat::GetData<int16_t>(format)[value_idx]);
+			break;
+		case LogicalTypeId::INTEGER:
+			write_integer(UnifiedVectorFormat::GetData<int32_t>(format)[value_idx]);
+			break;
+		case LogicalTypeId::BIGINT:
+			write_integer(UnifiedVectorFormat::GetData<int64_t>(format)[value_idx]);
+			break;
+		case LogicalTypeId::UTINYINT:
+			writer.WriteVarintField(VALUE_UINT, UnifiedVectorFormat::GetData<uint8_t>(format)[value_idx]);
+			break;
+		case LogicalTypeId::USMALLINT:
+			writer.WriteVarintField(VALUE_UINT, UnifiedVectorFormat::GetData<uint16_t>(format)[value_idx]);
+			break;
+		case LogicalTypeId::UINTEGER:
+			writer.WriteVarintField(VALUE_UINT, UnifiedVectorFormat::GetData<uint32_t>(format)[value_idx]);
+			break;
+		case LogicalTypeId::UBIGINT:
+			writer.WriteVarintField(VALUE_UINT, UnifiedVectorFormat::GetData<uint64_t>(format)[value_idx]);
+			break;
+		case LogicalTypeId::FLOAT:
+			writer.WriteFixedField<float>(VALUE_FLOAT, UnifiedVectorFormat::GetData<float>(format)[value_idx]);
+			break;
+		case LogicalTypeId::DOUBLE:
+			writer.WriteFixedField<double>(VALUE_DOUBLE, UnifiedVectorFormat::GetData<double>(format)[value_idx]);
+			break;
+		case LogicalTypeId::VARCHAR: {
+			const auto &str = UnifiedVectorFormat::GetData<string_t>(format)[value_idx];
+			writer.WriteBytesField(VALUE_STRING, const_data_ptr_cast(str.GetData()), str.GetSize());
+		} break;
+		default: {
+			// Everything else is encoded as its string representation
+			const auto str = vec.GetValue(row_idx).ToString();
+			writer.WriteStringField(VALUE_STRING, str);
+		} break;
+		}
+		return true;
+	}
+
+	static bool TryGetFeatureId(const LogicalType &type, const UnifiedVectorFormat &format, idx_t value_idx,
+	                            uint64_t &result) {
+		if (!format.validity.RowIsValid(value_idx)) {
+			return false;
+		}
+		int64_t value;
+		switch (type.id()) {
+		case LogicalTypeId::TINYINT:
+			value = UnifiedVectorFormat::GetData<int8_t>(format)[value_idx];
+			break;
+		case LogicalTypeId::SMALLINT:
+			value = UnifiedVectorFormat::GetData<int16_t>(format)[value_idx];
+			break;
+		case LogicalTypeId::INTEGER:
+			value = UnifiedVectorFormat::GetData<int32_t>(format)[value_idx];
+			break;
+		case LogicalTypeId::BIGINT:
+			value = UnifiedVectorFormat::GetData<int64_t>(format)[value_idx];
+			break;
+		case LogicalTypeId::UTINYINT:
+			result = UnifiedVectorFormat::GetData<uint8_t>(format)[value_idx];
+			return true;
+		case LogicalTypeId::USMALLINT:
+			result = UnifiedVectorFormat::GetData<uint16_t>(format)[value_idx];
+			return true;
+		case LogicalTypeId::UINTEGER:
+			result = UnifiedVectorFormat::GetData<uint32_t>(format)[value_idx];
+			return true;
+		case LogicalTypeId::UBIGINT:
+			result = UnifiedVectorFormat::GetData<uint64_t>(format)[value_idx];
+			return true;
+		default:
+			// HUGEINT and friends dont fit
+			return false;
+		}
+		// Feature ids are unsigned
+		if (value < 0) {
+			return false;
+		}
+		result = static_cast<uint64_t>(value);
+		return true;
+	}
+
+	static void Update(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count, Vector &state_vec,
+	                   idx_t count) {
+		auto &bind_data = aggr_input_data.bind_data->Cast<BindData>();
+
+		auto &row_vec = inputs[0];
+		auto &fields = StructVector::GetEntries(row_vec);
+
+		UnifiedVectorFormat row_format;
+		row_vec.ToUnifiedFormat(count, row_format);
+
+		UnifiedVectorFormat state_format;
+		state_vec.ToUnifiedFormat(count, state_format);
+		const auto state_ptr = UnifiedVectorFormat::GetData<State *>(state_format);
+
+		// The fields are indexed by the row index of the (resolved) row vector
+		vector<UnifiedVectorFormat> field_formats(fields.size());
+		for (idx_t field_idx = 0; field_idx < fields.size(); field_idx++) {
+			fields[field_idx]->ToUnifiedFormat(count, field_formats[field_idx]);
+		}
+		const auto &geom_format = field_formats[bind_data.geometry_field];
+		const auto geom_data = UnifiedVectorFormat::GetData<string_t>(geom_format);
+
+		ArenaAllocator arena(aggr_input_data.allocator.GetAllocator());
+		MVTGeometryEncoder encoder;
+		ProtobufWriter value_writer;
+
+		for (idx_t raw_idx = 0; raw_idx < count; raw_idx++) {
+			const auto row_idx = row_format.sel->get_index(raw_idx);
+			if (!row_format.validity.RowIsValid(row_idx)) {
+				continue;
+			}
+			const auto geom_idx = geom_format.sel->get_index(row_idx);
+			if (!geom_format.validity.RowIsValid(geom_idx)) {
+				continue;
+			}
+
+			auto &state = *state_ptr[state_format.sel->get_index(raw_idx)];
+
+			// Encode the geometry, features without a geometry are skipped
+			arena.Reset();
+			const auto &blob = geom_data[geom_idx];
+			sgl::geometry geom;
+			Serde::Deserialize(geom, arena, blob.GetDataUnsafe(), blob.GetSize());
+
+			Feature feature = {};
+			feature.commands_offset = state.commands.size();
+			feature.type = encoder.Encode(geom, state.commands);
+			if (feature.type == MVTGeometryType::UNKNOWN) {
+				continue;
+			}
+			feature.commands_count = state.commands.size() - feature.commands_offset;
+
+			if (bind_data.feature_id_field.IsValid()) {
+				const auto id_field = bind_data.feature_id_field.GetIndex();
+				const auto &id_format = field_formats[id_field];
+				feature.has_id = TryGetFeatureId(fields[id_field]->GetType(), id_format,
+				                                 id_format.sel->get_index(row_idx), feature.id);
+			}
+
+			// Encode the properties, NULLs are left out
+			feature.tags_offset = state.tags.size();
+			for (idx_t key_idx = 0; key_idx < bind_data.property_fields.size(); key_idx++) {
+				const auto field_idx = bind_data.property_fields[key_idx];
+				const auto &field_format = field_formats[field_idx];
+
+				value_writer.Clear();
+				if (!TryEncodeValue(*fields[field_idx], field_format, row_idx, field_format.sel->get_index(row_idx),
+				                    value_writer)) {
+					continue;
+				}
+
+				Tag tag;
+				tag.key = static_cast<uint32_t>(key_idx);
+				tag.value_offset = state.values.size();
+				tag.value_size = value_writer.GetSize();
+				state.values.insert(state.values.end(), value_writer.GetData(),
+				                    value_writer.GetData() + value_writer.GetSize());
+				state.tags.push_back(tag);
+			}
+			feature.tags_count = state.tags.size() - feature.tags_offset;
+
+			state.features.push_back(feature);
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Combine
+	//------------------------------------------------------------------------------------------------------------------
+	static void Combine(Vector &state_vec, Vector &combined, AggregateInputData &aggr_input_data, idx_t count) {
+		UnifiedVectorFormat state_format;
+		state_vec.ToUnifiedFormat(count, state_format);
+
+		const auto state_ptr = UnifiedVectorFormat::GetData<State *>(state_format);
+		const auto combined_ptr = FlatVector::GetData<State *>(combined);
+
+		const auto allow_destructive = aggr_input_data.combine_type == AggregateCombineType::ALLOW_DESTRUCTIVE;
+
+		for (idx_t raw_idx = 0; raw_idx < count; raw_idx++) {
+			auto &state = *state_ptr[state_format.sel->get_index(raw_idx)];
+			auto &combined_state = *combined_ptr[raw_idx];
+
+			if (allow_destructive && combined_state.features.empty()) {
+				// Steal the buffers
+				std::swap(combined_state, state);
+				continue;
+			}
+			combined_state.Append(state);
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Finalize
+	//------------------------------------------------------------------------------------------------------------------
+	static void EncodeTile(const BindData &bind_data, const State &state, ProtobufWriter &tile) {
+		ProtobufWriter layer;
+		ProtobufWriter message;
+
+		layer.WriteStringField(LAYER_NAME, bind_data.layer_name);
+
+		// Deduplicate the values, the tags reference them by index
+		unordered_map<string, uint32_t> value_ids;
+		vector<uint32_t> tag_values(state.tags.size());
+		vector<const Tag *> values;
+		for (idx_t tag_idx = 0; tag_idx < state.tags.size(); tag_idx++) {
+			const auto &tag = state.tags[tag_idx];
+			const string value(const_char_ptr_cast(state.values.data() + tag.value_offset), tag.value_size);
+			auto entry = value_ids.find(value);
+			if (entry == value_ids.end()) {
+				entry = value_ids.emplace(value, static_cast<uint32_t>(values.size())).first;
+				values.push_back(&tag);
+			}
+			tag_values[tag_idx] = entry->second;
+		}
+
+		vector<uint32_t> tags;
+		for (const auto &feature : state.features) {
+			message.Clear();
+			if (feature.has_id) {
+				message.WriteVarintField(FEATURE_ID, feature.id);
+			}
+			if (feature.tags_count != 0) {
+				tags.clear();
+				for (idx_t tag_idx = feature.tags_offset; tag_idx < feature.tags_offset + feature.tags_count;
+				     tag_idx++) {
+					tags.push_back(state.tags[tag_idx].key);
+					tags.push_back(tag_values[tag_idx]);
+				}
+				message.WritePackedField(FEATURE_TAGS, tags.data(), tags.size());
+			}
+			message.WriteVarintField(FEATURE_TYPE, static_cast<uint8_t>(feature.type));
+			message.WritePackedField(FEATURE_GEOMETRY, state.commands.data() + feature.commands_offset,
+			                         feature.commands_count);
+			layer.WriteBytesField(LAYER_FEATURES, message);
+		}
+
+		for (const auto &key : bind_data.keys) {
+			layer.WriteStringField(LAYER_KEYS, key);
+		}
+		for (const auto value : values) {
+			layer.WriteBytesField(LAYER_VALUES, state.values.data() + value->value_offset, value->value_size);
+		}
+		layer.WriteVarintField(LAYER_EXTENT, bind_data.extent);
+		layer.WriteVarintField(LAYER_VERSION, 2);
+
+		tile.WriteBytesField(TILE_LAYERS, layer);
+	}
+
+	static void Finalize(Vector &state_vec, AggregateInputData &aggr_input_data, Vector &result, idx_t count,
+	                     idx_t offset) {
+		auto &bind_data = aggr_input_data.bind_data->Cast<BindData>();
+
+		UnifiedVectorFormat state_format;
+		state_vec.ToUnifiedFormat(count, state_format);
+		const auto state_ptr = UnifiedVectorFormat::GetData<State *>(state_format);
+
+		const auto result_data = FlatVector::GetData<string_t>(result);
+
+		ProtobufWriter tile;
+		for (idx_t raw_idx = 0; raw_idx < count; raw_idx++) {
+			const auto &state = *state_ptr[state_format.sel->get_index(raw_idx)];
+			const auto out_idx = raw_idx + offset;
+
+			// A tile without features is empty
+			tile.Clear();
+			if (!state.features.empty()) {
+				EncodeTile(bind_data, state, tile);
+			}
+			result_data[out_idx] =
+			    StringVector::AddStringOrBlob(result, const_char_ptr_cast(tile.GetData()), tile.GetSize());
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Encodes a set of rows into a Mapbox Vector Tile (MVT) layer.
+
+		The geometry column of the rows (by default the first `GEOMETRY` column) becomes the geometry of the features,
+		all other columns become their properties. The geometries are expected to be in tile space already, e.g. as
+		returned by [ST_AsMVTGeom](#st_asmvtgeom).
+
+		The optional arguments are the name of the layer (`'default'` if not given), the extent of the tile (`4096`),
+		the name of the geometry column, and the name of an integer column to use as the id of the features.
+
+		Returns the tile as a protobuf encoded `BLOB`. Tiles with multiple layers can be created by concatenating the
+		results of multiple calls.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT ST_AsMVT({'geom': ST_AsMVTGeom(geom, ST_Extent(ST_MakeEnvelope(0, 0, 100, 100))), 'name': name}, 'points')
+		FROM (VALUES (ST_Point(10, 10), 'a'), (ST_Point(50, 50), 'b')) AS t(geom, name);
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		FunctionBuilder::RegisterAggregate(db, "ST_AsMVT", [&](AggregateFunctionBuilder &func) {
+			// The row, the layer name, the extent, the geometry column name and the feature id column name
+			const vector<LogicalType> arguments = {LogicalType::ANY, LogicalType::VARCHAR, LogicalType::INTEGER,
+			                                       LogicalType::VARCHAR, LogicalType::VARCHAR};
+
+			for (idx_t arg_count = 1; arg_count <= arguments.size(); arg_count++) {
+				const vector<LogicalType> variant_arguments(arguments.begin(), arguments.begin() + arg_count);
+				AggregateFunction agg(variant_arguments, LogicalType::BLOB, StateSize, Initialize, Update, Combine,
+				                      Finalize, nullptr, Bind, Destroy);
+				func.SetFunction(agg);
+			}
+
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "conversion");
+		});
+	}
+};
+
+//######################################################################################################################
+// Tile Grid
+//######################################################################################################################
+//
+// Tiles follow the XYZ scheme over web mercator (EPSG:3857): zoom level z divides the world into 2^z by 2^z tiles,
+// numbered from the top left corner.
+//
+
+struct TileGrid {
+	static double GetTileSize(int32_t zoom) {
+		return 2 * MVT_WEB_MERCATOR_ORIGIN / static_cast<double>(int64_t(1) << zoom);
+	}
+
+	static sgl::box_xy GetEnvelope(int32_t zoom, int32_t x, int32_t y) {
+		const auto size = GetTileSize(zoom);
+		sgl::box_xy result;
+		result.min.x = -MVT_WEB_MERCATOR_ORIGIN + x * size;
+		result.max.x = result.min.x + size;
+		result.max.y = MVT_WEB_MERCATOR_ORIGIN - y * size;
+		result.min.y = result.max.y - size;
+		return result;
+	}
+
+	static void CheckZoom(const char *function, int32_t zoom) {
+		if (zoom < 0 || zoom > MVT_MAX_ZOOM) {
+			throw InvalidInputException("%s: the zoom level must be between 0 and %d", function, MVT_MAX_ZOOM);
+		}
+	}
+
+	// Get the range of tiles intersecting the bounds at a zoom level, returns false if there are none
+	static bool TryGetRange(const sgl::box_xy &bounds, int32_t zoom, double margin, int64_t &min_x, int64_t &min_y,
+	                        int64_t &max_x, int64_t &max_y) {
+		const auto size = GetTileSize(zoom);
+		const auto count = static_cast<double>(int64_t(1) << zoom);
+		const auto buffer = margin * size;
+
+		const auto x0 = std::floor((bounds.min.x - buffer + MVT_WEB_MERCATOR_ORIGIN) / size);
+		const auto x1 = std::floor((bounds.max.x + buffer + MVT_WEB_MERCATOR_ORIGIN) / size);
+		const auto y0 = std::floor((MVT_WEB_MERCATOR_ORIGIN - bounds.max.y - buffer) / size);
+		const auto y1 = std::floor((MVT_WEB_MERCATOR_ORIGIN - bounds.min.y + buffer) / size);
+
+		// Also rejects NaN
+		if (!(x1 >= 0 && x0 < count && y1 >= 0 && y0 < count)) {
+			return false;
+		}
+
+		min_x = static_cast<int64_t>(MaxValue(x0, 0.0));
+		min_y = static_cast<int64_t>(MaxValue(y0, 0.0));
+		max_x = static_cast<int64_t>(MinValue(x1, count - 1));
+		max_y = static_cast<int64_t>(MinValue(y1, count - 1));
+		return true;
+	}
+};
+
+//######################################################################################################################
+// ST_TileEnvelope
+//######################################################################################################################
+
+struct ST_TileEnvelope {
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Execute
+	//------------------------------------------------------------------------------------------------------------------
+	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
+		TernaryExecutor::Execute<int32_t, int32_t, int32_t, string_t>(
+		    args.data[0], args.data[1], args.data[2], result, args.size(), [&](int32_t zoom, int32_t x, int32_t y) {
+			    TileGrid::CheckZoom("ST_TileEnvelope", zoom);
+			    const auto count = int64_t(1) << zoom;
+			    if (x < 0 || x >= count || y < 0 || y >= count) {
+				    throw InvalidInputException("ST_TileEnvelope: tile %d/%d/%d does not exist", zoom, x, y);
+			    }
+			    const auto bounds = TileGrid::GetEnvelope(zoom, x, y);
+
+			    const double buffer[10] = {bounds.min.x, bounds.min.y, bounds.min.x, bounds.max.y, bounds.max.x,
+			                               bounds.max.y, bounds.max.x, bounds.min.y, bounds.min.x, bounds.min.y};
+
+			    sgl::geometry ring(sgl::geometry_type::LINESTRING, false, false);
+			    ring.set_vertex_data(reinterpret_cast<const char *>(buffer), 5);
+
+			    sgl::geometry poly(sgl::geometry_type::POLYGON, false, false);
+			    poly.append_part(&ring);
+
+			    const auto size = Serde::GetRequiredSize(poly);
+			    auto blob = StringVector::EmptyString(result, size);
+			    Serde::Serialize(poly, blob.GetDataWriteable(), size);
+			    blob.Finalize();
+			    return blob;
+		    });
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Returns the bounds of a tile in web mercator (EPSG:3857) as a polygon.
+
+		Tiles are addressed in the XYZ scheme: at zoom level `z` the world is divided into `2^z` by `2^z` tiles, with tile
+		`0/0/0` covering the whole world and `x` and `y` counting from the top left corner.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT ST_TileEnvelope(1, 0, 0);
+		----
+		POLYGON ((-20037508.342789244 0, -20037508.342789244 20037508.342789244, 0 20037508.342789244, 0 0, -20037508.342789244 0))
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		FunctionBuilder::RegisterScalar(db, "ST_TileEnvelope", [](ScalarFunctionBuilder &func) {
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("z", LogicalType::INTEGER);
+				variant.AddParameter("x", LogicalType::INTEGER);
+				variant.AddParameter("y", LogicalType::INTEGER);
+				variant.SetReturnType(GeoTypes::GEOMETRY());
+
+				variant.SetFunction(Execute);
+			});
+
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "construction");
+		});
+	}
+};
+
+//######################################################################################################################
+// ST_TileCover
+//######################################################################################################################
+
+struct ST_TileCover {
+
+	static LogicalType GetTileType() {
+		return LogicalType::STRUCT(
+		    {{"z", LogicalType::INTEGER}, {"x", LogicalType::INTEGER}, {"y", LogicalType::INTEGER}});
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Execute
+	//------------------------------------------------------------------------------------------------------------------
+	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
+		const auto count = args.size();
+		args.Flatten();
+
+		const auto column_count = args.ColumnCount();
+		const auto geom_data = FlatVector::GetData<string_t>(args.data[0]);
+		const auto min_zoom_data = FlatVector::GetData<int32_t>(args.data[1]);
+		const auto max_zoom_data = FlatVector::GetData<int32_t>(args.data[2]);
+		const auto margin_data = column_count > 3 ? FlatVector::GetData<double>(args.data[3]) : nullptr;
+
+		const auto list_entries = FlatVector::GetData<list_entry_t>(result);
+		auto &result_mask = FlatVector::Validity(result);
+		auto &tile_vec = ListVector::GetEntry(result);
+		auto &tile_fields = StructVector::GetEntries(tile_vec);
+
+		idx_t total = 0;
+		for (idx_t row_idx = 0; row_idx < count; row_idx++) {
+			bool is_valid = true;
+			for (idx_t col_idx = 0; col_idx < column_count; col_idx++) {
+				is_valid &= FlatVector::Validity(args.data[col_idx]).RowIsValid(row_idx);
+			}
+			if (!is_valid) {
+				result_mask.SetInvalid(row_idx);
+				continue;
+			}
+
+			const auto min_zoom = min_zoom_data[row_idx];
+			const auto max_zoom = max_zoom_data[row_idx];
+			const auto margin = margin_data ? margin_data[row_idx] : 0.0;
+			TileGrid::CheckZoom("ST_TileCover", min_zoom);
+			TileGrid::CheckZoom("ST_TileCover", max_zoom);
+			if (min_zoom > max_zoom) {
+				throw InvalidInputException("ST_TileCover: the minimum zoom level must not exceed the maximum");
+			}
+			if (!(margin >= 0)) {
+				throw InvalidInputException("ST_TileCover: the margin must not be negative");
+			}
+
+			auto &entry = list_entries[row_idx];
+			entry.offset = total;
+			entry.length = 0;
+
+			const auto &blob = geom_data[row_idx];
+			sgl::box_xy bounds;
+			if (!Serde::TryGetExtentXY(blob.GetDataUnsafe(), blob.GetSize(), bounds)) {
+				// Empty geometries are not in any tile
+				continue;
+			}
+
+			// Count the tiles first, so that the list is only grown once
+			idx_t tile_count = 0;
+			for (auto zoom = min_zoom; zoom <= max_zoom; zoom++) {
+				int64_t min_x, min_y, max_x, max_y;
+				if (TileGrid::TryGetRange(bounds, zoom, margin, min_x, min_y, max_x, max_y)) {
+					tile_count += static_cast<idx_t>((max_x - min_x + 1) * (max_y - min_y + 1));
+				}
+				if (tile_count > MVT_MAX_TILE_COVER) {
+					throw InvalidInputException("ST_TileCover: the geometry covers more than %llu tiles",
+					                            static_cast<unsigned long long>(MVT_MAX_TILE_COVER));
+				}
+			}
+
+			ListVector::Reserve(result, total + tile_count);
+			const auto z_data = FlatVector::GetData<int32_t>(*tile_fields[0]);
+			const auto x_data = FlatVector::GetData<int32_t>(*tile_fields[1]);
+			const auto y_data = FlatVector::GetData<int32_t>(*tile_fields[2]);
+
+			for (auto zoom = min_zoom; zoom <= max_zoom; zoom++) {
+				int64_t min_x, min_y, max_x, max_y;
+				if (!TileGrid::TryGetRange(bounds, zoom, margin, min_x, min_y, max_x, max_y)) {
+					continue;
+				}
+				for (auto y = min_y; y <= max_y; y++) {
+					for (auto x = min_x; x <= max_x; x++) {
+						z_data[total] = zoom;
+						x_data[total] = static_cast<int32_t>(x);
+						y_data[total] = static_cast<int32_t>(y);
+						total++;
+					}
+				}
+			}
+			entry.length = total - entry.offset;
+		}
+		ListVector::SetListSize(result, total);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Returns the tiles that the bounding box of a geometry intersects, for every zoom level in a range.
+
+		The geometry is expected to be in web mercator (EPSG:3857), and the tiles are addressed in the XYZ scheme, see
+		[ST_TileEnvelope](#st_tileenvelope). The optional `margin` expands the bounding box by a fraction of the tile size
+		at each zoom level, e.g. to also assign a geometry to the tiles whose buffer it intersects.
+
+		Together with `UNNEST` and [ST_AsMVT](#st_asmvt) this assigns features to the tiles of a tile pyramid.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT ST_TileCover(ST_Point(100, 100), 0, 2);
+		----
+		[{'z': 0, 'x': 0, 'y': 0}, {'z': 1, 'x': 1, 'y': 0}, {'z': 2, 'x': 2, 'y': 1}]
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		FunctionBuilder::RegisterScalar(db, "ST_TileCover", [](ScalarFunctionBuilder &func) {
+			for (idx_t arg_count = 3; arg_count <= 4; arg_count++) {
+				func.AddVariant([&](ScalarFunctionVariantBuilder &variant) {
+					variant.AddParameter("geom", GeoTypes::GEOMETRY());
+					variant.AddParameter("min_zoom", LogicalType::INTEGER);
+					variant.AddParameter("max_zoom", LogicalType::INTEGER);
+					if (arg_count > 3) {
+						variant.AddParameter("margin", LogicalType::DOUBLE);
+					}
+					variant.SetReturnType(LogicalType::LIST(GetTileType()));
+					variant.SetFunction(Execute);
+				});
+			}
+
+			func.SetDescription(DESCRIPTION);
+			func.SetExample(EXAMPLE);
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "conversion");
+		});
+	}
+};
+
+//######################################################################################################################
+// ST_TilePyramid
+//######################################################################################################################
+//
+// Generating a pyramid is assigning every feature to the tiles it covers at each zoom level, clipping it per tile and
+// encoding every tile. Rather than doing all of that (and buffering every feature) within a single operator, the function
+// expands into a query over ST_TileCover, ST_AsMVTGeom and ST_AsMVT, so that the clipping runs in parallel in the
+// projection and the tiles are built by the (parallel) hash aggregate, and stream out as they are finished.
+//
+
+struct ST_TilePyramid {
+
+	static unique_ptr<TableRef> BindReplace(ClientContext &context, TableFunctionBindInput &input) {
+		const auto &source = StringValue::Get(input.inputs[0]);
+		const auto min_zoom = IntegerValue::Get(input.inputs[1]);
+		const auto max_zoom = IntegerValue::Get(input.inputs[2]);
+
+		TileGrid::CheckZoom("ST_TilePyramid", min_zoom);
+		TileGrid::CheckZoom("ST_TilePyramid", max_zoom);
+		if (min_zoom > max_zoom) {
+			throw InvalidInputException("ST_TilePyramid: the minimum zoom level must not exceed the maximum");
+		}
+
+		string geom_column = "geom";
+		string layer_name = "default";
+		auto extent = MVT_DEFAULT_EXTENT;
+		auto buffer = MVT_DEFAULT_BUFFER;
+
+		for (auto &param : input.named_parameters) {
+			if (param.second.IsNull()) {
+				throw InvalidInputException("ST_TilePyramid: '%s' must not be NULL", param.first);
+			}
+			if (param.first == "geom_column") {
+				geom_column = StringValue::Get(param.second);
+			} else if (param.first == "layer") {
+				layer_name = StringValue::Get(param.second);
+			} else if (param.first == "extent") {
+				extent = IntegerValue::Get(param.second);
+			} else if (param.first == "buffer") {
+				buffer = IntegerValue::Get(param.second);
+			}
+		}
+		if (extent <= 0) {
+			throw InvalidInputException("ST_TilePyramid: the extent must be positive");
+		}
+		if (buffer < 0) {
+			throw InvalidInputException("ST_TilePyramid: the buffer must not be negative");
+		}
+
+		const auto geom = KeywordHelper::WriteOptionallyQuoted(geom_column);
+		const auto margin = static_cast<double>(buffer) / extent;
+
+		// Snapping the clipped geometries to the grid of each tile simplifies them for that zoom level. The geometry is
+		// replaced within the row, so that all other columns become the properties of the features.
+		const auto query = StringUtil::Format(
+		    "SELECT __tile.z AS z, __tile.x AS x, __tile.y AS y, ST_AsMVT(__feature, %s, %d, %s) AS tile "
+		    "FROM ("
+		    "SELECT __tile, struct_pack(*COLUMNS(* EXCLUDE (__tile) REPLACE (ST_AsMVTGeom(%s, "
+		    "ST_Extent(ST_TileEnvelope(__tile.z, __tile.x, __tile.y)), %d, %d) AS %s))) AS __feature "
+		    "FROM (SELECT *, UNNEST(ST_TileCover(%s, %d, %d, %s)) AS __tile FROM query_table(%s))"
+		    ") "
+		    "WHERE struct_extract(__feature, %s) IS NOT NULL "
+		    "GROUP BY __tile",
+		    KeywordHelper::WriteQuoted(layer_name, '\''), extent, KeywordHelper::WriteQuoted(geom_column, '\''), geom,
+		    extent, buffer, geom, geom, min_zoom, max_zoom, Value::DOUBLE(margin).ToSQLString(),
+		    KeywordHelper::WriteQuoted(source, '\''), KeywordHelper::WriteQuoted(geom_column, '\''));
+
+		Parser parser(context.GetParserOptions());
+		parser.ParseQuery(query);
+		D_ASSERT(parser.statements.size() == 1 && parser.statements[0]->type == StatementType::SELECT_STATEMENT);
+
+		auto select = unique_ptr_cast<SQLStatement, SelectStatement>(std::move(parser.statements[0]));
+		return make_uniq<SubqueryRef>(std::move(select));
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Documentation
+	//------------------------------------------------------------------------------------------------------------------
+	static constexpr auto DESCRIPTION = R"(
+		Generates the vector tiles of a table for a range of zoom levels.
+
+		Takes the name of a table (or view) with a web mercator (EPSG:3857) geometry column, and the minimum and
+		maximum zoom level. Every feature is assigned to the tiles it covers at each zoom level, clipped to each tile and
+		snapped to its grid (simplifying it for the zoom level) with [ST_AsMVTGeom](#st_asmvtgeom), and encoded with
+		[ST_AsMVT](#st_asmvt). All other columns of the table become the properties of the features.
+
+		Returns a row `(z, x, y, tile)` for every tile that is not empty, in no particular order.
+
+		The following named parameters are supported:
+		- `geom_column`: the name of the geometry column, `'geom'` by default
+		- `layer`: the name of the layer in the tiles, `'default'` by default
+		- `extent`: the extent of the tiles, `4096` by default
+		- `buffer`: the buffer around the tiles, in tile units, `256` by default
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+		SELECT z, x, y, octet_length(tile) FROM ST_TilePyramid('roads', 0, 14, layer := 'roads');
+	)";
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Register
+	//------------------------------------------------------------------------------------------------------------------
+	static void Register(DatabaseInstance &db) {
+		TableFunction func("ST_TilePyramid", {LogicalType::VARCHAR, LogicalType::INTEGER, LogicalType::INTEGER},
+		                   nullptr, nullptr);
+		func.bind_replace = BindReplace;
+		func.named_parameters["geom_column"] = LogicalType::VARCHAR;
+		func.named_parameters["layer"] = LogicalType::VARCHAR;
+		func.named_parameters["extent"] = LogicalType::INTEGER;
+		func.named_parameters["buffer"] = LogicalType::INTEGER;
+		ExtensionUtil::RegisterFunction(db, func);
+
+		InsertionOrderPreservingMap<string> tags;
+		tags.insert("ext", "spatial");
+		FunctionBuilder::AddTableFunctionDocs(db, "ST_TilePyramid", DESCRIPTION, EXAMPLE, tags);
+	}
+};
+
+} // namespace
+
+//######################################################################################################################
+// Module Registration
+//######################################################################################################################
+
+void RegisterMVTModule(DatabaseInstance &db) {
+	ST_AsMVTGeom::Register(db);
+	ST_AsMVT::Register(db);
+	ST_TileEnvelope::Register(db);
+	ST_TileCover::Register(db);
+	ST_TilePyramid::Register(db);
+}
+
+} // namespace duckdb
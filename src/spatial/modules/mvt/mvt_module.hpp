@@ -0,0 +1,9 @@
+#pragma once
+
+namespace duckdb {
+
+class DatabaseInstance;
+
+void RegisterMVTModule(DatabaseInstance &db);
+
+} // namespace duckdb
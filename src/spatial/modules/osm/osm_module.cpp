@@ -1,14 +1,24 @@
 #include "spatial/modules/osm/osm_module.hpp"
 
+#include "duckdb/common/bit_utils.hpp"
 #include "duckdb/function/replacement_scan.hpp"
 #include "duckdb/main/database.hpp"
 #include "duckdb/main/extension_util.hpp"
 #include "duckdb/parser/expression/constant_expression.hpp"
 #include "duckdb/parser/expression/function_expression.hpp"
 #include "duckdb/parser/tableref/table_function_ref.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
 #include "duckdb/storage/buffer_manager.hpp"
 #include "protozero/pbf_reader.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
 #include "spatial/spatial_types.hpp"
+#include "spatial/util/managed_collection.hpp"
 #include "zlib.h"
 
 #include <spatial/util/function_builder.hpp>
@@ -26,12 +36,81 @@ static int32_t ReadInt32BigEndian(data_ptr_t ptr) {
 	return (ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3];
 }
 
+//! Decodes a packed field of delta coded, zig-zag encoded varints (the ids and coordinates of dense nodes) one value
+//! at a time, so that they can be written straight into the output vectors.
+//! Varints of up to 8 bytes (all but the largest deltas) are decoded from a single 64-bit load: the first byte
+//! without a continuation bit is found from the mask of the high bits, and the 7-bit groups are then compacted
+//! without any branches on the individual bytes.
+class DeltaVarintReader {
+public:
+	DeltaVarintReader() = default;
+	explicit DeltaVarintReader(const pz::data_view &view)
+	    : ptr(view.data()), end(view.data() + view.size()), count(CountVarints(view)) {
+	}
+
+	//! The number of values in the field
+	idx_t Count() const {
+		return count;
+	}
+
+	int64_t Next() {
+		value += pz::decode_zigzag64(ReadVarint());
+		return value;
+	}
+
+private:
+	static idx_t CountVarints(const pz::data_view &view) {
+		// Every varint ends with the only byte of it without the continuation bit
+		idx_t result = 0;
+		for (idx_t i = 0; i < view.size(); i++) {
+			result += (static_cast<uint8_t>(view.data()[i]) & 0x80) == 0;
+		}
+		return result;
+	}
+
+	uint64_t ReadVarint() {
+		if (end - ptr >= static_cast<int64_t>(sizeof(uint64_t))) {
+			auto word = Load<uint64_t>(const_data_ptr_cast(ptr));
+			const auto stop_bits = ~word & 0x8080808080808080ULL;
+			if (stop_bits != 0) {
+				const auto bits = CountZeros<uint64_t>::Trailing(stop_bits) + 1;
+				if (bits < 64) {
+					word &= (1ULL << bits) - 1;
+				}
+				ptr += bits / 8;
+				return (word & 0x7FULL) | ((word >> 1) & (0x7FULL << 7)) | ((word >> 2) & (0x7FULL << 14)) |
+				       ((word >> 3) & (0x7FULL << 21)) | ((word >> 4) & (0x7FULL << 28)) |
+				       ((word >> 5) & (0x7FULL << 35)) | ((word >> 6) & (0x7FULL << 42)) |
+				       ((word >> 7) & (0x7FULL << 49));
+			}
+		}
+		// Longer varints, and the last few bytes of the field
+		return pz::decode_varint(&ptr, end);
+	}
+
+	const char *ptr = nullptr;
+	const char *end = nullptr;
+	idx_t count = 0;
+	int64_t value = 0;
+};
+
 //------------------------------------------------------------------------------
 // OSM Table Function
 //------------------------------------------------------------------------------
 
+//! The columns of ST_ReadOSM
+enum class OsmColumn : idx_t { KIND = 0, ID, TAGS, REFS, LAT, LON, REF_ROLES, REF_TYPES, GEOMETRY, COUNT };
+
+//! The entity kinds, in the order of the OSM_ENTITY_TYPE enum
+enum class OsmKind : uint8_t { NODE = 0, WAY = 1, RELATION = 2, CHANGESET = 3, COUNT };
+
 struct BindData final : TableFunctionData {
 	string file_name;
+	vector<LogicalType> types;
+	//! Whether to output a geometry column, with points for nodes and linestrings for ways
+	bool geometry = false;
+	//! The kinds to scan, other kinds are skipped without parsing them if a filter removes them anyway
+	bool scan_kind[static_cast<idx_t>(OsmKind::COUNT)] = {true, true, true, true};
 
 	explicit BindData(string file_name) : file_name(std::move(file_name)) {
 	}
@@ -87,9 +166,106 @@ static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindIn
 	// Create bind data
 	auto file_name = StringValue::Get(input.inputs[0]);
 	auto result = make_uniq<BindData>(file_name);
+
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "geometry") {
+			result->geometry = BooleanValue::Get(kv.second);
+		}
+	}
+
+	if (result->geometry) {
+		return_types.push_back(GeoTypes::GEOMETRY());
+		names.push_back("geometry");
+	}
+
+	result->types = return_types;
 	return std::move(result);
 }
 
+//! Get the kinds that an expression on the kind column accepts, if it is a comparison (or IN) with constants
+static bool TryGetKindFilter(const LogicalGet &get, const Expression &expr,
+                             bool (&accepted)[static_cast<idx_t>(OsmKind::COUNT)]) {
+	const auto is_kind_column = [&](const Expression &child) {
+		if (child.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+			return false;
+		}
+		const auto &colref = child.Cast<BoundColumnRefExpression>();
+		if (colref.binding.table_index != get.table_index) {
+			return false;
+		}
+		const auto &column_ids = get.GetColumnIds();
+		return colref.binding.column_index < column_ids.size() &&
+		       column_ids[colref.binding.column_index].GetPrimaryIndex() == static_cast<idx_t>(OsmColumn::KIND);
+	};
+
+	const auto accept_constant = [&](const Expression &child) {
+		if (child.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+			return false;
+		}
+		const auto &value = child.Cast<BoundConstantExpression>().value;
+		if (value.IsNull()) {
+			return true;
+		}
+		const auto str = value.ToString();
+		const char *kinds[] = {"node", "way", "relation", "changeset"};
+		for (idx_t i = 0; i < static_cast<idx_t>(OsmKind::COUNT); i++) {
+			if (str == kinds[i]) {
+				accepted[i] = true;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	if (expr.GetExpressionType() == ExpressionType::COMPARE_EQUAL) {
+		const auto &cmp = expr.Cast<BoundComparisonExpression>();
+		if (is_kind_column(*cmp.left)) {
+			return accept_constant(*cmp.right);
+		}
+		if (is_kind_column(*cmp.right)) {
+			return accept_constant(*cmp.left);
+		}
+		return false;
+	}
+	if (expr.GetExpressionType() == ExpressionType::COMPARE_IN) {
+		const auto &op = expr.Cast<BoundOperatorExpression>();
+		if (!is_kind_column(*op.children[0])) {
+			return false;
+		}
+		for (idx_t i = 1; i < op.children.size(); i++) {
+			if (!accept_constant(*op.children[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+	if (expr.GetExpressionType() == ExpressionType::CONJUNCTION_OR) {
+		const auto &conj = expr.Cast<BoundConjunctionExpression>();
+		for (auto &child : conj.children) {
+			if (!TryGetKindFilter(get, *child, accepted)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+//! Skip the entity kinds that are filtered out anyway. The filters are left in place, so they still apply.
+static void PushdownComplexFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                  vector<unique_ptr<Expression>> &filters) {
+	auto &bind_data = bind_data_p->Cast<BindData>();
+	for (auto &filter : filters) {
+		bool accepted[static_cast<idx_t>(OsmKind::COUNT)] = {false, false, false, false};
+		if (!TryGetKindFilter(get, *filter, accepted)) {
+			continue;
+		}
+		for (idx_t i = 0; i < static_cast<idx_t>(OsmKind::COUNT); i++) {
+			bind_data.scan_kind[i] = bind_data.scan_kind[i] && accepted[i];
+		}
+	}
+}
+
 enum class FileBlockType { Header, Data };
 
 struct OsmBlob {
@@ -114,6 +290,17 @@ struct FileBlock {
 	}
 };
 
+//! Keeps a block alive for as long as the string vectors that reference its string table
+class FileBlockBuffer final : public VectorBuffer {
+public:
+	explicit FileBlockBuffer(shared_ptr<FileBlock> block_p)
+	    : VectorBuffer(VectorBufferType::OPAQUE_BUFFER), block(std::move(block_p)) {
+	}
+
+private:
+	shared_ptr<FileBlock> block;
+};
+
 static unique_ptr<FileBlock> DecompressBlob(ClientContext &context, OsmBlob &blob) {
 
 	auto &buffer_manager = BufferManager::GetBufferManager(context);
@@ -147,6 +334,105 @@ static unique_ptr<FileBlock> DecompressBlob(ClientContext &context, OsmBlob &blo
 	return make_uniq<FileBlock>(blob.type, std::move(uncompressed_handle), blob_uncompressed_size, blob.blob_idx);
 };
 
+//------------------------------------------------------------------------------
+// Node Locations
+//------------------------------------------------------------------------------
+
+struct NodeLocation {
+	int64_t id;
+	//! In units of 1e-7 degrees, the precision of the OSM database itself
+	int32_t lon;
+	int32_t lat;
+};
+
+static int32_t ToFixedLocation(int64_t nanodegrees) {
+	return static_cast<int32_t>((nanodegrees + (nanodegrees < 0 ? -50 : 50)) / 100);
+}
+
+//! A cursor into the location index, keeping the block of the last lookup pinned
+struct NodeLocationCursor {
+	idx_t block_idx = DConstants::INVALID_INDEX;
+	BufferHandle handle;
+	const NodeLocation *begin = nullptr;
+	const NodeLocation *end = nullptr;
+};
+
+//! An id -> location index of all nodes in a file, used to assemble way geometries. The locations are stored sorted
+//! by id in buffer managed blocks, so they can be spilled to disk if they do not fit in memory.
+class NodeLocationIndex {
+public:
+	explicit NodeLocationIndex(BufferManager &manager) : locations(manager) {
+		locations.InitializeAppend(append_state);
+	}
+
+	void Append(int64_t id, int64_t lon_nanodegrees, int64_t lat_nanodegrees) {
+		if (locations.Count() != 0 && id <= last_id) {
+			throw InvalidInputException("ST_ReadOSM: 'geometry := true' requires the nodes in the file to be sorted by "
+			                            "id (e.g. with 'osmium sort'), but node %lld follows node %lld",
+			                            id, last_id);
+		}
+		last_id = id;
+
+		const NodeLocation location = {id, ToFixedLocation(lon_nanodegrees), ToFixedLocation(lat_nanodegrees)};
+		locations.Append(append_state, location);
+
+		// Keep track of the first id in each block, to find the block of an id
+		if (locations.BlockCount() > block_first_ids.size()) {
+			block_first_ids.push_back(id);
+		}
+	}
+
+	//! Finish appending, unpinning the last block
+	void Finalize() {
+		append_state = ManagedCollectionAppendState();
+	}
+
+	idx_t Count() const {
+		return locations.Count();
+	}
+
+	//! Look up the location of a node. Lookups of nearby ids (as the refs of a way usually are) reuse the pinned block
+	bool TryGet(NodeLocationCursor &cursor, int64_t id, double &lon, double &lat) {
+		if (cursor.begin == cursor.end || id < cursor.begin->id || id > (cursor.end - 1)->id) {
+			const auto entry = std::upper_bound(block_first_ids.begin(), block_first_ids.end(), id);
+			if (entry == block_first_ids.begin()) {
+				return false;
+			}
+			const auto block_idx = static_cast<idx_t>(entry - block_first_ids.begin()) - 1;
+			if (block_idx != cursor.block_idx) {
+				idx_t item_count;
+				cursor.handle = locations.PinBlock(block_idx, item_count);
+				cursor.block_idx = block_idx;
+				cursor.begin = reinterpret_cast<const NodeLocation *>(cursor.handle.Ptr());
+				cursor.end = cursor.begin + item_count;
+			}
+		}
+
+		const auto location = std::lower_bound(cursor.begin, cursor.end, id,
+		                                       [](const NodeLocation &loc, int64_t key) { return loc.id < key; });
+		if (location == cursor.end || location->id != id) {
+			return false;
+		}
+		lon = 0.0000001 * location->lon;
+		lat = 0.0000001 * location->lat;
+		return true;
+	}
+
+private:
+	ManagedCollection<NodeLocation> locations;
+	ManagedCollectionAppendState append_state;
+	vector<int64_t> block_first_ids;
+	int64_t last_id = 0;
+};
+
+//! The location of a blob in the file
+struct OsmBlobRange {
+	FileBlockType type;
+	idx_t offset;
+	idx_t size;
+	idx_t blob_idx;
+};
+
 class GlobalState final : public GlobalTableFunctionState {
 	mutex lock;
 	unique_ptr<FileHandle> handle;
@@ -171,71 +457,240 @@ public:
 		return max_threads;
 	}
 
-	unique_ptr<OsmBlob> GetNextBlob(ClientContext &context) {
+	//! Claim the next blob of the file. Only the (small) BlobHeader is read while holding the lock, the blob itself is
+	//! read afterwards by the thread that claimed it.
+	bool GetNextBlobRange(ClientContext &context, OsmBlobRange &range) {
 		lock_guard<mutex> glock(lock);
 
 		if (done) {
-			return nullptr;
+			return false;
 		}
 		if (offset >= file_size) {
 			done = true;
-			return nullptr;
+			return false;
 		}
 
-		auto &buffer_manager = BufferManager::GetBufferManager(context);
-
 		// The format is a repeating sequence of:
 		//    int4: length of the BlobHeader message in network byte order
 		//    serialized BlobHeader message
 		//    serialized Blob message (size is given in the header)
 
-		// Read the length of the BlobHeader
-		int32_t header_length_be = 0;
-		handle->Read((data_ptr_t)&header_length_be, sizeof(int32_t), offset);
+		// Read the length of the BlobHeader, and speculatively the BlobHeader itself, in a single read
+		static constexpr idx_t HEADER_READ_AHEAD = 64;
+		data_t prefix[sizeof(int32_t) + HEADER_READ_AHEAD];
+		const auto prefix_size = MinValue<idx_t>(sizeof(prefix), file_size - offset);
+		if (prefix_size < sizeof(int32_t)) {
+			throw ParserException("Unexpected end of file while reading BlobHeader");
+		}
+		handle->Read(prefix, prefix_size, offset);
 		offset += sizeof(int32_t);
-		int32_t header_length = ReadInt32BigEndian((data_ptr_t)&header_length_be);
+		const auto header_length = ReadInt32BigEndian(prefix);
+		if (header_length < 0 || offset + header_length > file_size) {
+			throw ParserException("Invalid BlobHeader length");
+		}
 
-		// Read the BlobHeader
-		auto header_buffer = buffer_manager.GetBufferAllocator().Allocate(header_length);
-		handle->Read(header_buffer.get(), header_length, offset);
+		// Read the rest of the BlobHeader, if it did not fit
+		const auto prefetched = prefix_size - sizeof(int32_t);
+		AllocatedData header_buffer;
+		auto header_ptr = prefix + sizeof(int32_t);
+		if (static_cast<idx_t>(header_length) > prefetched) {
+			auto &buffer_manager = BufferManager::GetBufferManager(context);
+			header_buffer = buffer_manager.GetBufferAllocator().Allocate(header_length);
+			memcpy(header_buffer.get(), header_ptr, prefetched);
+			handle->Read(header_buffer.get() + prefetched, header_length - prefetched, offset + prefetched);
+			header_ptr = header_buffer.get();
+		}
 
-		pz::pbf_reader reader((const char *)header_buffer.get(), header_length);
+		pz::pbf_reader reader((const char *)header_ptr, header_length);
 
 		// 1 - type of the blob
 		reader.next(1);
 		auto type_str = reader.get_string();
-		FileBlockType type;
 		if (type_str == "OSMHeader") {
-			type = FileBlockType::Header;
+			range.type = FileBlockType::Header;
 		} else if (type_str == "OSMData") {
-			type = FileBlockType::Data;
+			range.type = FileBlockType::Data;
 		} else {
 			throw ParserException("Unexpected fileblock type in Blob");
 		}
 		// 3 - size of the next blob
 		reader.next(3);
-		auto blob_length = reader.get_int32(); // size of the next blob
+		const auto blob_length = reader.get_int32(); // size of the next blob
 
 		offset += header_length;
 
-		// Read the Blob
-		auto blob_buffer = buffer_manager.GetBufferAllocator().Allocate(blob_length);
-		handle->Read(blob_buffer.get(), blob_length, offset);
+		range.offset = offset;
+		range.size = blob_length;
+		range.blob_idx = blob_index++;
 
 		offset += blob_length;
-		bytes_read = offset;
+		return true;
+	}
+
+	//! Read the next blob using the given handle. Each thread has its own handle, so reads happen in parallel.
+	unique_ptr<OsmBlob> GetNextBlob(ClientContext &context, FileHandle &blob_handle) {
+		OsmBlobRange range;
+		if (!GetNextBlobRange(context, range)) {
+			return nullptr;
+		}
+
+		// Read the Blob
+		auto &buffer_manager = BufferManager::GetBufferManager(context);
+		auto blob_buffer = buffer_manager.GetBufferAllocator().Allocate(range.size);
+		blob_handle.Read(blob_buffer.get(), range.size, range.offset);
+
+		bytes_read += range.size;
+
+		return make_uniq<OsmBlob>(range.type, std::move(blob_buffer), range.size, range.blob_idx);
+	}
 
-		return make_uniq<OsmBlob>(type, std::move(blob_buffer), blob_length, blob_index++);
+	unique_ptr<OsmBlob> GetNextBlob(ClientContext &context) {
+		return GetNextBlob(context, *handle);
 	}
+
+	//! The node locations, if way geometries are assembled
+	unique_ptr<NodeLocationIndex> locations;
 };
 
+static unique_ptr<FileHandle> OpenFile(ClientContext &context, const string &file_name) {
+	auto &fs = FileSystem::GetFileSystem(context);
+	return fs.OpenFile(file_name, FileFlags::FILE_FLAGS_READ | FileLockType::READ_LOCK);
+}
+
+//! Add the locations of all nodes in a block to the index. Returns false if the block contains other entities too.
+static bool ReadBlockNodeLocations(const FileBlock &block, NodeLocationIndex &index) {
+	pz::pbf_reader block_reader(reinterpret_cast<const char *>(block.data.get()), block.size);
+
+	int32_t granularity = 100;
+	int64_t lat_offset = 0;
+	int64_t lon_offset = 0;
+
+	auto reader_copy = block_reader;
+	while (reader_copy.next()) {
+		switch (reader_copy.tag()) {
+		case 17:
+			granularity = reader_copy.get_int32();
+			break;
+		case 19:
+			lat_offset = reader_copy.get_int64();
+			break;
+		case 20:
+			lon_offset = reader_copy.get_int64();
+			break;
+		default:
+			reader_copy.skip();
+		}
+	}
+
+	bool only_nodes = true;
+	while (block_reader.next(2)) {
+		auto group_reader = block_reader.get_message();
+		while (group_reader.next()) {
+			switch (group_reader.tag()) {
+			case 1: { // Node
+				auto node = group_reader.get_message();
+				int64_t id = 0;
+				int64_t lat = 0;
+				int64_t lon = 0;
+				while (node.next()) {
+					switch (node.tag()) {
+					case 1:
+						id = node.get_sint64();
+						break;
+					case 8:
+						lat = node.get_sint64();
+						break;
+					case 9:
+						lon = node.get_sint64();
+						break;
+					default:
+						node.skip();
+					}
+				}
+				index.Append(id, lon_offset + granularity * lon, lat_offset + granularity * lat);
+			} break;
+			case 2: { // Dense nodes
+				auto dense_nodes = group_reader.get_message();
+				DeltaVarintReader ids;
+				DeltaVarintReader lats;
+				DeltaVarintReader lons;
+				while (dense_nodes.next()) {
+					switch (dense_nodes.tag()) {
+					case 1:
+						ids = DeltaVarintReader(dense_nodes.get_view());
+						break;
+					case 8:
+						lats = DeltaVarintReader(dense_nodes.get_view());
+						break;
+					case 9:
+						lons = DeltaVarintReader(dense_nodes.get_view());
+						break;
+					default:
+						dense_nodes.skip();
+					}
+				}
+				if (ids.Count() != lats.Count() || ids.Count() != lons.Count()) {
+					throw ParserException("Invalid DenseNodes, the number of ids and locations differ");
+				}
+				for (idx_t i = 0; i < ids.Count(); i++) {
+					const auto id = ids.Next();
+					const auto lat = lats.Next();
+					const auto lon = lons.Next();
+					index.Append(id, lon_offset + granularity * lon, lat_offset + granularity * lat);
+				}
+			} break;
+			default:
+				only_nodes = false;
+				group_reader.skip();
+			}
+		}
+	}
+	return only_nodes;
+}
+
+//! Read the locations of all nodes in the file, in a separate pass before the file is scanned
+static unique_ptr<NodeLocationIndex> ReadNodeLocations(ClientContext &context, const string &file_name) {
+	auto handle = OpenFile(context, file_name);
+	auto file_size = handle->GetFileSize();
+	GlobalState reader(std::move(handle), file_size, 1);
+
+	auto header_blob = reader.GetNextBlob(context);
+	if (!header_blob || header_blob->type != FileBlockType::Header) {
+		throw ParserException("First blob in file is not a header");
+	}
+
+	// If the file is sorted by type, all nodes come first and we can stop at the first block with other entities
+	bool sorted_by_type = false;
+	const auto header_block = DecompressBlob(context, *header_blob);
+	pz::pbf_reader header_reader(reinterpret_cast<const char *>(header_block->data.get()), header_block->size);
+	while (header_reader.next(5)) { // Optional features
+		if (header_reader.get_string() == "Sort.Type_then_ID") {
+			sorted_by_type = true;
+		}
+	}
+
+	auto result = make_uniq<NodeLocationIndex>(BufferManager::GetBufferManager(context));
+	while (true) {
+		auto blob = reader.GetNextBlob(context);
+		if (!blob) {
+			break;
+		}
+		if (blob->type != FileBlockType::Data) {
+			continue;
+		}
+		const auto block = DecompressBlob(context, *blob);
+		if (!ReadBlockNodeLocations(*block, *result) && sorted_by_type) {
+			break;
+		}
+	}
+	result->Finalize();
+	return result;
+}
+
 static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
 	auto &bind_data = (BindData &)*input.bind_data;
 
-	auto &fs = FileSystem::GetFileSystem(context);
-	auto file_name = bind_data.file_name;
-
-	auto handle = fs.OpenFile(file_name, FileFlags::FILE_FLAGS_READ | FileLockType::READ_LOCK);
+	auto handle = OpenFile(context, bind_data.file_name);
 	auto file_size = handle->GetFileSize();
 
 	auto max_threads = context.db->NumberOfThreads();
@@ -248,12 +703,125 @@ static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, T
 		throw ParserException("First blob in file is not a header");
 	}
 
+	// Way geometries are assembled from the node locations, which have to be read up front
+	for (const auto column_id : input.column_ids) {
+		if (column_id == static_cast<idx_t>(OsmColumn::GEOMETRY)) {
+			global_state->locations = ReadNodeLocations(context, bind_data.file_name);
+		}
+	}
+
 	return std::move(global_state);
 }
 
 struct LocalState final : LocalTableFunctionState {
-	unique_ptr<FileBlock> block;
-	vector<string> string_table;
+	//! The handle to read blobs with, separate from the other threads
+	unique_ptr<FileHandle> handle;
+	shared_ptr<FileBlock> block;
+	//! References the current block from the output vectors, as the string table points into it
+	buffer_ptr<VectorBuffer> block_buffer;
+
+	//! The output vector of each column, or a scratch vector if the column is not projected
+	Vector *columns[static_cast<idx_t>(OsmColumn::COUNT)];
+	DataChunk scratch;
+	vector<idx_t> column_ids;
+	//! Whether the expensive (nested) columns are projected, they are not decoded otherwise
+	bool project_tags = true;
+	bool project_refs = true;
+	bool project_ref_roles = true;
+	bool project_ref_types = true;
+	bool project_geometry = false;
+	bool scan_kind[static_cast<idx_t>(OsmKind::COUNT)] = {true, true, true, true};
+
+	void InitColumns(ClientContext &context, const BindData &bind_data, const vector<column_t> &column_ids_p) {
+		column_ids = column_ids_p;
+		scratch.Initialize(context, bind_data.types);
+		project_tags = project_refs = project_ref_roles = project_ref_types = false;
+		for (const auto column_id : column_ids) {
+			project_tags |= column_id == static_cast<idx_t>(OsmColumn::TAGS);
+			project_refs |= column_id == static_cast<idx_t>(OsmColumn::REFS);
+			project_ref_roles |= column_id == static_cast<idx_t>(OsmColumn::REF_ROLES);
+			project_ref_types |= column_id == static_cast<idx_t>(OsmColumn::REF_TYPES);
+			project_geometry |= column_id == static_cast<idx_t>(OsmColumn::GEOMETRY);
+		}
+		for (idx_t i = 0; i < static_cast<idx_t>(OsmKind::COUNT); i++) {
+			scan_kind[i] = bind_data.scan_kind[i];
+		}
+	}
+
+	//! Point the columns at the output, before scanning into it
+	void SetOutput(DataChunk &output) {
+		scratch.Reset();
+		for (idx_t i = 0; i < static_cast<idx_t>(OsmColumn::COUNT); i++) {
+			columns[i] = i < scratch.ColumnCount() ? &scratch.data[i] : nullptr;
+		}
+		for (idx_t i = 0; i < column_ids.size(); i++) {
+			if (column_ids[i] < static_cast<idx_t>(OsmColumn::COUNT)) {
+				columns[column_ids[i]] = &output.data[i];
+			}
+		}
+		ReferenceBlock();
+	}
+
+	//! Keep the current block alive for the strings that are emitted from its string table
+	void ReferenceBlock() {
+		auto &tags = Column(OsmColumn::TAGS);
+		StringVector::AddBuffer(MapVector::GetKeys(tags), block_buffer);
+		StringVector::AddBuffer(MapVector::GetValues(tags), block_buffer);
+		StringVector::AddBuffer(ListVector::GetEntry(Column(OsmColumn::REF_ROLES)), block_buffer);
+	}
+
+	Vector &Column(OsmColumn column) {
+		return *columns[static_cast<idx_t>(column)];
+	}
+
+	//! The node locations to assemble way geometries from
+	optional_ptr<NodeLocationIndex> locations;
+	NodeLocationCursor location_cursor;
+	vector<double> vertices;
+
+	void SetGeometry(idx_t index, const sgl::geometry &geom) {
+		auto &result = Column(OsmColumn::GEOMETRY);
+		const auto size = Serde::GetRequiredSize(geom);
+		auto blob = StringVector::EmptyString(result, size);
+		Serde::Serialize(geom, blob.GetDataWriteable(), size);
+		blob.Finalize();
+		FlatVector::GetData<string_t>(result)[index] = blob;
+	}
+
+	void SetPointGeometry(idx_t index, double lon, double lat) {
+		const double vertex[2] = {lon, lat};
+		sgl::geometry point(sgl::geometry_type::POINT);
+		point.set_vertex_data(reinterpret_cast<const uint8_t *>(vertex), 1);
+		SetGeometry(index, point);
+	}
+
+	//! Assemble the linestring of a way from the locations of its nodes. Ways that reference nodes missing from the
+	//! file (e.g. at the border of an extract) get no geometry.
+	void SetWayGeometry(idx_t index, const pz::iterator_range<pz::const_svarint_iterator<int64_t>> &refs) {
+		vertices.clear();
+		int64_t ref = 0;
+		for (auto ref_delta : refs) {
+			ref += ref_delta;
+			double lon;
+			double lat;
+			if (!locations->TryGet(location_cursor, ref, lon, lat)) {
+				FlatVector::SetNull(Column(OsmColumn::GEOMETRY), index, true);
+				return;
+			}
+			vertices.push_back(lon);
+			vertices.push_back(lat);
+		}
+		if (vertices.size() < 4) {
+			FlatVector::SetNull(Column(OsmColumn::GEOMETRY), index, true);
+			return;
+		}
+		sgl::geometry line(sgl::geometry_type::LINESTRING);
+		line.set_vertex_data(reinterpret_cast<const uint8_t *>(vertices.data()), vertices.size() / 2);
+		SetGeometry(index, line);
+	}
+
+	//! The strings of the block, pointing into the block data
+	vector<string_t> string_table;
 	int32_t granularity;
 	int64_t lat_offset;
 	int64_t lon_offset;
@@ -262,13 +830,16 @@ struct LocalState final : LocalTableFunctionState {
 		Reset();
 	}
 
+	//! Continue with the next block. Must only be called while scanning into an output chunk
 	void SetBlock(unique_ptr<FileBlock> block) {
 		this->block = std::move(block);
 		Reset();
+		ReferenceBlock();
 	}
 
 	void Reset() {
 		string_table.clear();
+		block_buffer = make_buffer<FileBlockBuffer>(block);
 		granularity = 100;
 		lat_offset = 0;
 		lon_offset = 0;
@@ -277,7 +848,8 @@ struct LocalState final : LocalTableFunctionState {
 		block_reader.next(1); // String table
 		auto string_table_reader = block_reader.get_message();
 		while (string_table_reader.next(1)) {
-			string_table.push_back(string_table_reader.get_string());
+			const auto view = string_table_reader.get_view();
+			string_table.emplace_back(view.data(), static_cast<uint32_t>(view.size()));
 		}
 
 		// Need to read ahead without advancing block_reader
@@ -301,11 +873,13 @@ struct LocalState final : LocalTableFunctionState {
 	pz::pbf_reader group_reader;
 
 	idx_t dense_node_index;
-	vector<int64_t> dense_node_ids;
+	idx_t dense_node_count;
+	//! The ids and coordinates are decoded as the nodes are written to the output
+	DeltaVarintReader dense_node_ids;
+	DeltaVarintReader dense_node_lats;
+	DeltaVarintReader dense_node_lons;
 	vector<uint32_t> dense_node_tags;
 	vector<list_entry_t> dense_node_tag_entries;
-	vector<int64_t> dense_node_lats;
-	vector<int64_t> dense_node_lons;
 
 	enum class ParseState { Block, Group, DenseNodes, End };
 
@@ -330,19 +904,35 @@ struct LocalState final : LocalTableFunctionState {
 					switch (group_reader.tag()) {
 						// Nodes
 					case 1: {
+						if (!scan_kind[static_cast<idx_t>(OsmKind::NODE)]) {
+							group_reader.skip();
+							break;
+						}
 						ScanNode(output, index, capacity);
 					} break;
 						// Dense nodes
 					case 2: {
+						if (!scan_kind[static_cast<idx_t>(OsmKind::NODE)]) {
+							group_reader.skip();
+							break;
+						}
 						PrepareDenseNodes(output, index, capacity);
 						state = ParseState::DenseNodes;
 					} break;
 						// Way
 					case 3: {
+						if (!scan_kind[static_cast<idx_t>(OsmKind::WAY)]) {
+							group_reader.skip();
+							break;
+						}
 						ScanWay(output, index, capacity);
 					} break;
 						// Relation
 					case 4: {
+						if (!scan_kind[static_cast<idx_t>(OsmKind::RELATION)]) {
+							group_reader.skip();
+							break;
+						}
 						ScanRelation(output, index, capacity);
 					} break;
 						// Changeset
@@ -383,8 +973,8 @@ struct LocalState final : LocalTableFunctionState {
 			switch (node.tag()) {
 			case 1: { // ID
 				auto id = node.get_int64();
-				FlatVector::GetData<uint8_t>(output.data[0])[index] = 0;
-				FlatVector::GetData<int64_t>(output.data[1])[index] = id;
+				FlatVector::GetData<uint8_t>(Column(OsmColumn::KIND))[index] = 0;
+				FlatVector::GetData<int64_t>(Column(OsmColumn::ID))[index] = id;
 			} break;
 			case 2: { // Tag Keys
 				key_iter = node.get_packed_uint32();
@@ -394,11 +984,13 @@ struct LocalState final : LocalTableFunctionState {
 			} break;
 			case 8: { // Lat
 				auto lat = node.get_sint64();
-				FlatVector::GetData<double>(output.data[4])[index] = 0.000000001 * (lat_offset + (granularity * lat));
+				FlatVector::GetData<double>(Column(OsmColumn::LAT))[index] =
+				    0.000000001 * (lat_offset + (granularity * lat));
 			} break;
 			case 9: { // Lon
 				auto lon = node.get_sint64();
-				FlatVector::GetData<double>(output.data[5])[index] = 0.000000001 * (lon_offset + (granularity * lon));
+				FlatVector::GetData<double>(Column(OsmColumn::LON))[index] =
+				    0.000000001 * (lon_offset + (granularity * lon));
 			} break;
 			default:
 				node.skip();
@@ -406,76 +998,68 @@ struct LocalState final : LocalTableFunctionState {
 		}
 
 		// Read tags
-		if (!key_iter.empty() && !val_iter.empty()) {
+		if (project_tags && !key_iter.empty() && !val_iter.empty()) {
 			auto tag_count = key_iter.size();
-			auto total_tags = ListVector::GetListSize(output.data[2]);
-			ListVector::Reserve(output.data[2], total_tags + tag_count);
-			ListVector::SetListSize(output.data[2], total_tags + tag_count);
-			auto &tag_entry = ListVector::GetData(output.data[2])[index];
+			auto total_tags = ListVector::GetListSize(Column(OsmColumn::TAGS));
+			ListVector::Reserve(Column(OsmColumn::TAGS), total_tags + tag_count);
+			ListVector::SetListSize(Column(OsmColumn::TAGS), total_tags + tag_count);
+			auto &tag_entry = ListVector::GetData(Column(OsmColumn::TAGS))[index];
 
 			tag_entry.offset = total_tags;
 			tag_entry.length = tag_count;
 
-			auto &key_vector = MapVector::GetKeys(output.data[2]);
-			auto &value_vector = MapVector::GetValues(output.data[2]);
+			auto &key_vector = MapVector::GetKeys(Column(OsmColumn::TAGS));
+			auto &value_vector = MapVector::GetValues(Column(OsmColumn::TAGS));
 
 			auto keys = key_iter.begin();
 			auto vals = val_iter.begin();
 			for (idx_t i = tag_entry.offset; i < tag_entry.offset + tag_count; i++) {
-				FlatVector::GetData<string_t>(key_vector)[i] =
-				    StringVector::AddString(key_vector, string_table[*keys++]);
-				FlatVector::GetData<string_t>(value_vector)[i] =
-				    StringVector::AddString(value_vector, string_table[*vals++]);
+				FlatVector::GetData<string_t>(key_vector)[i] = string_table[*keys++];
+				FlatVector::GetData<string_t>(value_vector)[i] = string_table[*vals++];
 			}
 		} else {
-			FlatVector::SetNull(output.data[2], index, true);
+			FlatVector::SetNull(Column(OsmColumn::TAGS), index, true);
 		}
 
 		// Node has no refs, ref_roles or ref_types
-		FlatVector::SetNull(output.data[3], index, true);
-		FlatVector::SetNull(output.data[6], index, true);
-		FlatVector::SetNull(output.data[7], index, true);
+		FlatVector::SetNull(Column(OsmColumn::REFS), index, true);
+		FlatVector::SetNull(Column(OsmColumn::REF_ROLES), index, true);
+		FlatVector::SetNull(Column(OsmColumn::REF_TYPES), index, true);
+
+		if (project_geometry) {
+			SetPointGeometry(index, FlatVector::GetData<double>(Column(OsmColumn::LON))[index],
+			                 FlatVector::GetData<double>(Column(OsmColumn::LAT))[index]);
+		}
 
 		index++;
 	}
 
 	void PrepareDenseNodes(DataChunk &output, idx_t &index, idx_t capacity) {
 		dense_node_index = 0;
-		dense_node_ids.clear();
+		dense_node_ids = DeltaVarintReader();
+		dense_node_lats = DeltaVarintReader();
+		dense_node_lons = DeltaVarintReader();
 		dense_node_tags.clear();
 		dense_node_tag_entries.clear();
-		dense_node_lats.clear();
-		dense_node_lons.clear();
 
 		auto dense_nodes = group_reader.get_message();
 
 		while (dense_nodes.next()) {
 			switch (dense_nodes.tag()) {
 			case 1: { // ID
-				auto ids = dense_nodes.get_packed_sint64();
-				int64_t last_id = 0;
-				for (auto id : ids) {
-					last_id += id;
-					dense_node_ids.push_back(last_id);
-				}
+				dense_node_ids = DeltaVarintReader(dense_nodes.get_view());
 			} break;
 			case 8: { // Lats
-				auto lats = dense_nodes.get_packed_sint64();
-				int64_t last_lat = 0;
-				for (auto lat : lats) {
-					last_lat += lat;
-					dense_node_lats.push_back(last_lat);
-				}
+				dense_node_lats = DeltaVarintReader(dense_nodes.get_view());
 			} break;
 			case 9: { // Lons
-				auto lons = dense_nodes.get_packed_sint64();
-				int64_t last_lon = 0;
-				for (auto lon : lons) {
-					last_lon += lon;
-					dense_node_lons.push_back(last_lon);
-				}
+				dense_node_lons = DeltaVarintReader(dense_nodes.get_view());
 			} break;
 			case 10: { // Tags
+				if (!project_tags) {
+					dense_nodes.skip();
+					break;
+				}
 				auto tags = dense_nodes.get_packed_uint32();
 				idx_t entry_offset = 0;
 				for (auto tag : tags) {
@@ -492,6 +1076,14 @@ struct LocalState final : LocalTableFunctionState {
 				dense_nodes.skip();
 			}
 		}
+
+		dense_node_count = dense_node_ids.Count();
+		if (dense_node_lats.Count() != dense_node_count || dense_node_lons.Count() != dense_node_count) {
+			throw ParserException("Invalid DenseNodes, the number of ids and locations differ");
+		}
+		if (!dense_node_tags.empty() && dense_node_tag_entries.size() < dense_node_count) {
+			throw ParserException("Invalid DenseNodes, the number of ids and tags differ");
+		}
 	}
 
 	void ScanWay(DataChunk &output, idx_t &index, idx_t capacity) {
@@ -505,12 +1097,12 @@ struct LocalState final : LocalTableFunctionState {
 			switch (way.tag()) {
 			case 1: { // ID
 				auto id = way.get_int64();
-				FlatVector::GetData<uint8_t>(output.data[0])[index] = 1;
-				FlatVector::GetData<int64_t>(output.data[1])[index] = id;
-				FlatVector::SetNull(output.data[4], index, true);
-				FlatVector::SetNull(output.data[5], index, true);
-				FlatVector::SetNull(output.data[6], index, true);
-				FlatVector::SetNull(output.data[7], index, true);
+				FlatVector::GetData<uint8_t>(Column(OsmColumn::KIND))[index] = 1;
+				FlatVector::GetData<int64_t>(Column(OsmColumn::ID))[index] = id;
+				FlatVector::SetNull(Column(OsmColumn::LAT), index, true);
+				FlatVector::SetNull(Column(OsmColumn::LON), index, true);
+				FlatVector::SetNull(Column(OsmColumn::REF_ROLES), index, true);
+				FlatVector::SetNull(Column(OsmColumn::REF_TYPES), index, true);
 			} break;
 			case 2: { // Tag Keys
 				key_iter = way.get_packed_uint32();
@@ -525,38 +1117,36 @@ struct LocalState final : LocalTableFunctionState {
 				way.skip();
 			}
 		}
-		if (!key_iter.empty() && !val_iter.empty()) {
+		if (project_tags && !key_iter.empty() && !val_iter.empty()) {
 			auto tag_count = key_iter.size();
-			auto total_tags = ListVector::GetListSize(output.data[2]);
-			ListVector::Reserve(output.data[2], total_tags + tag_count);
-			ListVector::SetListSize(output.data[2], total_tags + tag_count);
-			auto &tag_entry = ListVector::GetData(output.data[2])[index];
+			auto total_tags = ListVector::GetListSize(Column(OsmColumn::TAGS));
+			ListVector::Reserve(Column(OsmColumn::TAGS), total_tags + tag_count);
+			ListVector::SetListSize(Column(OsmColumn::TAGS), total_tags + tag_count);
+			auto &tag_entry = ListVector::GetData(Column(OsmColumn::TAGS))[index];
 
 			tag_entry.offset = total_tags;
 			tag_entry.length = tag_count;
 
-			auto &key_vector = MapVector::GetKeys(output.data[2]);
-			auto &value_vector = MapVector::GetValues(output.data[2]);
+			auto &key_vector = MapVector::GetKeys(Column(OsmColumn::TAGS));
+			auto &value_vector = MapVector::GetValues(Column(OsmColumn::TAGS));
 
 			auto keys = key_iter.begin();
 			auto vals = val_iter.begin();
 			for (idx_t i = tag_entry.offset; i < tag_entry.offset + tag_count; i++) {
-				FlatVector::GetData<string_t>(key_vector)[i] =
-				    StringVector::AddString(key_vector, string_table[*keys++]);
-				FlatVector::GetData<string_t>(value_vector)[i] =
-				    StringVector::AddString(value_vector, string_table[*vals++]);
+				FlatVector::GetData<string_t>(key_vector)[i] = string_table[*keys++];
+				FlatVector::GetData<string_t>(value_vector)[i] = string_table[*vals++];
 			}
 		} else {
-			FlatVector::SetNull(output.data[2], index, true);
+			FlatVector::SetNull(Column(OsmColumn::TAGS), index, true);
 		}
 
-		if (!ref_iter.empty()) {
+		if (project_refs && !ref_iter.empty()) {
 			auto ref_count = ref_iter.size();
-			auto total_refs = ListVector::GetListSize(output.data[3]);
-			ListVector::Reserve(output.data[3], total_refs + ref_count);
-			ListVector::SetListSize(output.data[3], total_refs + ref_count);
-			auto &ref_entry = ListVector::GetData(output.data[3])[index];
-			auto &ref_vector = ListVector::GetEntry(output.data[3]);
+			auto total_refs = ListVector::GetListSize(Column(OsmColumn::REFS));
+			ListVector::Reserve(Column(OsmColumn::REFS), total_refs + ref_count);
+			ListVector::SetListSize(Column(OsmColumn::REFS), total_refs + ref_count);
+			auto &ref_entry = ListVector::GetData(Column(OsmColumn::REFS))[index];
+			auto &ref_vector = ListVector::GetEntry(Column(OsmColumn::REFS));
 			ref_entry.offset = total_refs;
 			ref_entry.length = ref_count;
 
@@ -568,7 +1158,11 @@ struct LocalState final : LocalTableFunctionState {
 				ref_data[total_refs++] = last_ref;
 			}
 		} else {
-			FlatVector::SetNull(output.data[3], index, true);
+			FlatVector::SetNull(Column(OsmColumn::REFS), index, true);
+		}
+
+		if (project_geometry) {
+			SetWayGeometry(index, ref_iter);
 		}
 
 		index++;
@@ -587,10 +1181,10 @@ struct LocalState final : LocalTableFunctionState {
 			switch (relation.tag()) {
 			case 1: { // ID
 				auto id = relation.get_int64();
-				FlatVector::GetData<uint8_t>(output.data[0])[index] = 2;
-				FlatVector::GetData<int64_t>(output.data[1])[index] = id;
-				FlatVector::SetNull(output.data[4], index, true);
-				FlatVector::SetNull(output.data[5], index, true);
+				FlatVector::GetData<uint8_t>(Column(OsmColumn::KIND))[index] = 2;
+				FlatVector::GetData<int64_t>(Column(OsmColumn::ID))[index] = id;
+				FlatVector::SetNull(Column(OsmColumn::LAT), index, true);
+				FlatVector::SetNull(Column(OsmColumn::LON), index, true);
 			} break;
 			case 2: { // Tag Keys
 				key_iter = relation.get_packed_uint32();
@@ -613,66 +1207,64 @@ struct LocalState final : LocalTableFunctionState {
 		}
 
 		// Read tags
-		if (!key_iter.empty() && !val_iter.empty()) {
+		if (project_tags && !key_iter.empty() && !val_iter.empty()) {
 			auto tag_count = key_iter.size();
 
-			auto total_tags = ListVector::GetListSize(output.data[2]);
-			ListVector::Reserve(output.data[2], total_tags + tag_count);
-			ListVector::SetListSize(output.data[2], total_tags + tag_count);
-			auto &tag_entry = ListVector::GetData(output.data[2])[index];
+			auto total_tags = ListVector::GetListSize(Column(OsmColumn::TAGS));
+			ListVector::Reserve(Column(OsmColumn::TAGS), total_tags + tag_count);
+			ListVector::SetListSize(Column(OsmColumn::TAGS), total_tags + tag_count);
+			auto &tag_entry = ListVector::GetData(Column(OsmColumn::TAGS))[index];
 
 			tag_entry.offset = total_tags;
 			tag_entry.length = tag_count;
 
-			auto &key_vector = MapVector::GetKeys(output.data[2]);
-			auto &value_vector = MapVector::GetValues(output.data[2]);
+			auto &key_vector = MapVector::GetKeys(Column(OsmColumn::TAGS));
+			auto &value_vector = MapVector::GetValues(Column(OsmColumn::TAGS));
 
 			auto keys = key_iter.begin();
 			auto vals = val_iter.begin();
 			for (idx_t i = tag_entry.offset; i < tag_entry.offset + tag_count; i++) {
-				FlatVector::GetData<string_t>(key_vector)[i] =
-				    StringVector::AddString(key_vector, string_table[*keys++]);
-				FlatVector::GetData<string_t>(value_vector)[i] =
-				    StringVector::AddString(value_vector, string_table[*vals++]);
+				FlatVector::GetData<string_t>(key_vector)[i] = string_table[*keys++];
+				FlatVector::GetData<string_t>(value_vector)[i] = string_table[*vals++];
 			}
 		} else {
-			FlatVector::SetNull(output.data[2], index, true);
+			FlatVector::SetNull(Column(OsmColumn::TAGS), index, true);
 		}
 
 		// Roles
-		if (!role_iter.empty()) {
+		if (project_ref_roles && !role_iter.empty()) {
 			auto role_count = role_iter.size();
 
-			auto total_roles = ListVector::GetListSize(output.data[6]);
-			ListVector::Reserve(output.data[6], total_roles + role_count);
-			ListVector::SetListSize(output.data[6], total_roles + role_count);
-			auto &role_entry = ListVector::GetData(output.data[6])[index];
-			auto &role_vector = ListVector::GetEntry(output.data[6]);
+			auto total_roles = ListVector::GetListSize(Column(OsmColumn::REF_ROLES));
+			ListVector::Reserve(Column(OsmColumn::REF_ROLES), total_roles + role_count);
+			ListVector::SetListSize(Column(OsmColumn::REF_ROLES), total_roles + role_count);
+			auto &role_entry = ListVector::GetData(Column(OsmColumn::REF_ROLES))[index];
+			auto &role_vector = ListVector::GetEntry(Column(OsmColumn::REF_ROLES));
 			role_entry.offset = total_roles;
 			role_entry.length = role_count;
 
 			auto roles = role_iter.begin();
 			for (idx_t i = role_entry.offset; i < role_entry.offset + role_count; i++) {
 				auto &role_str = string_table[*roles++];
-				if (role_str.empty()) {
+				if (role_str.GetSize() == 0) {
 					FlatVector::SetNull(role_vector, i, true);
 				} else {
-					FlatVector::GetData<string_t>(role_vector)[i] = StringVector::AddString(role_vector, role_str);
+					FlatVector::GetData<string_t>(role_vector)[i] = role_str;
 				}
 			}
 		} else {
-			FlatVector::SetNull(output.data[6], index, true);
+			FlatVector::SetNull(Column(OsmColumn::REF_ROLES), index, true);
 		}
 
 		// Refs
-		if (!ref_iter.empty()) {
+		if (project_refs && !ref_iter.empty()) {
 			auto ref_count = ref_iter.size();
 
-			auto total_refs = ListVector::GetListSize(output.data[3]);
-			ListVector::Reserve(output.data[3], total_refs + ref_count);
-			ListVector::SetListSize(output.data[3], total_refs + ref_count);
-			auto &ref_entry = ListVector::GetData(output.data[3])[index];
-			auto &ref_vector = ListVector::GetEntry(output.data[3]);
+			auto total_refs = ListVector::GetListSize(Column(OsmColumn::REFS));
+			ListVector::Reserve(Column(OsmColumn::REFS), total_refs + ref_count);
+			ListVector::SetListSize(Column(OsmColumn::REFS), total_refs + ref_count);
+			auto &ref_entry = ListVector::GetData(Column(OsmColumn::REFS))[index];
+			auto &ref_vector = ListVector::GetEntry(Column(OsmColumn::REFS));
 			ref_entry.offset = total_refs;
 			ref_entry.length = ref_count;
 
@@ -684,18 +1276,18 @@ struct LocalState final : LocalTableFunctionState {
 				ref_data[total_refs++] = last_ref;
 			}
 		} else {
-			FlatVector::SetNull(output.data[3], index, true);
+			FlatVector::SetNull(Column(OsmColumn::REFS), index, true);
 		}
 
 		// Types
-		if (!type_iter.empty()) {
+		if (project_ref_types && !type_iter.empty()) {
 			auto type_count = type_iter.size();
 
-			auto total_types = ListVector::GetListSize(output.data[7]);
-			ListVector::Reserve(output.data[7], total_types + type_count);
-			ListVector::SetListSize(output.data[7], total_types + type_count);
-			auto &type_entry = ListVector::GetData(output.data[7])[index];
-			auto &type_vector = ListVector::GetEntry(output.data[7]);
+			auto total_types = ListVector::GetListSize(Column(OsmColumn::REF_TYPES));
+			ListVector::Reserve(Column(OsmColumn::REF_TYPES), total_types + type_count);
+			ListVector::SetListSize(Column(OsmColumn::REF_TYPES), total_types + type_count);
+			auto &type_entry = ListVector::GetData(Column(OsmColumn::REF_TYPES))[index];
+			auto &type_vector = ListVector::GetEntry(Column(OsmColumn::REF_TYPES));
 			type_entry.offset = total_types;
 			type_entry.length = type_count;
 
@@ -704,7 +1296,11 @@ struct LocalState final : LocalTableFunctionState {
 				type_data[total_types++] = (uint8_t)type;
 			}
 		} else {
-			FlatVector::SetNull(output.data[7], index, true);
+			FlatVector::SetNull(Column(OsmColumn::REF_TYPES), index, true);
+		}
+
+		if (project_geometry) {
+			FlatVector::SetNull(Column(OsmColumn::GEOMETRY), index, true);
 		}
 
 		index++;
@@ -714,20 +1310,18 @@ struct LocalState final : LocalTableFunctionState {
 	bool ScanDenseNodes(DataChunk &output, idx_t &index, idx_t capacity) {
 		// Write multiple nodes at once as long as we have capacity
 		auto nodes_to_write = capacity - index;
-		auto nodes_to_read = std::min(nodes_to_write, dense_node_ids.size() - dense_node_index);
+		auto nodes_to_read = std::min(nodes_to_write, dense_node_count - dense_node_index);
 
-		auto kind_data = FlatVector::GetData<uint8_t>(output.data[0]);
-		auto id_data = FlatVector::GetData<int64_t>(output.data[1]);
-		auto lat_data = FlatVector::GetData<double>(output.data[4]);
-		auto lon_data = FlatVector::GetData<double>(output.data[5]);
+		auto kind_data = FlatVector::GetData<uint8_t>(Column(OsmColumn::KIND));
+		auto id_data = FlatVector::GetData<int64_t>(Column(OsmColumn::ID));
+		auto lat_data = FlatVector::GetData<double>(Column(OsmColumn::LAT));
+		auto lon_data = FlatVector::GetData<double>(Column(OsmColumn::LON));
 
 		for (idx_t i = 0; i < nodes_to_read; i++) {
-			auto id = dense_node_ids[dense_node_index];
-
-			id_data[index] = id;
+			id_data[index] = dense_node_ids.Next();
 			kind_data[index] = 0;
-			lat_data[index] = 0.000000001 * (lat_offset + (granularity * dense_node_lats[dense_node_index]));
-			lon_data[index] = 0.000000001 * (lon_offset + (granularity * dense_node_lons[dense_node_index]));
+			lat_data[index] = 0.000000001 * (lat_offset + (granularity * dense_node_lats.Next()));
+			lon_data[index] = 0.000000001 * (lon_offset + (granularity * dense_node_lons.Next()));
 
 			// Do we have tags in this block?
 			if (!dense_node_tags.empty()) {
@@ -737,16 +1331,16 @@ struct LocalState final : LocalTableFunctionState {
 					// therefore we need to divide the length by 2 to get the number of tags
 					auto tag_count = entry.length / 2;
 
-					auto total_tags = ListVector::GetListSize(output.data[2]);
-					ListVector::Reserve(output.data[2], total_tags + tag_count);
-					ListVector::SetListSize(output.data[2], total_tags + tag_count);
-					auto &tag_entry = ListVector::GetData(output.data[2])[index];
+					auto total_tags = ListVector::GetListSize(Column(OsmColumn::TAGS));
+					ListVector::Reserve(Column(OsmColumn::TAGS), total_tags + tag_count);
+					ListVector::SetListSize(Column(OsmColumn::TAGS), total_tags + tag_count);
+					auto &tag_entry = ListVector::GetData(Column(OsmColumn::TAGS))[index];
 
 					tag_entry.offset = total_tags;
 					tag_entry.length = tag_count;
 
-					auto &key_vector = MapVector::GetKeys(output.data[2]);
-					auto &value_vector = MapVector::GetValues(output.data[2]);
+					auto &key_vector = MapVector::GetKeys(Column(OsmColumn::TAGS));
+					auto &value_vector = MapVector::GetValues(Column(OsmColumn::TAGS));
 
 					idx_t t = entry.offset;
 					idx_t r = tag_entry.offset;
@@ -755,30 +1349,32 @@ struct LocalState final : LocalTableFunctionState {
 						auto key_id = dense_node_tags[t];
 						auto val_id = dense_node_tags[t + 1];
 
-						FlatVector::GetData<string_t>(key_vector)[r] =
-						    StringVector::AddString(key_vector, string_table[key_id]);
-						FlatVector::GetData<string_t>(value_vector)[r] =
-						    StringVector::AddString(value_vector, string_table[val_id]);
+						FlatVector::GetData<string_t>(key_vector)[r] = string_table[key_id];
+						FlatVector::GetData<string_t>(value_vector)[r] = string_table[val_id];
 
 						t += 2;
 						r += 1;
 					}
 				} else {
-					FlatVector::SetNull(output.data[2], index, true);
+					FlatVector::SetNull(Column(OsmColumn::TAGS), index, true);
 				}
 			} else {
-				FlatVector::SetNull(output.data[2], index, true);
+				FlatVector::SetNull(Column(OsmColumn::TAGS), index, true);
 			}
-			FlatVector::SetNull(output.data[3], index, true);
+			FlatVector::SetNull(Column(OsmColumn::REFS), index, true);
 
 			// No ref types or roles for dense nodes
-			FlatVector::SetNull(output.data[6], index, true);
-			FlatVector::SetNull(output.data[7], index, true);
+			FlatVector::SetNull(Column(OsmColumn::REF_ROLES), index, true);
+			FlatVector::SetNull(Column(OsmColumn::REF_TYPES), index, true);
+
+			if (project_geometry) {
+				SetPointGeometry(index, lon_data[index], lat_data[index]);
+			}
 
 			dense_node_index++;
 			index++;
 		}
-		if (dense_node_index >= dense_node_ids.size()) {
+		if (dense_node_index >= dense_node_count) {
 			return true;
 		}
 		return false;
@@ -788,13 +1384,19 @@ struct LocalState final : LocalTableFunctionState {
 static unique_ptr<LocalTableFunctionState> InitLocal(ExecutionContext &context, TableFunctionInitInput &input,
                                                      GlobalTableFunctionState *global_state) {
 	auto &global = global_state->Cast<GlobalState>();
-	const auto blob = global.GetNextBlob(context.client);
+	auto &bind_data = input.bind_data->Cast<BindData>();
+
+	auto handle = OpenFile(context.client, bind_data.file_name);
+	const auto blob = global.GetNextBlob(context.client, *handle);
 	if (blob == nullptr) {
 		return nullptr;
 	}
 	auto block = DecompressBlob(context.client, *blob);
 
 	auto result = make_uniq<LocalState>(std::move(block));
+	result->handle = std::move(handle);
+	result->InitColumns(context.client, bind_data, input.column_ids);
+	result->locations = global.locations.get();
 	return std::move(result);
 }
 
@@ -810,10 +1412,12 @@ static void Execute(ClientContext &context, TableFunctionInput &input, DataChunk
 	idx_t row_id = 0;
 	idx_t capacity = STANDARD_VECTOR_SIZE;
 
+	local_state.SetOutput(output);
+
 	while (row_id < capacity) {
 		bool done = local_state.TryRead(output, row_id, capacity);
 		if (done) {
-			auto next = global_state.GetNextBlob(context);
+			auto next = global_state.GetNextBlob(context, *local_state.handle);
 			if (next.get() == nullptr) {
 				break;
 			}
@@ -862,7 +1466,9 @@ static unique_ptr<TableRef> ReadOsmPBFReplacementScan(ClientContext &context, Re
 static constexpr const char *DOC_DESCRIPTION = R"(
     The `ST_ReadOsm()` table function enables reading compressed OpenStreetMap data directly from a `.osm.pbf file.`
 
-    This function uses multithreading and zero-copy protobuf parsing which makes it a lot faster than using the `ST_Read()` OSM driver, however it only outputs the raw OSM data (Nodes, Ways, Relations), without constructing any geometries. For simple node entities (like PoI's) you can trivially construct POINT geometries, but it is also possible to construct LINESTRING and POLYGON geometries by manually joining refs and nodes together in SQL, although with available memory usually being a limiting factor.
+    This function uses multithreading and zero-copy protobuf parsing which makes it a lot faster than using the `ST_Read()` OSM driver, however by default it only outputs the raw OSM data (Nodes, Ways, Relations), without constructing any geometries. For simple node entities (like PoI's) you can trivially construct POINT geometries, but it is also possible to construct LINESTRING and POLYGON geometries by manually joining refs and nodes together in SQL, although with available memory usually being a limiting factor.
+
+    Passing `geometry := true` adds a `geometry` column with POINT geometries for nodes and LINESTRING geometries for ways, assembled from the locations of their nodes. The node locations are read in a separate pass into a compact (and spillable) index, which requires the nodes in the file to be sorted by id. Ways that reference nodes missing from the file, as well as relations, get a NULL geometry.
     The `ST_ReadOSM()` function also provides a "replacement scan" to enable reading from a file directly as if it were a table. This is just syntax sugar for calling `ST_ReadOSM()` though. Example:
 
     ```sql
@@ -898,6 +1504,9 @@ void RegisterOSMModule(DatabaseInstance &db) {
 
 	read.get_partition_data = GetPartitionData;
 	read.table_scan_progress = Progress;
+	read.projection_pushdown = true;
+	read.pushdown_complex_filter = PushdownComplexFilter;
+	read.named_parameters["geometry"] = LogicalType::BOOLEAN;
 
 	ExtensionUtil::RegisterFunction(db, read);
 
@@ -1,14 +1,27 @@
 #include "spatial/modules/proj/proj_module.hpp"
 #include "spatial/spatial_types.hpp"
 #include "spatial/util/function_builder.hpp"
+#include "spatial/util/scratch_pool.hpp"
+#include "spatial/util/spatial_profiler.hpp"
 #include "spatial/geometry/sgl.hpp"
 #include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/geometry_stats.hpp"
 
 #include "duckdb/common/vector_operations/generic_executor.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
 #include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/scalar_function_catalog_entry.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
 #include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/filter/expression_filter.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
 #include "duckdb/main/extension_util.hpp"
+#include "duckdb/storage/object_cache.hpp"
 
 #include "proj.h"
 #include "geodesic.h"
@@ -44,12 +57,15 @@ namespace {
 //######################################################################################################################
 
 struct ProjModule {
-	static void RegisterVFS(DatabaseInstance &db);
+	static void InitializeVFS();
 	static PJ_CONTEXT *GetThreadProjContext();
 };
 
 PJ_CONTEXT *ProjModule::GetThreadProjContext() {
 
+	// Any PJ_CONTEXT needs the VFS for the proj.db database
+	InitializeVFS();
+
 	const auto ctx = proj_context_create();
 
 	// We set the default context proj.db path to the one in the binary here
@@ -73,49 +89,44 @@ PJ_CONTEXT *ProjModule::GetThreadProjContext() {
 	return ctx;
 }
 
-// IMPORTANT: Make sure this module is loaded before any other modules that use proj (like GDAL)
-void ProjModule::RegisterVFS(DatabaseInstance &db) {
-
-	// Initialization lock around global proj state
-	static mutex lock;
-
-	lock_guard<mutex> g(lock);
-
-	// we use the sqlite "memvfs" to store the proj.db database in the extension binary itself
-	// this way we don't have to worry about the user having the proj.db database installed
-	// on their system. We therefore have to tell proj to use memvfs as the sqlite3 vfs and
-	// point it to the segment of the binary that contains the proj.db database
-
-	sqlite3_initialize();
-	sqlite3_memvfs_init(nullptr, nullptr, nullptr);
-	const auto vfs = sqlite3_vfs_find("memvfs");
-	if (!vfs) {
-		throw InternalException("Could not find sqlite memvfs extension");
-	}
-	sqlite3_vfs_register(vfs, 0);
+// Registering the VFS and pointing PROJ to the proj.db database is deferred until PROJ is first used, instead of doing it
+// on every LOAD of the extension. IMPORTANT: This has to happen before any other library uses proj (like GDAL)
+void ProjModule::InitializeVFS() {
+
+	static std::once_flag initialized;
+	std::call_once(initialized, []() {
+		// we use the sqlite "memvfs" to store the proj.db database in the extension binary itself
+		// this way we don't have to worry about the user having the proj.db database installed
+		// on their system. We therefore have to tell proj to use memvfs as the sqlite3 vfs and
+		// point it to the segment of the binary that contains the proj.db database
+
+		sqlite3_initialize();
+		sqlite3_memvfs_init(nullptr, nullptr, nullptr);
+		const auto vfs = sqlite3_vfs_find("memvfs");
+		if (!vfs) {
+			throw InternalException("Could not find sqlite memvfs extension");
+		}
+		sqlite3_vfs_register(vfs, 0);
 
-	// We set the default context proj.db path to the one in the binary here
-	// Otherwise GDAL will try to load the proj.db from the system
-	// Any PJ_CONTEXT we create after this will inherit these settings (on this thread?)
-	const auto path = StringUtil::Format("file:/proj.db?ptr=%llu&sz=%lu&max=%lu", static_cast<void *>(proj_db),
-	                                     proj_db_len, proj_db_len);
+		// We set the default context proj.db path to the one in the binary here
+		// Otherwise GDAL will try to load the proj.db from the system
+		// Any PJ_CONTEXT we create after this will inherit these settings (on this thread?)
+		const auto path = StringUtil::Format("file:/proj.db?ptr=%llu&sz=%lu&max=%lu", static_cast<void *>(proj_db),
+		                                     proj_db_len, proj_db_len);
 
-	proj_context_set_sqlite3_vfs_name(nullptr, "memvfs");
+		proj_context_set_sqlite3_vfs_name(nullptr, "memvfs");
 
-	const auto ok = proj_context_set_database_path(nullptr, path.c_str(), nullptr, nullptr);
-	if (!ok) {
-		throw InternalException("Could not set proj.db path");
-	}
+		const auto ok = proj_context_set_database_path(nullptr, path.c_str(), nullptr, nullptr);
+		if (!ok) {
+			throw InternalException("Could not set proj.db path");
+		}
+	});
 }
 
 //######################################################################################################################
 // Coordinate Transformation Functions
 //######################################################################################################################
 
-//======================================================================================================================
-// Local State
-//======================================================================================================================
-
 struct ProjCRSDelete {
 	void operator()(PJ *crs) const {
 		proj_destroy(crs);
@@ -124,14 +135,176 @@ struct ProjCRSDelete {
 
 using ProjCRS = unique_ptr<PJ, ProjCRSDelete>;
 
+//======================================================================================================================
+// Transformation Cache
+//======================================================================================================================
+
+//! Resolving a transformation between two CRS looks it up in proj.db, which can take tens of milliseconds. This cache
+//! keeps the resolved transformations of the database instance, so that the thread local PJ_CONTEXTs of later queries
+//! can clone them instead.
+class ProjTransformCache final : public ObjectCacheEntry {
+public:
+	static constexpr auto SETTING_NAME = "proj_transform_cache_size";
+	static constexpr idx_t DEFAULT_CAPACITY = 128;
+
+	ProjTransformCache() : proj_ctx(ProjModule::GetThreadProjContext()) {
+	}
+
+	~ProjTransformCache() override {
+		// Destroy the cached objects before the context
+		for (auto &entries : cache) {
+			entries.clear();
+		}
+		proj_context_destroy(proj_ctx);
+	}
+
+	static string ObjectType() {
+		return "spatial_proj_transform_cache";
+	}
+
+	string GetObjectType() override {
+		return ObjectType();
+	}
+
+	static shared_ptr<ProjTransformCache> Get(ClientContext &context) {
+		auto &object_cache = ObjectCache::GetObjectCache(context);
+		auto result = object_cache.GetOrCreate<ProjTransformCache>(ObjectType());
+
+		Value capacity_value;
+		if (context.TryGetCurrentSetting(SETTING_NAME, capacity_value)) {
+			result->SetCapacity(capacity_value.GetValue<idx_t>());
+		}
+		return result;
+	}
+
+	void SetCapacity(idx_t capacity_p) {
+		lock_guard<mutex> guard(lock);
+		capacity = capacity_p;
+		while (size > capacity) {
+			Evict();
+		}
+	}
+
+	//! Create the transformation in the given context, from the cache if possible
+	PJ *Create(PJ_CONTEXT *ctx, const string &source, const string &target, bool normalize) {
+		auto &entries = cache[normalize];
+		{
+			lock_guard<mutex> guard(lock);
+			const auto entry = entries.find({source, target});
+			if (entry != entries.end()) {
+				// Cloning may fail for some objects, in which case we recreate it from scratch
+				const auto clone = proj_clone(ctx, entry->second.crs.get());
+				if (clone) {
+					hits++;
+					entry->second.last_used = ++clock;
+					return clone;
+				}
+			}
+			misses++;
+		}
+
+		const auto crs = CreateProjection(ctx, source, target, normalize);
+
+		lock_guard<mutex> guard(lock);
+		if (capacity != 0 && entries.find({source, target}) == entries.end()) {
+			const auto clone = proj_clone(proj_ctx, crs);
+			if (clone) {
+				if (size >= capacity) {
+					Evict();
+				}
+				auto &entry = entries[{source, target}];
+				entry.crs = ProjCRS(clone);
+				entry.last_used = ++clock;
+				size++;
+			}
+		}
+		return crs;
+	}
+
+	//! Returns the number of cache hits and misses, the number of cached transformations and the capacity
+	void GetStatistics(idx_t &hits_p, idx_t &misses_p, idx_t &size_p, idx_t &capacity_p) {
+		lock_guard<mutex> guard(lock);
+		hits_p = hits;
+		misses_p = misses;
+		size_p = size;
+		capacity_p = capacity;
+	}
+
+	static PJ *CreateProjection(PJ_CONTEXT *ctx, const string &source, const string &target, bool normalize) {
+		SpatialProfileScope profile(SpatialProfileCategory::PROJ_CREATE);
+
+		auto crs = proj_create_crs_to_crs(ctx, source.c_str(), target.c_str(), nullptr);
+		if (!crs) {
+			throw InvalidInputException("Could not create projection: " + source + " -> " + target);
+		}
+
+		if (normalize) {
+			const auto normalized_crs = proj_normalize_for_visualization(ctx, crs);
+			proj_destroy(crs);
+			if (!normalized_crs) {
+				throw InvalidInputException("Could not normalize projection: " + source + " -> " + target);
+			}
+			crs = normalized_crs;
+		}
+		return crs;
+	}
+
+private:
+	//! Evict the least recently used transformation, the lock must be held
+	void Evict() {
+		unordered_map<std::pair<string, string>, Entry> *lru_entries = nullptr;
+		unordered_map<std::pair<string, string>, Entry>::iterator lru_entry;
+		for (auto &entries : cache) {
+			for (auto it = entries.begin(); it != entries.end(); ++it) {
+				if (!lru_entries || it->second.last_used < lru_entry->second.last_used) {
+					lru_entries = &entries;
+					lru_entry = it;
+				}
+			}
+		}
+		if (lru_entries) {
+			lru_entries->erase(lru_entry);
+			size--;
+		}
+	}
+
+	struct Entry {
+		ProjCRS crs;
+		idx_t last_used = 0;
+	};
+
+	mutex lock;
+	//! The context the cached objects belong to, only used while holding the lock
+	PJ_CONTEXT *proj_ctx;
+	//! The cached transformations, with and without normalized axis order
+	unordered_map<std::pair<string, string>, Entry> cache[2];
+
+	idx_t capacity = DEFAULT_CAPACITY;
+	idx_t size = 0;
+	idx_t clock = 0;
+	idx_t hits = 0;
+	idx_t misses = 0;
+};
+
+//======================================================================================================================
+// Local State
+//======================================================================================================================
+
 struct ProjFunctionLocalState final : FunctionLocalState {
 
 	PJ_CONTEXT *proj_ctx;
+	shared_ptr<GeometryScratchPool> pool;
 	ArenaAllocator arena;
 	GeometryAllocator allocator;
 
 	// Cache for PJ* objects
 	unordered_map<std::pair<string, string>, ProjCRS> crs_cache;
+	// The transformations shared by all threads, to create the PJ* objects from
+	shared_ptr<ProjTransformCache> shared_cache;
+
+	// Buffers to transform many coordinates with a single call to proj
+	vector<PJ_COORD> coords;
+	vector<sgl::geometry *> parts;
 
 	// Not copyable
 	ProjFunctionLocalState(const ProjFunctionLocalState &) = delete;
@@ -142,7 +315,9 @@ struct ProjFunctionLocalState final : FunctionLocalState {
 	ProjFunctionLocalState &operator=(ProjFunctionLocalState &&) = delete;
 
 	explicit ProjFunctionLocalState(ClientContext &context)
-	    : proj_ctx(ProjModule::GetThreadProjContext()), arena(BufferAllocator::Get(context)), allocator(arena) {
+	    : proj_ctx(ProjModule::GetThreadProjContext()), pool(GeometryScratchPool::Get(context)),
+	      arena(pool->GetAllocator()), allocator(arena),
+	      shared_cache(ProjTransformCache::Get(context)) {
 	}
 
 	~ProjFunctionLocalState() override {
@@ -162,7 +337,7 @@ struct ProjFunctionLocalState final : FunctionLocalState {
 
 	static ProjFunctionLocalState &ResetAndGet(ExpressionState &state) {
 		auto &local_state = ExecuteFunctionState::GetFunctionState(state)->Cast<ProjFunctionLocalState>();
-		local_state.arena.Reset();
+		GeometryScratchPool::Reset(local_state.arena);
 		return local_state;
 	}
 
@@ -172,20 +347,7 @@ struct ProjFunctionLocalState final : FunctionLocalState {
 			return crs_entry->second.get();
 		}
 
-		auto crs = proj_create_crs_to_crs(proj_ctx, source.c_str(), target.c_str(), nullptr);
-		if (!crs) {
-			throw InvalidInputException("Could not create projection: " + source + " -> " + target);
-		}
-
-		if (normalize) {
-			const auto normalized_crs = proj_normalize_for_visualization(proj_ctx, crs);
-			proj_destroy(crs);
-			if (!normalized_crs) {
-				throw InvalidInputException("Could not normalize projection: " + source + " -> " + target);
-			}
-			crs = normalized_crs;
-		}
-
+		const auto crs = shared_cache->Create(proj_ctx, source, target, normalize);
 		crs_cache[{source, target}] = ProjCRS(crs);
 		return crs;
 	}
@@ -214,19 +376,76 @@ struct ST_Transform {
 	//------------------------------------------------------------------------------------------------------------------
 	struct BindData final : FunctionData {
 		bool normalize = false;
+		//! Whether the constant source and target have a built-in projection, which is used instead of PROJ
+		bool has_builtin = false;
+		sgl::projection builtin;
 
 		unique_ptr<FunctionData> Copy() const override {
 			auto result = make_uniq<BindData>();
 			result->normalize = normalize;
+			result->has_builtin = has_builtin;
+			result->builtin = builtin;
 			return std::move(result);
 		}
 
 		bool Equals(const FunctionData &other) const override {
 			auto &data = other.Cast<BindData>();
-			return normalize == data.normalize;
+			return normalize == data.normalize && has_builtin == data.has_builtin;
 		}
 	};
 
+	enum class BuiltinCRS : uint8_t { NONE, WGS84, WEB_MERCATOR, UTM };
+
+	//! Recognize the coordinate systems that have a built-in projection
+	static BuiltinCRS GetBuiltinCRS(const string &crs, int &utm_zone, bool &utm_south) {
+		if (StringUtil::CIEquals(crs, "EPSG:4326")) {
+			return BuiltinCRS::WGS84;
+		}
+		if (StringUtil::CIEquals(crs, "EPSG:3857")) {
+			return BuiltinCRS::WEB_MERCATOR;
+		}
+		// EPSG:326XX and EPSG:327XX are the northern and southern UTM zones on WGS84
+		if (crs.size() == 10 &&
+		    (StringUtil::CIEquals(crs.substr(0, 8), "EPSG:326") || StringUtil::CIEquals(crs.substr(0, 8), "EPSG:327"))) {
+			if (!StringUtil::CharacterIsDigit(crs[8]) || !StringUtil::CharacterIsDigit(crs[9])) {
+				return BuiltinCRS::NONE;
+			}
+			utm_zone = (crs[8] - '0') * 10 + (crs[9] - '0');
+			utm_south = crs[7] == '7';
+			return utm_zone >= 1 && utm_zone <= 60 ? BuiltinCRS::UTM : BuiltinCRS::NONE;
+		}
+		return BuiltinCRS::NONE;
+	}
+
+	static bool TryGetBuiltinProjection(const string &source, const string &target, bool normalize,
+	                                    sgl::projection &result) {
+		int zone = 0;
+		bool south = false;
+		const auto source_crs = GetBuiltinCRS(source, zone, south);
+		const auto target_crs = GetBuiltinCRS(target, zone, south);
+
+		// EPSG:4326 has (latitude, longitude) axis order, unless the axis order is normalized
+		const auto lat_lon_order = !normalize;
+
+		if (source_crs == BuiltinCRS::WGS84 && target_crs == BuiltinCRS::WEB_MERCATOR) {
+			result = sgl::projection::web_mercator(false, lat_lon_order);
+			return true;
+		}
+		if (source_crs == BuiltinCRS::WEB_MERCATOR && target_crs == BuiltinCRS::WGS84) {
+			result = sgl::projection::web_mercator(true, lat_lon_order);
+			return true;
+		}
+		if (source_crs == BuiltinCRS::WGS84 && target_crs == BuiltinCRS::UTM) {
+			result = sgl::projection::utm(zone, south, false, lat_lon_order);
+			return true;
+		}
+		if (source_crs == BuiltinCRS::UTM && target_crs == BuiltinCRS::WGS84) {
+			result = sgl::projection::utm(zone, south, true, lat_lon_order);
+			return true;
+		}
+		return false;
+	}
+
 	static unique_ptr<FunctionData> Bind(ClientContext &ctx, ScalarFunction &, vector<unique_ptr<Expression>> &args) {
 		auto result = make_uniq<BindData>();
 		if (args.size() == 4) {
@@ -240,9 +459,26 @@ struct ST_Transform {
 			}
 			result->normalize = BooleanValue::Get(ExpressionExecutor::EvaluateScalar(ctx, *arg));
 		}
+
+		// Use a built-in projection for the most common pairs of constant coordinate systems
+		const auto &source_arg = args[1];
+		const auto &target_arg = args[2];
+		if (source_arg->IsFoldable() && target_arg->IsFoldable() && !source_arg->HasParameter() &&
+		    !target_arg->HasParameter()) {
+			const auto source = ExpressionExecutor::EvaluateScalar(ctx, *source_arg);
+			const auto target = ExpressionExecutor::EvaluateScalar(ctx, *target_arg);
+			if (!source.IsNull() && !target.IsNull()) {
+				result->has_builtin = TryGetBuiltinProjection(StringValue::Get(source), StringValue::Get(target),
+				                                              result->normalize, result->builtin);
+			}
+		}
 		return std::move(result);
 	}
 
+	static bool IsNonNullConstant(Vector &vec) {
+		return vec.GetVectorType() == VectorType::CONSTANT_VECTOR && !ConstantVector::IsNull(vec);
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	// Execute (POINT_2D)
 	//------------------------------------------------------------------------------------------------------------------
@@ -254,6 +490,73 @@ struct ST_Transform {
 		auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
 		const auto &info = func_expr.bind_info->Cast<BindData>();
 
+		auto &point_vec = args.data[0];
+		const auto count = args.size();
+
+		if (info.has_builtin) {
+			point_vec.Flatten(count);
+			const auto &point_parts = StructVector::GetEntries(point_vec);
+			const auto &result_parts = StructVector::GetEntries(result);
+			const auto x_out = FlatVector::GetData<double>(*result_parts[0]);
+			const auto y_out = FlatVector::GetData<double>(*result_parts[1]);
+			memcpy(x_out, FlatVector::GetData<double>(*point_parts[0]), count * sizeof(double));
+			memcpy(y_out, FlatVector::GetData<double>(*point_parts[1]), count * sizeof(double));
+
+			info.builtin.apply(x_out, y_out, count, 1);
+
+			const auto &point_validity = FlatVector::Validity(point_vec);
+			if (!point_validity.AllValid()) {
+				for (idx_t i = 0; i < count; i++) {
+					if (!point_validity.RowIsValid(i)) {
+						FlatVector::SetNull(result, i, true);
+					}
+				}
+			}
+			return;
+		}
+
+		if (IsNonNullConstant(args.data[1]) && IsNonNullConstant(args.data[2]) &&
+		    point_vec.GetVectorType() != VectorType::CONSTANT_VECTOR) {
+			// Resolve the projection once, and transform all points of the chunk with a single call to proj
+			const auto source_str = ConstantVector::GetData<string_t>(args.data[1])[0].GetString();
+			const auto target_str = ConstantVector::GetData<string_t>(args.data[2])[0].GetString();
+			const auto crs = lstate.GetOrCreateProjection(source_str, target_str, info.normalize);
+
+			point_vec.Flatten(count);
+			const auto &point_parts = StructVector::GetEntries(point_vec);
+			const auto x_in = FlatVector::GetData<double>(*point_parts[0]);
+			const auto y_in = FlatVector::GetData<double>(*point_parts[1]);
+
+			auto &coords = lstate.coords;
+			coords.resize(count);
+			for (idx_t i = 0; i < count; i++) {
+				coords[i] = proj_coord(x_in[i], y_in[i], 0, 0);
+			}
+
+			{
+				SpatialProfileScope profile(SpatialProfileCategory::PROJ_TRANSFORM);
+				proj_trans_array(crs, PJ_FWD, count, coords.data());
+			}
+
+			const auto &result_parts = StructVector::GetEntries(result);
+			const auto x_out = FlatVector::GetData<double>(*result_parts[0]);
+			const auto y_out = FlatVector::GetData<double>(*result_parts[1]);
+			for (idx_t i = 0; i < count; i++) {
+				x_out[i] = coords[i].xy.x;
+				y_out[i] = coords[i].xy.y;
+			}
+
+			const auto &point_validity = FlatVector::Validity(point_vec);
+			if (!point_validity.AllValid()) {
+				for (idx_t i = 0; i < count; i++) {
+					if (!point_validity.RowIsValid(i)) {
+						FlatVector::SetNull(result, i, true);
+					}
+				}
+			}
+			return;
+		}
+
 		GenericExecutor::ExecuteTernary<POINT_TYPE, PROJ_TYPE, PROJ_TYPE, POINT_TYPE>(
 		    args.data[0], args.data[1], args.data[2], result, args.size(),
 		    [&](const POINT_TYPE &point_in, const PROJ_TYPE &source, const PROJ_TYPE target) {
@@ -262,6 +565,7 @@ struct ST_Transform {
 
 			    const auto crs = lstate.GetOrCreateProjection(source_str, target_str, info.normalize);
 
+			    SpatialProfileScope profile(SpatialProfileCategory::PROJ_TRANSFORM);
 			    POINT_TYPE point_out;
 			    const auto transformed = proj_trans(crs, PJ_FWD, proj_coord(point_in.a_val, point_in.b_val, 0, 0)).xy;
 			    point_out.a_val = transformed.x;
@@ -293,6 +597,7 @@ struct ST_Transform {
 			    // TODO: this may be interesting to use, but at that point we can only return a BOX_TYPE
 			    constexpr int densify_pts = 0;
 			    BOX_TYPE box_out;
+			    SpatialProfileScope profile(SpatialProfileCategory::PROJ_TRANSFORM);
 			    proj_trans_bounds(lstate.proj_ctx, crs, PJ_FWD, box_in.a_val, box_in.b_val, box_in.c_val, box_in.d_val,
 			                      &box_out.a_val, &box_out.b_val, &box_out.c_val, &box_out.d_val, densify_pts);
 			    return box_out;
@@ -302,32 +607,133 @@ struct ST_Transform {
 	//------------------------------------------------------------------------------------------------------------------
 	// Execute (GEOMETRY)
 	//------------------------------------------------------------------------------------------------------------------
+	//! Collect all parts of the geometry that hold vertices
+	static void CollectVertexParts(sgl::geometry *geom, vector<sgl::geometry *> &parts) {
+		sgl::geometry *part = geom;
+		const sgl::geometry *root = part->get_parent();
+
+		while (true) {
+			switch (part->get_type()) {
+			case sgl::geometry_type::POINT:
+			case sgl::geometry_type::LINESTRING:
+				if (part->get_count() != 0) {
+					parts.push_back(part);
+				}
+				break;
+			case sgl::geometry_type::POLYGON:
+			case sgl::geometry_type::MULTI_POINT:
+			case sgl::geometry_type::MULTI_LINESTRING:
+			case sgl::geometry_type::MULTI_POLYGON:
+			case sgl::geometry_type::MULTI_GEOMETRY:
+				if (!part->is_empty()) {
+					part = part->get_first_part();
+					continue;
+				}
+				break;
+			default:
+				throw InternalException("Unsupported geometry type in ST_Transform");
+			}
+
+			while (true) {
+				const auto parent = part->get_parent();
+				if (parent == root) {
+					return;
+				}
+				if (part != parent->get_last_part()) {
+					part = part->get_next();
+					break;
+				}
+				part = parent;
+			}
+		}
+	}
+
+	//! Transform all vertices of a geometry with a single call to proj, and serialize the result
+	static string_t TransformGeometry(ProjFunctionLocalState &lstate, PJ *crs, const string_t &blob, Vector &result) {
+		auto &coords = lstate.coords;
+		auto &parts = lstate.parts;
+
+		sgl::geometry geom;
+		lstate.Deserialize(blob, geom);
+
+		parts.clear();
+		CollectVertexParts(&geom, parts);
+
+		// Gather the vertices
+		coords.clear();
+		for (const auto part : parts) {
+			const auto vertex_size = part->get_vertex_size();
+			const auto vertex_data = part->get_vertex_data();
+			for (uint32_t v_idx = 0; v_idx < part->get_count(); v_idx++) {
+				sgl::vertex_xyzm vertex = {0, 0, 0, 0};
+				memcpy(&vertex, vertex_data + v_idx * vertex_size, vertex_size);
+				coords.push_back(proj_coord(vertex.x, vertex.y, vertex.zm, 0));
+			}
+		}
+
+		{
+			SpatialProfileScope profile(SpatialProfileCategory::PROJ_TRANSFORM);
+			proj_trans_array(crs, PJ_FWD, coords.size(), coords.data());
+		}
+
+		// Scatter the transformed x/y back into new vertex arrays, the blob is read-only
+		idx_t coord_idx = 0;
+		for (const auto part : parts) {
+			const auto vertex_count = part->get_count();
+			const auto vertex_size = part->get_vertex_size();
+			const auto old_vertex_data = part->get_vertex_data();
+			const auto new_vertex_data = static_cast<uint8_t *>(lstate.allocator.alloc(vertex_count * vertex_size));
+			memcpy(new_vertex_data, old_vertex_data, vertex_count * vertex_size);
+			for (uint32_t v_idx = 0; v_idx < vertex_count; v_idx++) {
+				const auto &transformed = coords[coord_idx++].xy;
+				memcpy(new_vertex_data + v_idx * vertex_size, &transformed.x, sizeof(double));
+				memcpy(new_vertex_data + v_idx * vertex_size + sizeof(double), &transformed.y, sizeof(double));
+			}
+			part->set_vertex_data(new_vertex_data, vertex_count);
+		}
+
+		return lstate.Serialize(result, geom);
+	}
+
 	static void ExecuteGeometry(DataChunk &args, ExpressionState &state, Vector &result) {
 		auto &lstate = ProjFunctionLocalState::ResetAndGet(state);
-		auto &alloc = lstate.allocator;
 		auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
 		const auto &info = func_expr.bind_info->Cast<BindData>();
 
+		auto &source_vec = args.data[1];
+		auto &target_vec = args.data[2];
+
+		if (info.has_builtin) {
+			UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &blob) {
+				sgl::geometry geom;
+				lstate.Deserialize(blob, geom);
+				sgl::ops::project(&lstate.allocator, &geom, &info.builtin);
+				return lstate.Serialize(result, geom);
+			});
+			return;
+		}
+
+		if (IsNonNullConstant(source_vec) && IsNonNullConstant(target_vec)) {
+			// Resolve the projection once for the whole chunk
+			const auto source_str = ConstantVector::GetData<string_t>(source_vec)[0].GetString();
+			const auto target_str = ConstantVector::GetData<string_t>(target_vec)[0].GetString();
+			const auto crs = lstate.GetOrCreateProjection(source_str, target_str, info.normalize);
+
+			UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](const string_t &blob) {
+				return TransformGeometry(lstate, crs, blob, result);
+			});
+			return;
+		}
+
 		TernaryExecutor::Execute<string_t, string_t, string_t, string_t>(
-		    args.data[0], args.data[1], args.data[2], result, args.size(),
+		    args.data[0], source_vec, target_vec, result, args.size(),
 		    [&](const string_t &blob, const string_t &source, const string_t &target) {
 			    const auto source_str = source.GetString();
 			    const auto target_str = target.GetString();
 
 			    const auto crs = lstate.GetOrCreateProjection(source_str, target_str, info.normalize);
 
-			    sgl::geometry geom;
-			    lstate.Deserialize(blob, geom);
-
-			    sgl::ops::replace_vertices(&alloc, &geom, crs, [](void *arg, sgl::vertex_xyzm *vertex) {
-				    const auto crs_ptr = static_cast<PJ *>(arg);
-				    const auto transformed =
-				        proj_trans(crs_ptr, PJ_FWD, proj_coord(vertex->x, vertex->y, vertex->zm, 0)).xy;
-				    vertex->x = transformed.x;
-				    vertex->y = transformed.y;
-			    });
-
-			    return lstate.Serialize(result, geom);
+			    return TransformGeometry(lstate, crs, blob, result);
 		    });
 	}
 
@@ -482,6 +888,269 @@ struct ST_Transform {
 	}
 };
 
+//======================================================================================================================
+// ST_Transform Filter Pushdown
+//======================================================================================================================
+// A spatial predicate between a transformed column and a constant, e.g. a tile in another coordinate system like
+// "ST_Intersects(ST_Transform(geom, 'EPSG:4326', 'EPSG:3857'), <tile>)", has to transform every row, and can not use an
+// RTREE index or any statistics of the column. Instead, we transform the bounds of the constant back into the source
+// coordinate system once, and add an "ST_Intersects_Extent(geom, <bounds>)" filter on the column itself, which the
+// index scan and the covering filter pushdown can use. The original predicate is kept, the new filter only has to be
+// implied by it.
+//
+// The edges of the box are densified before they are transformed, so that the bounds also contain the parts of the
+// edges that bulge out between the corners. But ST_Transform only transforms the vertices, and an edge of a transformed
+// geometry is a straight line between them, which for most projections (e.g. UTM or lambert conformal conic) is not the
+// transformed edge. Such an edge can cross the constant while the bounds of the original geometry are outside of the
+// transformed bounds. So the filter is only implied for points, whose transformation is exact, and for projections that
+// map boxes onto boxes (the identity, and between EPSG:4326 and web mercator), where the bounds of the transformed
+// geometry are the transformed bounds of the geometry. The "spatial_transform_filter_pushdown" setting disables it.
+
+struct TransformFilterPushdown {
+	static constexpr auto SETTING_NAME = "spatial_transform_filter_pushdown";
+
+	enum class Mode : uint8_t {
+		//! Never add the filter
+		NONE,
+		//! Only add the filter where it is implied by the predicate
+		EXACT
+	};
+
+	static Mode GetMode(ClientContext &context) {
+		Value mode;
+		if (!context.TryGetCurrentSetting(SETTING_NAME, mode) || mode.IsNull()) {
+			return Mode::EXACT;
+		}
+		return StringUtil::CIEquals(mode.ToString(), "none") ? Mode::NONE : Mode::EXACT;
+	}
+
+	static void SetMode(ClientContext &context, SetScope scope, Value &parameter) {
+		if (parameter.IsNull()) {
+			return;
+		}
+		const auto name = StringUtil::Lower(parameter.ToString());
+		if (name != "exact" && name != "none") {
+			throw InvalidInputException("Unknown %s '%s', expected 'exact' or 'none'", SETTING_NAME,
+			                            parameter.ToString());
+		}
+	}
+
+	//! Whether the transformation maps boxes onto boxes, each axis of the result only depending on one axis of the
+	//! input, monotonically
+	static bool MapsBoxesOntoBoxes(const string &source, const string &target) {
+		if (StringUtil::CIEquals(source, target)) {
+			return true;
+		}
+		int zone = 0;
+		bool south = false;
+		const auto source_crs = ST_Transform::GetBuiltinCRS(source, zone, south);
+		const auto target_crs = ST_Transform::GetBuiltinCRS(target, zone, south);
+		return (source_crs == ST_Transform::BuiltinCRS::WGS84 && target_crs == ST_Transform::BuiltinCRS::WEB_MERCATOR) ||
+		       (source_crs == ST_Transform::BuiltinCRS::WEB_MERCATOR && target_crs == ST_Transform::BuiltinCRS::WGS84);
+	}
+
+	//! The number of points to add along each edge of the box when transforming it
+	static constexpr int DENSIFY_POINTS = 21;
+
+	//! The predicates that imply that the bounds of their arguments intersect
+	static bool IsSpatialPredicate(const string &name) {
+		static const case_insensitive_set_t predicates = {
+		    "ST_Equals", "ST_Intersects", "ST_Touches",   "ST_Crosses",          "ST_Within",
+		    "ST_Contains", "ST_Overlaps", "ST_Covers", "ST_CoveredBy", "ST_ContainsProperly", "ST_Intersects_Extent"};
+		return predicates.find(name) != predicates.end();
+	}
+
+	//! Transform the box from the target back into the source coordinate system of the transformation
+	static bool TryGetSourceBounds(ClientContext &context, const string &source, const string &target, bool normalize,
+	                               const sgl::box_xy &box, sgl::box_xy &result) {
+		const auto ctx = ProjModule::GetThreadProjContext();
+		PJ *crs = nullptr;
+		try {
+			crs = ProjTransformCache::Get(context)->Create(ctx, source, target, normalize);
+		} catch (...) {
+			// Leave the error to the execution of ST_Transform itself
+			proj_context_destroy(ctx);
+			return false;
+		}
+
+		SpatialProfileScope profile(SpatialProfileCategory::PROJ_TRANSFORM);
+		const auto ok = proj_trans_bounds(ctx, crs, PJ_INV, box.min.x, box.min.y, box.max.x, box.max.y, &result.min.x,
+		                                  &result.min.y, &result.max.x, &result.max.y, DENSIFY_POINTS);
+		proj_destroy(crs);
+		proj_context_destroy(ctx);
+
+		// Bounds that wrap around the antimeridian have their minimum on the "wrong" side, we dont handle these
+		if (!ok || !std::isfinite(result.min.x) || !std::isfinite(result.min.y) || !std::isfinite(result.max.x) ||
+		    !std::isfinite(result.max.y) || result.min.x > result.max.x || result.min.y > result.max.y) {
+			return false;
+		}
+
+		// ST_Transform may use a built-in projection that differs from PROJ in the last few digits, so widen the
+		// bounds a bit to stay on the safe side
+		const auto margin = (std::max(result.max.x - result.min.x, result.max.y - result.min.y)) * 1e-6;
+		result.min.x -= margin + std::max(1.0, std::abs(result.min.x)) * 1e-9;
+		result.min.y -= margin + std::max(1.0, std::abs(result.min.y)) * 1e-9;
+		result.max.x += margin + std::max(1.0, std::abs(result.max.x)) * 1e-9;
+		result.max.y += margin + std::max(1.0, std::abs(result.max.y)) * 1e-9;
+		return true;
+	}
+
+	//! Create the polygon spanning the box as a constant
+	static Value MakeBoxValue(const sgl::box_xy &box) {
+		double buf[10] = {box.min.x, box.min.y, box.min.x, box.max.y, box.max.x,
+		                  box.max.y, box.max.x, box.min.y, box.min.x, box.min.y};
+
+		sgl::geometry ring(sgl::geometry_type::LINESTRING, false, false);
+		ring.set_vertex_data(reinterpret_cast<const char *>(buf), 5);
+
+		sgl::geometry polygon(sgl::geometry_type::POLYGON, false, false);
+		polygon.append_part(&ring);
+
+		const auto size = Serde::GetRequiredSize(polygon);
+		auto blob = make_unsafe_uniq_array<char>(size);
+		Serde::Serialize(polygon, blob.get(), size);
+
+		auto result = Value::BLOB(const_data_ptr_cast(blob.get()), size);
+		result.Reinterpret(GeoTypes::GEOMETRY());
+		return result;
+	}
+
+	//! If the expression is a spatial predicate between ST_Transform(<expr>, <source>, <target>) and a constant, create
+	//! the extent filter on <expr> that it implies. is_points_only tells whether <expr> only holds points.
+	template <class IS_POINTS_ONLY>
+	static unique_ptr<Expression> TryCreateExtentFilter(ClientContext &context, const Expression &expr,
+	                                                    IS_POINTS_ONLY &&is_points_only) {
+		if (expr.type != ExpressionType::BOUND_FUNCTION) {
+			return nullptr;
+		}
+		auto &func = expr.Cast<BoundFunctionExpression>();
+		if (!IsSpatialPredicate(func.function.name) || func.children.size() != 2 ||
+		    func.children[0]->return_type != GeoTypes::GEOMETRY() ||
+		    func.children[1]->return_type != GeoTypes::GEOMETRY()) {
+			return nullptr;
+		}
+
+		const auto const_idx = func.children[0]->type == ExpressionType::VALUE_CONSTANT ? 0 : 1;
+		const auto &const_expr = *func.children[const_idx];
+		const auto &transform_expr = *func.children[1 - const_idx];
+		if (const_expr.type != ExpressionType::VALUE_CONSTANT || transform_expr.type != ExpressionType::BOUND_FUNCTION) {
+			return nullptr;
+		}
+
+		auto &transform = transform_expr.Cast<BoundFunctionExpression>();
+		if (transform.function.name != "ST_Transform" || transform.children.size() < 3 || !transform.bind_info) {
+			return nullptr;
+		}
+		const auto &source_expr = *transform.children[1];
+		const auto &target_expr = *transform.children[2];
+		if (source_expr.type != ExpressionType::VALUE_CONSTANT || target_expr.type != ExpressionType::VALUE_CONSTANT) {
+			return nullptr;
+		}
+		const auto &source = source_expr.Cast<BoundConstantExpression>().value;
+		const auto &target = target_expr.Cast<BoundConstantExpression>().value;
+		const auto &constant = const_expr.Cast<BoundConstantExpression>().value;
+		if (source.IsNull() || target.IsNull() || constant.IsNull()) {
+			return nullptr;
+		}
+		if (!MapsBoxesOntoBoxes(StringValue::Get(source), StringValue::Get(target)) &&
+		    !is_points_only(*transform.children[0])) {
+			return nullptr;
+		}
+
+		// A NULL or empty constant does not match anything anyway
+		const auto &blob = StringValue::Get(constant);
+		auto target_box = sgl::box_xy::smallest();
+		if (!Serde::TryGetExtentXY(blob.data(), blob.size(), target_box)) {
+			return nullptr;
+		}
+
+		const auto normalize = transform.bind_info->Cast<ST_Transform::BindData>().normalize;
+		sgl::box_xy source_box;
+		if (!TryGetSourceBounds(context, StringValue::Get(source), StringValue::Get(target), normalize, target_box,
+		                        source_box)) {
+			return nullptr;
+		}
+
+		auto &catalog = Catalog::GetSystemCatalog(context);
+		auto &entry = catalog.GetEntry<ScalarFunctionCatalogEntry>(context, DEFAULT_SCHEMA, "ST_Intersects_Extent");
+		auto extent_func = entry.functions.GetFunctionByArguments(context, {GeoTypes::GEOMETRY(), GeoTypes::GEOMETRY()});
+
+		vector<unique_ptr<Expression>> children;
+		children.push_back(transform.children[0]->Copy());
+		children.push_back(make_uniq<BoundConstantExpression>(MakeBoxValue(source_box)));
+		return make_uniq<BoundFunctionExpression>(LogicalType::BOOLEAN, extent_func, std::move(children), nullptr);
+	}
+
+	static void OptimizeRecursive(ClientContext &context, LogicalOperator &op) {
+		if (op.type == LogicalOperatorType::LOGICAL_FILTER) {
+			// The conjuncts of the filter are already split up
+			auto &filter = op.Cast<LogicalFilter>();
+			const auto is_points_only = [&](const Expression &geom_expr) {
+				GeometryStats stats;
+				return GeometryStats::TryGetStatistics(context, *filter.children[0], const_cast<Expression &>(geom_expr),
+				                                       stats) &&
+				       stats.IsPointsOnly();
+			};
+			const auto expr_count = filter.expressions.size();
+			for (idx_t i = 0; i < expr_count; i++) {
+				auto extent_filter = TryCreateExtentFilter(context, *filter.expressions[i], is_points_only);
+				if (extent_filter) {
+					filter.expressions.push_back(std::move(extent_filter));
+				}
+			}
+		} else if (op.type == LogicalOperatorType::LOGICAL_GET) {
+			// Predicates on a single column may have been pushed into the scan as expression filters
+			auto &get = op.Cast<LogicalGet>();
+			for (auto &entry : get.table_filters.filters) {
+				if (entry.second->filter_type != TableFilterType::EXPRESSION_FILTER) {
+					continue;
+				}
+				// The filter is on the column of the table with this index
+				const auto column_idx = entry.first;
+				const auto is_points_only = [&](const Expression &geom_expr) {
+					if (geom_expr.GetExpressionClass() != ExpressionClass::BOUND_REF || !get.function.statistics) {
+						return false;
+					}
+					const auto stats = get.function.statistics(context, get.bind_data.get(), column_idx);
+					return stats && GeometryStats::FromStatistics(*stats).IsPointsOnly();
+				};
+				auto &expr_filter = entry.second->Cast<ExpressionFilter>();
+				auto extent_filter = TryCreateExtentFilter(context, *expr_filter.expr, is_points_only);
+				if (extent_filter) {
+					expr_filter.expr = make_uniq<BoundConjunctionExpression>(
+					    ExpressionType::CONJUNCTION_AND, std::move(expr_filter.expr), std::move(extent_filter));
+				}
+			}
+		}
+
+		for (auto &child : op.children) {
+			OptimizeRecursive(context, *child);
+		}
+	}
+
+	static void Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+		const auto mode = GetMode(input.context);
+		if (mode == Mode::NONE) {
+			return;
+		}
+		OptimizeRecursive(input.context, *plan);
+	}
+
+	static void Register(DatabaseInstance &db) {
+		// This has to run before the RTREE index scan and covering filter optimizers, so that they see the new filters
+		OptimizerExtension optimizer;
+		optimizer.optimize_function = Optimize;
+		db.config.optimizer_extensions.push_back(optimizer);
+
+		db.config.AddExtensionOption(SETTING_NAME,
+		                             "Add a bounding box filter on the column of spatial predicates between "
+		                             "ST_Transform(<column>, ...) and a constant, so that RTREE indexes and statistics of "
+		                             "the column can be used. 'exact' (the default) only adds it for points and for "
+		                             "projections that map boxes onto boxes, and 'none' never adds it",
+		                             LogicalType::VARCHAR, Value("exact"), SetMode);
+	}
+};
+
 //######################################################################################################################
 // Geodesic Functions
 //######################################################################################################################
@@ -495,6 +1164,7 @@ constexpr auto EARTH_F = 1 / 298.257223563;
 
 struct GeodesicLocalState final : FunctionLocalState {
 
+	shared_ptr<GeometryScratchPool> pool;
 	ArenaAllocator arena;
 	GeometryAllocator alloc;
 	geod_geodesic geod = {};
@@ -502,7 +1172,7 @@ struct GeodesicLocalState final : FunctionLocalState {
 	double accum = 0;
 
 	explicit GeodesicLocalState(ClientContext &context, bool is_line)
-	    : arena(BufferAllocator::Get(context)), alloc(arena) {
+	    : pool(GeometryScratchPool::Get(context)), arena(pool->GetAllocator()), alloc(arena) {
 
 		// Initialize the geodesic object for earth
 		geod_init(&geod, EARTH_A, EARTH_F);
@@ -521,7 +1191,7 @@ struct GeodesicLocalState final : FunctionLocalState {
 
 	static GeodesicLocalState &ResetAndGet(ExpressionState &state) {
 		auto &local_state = ExecuteFunctionState::GetFunctionState(state)->Cast<GeodesicLocalState>();
-		local_state.arena.Reset();
+		GeometryScratchPool::Reset(local_state.arena);
 		return local_state;
 	}
 
@@ -1056,27 +1726,194 @@ struct ST_Distance_Spheroid {
 
 struct ST_DWithin_Spheroid {
 
+	// Most pairs are either much closer or much further apart than the distance limit, so we first check cheap but
+	// conservative bounds of the geodesic distance, and only solve the inverse geodesic problem for the pairs the
+	// bounds can not decide:
+	//  - The geodesic is never shorter than the meridian arc between the latitudes of the points, which is at least
+	//    the smallest meridional radius of curvature (at the equator) times the latitude difference.
+	//  - The geodesic is never shorter than the chord between the points (in earth-centered cartesian coordinates).
+	//  - The geodesic is never longer than the section of the ellipsoid by the plane through the points and the center,
+	//    an ellipse whose curvature is at most 1 / b^2/a. So by Schur's comparison theorem, it is never longer than the
+	//    arc of a circle with radius b^2/a over the same chord (for chords up to that radius).
+	enum class BoundResult : uint8_t { OUTSIDE, INSIDE, UNDECIDED };
+
+	// The smallest radius of curvature of the ellipsoid, b^2/a = a * (1 - f)^2
+	static constexpr double MIN_RADIUS = EARTH_A * (1 - EARTH_F) * (1 - EARTH_F);
+	static constexpr double SQUARED_ECCENTRICITY = EARTH_F * (2 - EARTH_F);
+	static constexpr double DEG_TO_RAD = PI / 180.0;
+
+	static void ToCartesian(double lat, double lon, double &x, double &y, double &z) {
+		const auto sin_lat = std::sin(lat * DEG_TO_RAD);
+		const auto cos_lat = std::cos(lat * DEG_TO_RAD);
+		const auto n = EARTH_A / std::sqrt(1 - SQUARED_ECCENTRICITY * sin_lat * sin_lat);
+		x = n * cos_lat * std::cos(lon * DEG_TO_RAD);
+		y = n * cos_lat * std::sin(lon * DEG_TO_RAD);
+		z = n * (1 - SQUARED_ECCENTRICITY) * sin_lat;
+	}
+
+	// Written so that NaN inputs are always undecided
+	static BoundResult CheckBounds(double lat1, double lon1, double lat2, double lon2, double limit) {
+		// Leave invalid latitudes to GeographicLib
+		if (std::abs(lat1) > 90 || std::abs(lat2) > 90) {
+			return BoundResult::UNDECIDED;
+		}
+
+		// Allow for the rounding errors of both the bounds and the exact solution
+		const auto margin = 1e-5 + std::abs(limit) * 1e-9;
+
+		if (std::abs(lat1 - lat2) * DEG_TO_RAD * MIN_RADIUS > limit + margin) {
+			return BoundResult::OUTSIDE;
+		}
+
+		double x1, y1, z1, x2, y2, z2;
+		ToCartesian(lat1, lon1, x1, y1, z1);
+		ToCartesian(lat2, lon2, x2, y2, z2);
+		const auto chord = std::sqrt((x1 - x2) * (x1 - x2) + (y1 - y2) * (y1 - y2) + (z1 - z2) * (z1 - z2));
+
+		if (chord > limit + margin) {
+			return BoundResult::OUTSIDE;
+		}
+		if (chord <= MIN_RADIUS && 2 * MIN_RADIUS * std::asin(chord / (2 * MIN_RADIUS)) + margin <= limit) {
+			return BoundResult::INSIDE;
+		}
+		return BoundResult::UNDECIDED;
+	}
+
 	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
-		using POINT_TYPE = StructTypeBinary<double, double>;
-		using DISTANCE_TYPE = PrimitiveType<double>;
-		using BOOL_TYPE = PrimitiveType<bool>;
+		const auto count = args.size();
+
+		UnifiedVectorFormat p1_format;
+		UnifiedVectorFormat p2_format;
+		UnifiedVectorFormat limit_format;
+		args.data[0].ToUnifiedFormat(count, p1_format);
+		args.data[1].ToUnifiedFormat(count, p2_format);
+		args.data[2].ToUnifiedFormat(count, limit_format);
+
+		// The point children are never NULL, only the points themselves
+		auto &p1_children = StructVector::GetEntries(args.data[0]);
+		auto &p2_children = StructVector::GetEntries(args.data[1]);
+		UnifiedVectorFormat p1_x_format, p1_y_format, p2_x_format, p2_y_format;
+		p1_children[0]->ToUnifiedFormat(count, p1_x_format);
+		p1_children[1]->ToUnifiedFormat(count, p1_y_format);
+		p2_children[0]->ToUnifiedFormat(count, p2_x_format);
+		p2_children[1]->ToUnifiedFormat(count, p2_y_format);
+
+		const auto p1_x = UnifiedVectorFormat::GetData<double>(p1_x_format);
+		const auto p1_y = UnifiedVectorFormat::GetData<double>(p1_y_format);
+		const auto p2_x = UnifiedVectorFormat::GetData<double>(p2_x_format);
+		const auto p2_y = UnifiedVectorFormat::GetData<double>(p2_y_format);
+		const auto limit_data = UnifiedVectorFormat::GetData<double>(limit_format);
+
+		result.SetVectorType(VectorType::FLAT_VECTOR);
+		const auto result_data = FlatVector::GetData<bool>(result);
+		auto &result_validity = FlatVector::Validity(result);
+
+		// First pass: decide what we can from the bounds, in a tight loop without calls into GeographicLib
+		BoundResult bounds[STANDARD_VECTOR_SIZE];
+		for (idx_t i = 0; i < count; i++) {
+			const auto p1_idx = p1_format.sel->get_index(i);
+			const auto p2_idx = p2_format.sel->get_index(i);
+			const auto lat1 = p1_x[p1_x_format.sel->get_index(p1_idx)];
+			const auto lon1 = p1_y[p1_y_format.sel->get_index(p1_idx)];
+			const auto lat2 = p2_x[p2_x_format.sel->get_index(p2_idx)];
+			const auto lon2 = p2_y[p2_y_format.sel->get_index(p2_idx)];
+			const auto limit = limit_data[limit_format.sel->get_index(i)];
+
+			bounds[i] = CheckBounds(lat1, lon1, lat2, lon2, limit);
+			result_data[i] = bounds[i] == BoundResult::INSIDE;
+		}
 
+		// Second pass: handle NULLs, and solve the inverse problem for the pairs that are still undecided
 		geod_geodesic geod = {};
 		geod_init(&geod, EARTH_A, EARTH_F);
 
-		GenericExecutor::ExecuteTernary<POINT_TYPE, POINT_TYPE, DISTANCE_TYPE, BOOL_TYPE>(
-		    args.data[0], args.data[1], args.data[2], result, args.size(),
-		    [&](const POINT_TYPE &p1, const POINT_TYPE &p2, const DISTANCE_TYPE &limit) {
-			    double distance;
-			    geod_inverse(&geod, p1.a_val, p1.b_val, p2.a_val, p2.b_val, &distance, nullptr, nullptr);
-			    return distance <= limit.val;
-		    });
+		for (idx_t i = 0; i < count; i++) {
+			const auto p1_idx = p1_format.sel->get_index(i);
+			const auto p2_idx = p2_format.sel->get_index(i);
+			const auto limit_idx = limit_format.sel->get_index(i);
+			if (!p1_format.validity.RowIsValid(p1_idx) || !p2_format.validity.RowIsValid(p2_idx) ||
+			    !limit_format.validity.RowIsValid(limit_idx)) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			if (bounds[i] != BoundResult::UNDECIDED) {
+				continue;
+			}
+
+			const auto lat1 = p1_x[p1_x_format.sel->get_index(p1_idx)];
+			const auto lon1 = p1_y[p1_y_format.sel->get_index(p1_idx)];
+			const auto lat2 = p2_x[p2_x_format.sel->get_index(p2_idx)];
+			const auto lon2 = p2_y[p2_y_format.sel->get_index(p2_idx)];
+
+			double distance;
+			geod_inverse(&geod, lat1, lon1, lat2, lon2, &distance, nullptr, nullptr);
+			result_data[i] = distance <= limit_data[limit_idx];
+		}
+
+		if (args.AllConstant()) {
+			result.SetVectorType(VectorType::CONSTANT_VECTOR);
+		}
+	}
+
+	// Extract the coordinates of POINT geometries into a POINT_2D vector
+	static void GetPoints(GeodesicLocalState &lstate, Vector &geom_vec, Vector &point_vec, idx_t count) {
+		UnifiedVectorFormat geom_format;
+		geom_vec.ToUnifiedFormat(count, geom_format);
+		const auto geom_data = UnifiedVectorFormat::GetData<string_t>(geom_format);
+
+		auto &point_children = StructVector::GetEntries(point_vec);
+		const auto x_data = FlatVector::GetData<double>(*point_children[0]);
+		const auto y_data = FlatVector::GetData<double>(*point_children[1]);
+
+		for (idx_t i = 0; i < count; i++) {
+			const auto geom_idx = geom_format.sel->get_index(i);
+			if (!geom_format.validity.RowIsValid(geom_idx)) {
+				FlatVector::SetNull(point_vec, i, true);
+				continue;
+			}
+
+			sgl::geometry geom;
+			lstate.Deserialize(geom_data[geom_idx], geom);
+
+			if (geom.get_type() != sgl::geometry_type::POINT) {
+				throw InvalidInputException("ST_DWithin_Spheroid only accepts POINT geometries");
+			}
+			if (geom.is_empty()) {
+				throw InvalidInputException("ST_DWithin_Spheroid does not accept empty geometries");
+			}
+
+			const auto vertex = geom.get_vertex_xy(0);
+			x_data[i] = vertex.x;
+			y_data[i] = vertex.y;
+		}
+	}
+
+	static void ExecuteGeometry(DataChunk &args, ExpressionState &state, Vector &result) {
+		auto &lstate = GeodesicLocalState::ResetAndGet(state);
+		const auto count = args.size();
+
+		DataChunk points;
+		points.InitializeEmpty({GeoTypes::POINT_2D(), GeoTypes::POINT_2D(), LogicalType::DOUBLE});
+
+		Vector p1(GeoTypes::POINT_2D(), count);
+		Vector p2(GeoTypes::POINT_2D(), count);
+		GetPoints(lstate, args.data[0], p1, count);
+		GetPoints(lstate, args.data[1], p2, count);
+
+		points.data[0].Reference(p1);
+		points.data[1].Reference(p2);
+		points.data[2].Reference(args.data[2]);
+		points.SetCardinality(count);
+
+		Execute(points, state, result);
 	}
 
 	static constexpr auto DESCRIPTION = R"(
 		Returns if two POINT_2D's are within a target distance in meters, using an ellipsoidal model of the earths surface
 
 		The input geometry is assumed to be in the [EPSG:4326](https://en.wikipedia.org/wiki/World_Geodetic_System) coordinate system (WGS84), with [latitude, longitude] axis order and the distance is returned in meters. This function uses the [GeographicLib](https://geographiclib.sourceforge.io/) library to solve the [inverse geodesic problem](https://en.wikipedia.org/wiki/Geodesics_on_an_ellipsoid#Solution_of_the_direct_and_inverse_problems), calculating the distance between two points using an ellipsoidal model of the earth. This is a highly accurate method for calculating the distance between two arbitrary points taking the curvature of the earths surface into account, but is also the slowest.
+
+		The GEOMETRY variant only accepts POINT geometries, and can be used as the condition of a spatial join.
 	)";
 
 	// TODO: add example
@@ -1093,6 +1930,16 @@ struct ST_DWithin_Spheroid {
 				variant.SetFunction(Execute);
 			});
 
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.AddParameter("geom1", GeoTypes::GEOMETRY());
+				variant.AddParameter("geom2", GeoTypes::GEOMETRY());
+				variant.AddParameter("distance", LogicalType::DOUBLE);
+				variant.SetReturnType(LogicalType::BOOLEAN);
+
+				variant.SetInit(GeodesicLocalState::InitLine);
+				variant.SetFunction(ExecuteGeometry);
+			});
+
 			func.SetExample(EXAMPLE);
 			func.SetDescription(DESCRIPTION);
 
@@ -1185,18 +2032,74 @@ struct DuckDB_Proj_Compiled_Version {
 	}
 };
 
+struct DuckDB_Proj_Cache_Stats {
+
+	static void Execute(DataChunk &args, ExpressionState &state, Vector &result) {
+		D_ASSERT(args.ColumnCount() == 0);
+		const auto cache = ProjTransformCache::Get(state.GetContext());
+
+		idx_t hits, misses, size, capacity;
+		cache->GetStatistics(hits, misses, size, capacity);
+
+		child_list_t<Value> values;
+		values.emplace_back("hits", Value::UBIGINT(hits));
+		values.emplace_back("misses", Value::UBIGINT(misses));
+		values.emplace_back("size", Value::UBIGINT(size));
+		values.emplace_back("capacity", Value::UBIGINT(capacity));
+		auto val = Value::STRUCT(std::move(values));
+		result.Reference(val);
+	}
+
+	static LogicalType GetReturnType() {
+		child_list_t<LogicalType> children;
+		children.emplace_back("hits", LogicalType::UBIGINT);
+		children.emplace_back("misses", LogicalType::UBIGINT);
+		children.emplace_back("size", LogicalType::UBIGINT);
+		children.emplace_back("capacity", LogicalType::UBIGINT);
+		return LogicalType::STRUCT(std::move(children));
+	}
+
+	static constexpr auto DESCRIPTION = R"(
+		Returns statistics of the cache of coordinate transformations that is shared by all threads of this instance of DuckDB.
+
+		`hits` and `misses` count how often a thread could clone a cached transformation, and how often it had to be resolved from the PROJ database instead. The capacity can be set with the `proj_transform_cache_size` setting.
+	)";
+
+	static constexpr auto EXAMPLE = R"(
+	SELECT duckdb_proj_cache_stats();
+	)";
+
+	static void Register(DatabaseInstance &db) {
+		FunctionBuilder::RegisterScalar(db, "DuckDB_Proj_Cache_Stats", [](ScalarFunctionBuilder &func) {
+			func.AddVariant([](ScalarFunctionVariantBuilder &variant) {
+				variant.SetReturnType(GetReturnType());
+
+				variant.SetFunction(Execute);
+			});
+
+			func.SetExample(EXAMPLE);
+			func.SetDescription(DESCRIPTION);
+
+			func.SetTag("ext", "spatial");
+			func.SetTag("category", "meta");
+		});
+	}
+};
+
 } // namespace
 
 //######################################################################################################################
 // Module Registration
 //######################################################################################################################
-void RegisterProjModule(DatabaseInstance &db) {
+void InitializeProjModule() {
+	ProjModule::InitializeVFS();
+}
 
-	// Register the VFS for the proj.db database
-	ProjModule::RegisterVFS(db);
+void RegisterProjModule(DatabaseInstance &db) {
 
 	// Coordinate Transform Function
 	ST_Transform::Register(db);
+	TransformFilterPushdown::Register(db);
 
 	// Geodesic Functions
 	ST_Area_Spheroid::Register(db);
@@ -1208,6 +2111,12 @@ void RegisterProjModule(DatabaseInstance &db) {
 	// Meta functions for proj lib
 	DuckDB_Proj_Version::Register(db);
 	DuckDB_Proj_Compiled_Version::Register(db);
+	DuckDB_Proj_Cache_Stats::Register(db);
+
+	db.config.AddExtensionOption(ProjTransformCache::SETTING_NAME,
+	                             "The number of coordinate transformations to keep in the cache that is shared by all "
+	                             "threads, so they don't have to be resolved from the PROJ database again",
+	                             LogicalType::UBIGINT, Value::UBIGINT(ProjTransformCache::DEFAULT_CAPACITY));
 }
 
 } // namespace duckdb
\ No newline at end of file
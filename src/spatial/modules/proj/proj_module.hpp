@@ -6,4 +6,8 @@ class DatabaseInstance;
 
 void RegisterProjModule(DatabaseInstance &db);
 
-} // namespace duckdb
\ No newline at end of file
+//! Point PROJ to the proj.db database embedded in the extension, if that has not been done yet. This has to happen
+//! before PROJ is used, also by other libraries such as GDAL.
+void InitializeProjModule();
+
+} // namespace duckdb
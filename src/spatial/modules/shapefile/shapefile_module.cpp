@@ -4,6 +4,7 @@
 #include "spatial/spatial_types.hpp"
 
 #include "duckdb/common/multi_file/multi_file_reader.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
 #include "duckdb/function/replacement_scan.hpp"
 #include "duckdb/main/extension_util.hpp"
 #include "duckdb/parser/expression/constant_expression.hpp"
@@ -100,9 +101,10 @@ struct EncodingUtil {
 	// convert ISO-8859-1 to UTF-8
 	// mind = blown
 	// out must be at least 2x the size of in
-	static idx_t LatinToUTF8Buffer(const_data_ptr_t in, data_ptr_t out) {
+	static idx_t LatinToUTF8Buffer(const_data_ptr_t in, idx_t in_len, data_ptr_t out) {
 		idx_t len = 0;
-		while (*in) {
+		const auto end = in + in_len;
+		while (in != end) {
 			if (*in < 128) {
 				*out++ = *in++;
 				len += 1;
@@ -274,44 +276,96 @@ struct ST_ReadSHP {
 	// Bind
 	//------------------------------------------------------------------------------------------------------------------
 	struct ShapefileBindData final : TableFunctionData {
-		string file_name;
+		//! The files to read (from a list or a glob), they all have to have the attributes of the first
+		vector<string> file_names;
 		int shape_count;
 		int shape_type;
 		double min_bound[4];
 		double max_bound[4];
 		AttributeEncoding attribute_encoding;
+		vector<string> attribute_names;
 		vector<LogicalType> attribute_types;
+		//! The index of the filename column (after the geometry), if requested
+		idx_t filename_column_idx = DConstants::INVALID_INDEX;
 
-		explicit ShapefileBindData(string file_name_p)
-		    : file_name(std::move(file_name_p)), shape_count(0), shape_type(0), min_bound {0, 0, 0, 0},
+		explicit ShapefileBindData(vector<string> file_names_p)
+		    : file_names(std::move(file_names_p)), shape_count(0), shape_type(0), min_bound {0, 0, 0, 0},
 		      max_bound {0, 0, 0, 0}, attribute_encoding(AttributeEncoding::LATIN1) {
 		}
-	};
-
-	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
-	                                     vector<LogicalType> &return_types, vector<string> &names) {
-
-		auto file_name = StringValue::Get(input.inputs[0]);
-		auto result = make_uniq<ShapefileBindData>(file_name);
-
-		auto &fs = FileSystem::GetFileSystem(context);
-		auto shp_handle = OpenSHPFile(fs, file_name);
 
-		// Get info about the geometry
-		SHPGetInfo(shp_handle.get(), &result->shape_count, &result->shape_type, result->min_bound, result->max_bound);
+		bool IsMultiFile() const {
+			return file_names.size() > 1;
+		}
+	};
 
+	static void CheckShapeType(int shape_type) {
 		// Ensure we have a supported shape type
 		auto valid_types = {SHPT_NULL, SHPT_POINT, SHPT_ARC, SHPT_POLYGON, SHPT_MULTIPOINT};
 		bool is_valid_type = false;
 		for (auto type : valid_types) {
-			if (result->shape_type == type) {
+			if (shape_type == type) {
 				is_valid_type = true;
 				break;
 			}
 		}
 		if (!is_valid_type) {
-			throw InvalidInputException("Invalid shape type %d", result->shape_type);
+			throw InvalidInputException("Invalid shape type %d", shape_type);
+		}
+	}
+
+	static LogicalType GetAttributeType(DBFHandle dbf_handle, int field_idx, AttributeEncoding attribute_encoding,
+	                                    string &name) {
+		char field_name[12]; // Max field name length is 11 + null terminator
+		int field_width = 0;
+		int field_precision = 0;
+		memset(field_name, 0, sizeof(field_name));
+
+		auto field_type = DBFGetFieldInfo(dbf_handle, field_idx, field_name, &field_width, &field_precision);
+		name = field_name;
+
+		switch (field_type) {
+		case FTString:
+			return attribute_encoding == AttributeEncoding::BLOB ? LogicalType::BLOB : LogicalType::VARCHAR;
+		case FTInteger:
+			return LogicalType::INTEGER;
+		case FTDouble:
+			if (field_precision == 0 && field_width < 19) {
+				return LogicalType::BIGINT;
+			}
+			return LogicalType::DOUBLE;
+		case FTDate:
+			// Dates are stored as 8-char strings
+			// YYYYMMDD
+			return LogicalType::DATE;
+		case FTLogical:
+			return LogicalType::BOOLEAN;
+		default:
+			throw InvalidInputException("DBF field type %d not supported", field_type);
 		}
+	}
+
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names) {
+
+		// Expand lists and globs
+		vector<string> file_names;
+		const auto multi_file_reader = MultiFileReader::Create(input.table_function);
+		const auto file_list =
+		    multi_file_reader->CreateFileList(context, input.inputs[0], FileGlobOptions::DISALLOW_EMPTY);
+		for (const auto &file : file_list->GetAllFiles()) {
+			file_names.push_back(file.path);
+		}
+		auto result = make_uniq<ShapefileBindData>(std::move(file_names));
+
+		// The schema is that of the first file
+		const auto &file_name = result->file_names[0];
+
+		auto &fs = FileSystem::GetFileSystem(context);
+		auto shp_handle = OpenSHPFile(fs, file_name);
+
+		// Get info about the geometry
+		SHPGetInfo(shp_handle.get(), &result->shape_count, &result->shape_type, result->min_bound, result->max_bound);
+		CheckShapeType(result->shape_type);
 
 		auto base_name = file_name.substr(0, file_name.find_last_of('.'));
 
@@ -331,6 +385,7 @@ struct ST_ReadSHP {
 			}
 		}
 
+		bool add_filename = false;
 		for (auto &kv : input.named_parameters) {
 			if (kv.first == "encoding") {
 				auto encoding = StringUtil::Lower(StringValue::Get(kv.second));
@@ -350,6 +405,9 @@ struct ST_ReadSHP {
 			if (kv.first == "spatial_filter_box") {
 				auto filter_box = StructValue::GetChildren(kv.second);
 			}
+			if (kv.first == "filename") {
+				add_filename = BooleanValue::Get(kv.second);
+			}
 		}
 
 		// Get info about the attributes
@@ -362,49 +420,25 @@ struct ST_ReadSHP {
 
 		// Then return the attributes
 		auto field_count = DBFGetFieldCount(dbf_handle.get());
-		char field_name[12]; // Max field name length is 11 + null terminator
-		int field_width = 0;
-		int field_precision = 0;
-		memset(field_name, 0, sizeof(field_name));
-
 		for (int i = 0; i < field_count; i++) {
-			auto field_type = DBFGetFieldInfo(dbf_handle.get(), i, field_name, &field_width, &field_precision);
-
-			LogicalType type;
-			switch (field_type) {
-			case FTString:
-				type = result->attribute_encoding == AttributeEncoding::BLOB ? LogicalType::BLOB : LogicalType::VARCHAR;
-				break;
-			case FTInteger:
-				type = LogicalType::INTEGER;
-				break;
-			case FTDouble:
-				if (field_precision == 0 && field_width < 19) {
-					type = LogicalType::BIGINT;
-				} else {
-					type = LogicalType::DOUBLE;
-				}
-				break;
-			case FTDate:
-				// Dates are stored as 8-char strings
-				// YYYYMMDD
-				type = LogicalType::DATE;
-				break;
-			case FTLogical:
-				type = LogicalType::BOOLEAN;
-				break;
-			default:
-				throw InvalidInputException("DBF field type %d not supported", field_type);
-			}
-			names.emplace_back(field_name);
+			string field_name;
+			auto type = GetAttributeType(dbf_handle.get(), i, result->attribute_encoding, field_name);
+			names.push_back(field_name);
 			return_types.push_back(type);
+			result->attribute_names.push_back(field_name);
 			result->attribute_types.push_back(type);
 		}
 
-		// Always return geometry last
+		// Always return geometry last, followed by the filename
 		return_types.push_back(GeoTypes::GEOMETRY());
 		names.push_back("geom");
 
+		if (add_filename) {
+			result->filename_column_idx = names.size();
+			return_types.push_back(LogicalType::VARCHAR);
+			names.push_back("filename");
+		}
+
 		// Deduplicate field names if necessary
 		for (size_t i = 0; i < names.size(); i++) {
 			idx_t count = 1;
@@ -421,118 +455,275 @@ struct ST_ReadSHP {
 	//------------------------------------------------------------------------------------------------------------------
 	// Init Global
 	//------------------------------------------------------------------------------------------------------------------
+	// The records are handed out to the threads in ranges of one vector each. The .shx index gives the offset of
+	// every record, so each thread can read its ranges independently through its own handles.
+	// When reading multiple files, the files are handed out instead, and each file is read by the thread claiming it.
 	struct ShapefileGlobalState final : GlobalTableFunctionState {
-		int shape_idx;
+		atomic<idx_t> shape_idx;
+		idx_t shape_count;
+		idx_t max_threads;
+		vector<idx_t> column_ids;
+		atomic<idx_t> file_idx;
+		idx_t file_count;
+
+		explicit ShapefileGlobalState(idx_t shape_count_p, idx_t max_threads_p, vector<idx_t> column_ids_p,
+		                              idx_t file_count_p)
+		    : shape_idx(0), shape_count(shape_count_p), max_threads(max_threads_p),
+		      column_ids(std::move(column_ids_p)), file_idx(0), file_count(file_count_p) {
+		}
+
+		idx_t MaxThreads() const override {
+			return max_threads;
+		}
+
+		// Claim the next range of records, returns false once all records have been claimed
+		bool GetNextRange(int &record_start, int &record_count) {
+			const auto start = shape_idx.fetch_add(STANDARD_VECTOR_SIZE);
+			if (start >= shape_count) {
+				return false;
+			}
+			record_start = static_cast<int>(start);
+			record_count = static_cast<int>(MinValue<idx_t>(STANDARD_VECTOR_SIZE, shape_count - start));
+			return true;
+		}
+	};
+
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+		auto &bind_data = input.bind_data->Cast<ShapefileBindData>();
+
+		// Every thread opens its own handles (and loads the .shx index), so dont use more threads than ranges
+		const auto shape_count = static_cast<idx_t>(MaxValue<int>(bind_data.shape_count, 0));
+		const auto range_count = bind_data.IsMultiFile() ? bind_data.file_names.size()
+		                                                 : (shape_count + STANDARD_VECTOR_SIZE - 1) / STANDARD_VECTOR_SIZE;
+		const auto max_threads = MaxValue<idx_t>(MinValue<idx_t>(context.db->NumberOfThreads(), range_count), 1);
+
+		auto result = make_uniq<ShapefileGlobalState>(shape_count, max_threads, input.column_ids,
+		                                              bind_data.file_names.size());
+		return std::move(result);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Init Local
+	//------------------------------------------------------------------------------------------------------------------
+	struct ShapefileLocalState final : LocalTableFunctionState {
+		// Only used for the record offsets of the .shx index and the field layout of the .dbf. The records themselves
+		// are read through the file handles. Both are only opened if the geometry or any attribute is projected.
 		SHPHandlePtr shp_handle;
+		unique_ptr<FileHandle> shp_file;
 		DBFHandlePtr dbf_handle;
+		unique_ptr<FileHandle> dbf_file;
 		ArenaAllocator arena;
-		vector<idx_t> column_ids;
+		bool read_geometry;
+		bool read_attributes;
+		// The first record of the range currently being read
+		int record_start;
 
-		explicit ShapefileGlobalState(ClientContext &context, const string &file_name, vector<idx_t> column_ids_p)
-		    : shape_idx(0), arena(BufferAllocator::Get(context)), column_ids(std::move(column_ids_p)) {
+		// When reading multiple files, the file this thread is reading, its shape type and the records left in it
+		idx_t file_idx;
+		int shape_type;
+		int shape_count;
+
+		ShapefileLocalState(ClientContext &context, bool read_geometry_p, bool read_attributes_p)
+		    : arena(BufferAllocator::Get(context)), read_geometry(read_geometry_p), read_attributes(read_attributes_p),
+		      record_start(0), file_idx(0), shape_type(SHPT_NULL), shape_count(0) {
+		}
+
+		void Open(ClientContext &context, const string &file_name, bool multi_file) {
 			auto &fs = FileSystem::GetFileSystem(context);
 
-			shp_handle = OpenSHPFile(fs, file_name);
+			// The number of records of each file is only known once it is opened
+			if (read_geometry || multi_file) {
+				shp_handle = OpenSHPFile(fs, file_name);
+				shp_file = read_geometry ? fs.OpenFile(file_name, FileFlags::FILE_FLAGS_READ) : nullptr;
+			}
 
-			// Remove file extension and replace with .dbf
-			auto dot_idx = file_name.find_last_of('.');
-			auto base_name = file_name.substr(0, dot_idx);
-			dbf_handle = OpenDBFFile(fs, base_name + ".dbf");
+			if (read_attributes) {
+				// Remove file extension and replace with .dbf
+				auto dot_idx = file_name.find_last_of('.');
+				auto dbf_name = file_name.substr(0, dot_idx) + ".dbf";
+				dbf_handle = OpenDBFFile(fs, dbf_name);
+				dbf_file = fs.OpenFile(dbf_name, FileFlags::FILE_FLAGS_READ);
+			}
 		}
 	};
 
-	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+	static unique_ptr<LocalTableFunctionState> InitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+	                                                     GlobalTableFunctionState *global_state) {
 		auto &bind_data = input.bind_data->Cast<ShapefileBindData>();
-		auto result = make_uniq<ShapefileGlobalState>(context, bind_data.file_name, input.column_ids);
+
+		// The geometry is always the last column
+		const auto geometry_idx = bind_data.attribute_types.size();
+		bool read_geometry = false;
+		bool read_attributes = false;
+		for (const auto column_id : input.column_ids) {
+			read_geometry |= column_id == geometry_idx;
+			read_attributes |= column_id < geometry_idx;
+		}
+
+		auto result = make_uniq<ShapefileLocalState>(context.client, read_geometry, read_attributes);
+		if (!bind_data.IsMultiFile()) {
+			result->Open(context.client, bind_data.file_names[0], false);
+			result->shape_type = bind_data.shape_type;
+		}
 		return std::move(result);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
 	// Geometry Conversion
 	//------------------------------------------------------------------------------------------------------------------
-	struct ConvertPoint {
-		static void Convert(sgl::geometry &point, const SHPObjectPtr &shape, ArenaAllocator &arena) {
+	// The records are decoded straight from the raw .shp bytes instead of through SHPReadObject. The vertices of a
+	// (XY) record are already stored as interleaved x/y doubles, so the geometries reference them in place and are
+	// serialized without any intermediate copies.
+	struct ShapeRecord {
+		int shape_type = SHPT_NULL;
+		int part_count = 0;
+		int vertex_count = 0;
+		// Not necessarily aligned, so only accessed through Load
+		const_data_ptr_t part_starts = nullptr;
+		const_data_ptr_t vertices = nullptr;
+
+		int PartStart(int part_idx) const {
+			return Load<int32_t>(part_starts + part_idx * sizeof(int32_t));
+		}
+		int PartEnd(int part_idx) const {
+			return part_idx == part_count - 1 ? vertex_count : PartStart(part_idx + 1);
+		}
+		const_data_ptr_t Vertex(int vertex_idx) const {
+			return vertices + vertex_idx * sizeof(double) * 2;
+		}
+		double X(int vertex_idx) const {
+			return Load<double>(Vertex(vertex_idx));
+		}
+		double Y(int vertex_idx) const {
+			return Load<double>(Vertex(vertex_idx) + sizeof(double));
+		}
+	};
 
-			// Create a point
-			point.set_type(sgl::geometry_type::POINT);
+	// Decode the content of a record (without the record header)
+	static ShapeRecord DecodeRecord(const_data_ptr_t data, idx_t size, int record_idx) {
+		const auto invalid = [&]() {
+			return InvalidInputException("Invalid or corrupt record %d in shapefile", record_idx);
+		};
 
-			// Allocate memory for the vertex
-			const auto vertex_mem = arena.AllocateAligned(sizeof(double) * 2);
-			const auto vertex_ptr = reinterpret_cast<double *>(vertex_mem);
+		ShapeRecord record;
+		if (size < sizeof(int32_t)) {
+			// Empty records are treated as NULL shapes
+			return record;
+		}
+		record.shape_type = Load<int32_t>(data);
 
-			// Set the vertex data
-			vertex_ptr[0] = shape->padfX[0];
-			vertex_ptr[1] = shape->padfY[0];
+		switch (record.shape_type) {
+		case SHPT_NULL:
+			break;
+		case SHPT_POINT:
+			// type, x, y
+			if (size < 20) {
+				throw invalid();
+			}
+			record.vertex_count = 1;
+			record.vertices = data + 4;
+			break;
+		case SHPT_MULTIPOINT: {
+			// type, bbox, vertex count, vertices
+			if (size < 40) {
+				throw invalid();
+			}
+			record.vertex_count = Load<int32_t>(data + 36);
+			record.vertices = data + 40;
+			if (record.vertex_count < 0 || 40 + static_cast<idx_t>(record.vertex_count) * 16 > size) {
+				throw invalid();
+			}
+		} break;
+		case SHPT_ARC:
+		case SHPT_POLYGON: {
+			// type, bbox, part count, vertex count, part starts, vertices
+			if (size < 44) {
+				throw invalid();
+			}
+			record.part_count = Load<int32_t>(data + 36);
+			record.vertex_count = Load<int32_t>(data + 40);
+			if (record.part_count < 0 || record.vertex_count < 0) {
+				throw invalid();
+			}
+			const auto vertex_offset = 44 + static_cast<idx_t>(record.part_count) * 4;
+			if (vertex_offset + static_cast<idx_t>(record.vertex_count) * 16 > size) {
+				throw invalid();
+			}
+			record.part_starts = data + 44;
+			record.vertices = data + vertex_offset;
+
+			// The parts have to be in order, and within the vertices
+			int last_start = 0;
+			for (int i = 0; i < record.part_count; i++) {
+				const auto start = record.PartStart(i);
+				if (start < last_start || start > record.vertex_count || (i == 0 && start != 0)) {
+					throw invalid();
+				}
+				last_start = start;
+			}
+		} break;
+		default:
+			throw InvalidInputException("Shape type %d not supported", record.shape_type);
+		}
+		return record;
+	}
 
-			point.set_vertex_data(vertex_mem, 1);
+	struct ConvertPoint {
+		static void Convert(sgl::geometry &point, const ShapeRecord &shape, ArenaAllocator &arena) {
+			point.set_type(sgl::geometry_type::POINT);
+			point.set_vertex_data(shape.Vertex(0), 1);
 		}
 	};
 
 	struct ConvertLineString {
-		static void Convert(sgl::geometry &line, const SHPObjectPtr &shape, ArenaAllocator &arena) {
-			if (shape->nParts == 1) {
+		static void Convert(sgl::geometry &line, const ShapeRecord &shape, ArenaAllocator &arena) {
+			if (shape.part_count == 1) {
 				// Create a line
 				line.set_type(sgl::geometry_type::LINESTRING);
-
-				// Allocate memory for the vertices
-				const auto vertex_mem = arena.AllocateAligned(sizeof(double) * 2 * shape->nVertices);
-				const auto vertex_ptr = reinterpret_cast<double *>(vertex_mem);
-
-				// Set the vertex data
-				for (int i = 0; i < shape->nVertices; i++) {
-					vertex_ptr[i * 2] = shape->padfX[i];
-					vertex_ptr[i * 2 + 1] = shape->padfY[i];
-				}
-				line.set_vertex_data(vertex_mem, shape->nVertices);
-
-				// Return the line
+				line.set_vertex_data(shape.Vertex(0), shape.vertex_count);
 				return;
 			}
 
 			// Else, create a multi-line
 			line.set_type(sgl::geometry_type::MULTI_LINESTRING);
 
-			auto start = shape->panPartStart[0];
-			for (int i = 0; i < shape->nParts; i++) {
-				const auto end = i == shape->nParts - 1 ? shape->nVertices : shape->panPartStart[i + 1];
-				const auto line_size = end - start;
+			for (int i = 0; i < shape.part_count; i++) {
+				const auto start = shape.PartStart(i);
+				const auto end = shape.PartEnd(i);
 
 				// Allocate a new line
 				const auto line_mem = arena.AllocateAligned(sizeof(sgl::geometry));
 				const auto line_ptr = new (line_mem) sgl::geometry(sgl::geometry_type::LINESTRING);
 
-				// Allocate memory for the vertices
-				const auto vertex_mem = arena.AllocateAligned(sizeof(double) * 2 * line_size);
-				const auto vertex_ptr = reinterpret_cast<double *>(vertex_mem);
-
-				for (int j = 0; j < line_size; j++) {
-					const auto offset = start + j;
-
-					vertex_ptr[j * 2] = shape->padfX[offset];
-					vertex_ptr[j * 2 + 1] = shape->padfY[offset];
-				}
-
 				// Set the vertex data and append to the multi-line
-				line_ptr->set_vertex_data(vertex_mem, line_size);
+				line_ptr->set_vertex_data(shape.Vertex(start), end - start);
 				line.append_part(line_ptr);
-
-				start = end;
 			}
 		}
 	};
 
 	struct ConvertPolygon {
-		static void Convert(sgl::geometry &poly, const SHPObjectPtr &shape, ArenaAllocator &arena) {
+		static sgl::geometry *MakeRing(const ShapeRecord &shape, int ring_idx, ArenaAllocator &arena) {
+			const auto start = shape.PartStart(ring_idx);
+			const auto end = shape.PartEnd(ring_idx);
+
+			const auto ring_mem = arena.AllocateAligned(sizeof(sgl::geometry));
+			const auto ring = new (ring_mem) sgl::geometry(sgl::geometry_type::LINESTRING);
+			ring->set_vertex_data(shape.Vertex(start), end - start);
+			return ring;
+		}
+
+		static void Convert(sgl::geometry &poly, const ShapeRecord &shape, ArenaAllocator &arena) {
 			// First off, check if there are more than one polygon.
 			// Each polygon is identified by a part with clockwise winding order
 			// we calculate the winding order by checking the sign of the area
 			vector<int> polygon_part_starts;
-			for (int i = 0; i < shape->nParts; i++) {
-				const auto start = shape->panPartStart[i];
-				const auto end = i == shape->nParts - 1 ? shape->nVertices : shape->panPartStart[i + 1];
+			for (int i = 0; i < shape.part_count; i++) {
+				const auto start = shape.PartStart(i);
+				const auto end = shape.PartEnd(i);
 				double area = 0;
 				for (int j = start; j < end - 1; j++) {
-					area += (shape->padfX[j] * shape->padfY[j + 1]) - (shape->padfX[j + 1] * shape->padfY[j]);
+					area += (shape.X(j) * shape.Y(j + 1)) - (shape.X(j + 1) * shape.Y(j));
 				}
 				if (area < 0) {
 					polygon_part_starts.push_back(i);
@@ -545,29 +736,9 @@ struct ST_ReadSHP {
 				// we still fall back and convert it to a single polygon.
 				poly.set_type(sgl::geometry_type::POLYGON);
 
-				auto start = shape->panPartStart[0];
-				for (int i = 0; i < shape->nParts; i++) {
-					const auto end = i == shape->nParts - 1 ? shape->nVertices : shape->panPartStart[i + 1];
-
-					const auto ring_size = end - start;
-					const auto ring_mem = arena.AllocateAligned(sizeof(sgl::geometry));
-					const auto ring = new (ring_mem) sgl::geometry(sgl::geometry_type::LINESTRING);
-
-					const auto vertex_mem = arena.AllocateAligned(sizeof(double) * 2 * ring_size);
-					const auto vertex_ptr = reinterpret_cast<double *>(vertex_mem);
-
-					for (int j = 0; j < ring_size; j++) {
-						const auto offset = start + j;
-						vertex_ptr[j * 2] = shape->padfX[offset];
-						vertex_ptr[j * 2 + 1] = shape->padfY[offset];
-					}
-
-					ring->set_vertex_data(vertex_mem, ring_size);
-					poly.append_part(ring);
-
-					start = end;
+				for (int i = 0; i < shape.part_count; i++) {
+					poly.append_part(MakeRing(shape, i, arena));
 				}
-
 				return;
 			}
 
@@ -577,32 +748,14 @@ struct ST_ReadSHP {
 			for (size_t polygon_idx = 0; polygon_idx < polygon_part_starts.size(); polygon_idx++) {
 				const auto part_start = polygon_part_starts[polygon_idx];
 				const auto part_end = polygon_idx == polygon_part_starts.size() - 1
-				                          ? shape->nParts
+				                          ? shape.part_count
 				                          : polygon_part_starts[polygon_idx + 1];
 
 				const auto poly_mem = arena.AllocateAligned(sizeof(sgl::geometry));
 				const auto poly_ptr = new (poly_mem) sgl::geometry(sgl::geometry_type::POLYGON);
 
 				for (auto ring_idx = part_start; ring_idx < part_end; ring_idx++) {
-					const auto start = shape->panPartStart[ring_idx];
-					const auto end =
-					    ring_idx == shape->nParts - 1 ? shape->nVertices : shape->panPartStart[ring_idx + 1];
-					const auto ring_size = end - start;
-
-					const auto ring_mem = arena.AllocateAligned(sizeof(sgl::geometry));
-					const auto ring_ptr = new (ring_mem) sgl::geometry(sgl::geometry_type::LINESTRING);
-
-					const auto vertex_mem = arena.AllocateAligned(sizeof(double) * 2 * ring_size);
-					const auto vertex_ptr = reinterpret_cast<double *>(vertex_mem);
-
-					for (int j = 0; j < ring_size; j++) {
-						const auto offset = start + j;
-						vertex_ptr[j * 2] = shape->padfX[offset];
-						vertex_ptr[j * 2 + 1] = shape->padfY[offset];
-					}
-
-					ring_ptr->set_vertex_data(vertex_mem, ring_size);
-					poly_ptr->append_part(ring_ptr);
+					poly_ptr->append_part(MakeRing(shape, ring_idx, arena));
 				}
 
 				poly.append_part(poly_ptr);
@@ -611,31 +764,65 @@ struct ST_ReadSHP {
 	};
 
 	struct ConvertMultiPoint {
-		static void Convert(sgl::geometry &mpoint, const SHPObjectPtr &shape, ArenaAllocator &arena) {
+		static void Convert(sgl::geometry &mpoint, const ShapeRecord &shape, ArenaAllocator &arena) {
 			mpoint.set_type(sgl::geometry_type::MULTI_POINT);
 
-			for (int i = 0; i < shape->nVertices; i++) {
+			for (int i = 0; i < shape.vertex_count; i++) {
 				const auto point_mem = arena.AllocateAligned(sizeof(sgl::geometry));
 				const auto point_ptr = new (point_mem) sgl::geometry(sgl::geometry_type::POINT);
 
-				const auto vertex_mem = arena.AllocateAligned(sizeof(double) * 2);
-				const auto vertex_ptr = reinterpret_cast<double *>(vertex_mem);
-
-				vertex_ptr[0] = shape->padfX[i];
-				vertex_ptr[1] = shape->padfY[i];
-
-				point_ptr->set_vertex_data(vertex_mem, 1);
+				point_ptr->set_vertex_data(shape.Vertex(i), 1);
 				mpoint.append_part(point_ptr);
 			}
 		}
 	};
 
+	// Read the raw bytes of a range of records. If the records are stored back to back (as they usually are), this is
+	// a single read. Returns the start of each record (including the record header) in the buffer.
+	static data_ptr_t ReadRecords(SHPHandle shp_handle, FileHandle &shp_file, int record_start, idx_t count,
+	                              ArenaAllocator &arena, vector<idx_t> &record_offsets) {
+		record_offsets.resize(count);
+
+		idx_t total_size = 0;
+		bool contiguous = true;
+		for (idx_t i = 0; i < count; i++) {
+			const auto record_idx = record_start + static_cast<int>(i);
+			record_offsets[i] = total_size;
+			total_size += shp_handle->panRecSize[record_idx] + 8;
+			if (i > 0) {
+				const auto prev_idx = record_idx - 1;
+				const auto prev_end =
+				    static_cast<idx_t>(shp_handle->panRecOffset[prev_idx]) + shp_handle->panRecSize[prev_idx] + 8;
+				contiguous &= shp_handle->panRecOffset[record_idx] == prev_end;
+			}
+		}
+
+		const auto buffer = arena.AllocateAligned(total_size);
+		if (contiguous) {
+			shp_file.Read(buffer, total_size, shp_handle->panRecOffset[record_start]);
+		} else {
+			for (idx_t i = 0; i < count; i++) {
+				const auto record_idx = record_start + static_cast<int>(i);
+				shp_file.Read(buffer + record_offsets[i], shp_handle->panRecSize[record_idx] + 8,
+				              shp_handle->panRecOffset[record_idx]);
+			}
+		}
+		return buffer;
+	}
+
 	template <class OP>
-	static void ConvertGeomLoop(Vector &result, int record_start, idx_t count, SHPHandle &shp_handle,
-	                            ArenaAllocator &arena) {
+	static void ConvertGeomLoop(Vector &result, int record_start, idx_t count, SHPHandle shp_handle,
+	                            FileHandle &shp_file, ArenaAllocator &arena) {
+		vector<idx_t> record_offsets;
+		const auto buffer = ReadRecords(shp_handle, shp_file, record_start, count, arena, record_offsets);
+
 		for (idx_t result_idx = 0; result_idx < count; result_idx++) {
-			auto shape = SHPObjectPtr(SHPReadObject(shp_handle, record_start++));
-			if (shape->nSHPType == SHPT_NULL) {
+			const auto record_idx = record_start + static_cast<int>(result_idx);
+			const auto record_data = buffer + record_offsets[result_idx] + 8;
+			const auto record_size = shp_handle->panRecSize[record_idx];
+
+			const auto shape = DecodeRecord(record_data, record_size, record_idx);
+			if (shape.shape_type == SHPT_NULL) {
 				FlatVector::SetNull(result, result_idx, true);
 				continue;
 			}
@@ -656,22 +843,22 @@ struct ST_ReadSHP {
 	}
 
 	static void ConvertGeometryVector(Vector &result, int record_start, idx_t count, SHPHandle shp_handle,
-	                                  ArenaAllocator &arena, int geom_type) {
+	                                  FileHandle &shp_file, ArenaAllocator &arena, int geom_type) {
 		switch (geom_type) {
 		case SHPT_NULL:
 			FlatVector::Validity(result).SetAllInvalid(count);
 			break;
 		case SHPT_POINT:
-			ConvertGeomLoop<ConvertPoint>(result, record_start, count, shp_handle, arena);
+			ConvertGeomLoop<ConvertPoint>(result, record_start, count, shp_handle, shp_file, arena);
 			break;
 		case SHPT_ARC:
-			ConvertGeomLoop<ConvertLineString>(result, record_start, count, shp_handle, arena);
+			ConvertGeomLoop<ConvertLineString>(result, record_start, count, shp_handle, shp_file, arena);
 			break;
 		case SHPT_POLYGON:
-			ConvertGeomLoop<ConvertPolygon>(result, record_start, count, shp_handle, arena);
+			ConvertGeomLoop<ConvertPolygon>(result, record_start, count, shp_handle, shp_file, arena);
 			break;
 		case SHPT_MULTIPOINT:
-			ConvertGeomLoop<ConvertMultiPoint>(result, record_start, count, shp_handle, arena);
+			ConvertGeomLoop<ConvertMultiPoint>(result, record_start, count, shp_handle, shp_file, arena);
 			break;
 		default:
 			throw InvalidInputException("Shape type %d not supported", geom_type);
@@ -681,127 +868,240 @@ struct ST_ReadSHP {
 	//------------------------------------------------------------------------------------------------------------------
 	// Attribute Conversion
 	//------------------------------------------------------------------------------------------------------------------
+	// The DBF records of a range are read in a single read, and each projected field is then decoded column-wise from
+	// the fixed-width record buffer, instead of reading (and re-parsing) the record for every cell through shapelib.
+
+	struct DBFRecords {
+		const_data_ptr_t data = nullptr;
+		// The number of records that are actually present in the .dbf, attributes of the others are NULL
+		idx_t count = 0;
+		idx_t record_length = 0;
+	};
+
+	// A field value, with the surrounding whitespace trimmed (like shapelib does for strings)
+	struct DBFField {
+		const char *ptr;
+		idx_t len;
+
+		bool IsNull(char field_type) const {
+			switch (field_type) {
+			case 'N':
+			case 'F':
+				return len == 0 || ptr[0] == '*';
+			case 'D':
+				return len == 0 || (len >= 8 && memcmp(ptr, "00000000", 8) == 0);
+			case 'L':
+				return len == 0 || ptr[0] == '?';
+			default:
+				return len == 0;
+			}
+		}
+	};
+
+	static DBFRecords ReadDBFRecords(DBFHandle dbf_handle, FileHandle &dbf_file, int record_start, idx_t count,
+	                                 ArenaAllocator &arena) {
+		DBFRecords records;
+		records.record_length = static_cast<idx_t>(dbf_handle->nRecordLength);
+		if (record_start >= dbf_handle->nRecords) {
+			return records;
+		}
+		records.count = MinValue<idx_t>(count, static_cast<idx_t>(dbf_handle->nRecords - record_start));
+
+		const auto size = records.count * records.record_length;
+		const auto offset = static_cast<idx_t>(dbf_handle->nHeaderLength) +
+		                    static_cast<idx_t>(record_start) * records.record_length;
+		const auto buffer = arena.AllocateAligned(size);
+		dbf_file.Read(buffer, size, offset);
+		records.data = buffer;
+		return records;
+	}
+
+	static DBFField GetField(const DBFRecords &records, idx_t row_idx, int field_offset, int field_size) {
+		auto ptr = const_char_ptr_cast(records.data + row_idx * records.record_length + field_offset);
+		// Values end at the first NUL, if any
+		auto len = static_cast<idx_t>(field_size);
+		const auto nul = static_cast<const char *>(memchr(ptr, '\0', len));
+		if (nul) {
+			len = static_cast<idx_t>(nul - ptr);
+		}
+		while (len > 0 && *ptr == ' ') {
+			ptr++;
+			len--;
+		}
+		while (len > 0 && ptr[len - 1] == ' ') {
+			len--;
+		}
+		return {ptr, len};
+	}
+
+	// Parse the leading integer of a field, like atoi
+	template <class T>
+	static T ParseInteger(const DBFField &field) {
+		idx_t pos = 0;
+		bool negative = false;
+		if (pos < field.len && (field.ptr[pos] == '-' || field.ptr[pos] == '+')) {
+			negative = field.ptr[pos] == '-';
+			pos++;
+		}
+		T result = 0;
+		for (; pos < field.len; pos++) {
+			const auto digit = field.ptr[pos] - '0';
+			if (digit < 0 || digit > 9) {
+				break;
+			}
+			result = result * 10 + digit;
+		}
+		return negative ? -result : result;
+	}
 
 	struct ConvertBlobAttribute {
 		using TYPE = string_t;
-		static string_t Convert(Vector &result, DBFHandle dbf_handle, int record_idx, int field_idx) {
-			auto value = DBFReadStringAttribute(dbf_handle, record_idx, field_idx);
-			return StringVector::AddString(result, const_char_ptr_cast(value));
+		static string_t Convert(Vector &result, const DBFField &field) {
+			return StringVector::AddStringOrBlob(result, field.ptr, field.len);
 		}
 	};
 
 	struct ConvertIntegerAttribute {
 		using TYPE = int32_t;
-		static int32_t Convert(Vector &, DBFHandle dbf_handle, int record_idx, int field_idx) {
-			return DBFReadIntegerAttribute(dbf_handle, record_idx, field_idx);
+		static int32_t Convert(Vector &, const DBFField &field) {
+			return static_cast<int32_t>(ParseInteger<int64_t>(field));
 		}
 	};
 
 	struct ConvertBigIntAttribute {
 		using TYPE = int64_t;
-		static int64_t Convert(Vector &, DBFHandle dbf_handle, int record_idx, int field_idx) {
-			return static_cast<int64_t>(DBFReadDoubleAttribute(dbf_handle, record_idx, field_idx));
+		static int64_t Convert(Vector &, const DBFField &field) {
+			// These are numeric fields without decimals, that fit in a BIGINT
+			return ParseInteger<int64_t>(field);
 		}
 	};
 
 	struct ConvertDoubleAttribute {
 		using TYPE = double;
-		static double Convert(Vector &, DBFHandle dbf_handle, int record_idx, int field_idx) {
-			return DBFReadDoubleAttribute(dbf_handle, record_idx, field_idx);
+		static double Convert(Vector &, const DBFField &field) {
+			double result;
+			if (TryCast::Operation<string_t, double>(string_t(field.ptr, static_cast<uint32_t>(field.len)), result,
+			                                         false)) {
+				return result;
+			}
+			// Fall back to parsing the leading number, like atof
+			char buffer[256];
+			const auto len = MinValue<idx_t>(field.len, sizeof(buffer) - 1);
+			memcpy(buffer, field.ptr, len);
+			buffer[len] = '\0';
+			return std::atof(buffer);
 		}
 	};
 
 	struct ConvertDateAttribute {
 		using TYPE = date_t;
-		static date_t Convert(Vector &, DBFHandle dbf_handle, int record_idx, int field_idx) {
+		static date_t Convert(Vector &, const DBFField &field) {
 			// XBase stores dates as 8-char strings (without separators)
-			// but DuckDB expects a date string with separators.
-			auto value = DBFReadStringAttribute(dbf_handle, record_idx, field_idx);
-			char date_with_separator[11];
-			memcpy(date_with_separator, value, 4);
-			date_with_separator[4] = '-';
-			memcpy(date_with_separator + 5, value + 4, 2);
-			date_with_separator[7] = '-';
-			memcpy(date_with_separator + 8, value + 6, 2);
-			date_with_separator[10] = '\0';
-			return Date::FromString(date_with_separator);
+			int32_t parts[3] = {0, 0, 0};
+			const int widths[3] = {4, 2, 2};
+			bool valid = field.len == 8;
+			idx_t pos = 0;
+			for (idx_t i = 0; i < 3 && valid; i++) {
+				for (int j = 0; j < widths[i]; j++) {
+					const auto digit = field.ptr[pos++] - '0';
+					if (digit < 0 || digit > 9) {
+						valid = false;
+						break;
+					}
+					parts[i] = parts[i] * 10 + digit;
+				}
+			}
+			if (!valid || !Date::IsValid(parts[0], parts[1], parts[2])) {
+				throw InvalidInputException("Invalid date in DBF field: '%s'", string(field.ptr, field.len));
+			}
+			return Date::FromDate(parts[0], parts[1], parts[2]);
 		}
 	};
 
 	struct ConvertBooleanAttribute {
 		using TYPE = bool;
-		static bool Convert(Vector &result, DBFHandle dbf_handle, int record_idx, int field_idx) {
-			return *DBFReadLogicalAttribute(dbf_handle, record_idx, field_idx) == 'T';
+		static bool Convert(Vector &, const DBFField &field) {
+			return field.ptr[0] == 'T';
 		}
 	};
 
 	template <class OP>
-	static void ConvertAttributeLoop(Vector &result, int record_start, idx_t count, DBFHandle dbf_handle,
-	                                 int field_idx) {
-		int record_idx = record_start;
+	static void ConvertAttributeLoop(Vector &result, const DBFRecords &records, idx_t count, int field_offset,
+	                                 int field_size, char field_type) {
+		const auto result_data = FlatVector::GetData<typename OP::TYPE>(result);
 		for (idx_t row_idx = 0; row_idx < count; row_idx++) {
-			if (DBFIsAttributeNULL(dbf_handle, record_idx, field_idx)) {
+			if (row_idx >= records.count) {
+				FlatVector::SetNull(result, row_idx, true);
+				continue;
+			}
+			const auto field = GetField(records, row_idx, field_offset, field_size);
+			if (field.IsNull(field_type)) {
 				FlatVector::SetNull(result, row_idx, true);
 			} else {
-				FlatVector::GetData<typename OP::TYPE>(result)[row_idx] =
-				    OP::Convert(result, dbf_handle, record_idx, field_idx);
+				result_data[row_idx] = OP::Convert(result, field);
 			}
-			record_idx++;
 		}
 	}
 
-	static void ConvertStringAttributeLoop(Vector &result, int record_start, idx_t count, DBFHandle dbf_handle,
-	                                       int field_idx, AttributeEncoding attribute_encoding) {
-		int record_idx = record_start;
+	static void ConvertStringAttributeLoop(Vector &result, const DBFRecords &records, idx_t count, int field_offset,
+	                                       int field_size, char field_type, AttributeEncoding attribute_encoding) {
+		const auto result_data = FlatVector::GetData<string_t>(result);
 		vector<data_t> conversion_buffer;
 		for (idx_t row_idx = 0; row_idx < count; row_idx++) {
-			if (DBFIsAttributeNULL(dbf_handle, record_idx, field_idx)) {
+			if (row_idx >= records.count) {
+				FlatVector::SetNull(result, row_idx, true);
+				continue;
+			}
+			const auto field = GetField(records, row_idx, field_offset, field_size);
+			if (field.IsNull(field_type)) {
 				FlatVector::SetNull(result, row_idx, true);
+				continue;
+			}
+			string_t result_str = {};
+			if (attribute_encoding == AttributeEncoding::LATIN1) {
+				conversion_buffer.resize(field.len * 2); // worst case (all non-ascii chars)
+				const auto in_ptr = const_data_ptr_cast(field.ptr);
+				auto out_len = EncodingUtil::LatinToUTF8Buffer(in_ptr, field.len, conversion_buffer.data());
+				result_str = StringVector::AddString(result, const_char_ptr_cast(conversion_buffer.data()), out_len);
 			} else {
-				auto string_bytes = DBFReadStringAttribute(dbf_handle, record_idx, field_idx);
-				string_t result_str = {};
-				if (attribute_encoding == AttributeEncoding::LATIN1) {
-					conversion_buffer.resize(strlen(string_bytes) * 2 + 1); // worst case (all non-ascii chars)
-					auto out_len =
-					    EncodingUtil::LatinToUTF8Buffer(const_data_ptr_cast(string_bytes), conversion_buffer.data());
-					result_str =
-					    StringVector::AddString(result, const_char_ptr_cast(conversion_buffer.data()), out_len);
-				} else {
-					result_str = StringVector::AddString(result, const_char_ptr_cast(string_bytes));
-				}
-				if (!Utf8Proc::IsValid(result_str.GetDataUnsafe(), result_str.GetSize())) {
-					throw InvalidInputException("Could not decode VARCHAR field as valid UTF-8, try passing "
-					                            "encoding='blob' to skip decoding of string attributes");
-				}
-				FlatVector::GetData<string_t>(result)[row_idx] = result_str;
+				result_str = StringVector::AddString(result, field.ptr, field.len);
+			}
+			if (!Utf8Proc::IsValid(result_str.GetDataUnsafe(), result_str.GetSize())) {
+				throw InvalidInputException("Could not decode VARCHAR field as valid UTF-8, try passing "
+				                            "encoding='blob' to skip decoding of string attributes");
 			}
-			record_idx++;
+			result_data[row_idx] = result_str;
 		}
 	}
 
-	static void ConvertAttributeVector(Vector &result, int record_start, idx_t count, DBFHandle dbf_handle,
+	static void ConvertAttributeVector(Vector &result, const DBFRecords &records, idx_t count, DBFHandle dbf_handle,
 	                                   int field_idx, AttributeEncoding attribute_encoding) {
+		const auto field_offset = dbf_handle->panFieldOffset[field_idx];
+		const auto field_size = dbf_handle->panFieldSize[field_idx];
+		const auto field_type = dbf_handle->pachFieldType[field_idx];
+
 		switch (result.GetType().id()) {
 		case LogicalTypeId::BLOB:
-			ConvertAttributeLoop<ConvertBlobAttribute>(result, record_start, count, dbf_handle, field_idx);
+			ConvertAttributeLoop<ConvertBlobAttribute>(result, records, count, field_offset, field_size, field_type);
 			break;
 		case LogicalTypeId::VARCHAR:
-			ConvertStringAttributeLoop(result, record_start, count, dbf_handle, field_idx, attribute_encoding);
+			ConvertStringAttributeLoop(result, records, count, field_offset, field_size, field_type,
+			                           attribute_encoding);
 			break;
 		case LogicalTypeId::INTEGER:
-			ConvertAttributeLoop<ConvertIntegerAttribute>(result, record_start, count, dbf_handle, field_idx);
+			ConvertAttributeLoop<ConvertIntegerAttribute>(result, records, count, field_offset, field_size, field_type);
 			break;
 		case LogicalTypeId::BIGINT:
-			ConvertAttributeLoop<ConvertBigIntAttribute>(result, record_start, count, dbf_handle, field_idx);
+			ConvertAttributeLoop<ConvertBigIntAttribute>(result, records, count, field_offset, field_size, field_type);
 			break;
 		case LogicalTypeId::DOUBLE:
-			ConvertAttributeLoop<ConvertDoubleAttribute>(result, record_start, count, dbf_handle, field_idx);
+			ConvertAttributeLoop<ConvertDoubleAttribute>(result, records, count, field_offset, field_size, field_type);
 			break;
 		case LogicalTypeId::DATE:
-			ConvertAttributeLoop<ConvertDateAttribute>(result, record_start, count, dbf_handle, field_idx);
+			ConvertAttributeLoop<ConvertDateAttribute>(result, records, count, field_offset, field_size, field_type);
 			break;
 		case LogicalTypeId::BOOLEAN:
-			ConvertAttributeLoop<ConvertBooleanAttribute>(result, record_start, count, dbf_handle, field_idx);
+			ConvertAttributeLoop<ConvertBooleanAttribute>(result, records, count, field_offset, field_size, field_type);
 			break;
 		default:
 			throw InvalidInputException("Attribute type %s not supported", result.GetType().ToString());
@@ -812,34 +1112,105 @@ struct ST_ReadSHP {
 	// Execute
 	//------------------------------------------------------------------------------------------------------------------
 
+	// Claim and open the next file, and check that its attributes match those of the first file
+	static bool OpenNextFile(ClientContext &context, const ShapefileBindData &bind_data,
+	                         ShapefileGlobalState &gstate, ShapefileLocalState &lstate) {
+		const auto file_idx = gstate.file_idx++;
+		if (file_idx >= gstate.file_count) {
+			return false;
+		}
+		const auto &file_name = bind_data.file_names[file_idx];
+		lstate.Open(context, file_name, true);
+
+		double min_bound[4];
+		double max_bound[4];
+		SHPGetInfo(lstate.shp_handle.get(), &lstate.shape_count, &lstate.shape_type, min_bound, max_bound);
+		CheckShapeType(lstate.shape_type);
+
+		if (lstate.dbf_handle) {
+			const auto field_count = DBFGetFieldCount(lstate.dbf_handle.get());
+			bool matches = static_cast<idx_t>(field_count) == bind_data.attribute_types.size();
+			for (int i = 0; matches && i < field_count; i++) {
+				string field_name;
+				const auto type = GetAttributeType(lstate.dbf_handle.get(), i, bind_data.attribute_encoding, field_name);
+				matches = type == bind_data.attribute_types[i] && field_name == bind_data.attribute_names[i];
+			}
+			if (!matches) {
+				throw InvalidInputException("Shapefile \"%s\" does not have the same attributes as \"%s\"", file_name,
+				                            bind_data.file_names[0]);
+			}
+		}
+
+		lstate.file_idx = file_idx;
+		lstate.record_start = 0;
+		return true;
+	}
+
+	// Claim the next range of records, or when reading multiple files, the next range of the current file
+	static bool GetNextRange(ClientContext &context, const ShapefileBindData &bind_data, ShapefileGlobalState &gstate,
+	                         ShapefileLocalState &lstate, int &record_start, int &record_count) {
+		if (!bind_data.IsMultiFile()) {
+			if (!gstate.GetNextRange(record_start, record_count)) {
+				return false;
+			}
+			lstate.record_start = record_start;
+			return true;
+		}
+
+		while (true) {
+			if (lstate.shp_handle && lstate.record_start < lstate.shape_count) {
+				record_start = lstate.record_start;
+				record_count = MinValue<int>(STANDARD_VECTOR_SIZE, lstate.shape_count - record_start);
+				lstate.record_start += record_count;
+				return true;
+			}
+			if (!OpenNextFile(context, bind_data, gstate, lstate)) {
+				return false;
+			}
+		}
+	}
+
 	static void Execute(ClientContext &context, TableFunctionInput &input, DataChunk &output) {
 		auto &bind_data = input.bind_data->Cast<ShapefileBindData>();
 		auto &gstate = input.global_state->Cast<ShapefileGlobalState>();
+		auto &lstate = input.local_state->Cast<ShapefileLocalState>();
+
+		// Claim the next range of records
+		int record_start;
+		int output_size;
+		if (!GetNextRange(context, bind_data, gstate, lstate, record_start, output_size)) {
+			output.SetCardinality(0);
+			return;
+		}
 
 		// Reset the buffer allocator
-		gstate.arena.Reset();
+		lstate.arena.Reset();
+
+		// Read the attribute records of the range at once
+		DBFRecords records;
+		if (lstate.dbf_handle) {
+			records =
+			    ReadDBFRecords(lstate.dbf_handle.get(), *lstate.dbf_file, record_start, output_size, lstate.arena);
+		}
 
-		// Calculate how many record we can fit in the output
-		const auto output_size = std::min<int>(STANDARD_VECTOR_SIZE, bind_data.shape_count - gstate.shape_idx);
-		const auto record_start = gstate.shape_idx;
 		for (idx_t col_idx = 0; col_idx < output.ColumnCount(); col_idx++) {
 
 			// Projected column indices
 			const auto projected_col_idx = gstate.column_ids[col_idx];
 
 			auto &col_vec = output.data[col_idx];
-			if (col_vec.GetType() == GeoTypes::GEOMETRY()) {
-				ConvertGeometryVector(col_vec, record_start, output_size, gstate.shp_handle.get(), gstate.arena,
-				                      bind_data.shape_type);
+			if (projected_col_idx == bind_data.filename_column_idx) {
+				col_vec.Reference(Value(bind_data.file_names[lstate.file_idx]));
+			} else if (col_vec.GetType() == GeoTypes::GEOMETRY()) {
+				ConvertGeometryVector(col_vec, record_start, output_size, lstate.shp_handle.get(), *lstate.shp_file,
+				                      lstate.arena, lstate.shape_type);
 			} else {
 				// The geometry is always last, so we can use the projected column index directly
 				const auto field_idx = static_cast<int>(projected_col_idx);
-				ConvertAttributeVector(col_vec, record_start, output_size, gstate.dbf_handle.get(), field_idx,
+				ConvertAttributeVector(col_vec, records, output_size, lstate.dbf_handle.get(), field_idx,
 				                       bind_data.attribute_encoding);
 			}
 		}
-		// Update the shape index
-		gstate.shape_idx += output_size;
 
 		// Set the cardinality of the output
 		output.SetCardinality(output_size);
@@ -853,15 +1224,41 @@ struct ST_ReadSHP {
 	                          const GlobalTableFunctionState *global_state) {
 
 		auto &gstate = global_state->Cast<ShapefileGlobalState>();
-		auto &bind_data = bind_data_p->Cast<ShapefileBindData>();
+		if (gstate.file_count > 1) {
+			const auto claimed = MinValue<idx_t>(gstate.file_idx.load(), gstate.file_count);
+			return 100 * static_cast<double>(claimed) / static_cast<double>(gstate.file_count);
+		}
+		if (gstate.shape_count == 0) {
+			return 100;
+		}
+		const auto claimed = MinValue<idx_t>(gstate.shape_idx.load(), gstate.shape_count);
+		return 100 * static_cast<double>(claimed) / static_cast<double>(gstate.shape_count);
+	}
 
-		return static_cast<double>(gstate.shape_idx) / static_cast<double>(bind_data.shape_count);
+	static OperatorPartitionData GetPartitionData(ClientContext &context, TableFunctionGetPartitionInput &input) {
+		if (input.partition_info.RequiresPartitionColumns()) {
+			throw InternalException("ST_ReadSHP::GetPartitionData: partition columns not supported");
+		}
+		// The ranges (or files) are claimed in order, so their index preserves the order of the records
+		auto &bind_data = input.bind_data->Cast<ShapefileBindData>();
+		auto &lstate = input.local_state->Cast<ShapefileLocalState>();
+		if (bind_data.IsMultiFile()) {
+			return OperatorPartitionData(lstate.file_idx);
+		}
+		return OperatorPartitionData(static_cast<idx_t>(lstate.record_start) / STANDARD_VECTOR_SIZE);
 	}
 
 	static unique_ptr<NodeStatistics> GetCardinality(ClientContext &context, const FunctionData *data) {
 		auto &bind_data = data->Cast<ShapefileBindData>();
 		auto result = make_uniq<NodeStatistics>();
 
+		if (bind_data.IsMultiFile()) {
+			// Assume the files are about as large as the first
+			result->has_estimated_cardinality = true;
+			result->estimated_cardinality = bind_data.shape_count * bind_data.file_names.size();
+			return result;
+		}
+
 		// This is the maximum number of shapes in a single file
 		result->has_max_cardinality = true;
 		result->max_cardinality = bind_data.shape_count;
@@ -888,13 +1285,15 @@ struct ST_ReadSHP {
 	// Register
 	//------------------------------------------------------------------------------------------------------------------
 	static void Register(DatabaseInstance &db) {
-		TableFunction read_func("ST_ReadSHP", {LogicalType::VARCHAR}, Execute, Bind, InitGlobal);
+		TableFunction read_func("ST_ReadSHP", {LogicalType::VARCHAR}, Execute, Bind, InitGlobal, InitLocal);
 
 		read_func.named_parameters["encoding"] = LogicalType::VARCHAR;
+		read_func.named_parameters["filename"] = LogicalType::BOOLEAN;
 		read_func.table_scan_progress = GetProgress;
+		read_func.get_partition_data = GetPartitionData;
 		read_func.cardinality = GetCardinality;
 		read_func.projection_pushdown = true;
-		ExtensionUtil::RegisterFunction(db, read_func);
+		ExtensionUtil::RegisterFunction(db, MultiFileReader::CreateFunctionSet(read_func));
 
 		// Replacement scan
 		auto &config = DBConfig::GetConfig(db);
@@ -0,0 +1,301 @@
+#include "spatial/operators/covering_filter_optimizer.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/spatial_types.hpp"
+#include "spatial/util/math.hpp"
+
+#include "duckdb/main/database.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/expression_filter.hpp"
+#include "duckdb/planner/filter/struct_filter.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+
+namespace duckdb {
+
+//------------------------------------------------------------------------------
+// Covering Filter Optimizer
+//------------------------------------------------------------------------------
+// GeoParquet 1.1 files can store a "covering" struct column holding the bounding box of the geometry in each row,
+// which Parquet keeps min/max statistics for. A spatial predicate between the geometry column and a constant implies
+// that the box of each row intersects the box of the constant, which we push into the scan as filters on the fields
+// of the covering column. The scan can then skip every row group whose statistics are outside of the query box. The
+// predicate itself is kept, the filters only have to be implied by it.
+//
+// We can't read the "covering" key of the GeoParquet metadata here, so the covering column is recognized by its name
+// ("bbox" or "<geometry column>_bbox") and fields, and only when the scan has a single geometry column.
+
+namespace {
+
+// All of these imply bounding box intersection
+const case_insensitive_set_t spatial_predicates = {
+    "ST_Equals",   "ST_Intersects", "ST_Touches",   "ST_Crosses",          "ST_Within",         "ST_Contains",
+    "ST_Overlaps", "ST_Covers",     "ST_CoveredBy", "ST_ContainsProperly", "ST_WithinProperly", "ST_Intersects_Extent"};
+
+struct CoveringColumn {
+	idx_t geom_idx = DConstants::INVALID_INDEX;
+	idx_t bbox_idx = DConstants::INVALID_INDEX;
+	//! The child index and type of the xmin, ymin, xmax and ymax fields
+	idx_t field_idx[4] = {};
+	LogicalType field_type[4];
+};
+
+bool TryGetCoveringColumn(const LogicalGet &get, CoveringColumn &result) {
+	const auto &types = get.returned_types;
+	const auto &names = get.names;
+
+	for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+		if (types[col_idx] != GeoTypes::GEOMETRY()) {
+			continue;
+		}
+		if (result.geom_idx != DConstants::INVALID_INDEX) {
+			// We dont know which of the geometry columns the covering belongs to
+			return false;
+		}
+		result.geom_idx = col_idx;
+	}
+	if (result.geom_idx == DConstants::INVALID_INDEX) {
+		return false;
+	}
+
+	const auto geom_bbox_name = names[result.geom_idx] + "_bbox";
+	for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+		if (types[col_idx].id() != LogicalTypeId::STRUCT) {
+			continue;
+		}
+		if (!StringUtil::CIEquals(names[col_idx], "bbox") && !StringUtil::CIEquals(names[col_idx], geom_bbox_name)) {
+			continue;
+		}
+
+		static const char *field_names[4] = {"xmin", "ymin", "xmax", "ymax"};
+		idx_t found = 0;
+		const auto &children = StructType::GetChildTypes(types[col_idx]);
+		for (idx_t field = 0; field < 4; field++) {
+			for (idx_t child_idx = 0; child_idx < children.size(); child_idx++) {
+				const auto &child = children[child_idx];
+				if (!StringUtil::CIEquals(child.first, field_names[field])) {
+					continue;
+				}
+				if (child.second.id() != LogicalTypeId::FLOAT && child.second.id() != LogicalTypeId::DOUBLE) {
+					return false;
+				}
+				result.field_idx[field] = child_idx;
+				result.field_type[field] = child.second;
+				found++;
+				break;
+			}
+		}
+		if (found == 4) {
+			result.bbox_idx = col_idx;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Get the box that the covering has to intersect for the predicate to hold
+template <class F>
+bool TryGetFilterBounds(const Expression &expr, F &&is_geom_column, sgl::box_xy &bounds) {
+	if (expr.GetExpressionClass() != ExpressionClass::BOUND_FUNCTION) {
+		return false;
+	}
+	auto &func = expr.Cast<BoundFunctionExpression>();
+	const auto is_distance = StringUtil::CIEquals(func.function.name, "ST_DWithin");
+	if (!is_distance && spatial_predicates.find(func.function.name) == spatial_predicates.end()) {
+		return false;
+	}
+	if (func.children.size() != (is_distance ? 3 : 2)) {
+		return false;
+	}
+
+	// One side has to be the geometry column, and the other a constant
+	auto &lhs = *func.children[0];
+	auto &rhs = *func.children[1];
+	auto &column_expr = is_geom_column(lhs) ? lhs : rhs;
+	auto &constant_expr = &column_expr == &lhs ? rhs : lhs;
+	if (!is_geom_column(column_expr) || constant_expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT ||
+	    constant_expr.return_type != GeoTypes::GEOMETRY()) {
+		return false;
+	}
+
+	auto &constant = constant_expr.Cast<BoundConstantExpression>().value;
+	if (constant.IsNull()) {
+		return false;
+	}
+	const auto &blob = StringValue::Get(constant);
+	bounds = sgl::box_xy::smallest();
+	if (!Serde::TryGetExtentXY(blob.data(), blob.size(), bounds)) {
+		return false;
+	}
+
+	if (is_distance) {
+		auto &distance_expr = *func.children[2];
+		if (distance_expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+			return false;
+		}
+		auto &distance_value = distance_expr.Cast<BoundConstantExpression>().value;
+		if (distance_value.IsNull()) {
+			return false;
+		}
+		const auto distance = distance_value.GetValue<double>();
+		if (!(distance >= 0)) {
+			return false;
+		}
+		bounds.min.x -= distance;
+		bounds.min.y -= distance;
+		bounds.max.x += distance;
+		bounds.max.y += distance;
+	}
+	return true;
+}
+
+// The bound has to be rounded so that the filter is looser than the predicate, never stricter
+Value GetBoundValue(const LogicalType &type, const double value, const bool round_up) {
+	if (type.id() == LogicalTypeId::FLOAT) {
+		return Value::FLOAT(round_up ? MathUtil::DoubleToFloatUp(value) : MathUtil::DoubleToFloatDown(value));
+	}
+	return Value::DOUBLE(value);
+}
+
+void PushCoveringFilters(LogicalGet &get, const CoveringColumn &covering, const sgl::box_xy &bounds) {
+	// The covering column has to be read by the scan to be filtered on, but is not projected out if it wasn't already
+	auto &column_ids = get.GetColumnIds();
+	auto found = false;
+	for (auto &column_id : column_ids) {
+		if (column_id.GetPrimaryIndex() == covering.bbox_idx) {
+			found = true;
+			break;
+		}
+	}
+	if (!found) {
+		if (get.projection_ids.empty()) {
+			for (idx_t i = 0; i < column_ids.size(); i++) {
+				get.projection_ids.push_back(i);
+			}
+		}
+		get.AddColumnId(covering.bbox_idx);
+	}
+
+	// xmin <= max.x, ymin <= max.y, xmax >= min.x, ymax >= min.y
+	const double limits[4] = {bounds.max.x, bounds.max.y, bounds.min.x, bounds.min.y};
+	for (idx_t field = 0; field < 4; field++) {
+		const auto is_min = field < 2;
+		const auto &field_type = covering.field_type[field];
+		const auto comparison =
+		    is_min ? ExpressionType::COMPARE_LESSTHANOREQUALTO : ExpressionType::COMPARE_GREATERTHANOREQUALTO;
+		auto constant_filter = make_uniq<ConstantFilter>(comparison, GetBoundValue(field_type, limits[field], is_min));
+
+		const auto &field_name = StructType::GetChildName(get.returned_types[covering.bbox_idx],
+		                                                  covering.field_idx[field]);
+		auto struct_filter =
+		    make_uniq<StructFilter>(covering.field_idx[field], field_name, std::move(constant_filter));
+		get.table_filters.PushFilter(ColumnIndex(covering.bbox_idx), std::move(struct_filter));
+	}
+}
+
+void TryPushCoveringFilter(LogicalGet &get, optional_ptr<LogicalFilter> filter) {
+	if (!get.function.filter_pushdown) {
+		return;
+	}
+
+	CoveringColumn covering;
+	if (!TryGetCoveringColumn(get, covering)) {
+		return;
+	}
+
+	// The filters are all AND'ed together, so intersect the bounds of all predicates
+	auto has_bounds = false;
+	sgl::box_xy query_bounds = {};
+	const auto add_bounds = [&](const sgl::box_xy &bounds) {
+		if (!has_bounds) {
+			has_bounds = true;
+			query_bounds = bounds;
+			return;
+		}
+		query_bounds.min.x = MaxValue(query_bounds.min.x, bounds.min.x);
+		query_bounds.min.y = MaxValue(query_bounds.min.y, bounds.min.y);
+		query_bounds.max.x = MinValue(query_bounds.max.x, bounds.max.x);
+		query_bounds.max.y = MinValue(query_bounds.max.y, bounds.max.y);
+	};
+
+	// Predicates in a filter on top of the scan
+	if (filter) {
+		const auto &column_ids = get.GetColumnIds();
+		const auto is_geom_column = [&](const Expression &expr) {
+			if (expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+				return false;
+			}
+			auto &binding = expr.Cast<BoundColumnRefExpression>().binding;
+			return binding.table_index == get.table_index && binding.column_index < column_ids.size() &&
+			       column_ids[binding.column_index].GetPrimaryIndex() == covering.geom_idx;
+		};
+		for (auto &expr : filter->expressions) {
+			sgl::box_xy bounds;
+			if (TryGetFilterBounds(*expr, is_geom_column, bounds)) {
+				add_bounds(bounds);
+			}
+		}
+	}
+
+	// Predicates that have already been pushed into the scan as expression filters on the geometry column
+	const auto entry = get.table_filters.filters.find(covering.geom_idx);
+	if (entry != get.table_filters.filters.end() && entry->second->filter_type == TableFilterType::EXPRESSION_FILTER) {
+		const auto is_geom_column = [&](const Expression &expr) {
+			return expr.GetExpressionClass() == ExpressionClass::BOUND_REF;
+		};
+		sgl::box_xy bounds;
+		if (TryGetFilterBounds(*entry->second->Cast<ExpressionFilter>().expr, is_geom_column, bounds)) {
+			add_bounds(bounds);
+		}
+	}
+
+	if (has_bounds) {
+		PushCoveringFilters(get, covering, query_bounds);
+	}
+}
+
+void OptimizeCoveringFilters(ClientContext &context, unique_ptr<LogicalOperator> &plan) {
+	auto &op = *plan;
+	if (op.type == LogicalOperatorType::LOGICAL_FILTER && op.children.front()->type == LogicalOperatorType::LOGICAL_GET) {
+		TryPushCoveringFilter(op.children.front()->Cast<LogicalGet>(), op.Cast<LogicalFilter>());
+	} else if (op.type == LogicalOperatorType::LOGICAL_GET) {
+		TryPushCoveringFilter(op.Cast<LogicalGet>(), nullptr);
+	}
+
+	for (auto &child : plan->children) {
+		if (child->type == LogicalOperatorType::LOGICAL_GET && op.type == LogicalOperatorType::LOGICAL_FILTER) {
+			// Already handled together with the filter
+			continue;
+		}
+		OptimizeCoveringFilters(context, child);
+	}
+}
+
+void Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	Value enabled;
+	if (input.context.TryGetCurrentSetting("spatial_covering_filter_pushdown", enabled) && !enabled.IsNull() &&
+	    !BooleanValue::Get(enabled)) {
+		return;
+	}
+	OptimizeCoveringFilters(input.context, plan);
+}
+
+} // namespace
+
+void CoveringFilterOptimizer::Register(DatabaseInstance &db) {
+	OptimizerExtension optimizer;
+	optimizer.optimize_function = Optimize;
+	db.config.optimizer_extensions.push_back(optimizer);
+
+	db.config.AddExtensionOption("spatial_covering_filter_pushdown",
+	                             "Push the bounds of spatial predicates into GeoParquet 'bbox' covering columns, so "
+	                             "that row groups outside of them can be skipped",
+	                             LogicalType::BOOLEAN, Value::BOOLEAN(true));
+}
+
+} // namespace duckdb
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace duckdb {
+
+class DatabaseInstance;
+
+//! Pushes the bounds of spatial predicates on a geometry column into a GeoParquet 1.1 style "bbox" covering column
+//! of the same scan, e.g. STRUCT(xmin, ymin, xmax, ymax), so that row groups can be skipped based on its statistics
+struct CoveringFilterOptimizer {
+	static void Register(DatabaseInstance &db);
+};
+
+} // namespace duckdb
@@ -0,0 +1,339 @@
+#include "spatial/operators/spatial_index_join_physical.hpp"
+#include "spatial/geometry/geometry_type.hpp"
+#include "spatial/geometry/spatial_key.hpp"
+#include "spatial/index/rtree/rtree_index.hpp"
+#include "spatial/util/math.hpp"
+#include "spatial_join_logical.hpp"
+
+#include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/execution/operator/join/physical_comparison_join.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/storage/data_table.hpp"
+#include "duckdb/transaction/duck_transaction.hpp"
+
+namespace duckdb {
+
+PhysicalSpatialIndexJoin::PhysicalSpatialIndexJoin(LogicalOperator &op, PhysicalOperator &left, DuckTableEntry &table_p,
+                                                   RTreeIndex &index_p, const vector<ColumnIndex> &column_ids,
+                                                   const vector<idx_t> &projection_ids,
+                                                   unique_ptr<Expression> condition_p, JoinType join_type_p,
+                                                   idx_t estimated_cardinality)
+    : CachingPhysicalOperator(PhysicalOperatorType::EXTENSION, op.types, estimated_cardinality),
+      condition(std::move(condition_p)), join_type(join_type_p), table(table_p), index(index_p) {
+
+	children.emplace_back(left);
+
+	auto &func = condition->Cast<BoundFunctionExpression>();
+
+	// Extract the probe side and build side join keys
+	probe_side_key = func.children[0].get();
+	build_side_key = func.children[1].get();
+
+	// Distance predicates have a third, constant (non-null) argument, this is ensured by the optimizer
+	if (func.children.size() == 3) {
+		const auto &distance = func.children[2]->Cast<BoundConstantExpression>().value;
+		probe_side_expansion = MaxValue(distance.GetValue<double>(), 0.0);
+	}
+
+	// Only joins that never emit unmatched build side rows can be answered by probing the index
+	D_ASSERT(join_type == JoinType::INNER || join_type == JoinType::LEFT);
+
+	const auto &lop = op.Cast<LogicalSpatialJoin>();
+
+	// Probe-side
+	const auto &probe_side_input_types = children[0].get().types;
+	probe_side_output_columns = lop.left_projection_map;
+	if (probe_side_output_columns.empty()) {
+		probe_side_output_columns.reserve(probe_side_input_types.size());
+		for (idx_t i = 0; i < probe_side_input_types.size(); i++) {
+			probe_side_output_columns.emplace_back(i);
+		}
+	}
+
+	// Build-side. We fetch all the columns the (replaced) table scan would have scanned, plus the row id so that we
+	// can tell which of the requested rows were actually fetched
+	const auto &columns = table.GetColumns();
+	for (const auto &col_idx : column_ids) {
+		if (col_idx.IsRowIdColumn()) {
+			fetch_column_ids.emplace_back(COLUMN_IDENTIFIER_ROW_ID);
+			fetch_types.emplace_back(LogicalType::ROW_TYPE);
+		} else {
+			const auto &col = columns.GetColumn(LogicalIndex(col_idx.GetPrimaryIndex()));
+			fetch_column_ids.emplace_back(col.StorageOid());
+			fetch_types.push_back(col.Type());
+		}
+	}
+	fetch_column_ids.emplace_back(COLUMN_IDENTIFIER_ROW_ID);
+	fetch_types.emplace_back(LogicalType::ROW_TYPE);
+
+	build_side_columns = projection_ids;
+	if (build_side_columns.empty()) {
+		for (idx_t i = 0; i < column_ids.size(); i++) {
+			build_side_columns.push_back(i);
+		}
+	}
+
+	build_side_output_columns = lop.right_projection_map;
+	if (build_side_output_columns.empty()) {
+		for (idx_t i = 0; i < build_side_columns.size(); i++) {
+			build_side_output_columns.push_back(i);
+		}
+	}
+}
+
+InsertionOrderPreservingMap<string> PhysicalSpatialIndexJoin::ParamsToString() const {
+	auto result = PhysicalOperator::ParamsToString();
+	result["Join Type"] = EnumUtil::ToString(join_type);
+	result["Conditions"] = condition->GetName();
+	result["Table"] = table.name;
+	result["Index"] = index.GetIndexName();
+	SetEstimatedCardinality(result, estimated_cardinality);
+	return result;
+}
+
+string PhysicalSpatialIndexJoin::GetName() const {
+	return "RTREE_INDEX_JOIN";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Operator State
+//----------------------------------------------------------------------------------------------------------------------
+class SpatialIndexJoinGlobalState final : public GlobalOperatorState {
+public:
+	// Guards the traversal of the index, which may load pages from storage
+	mutex index_lock;
+};
+
+class SpatialIndexJoinLocalState final : public CachingOperatorState {
+public:
+	explicit SpatialIndexJoinLocalState(ClientContext &context)
+	    : probe_executor(context), build_executor(context), match_executor(context), probe_sel(STANDARD_VECTOR_SIZE),
+	      match_sel(STANDARD_VECTOR_SIZE), lhs_sel(STANDARD_VECTOR_SIZE) {
+	}
+
+	// Whether the current input chunk has been probed already
+	bool is_probed = false;
+
+	// The matching (probe side row, build side row id) pairs of the current input chunk, ordered by row id
+	vector<pair<row_t, sel_t>> candidates;
+	idx_t candidate_idx = 0;
+
+	DataChunk probe_key_chunk;
+	DataChunk fetch_chunk;
+	DataChunk build_chunk;
+	DataChunk build_key_chunk;
+	DataChunk match_arg_chunk;
+	ColumnFetchState fetch_state;
+	Vector row_ids = Vector(LogicalType::ROW_TYPE);
+	Vector scan_row_ids = Vector(LogicalType::ROW_TYPE);
+
+	ExpressionExecutor probe_executor;
+	ExpressionExecutor build_executor;
+	ExpressionExecutor match_executor;
+
+	unique_ptr<Expression> match_expr;
+
+	SelectionVector probe_sel; // the probe side row of each fetched build side row
+	SelectionVector match_sel; // the fetched rows that satisfy the predicate
+	SelectionVector lhs_sel;   // the unmatched probe side rows, for left joins
+
+	uint8_t left_outer_marker[STANDARD_VECTOR_SIZE] = {};
+};
+
+unique_ptr<GlobalOperatorState> PhysicalSpatialIndexJoin::GetGlobalOperatorState(ClientContext &context) const {
+	return make_uniq<SpatialIndexJoinGlobalState>();
+}
+
+unique_ptr<OperatorState> PhysicalSpatialIndexJoin::GetOperatorState(ExecutionContext &context) const {
+	auto lstate = make_uniq<SpatialIndexJoinLocalState>(context.client);
+
+	// The predicate is evaluated on the probe side key and the build side key
+	lstate->match_expr = condition->Copy();
+	auto &func_expr = lstate->match_expr->Cast<BoundFunctionExpression>();
+	func_expr.children[0] = make_uniq<BoundReferenceExpression>(probe_side_key->return_type, 0);
+	func_expr.children[1] = make_uniq<BoundReferenceExpression>(build_side_key->return_type, 1);
+	lstate->match_executor.AddExpression(*lstate->match_expr);
+
+	lstate->probe_executor.AddExpression(*probe_side_key);
+	lstate->build_executor.AddExpression(*build_side_key);
+
+	vector<LogicalType> build_types;
+	for (const auto &col_idx : build_side_columns) {
+		build_types.push_back(fetch_types[col_idx]);
+	}
+
+	lstate->probe_key_chunk.Initialize(context.client, {probe_side_key->return_type});
+	lstate->fetch_chunk.Initialize(context.client, fetch_types);
+	lstate->build_chunk.Initialize(context.client, build_types);
+	lstate->build_key_chunk.Initialize(context.client, {build_side_key->return_type});
+	lstate->match_arg_chunk.Initialize(context.client, {probe_side_key->return_type, build_side_key->return_type});
+
+	return std::move(lstate);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Execute
+//----------------------------------------------------------------------------------------------------------------------
+// Collect the row ids of all the index entries intersecting the (expanded) bounds of each probe side row
+static void ProbeIndex(const PhysicalSpatialIndexJoin &op, SpatialIndexJoinGlobalState &gstate,
+                       SpatialIndexJoinLocalState &lstate, DataChunk &input) {
+	lstate.candidates.clear();
+	lstate.candidate_idx = 0;
+
+	lstate.probe_key_chunk.Reset();
+	lstate.probe_executor.Execute(input, lstate.probe_key_chunk);
+
+	const SpatialKeyReader key_reader(op.probe_side_key->return_type, lstate.probe_key_chunk.data[0], input.size());
+	const auto scan_row_ids = FlatVector::GetData<row_t>(lstate.scan_row_ids);
+
+	const auto distance = op.probe_side_expansion;
+
+	lock_guard<mutex> guard(gstate.index_lock);
+	for (idx_t i = 0; i < input.size(); i++) {
+		Box2D<float> bbox;
+		if (!key_reader.TryGetBounds(i, bbox)) {
+			continue;
+		}
+		if (distance != 0) {
+			bbox.min.x = MathUtil::DoubleToFloatDown(static_cast<double>(bbox.min.x) - distance);
+			bbox.min.y = MathUtil::DoubleToFloatDown(static_cast<double>(bbox.min.y) - distance);
+			bbox.max.x = MathUtil::DoubleToFloatUp(static_cast<double>(bbox.max.x) + distance);
+			bbox.max.y = MathUtil::DoubleToFloatUp(static_cast<double>(bbox.max.y) + distance);
+		}
+
+		auto scan_state = op.index.InitializeScan(bbox);
+		while (true) {
+			const auto row_count = op.index.Scan(*scan_state, lstate.scan_row_ids);
+			if (row_count == 0) {
+				break;
+			}
+			for (idx_t j = 0; j < row_count; j++) {
+				lstate.candidates.emplace_back(scan_row_ids[j], UnsafeNumericCast<sel_t>(i));
+			}
+		}
+	}
+
+	// Fetch the build side rows in storage order
+	std::sort(lstate.candidates.begin(), lstate.candidates.end());
+}
+
+// Fetch the next batch of candidate rows, and emit the ones that satisfy the predicate
+static void EmitCandidates(ExecutionContext &context, const PhysicalSpatialIndexJoin &op,
+                           SpatialIndexJoinLocalState &lstate, DataChunk &input, DataChunk &chunk) {
+	const auto batch_count = MinValue<idx_t>(lstate.candidates.size() - lstate.candidate_idx, STANDARD_VECTOR_SIZE);
+	const auto batch = lstate.candidates.data() + lstate.candidate_idx;
+	lstate.candidate_idx += batch_count;
+
+	const auto row_ids = FlatVector::GetData<row_t>(lstate.row_ids);
+	for (idx_t i = 0; i < batch_count; i++) {
+		row_ids[i] = batch[i].first;
+	}
+
+	auto &transaction = DuckTransaction::Get(context.client, op.table.catalog);
+	lstate.fetch_chunk.Reset();
+	op.table.GetStorage().Fetch(transaction, lstate.fetch_chunk, op.fetch_column_ids, lstate.row_ids, batch_count,
+	                            lstate.fetch_state);
+
+	// Rows that are not visible to this transaction are skipped by the fetch, so match the fetched rows back up with
+	// the candidates through their row id. Both are in the same order.
+	const auto fetch_count = lstate.fetch_chunk.size();
+	const auto fetched_row_ids = FlatVector::GetData<row_t>(lstate.fetch_chunk.data.back());
+	idx_t candidate_pos = 0;
+	for (idx_t i = 0; i < fetch_count; i++) {
+		while (batch[candidate_pos].first != fetched_row_ids[i]) {
+			candidate_pos++;
+			D_ASSERT(candidate_pos < batch_count);
+		}
+		lstate.probe_sel.set_index(i, batch[candidate_pos].second);
+		candidate_pos++;
+	}
+
+	if (fetch_count == 0) {
+		chunk.SetCardinality(0);
+		return;
+	}
+
+	// Compute the build side key, and evaluate the predicate
+	lstate.build_chunk.ReferenceColumns(lstate.fetch_chunk, op.build_side_columns);
+	lstate.build_key_chunk.Reset();
+	lstate.build_executor.Execute(lstate.build_chunk, lstate.build_key_chunk);
+
+	lstate.match_arg_chunk.data[0].Slice(lstate.probe_key_chunk.data[0], lstate.probe_sel, fetch_count);
+	lstate.match_arg_chunk.data[1].Reference(lstate.build_key_chunk.data[0]);
+	lstate.match_arg_chunk.SetCardinality(fetch_count);
+
+	const auto match_count = lstate.match_executor.SelectExpression(lstate.match_arg_chunk, lstate.match_sel);
+
+	if (IsLeftOuterJoin(op.join_type)) {
+		for (idx_t i = 0; i < match_count; i++) {
+			lstate.left_outer_marker[lstate.probe_sel.get_index(lstate.match_sel.get_index(i))] = 1;
+		}
+	}
+
+	// Put together the output: the probe side columns, followed by the build side columns
+	const auto probe_col_count = op.probe_side_output_columns.size();
+	for (idx_t i = 0; i < probe_col_count; i++) {
+		chunk.data[i].Slice(input.data[op.probe_side_output_columns[i]], lstate.probe_sel, fetch_count);
+	}
+	for (idx_t i = 0; i < op.build_side_output_columns.size(); i++) {
+		chunk.data[probe_col_count + i].Reference(lstate.build_chunk.data[op.build_side_output_columns[i]]);
+	}
+	chunk.SetCardinality(fetch_count);
+	chunk.Slice(lstate.match_sel, match_count);
+}
+
+// Emit the probe side rows without any match, for left joins
+static void EmitUnmatched(const PhysicalSpatialIndexJoin &op, SpatialIndexJoinLocalState &lstate, DataChunk &input,
+                          DataChunk &chunk) {
+	idx_t remaining_count = 0;
+	for (idx_t i = 0; i < input.size(); i++) {
+		if (!lstate.left_outer_marker[i]) {
+			lstate.lhs_sel.set_index(remaining_count++, i);
+		}
+	}
+	if (remaining_count == 0) {
+		chunk.SetCardinality(0);
+		return;
+	}
+
+	const auto probe_col_count = op.probe_side_output_columns.size();
+	for (idx_t i = 0; i < probe_col_count; i++) {
+		chunk.data[i].Slice(input.data[op.probe_side_output_columns[i]], lstate.lhs_sel, remaining_count);
+	}
+	for (idx_t i = 0; i < op.build_side_output_columns.size(); i++) {
+		auto &target = chunk.data[probe_col_count + i];
+		target.SetVectorType(VectorType::CONSTANT_VECTOR);
+		ConstantVector::SetNull(target, true);
+	}
+	chunk.SetCardinality(remaining_count);
+}
+
+OperatorResultType PhysicalSpatialIndexJoin::ExecuteInternal(ExecutionContext &context, DataChunk &input,
+                                                             DataChunk &chunk, GlobalOperatorState &gstate_p,
+                                                             OperatorState &lstate_p) const {
+	auto &gstate = gstate_p.Cast<SpatialIndexJoinGlobalState>();
+	auto &lstate = lstate_p.Cast<SpatialIndexJoinLocalState>();
+
+	if (!lstate.is_probed) {
+		ProbeIndex(*this, gstate, lstate, input);
+		memset(lstate.left_outer_marker, 0, sizeof(lstate.left_outer_marker));
+		lstate.is_probed = true;
+	}
+
+	if (lstate.candidate_idx < lstate.candidates.size()) {
+		EmitCandidates(context, *this, lstate, input, chunk);
+		return OperatorResultType::HAVE_MORE_OUTPUT;
+	}
+
+	// We are done with this input chunk
+	lstate.is_probed = false;
+	if (IsLeftOuterJoin(join_type)) {
+		EmitUnmatched(*this, lstate, input, chunk);
+	}
+	return OperatorResultType::NEED_MORE_INPUT;
+}
+
+} // namespace duckdb
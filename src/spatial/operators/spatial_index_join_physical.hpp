@@ -0,0 +1,63 @@
+#pragma once
+#include "duckdb/execution/physical_operator.hpp"
+#include "duckdb/storage/storage_index.hpp"
+
+namespace duckdb {
+
+class DuckTableEntry;
+class RTreeIndex;
+
+//! Joins the probe side against a table with an RTREE index on the join column, by probing the index with the bounds
+//! of each probe side row and fetching the matching rows by row id (an index nested loop join).
+class PhysicalSpatialIndexJoin final : public CachingPhysicalOperator {
+public:
+	static constexpr auto TYPE = PhysicalOperatorType::EXTENSION;
+
+public:
+	PhysicalSpatialIndexJoin(LogicalOperator &op, PhysicalOperator &left, DuckTableEntry &table, RTreeIndex &index,
+	                         const vector<ColumnIndex> &column_ids, const vector<idx_t> &projection_ids,
+	                         unique_ptr<Expression> spatial_predicate, JoinType join_type,
+	                         idx_t estimated_cardinality);
+
+	//! The condition of the join
+	unique_ptr<Expression> condition;
+	optional_ptr<Expression> build_side_key;
+	optional_ptr<Expression> probe_side_key;
+
+	JoinType join_type;
+
+	//! The indexed table, and the index to probe
+	DuckTableEntry &table;
+	RTreeIndex &index;
+
+	//! The storage columns to fetch from the table. The row id is always fetched last
+	vector<StorageIndex> fetch_column_ids;
+	vector<LogicalType> fetch_types;
+	//! The fetched columns that make up the (projected) build side rows, i.e. what the build key refers to
+	vector<idx_t> build_side_columns;
+
+	vector<column_t> probe_side_output_columns;
+	//! The build side columns that are output by the join
+	vector<column_t> build_side_output_columns;
+
+	//! Added to the bounds of each probe row before it is looked up in the index, for ST_DWithin and ST_Distance <= r
+	double probe_side_expansion = 0;
+
+public:
+	unique_ptr<OperatorState> GetOperatorState(ExecutionContext &context) const override;
+	unique_ptr<GlobalOperatorState> GetGlobalOperatorState(ClientContext &context) const override;
+
+	bool ParallelOperator() const override {
+		return true;
+	}
+
+protected:
+	OperatorResultType ExecuteInternal(ExecutionContext &context, DataChunk &input, DataChunk &chunk,
+	                                   GlobalOperatorState &gstate, OperatorState &state) const override;
+
+public:
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
+	string GetName() const override;
+};
+
+} // namespace duckdb
@@ -0,0 +1,346 @@
+#include "spatial/operators/spatial_join_cache.hpp"
+#include "spatial/operators/spatial_join_rtree.hpp"
+
+#include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
+#include "duckdb/common/types/row/tuple_data_collection.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/client_context_state.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/main/prepared_statement_data.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+#include "duckdb/planner/operator/logical_delete.hpp"
+#include "duckdb/planner/operator/logical_insert.hpp"
+#include "duckdb/planner/operator/logical_update.hpp"
+#include "duckdb/storage/data_table.hpp"
+#include "duckdb/transaction/local_storage.hpp"
+
+namespace duckdb {
+
+namespace {
+
+//----------------------------------------------------------------------------------------------------------------------
+// Client State
+//----------------------------------------------------------------------------------------------------------------------
+// Tracks which writes the transaction of a client sees, and the tables the transaction writes to.
+class SpatialJoinCacheClientState final : public ClientContextState {
+public:
+	explicit SpatialJoinCacheClientState(ClientContext &context) : cache(SpatialJoinBuildCache::Get(context)) {
+	}
+
+	~SpatialJoinCacheClientState() override {
+		// The transaction is rolled back with the client
+		EndWrites();
+	}
+
+	static SpatialJoinCacheClientState &Get(ClientContext &context) {
+		return *context.registered_state->GetOrCreate<SpatialJoinCacheClientState>("spatial_join_build_cache",
+		                                                                           context);
+	}
+
+	// The epoch is taken before the transaction takes its snapshot of the database, so the transaction sees (at least)
+	// the writes that ended before the epoch
+	void TransactionBegin(MetaTransaction &transaction, ClientContext &context) override {
+		begin_epoch = cache->GetEpoch();
+		has_begin_epoch = true;
+	}
+
+	void QueryEnd(ClientContext &context) override {
+		if (!context.transaction.HasActiveTransaction()) {
+			EndWrites();
+		}
+	}
+
+	// Prepared statements are not optimized again when they are executed, so replan the ones that write to the database
+	// to find out which tables they write to
+	bool CanRequestRebind() override {
+		return true;
+	}
+
+	RebindQueryInfo OnExecutePrepared(ClientContext &context, PreparedStatementCallbackInfo &info,
+	                                  RebindQueryInfo current_rebind) override {
+		if (!info.prepared_statement.properties.modified_databases.empty()) {
+			return RebindQueryInfo::ATTEMPT_TO_REBIND;
+		}
+		return current_rebind;
+	}
+
+	//! Get the epoch the current transaction started at, false if the transaction started before the state existed
+	bool TryGetBeginEpoch(idx_t &result) const {
+		result = begin_epoch;
+		return has_begin_epoch;
+	}
+
+	void RegisterWrite(const shared_ptr<DataTableInfo> &info) {
+		for (auto &table : written_tables) {
+			if (table == info) {
+				return;
+			}
+		}
+		written_tables.push_back(info);
+		cache->BeginWrite(info);
+	}
+
+private:
+	void EndWrites() {
+		for (auto &table : written_tables) {
+			cache->EndWrite(table);
+		}
+		written_tables.clear();
+	}
+
+	shared_ptr<SpatialJoinBuildCache> cache;
+	bool has_begin_epoch = false;
+	idx_t begin_epoch = 0;
+	//! The tables the current transaction writes to
+	vector<shared_ptr<DataTableInfo>> written_tables;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Write Tracking
+//----------------------------------------------------------------------------------------------------------------------
+// Every planned statement is checked for writes to tables, so that the cached build sides (of any connection) over a
+// table are dropped as soon as a statement writing to it is planned.
+void TrackWrites(ClientContext &context, LogicalOperator &op) {
+	optional_ptr<TableCatalogEntry> table;
+	switch (op.type) {
+	case LogicalOperatorType::LOGICAL_INSERT:
+		table = &op.Cast<LogicalInsert>().table;
+		break;
+	case LogicalOperatorType::LOGICAL_DELETE:
+		table = &op.Cast<LogicalDelete>().table;
+		break;
+	case LogicalOperatorType::LOGICAL_UPDATE:
+		table = &op.Cast<LogicalUpdate>().table;
+		break;
+	default:
+		break;
+	}
+	if (table && table->IsDuckTable()) {
+		const auto &info = table->Cast<DuckTableEntry>().GetStorage().GetDataTableInfo();
+		SpatialJoinCacheClientState::Get(context).RegisterWrite(info);
+	}
+	for (auto &child : op.children) {
+		TrackWrites(context, *child);
+	}
+}
+
+void TrackTableWrites(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	auto &context = input.context;
+
+	// Create the client state before the next transaction starts, so that it can use the cache
+	Value capacity_value;
+	if (context.TryGetCurrentSetting(SpatialJoinBuildCache::SETTING_NAME, capacity_value) &&
+	    capacity_value.GetValue<idx_t>() != 0) {
+		SpatialJoinCacheClientState::Get(context);
+	}
+
+	TrackWrites(context, *plan);
+}
+
+string GetEntryKey(const DataTableInfo &info, const string &key) {
+	return to_string(reinterpret_cast<uintptr_t>(&info)) + ":" + key;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+// Spatial Join Build
+//----------------------------------------------------------------------------------------------------------------------
+idx_t SpatialJoinBuild::GetMemoryUsage() const {
+	return collection->SizeInBytes() + rtree_memory + unindexed_rows.capacity() * sizeof(data_ptr_t);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Spatial Join Build Cache
+//----------------------------------------------------------------------------------------------------------------------
+SpatialJoinBuildCache::SpatialJoinBuildCache() : capacity(DEFAULT_CAPACITY), epoch(0) {
+}
+
+shared_ptr<SpatialJoinBuildCache> SpatialJoinBuildCache::Get(ClientContext &context) {
+	auto &object_cache = ObjectCache::GetObjectCache(context);
+	auto result = object_cache.GetOrCreate<SpatialJoinBuildCache>(ObjectType());
+
+	Value capacity_value;
+	if (context.TryGetCurrentSetting(SETTING_NAME, capacity_value)) {
+		const auto new_capacity = capacity_value.GetValue<idx_t>();
+		if (new_capacity != result->capacity.load()) {
+			result->SetCapacity(new_capacity);
+		}
+	}
+	return result;
+}
+
+void SpatialJoinBuildCache::Register(DatabaseInstance &db) {
+	db.config.AddExtensionOption(SETTING_NAME,
+	                             "The number of bytes of spatial join build sides (the rows and the rtree of a plain "
+	                             "scan of a table) that are kept in memory to be reused by later joins against the same "
+	                             "table. 0 (the default) disables the cache",
+	                             LogicalType::UBIGINT, Value::UBIGINT(DEFAULT_CAPACITY));
+
+	OptimizerExtension optimizer;
+	optimizer.optimize_function = TrackTableWrites;
+	db.config.optimizer_extensions.push_back(optimizer);
+}
+
+void SpatialJoinBuildCache::SetCapacity(idx_t capacity_p) {
+	lock_guard<mutex> guard(lock);
+	capacity = capacity_p;
+	Shrink(capacity_p);
+}
+
+shared_ptr<SpatialJoinBuild> SpatialJoinBuildCache::Lookup(ClientContext &context, DuckTableEntry &table,
+                                                            const string &key, TableVersion &version) {
+	version = TableVersion();
+	if (capacity.load() == 0) {
+		return nullptr;
+	}
+
+	idx_t begin_epoch;
+	if (!SpatialJoinCacheClientState::Get(context).TryGetBeginEpoch(begin_epoch)) {
+		return nullptr;
+	}
+
+	// Transaction-local changes are only seen by the current transaction
+	auto &storage = table.GetStorage();
+	auto &local_storage = LocalStorage::Get(context, table.catalog);
+	if (local_storage.Find(storage)) {
+		return nullptr;
+	}
+
+	const auto &info = storage.GetDataTableInfo();
+	const auto row_count = storage.GetTotalRows();
+
+	lock_guard<mutex> guard(lock);
+	auto &state = GetTableState(info);
+	if (state.storage != &storage) {
+		// The table was altered
+		Invalidate(*info, state);
+		state.storage = &storage;
+	}
+
+	// While the table is being written to, or if the last write ended after the transaction started, the transaction
+	// may see a different version of the table than the transactions after it
+	if (state.writers != 0 || begin_epoch < state.last_write_epoch) {
+		return nullptr;
+	}
+
+	version.cacheable = true;
+	version.generation = state.generation;
+	version.row_count = row_count;
+
+	const auto entry = lookup.find(GetEntryKey(*info, key));
+	if (entry == lookup.end()) {
+		return nullptr;
+	}
+	const auto cached = entry->second;
+	if (cached->version.generation != version.generation || cached->version.row_count != version.row_count) {
+		// Rows were appended without going through the planner
+		used -= cached->size;
+		entries.erase(cached);
+		lookup.erase(entry);
+		return nullptr;
+	}
+
+	// Move the entry to the front
+	entries.splice(entries.begin(), entries, cached);
+	return cached->build;
+}
+
+void SpatialJoinBuildCache::Insert(DuckTableEntry &table, const string &key, const TableVersion &version,
+                                   shared_ptr<SpatialJoinBuild> build) {
+	if (!version.cacheable) {
+		return;
+	}
+	const auto size = build->GetMemoryUsage();
+	const auto current_capacity = capacity.load();
+	if (size > current_capacity) {
+		return;
+	}
+
+	auto &storage = table.GetStorage();
+	const auto &info = storage.GetDataTableInfo();
+
+	lock_guard<mutex> guard(lock);
+
+	// Forget the tables that were dropped
+	for (auto it = tables.begin(); it != tables.end();) {
+		if (it->second.info.expired()) {
+			it = tables.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	// The table may have been written to while the build side was built
+	auto &state = GetTableState(info);
+	if (state.generation != version.generation || state.writers != 0 || state.storage != &storage) {
+		return;
+	}
+
+	const auto entry_key = GetEntryKey(*info, key);
+	const auto existing = lookup.find(entry_key);
+	if (existing != lookup.end()) {
+		// Another query was faster
+		return;
+	}
+
+	Shrink(capacity.load() - MinValue(size, capacity.load()));
+	entries.push_front(Entry {info.get(), entry_key, version, std::move(build), size});
+	lookup.emplace(entry_key, entries.begin());
+	used += size;
+}
+
+void SpatialJoinBuildCache::BeginWrite(const shared_ptr<DataTableInfo> &info) {
+	lock_guard<mutex> guard(lock);
+	auto &state = GetTableState(info);
+	state.writers++;
+	Invalidate(*info, state);
+}
+
+void SpatialJoinBuildCache::EndWrite(const shared_ptr<DataTableInfo> &info) {
+	lock_guard<mutex> guard(lock);
+	auto &state = GetTableState(info);
+	D_ASSERT(state.writers > 0);
+	state.writers--;
+	state.last_write_epoch = ++epoch;
+	Invalidate(*info, state);
+}
+
+SpatialJoinBuildCache::TableState &SpatialJoinBuildCache::GetTableState(const shared_ptr<DataTableInfo> &info) {
+	auto &state = tables[info.get()];
+	if (state.info.lock() != info) {
+		// A table we have not seen yet, or the info of a dropped table was freed and its address reused. The writers
+		// keep the info of the tables they write to alive, so there are none.
+		Invalidate(*info, state);
+		const auto generation = state.generation;
+		state = TableState();
+		state.info = info;
+		state.generation = generation;
+	}
+	return state;
+}
+
+void SpatialJoinBuildCache::Invalidate(const DataTableInfo &info, TableState &state) {
+	state.generation++;
+	for (auto it = entries.begin(); it != entries.end();) {
+		if (it->table == &info) {
+			lookup.erase(it->key);
+			used -= it->size;
+			it = entries.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void SpatialJoinBuildCache::Shrink(idx_t capacity_p) {
+	while (used > capacity_p && !entries.empty()) {
+		auto &entry = entries.back();
+		lookup.erase(entry.key);
+		used -= entry.size;
+		entries.pop_back();
+	}
+}
+
+} // namespace duckdb
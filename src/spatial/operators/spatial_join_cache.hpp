@@ -0,0 +1,133 @@
+#pragma once
+
+#include "duckdb/common/atomic.hpp"
+#include "duckdb/common/list.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+namespace duckdb {
+
+class ClientContext;
+class DatabaseInstance;
+class DataTable;
+class DataTableInfo;
+class DuckTableEntry;
+class FlatRTree;
+class TupleDataCollection;
+
+//! The build side of a spatial join: the (pinned) build side rows and the rtree over them. It is never modified once
+//! built, so any number of queries can probe it at the same time.
+struct SpatialJoinBuild {
+	shared_ptr<TupleDataCollection> collection;
+	shared_ptr<FlatRTree> rtree;
+	//! The rows with a null or empty key, which are not in the rtree. Only collected for right/outer joins
+	vector<data_ptr_t> unindexed_rows;
+	//! The number of rows in the rtree, for profiling
+	idx_t build_count = 0;
+	idx_t rtree_memory = 0;
+
+	idx_t GetMemoryUsage() const;
+};
+
+//! A database-wide LRU cache of the build sides of spatial joins over a plain scan of a table. Joins against a static
+//! reference table (e.g. countries or timezones) then only scan the table and build the rtree once, and later queries
+//! probe the cached rtree directly. The cached rows stay pinned in the buffer pool, so they count towards the memory
+//! limit. The cache is disabled by default.
+//!
+//! An entry is only reused by transactions that see the same version of the table it was built from. Statements that
+//! write to a table (INSERT, UPDATE, DELETE) are tracked from planning until their transaction ends, and the cache is
+//! bypassed for the table while any of them is running. Appends that are not planned (e.g. with the appender) are
+//! caught by the number of rows of the table changing. Writes are tracked by an optimizer extension, so statements
+//! planned with the optimizer disabled must not write to tables that are joined with the cache enabled.
+class SpatialJoinBuildCache final : public ObjectCacheEntry {
+public:
+	static constexpr auto SETTING_NAME = "spatial_join_build_cache_size";
+	//! The default number of bytes of cached build sides
+	static constexpr idx_t DEFAULT_CAPACITY = 0;
+
+	//! The version of a table a build side is cached for
+	struct TableVersion {
+		//! Whether the build side can be cached at all
+		bool cacheable = false;
+		idx_t generation = 0;
+		idx_t row_count = 0;
+	};
+
+	SpatialJoinBuildCache();
+
+	static string ObjectType() {
+		return "spatial_join_build_cache";
+	}
+
+	string GetObjectType() override {
+		return ObjectType();
+	}
+
+	static shared_ptr<SpatialJoinBuildCache> Get(ClientContext &context);
+	static void Register(DatabaseInstance &db);
+
+	//! Get the cached build side of a join over the table, if the current transaction sees the version of the table it
+	//! was built from. Otherwise sets the version to insert the newly built side with, which is not cacheable if the
+	//! current transaction might see a different version of the table than later ones.
+	shared_ptr<SpatialJoinBuild> Lookup(ClientContext &context, DuckTableEntry &table, const string &key,
+	                                    TableVersion &version);
+	//! Cache a build side, unless the table has been written to since the version was taken
+	void Insert(DuckTableEntry &table, const string &key, const TableVersion &version,
+	            shared_ptr<SpatialJoinBuild> build);
+
+	//! Track a transaction writing to a table, from when the first statement writing to it is planned until the
+	//! transaction ends. See SpatialJoinCacheClientState
+	void BeginWrite(const shared_ptr<DataTableInfo> &info);
+	void EndWrite(const shared_ptr<DataTableInfo> &info);
+
+	//! The number of writes that ended so far. A transaction that started after a write ended sees its changes
+	idx_t GetEpoch() const {
+		return epoch.load();
+	}
+
+	//! Set the number of bytes of cached build sides, evicting the least recently used ones over the new capacity
+	void SetCapacity(idx_t capacity);
+
+private:
+	struct TableState {
+		//! The table the state is for, tables are identified by the address of their info, which may be reused once
+		//! the table is dropped
+		weak_ptr<DataTableInfo> info;
+		//! The storage of the table the state is for, a new one is created when the table is altered
+		const DataTable *storage = nullptr;
+		//! Incremented on every change of the table, entries of older generations are stale
+		idx_t generation = 0;
+		//! The number of transactions currently writing to the table
+		idx_t writers = 0;
+		//! The epoch at which the last write to the table ended
+		idx_t last_write_epoch = 0;
+	};
+
+	struct Entry {
+		const DataTableInfo *table;
+		string key;
+		TableVersion version;
+		shared_ptr<SpatialJoinBuild> build;
+		idx_t size;
+	};
+
+	//! Get the state of a table, the lock must be held
+	TableState &GetTableState(const shared_ptr<DataTableInfo> &info);
+	//! Drop the cached entries of a table and start a new generation, the lock must be held
+	void Invalidate(const DataTableInfo &info, TableState &state);
+	//! Evict the least recently used entries until the cache fits in the capacity, the lock must be held
+	void Shrink(idx_t capacity);
+
+	mutex lock;
+	unordered_map<const DataTableInfo *, TableState> tables;
+	//! The cached build sides, the most recently used first
+	list<Entry> entries;
+	unordered_map<string, list<Entry>::iterator> lookup;
+
+	atomic<idx_t> capacity;
+	idx_t used = 0;
+	atomic<idx_t> epoch;
+};
+
+} // namespace duckdb
@@ -1,11 +1,14 @@
 #include "spatial_join_logical.hpp"
 #include "spatial_join_physical.hpp"
+#include "spatial_index_join_physical.hpp"
 
 #include "duckdb/planner/expression/bound_function_expression.hpp"
 #include "duckdb/planner/operator/logical_filter.hpp"
 #include "duckdb/execution/column_binding_resolver.hpp"
 #include "duckdb/common/serializer/serializer.hpp"
 #include "duckdb/common/serializer/deserializer.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
 
 namespace duckdb {
 
@@ -69,14 +72,85 @@ void LogicalSpatialJoin::ResolveTypes() {
 	types.insert(types.end(), right_types.begin(), right_types.end());
 }
 
+// If the build side is a plain scan of a table, key the build side by everything that determines its rows and layout,
+// so that it can be reused from the SpatialJoinBuildCache by later joins against the same table
+static void TrySetBuildCacheKey(ClientContext &context, PhysicalSpatialJoin &join, LogicalOperator &build_side) {
+	Value capacity_value;
+	if (!context.TryGetCurrentSetting(SpatialJoinBuildCache::SETTING_NAME, capacity_value) ||
+	    capacity_value.GetValue<idx_t>() == 0) {
+		return;
+	}
+	if (build_side.type != LogicalOperatorType::LOGICAL_GET) {
+		return;
+	}
+	auto &get = build_side.Cast<LogicalGet>();
+	if (get.function.name != "seq_scan") {
+		return;
+	}
+	if (!get.table_filters.filters.empty() || (get.dynamic_filters && get.dynamic_filters->HasFilters())) {
+		return;
+	}
+	auto table = get.GetTable();
+	if (!table || !table->IsDuckTable()) {
+		return;
+	}
+	if (join.build_side_key->IsVolatile()) {
+		return;
+	}
+
+	string key;
+	for (auto &column : get.GetColumnIds()) {
+		if (column.HasChildren()) {
+			// Pushed down struct field projections are not part of the key
+			return;
+		}
+		key += to_string(column.GetPrimaryIndex()) + ",";
+	}
+	key += "|";
+	for (auto &projection_id : get.projection_ids) {
+		key += to_string(projection_id) + ",";
+	}
+	key += "|" + join.build_side_key->ToString() + "|";
+	for (auto &payload_column : join.build_side_payload_columns) {
+		key += to_string(payload_column) + ",";
+	}
+	key += "|";
+	for (auto &type : join.layout->GetTypes()) {
+		key += type.ToString() + ",";
+	}
+	key += "|" + to_string(static_cast<uint8_t>(join.algorithm));
+	key += "|" + to_string(PropagatesBuildSide(join.join_type));
+
+	join.build_cache_table = &table->Cast<DuckTableEntry>();
+	join.build_cache_key = std::move(key);
+}
+
 PhysicalOperator &LogicalSpatialJoin::CreatePlan(ClientContext &context, PhysicalPlanGenerator &generator) {
 
-	// Return a new PhysicalSpatialJoin operator
+	if (self_join) {
+		// Both sides are read from the RHS, the scan of the LHS is not needed
+		auto &right = generator.CreatePlan(*children[1]);
+		return generator.Make<PhysicalSpatialJoin>(*this, right, right, std::move(spatial_predicate), join_type,
+		                                           estimated_cardinality);
+	}
+
 	auto &left = generator.CreatePlan(*children[0]);
+
+	if (index) {
+		// Probe the index of the RHS table directly, the scan of the RHS is not needed
+		auto &get = children[1]->Cast<LogicalGet>();
+		return generator.Make<PhysicalSpatialIndexJoin>(*this, left, *index_table, *index, get.GetColumnIds(),
+		                                                get.projection_ids, std::move(spatial_predicate), join_type,
+		                                                estimated_cardinality);
+	}
+
+	// Return a new PhysicalSpatialJoin operator
 	auto &right = generator.CreatePlan(*children[1]);
 
-	return generator.Make<PhysicalSpatialJoin>(*this, left, right, std::move(spatial_predicate), join_type,
-	                                           estimated_cardinality);
+	auto &join = generator.Make<PhysicalSpatialJoin>(*this, left, right, std::move(spatial_predicate), join_type,
+	                                                 estimated_cardinality);
+	TrySetBuildCacheKey(context, join.Cast<PhysicalSpatialJoin>(), *children[1]);
+	return join;
 }
 
 void LogicalSpatialJoin::Serialize(Serializer &writer) const {
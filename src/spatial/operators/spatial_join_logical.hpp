@@ -4,6 +4,17 @@
 
 namespace duckdb {
 
+class DuckTableEntry;
+class RTreeIndex;
+
+//! How the build side of a spatial join is indexed, see PhysicalSpatialJoin
+enum class SpatialJoinAlgorithm : uint8_t {
+	//! A packed hilbert rtree
+	RTREE,
+	//! A uniform grid, for build sides of uniformly dense points
+	GRID
+};
+
 class LogicalSpatialJoin final : public LogicalExtensionOperator {
 public:
 	static constexpr auto TYPE = LogicalOperatorType::LOGICAL_EXTENSION_OPERATOR;
@@ -28,6 +39,20 @@ public:
 	//! Join Keys statistics (optional)
 	vector<unique_ptr<BaseStatistics>> join_stats;
 
+	//! If set, the RHS is a scan of this table, and the join is executed by probing its RTREE index instead of building
+	//! a new rtree. This is a physical planning decision, and is not serialized.
+	optional_ptr<DuckTableEntry> index_table;
+	optional_ptr<RTreeIndex> index;
+
+	//! If set, both sides are scans of the same table, and the join is executed by scanning the RHS once and joining
+	//! its rtree with itself. Maps each column of the LHS to the same column of the RHS. This is a physical planning
+	//! decision, and is not serialized.
+	bool self_join = false;
+	vector<idx_t> self_join_column_map;
+
+	//! How the build side is indexed. This is a physical planning decision, and is not serialized.
+	SpatialJoinAlgorithm algorithm = SpatialJoinAlgorithm::RTREE;
+
 public:
 	explicit LogicalSpatialJoin(JoinType join_type_p);
 
@@ -3,10 +3,26 @@
 #include "duckdb/main/database.hpp"
 #include "duckdb/planner/expression/bound_function_expression.hpp"
 #include "duckdb/planner/operator/logical_any_join.hpp"
+#include "duckdb/planner/operator/logical_comparison_join.hpp"
 #include "spatial_join_logical.hpp"
+#include "spatial_join_cache.hpp"
 
 #include "duckdb/catalog/catalog_entry/scalar_function_catalog_entry.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/planner/expression/bound_cast_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
 #include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
+#include "duckdb/planner/expression_iterator.hpp"
+#include "duckdb/storage/data_table.hpp"
+#include "duckdb/transaction/local_storage.hpp"
+#include "spatial/geometry/geometry_stats.hpp"
+#include "spatial/geometry/spatial_key.hpp"
+#include "spatial/index/rtree/rtree_index.hpp"
+#include "spatial/spatial_types.hpp"
 
 namespace duckdb {
 
@@ -15,18 +31,34 @@ static case_insensitive_set_t spatial_predicate_map = {
     "ST_Equals",   "ST_Intersects", "ST_Touches",   "ST_Crosses",          "ST_Within",        "ST_Contains",
     "ST_Overlaps", "ST_Covers",     "ST_CoveredBy", "ST_ContainsProperly", "ST_WithinProperly"};
 
+// These imply bounding box intersection once one of the boxes is expanded by the (constant) distance argument
+static case_insensitive_set_t spatial_distance_predicate_map = {"ST_DWithin", "ST_DWithin_Sphere",
+                                                                "ST_DWithin_Spheroid"};
+
+// Distance predicates on the surface of the earth, the distance is in meters but the coordinates are in degrees.
+// The expanded boxes depend on the latitude, and wrap around the antimeridian, see PhysicalSpatialJoin.
+static case_insensitive_set_t spatial_geodesic_predicate_map = {"ST_DWithin_Sphere", "ST_DWithin_Spheroid"};
+
+// The distance functions that can be rewritten into a distance predicate, when compared to a constant
+static case_insensitive_map_t<string> spatial_distance_function_map = {{"ST_Distance", "ST_DWithin"},
+                                                                       {"ST_Distance_Sphere", "ST_DWithin_Sphere"},
+                                                                       {"ST_Distance_Spheroid", "ST_DWithin_Spheroid"}};
+
 static case_insensitive_map_t<string> spatial_predicate_inverse_map = {
     {"ST_Equals", "ST_Equals"},
-    {"ST_Intersects", "ST_Intersects"},           // Symmetric
-    {"ST_Touches", "ST_Touches"},                 // Symmetric
-    {"ST_Crosses", "ST_Crosses"},                 // Symmetric
-    {"ST_Within", "ST_Contains"},                 // Inverse
-    {"ST_Contains", "ST_Within"},                 // Inverse
-    {"ST_Overlaps", "ST_Overlaps"},               // Symmetric
-    {"ST_Covers", "ST_CoveredBy"},                // Inverse
-    {"ST_CoveredBy", "ST_Covers"},                // Inverse
-    {"ST_WithinProperly", "ST_ContainsProperly"}, // Inverse
-    {"ST_ContainsProperly", "ST_WithinProperly"}  // Inverse
+    {"ST_Intersects", "ST_Intersects"},            // Symmetric
+    {"ST_Touches", "ST_Touches"},                  // Symmetric
+    {"ST_Crosses", "ST_Crosses"},                  // Symmetric
+    {"ST_Within", "ST_Contains"},                  // Inverse
+    {"ST_Contains", "ST_Within"},                  // Inverse
+    {"ST_Overlaps", "ST_Overlaps"},                // Symmetric
+    {"ST_Covers", "ST_CoveredBy"},                 // Inverse
+    {"ST_CoveredBy", "ST_Covers"},                 // Inverse
+    {"ST_WithinProperly", "ST_ContainsProperly"},  // Inverse
+    {"ST_ContainsProperly", "ST_WithinProperly"},  // Inverse
+    {"ST_DWithin", "ST_DWithin"},                  // Symmetric
+    {"ST_DWithin_Sphere", "ST_DWithin_Sphere"},    // Symmetric
+    {"ST_DWithin_Spheroid", "ST_DWithin_Spheroid"} // Symmetric
 };
 
 unique_ptr<Expression> TryGetInversePredicate(ClientContext &context, unique_ptr<Expression> expr) {
@@ -41,74 +73,468 @@ unique_ptr<Expression> TryGetInversePredicate(ClientContext &context, unique_ptr
 	// Swap the arguments
 	std::swap(func.children[0], func.children[1]);
 
-	if (it->first == it->second) {
+	if (it->first == it->second && func.children[0]->return_type == func.children[1]->return_type) {
 		// We've already swapped the child, so just return the expression
 		return expr;
 	}
 
-	// Get the function from the catalog
+	// Get the function from the catalog. Symmetric predicates over different types (e.g. a POINT_2D and a BOX_2D)
+	// have to be rebound too, as the swapped arguments are of another variant.
 	auto &catalog = Catalog::GetSystemCatalog(context);
 	auto &entry = catalog.GetEntry<ScalarFunctionCatalogEntry>(context, DEFAULT_SCHEMA, it->second);
 	auto inverse_func =
 	    entry.functions.GetFunctionByArguments(context, {func.children[0]->return_type, func.children[1]->return_type});
 
+	// If there is no variant for the swapped types, the arguments are cast to the one that was picked instead
+	for (idx_t i = 0; i < func.children.size(); i++) {
+		func.children[i] =
+		    BoundCastExpression::AddCastToType(context, std::move(func.children[i]), inverse_func.arguments[i]);
+	}
+
 	return make_uniq_base<Expression, BoundFunctionExpression>(func.return_type, inverse_func, std::move(func.children),
 	                                                           nullptr, func.is_operator);
 }
 
-static void InsertSpatialJoin(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
-	auto &op = *plan;
+// Rewrite "ST_Distance(a, b) <= r" (or "r >= ST_Distance(a, b)") into "ST_DWithin(a, b, r)", and likewise for the
+// spherical and spheroidal distances. A strict comparison "ST_Distance(a, b) < r" is rewritten to the largest double
+// below r instead, so the radius has to be folded into a constant first.
+static unique_ptr<Expression> TryRewriteDistanceComparison(ClientContext &context, unique_ptr<Expression> expr) {
+	const auto is_lhs = expr->type == ExpressionType::COMPARE_LESSTHANOREQUALTO ||
+	                    expr->type == ExpressionType::COMPARE_LESSTHAN;
+	const auto is_rhs = expr->type == ExpressionType::COMPARE_GREATERTHANOREQUALTO ||
+	                    expr->type == ExpressionType::COMPARE_GREATERTHAN;
+	if (!is_lhs && !is_rhs) {
+		return expr;
+	}
+	const auto is_strict =
+	    expr->type == ExpressionType::COMPARE_LESSTHAN || expr->type == ExpressionType::COMPARE_GREATERTHAN;
 
-	// We only care about ANY_JOIN operators
-	if (op.type != LogicalOperatorType::LOGICAL_ANY_JOIN) {
+	auto &comp = expr->Cast<BoundComparisonExpression>();
+	auto &distance_expr = is_lhs ? comp.left : comp.right;
+	auto &radius_expr = is_lhs ? comp.right : comp.left;
+
+	if (distance_expr->type != ExpressionType::BOUND_FUNCTION || !radius_expr->IsFoldable()) {
+		return expr;
+	}
+
+	auto &func = distance_expr->Cast<BoundFunctionExpression>();
+	const auto it = spatial_distance_function_map.find(func.function.name);
+	if (it == spatial_distance_function_map.end() || func.children.size() != 2 ||
+	    func.children[0]->return_type != func.children[1]->return_type) {
+		return expr;
+	}
+
+	// The planar distance is only supported for GEOMETRY, the others also for POINT_2D
+	const auto &arg_type = func.children[0]->return_type;
+	const auto is_planar = StringUtil::CIEquals(it->first, "ST_Distance");
+	if (arg_type != GeoTypes::GEOMETRY() && (is_planar || arg_type != GeoTypes::POINT_2D())) {
+		return expr;
+	}
+
+	// The predicate may not be available, e.g. ST_DWithin requires GEOS
+	auto &catalog = Catalog::GetSystemCatalog(context);
+	auto entry =
+	    catalog.GetEntry<ScalarFunctionCatalogEntry>(context, DEFAULT_SCHEMA, it->second, OnEntryNotFound::RETURN_NULL);
+	if (!entry) {
+		return expr;
+	}
+
+	auto radius = BoundCastExpression::AddCastToType(context, std::move(radius_expr), LogicalType::DOUBLE);
+	if (is_strict) {
+		Value radius_value;
+		if (!ExpressionExecutor::TryEvaluateScalar(context, *radius, radius_value) || radius_value.IsNull()) {
+			// Put the comparison back together, it never matches anyway
+			radius_expr = std::move(radius);
+			return expr;
+		}
+		const auto radius_double = radius_value.GetValue<double>();
+		const auto strict_radius = std::nextafter(radius_double, -std::numeric_limits<double>::infinity());
+		radius = make_uniq<BoundConstantExpression>(Value::DOUBLE(strict_radius));
+	}
+
+	auto within_func = entry->functions.GetFunctionByArguments(context, {arg_type, arg_type, LogicalType::DOUBLE});
+
+	vector<unique_ptr<Expression>> args;
+	args.push_back(std::move(func.children[0]));
+	args.push_back(std::move(func.children[1]));
+	args.push_back(std::move(radius));
+
+	return make_uniq_base<Expression, BoundFunctionExpression>(LogicalType::BOOLEAN, within_func, std::move(args),
+	                                                           nullptr);
+}
+
+// The join keys have to be GEOMETRY, so geodesic predicates on POINT_2D are bound to their GEOMETRY variant instead
+static void TryCastGeodesicPredicate(ClientContext &context, BoundFunctionExpression &func) {
+	if (spatial_geodesic_predicate_map.count(func.function.name) == 0 ||
+	    func.children[0]->return_type != GeoTypes::POINT_2D() ||
+	    func.children[1]->return_type != GeoTypes::POINT_2D()) {
 		return;
 	}
+	auto &catalog = Catalog::GetSystemCatalog(context);
+	auto &entry = catalog.GetEntry<ScalarFunctionCatalogEntry>(context, DEFAULT_SCHEMA, func.function.name);
+	func.function = entry.functions.GetFunctionByArguments(
+	    context, {GeoTypes::GEOMETRY(), GeoTypes::GEOMETRY(), LogicalType::DOUBLE});
+	func.bind_info = nullptr;
+	func.children[0] = BoundCastExpression::AddCastToType(context, std::move(func.children[0]), GeoTypes::GEOMETRY());
+	func.children[1] = BoundCastExpression::AddCastToType(context, std::move(func.children[1]), GeoTypes::GEOMETRY());
+}
 
-	auto &any_join = op.Cast<LogicalAnyJoin>();
+// Fold the distance argument of a distance predicate into a constant.
+// Returns false if the distance is not constant, or NULL (in which case the predicate never matches)
+static bool TryFoldDistanceArgument(ClientContext &context, BoundFunctionExpression &func) {
+	if (func.children.size() != 3 || !func.children[2]->IsFoldable()) {
+		return false;
+	}
+	Value distance;
+	if (!ExpressionExecutor::TryEvaluateScalar(context, *func.children[2], distance)) {
+		return false;
+	}
+	if (distance.IsNull() || !distance.DefaultTryCastAs(LogicalType::DOUBLE)) {
+		return false;
+	}
+	func.children[2] = make_uniq<BoundConstantExpression>(std::move(distance));
+	return true;
+}
 
-	// We also only support simple join types
-	auto join_supported = false;
-	switch (any_join.join_type) {
-	case JoinType::INNER:
-	case JoinType::LEFT:
-	case JoinType::RIGHT:
-	case JoinType::OUTER:
-		join_supported = true;
-		break;
-	default:
-		break;
+// Rewrite the column references of an index expression to the columns of the given table scan
+static void RewriteIndexExpression(Index &index, LogicalGet &get, Expression &expr, bool &rewrite_possible) {
+	if (expr.type == ExpressionType::BOUND_COLUMN_REF) {
+		auto &bound_colref = expr.Cast<BoundColumnRefExpression>();
+		bound_colref.binding.table_index = get.table_index;
+		auto &column_ids = index.GetColumnIds();
+		auto &get_column_ids = get.GetColumnIds();
+		const auto referenced_column = column_ids[bound_colref.binding.column_index];
+		for (idx_t i = 0; i < get_column_ids.size(); i++) {
+			if (get_column_ids[i].GetPrimaryIndex() == referenced_column) {
+				bound_colref.binding.column_index = i;
+				return;
+			}
+		}
+		// The scan does not read the indexed column
+		rewrite_possible = false;
 	}
-	if (!join_supported) {
+	ExpressionIterator::EnumerateChildren(
+	    expr, [&](Expression &child) { RewriteIndexExpression(index, get, child, rewrite_possible); });
+}
+
+// Find an RTREE index on the build side key, if the build side is a plain scan of a table
+static optional_ptr<RTreeIndex> TryGetJoinIndex(ClientContext &context, LogicalOperator &build_side,
+                                                LogicalOperator &probe_side, const Expression &build_key,
+                                                optional_ptr<DuckTableEntry> &index_table) {
+	if (build_side.type != LogicalOperatorType::LOGICAL_GET) {
+		return nullptr;
+	}
+	auto &get = build_side.Cast<LogicalGet>();
+	if (get.function.name != "seq_scan") {
+		return nullptr;
+	}
+	// Filters on the build side would have to be applied after fetching, leave that to the regular join
+	if (!get.table_filters.filters.empty() || (get.dynamic_filters && get.dynamic_filters->HasFilters())) {
+		return nullptr;
+	}
+	auto table = get.GetTable();
+	if (!table || !table->IsDuckTable()) {
+		return nullptr;
+	}
+	auto &duck_table = table->Cast<DuckTableEntry>();
+	auto &storage = duck_table.GetStorage();
+
+	// Transaction-local changes are not in the index yet
+	auto &local_storage = LocalStorage::Get(context, duck_table.catalog);
+	if (local_storage.Find(storage)) {
+		return nullptr;
+	}
+
+	// Every probe fetches its matches from the table one by one, so this only pays off if the probe side is small
+	// compared to the indexed table
+	auto max_probe_ratio = SpatialJoinOptimizer::DEFAULT_INDEX_JOIN_MAX_PROBE_RATIO;
+	Value ratio_value;
+	if (context.TryGetCurrentSetting("spatial_join_index_max_probe_ratio", ratio_value) && !ratio_value.IsNull()) {
+		max_probe_ratio = ratio_value.GetValue<double>();
+	}
+	const auto probe_rows = static_cast<double>(probe_side.EstimateCardinality(context));
+	const auto table_rows = static_cast<double>(storage.GetTotalRows());
+	if (max_probe_ratio <= 0 || probe_rows > table_rows * max_probe_ratio) {
+		return nullptr;
+	}
+
+	optional_ptr<RTreeIndex> result;
+	auto &table_info = *storage.GetDataTableInfo();
+	table_info.GetIndexes().BindAndScan<RTreeIndex>(context, table_info, [&](RTreeIndex &index_entry) {
+		bool rewrite_possible = true;
+		auto index_expr = index_entry.unbound_expressions[0]->Copy();
+		RewriteIndexExpression(index_entry, get, *index_expr, rewrite_possible);
+		if (!rewrite_possible || !index_expr->Equals(build_key)) {
+			return false;
+		}
+		result = &index_entry;
+		return true;
+	});
+	if (result) {
+		index_table = &duck_table;
+	}
+	return result;
+}
+
+// Swap the build and probe side of an inner join, inverting the spatial predicate
+static void SwapJoinSides(ClientContext &context, LogicalSpatialJoin &join) {
+	join.spatial_predicate = TryGetInversePredicate(context, std::move(join.spatial_predicate));
+	std::swap(join.children[0], join.children[1]);
+	std::swap(join.left_projection_map, join.right_projection_map);
+	if (join.join_stats.size() == 2) {
+		std::swap(join.join_stats[0], join.join_stats[1]);
+	}
+	join.ResolveOperatorTypes();
+}
+
+// If one side of the join is a scan of a table with an RTREE index on the join key, probe the index with the rows of
+// the other side (an index nested loop join) instead of building a new rtree over the whole table.
+static void TryUseIndexJoin(ClientContext &context, LogicalSpatialJoin &join) {
+	// The index can not tell which build side rows did not match anything
+	if (join.join_type != JoinType::INNER && join.join_type != JoinType::LEFT) {
 		return;
 	}
 
-	// Inspect the join condition
-	vector<unique_ptr<Expression>> expressions;
-	expressions.push_back(any_join.condition->Copy()); // TODO: Maybe move instead of copy
+	auto &func = join.spatial_predicate->Cast<BoundFunctionExpression>();
+	if (!SpatialKey::IsKeyType(func.children[0]->return_type) || !SpatialKey::IsKeyType(func.children[1]->return_type)) {
+		return;
+	}
 
-	// Split by AND
-	LogicalFilter::SplitPredicates(expressions);
+	// The index is probed with planar boxes
+	if (spatial_geodesic_predicate_map.count(func.function.name) != 0) {
+		return;
+	}
 
-	// Get the table indexes that are reachable from the left and right children
-	auto &left_child = any_join.children[0];
-	auto &right_child = any_join.children[1];
-	unordered_set<idx_t> left_bindings;
-	unordered_set<idx_t> right_bindings;
-	LogicalJoin::GetTableReferences(*left_child, left_bindings);
-	LogicalJoin::GetTableReferences(*right_child, right_bindings);
+	join.index = TryGetJoinIndex(context, *join.children[1], *join.children[0], *func.children[1], join.index_table);
+	if (join.index || join.join_type != JoinType::INNER ||
+	    spatial_predicate_inverse_map.count(func.function.name) == 0) {
+		return;
+	}
+
+	// The join order optimizer usually puts the smaller side on the right. For inner joins, we can swap the sides
+	join.index = TryGetJoinIndex(context, *join.children[0], *join.children[1], *func.children[0], join.index_table);
+	if (!join.index) {
+		return;
+	}
+	SwapJoinSides(context, join);
+}
+
+// The build (right) side of the join is materialized and indexed, and partitioned if it does not fit in memory, while
+// the probe side is streamed through. So the build side should be the smaller side, building an rtree over millions of
+// points to probe it with a handful of polygons is backwards. For inner joins we can swap the sides, as long as the
+// predicate can be inverted.
+//
+// Usually the side with the fewest (estimated) rows is the smaller one. But a few large polygons can take up far more
+// memory than many points, so if the statistics show that the left side only holds points, whose size is known
+// exactly, compare the (upper bound of the) size in bytes of both sides instead.
+static void TryPickBuildSide(ClientContext &context, LogicalSpatialJoin &join) {
+	if (join.join_type != JoinType::INNER || join.index) {
+		return;
+	}
+
+	auto &func = join.spatial_predicate->Cast<BoundFunctionExpression>();
+	if (spatial_predicate_inverse_map.count(func.function.name) == 0) {
+		return;
+	}
+
+	auto left_size = static_cast<double>(join.children[0]->EstimateCardinality(context));
+	auto right_size = static_cast<double>(join.children[1]->EstimateCardinality(context));
+
+	GeometryStats left_stats;
+	GeometryStats right_stats;
+	if (GeometryStats::TryGetStatistics(context, *join.children[0], *func.children[0], left_stats) &&
+	    GeometryStats::TryGetStatistics(context, *join.children[1], *func.children[1], right_stats) &&
+	    left_stats.IsPointsOnly() && !right_stats.IsPointsOnly() && left_stats.max_size != 0 &&
+	    right_stats.max_size != 0) {
+		left_size *= static_cast<double>(left_stats.max_size);
+		right_size *= static_cast<double>(right_stats.max_size);
+	}
+
+	if (left_size < right_size) {
+		SwapJoinSides(context, join);
+	}
+}
+
+// Whether the operator is a plain scan of a table, so that scanning the same table twice yields the same rows
+static bool IsPlainTableScan(LogicalOperator &op) {
+	if (op.type != LogicalOperatorType::LOGICAL_GET) {
+		return false;
+	}
+	auto &get = op.Cast<LogicalGet>();
+	if (get.function.name != "seq_scan" || !get.GetTable()) {
+		return false;
+	}
+	if (!get.table_filters.filters.empty() || (get.dynamic_filters && get.dynamic_filters->HasFilters())) {
+		return false;
+	}
+	return get.projection_ids.empty() && !get.extra_info.sample_options;
+}
+
+// Map each column read by one scan to the same column read by another scan of the same table.
+// Returns false if the first scan reads a column that the other scan does not.
+static bool TryMapScanColumns(const LogicalGet &from, const LogicalGet &to, vector<idx_t> &column_map) {
+	column_map.clear();
+	const auto &from_ids = from.GetColumnIds();
+	const auto &to_ids = to.GetColumnIds();
+	for (const auto &from_id : from_ids) {
+		if (from_id.HasChildren()) {
+			return false;
+		}
+		idx_t to_idx = 0;
+		while (to_idx < to_ids.size() &&
+		       (to_ids[to_idx].HasChildren() || to_ids[to_idx].GetPrimaryIndex() != from_id.GetPrimaryIndex())) {
+			to_idx++;
+		}
+		if (to_idx == to_ids.size()) {
+			return false;
+		}
+		column_map.push_back(to_idx);
+	}
+	return true;
+}
 
-	// TODO: Only support a single predicate for now
-	if (expressions.size() != 1) {
+// Rewrite the column references of an expression over one scan to the same columns of another scan
+static void RewriteSelfJoinExpression(const LogicalGet &from, const LogicalGet &to, const vector<idx_t> &column_map,
+                                      Expression &expr, bool &rewrite_possible) {
+	if (expr.type == ExpressionType::BOUND_COLUMN_REF) {
+		auto &bound_colref = expr.Cast<BoundColumnRefExpression>();
+		if (bound_colref.binding.table_index != from.table_index) {
+			rewrite_possible = false;
+			return;
+		}
+		bound_colref.binding.table_index = to.table_index;
+		bound_colref.binding.column_index = column_map[bound_colref.binding.column_index];
+		return;
+	}
+	ExpressionIterator::EnumerateChildren(
+	    expr, [&](Expression &child) { RewriteSelfJoinExpression(from, to, column_map, child, rewrite_possible); });
+}
+
+// A self join of a table on a symmetric predicate, e.g. "FROM t a JOIN t b ON ST_Intersects(a.geom, b.geom)", does not
+// need to scan the table twice, or to probe the rtree with every row. Instead we scan the RHS once, and join its rtree
+// with itself, which visits each unordered pair of rows once. Both sides must read the same key from the same rows,
+// and every column the LHS reads must also be read by the RHS (or the other way around, in which case we swap them).
+static void TryUseSelfJoin(ClientContext &context, LogicalSpatialJoin &join) {
+	if (join.join_type != JoinType::INNER || join.index) {
+		return;
+	}
+
+	auto &func = join.spatial_predicate->Cast<BoundFunctionExpression>();
+	const auto it = spatial_predicate_inverse_map.find(func.function.name);
+	if (it == spatial_predicate_inverse_map.end() || !StringUtil::CIEquals(it->first, it->second)) {
 		return;
 	}
 
-	// TODO: This whole logic is a work in progress.
-	// it does a bunch of extra work trying to separate the predicates, which doesnt matter because we only support
-	// a single join condition for now anyway
+	// The nodes of the rtree are expanded by a planar distance when joining it with itself
+	if (spatial_geodesic_predicate_map.count(func.function.name) != 0) {
+		return;
+	}
 
-	// The spatial join condition
-	unique_ptr<Expression> spatial_pred_expr = nullptr;
+	if (!IsPlainTableScan(*join.children[0]) || !IsPlainTableScan(*join.children[1])) {
+		return;
+	}
+	auto &lhs_get = join.children[0]->Cast<LogicalGet>();
+	auto &rhs_get = join.children[1]->Cast<LogicalGet>();
+	if (lhs_get.GetTable().get() != rhs_get.GetTable().get()) {
+		return;
+	}
 
+	vector<idx_t> column_map;
+	if (!TryMapScanColumns(lhs_get, rhs_get, column_map)) {
+		if (!TryMapScanColumns(rhs_get, lhs_get, column_map)) {
+			return;
+		}
+		SwapJoinSides(context, join);
+	}
+
+	// Both keys must be the same expression over the same columns
+	auto &lhs = join.children[0]->Cast<LogicalGet>();
+	auto &rhs = join.children[1]->Cast<LogicalGet>();
+	auto &keys = join.spatial_predicate->Cast<BoundFunctionExpression>().children;
+
+	bool rewrite_possible = true;
+	auto lhs_key = keys[0]->Copy();
+	RewriteSelfJoinExpression(lhs, rhs, column_map, *lhs_key, rewrite_possible);
+	if (!rewrite_possible || !lhs_key->Equals(*keys[1])) {
+		return;
+	}
+
+	join.self_join = true;
+	join.self_join_column_map = std::move(column_map);
+}
+
+// The build side is indexed with an rtree, unless it only holds points, as then a uniform grid is both faster to build
+// and to probe (see FlatRTree::BuildGrid). The statistics do not tell whether the points are uniformly dense, but the
+// entries of each cell are sorted, so dense cells are still swept quickly. The choice can be overridden with the
+// spatial_join_algorithm setting.
+static void TryUseGridJoin(ClientContext &context, LogicalSpatialJoin &join) {
+	// The rtree of a self join is joined with itself, and index joins probe the existing index
+	if (join.index || join.self_join) {
+		return;
+	}
+
+	Value algorithm_value;
+	if (context.TryGetCurrentSetting("spatial_join_algorithm", algorithm_value) && !algorithm_value.IsNull()) {
+		const auto algorithm = StringUtil::Lower(algorithm_value.ToString());
+		if (algorithm == "rtree") {
+			return;
+		}
+		if (algorithm == "grid") {
+			join.algorithm = SpatialJoinAlgorithm::GRID;
+			return;
+		}
+	}
+
+	auto &func = join.spatial_predicate->Cast<BoundFunctionExpression>();
+	auto &build_key = *func.children[1];
+	if (build_key.return_type == GeoTypes::POINT_2D()) {
+		join.algorithm = SpatialJoinAlgorithm::GRID;
+		return;
+	}
+
+	GeometryStats build_stats;
+	if (build_key.return_type == GeoTypes::GEOMETRY() &&
+	    GeometryStats::TryGetStatistics(context, *join.children[1], build_key, build_stats) &&
+	    build_stats.IsPointsOnly()) {
+		join.algorithm = SpatialJoinAlgorithm::GRID;
+	}
+}
+
+// The conditions of a join, split into the spatial predicate to join on and the other predicates
+struct SpatialJoinConditions {
+	//! The spatial predicate, with the key of the left (probe) side as its first argument
+	unique_ptr<Expression> spatial_predicate;
+	//! The predicates over only one side of the join, which are pushed into that side
+	vector<unique_ptr<Expression>> left_predicates;
+	vector<unique_ptr<Expression>> right_predicates;
+	//! The remaining predicates, which are evaluated on the joined pairs
+	vector<unique_ptr<Expression>> residual_predicates;
+};
+
+// Whether predicates over only one side of the join can be evaluated below the join. That is the case if the rows of
+// that side that do not satisfy them are not emitted without a match either.
+static bool CanPushIntoSide(JoinType join_type, JoinSide side) {
+	switch (join_type) {
+	case JoinType::INNER:
+		return side == JoinSide::LEFT || side == JoinSide::RIGHT;
+	case JoinType::LEFT:
+	case JoinType::SEMI:
+	case JoinType::ANTI:
+	case JoinType::MARK:
+		return side == JoinSide::RIGHT;
+	case JoinType::RIGHT:
+		return side == JoinSide::LEFT;
+	default:
+		return false;
+	}
+}
+
+// Split the conjuncts of a join condition into a spatial predicate and the other predicates. Returns false if there is
+// no spatial predicate among them, or if the other predicates can not be evaluated outside of the join. Predicates
+// over both sides can only be evaluated on the joined pairs of an inner join, with a filter on top of the join.
+static bool TrySplitJoinConditions(ClientContext &context, JoinType join_type,
+                                   vector<unique_ptr<Expression>> expressions, const unordered_set<idx_t> &left_bindings,
+                                   const unordered_set<idx_t> &right_bindings, SpatialJoinConditions &result) {
 	// Extra predicates that are not spatial predicates
 	vector<unique_ptr<Expression>> extra_predicates;
 
@@ -116,12 +542,15 @@ static void InsertSpatialJoin(OptimizerExtensionInput &input, unique_ptr<Logical
 	for (auto &expr : expressions) {
 		auto total_side = JoinSide::GetJoinSide(*expr, left_bindings, right_bindings);
 
-		if (total_side != JoinSide::BOTH) {
-			// Throw?. No, push down the filter
+		// We join on the first spatial predicate, any other ones are evaluated on the joined pairs
+		if (total_side != JoinSide::BOTH || result.spatial_predicate) {
 			extra_predicates.push_back(std::move(expr));
 			continue;
 		}
 
+		// Distance comparisons can be turned into distance predicates
+		expr = TryRewriteDistanceComparison(context, std::move(expr));
+
 		// Check if the expression is a spatial predicate
 		if (expr->type != ExpressionType::BOUND_FUNCTION) {
 			extra_predicates.push_back(std::move(expr));
@@ -131,7 +560,27 @@ static void InsertSpatialJoin(OptimizerExtensionInput &input, unique_ptr<Logical
 		auto &func = expr->Cast<BoundFunctionExpression>();
 
 		// The function must be a recognized spatial predicate
-		if (spatial_predicate_map.count(func.function.name) == 0) {
+		const auto is_distance_predicate = spatial_distance_predicate_map.count(func.function.name) != 0;
+		if (spatial_predicate_map.count(func.function.name) == 0 && !is_distance_predicate) {
+			extra_predicates.push_back(std::move(expr));
+			continue;
+		}
+
+		// Distance predicates need a constant distance, and GEOMETRY arguments
+		if (is_distance_predicate) {
+			TryCastGeodesicPredicate(context, func);
+		}
+		if (is_distance_predicate &&
+		    (func.children[0]->return_type != GeoTypes::GEOMETRY() ||
+		     func.children[1]->return_type != GeoTypes::GEOMETRY() || !TryFoldDistanceArgument(context, func))) {
+			extra_predicates.push_back(std::move(expr));
+			continue;
+		}
+
+		// The other predicates need two arguments whose bounds we can read, i.e. geometries, points or boxes
+		if (!is_distance_predicate &&
+		    (func.children.size() != 2 || !SpatialKey::IsKeyType(func.children[0]->return_type) ||
+		     !SpatialKey::IsKeyType(func.children[1]->return_type))) {
 			extra_predicates.push_back(std::move(expr));
 			continue;
 		}
@@ -146,32 +595,149 @@ static void InsertSpatialJoin(OptimizerExtensionInput &input, unique_ptr<Logical
 		}
 
 		if (left_side == JoinSide::RIGHT) {
-			expr = TryGetInversePredicate(input.context, std::move(expr));
-			if (expr == nullptr) {
-				// We cant flip this, abort!
-				return;
+			if (spatial_predicate_inverse_map.count(func.function.name) == 0) {
+				// We cant flip this, so we cant join on it
+				extra_predicates.push_back(std::move(expr));
+				continue;
 			}
+			expr = TryGetInversePredicate(context, std::move(expr));
 		}
 
-		spatial_pred_expr = std::move(expr);
+		result.spatial_predicate = std::move(expr);
 	}
 
 	// Nope! No spatial predicate found
-	if (!spatial_pred_expr) {
+	if (!result.spatial_predicate) {
+		return false;
+	}
+
+	for (auto &expr : extra_predicates) {
+		const auto side = JoinSide::GetJoinSide(*expr, left_bindings, right_bindings);
+		if (CanPushIntoSide(join_type, side)) {
+			auto &target = side == JoinSide::LEFT ? result.left_predicates : result.right_predicates;
+			target.push_back(std::move(expr));
+		} else {
+			result.residual_predicates.push_back(std::move(expr));
+		}
+	}
+
+	return result.residual_predicates.empty() || join_type == JoinType::INNER;
+}
+
+// Filter a child of the join with a predicate over only that child
+static void PushIntoSide(unique_ptr<LogicalOperator> &child, unique_ptr<Expression> predicate) {
+	auto filter = make_uniq<LogicalFilter>(std::move(predicate));
+	filter->children.push_back(std::move(child));
+	filter->ResolveOperatorTypes();
+	child = std::move(filter);
+}
+
+// Finish planning a spatial join, whose children, statistics and cardinality are set already, and return the plan that
+// replaces the original join. The residual predicates are evaluated by a filter on top of the join, which needs the
+// columns they reference, so then the join emits all columns of both sides and the filter only passes on the columns
+// that the original join produced.
+static unique_ptr<LogicalOperator> PlanSpatialJoin(ClientContext &context, unique_ptr<LogicalSpatialJoin> spatial_join,
+                                                   SpatialJoinConditions &conditions,
+                                                   const vector<ColumnBinding> &output_bindings) {
+	spatial_join->spatial_predicate = std::move(conditions.spatial_predicate);
+	for (auto &predicate : conditions.left_predicates) {
+		PushIntoSide(spatial_join->children[0], std::move(predicate));
+	}
+	for (auto &predicate : conditions.right_predicates) {
+		PushIntoSide(spatial_join->children[1], std::move(predicate));
+	}
+	if (!conditions.residual_predicates.empty()) {
+		spatial_join->left_projection_map.clear();
+		spatial_join->right_projection_map.clear();
+	}
+	spatial_join->ResolveOperatorTypes();
+
+	TryUseIndexJoin(context, *spatial_join);
+	TryPickBuildSide(context, *spatial_join);
+	TryUseSelfJoin(context, *spatial_join);
+	TryUseGridJoin(context, *spatial_join);
+
+	if (conditions.residual_predicates.empty()) {
+		return std::move(spatial_join);
+	}
+
+	auto filter = make_uniq<LogicalFilter>();
+	filter->expressions = std::move(conditions.residual_predicates);
+
+	const auto join_bindings = spatial_join->GetColumnBindings();
+	for (auto &binding : output_bindings) {
+		const auto it = std::find(join_bindings.begin(), join_bindings.end(), binding);
+		if (it == join_bindings.end()) {
+			throw InternalException("Spatial join does not produce a column of the join it replaces");
+		}
+		filter->projection_map.push_back(NumericCast<idx_t>(it - join_bindings.begin()));
+	}
+
+	filter->has_estimated_cardinality = spatial_join->has_estimated_cardinality;
+	filter->estimated_cardinality = spatial_join->estimated_cardinality;
+	filter->children.push_back(std::move(spatial_join));
+	filter->ResolveOperatorTypes();
+	return std::move(filter);
+}
+
+static bool IsSupportedJoinType(JoinType join_type) {
+	switch (join_type) {
+	case JoinType::INNER:
+	case JoinType::LEFT:
+	case JoinType::RIGHT:
+	case JoinType::OUTER:
+	case JoinType::SEMI:
+	case JoinType::ANTI:
+	case JoinType::MARK:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void InsertSpatialJoin(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	auto &op = *plan;
+
+	// We only care about ANY_JOIN operators
+	if (op.type != LogicalOperatorType::LOGICAL_ANY_JOIN) {
+		return;
+	}
+
+	auto &any_join = op.Cast<LogicalAnyJoin>();
+
+	// We also only support simple join types
+	if (!IsSupportedJoinType(any_join.join_type)) {
 		return;
 	}
 
-	// TODO: Push a filter for the extra conditions?
+	// Inspect the join condition
+	vector<unique_ptr<Expression>> expressions;
+	expressions.push_back(any_join.condition->Copy()); // TODO: Maybe move instead of copy
+
+	// Split by AND
+	LogicalFilter::SplitPredicates(expressions);
+
+	// Get the table indexes that are reachable from the left and right children
+	auto &left_child = any_join.children[0];
+	auto &right_child = any_join.children[1];
+	unordered_set<idx_t> left_bindings;
+	unordered_set<idx_t> right_bindings;
+	LogicalJoin::GetTableReferences(*left_child, left_bindings);
+	LogicalJoin::GetTableReferences(*right_child, right_bindings);
+
+	SpatialJoinConditions conditions;
+	if (!TrySplitJoinConditions(input.context, any_join.join_type, std::move(expressions), left_bindings,
+	                            right_bindings, conditions)) {
+		return;
+	}
 
 	// Cool, now we have spatial join conditions. Proceed to create a new LogicalSpatialJoin operator
+	const auto output_bindings = any_join.GetColumnBindings();
 	auto spatial_join = make_uniq<LogicalSpatialJoin>(any_join.join_type);
 
 	// Steal the properties from the any join
-	spatial_join->spatial_predicate = std::move(spatial_pred_expr);
-	spatial_join->extra_conditions = std::move(extra_predicates);
 	spatial_join->children = std::move(any_join.children);
 	spatial_join->expressions = std::move(any_join.expressions);
-	spatial_join->types = std::move(any_join.types);
 	spatial_join->left_projection_map = std::move(any_join.left_projection_map);
 	spatial_join->right_projection_map = std::move(any_join.right_projection_map);
 	spatial_join->join_stats = std::move(any_join.join_stats);
@@ -180,12 +746,69 @@ static void InsertSpatialJoin(OptimizerExtensionInput &input, unique_ptr<Logical
 	spatial_join->estimated_cardinality = any_join.estimated_cardinality;
 
 	// Replace the operator
-	plan = std::move(spatial_join);
+	plan = PlanSpatialJoin(input.context, std::move(spatial_join), conditions, output_bindings);
+}
+
+// The planner turns the conditions of an inner join into a comparison join on the comparisons between both sides, e.g.
+// the equality of a key or a range of timestamps, and a filter on top for the other conditions, such as a spatial
+// predicate. If the comparisons leave many pairs to check the spatial predicate for, we rather join on the spatial
+// predicate and check the comparisons on the (few) pairs of rows whose bounds intersect.
+static void InsertSpatialJoinBelowFilter(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	if (plan->type != LogicalOperatorType::LOGICAL_FILTER ||
+	    plan->children[0]->type != LogicalOperatorType::LOGICAL_COMPARISON_JOIN) {
+		return;
+	}
+
+	auto &filter = plan->Cast<LogicalFilter>();
+	auto &comparison_join = filter.children[0]->Cast<LogicalComparisonJoin>();
+	if (comparison_join.join_type != JoinType::INNER) {
+		return;
+	}
+
+	// If the comparisons produce at most as many pairs as there are rows on the larger side, they are selective enough
+	const auto join_rows = comparison_join.EstimateCardinality(input.context);
+	const auto left_rows = comparison_join.children[0]->EstimateCardinality(input.context);
+	const auto right_rows = comparison_join.children[1]->EstimateCardinality(input.context);
+	if (join_rows <= MaxValue(left_rows, right_rows)) {
+		return;
+	}
+
+	vector<unique_ptr<Expression>> expressions;
+	for (auto &expr : filter.expressions) {
+		expressions.push_back(expr->Copy());
+	}
+	LogicalFilter::SplitPredicates(expressions);
+	for (auto &cond : comparison_join.conditions) {
+		expressions.push_back(
+		    make_uniq<BoundComparisonExpression>(cond.comparison, cond.left->Copy(), cond.right->Copy()));
+	}
+
+	unordered_set<idx_t> left_bindings;
+	unordered_set<idx_t> right_bindings;
+	LogicalJoin::GetTableReferences(*comparison_join.children[0], left_bindings);
+	LogicalJoin::GetTableReferences(*comparison_join.children[1], right_bindings);
+
+	SpatialJoinConditions conditions;
+	if (!TrySplitJoinConditions(input.context, JoinType::INNER, std::move(expressions), left_bindings, right_bindings,
+	                            conditions)) {
+		return;
+	}
+
+	const auto output_bindings = filter.GetColumnBindings();
+	auto spatial_join = make_uniq<LogicalSpatialJoin>(JoinType::INNER);
+
+	spatial_join->children = std::move(comparison_join.children);
+	spatial_join->join_stats = std::move(comparison_join.join_stats);
+	spatial_join->has_estimated_cardinality = filter.has_estimated_cardinality;
+	spatial_join->estimated_cardinality = filter.estimated_cardinality;
+
+	plan = PlanSpatialJoin(input.context, std::move(spatial_join), conditions, output_bindings);
 }
 
 static void TryInsertSpatialJoin(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
 
 	InsertSpatialJoin(input, plan);
+	InsertSpatialJoinBelowFilter(input, plan);
 
 	// Recursively call this function on all children
 	for (auto &child : plan->children) {
@@ -193,12 +816,42 @@ static void TryInsertSpatialJoin(OptimizerExtensionInput &input, unique_ptr<Logi
 	}
 }
 
+static void SetSpatialJoinAlgorithm(ClientContext &context, SetScope scope, Value &parameter) {
+	if (parameter.IsNull()) {
+		return;
+	}
+	const auto algorithm = StringUtil::Lower(parameter.ToString());
+	if (algorithm != "auto" && algorithm != "rtree" && algorithm != "grid") {
+		throw InvalidInputException("Unknown spatial_join_algorithm '%s', expected 'auto', 'rtree' or 'grid'",
+		                            parameter.ToString());
+	}
+}
+
 void SpatialJoinOptimizer::Register(DatabaseInstance &db) {
 
 	OptimizerExtension optimizer;
 	optimizer.optimize_function = TryInsertSpatialJoin;
 
 	db.config.optimizer_extensions.push_back(optimizer);
+
+	db.config.AddExtensionOption("spatial_join_partitions",
+	                             "The number of spatial partitions to split the build side of an inner spatial join "
+	                             "into. 0 (the default) picks the number of partitions based on the memory limit",
+	                             LogicalType::UBIGINT, Value::UBIGINT(0));
+
+	db.config.AddExtensionOption("spatial_join_algorithm",
+	                             "How the build side of a spatial join is indexed: 'rtree', 'grid' (a uniform grid, "
+	                             "for uniformly dense points), or 'auto' (the default) to use a grid if the build side "
+	                             "only holds points",
+	                             LogicalType::VARCHAR, Value("auto"), SetSpatialJoinAlgorithm);
+
+	db.config.AddExtensionOption("spatial_join_index_max_probe_ratio",
+	                             "The estimated number of probe side rows, as a fraction of the rows of the build side "
+	                             "table, up to which a spatial join probes an RTREE index on the build side instead of "
+	                             "building a new rtree. 0 disables index joins",
+	                             LogicalType::DOUBLE, Value::DOUBLE(DEFAULT_INDEX_JOIN_MAX_PROBE_RATIO));
+
+	SpatialJoinBuildCache::Register(db);
 }
 
 } // namespace duckdb
\ No newline at end of file
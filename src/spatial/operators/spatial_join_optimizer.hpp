@@ -5,6 +5,8 @@ namespace duckdb {
 class DatabaseInstance;
 
 struct SpatialJoinOptimizer {
+	static constexpr double DEFAULT_INDEX_JOIN_MAX_PROBE_RATIO = 0.1;
+
 	static void Register(DatabaseInstance &db);
 };
 
@@ -1,325 +1,257 @@
 #include "spatial/operators/spatial_join_physical.hpp"
 #include "spatial/geometry/geometry_type.hpp"
 #include "spatial/geometry/sgl.hpp"
+#include "spatial/geometry/spatial_key.hpp"
+#include "spatial/operators/spatial_join_refine.hpp"
+#include "spatial/operators/spatial_join_rtree.hpp"
 #include "spatial/spatial_types.hpp"
+#include "spatial/util/math.hpp"
 #include "spatial_join_logical.hpp"
 
+#if SPATIAL_USE_GEOS
+#include "spatial/modules/geos/geos_prepared_cache.hpp"
+#endif
+
 #include "duckdb/catalog/catalog_entry/scalar_function_catalog_entry.hpp"
+#include "duckdb/common/profiler.hpp"
 #include "duckdb/common/types/row/tuple_data_collection.hpp"
 #include "duckdb/common/types/row/tuple_data_iterator.hpp"
 #include "duckdb/execution/operator/join/physical_comparison_join.hpp"
+#include "duckdb/parallel/base_pipeline_event.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include "duckdb/planner/expression/bound_function_expression.hpp"
 #include "duckdb/planner/expression/bound_operator_expression.hpp"
 #include "duckdb/planner/expression/bound_reference_expression.hpp"
 #include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
 #include "duckdb/storage/buffer_manager.hpp"
 
 namespace duckdb {
 
-//======================================================================================================================
-// Flat RTree
-//======================================================================================================================
-
 namespace {
 
-template <class T>
-class typed_view {
+//----------------------------------------------------------------------------------------------------------------------
+// Found Match Bitmap
+//----------------------------------------------------------------------------------------------------------------------
+// Tracks which build side rows have found a match in a right/outer join, one bit per rtree entry indexed by insertion
+// position. Bits are set concurrently by all the probing threads.
+class FoundMatchBitmap {
 public:
-	size_t size() const {
-		return len;
-	}
-	T *data() {
-		return ptr;
-	}
-	const T *data() const {
-		return ptr;
-	}
-	T &operator[](size_t idx) {
-		return data()[idx];
+	explicit FoundMatchBitmap(idx_t count) : word_count((count + 63) / 64) {
+		words = make_unsafe_uniq_array<atomic<uint64_t>>(word_count);
+		for (idx_t i = 0; i < word_count; i++) {
+			words[i].store(0, std::memory_order_relaxed);
+		}
 	}
-	const T &operator[](size_t idx) const {
-		return data()[idx];
+
+	void Set(idx_t position) {
+		auto &word = words[position / 64];
+		const auto mask = static_cast<uint64_t>(1) << (position % 64);
+		// Build side rows are often matched many times, only write to the word the first time
+		if ((word.load(std::memory_order_relaxed) & mask) == 0) {
+			word.fetch_or(mask, std::memory_order_relaxed);
+		}
 	}
 
-	void set(T *ptr_p, const size_t len_p) {
-		ptr = ptr_p;
-		len = len_p;
+	bool IsSet(idx_t position) const {
+		const auto mask = static_cast<uint64_t>(1) << (position % 64);
+		return (words[position / 64].load(std::memory_order_relaxed) & mask) != 0;
 	}
 
 private:
-	T *ptr = nullptr;
-	size_t len = 0;
+	idx_t word_count;
+	unsafe_unique_array<atomic<uint64_t>> words;
 };
 
-class FlatRTreeScanState {
-	friend class FlatRTree;
-	using Box = Box2D<float>;
+//----------------------------------------------------------------------------------------------------------------------
+// Parallel Build
+//----------------------------------------------------------------------------------------------------------------------
+// Sorts the flat rtree entries along the hilbert curve using a sample sort, and packs the leaf layer in parallel.
+// The work is split into four phases, each executed as a set of tasks:
+//   COUNT:   compute the curve value of each entry and count how many entries fall into each bucket
+//   SCATTER: copy each entry into its bucket in a temporary sort buffer
+//   SORT:    sort each bucket and write the entries back into the tree
+//   PACK:    create the first layer of parent nodes. The remaining (much smaller) layers are packed serially.
 
-public:
-	explicit FlatRTreeScanState() : matches(LogicalType::POINTER) {
-	}
+enum class FlatRTreeBuildPhase : uint8_t { COUNT, SCATTER, SORT, PACK };
 
-public:
-	Vector matches;
-	idx_t matches_count = 0;
-	idx_t matches_idx = 0;
+class FlatRTreeParallelBuildState {
+	using Box = Box2D<float>;
 
-private:
-	queue<size_t> search_queue;
-	Box search_box;
-	size_t entry_beg = 0;
-	size_t entry_pos = 0;
-	bool exhausted = true;
-};
+	struct SortEntry {
+		uint32_t curve;
+		uint32_t index;
+		Box box;
+	};
 
-class FlatRTree {
 public:
-	using Box = Box2D<float>;
+	// How many samples we take per bucket when computing the bucket splitters
+	static constexpr idx_t SAMPLES_PER_BUCKET = 64;
 
-	FlatRTree(Allocator &alloc, uint32_t item_count_p, uint32_t node_size_p)
-	    : item_count(item_count_p), node_size(node_size_p) {
+	FlatRTreeParallelBuildState(Allocator &allocator, FlatRTree &tree_p, idx_t task_count_p)
+	    : tree(tree_p), task_count(task_count_p), histogram(task_count_p * task_count_p, 0),
+	      bucket_offsets(task_count_p + 1, 0) {
 
-		uint32_t count = item_count;
-		uint32_t nodes = item_count;
+		timer.Start();
 
-		layer_bounds.push_back(nodes);
-
-		if (item_count_p == 0) {
-			return;
-		}
+		curve_mem = allocator.Allocate(sizeof(uint32_t) * tree.Count());
+		sort_mem = allocator.Allocate(sizeof(SortEntry) * tree.Count());
 
-		do {
-			count = (count + node_size - 1) / node_size;
-			nodes += count;
-			layer_bounds.push_back(nodes);
-		} while (count > 1);
+		curve.set(reinterpret_cast<uint32_t *>(curve_mem.get()), tree.Count());
+		sort_buffer.set(reinterpret_cast<SortEntry *>(sort_mem.get()), tree.Count());
 
-		box_array_mem = alloc.Allocate(sizeof(Box) * nodes);
-		idx_array_mem = alloc.Allocate(sizeof(uint32_t) * nodes);
-		row_array_mem = alloc.Allocate(sizeof(data_ptr_t) * item_count);
+		tree.PrepareCurve();
 
-		box_array.set(reinterpret_cast<Box *>(box_array_mem.get()), nodes);
-		idx_array.set(reinterpret_cast<uint32_t *>(idx_array_mem.get()), nodes);
-		row_array.set(reinterpret_cast<data_ptr_t *>(row_array_mem.get()), item_count);
+		// Pick the bucket splitters from a sorted sample of the curve values
+		const auto sample_count = MinValue<idx_t>(task_count * SAMPLES_PER_BUCKET, tree.Count());
+		const auto sample_step = tree.Count() / sample_count;
 
-		// Make sure that memory is initialized
-		for (size_t i = 0; i < nodes; i++) {
-			box_array[i] = Box();
-			idx_array[i] = 0;
+		vector<uint32_t> samples;
+		samples.reserve(sample_count);
+		for (idx_t i = 0; i < sample_count; i++) {
+			samples.push_back(tree.GetCurveValue(tree.GetBox(i * sample_step)));
 		}
-		for (size_t i = 0; i < item_count; i++) {
-			row_array[i] = nullptr;
+		std::sort(samples.begin(), samples.end());
+
+		for (idx_t i = 1; i < task_count; i++) {
+			splitters.push_back(samples[i * sample_count / task_count]);
 		}
 	}
 
-	uint32_t Count() const {
-		return item_count;
+	idx_t GetTaskCount() const {
+		return task_count;
 	}
 
-	// Return insertion index
-	uint32_t Push(const Box &box, data_ptr_t row) {
-		// Push the index and the box
-		idx_array[current_position] = current_position;
-		box_array[current_position] = box;
-
-		// Update the bounds
-		tree_box.Union(box);
-
-		// Store the row pointer
-		row_array[current_position] = row;
-
-		return current_position++;
+	// The time from the start of the build until the last phase finished, for profiling
+	double GetBuildTime() const {
+		return timer.Elapsed();
 	}
 
-	void Sort(vector<uint32_t> &curve) {
-		Sort(curve, 0, curve.size() - 1);
+	void Execute(FlatRTreeBuildPhase phase, idx_t task_idx) {
+		switch (phase) {
+		case FlatRTreeBuildPhase::COUNT:
+			Count(task_idx);
+			break;
+		case FlatRTreeBuildPhase::SCATTER:
+			Scatter(task_idx);
+			break;
+		case FlatRTreeBuildPhase::SORT:
+			SortBucket(task_idx);
+			break;
+		case FlatRTreeBuildPhase::PACK:
+			Pack(task_idx);
+			break;
+		default:
+			D_ASSERT(false);
+			break;
+		}
 	}
 
-	void Sort(vector<uint32_t> &curve, size_t l_idx, size_t r_idx) {
-		if (l_idx < r_idx) {
-			const auto pivot = curve[(l_idx + r_idx) >> 1];
-			auto pivot_l = l_idx - 1;
-			auto pivot_r = r_idx + 1;
-
-			while (true) {
-				do {
-					++pivot_l;
-				} while (curve[pivot_l] < pivot);
-				do {
-					--pivot_r;
-				} while (curve[pivot_r] > pivot);
-
-				if (pivot_l >= pivot_r) {
-					break;
-				}
-
-				// Reorder the curve, boxes and indices
-				// TODO: Pass callback here and make static
-				std::swap(curve[pivot_l], curve[pivot_r]);
-				std::swap(box_array[pivot_l], box_array[pivot_r]);
-				std::swap(idx_array[pivot_l], idx_array[pivot_r]);
+	// Called once all tasks of a phase have finished
+	void Finish(FlatRTreeBuildPhase phase) {
+		switch (phase) {
+		case FlatRTreeBuildPhase::COUNT:
+			ComputeOffsets();
+			break;
+		case FlatRTreeBuildPhase::SORT:
+			// We dont need the temporary buffers anymore
+			curve_mem.Reset();
+			sort_mem.Reset();
+			break;
+		case FlatRTreeBuildPhase::PACK:
+			// Pack the remaining layers serially, they are a factor of node_size smaller than the leaf layer
+			for (idx_t layer_idx = 1; layer_idx < tree.GetLayerCount() - 1; layer_idx++) {
+				tree.PackLayer(layer_idx, 0, tree.GetLayerSize(layer_idx + 1));
 			}
-
-			Sort(curve, l_idx, pivot_r);
-			Sort(curve, pivot_r + 1, r_idx);
+			tree.FinishBuild();
+			timer.End();
+			break;
+		default:
+			break;
 		}
 	}
 
-	void Build() {
-		D_ASSERT(item_count == current_position);
-
-		if (item_count <= node_size) {
-			box_array[current_position++] = tree_box;
-			return;
-		}
-
-		// Generate hilbert curve values
-		// TODO: Parallelize this with tasks when the number of items is large?
-		constexpr auto max_hilbert = std::numeric_limits<uint16_t>::max();
-		const auto hw = max_hilbert / (tree_box.max.x - tree_box.min.x);
-		const auto hh = max_hilbert / (tree_box.max.y - tree_box.min.y);
-
-		vector<uint32_t> curve(item_count);
-		for (idx_t i = 0; i < item_count; i++) {
-			const auto &node_box = box_array[i];
+private:
+	// Split [0, count) evenly into task_count ranges
+	pair<idx_t, idx_t> GetRange(idx_t count, idx_t task_idx) const {
+		const auto beg = count * task_idx / task_count;
+		const auto end = count * (task_idx + 1) / task_count;
+		return {beg, end};
+	}
 
-			const auto hx = static_cast<uint32_t>(hw * ((node_box.min.x + node_box.max.x) / 2 - tree_box.min.x));
-			const auto hy = static_cast<uint32_t>(hh * ((node_box.min.y + node_box.max.y) / 2 - tree_box.min.y));
+	idx_t GetBucket(uint32_t value) const {
+		return NumericCast<idx_t>(std::upper_bound(splitters.begin(), splitters.end(), value) - splitters.begin());
+	}
 
-			curve[i] = sgl::util::hilbert_encode(16, hx, hy);
+	void Count(idx_t task_idx) {
+		const auto range = GetRange(tree.Count(), task_idx);
+		const auto counts = histogram.data() + task_idx * task_count;
+		for (auto i = range.first; i < range.second; i++) {
+			curve[i] = tree.GetCurveValue(tree.GetBox(i));
+			counts[GetBucket(curve[i])]++;
 		}
+	}
 
-		// Now, sort the indices based on their curve value
-		Sort(curve);
-
-		size_t layer_idx = 0;
-		size_t entry_idx = 0;
-
-		while (layer_idx < layer_bounds.size() - 1) {
-			const auto entry_end = layer_bounds[layer_idx];
-
-			while (entry_idx < entry_end) {
-				auto node_idx = entry_idx;
-				auto node_box = box_array[entry_idx];
-
-				size_t child_idx = 0;
-				while (child_idx < node_size && entry_idx < entry_end) {
-
-					node_box.Union(box_array[entry_idx]);
-
-					child_idx++;
-					entry_idx++;
-				}
-
-				// Add a new parent node
-				idx_array[current_position] = node_idx;
-				box_array[current_position] = node_box;
-				current_position++;
+	// Turn the per-task bucket counts into write offsets into the sort buffer
+	void ComputeOffsets() {
+		idx_t offset = 0;
+		for (idx_t bucket_idx = 0; bucket_idx < task_count; bucket_idx++) {
+			bucket_offsets[bucket_idx] = offset;
+			for (idx_t task_idx = 0; task_idx < task_count; task_idx++) {
+				auto &count = histogram[task_idx * task_count + bucket_idx];
+				const auto bucket_count = count;
+				count = offset;
+				offset += bucket_count;
 			}
-
-			// Go to the next layer
-			layer_idx++;
 		}
+		bucket_offsets[task_count] = offset;
+		D_ASSERT(offset == tree.Count());
 	}
 
-	size_t UpperBound(size_t node_idx) const {
-		const auto it = std::upper_bound(layer_bounds.begin(), layer_bounds.end(), node_idx);
-		if (it == layer_bounds.end()) {
-			return layer_bounds.back();
+	void Scatter(idx_t task_idx) {
+		const auto range = GetRange(tree.Count(), task_idx);
+		const auto offsets = histogram.data() + task_idx * task_count;
+		for (auto i = range.first; i < range.second; i++) {
+			auto &entry = sort_buffer[offsets[GetBucket(curve[i])]++];
+			entry.curve = curve[i];
+			entry.index = tree.GetIndex(i);
+			entry.box = tree.GetBox(i);
 		}
-		return *it;
 	}
 
-	void InitScan(FlatRTreeScanState &state, const Box &box) const {
-		while (!state.search_queue.empty()) {
-			state.search_queue.pop();
-		}
-		state.search_box = box;
-		state.entry_beg = box_array.size() - 1;
-		state.entry_pos = state.entry_beg;
-
-		state.exhausted = false;
-		state.matches_idx = 0;
-		state.matches_count = 0;
-	}
+	void SortBucket(idx_t bucket_idx) {
+		const auto beg = sort_buffer.data() + bucket_offsets[bucket_idx];
+		const auto end = sort_buffer.data() + bucket_offsets[bucket_idx + 1];
+		std::sort(beg, end, [](const SortEntry &a, const SortEntry &b) { return a.curve < b.curve; });
 
-	bool Scan(FlatRTreeScanState &state) const {
-		if (state.exhausted) {
-			return false;
+		for (auto i = bucket_offsets[bucket_idx]; i < bucket_offsets[bucket_idx + 1]; i++) {
+			tree.SetEntry(i, sort_buffer[i].box, sort_buffer[i].index);
 		}
-
-		idx_t count = 0;
-		const auto ptr = FlatVector::GetData<data_ptr_t>(state.matches);
-		Lookup(state, [&](const data_ptr_t &row) {
-			ptr[count++] = row;
-			return count == STANDARD_VECTOR_SIZE;
-		});
-		// Set the count of the result vector
-		state.matches_count = count;
-		state.matches_idx = 0;
-
-		return count > 0;
 	}
 
-	template <class CALLBACK>
-	void Lookup(FlatRTreeScanState &state, CALLBACK &&callback) const {
-
-		while (true) {
-
-			const auto entry_end = std::min(state.entry_beg + node_size, UpperBound(state.entry_beg));
-
-			while (state.entry_pos < entry_end) {
-				if (!state.search_box.Intersects(box_array[state.entry_pos])) {
-					state.entry_pos++;
-					continue;
-				}
-
-				auto yield = false;
-
-				if (state.entry_beg >= item_count) {
-					// Internal node
-					state.search_queue.push(idx_array[state.entry_pos]);
-				} else {
-					// Leaf node
-					yield = callback(row_array[idx_array[state.entry_pos]]);
-				}
-
-				state.entry_pos++;
-
-				if (yield) {
-					// Yield!, return true to signal that there might be more rows!
-					return;
-				}
-			}
-
-			if (state.search_queue.empty()) {
-				// There is no more nodes to search, return false!
-				state.exhausted = true;
-				return;
-			}
-
-			state.entry_beg = state.search_queue.front();
-			state.entry_pos = state.entry_beg;
-			state.search_queue.pop();
-		}
+	void Pack(idx_t task_idx) {
+		const auto range = GetRange(tree.GetLayerSize(1), task_idx);
+		tree.PackLayer(0, range.first, range.second);
 	}
 
 private:
-	vector<uint32_t> layer_bounds;
+	FlatRTree &tree;
+	idx_t task_count;
 
-	AllocatedData box_array_mem;
-	AllocatedData idx_array_mem;
-	AllocatedData row_array_mem;
+	// The curve values that separate the buckets
+	vector<uint32_t> splitters;
+	// The number of entries per (task, bucket) pair, later the write offset of each pair
+	vector<idx_t> histogram;
+	// The start offset of each bucket in the sort buffer
+	vector<idx_t> bucket_offsets;
 
-	typed_view<uint32_t> idx_array;
-	typed_view<Box> box_array;
-	typed_view<data_ptr_t> row_array;
+	AllocatedData curve_mem;
+	AllocatedData sort_mem;
 
-	Box tree_box;
+	typed_view<uint32_t> curve;
+	typed_view<SortEntry> sort_buffer;
 
-	uint32_t item_count = 0;
-	uint32_t node_size = 0;
-	uint32_t current_position = 0;
+	Profiler timer;
 };
 
 } // namespace
@@ -328,13 +260,26 @@ private:
 // Physical Spatial Join Operator
 //======================================================================================================================
 
+// Existence joins only emit the probe side rows (and a mark), depending on whether they have a match on the build side
+static bool IsExistenceJoin(JoinType join_type) {
+	return join_type == JoinType::SEMI || join_type == JoinType::ANTI || join_type == JoinType::MARK;
+}
+
 PhysicalSpatialJoin::PhysicalSpatialJoin(LogicalOperator &op, PhysicalOperator &left, PhysicalOperator &right,
                                          unique_ptr<Expression> condition_p, JoinType join_type,
                                          idx_t estimated_cardinality)
     : PhysicalJoin(op, PhysicalOperatorType::EXTENSION, join_type, estimated_cardinality),
       condition(std::move(condition_p)) {
 
-	children.emplace_back(left);
+	const auto &lop = op.Cast<LogicalSpatialJoin>();
+
+	// A self join reads both sides from the build side child, which is then passed as both the left and right side
+	self_join = lop.self_join;
+	algorithm = lop.algorithm;
+	D_ASSERT(!self_join || algorithm == SpatialJoinAlgorithm::RTREE);
+	if (!self_join) {
+		children.emplace_back(left);
+	}
 	children.emplace_back(right);
 
 	auto &func = condition->Cast<BoundFunctionExpression>();
@@ -343,32 +288,51 @@ PhysicalSpatialJoin::PhysicalSpatialJoin(LogicalOperator &op, PhysicalOperator &
 	probe_side_key = func.children[0].get();
 	build_side_key = func.children[1].get();
 
+	// Distance predicates have a third, constant (non-null) argument, this is ensured by the optimizer
+	if (func.children.size() == 3) {
+		const auto &distance = func.children[2]->Cast<BoundConstantExpression>().value;
+		probe_side_expansion = MaxValue(distance.GetValue<double>(), 0.0);
+	}
+
+	// The geodesic distance predicates measure the distance in meters, along the surface of the earth
+	if (StringUtil::CIEquals(func.function.name, "ST_DWithin_Sphere")) {
+		// The radius of the sphere used by the haversine distance
+		geodesic_radius = 6371000.0;
+	} else if (StringUtil::CIEquals(func.function.name, "ST_DWithin_Spheroid")) {
+		// The smallest radius of curvature of the WGS84 ellipsoid, b^2/a = a * (1 - f)^2. The meridional and prime
+		// vertical radii of curvature are never smaller, so no curve between two points in geodetic coordinates is
+		// shorter on the ellipsoid than on a sphere of this radius, and neither is the geodesic.
+		constexpr auto WGS84_A = 6378137.0;
+		constexpr auto WGS84_F = 1 / 298.257223563;
+		geodesic_radius = WGS84_A * (1 - WGS84_F) * (1 - WGS84_F);
+	}
+
 	// Only simple join types are supported
 	D_ASSERT(join_type == JoinType::INNER || join_type == JoinType::LEFT || join_type == JoinType::OUTER ||
-	         join_type == JoinType::RIGHT);
+	         join_type == JoinType::RIGHT || IsExistenceJoin(join_type));
+	D_ASSERT(!self_join || join_type == JoinType::INNER);
+	D_ASSERT(!self_join || geodesic_radius == 0);
 
 	// Always make sure we have a consistent order of the output columns, regardless if we have projection maps or not
 
-	const auto &lop = op.Cast<LogicalJoin>();
-
 	// Probe-side
-	const auto &probe_side_input_types = children[0].get().types;
+	const auto probe_side_input_count = lop.children[0]->types.size();
 	probe_side_output_columns = lop.left_projection_map;
 	if (probe_side_output_columns.empty()) {
-		probe_side_output_columns.reserve(probe_side_input_types.size());
-		for (idx_t i = 0; i < probe_side_input_types.size(); i++) {
+		probe_side_output_columns.reserve(probe_side_input_count);
+		for (idx_t i = 0; i < probe_side_input_count; i++) {
 			probe_side_output_columns.emplace_back(i);
 		}
 	}
 
 	for (const auto &probe_col_idx : probe_side_output_columns) {
-		const auto type = probe_side_input_types[probe_col_idx];
-		probe_side_output_types.push_back(type);
+		const auto input_col_idx = self_join ? lop.self_join_column_map[probe_col_idx] : probe_col_idx;
+		probe_side_output_types.push_back(left.types[input_col_idx]);
 	}
 
 	// The build side is slightly different.
 	// Here we reorder the layout so that join keys are first, and the payload columns.
-	// For right outer, the match column is added at the end
+	// For right outer joins, the matched build side rows are tracked separately in a bitmap, see FoundMatchBitmap
 
 	unordered_map<idx_t, idx_t> conditions_in_layout;
 	// TODO: Loop over multiple conds
@@ -378,52 +342,58 @@ PhysicalSpatialJoin::PhysicalSpatialJoin(LogicalOperator &op, PhysicalOperator &
 	// TODO Add rest too
 	build_side_key_types.push_back(build_side_key->return_type);
 
-	const auto &build_side_input_types = children[1].get().types;
+	const auto &build_side_input_types = right.types;
 	auto right_projection_map_copy = lop.right_projection_map;
-	if (right_projection_map_copy.empty()) {
+	if (IsExistenceJoin(join_type)) {
+		// Existence joins do not output any build side columns, we only need the key
+		right_projection_map_copy.clear();
+	} else if (right_projection_map_copy.empty()) {
 		right_projection_map_copy.reserve(build_side_input_types.size());
 		for (idx_t i = 0; i < build_side_input_types.size(); i++) {
 			right_projection_map_copy.emplace_back(i);
 		}
 	}
 
-	for (auto &rhs_col : right_projection_map_copy) {
-		auto &rhs_type = build_side_input_types[rhs_col];
-
-		auto it = conditions_in_layout.find(rhs_col);
-		if (it == conditions_in_layout.end()) {
-			// This column is not a condition, but we want to include it in the output.
-			// And thus need to add it to the layout
-			build_side_output_columns.push_back(build_side_key_types.size() + build_side_payload_types.size());
-			build_side_payload_types.push_back(rhs_type);
-			build_side_payload_columns.push_back(rhs_col);
-		} else {
+	const auto get_layout_column = [&](idx_t rhs_col) -> column_t {
+		const auto it = conditions_in_layout.find(rhs_col);
+		if (it != conditions_in_layout.end()) {
 			// This condition is part of the layout already, so just project it out
 			// (conditions are added to the layout separately below)
-			build_side_output_columns.push_back(it->second);
+			return it->second;
+		}
+		const auto payload_it =
+		    std::find(build_side_payload_columns.begin(), build_side_payload_columns.end(), rhs_col);
+		if (payload_it != build_side_payload_columns.end()) {
+			return build_side_key_types.size() + NumericCast<idx_t>(payload_it - build_side_payload_columns.begin());
+		}
+		// This column is not a condition, but we want to include it in the output.
+		// And thus need to add it to the layout
+		build_side_payload_types.push_back(build_side_input_types[rhs_col]);
+		build_side_payload_columns.push_back(rhs_col);
+		return build_side_key_types.size() + build_side_payload_types.size() - 1;
+	};
+
+	for (auto &rhs_col : right_projection_map_copy) {
+		build_side_output_columns.push_back(get_layout_column(rhs_col));
+		build_side_output_types.push_back(build_side_input_types[rhs_col]);
+	}
+
+	if (self_join) {
+		// The probe side output columns are gathered from the build side rows as well
+		for (const auto &probe_col_idx : probe_side_output_columns) {
+			self_join_probe_columns.push_back(get_layout_column(lop.self_join_column_map[probe_col_idx]));
 		}
-		build_side_output_types.push_back(rhs_type);
 	}
 
 	vector<LogicalType> layout_types;
 	// Insert all condition types
 	layout_types.insert(layout_types.end(), build_side_key_types.begin(), build_side_key_types.end());
 	layout_types.insert(layout_types.end(), build_side_payload_types.begin(), build_side_payload_types.end());
-	if (PropagatesBuildSide(join_type)) {
-		// Add it to the ned
-		layout_types.push_back(LogicalType::BOOLEAN);
-	}
 
 	// Initialize the layout
 	// TODO: Align?
 	layout = make_shared_ptr<TupleDataLayout>();
 	layout->Initialize(std::move(layout_types), false);
-
-	// For right/outer joins, this is where the build side match column goes
-	if (PropagatesBuildSide(join_type)) {
-		const auto &offsets = layout->GetOffsets();
-		build_side_match_offset = offsets[build_side_key_types.size() + build_side_payload_types.size()];
-	}
 }
 
 InsertionOrderPreservingMap<string> PhysicalSpatialJoin::ParamsToString() const {
@@ -431,6 +401,12 @@ InsertionOrderPreservingMap<string> PhysicalSpatialJoin::ParamsToString() const
 	auto result = PhysicalOperator::ParamsToString();
 	result["Join Type"] = EnumUtil::ToString(join_type);
 	result["Conditions"] = condition->GetName();
+	if (algorithm == SpatialJoinAlgorithm::GRID) {
+		result["Algorithm"] = "GRID";
+	}
+	if (self_join) {
+		result["Self Join"] = "true";
+	}
 	SetEstimatedCardinality(result, estimated_cardinality);
 	return result;
 }
@@ -439,18 +415,67 @@ string PhysicalSpatialJoin::GetName() const {
 	return "SPATIAL_JOIN";
 }
 
+vector<const_reference<PhysicalOperator>> PhysicalSpatialJoin::GetSources() const {
+	if (self_join) {
+		return PhysicalOperator::GetSources();
+	}
+	return PhysicalJoin::GetSources();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 // Sink Interface
 //----------------------------------------------------------------------------------------------------------------------
+// A spatial partition of the build side, only used when the build side does not fit in memory
+struct SpatialJoinPartition {
+	// The bounds of all the build side rows in this partition
+	Box2D<float> bounds;
+	// The number of non-null and non-empty geometries in this partition
+	idx_t rtree_size = 0;
+	// The build side rows of this partition
+	unique_ptr<TupleDataCollection> build;
+	// The probe side rows that intersect this partition, spilled while probing the first partition
+	unique_ptr<TupleDataCollection> probe;
+};
+
 class SpatialJoinGlobalState final : public GlobalSinkState {
 public:
 	unique_ptr<TupleDataCollection> collection;
 
-	// The number of non-null and non-empty geometries on the build side
+	// The number of non-null and non-empty geometries on the build side (or in the first partition, if partitioned)
 	idx_t total_rtree_size = 0;
 
+	// The number of non-null and non-empty geometries on the whole build side, for profiling
+	idx_t build_count = 0;
+
+	// The time spent partitioning the build side and building the rtree serially, and the size of the rtree,
+	// for profiling
+	double build_time = 0;
+	idx_t rtree_memory = 0;
+
 	// This is initialized in the finalize state
 	unique_ptr<FlatRTree> rtree = nullptr;
+
+	// Only used when the rtree is built in parallel
+	unique_ptr<FlatRTreeParallelBuildState> build_state = nullptr;
+
+	// Only used when the build side is partitioned. The first partition is kept in the collection above.
+	vector<SpatialJoinPartition> partitions;
+
+	// Only used for right/outer joins, the build side rows that are not in the rtree (null or empty geometries)
+	vector<data_ptr_t> unindexed_rows;
+
+	// If set, the build side is not sunk at all, and this cached build side of an earlier query is probed instead
+	shared_ptr<SpatialJoinBuild> cached_build;
+
+	// The total time spent building the rtree, including the parallel build phases (if any)
+	double GetBuildTime() const {
+		return build_time + (build_state ? build_state->GetBuildTime() : 0);
+	}
+
+	// The number of tasks the rtree was built with, 1 if it was built serially
+	idx_t GetBuildTaskCount() const {
+		return build_state ? build_state->GetTaskCount() : 1;
+	}
 };
 
 unique_ptr<GlobalSinkState> PhysicalSpatialJoin::GetGlobalSinkState(ClientContext &context) const {
@@ -461,11 +486,33 @@ unique_ptr<GlobalSinkState> PhysicalSpatialJoin::GetGlobalSinkState(ClientContex
 	return std::move(gstate);
 }
 
+void PhysicalSpatialJoin::BuildPipelines(Pipeline &current, MetaPipeline &meta_pipeline) {
+	if (self_join) {
+		// We only have the build side child, and emit the join result as a source
+		PhysicalOperator::BuildPipelines(current, meta_pipeline);
+		return;
+	}
+	if (build_cache_table) {
+		auto &context = meta_pipeline.GetExecutor().context;
+		auto cached_build = SpatialJoinBuildCache::Get(context)->Lookup(context, *build_cache_table, build_cache_key,
+		                                                                build_cache_version);
+		if (cached_build) {
+			// Probe the build side of an earlier query, the build side child is not executed at all
+			PhysicalJoin::BuildJoinPipelines(current, meta_pipeline, *this, false);
+			auto gstate = make_uniq<SpatialJoinGlobalState>();
+			gstate->cached_build = std::move(cached_build);
+			sink_state = std::move(gstate);
+			return;
+		}
+	}
+	PhysicalJoin::BuildPipelines(current, meta_pipeline);
+}
+
 class SpatialJoinLocalState final : public LocalSinkState {
 public:
 	SpatialJoinLocalState(const PhysicalSpatialJoin &op, ClientContext &context,
 	                      const shared_ptr<TupleDataLayout> &layout)
-	    : build_side_key_executor(context), build_side_filter_executor(context) {
+	    : build_side_key_executor(context) {
 		// Dont keep the tuples in memory after appending.
 		collection = make_uniq<TupleDataCollection>(BufferManager::GetBufferManager(context), layout);
 		collection->InitializeAppend(append_state, TupleDataPinProperties::UNPIN_AFTER_DONE);
@@ -477,31 +524,6 @@ public:
 		build_side_row_chunk.InitializeEmpty(layout->GetTypes());
 
 		build_side_payload_chunk.InitializeEmpty(op.build_side_payload_types);
-
-		auto &catalog = Catalog::GetSystemCatalog(context);
-		auto &entry = catalog.GetEntry<ScalarFunctionCatalogEntry>(context, DEFAULT_SCHEMA, "ST_IsEmpty");
-		auto func = entry.functions.GetFunctionByArguments(context, {GeoTypes::GEOMETRY()});
-
-		auto is_empty_expr = make_uniq<BoundFunctionExpression>(LogicalTypeId::BOOLEAN, func,
-		                                                        vector<unique_ptr<Expression>> {}, nullptr);
-		is_empty_expr->children.push_back(
-		    make_uniq_base<Expression, BoundReferenceExpression>(GeoTypes::GEOMETRY(), 0));
-
-		auto is_not_empty_expr =
-		    make_uniq<BoundOperatorExpression>(ExpressionType::OPERATOR_NOT, LogicalTypeId::BOOLEAN);
-		is_not_empty_expr->children.push_back(std::move(is_empty_expr));
-
-		auto is_not_null_expr =
-		    make_uniq<BoundOperatorExpression>(ExpressionType::OPERATOR_IS_NOT_NULL, LogicalTypeId::BOOLEAN);
-		is_not_null_expr->children.push_back(
-		    make_uniq_base<Expression, BoundReferenceExpression>(GeoTypes::GEOMETRY(), 0));
-
-		auto filter_expr = make_uniq_base<Expression, BoundConjunctionExpression>(
-		    ExpressionType::CONJUNCTION_AND, std::move(is_not_empty_expr), std::move(is_not_null_expr));
-
-		build_side_filter_expr = std::move(filter_expr);
-		build_side_filter_executor.AddExpression(*build_side_filter_expr);
-		build_side_filter_sel.Initialize(STANDARD_VECTOR_SIZE);
 	}
 
 	TupleDataAppendState append_state;
@@ -515,12 +537,7 @@ public:
 	// Used to execute the build side join key expression
 	ExpressionExecutor build_side_key_executor;
 
-	// Used to count how many non-null and non-empty geometries we have on the build side
-	// (so we can initialize the rtree to the correct size)
-	unique_ptr<Expression> build_side_filter_expr;
-	ExpressionExecutor build_side_filter_executor;
-	SelectionVector build_side_filter_sel; // not used, but needed for the executor
-
+	// The number of build side keys with bounds, so we can initialize the rtree to the correct size
 	idx_t build_side_non_null_non_empty_count = 0;
 };
 
@@ -537,9 +554,14 @@ SinkResultType PhysicalSpatialJoin::Sink(ExecutionContext &context, DataChunk &c
 	lstate.build_side_key_chunk.Reset();
 	lstate.build_side_key_executor.Execute(chunk, lstate.build_side_key_chunk);
 
-	// Count how many non-null and non-empty geometries we have on the build side
-	lstate.build_side_non_null_non_empty_count +=
-	    lstate.build_side_filter_executor.SelectExpression(lstate.build_side_key_chunk, lstate.build_side_filter_sel);
+	// Count how many keys with bounds (non-null and non-empty) we have on the build side
+	const SpatialKeyReader key_reader(build_side_key_types[0], lstate.build_side_key_chunk.data[0], chunk.size());
+	for (idx_t row_idx = 0; row_idx < chunk.size(); row_idx++) {
+		Box2D<float> bbox;
+		if (key_reader.TryGetBounds(row_idx, bbox)) {
+			lstate.build_side_non_null_non_empty_count++;
+		}
+	}
 
 	if (build_side_payload_types.empty()) {
 		// There are only keys. Make the payload chunk empty
@@ -548,7 +570,7 @@ SinkResultType PhysicalSpatialJoin::Sink(ExecutionContext &context, DataChunk &c
 		lstate.build_side_payload_chunk.ReferenceColumns(chunk, build_side_payload_columns);
 	}
 
-	// Now reference the key chunk, the payload chunk, and the build side match column (if needed)
+	// Now reference the key chunk and the payload chunk
 	idx_t layout_col_idx = 0;
 	for (auto &key_col : lstate.build_side_key_chunk.data) {
 		lstate.build_side_row_chunk.data[layout_col_idx++].Reference(key_col);
@@ -558,10 +580,6 @@ SinkResultType PhysicalSpatialJoin::Sink(ExecutionContext &context, DataChunk &c
 		lstate.build_side_row_chunk.data[layout_col_idx++].Reference(payload_col);
 	}
 
-	if (PropagatesBuildSide(join_type)) {
-		lstate.build_side_row_chunk.data[layout_col_idx++].Reference(Value::BOOLEAN(false));
-	}
-
 	// Set the cardinality to match the input
 	lstate.build_side_row_chunk.SetCardinality(chunk.size());
 
@@ -587,62 +605,323 @@ SinkCombineResultType PhysicalSpatialJoin::Combine(ExecutionContext &context, Op
 	return SinkCombineResultType::FINISHED;
 }
 
-// This is where we would build the rtree, by iterating through the tupledata collection we've created
-SinkFinalizeType PhysicalSpatialJoin::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
-                                               OperatorSinkFinalizeInput &input) const {
-	auto &gstate = input.global_state.Cast<SpatialJoinGlobalState>();
+//----------------------------------------------------------------------------------------------------------------------
+// Parallel RTree Construction
+//----------------------------------------------------------------------------------------------------------------------
+class SpatialJoinBuildTask final : public ExecutorTask {
+public:
+	SpatialJoinBuildTask(shared_ptr<Event> event_p, ClientContext &context, const PhysicalSpatialJoin &op,
+	                     FlatRTreeParallelBuildState &state_p, FlatRTreeBuildPhase phase_p, idx_t task_idx_p)
+	    : ExecutorTask(context, std::move(event_p), op), state(state_p), phase(phase_p), task_idx(task_idx_p) {
+	}
 
-	if (gstate.collection->Count() == 0) {
-		return EmptyResultIfRHSIsEmpty() ? SinkFinalizeType::NO_OUTPUT_POSSIBLE : SinkFinalizeType::READY;
+	TaskExecutionResult ExecuteTask(TaskExecutionMode mode) override {
+		state.Execute(phase, task_idx);
+		event->FinishTask();
+		return TaskExecutionResult::TASK_FINISHED;
 	}
 
-	// Initialize the flat R-Tree
-	static constexpr auto RTREE_NODE_SIZE = 32;
-	gstate.rtree = make_uniq<FlatRTree>(BufferAllocator::Get(context), gstate.total_rtree_size, RTREE_NODE_SIZE);
+private:
+	FlatRTreeParallelBuildState &state;
+	FlatRTreeBuildPhase phase;
+	idx_t task_idx;
+};
+
+class SpatialJoinBuildEvent final : public BasePipelineEvent {
+public:
+	SpatialJoinBuildEvent(const PhysicalSpatialJoin &op_p, FlatRTreeParallelBuildState &state_p, Pipeline &pipeline_p,
+	                      FlatRTreeBuildPhase phase_p)
+	    : BasePipelineEvent(pipeline_p), op(op_p), state(state_p), phase(phase_p) {
+	}
+
+	void Schedule() override {
+		auto &context = pipeline->GetClientContext();
+
+		vector<shared_ptr<Task>> tasks;
+		for (idx_t task_idx = 0; task_idx < state.GetTaskCount(); task_idx++) {
+			tasks.push_back(make_uniq<SpatialJoinBuildTask>(shared_from_this(), context, op, state, phase, task_idx));
+		}
+		SetTasks(std::move(tasks));
+	}
+
+	void FinishEvent() override {
+		state.Finish(phase);
+
+		// Schedule the next phase (if any)
+		switch (phase) {
+		case FlatRTreeBuildPhase::COUNT:
+			InsertEvent(make_shared_ptr<SpatialJoinBuildEvent>(op, state, *pipeline, FlatRTreeBuildPhase::SCATTER));
+			break;
+		case FlatRTreeBuildPhase::SCATTER:
+			InsertEvent(make_shared_ptr<SpatialJoinBuildEvent>(op, state, *pipeline, FlatRTreeBuildPhase::SORT));
+			break;
+		case FlatRTreeBuildPhase::SORT:
+			InsertEvent(make_shared_ptr<SpatialJoinBuildEvent>(op, state, *pipeline, FlatRTreeBuildPhase::PACK));
+			break;
+		default:
+			break;
+		}
+	}
+
+private:
+	const PhysicalSpatialJoin &op;
+	FlatRTreeParallelBuildState &state;
+	FlatRTreeBuildPhase phase;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Build Side Partitioning
+//----------------------------------------------------------------------------------------------------------------------
+// When the build side does not fit in memory, we split it into spatial partitions along the hilbert curve.
+// The first partition is joined in-memory while streaming the probe side, and the probe rows whose bounds intersect
+// any of the other partitions are spilled (replicated into each partition they intersect). Once the probe side is
+// exhausted, the remaining partitions are joined one partition pair at a time in the source phase.
+
+static uint32_t GetHilbertValue(const Box2D<float> &extent, const Box2D<float> &box) {
+	constexpr auto max_hilbert = std::numeric_limits<uint16_t>::max();
+	const auto hw = max_hilbert / (extent.max.x - extent.min.x);
+	const auto hh = max_hilbert / (extent.max.y - extent.min.y);
+	const auto hx = static_cast<uint32_t>(hw * ((box.min.x + box.max.x) / 2 - extent.min.x));
+	const auto hy = static_cast<uint32_t>(hh * ((box.min.y + box.max.y) / 2 - extent.min.y));
+	return sgl::util::hilbert_encode(16, hx, hy);
+}
+
+static idx_t GetPartitionCount(ClientContext &context, const SpatialJoinGlobalState &gstate, JoinType join_type) {
+	// Only inner joins can be partitioned (for now)
+	if (join_type != JoinType::INNER || gstate.total_rtree_size == 0) {
+		return 1;
+	}
+
+	idx_t partition_count = 0;
+	Value partitions_value;
+	if (context.TryGetCurrentSetting("spatial_join_partitions", partitions_value)) {
+		partition_count = partitions_value.GetValue<idx_t>();
+	}
+
+	if (partition_count == 0) {
+		// Pick the number of partitions automatically.
+		// The remaining partitions are joined concurrently, so each one should fit within its share of the budget.
+		const auto thread_count = NumericCast<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads());
+		const auto memory_budget = BufferManager::GetBufferManager(context).GetMaxMemory() / 2;
+		const auto build_size = gstate.collection->SizeInBytes();
+
+		if (build_size <= memory_budget) {
+			return 1;
+		}
+		const auto partition_budget = MaxValue<idx_t>(memory_budget / thread_count, 1);
+		partition_count = (build_size + partition_budget - 1) / partition_budget;
+	}
+
+	return MinValue(partition_count, gstate.total_rtree_size);
+}
+
+static void PartitionBuildSide(ClientContext &context, const PhysicalSpatialJoin &op, SpatialJoinGlobalState &gstate,
+                               idx_t partition_count) {
+	auto &collection = *gstate.collection;
+	auto &buffer_manager = BufferManager::GetBufferManager(context);
+
+	// How many samples we take per partition when computing the partition splitters
+	static constexpr idx_t SAMPLES_PER_PARTITION = 64;
+	const auto sample_step = MaxValue<idx_t>(gstate.total_rtree_size / (partition_count * SAMPLES_PER_PARTITION), 1);
+
+	// First pass: compute the extent of the build side, and sample the bounding boxes
+	Box2D<float> extent;
+	vector<Box2D<float>> samples;
+	{
+		TupleDataScanState scan_state;
+		collection.InitializeScan(scan_state, vector<column_t> {0}, TupleDataPinProperties::UNPIN_AFTER_DONE);
+		DataChunk key_chunk;
+		collection.InitializeScanChunk(scan_state, key_chunk);
+
+		idx_t valid_idx = 0;
+		while (collection.Scan(scan_state, key_chunk)) {
+			const SpatialKeyReader key_reader(op.build_side_key_types[0], key_chunk.data[0], key_chunk.size());
+			for (idx_t row_idx = 0; row_idx < key_chunk.size(); row_idx++) {
+				Box2D<float> bbox;
+				if (!key_reader.TryGetBounds(row_idx, bbox)) {
+					continue;
+				}
+				extent.Union(bbox);
+				if (valid_idx++ % sample_step == 0) {
+					samples.push_back(bbox);
+				}
+			}
+		}
+	}
+
+	// Pick the partition splitters from the sorted sample curve values
+	vector<uint32_t> sample_curve;
+	sample_curve.reserve(samples.size());
+	for (const auto &sample : samples) {
+		sample_curve.push_back(GetHilbertValue(extent, sample));
+	}
+	std::sort(sample_curve.begin(), sample_curve.end());
+
+	vector<uint32_t> splitters;
+	for (idx_t i = 1; i < partition_count; i++) {
+		splitters.push_back(sample_curve[i * sample_curve.size() / partition_count]);
+	}
+
+	// Initialize the partitions
+	vector<TupleDataAppendState> append_states(partition_count);
+	gstate.partitions.resize(partition_count);
+	for (idx_t i = 0; i < partition_count; i++) {
+		auto &partition = gstate.partitions[i];
+		partition.build = make_uniq<TupleDataCollection>(buffer_manager, op.layout);
+		partition.build->InitializeAppend(append_states[i], TupleDataPinProperties::UNPIN_AFTER_DONE);
+	}
+
+	// Second pass: scatter the rows into the partitions. We dont need the original rows afterwards.
+	// Null and empty geometries can never match in an inner join, so we drop them here.
+	TupleDataScanState scan_state;
+	collection.InitializeScan(scan_state, TupleDataPinProperties::DESTROY_AFTER_DONE);
+	DataChunk row_chunk;
+	collection.InitializeScanChunk(scan_state, row_chunk);
+
+	vector<SelectionVector> partition_sel(partition_count);
+	vector<idx_t> partition_sel_count(partition_count);
+	for (auto &sel : partition_sel) {
+		sel.Initialize(STANDARD_VECTOR_SIZE);
+	}
+
+	while (collection.Scan(scan_state, row_chunk)) {
+		std::fill(partition_sel_count.begin(), partition_sel_count.end(), 0);
+
+		const SpatialKeyReader key_reader(op.build_side_key_types[0], row_chunk.data[0], row_chunk.size());
+		for (idx_t row_idx = 0; row_idx < row_chunk.size(); row_idx++) {
+			Box2D<float> bbox;
+			if (!key_reader.TryGetBounds(row_idx, bbox)) {
+				continue;
+			}
+			const auto curve = GetHilbertValue(extent, bbox);
+			const auto partition_idx = NumericCast<idx_t>(std::upper_bound(splitters.begin(), splitters.end(), curve) -
+			                                              splitters.begin());
+
+			auto &partition = gstate.partitions[partition_idx];
+			partition.bounds.Union(bbox);
+			partition.rtree_size++;
+
+			partition_sel[partition_idx].set_index(partition_sel_count[partition_idx]++, row_idx);
+		}
+
+		for (idx_t i = 0; i < partition_count; i++) {
+			if (partition_sel_count[i] != 0) {
+				gstate.partitions[i].build->Append(append_states[i], row_chunk, partition_sel[i],
+				                                   partition_sel_count[i]);
+			}
+		}
+	}
+
+	for (idx_t i = 0; i < partition_count; i++) {
+		gstate.partitions[i].build->FinalizePinState(append_states[i].pin_state);
+	}
+
+	// The first partition is the one we join in-memory while probing
+	gstate.collection = std::move(gstate.partitions[0].build);
+	gstate.total_rtree_size = gstate.partitions[0].rtree_size;
+}
+
+// Create a flat rtree over all the rows in the collection, keeping the collection pinned so that
+// the row pointers stay valid while probing. If requested, the rows that can not be put in the rtree are collected.
+static unique_ptr<FlatRTree> CreateFlatRTree(ClientContext &context, const PhysicalSpatialJoin &op,
+                                             TupleDataCollection &collection, idx_t rtree_size,
+                                             vector<data_ptr_t> *unindexed_rows = nullptr) {
+	const auto &key_type = op.build_side_key_types[0];
+	const auto node_size = GetRTreeNodeSize(rtree_size);
+	const auto is_grid = op.algorithm == SpatialJoinAlgorithm::GRID;
+	auto rtree = make_uniq<FlatRTree>(BufferAllocator::Get(context), rtree_size, node_size, is_grid);
 
 	// Now, this is where we build the rtree, by iterating over the tuples in the collection.
 	// We need to keep everything pinned so that we can probe the pointers later
-	TupleDataChunkIterator iterator(*gstate.collection, TupleDataPinProperties::KEEP_EVERYTHING_PINNED, true);
+	TupleDataChunkIterator iterator(collection, TupleDataPinProperties::KEEP_EVERYTHING_PINNED, true);
 
 	const auto rows_ptr = iterator.GetRowLocations();
 	Vector row_pointer_vector(LogicalType::POINTER, reinterpret_cast<data_ptr_t>(rows_ptr));
 
 	auto &sel = *FlatVector::IncrementalSelectionVector();
-	Vector geom_vec(GeoTypes::GEOMETRY());
+	Vector key_vec(key_type);
 
 	do {
 		const auto row_count = iterator.GetCurrentChunkCount();
 
 		// We only need to fetch the build-side key column to build the rtree.
 		// The key column is always the first column in the layout.
-		constexpr auto build_side_key_col = 0;      // TODO: layout_key_col_idx
-		D_ASSERT(build_side_key_types.size() == 1); // TODO: remove this
+		constexpr auto build_side_key_col = 0; // TODO: layout_key_col_idx
 
-		gstate.collection->Gather(row_pointer_vector, sel, row_count, build_side_key_col, geom_vec, sel, nullptr);
+		collection.Gather(row_pointer_vector, sel, row_count, build_side_key_col, key_vec, sel, nullptr);
 
-		// Get a pointer to what we just gathered
-		const auto geom_ptr = FlatVector::GetData<geometry_t>(geom_vec);
-		// Push the bounding boxes into the R-Tree
+		// Push the bounding boxes of what we just gathered into the R-Tree
+		const SpatialKeyReader key_reader(key_type, key_vec, row_count);
 		for (idx_t row_idx = 0; row_idx < row_count; row_idx++) {
-			if (FlatVector::IsNull(geom_vec, row_idx)) {
-				// Skip null geometries
-				continue;
-			}
-
-			const auto &geom = geom_ptr[row_idx];
 			Box2D<float> bbox;
-			if (!geom.TryGetCachedBounds(bbox)) {
-				// Skip empty geometries
+			if (!key_reader.TryGetBounds(row_idx, bbox)) {
+				// Skip null and empty keys
+				if (unindexed_rows) {
+					unindexed_rows->push_back(rows_ptr[row_idx]);
+				}
 				continue;
 			}
 
 			// Push the bounding box into the R-Tree
-			gstate.rtree->Push(bbox, rows_ptr[row_idx]);
+			rtree->Push(bbox, rows_ptr[row_idx]);
 		}
 	} while (iterator.Next());
 
-	// Build the R-Tree once we've gathered everything
-	gstate.rtree->Build();
+	return rtree;
+}
+
+// This is where we would build the rtree, by iterating through the tupledata collection we've created
+SinkFinalizeType PhysicalSpatialJoin::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+                                               OperatorSinkFinalizeInput &input) const {
+	auto &gstate = input.global_state.Cast<SpatialJoinGlobalState>();
+
+	if (gstate.collection->Count() == 0) {
+		return EmptyResultIfRHSIsEmpty() ? SinkFinalizeType::NO_OUTPUT_POSSIBLE : SinkFinalizeType::READY;
+	}
+
+	D_ASSERT(build_side_key_types.size() == 1); // TODO: remove this
+
+	gstate.build_count = gstate.total_rtree_size;
+
+	Profiler timer;
+	timer.Start();
+
+	// If the build side is too large to keep in memory, split it into spatial partitions.
+	// A self join has no probe side to spill, so it is never partitioned.
+	const auto partition_count = self_join ? 1 : GetPartitionCount(context, gstate, join_type);
+	if (partition_count > 1) {
+		PartitionBuildSide(context, *this, gstate, partition_count);
+	}
+
+	// Initialize the flat R-Tree
+	gstate.rtree = CreateFlatRTree(context, *this, *gstate.collection, gstate.total_rtree_size,
+	                               PropagatesBuildSide(join_type) ? &gstate.unindexed_rows : nullptr);
+	gstate.rtree_memory = gstate.rtree->GetMemoryUsage();
+
+	// Build the R-Tree once we've gathered everything.
+	// If the build side is large enough, sort and pack the tree in parallel
+	static constexpr idx_t RTREE_PARALLEL_BUILD_MIN_ITEMS_PER_TASK = 100000;
+
+	const auto thread_count = NumericCast<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads());
+	const auto task_count = MinValue(thread_count, gstate.rtree->Count() / RTREE_PARALLEL_BUILD_MIN_ITEMS_PER_TASK);
+
+	// The grid is built in a single pass over the entries, only the tree is built in parallel
+	if (task_count <= 1 || gstate.rtree->IsGrid()) {
+		gstate.rtree->Build();
+		timer.End();
+		gstate.build_time = timer.Elapsed();
+		return SinkFinalizeType::READY;
+	}
+
+	timer.End();
+	gstate.build_time = timer.Elapsed();
+
+	gstate.build_state =
+	    make_uniq<FlatRTreeParallelBuildState>(BufferAllocator::Get(context), *gstate.rtree, task_count);
+
+	auto build_event =
+	    make_shared_ptr<SpatialJoinBuildEvent>(*this, *gstate.build_state, pipeline, FlatRTreeBuildPhase::COUNT);
+	event.InsertEvent(std::move(build_event));
 
 	return SinkFinalizeType::READY;
 }
@@ -652,7 +931,7 @@ SinkFinalizeType PhysicalSpatialJoin::Finalize(Pipeline &pipeline, Event &event,
 //----------------------------------------------------------------------------------------------------------------------
 // This is where we do the probing of the rtree.
 
-enum class SpatialJoinState { START = 0, INIT, PROBE, SCAN, EMIT, EMIT_LHS };
+enum class SpatialJoinState { START = 0, INIT, SCAN, EMIT, EMIT_LHS };
 
 class SpatialJoinLocalOperatorState final : public CachingOperatorState {
 public:
@@ -673,7 +952,7 @@ public:
 	ExpressionExecutor join_probe_executor; // used to compute the probe key
 	ExpressionExecutor join_match_executor; // used to compute the predicate
 
-	UnifiedVectorFormat probe_side_key_vformat; // used to access the probe side key, after its been computed
+	SpatialKeyReader probe_side_key_reader; // used to access the probe side key, after its been computed
 
 	unique_ptr<Expression> match_expr;
 
@@ -686,28 +965,153 @@ public:
 
 	uint8_t left_outer_marker[STANDARD_VECTOR_SIZE] = {};
 
-	idx_t build_side_match_offset = 0;
 	unsafe_unique_array<data_ptr_t> build_side_pointers = nullptr;
+	unsafe_unique_array<uint32_t> build_side_positions = nullptr;
+
+#if SPATIAL_USE_GEOS
+	// Used to evaluate the predicate with prepared build side geometries, if supported
+	unique_ptr<GeosPreparedJoinCache> prepared_cache;
+#endif
+
+	// Used to decide the common cases of the predicate natively, if supported
+	unique_ptr<SpatialJoinRefiner> refiner;
+	bool refine_matches[STANDARD_VECTOR_SIZE] = {};
+	SelectionVector undecided_sel;       // the pairs the refiner could not decide
+	SelectionVector undecided_match_sel; // the undecided pairs that match
+	DataChunk undecided_chunk;           // references the predicate arguments of the undecided pairs
+	unsafe_unique_array<data_ptr_t> undecided_pointers = nullptr;
+
+	// Only used when the build side is partitioned, the probe rows spilled for the other partitions
+	optional_ptr<SpatialJoinProbeSpill> probe_spill;
+	vector<SelectionVector> probe_spill_sel;
+	vector<idx_t> probe_spill_count;
+
+	// Profiling counters, flushed to the global operator state when done
+	idx_t probe_count = 0;     // the number of probe side rows
+	idx_t candidate_count = 0; // the number of pairs whose bounding boxes intersect
+	idx_t match_count = 0;     // the number of candidate pairs that satisfy the predicate
+	double build_time = 0;     // the time spent building the rtrees of the spilled partitions
+	double filter_time = 0;    // the time spent searching the rtree for candidate pairs
+	double refine_time = 0;    // the time spent evaluating the predicate for the candidate pairs
 
 	explicit SpatialJoinLocalOperatorState(ClientContext &context)
 	    : join_probe_executor(context), join_match_executor(context), probe_side_source_sel(STANDARD_VECTOR_SIZE),
 	      build_side_source_sel(STANDARD_VECTOR_SIZE), build_side_target_sel(STANDARD_VECTOR_SIZE),
-	      match_sel(STANDARD_VECTOR_SIZE), lhs_match_sel(STANDARD_VECTOR_SIZE) {
+	      match_sel(STANDARD_VECTOR_SIZE), lhs_match_sel(STANDARD_VECTOR_SIZE), undecided_sel(STANDARD_VECTOR_SIZE),
+	      undecided_match_sel(STANDARD_VECTOR_SIZE) {
 
 		build_side_pointers = make_unsafe_uniq_array<data_ptr_t>(STANDARD_VECTOR_SIZE);
+		build_side_positions = make_unsafe_uniq_array<uint32_t>(STANDARD_VECTOR_SIZE);
+		undecided_pointers = make_unsafe_uniq_array<data_ptr_t>(STANDARD_VECTOR_SIZE);
 	}
+
+	void Finalize(const PhysicalOperator &op, ExecutionContext &context) override;
 };
 
-class SpatialJoinGlobalOperatorState final : public GlobalOperatorState {
+// The probe side rows spilled by a single thread, one collection per build side partition
+class SpatialJoinProbeSpill {
 public:
-	unique_ptr<FlatRTree> rtree;
-	unique_ptr<TupleDataCollection> collection;
-};
+	SpatialJoinProbeSpill(ClientContext &context, const shared_ptr<TupleDataLayout> &layout, idx_t partition_count)
+	    : append_states(partition_count) {
+		for (idx_t i = 0; i < partition_count; i++) {
+			collections.push_back(make_uniq<TupleDataCollection>(BufferManager::GetBufferManager(context), layout));
+			collections.back()->InitializeAppend(append_states[i], TupleDataPinProperties::UNPIN_AFTER_DONE);
+		}
+	}
 
-unique_ptr<OperatorState> PhysicalSpatialJoin::GetOperatorState(ExecutionContext &context) const {
-	auto lstate = make_uniq<SpatialJoinLocalOperatorState>(context.client);
+	void Append(idx_t partition_idx, DataChunk &chunk, const SelectionVector &sel, idx_t count) {
+		collections[partition_idx]->Append(append_states[partition_idx], chunk, sel, count);
+	}
 
-	// Create a match expression using the condition, that will be used to filter the results
+	void FinalizeAppend() {
+		for (idx_t i = 0; i < collections.size(); i++) {
+			collections[i]->FinalizePinState(append_states[i].pin_state);
+		}
+	}
+
+	vector<unique_ptr<TupleDataCollection>> collections;
+	vector<TupleDataAppendState> append_states;
+};
+
+class SpatialJoinGlobalOperatorState final : public GlobalOperatorState {
+public:
+	// The build side may be shared with other queries through the SpatialJoinBuildCache
+	shared_ptr<FlatRTree> rtree;
+	shared_ptr<TupleDataCollection> collection;
+	bool cached_build = false;
+
+	// Only used when the build side is partitioned.
+	// The first partition is joined in-memory using the rtree and collection above.
+	vector<SpatialJoinPartition> partitions;
+
+	// The layout of the spilled probe side rows
+	shared_ptr<TupleDataLayout> probe_spill_layout;
+
+	// Only used for right/outer joins
+	unique_ptr<FoundMatchBitmap> found_match;
+	vector<data_ptr_t> unindexed_rows;
+
+	mutex spill_lock;
+	vector<unique_ptr<SpatialJoinProbeSpill>> probe_spills;
+
+	// Profiling counters, summed over all threads
+	idx_t build_count = 0;
+	idx_t build_task_count = 1;
+	idx_t rtree_memory = 0;
+	atomic<idx_t> probe_count = {0};
+	atomic<idx_t> candidate_count = {0};
+	atomic<idx_t> match_count = {0};
+	atomic<idx_t> node_count = {0};
+
+	// The timings are summed over all threads as well, guarded by the timing lock
+	mutex timing_lock;
+	double build_time = 0;
+	double filter_time = 0;
+	double refine_time = 0;
+
+	bool IsPartitioned() const {
+		return !partitions.empty();
+	}
+
+	void FlushCounters(SpatialJoinLocalOperatorState &lstate) {
+		probe_count += lstate.probe_count;
+		candidate_count += lstate.candidate_count;
+		match_count += lstate.match_count;
+		node_count += lstate.scan.node_count;
+		lstate.probe_count = 0;
+		lstate.candidate_count = 0;
+		lstate.match_count = 0;
+		lstate.scan.node_count = 0;
+
+		lock_guard<mutex> guard(timing_lock);
+		build_time += lstate.build_time;
+		filter_time += lstate.filter_time;
+		refine_time += lstate.refine_time;
+		lstate.build_time = 0;
+		lstate.filter_time = 0;
+		lstate.refine_time = 0;
+	}
+
+	SpatialJoinProbeSpill &RegisterProbeSpill(ClientContext &context) {
+		lock_guard<mutex> guard(spill_lock);
+		probe_spills.push_back(make_uniq<SpatialJoinProbeSpill>(context, probe_spill_layout, partitions.size()));
+		return *probe_spills.back();
+	}
+};
+
+void SpatialJoinLocalOperatorState::Finalize(const PhysicalOperator &op, ExecutionContext &context) {
+	// Unpin the spilled probe side rows
+	if (probe_spill) {
+		probe_spill->FinalizeAppend();
+	}
+
+	op.Cast<PhysicalSpatialJoin>().op_state->Cast<SpatialJoinGlobalOperatorState>().FlushCounters(*this);
+}
+
+unique_ptr<OperatorState> PhysicalSpatialJoin::GetOperatorState(ExecutionContext &context) const {
+	auto lstate = make_uniq<SpatialJoinLocalOperatorState>(context.client);
+
+	// Create a match expression using the condition, that will be used to filter the results
 	lstate->match_expr = condition->Copy();
 	auto &func_expr = lstate->match_expr->Cast<BoundFunctionExpression>();
 	func_expr.children[0] = make_uniq<BoundReferenceExpression>(probe_side_key->return_type, 0);
@@ -715,6 +1119,18 @@ unique_ptr<OperatorState> PhysicalSpatialJoin::GetOperatorState(ExecutionContext
 
 	lstate->join_match_executor.AddExpression(*lstate->match_expr);
 
+#if SPATIAL_USE_GEOS
+	// Build side rows are usually probed many times, so try to keep them prepared
+	if (probe_side_key->return_type == GeoTypes::GEOMETRY() && build_side_key->return_type == GeoTypes::GEOMETRY()) {
+		lstate->prepared_cache = GeosPreparedJoinCache::TryCreate(func_expr.function.name);
+	}
+#endif
+
+	// Most candidate pairs are points against polygons, or boxes against boxes, which we can decide natively
+	if (probe_side_key->return_type == GeoTypes::GEOMETRY() && build_side_key->return_type == GeoTypes::GEOMETRY()) {
+		lstate->refiner = SpatialJoinRefiner::TryCreate(BufferAllocator::Get(context.client), func_expr.function.name);
+	}
+
 	// Add the probe side join key expression
 	lstate->join_probe_executor.AddExpression(*probe_side_key);
 
@@ -723,6 +1139,7 @@ unique_ptr<OperatorState> PhysicalSpatialJoin::GetOperatorState(ExecutionContext
 	lstate->probe_side_key_chunk.Initialize(context.client, {probe_side_key->return_type});
 	lstate->build_side_key_chunk.Initialize(context.client, {build_side_key->return_type});
 	lstate->match_pred_arg_chunk.Initialize(context.client, {probe_side_key->return_type, build_side_key->return_type});
+	lstate->undecided_chunk.InitializeEmpty(lstate->match_pred_arg_chunk.GetTypes());
 
 	return std::move(lstate);
 }
@@ -731,18 +1148,401 @@ unique_ptr<GlobalOperatorState> PhysicalSpatialJoin::GetGlobalOperatorState(Clie
 	auto &gstate = sink_state->Cast<SpatialJoinGlobalState>();
 
 	auto result = make_uniq<SpatialJoinGlobalOperatorState>();
+
+	if (gstate.cached_build) {
+		const auto &build = *gstate.cached_build;
+		result->rtree = build.rtree;
+		result->collection = build.collection;
+		result->build_count = build.build_count;
+		result->rtree_memory = build.rtree_memory;
+		result->cached_build = true;
+
+		if (PropagatesBuildSide(join_type)) {
+			result->found_match = make_uniq<FoundMatchBitmap>(result->rtree->Count());
+			result->unindexed_rows = build.unindexed_rows;
+		}
+		return std::move(result);
+	}
+
 	// Steal the built rtree from the sink state.
 	result->rtree = std::move(gstate.rtree);
 	// Steal the tuple data collection
 	result->collection = std::move(gstate.collection);
+	// Steal the remaining partitions, if any
+	result->partitions = std::move(gstate.partitions);
+
+	result->build_count = gstate.build_count;
+	result->build_time = gstate.GetBuildTime();
+	result->build_task_count = gstate.GetBuildTaskCount();
+	result->rtree_memory = gstate.rtree_memory;
+
+	if (PropagatesBuildSide(join_type) && result->rtree) {
+		result->found_match = make_uniq<FoundMatchBitmap>(result->rtree->Count());
+		result->unindexed_rows = std::move(gstate.unindexed_rows);
+	}
+
+	// Keep the build side for later queries. A partitioned build side is only held in memory one partition at a time.
+	if (build_cache_version.cacheable && result->rtree && !result->IsPartitioned()) {
+		auto build = make_shared_ptr<SpatialJoinBuild>();
+		build->collection = result->collection;
+		build->rtree = result->rtree;
+		build->unindexed_rows = result->unindexed_rows;
+		build->build_count = result->build_count;
+		build->rtree_memory = result->rtree_memory;
+		SpatialJoinBuildCache::Get(context)->Insert(*build_cache_table, build_cache_key, build_cache_version,
+		                                            std::move(build));
+	}
+
+	if (result->IsPartitioned()) {
+		result->probe_spill_layout = make_shared_ptr<TupleDataLayout>();
+		result->probe_spill_layout->Initialize(children[0].get().types, false);
+	}
 
 	return std::move(result);
 }
 
-OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &context, DataChunk &input, DataChunk &chunk,
-                                                        GlobalOperatorState &gstate_p, OperatorState &lstate_p) const {
-	auto &gstate = gstate_p.Cast<SpatialJoinGlobalOperatorState>();
-	auto &lstate = lstate_p.Cast<SpatialJoinLocalOperatorState>();
+// Expand the bounds of probe side points for a geodesic distance predicate. The coordinates are (latitude, longitude)
+// in degrees, on a sphere of the given radius. Within the distance, the latitude changes by at most the angle the
+// distance spans, while the longitude changes the most at the highest latitude, and wraps around at the antimeridian.
+// So the box is repeated every turn around the earth that intersects the build side extent.
+static idx_t GetGeodesicProbeBounds(const Box2D<float> &bbox, double distance, double radius,
+                                    const Box2D<float> &extent, Box2D<float> *boxes) {
+	static constexpr auto DEG_TO_RAD = PI / 180.0;
+
+	const auto min_lat = static_cast<double>(bbox.min.x);
+	const auto max_lat = static_cast<double>(bbox.max.x);
+	const auto min_lon = static_cast<double>(bbox.min.y);
+	const auto max_lon = static_cast<double>(bbox.max.y);
+
+	// If we can not bound the distance, probe with the whole build side extent instead
+	boxes[0] = extent;
+
+	// Invalid latitudes do not lie on the sphere
+	if (!(min_lat >= -90 && max_lat <= 90 && extent.min.x >= -90 && extent.max.x <= 90)) {
+		return 1;
+	}
+
+	// The angle spanned by the distance, with some slack for the rounding errors of the distance functions
+	const auto angle = distance / radius * (1 + 1e-9) + 1e-12;
+	if (!(angle < PI / 2)) {
+		return 1;
+	}
+	const auto angle_deg = angle / DEG_TO_RAD;
+
+	Box2D<float> box;
+	box.min.x = MathUtil::DoubleToFloatDown(min_lat - angle_deg);
+	box.max.x = MathUtil::DoubleToFloatUp(max_lat + angle_deg);
+
+	// If the distance reaches over a pole, every longitude is in range
+	const auto abs_lat = MaxValue(std::abs(min_lat), std::abs(max_lat));
+	if (abs_lat + angle_deg >= 90) {
+		box.min.y = extent.min.y;
+		box.max.y = extent.max.y;
+		boxes[0] = box;
+		return 1;
+	}
+
+	const auto ratio = MinValue(std::sin(angle) / std::cos(abs_lat * DEG_TO_RAD), 1.0);
+	const auto lon_deg = std::asin(ratio) / DEG_TO_RAD * (1 + 1e-9);
+	const auto lo = min_lon - lon_deg;
+	const auto hi = max_lon + lon_deg;
+
+	// Keep the boxes of different turns well apart, so that a build side row is never matched twice
+	const auto turn_beg = std::ceil((extent.min.y - hi) / 360.0);
+	const auto turn_end = std::floor((extent.max.y - lo) / 360.0);
+	if (!(hi - lo < 180) || turn_end - turn_beg + 1 > static_cast<double>(PhysicalSpatialJoin::MAX_PROBE_BOXES)) {
+		box.min.y = extent.min.y;
+		box.max.y = extent.max.y;
+		boxes[0] = box;
+		return 1;
+	}
+
+	idx_t box_count = 0;
+	for (auto turn = turn_beg; turn <= turn_end; turn++) {
+		box.min.y = MathUtil::DoubleToFloatDown(lo + turn * 360.0);
+		box.max.y = MathUtil::DoubleToFloatUp(hi + turn * 360.0);
+		boxes[box_count++] = box;
+	}
+	return box_count;
+}
+
+// Get the boxes to probe the rtree with for a probe side key. Returns how many there are (at most
+// MAX_PROBE_BOXES), none if the key is null or empty. The boxes never overlap, so each build side row matches at most one.
+// For distance predicates the bounds are expanded by the distance, rounding outwards so that we never miss a match.
+// The extent holds the bounds of all the build side rows that are probed.
+static idx_t GetProbeBounds(const PhysicalSpatialJoin &op, const SpatialKeyReader &key_reader, idx_t row_idx,
+                            const Box2D<float> &extent, Box2D<float> *boxes) {
+	Box2D<float> bbox;
+	if (!key_reader.TryGetBounds(row_idx, bbox)) {
+		return 0;
+	}
+	if (op.geodesic_radius != 0) {
+		return GetGeodesicProbeBounds(bbox, op.probe_side_expansion, op.geodesic_radius, extent, boxes);
+	}
+	boxes[0] = ExpandBox(bbox, op.probe_side_expansion);
+	return 1;
+}
+
+static void SpillProbeChunk(ExecutionContext &context, const PhysicalSpatialJoin &op,
+                            SpatialJoinGlobalOperatorState &gstate, SpatialJoinLocalOperatorState &lstate,
+                            DataChunk &input) {
+	const auto partition_count = gstate.partitions.size();
+
+	if (!lstate.probe_spill) {
+		lstate.probe_spill = gstate.RegisterProbeSpill(context.client);
+		lstate.probe_spill_sel.resize(partition_count);
+		lstate.probe_spill_count.resize(partition_count);
+		for (auto &sel : lstate.probe_spill_sel) {
+			sel.Initialize(STANDARD_VECTOR_SIZE);
+		}
+	}
+
+	std::fill(lstate.probe_spill_count.begin(), lstate.probe_spill_count.end(), 0);
+
+	// The extent of the spilled partitions
+	Box2D<float> extent;
+	for (idx_t partition_idx = 1; partition_idx < partition_count; partition_idx++) {
+		extent.Union(gstate.partitions[partition_idx].bounds);
+	}
+
+	for (idx_t row_idx = 0; row_idx < input.size(); row_idx++) {
+		Box2D<float> boxes[PhysicalSpatialJoin::MAX_PROBE_BOXES];
+		const auto box_count = GetProbeBounds(op, lstate.probe_side_key_reader, row_idx, extent, boxes);
+
+		// Replicate the row into every partition it intersects (the first partition is probed in-memory)
+		for (idx_t partition_idx = 1; partition_idx < partition_count; partition_idx++) {
+			const auto &bounds = gstate.partitions[partition_idx].bounds;
+			for (idx_t box_idx = 0; box_idx < box_count; box_idx++) {
+				if (bounds.Intersects(boxes[box_idx])) {
+					lstate.probe_spill_sel[partition_idx].set_index(lstate.probe_spill_count[partition_idx]++,
+					                                                row_idx);
+					break;
+				}
+			}
+		}
+	}
+
+	for (idx_t partition_idx = 1; partition_idx < partition_count; partition_idx++) {
+		const auto count = lstate.probe_spill_count[partition_idx];
+		if (count != 0) {
+			lstate.probe_spill->Append(partition_idx, input, lstate.probe_spill_sel[partition_idx], count);
+		}
+	}
+}
+
+// Whether the predicate evaluation needs to know the build side row of each candidate pair
+static bool NeedsBuildSideRows(const SpatialJoinLocalOperatorState &lstate) {
+#if SPATIAL_USE_GEOS
+	if (lstate.prepared_cache) {
+		return true;
+	}
+#endif
+	return lstate.refiner != nullptr;
+}
+
+// Evaluate the full predicate for the (probe, build) pairs in the argument chunk, and select the pairs that match
+static idx_t EvaluatePredicate(SpatialJoinLocalOperatorState &lstate, DataChunk &args, const data_ptr_t *build_rows,
+                               idx_t count, SelectionVector &sel) {
+#if SPATIAL_USE_GEOS
+	if (lstate.prepared_cache) {
+		return lstate.prepared_cache->Select(args.data[0], args.data[1], build_rows, count, sel);
+	}
+#endif
+	return lstate.join_match_executor.SelectExpression(args, sel);
+}
+
+static idx_t SelectMatchesInternal(SpatialJoinLocalOperatorState &lstate, idx_t count) {
+	auto &args = lstate.match_pred_arg_chunk;
+	const auto build_rows = lstate.build_side_pointers.get();
+	if (!lstate.refiner) {
+		return EvaluatePredicate(lstate, args, build_rows, count, lstate.match_sel);
+	}
+
+	// Decide what we can natively, and only evaluate the full predicate for the remaining pairs
+	const auto matches = lstate.refine_matches;
+	const auto undecided_count =
+	    lstate.refiner->Refine(args.data[0], args.data[1], build_rows, count, matches, lstate.undecided_sel);
+
+	if (undecided_count != 0) {
+		lstate.undecided_chunk.Slice(args, lstate.undecided_sel, undecided_count);
+		for (idx_t i = 0; i < undecided_count; i++) {
+			const auto pair_idx = lstate.undecided_sel.get_index(i);
+			lstate.undecided_pointers[i] = build_rows[pair_idx];
+			matches[pair_idx] = false;
+		}
+		const auto undecided_matches = EvaluatePredicate(lstate, lstate.undecided_chunk, lstate.undecided_pointers.get(),
+		                                                 undecided_count, lstate.undecided_match_sel);
+		for (idx_t i = 0; i < undecided_matches; i++) {
+			matches[lstate.undecided_sel.get_index(lstate.undecided_match_sel.get_index(i))] = true;
+		}
+	}
+
+	idx_t result_count = 0;
+	for (idx_t i = 0; i < count; i++) {
+		if (matches[i]) {
+			lstate.match_sel.set_index(result_count++, i);
+		}
+	}
+	return result_count;
+}
+
+// Select the candidate pairs in the predicate arguments that satisfy the predicate into the match selection
+static idx_t SelectMatches(SpatialJoinLocalOperatorState &lstate, idx_t count) {
+	Profiler timer;
+	timer.Start();
+	const auto result = SelectMatchesInternal(lstate, count);
+	timer.End();
+	lstate.refine_time += timer.Elapsed();
+	return result;
+}
+
+// Fill the scan state with the next batch of candidate pairs, returns false if there are no more candidates
+static bool ScanRTree(const FlatRTree &rtree, SpatialJoinLocalOperatorState &lstate) {
+	Profiler timer;
+	timer.Start();
+	const auto result = rtree.Scan(lstate.scan);
+	timer.End();
+	lstate.filter_time += timer.Elapsed();
+	return result;
+}
+
+// Probe the rtree with the input chunk for a SEMI, ANTI or MARK join, and emit the probe side rows (with their mark).
+// These only care about whether a probe side row has a match, so we refine the candidates of all probe rows in batches,
+// and skip the remaining candidates of a probe row as soon as one of its candidates satisfies the predicate.
+static OperatorResultType ProbeRTreeExistence(const PhysicalSpatialJoin &op, DataChunk &input, DataChunk &chunk,
+                                              const FlatRTree *rtree, TupleDataCollection &collection,
+                                              SpatialJoinLocalOperatorState &lstate) {
+	const auto join_type = op.join_type;
+	const auto has_build_side = rtree != nullptr && rtree->Count() != 0;
+	if (!has_build_side && op.EmptyResultIfRHSIsEmpty()) {
+		return OperatorResultType::FINISHED;
+	}
+
+	// Reference the columns that we actually care about
+	lstate.probe_side_row_chunk.ReferenceColumns(input, op.probe_side_output_columns);
+
+	lstate.probe_count += input.size();
+
+	// The marker is set for each probe side row that has a match
+	memset(lstate.left_outer_marker, 0, sizeof(lstate.left_outer_marker));
+
+	if (has_build_side) {
+		lstate.join_probe_executor.Execute(input, lstate.probe_side_key_chunk);
+		lstate.probe_side_key_reader.Initialize(lstate.probe_side_key_chunk.data[0].GetType(),
+		                                        lstate.probe_side_key_chunk.data[0], input.size());
+
+		// Collect the bounds of all the probe side keys, and probe the rtree with all of them at once
+		const auto extent = rtree->GetBounds();
+		lstate.scan.Reset();
+		for (idx_t i = 0; i < input.size(); i++) {
+			Box2D<float> boxes[PhysicalSpatialJoin::MAX_PROBE_BOXES];
+			const auto box_count = GetProbeBounds(op, lstate.probe_side_key_reader, i, extent, boxes);
+			for (idx_t box_idx = 0; box_idx < box_count; box_idx++) {
+				lstate.scan.AddProbe(boxes[box_idx], UnsafeNumericCast<sel_t>(i));
+			}
+		}
+		rtree->InitScan(lstate.scan);
+
+		auto &target_sel = *FlatVector::IncrementalSelectionVector();
+
+		while (true) {
+			if (lstate.scan.matches_idx == lstate.scan.matches_count) {
+				// Get the next batch of candidates, if any
+				if (!ScanRTree(*rtree, lstate)) {
+					break;
+				}
+				continue;
+			}
+
+			// Collect the candidates of this batch, skipping those of probe side rows that already have a match
+			idx_t candidate_count = 0;
+			for (; lstate.scan.matches_idx < lstate.scan.matches_count; lstate.scan.matches_idx++) {
+				const auto probe_idx = lstate.scan.matches_sel.get_index(lstate.scan.matches_idx);
+				if (lstate.left_outer_marker[probe_idx]) {
+					continue;
+				}
+				lstate.build_side_source_sel.set_index(candidate_count, lstate.scan.matches_idx);
+				lstate.probe_side_source_sel.set_index(candidate_count, probe_idx);
+				candidate_count++;
+			}
+			if (candidate_count == 0) {
+				continue;
+			}
+
+			// Collect the build side join key of each candidate
+			constexpr auto build_side_key_col = 0;
+			auto &row_pointers = lstate.scan.matches;
+			collection.Gather(row_pointers, lstate.build_side_source_sel, candidate_count, build_side_key_col,
+			                  lstate.build_side_key_chunk.data[0], target_sel, nullptr);
+
+			if (NeedsBuildSideRows(lstate)) {
+				const auto ptrs = FlatVector::GetData<data_ptr_t>(row_pointers);
+				for (idx_t i = 0; i < candidate_count; i++) {
+					lstate.build_side_pointers[i] = ptrs[lstate.build_side_source_sel.get_index(i)];
+				}
+			}
+
+			// Evaluate the predicate, and mark the probe side rows that matched
+			lstate.match_pred_arg_chunk.data[0].Slice(lstate.probe_side_key_chunk.data[0], lstate.probe_side_source_sel,
+			                                          candidate_count);
+			lstate.match_pred_arg_chunk.data[1].Reference(lstate.build_side_key_chunk.data[0]);
+			lstate.match_pred_arg_chunk.SetCardinality(candidate_count);
+
+			const auto filtered = SelectMatches(lstate, candidate_count);
+
+			lstate.candidate_count += candidate_count;
+			lstate.match_count += filtered;
+
+			for (idx_t i = 0; i < filtered; i++) {
+				const auto probe_idx = lstate.probe_side_source_sel.get_index(lstate.match_sel.get_index(i));
+				lstate.left_outer_marker[probe_idx] = 1;
+			}
+		}
+	}
+
+	if (join_type == JoinType::MARK) {
+		// Emit all the probe side rows, together with whether they had a match
+		const auto probe_col_count = op.probe_side_output_columns.size();
+		for (idx_t i = 0; i < probe_col_count; i++) {
+			chunk.data[i].Reference(lstate.probe_side_row_chunk.data[i]);
+		}
+		auto &mark = chunk.data[probe_col_count];
+		mark.SetVectorType(VectorType::FLAT_VECTOR);
+		const auto mark_data = FlatVector::GetData<bool>(mark);
+		for (idx_t i = 0; i < input.size(); i++) {
+			mark_data[i] = lstate.left_outer_marker[i] != 0;
+		}
+		chunk.SetCardinality(input.size());
+		return OperatorResultType::NEED_MORE_INPUT;
+	}
+
+	// Emit the probe side rows that had a match (SEMI), or that did not have a match (ANTI)
+	const uint8_t keep_marker = join_type == JoinType::SEMI ? 1 : 0;
+	idx_t result_count = 0;
+	for (idx_t i = 0; i < input.size(); i++) {
+		if (lstate.left_outer_marker[i] == keep_marker) {
+			lstate.lhs_match_sel.set_index(result_count++, i);
+		}
+	}
+	if (result_count > 0) {
+		chunk.Slice(lstate.probe_side_row_chunk, lstate.lhs_match_sel, result_count);
+	}
+	return OperatorResultType::NEED_MORE_INPUT;
+}
+
+// Probe the rtree with the input chunk, and emit the matching rows
+static OperatorResultType ProbeRTree(const PhysicalSpatialJoin &op, DataChunk &input, DataChunk &chunk,
+                                     const FlatRTree *rtree, TupleDataCollection &collection,
+                                     SpatialJoinLocalOperatorState &lstate,
+                                     optional_ptr<FoundMatchBitmap> found_match = nullptr) {
+	const auto join_type = op.join_type;
+	const auto &probe_side_output_columns = op.probe_side_output_columns;
+	const auto &build_side_output_columns = op.build_side_output_columns;
+	const auto &build_side_output_types = op.build_side_output_types;
+
+	if (IsExistenceJoin(join_type)) {
+		return ProbeRTreeExistence(op, input, chunk, rtree, collection, lstate);
+	}
 
 	idx_t output_index = 0;
 	idx_t output_count = chunk.GetCapacity();
@@ -754,8 +1554,8 @@ OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &contex
 		//--------------------------------------------------------------------------------------------------------------
 		case SpatialJoinState::START: {
 			// Check if the build side is empty
-			if (gstate.rtree == nullptr || gstate.rtree->Count() == 0) {
-				if (EmptyResultIfRHSIsEmpty()) {
+			if (rtree == nullptr || rtree->Count() == 0) {
+				if (op.EmptyResultIfRHSIsEmpty()) {
 					return OperatorResultType::FINISHED;
 				}
 
@@ -776,51 +1576,33 @@ OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &contex
 		case SpatialJoinState::INIT: {
 			// We have a new fresh input chunk
 			lstate.join_probe_executor.Execute(input, lstate.probe_side_key_chunk);
-			lstate.probe_side_key_chunk.data[0].ToUnifiedFormat(input.size(), lstate.probe_side_key_vformat);
+			lstate.probe_side_key_reader.Initialize(lstate.probe_side_key_chunk.data[0].GetType(),
+			                                        lstate.probe_side_key_chunk.data[0], input.size());
 
 			// Reference the columns that we actually care about
 			lstate.probe_side_row_chunk.ReferenceColumns(input, probe_side_output_columns);
 
+			lstate.probe_count += input.size();
+
 			// zero miss vector
 			memset(lstate.left_outer_marker, 0, sizeof(lstate.left_outer_marker));
 
-			// Reset the input index and move on to the next state
-			lstate.input_index = 0;
-			lstate.state = SpatialJoinState::PROBE;
-
-		} // fall through
-		//--------------------------------------------------------------------------------------------------------------
-		// PROBE
-		//--------------------------------------------------------------------------------------------------------------
-		case SpatialJoinState::PROBE: {
-			if (lstate.input_index == input.size()) {
-				lstate.state = SpatialJoinState::EMIT;
-				continue;
-			}
-
-			const auto geom_idx = lstate.probe_side_key_vformat.sel->get_index(lstate.input_index);
-			if (!lstate.probe_side_key_vformat.validity.RowIsValid(geom_idx)) {
-				lstate.input_index++;
-				continue;
-			}
-
-			const auto geom_ptr = UnifiedVectorFormat::GetData<geometry_t>(lstate.probe_side_key_vformat);
-			const auto &geom = geom_ptr[geom_idx];
-
-			Box2D<float> bbox;
-			if (!geom.TryGetCachedBounds(bbox)) {
-				lstate.input_index++;
-				continue;
-			}
-
-			gstate.rtree->InitScan(lstate.scan, bbox);
-
-			if (!gstate.rtree->Scan(lstate.scan)) {
-				lstate.input_index++;
-				continue;
+			// Collect the bounds of all the probe side keys, and probe the rtree with all of them at once
+			const auto extent = rtree->GetBounds();
+			lstate.scan.Reset();
+			for (idx_t i = 0; i < input.size(); i++) {
+				Box2D<float> boxes[PhysicalSpatialJoin::MAX_PROBE_BOXES];
+				const auto box_count = GetProbeBounds(op, lstate.probe_side_key_reader, i, extent, boxes);
+				for (idx_t box_idx = 0; box_idx < box_count; box_idx++) {
+					lstate.scan.AddProbe(boxes[box_idx], UnsafeNumericCast<sel_t>(i));
+				}
 			}
+			rtree->InitScan(lstate.scan);
 
+			// Reset the input index and move on to the next state
+			lstate.input_index = 0;
 			lstate.state = SpatialJoinState::SCAN;
+
 		} // fall through
 		//--------------------------------------------------------------------------------------------------------------
 		// SCAN
@@ -828,13 +1610,13 @@ OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &contex
 		case SpatialJoinState::SCAN: {
 			const auto matches_remaining = lstate.scan.matches_count - lstate.scan.matches_idx;
 			if (matches_remaining == 0) {
-				// We are out of matches. Try to get the next probe
-				if (gstate.rtree->Scan(lstate.scan)) {
+				// We are out of matches. Try to get the next batch
+				if (ScanRTree(*rtree, lstate)) {
 					continue;
 				}
-				// Otherwise, we are done with this probe
-				lstate.input_index++;
-				lstate.state = SpatialJoinState::PROBE;
+				// Otherwise, we are done with this input chunk
+				lstate.input_index = input.size();
+				lstate.state = SpatialJoinState::EMIT;
 				continue;
 			}
 
@@ -849,11 +1631,12 @@ OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &contex
 				lstate.build_side_source_sel.set_index(i, lstate.scan.matches_idx + i);
 
 				// This stores which probe side row we used to gather the build side
-				lstate.probe_side_source_sel.set_index(output_index + i, lstate.input_index);
+				lstate.probe_side_source_sel.set_index(output_index + i,
+				                                       lstate.scan.matches_sel.get_index(lstate.scan.matches_idx + i));
 			}
 
 			// Fetch each column from the build side
-			D_ASSERT(build_side_key_types.size() == 1);
+			D_ASSERT(op.build_side_key_types.size() == 1);
 			// TODO: Add more key conditions here
 			constexpr auto build_side_key_col = 0;
 
@@ -861,7 +1644,7 @@ OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &contex
 
 			// Collect the build side join key(s)
 			// TODO: Multiple join keys
-			gstate.collection->Gather(row_pointers, lstate.build_side_source_sel, scan_count, build_side_key_col,
+			collection.Gather(row_pointers, lstate.build_side_source_sel, scan_count, build_side_key_col,
 			                          lstate.build_side_key_chunk.data[0], lstate.build_side_target_sel, nullptr);
 
 			// Now, lets collect the rest of the build side columns
@@ -871,15 +1654,23 @@ OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &contex
 				D_ASSERT(target.GetType() == build_side_output_types[i]);
 
 				// TODO: We should use cached cast vectors here to improve performance of nested array payloads
-				gstate.collection->Gather(row_pointers, lstate.build_side_source_sel, scan_count, build_side_col_idx,
+				collection.Gather(row_pointers, lstate.build_side_source_sel, scan_count, build_side_col_idx,
 				                          target, lstate.build_side_target_sel, nullptr);
 			}
 
-			// Also collect the build side row pointers (if we have a match column)
-			if (IsRightOuterJoin(join_type)) {
+			// Also collect the build side row pointers (if we refine or cache prepared geometries per build row)
+			if (NeedsBuildSideRows(lstate)) {
 				const auto ptrs = FlatVector::GetData<data_ptr_t>(row_pointers);
 				for (idx_t i = 0; i < scan_count; i++) {
-					lstate.build_side_pointers[output_index + i] = ptrs[i];
+					lstate.build_side_pointers[output_index + i] = ptrs[lstate.scan.matches_idx + i];
+				}
+			}
+
+			// And their positions in the rtree, so we can mark them as matched
+			if (found_match) {
+				const auto positions = lstate.scan.matches_pos + lstate.scan.matches_idx;
+				for (idx_t i = 0; i < scan_count; i++) {
+					lstate.build_side_positions[output_index + i] = positions[i];
 				}
 			}
 
@@ -908,8 +1699,10 @@ OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &contex
 			lstate.match_pred_arg_chunk.data[1].Reference(lstate.build_side_key_chunk.data[0]);
 			lstate.match_pred_arg_chunk.SetCardinality(output_index);
 
-			const auto filtered =
-			    lstate.join_match_executor.SelectExpression(lstate.match_pred_arg_chunk, lstate.match_sel);
+			const auto filtered = SelectMatches(lstate, output_index);
+
+			lstate.candidate_count += output_index;
+			lstate.match_count += filtered;
 
 			if (IsLeftOuterJoin(join_type)) {
 				for (idx_t i = 0; i < filtered; i++) {
@@ -922,18 +1715,12 @@ OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &contex
 				}
 			}
 
-			if (IsRightOuterJoin(join_type)) {
+			if (found_match) {
 				// Mark each row in the build side as being matched.
 				// We need to do this so we dont emit them again in the right-outer join phase
-
-				// This is where the bool match offset is
-				const auto tuple_size = build_side_match_offset;
-
 				for (idx_t i = 0; i < filtered; i++) {
 					const auto match_source_idx = lstate.match_sel.get_index(i);
-					const auto data_ptr = lstate.build_side_pointers[match_source_idx] + tuple_size;
-					// Set the match column to true
-					Store<bool>(true, data_ptr);
+					found_match->Set(lstate.build_side_positions[match_source_idx]);
 				}
 			}
 
@@ -991,127 +1778,432 @@ OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &contex
 	}
 }
 
+OperatorResultType PhysicalSpatialJoin::ExecuteInternal(ExecutionContext &context, DataChunk &input, DataChunk &chunk,
+                                                        GlobalOperatorState &gstate_p, OperatorState &lstate_p) const {
+	auto &gstate = gstate_p.Cast<SpatialJoinGlobalOperatorState>();
+	auto &lstate = lstate_p.Cast<SpatialJoinLocalOperatorState>();
+
+	const auto is_new_input = lstate.state == SpatialJoinState::START || lstate.state == SpatialJoinState::INIT;
+	if (gstate.IsPartitioned() && is_new_input) {
+		// Spill the rows that need to be joined with the other partitions later
+		lstate.join_probe_executor.Execute(input, lstate.probe_side_key_chunk);
+		lstate.probe_side_key_reader.Initialize(lstate.probe_side_key_chunk.data[0].GetType(),
+		                                        lstate.probe_side_key_chunk.data[0], input.size());
+		SpillProbeChunk(context, *this, gstate, lstate, input);
+
+		if (gstate.rtree->Count() == 0) {
+			// The first partition is empty, but we must not finish early as we need to spill the rest of the input
+			return OperatorResultType::NEED_MORE_INPUT;
+		}
+	}
+
+	return ProbeRTree(*this, input, chunk, gstate.rtree.get(), *gstate.collection, lstate, gstate.found_match.get());
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 // Source Interface
 //----------------------------------------------------------------------------------------------------------------------
 class SpatialJoinGlobalSourceState final : public GlobalSourceState {
 public:
-	explicit SpatialJoinGlobalSourceState(const PhysicalSpatialJoin &op) : op(op) {
+	SpatialJoinGlobalSourceState(ClientContext &context, const PhysicalSpatialJoin &op) : op(op) {
 		D_ASSERT(op.sink_state);
-		const auto &state = op.op_state->Cast<SpatialJoinGlobalOperatorState>();
 
-		// Initialize a parallel scan
-		vector<column_t> column_ids;
+		if (op.self_join) {
+			// Split the self join of the rtree into enough pairs of nodes to keep all threads busy
+			const auto &sink = op.sink_state->Cast<SpatialJoinGlobalState>();
+			if (sink.rtree) {
+				const auto thread_count = NumericCast<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads());
+				self_join_tasks =
+				    sink.rtree->GetSelfJoinTasks(thread_count * SELF_JOIN_TASKS_PER_THREAD, op.probe_side_expansion);
+			}
+			tuples_maximum = self_join_tasks.size();
+			return;
+		}
 
-		column_ids.insert(column_ids.end(), op.build_side_output_columns.begin(), op.build_side_output_columns.end());
+		const auto &state = op.op_state->Cast<SpatialJoinGlobalOperatorState>();
 
-		// Also add the match column
-		column_ids.push_back(op.build_side_key_types.size() + op.build_side_payload_types.size());
+		if (state.IsPartitioned()) {
+			// We join the remaining partitions, the first partition has already been joined while probing
+			tuples_maximum = state.partitions.size() - 1;
+			return;
+		}
 
-		// We dont need to keep the tuples aroun after scanning
-		state.collection->InitializeScan(scan_state, std::move(column_ids), TupleDataPinProperties::DESTROY_AFTER_DONE);
+		if (!PropagatesBuildSide(op.join_type) || !state.rtree) {
+			// Nothing to emit
+			return;
+		}
 
-		tuples_maximum = state.collection->Count();
+		// We emit the unmatched build side rows by scanning the rtree entries, followed by the rows not in the rtree
+		tuples_maximum = state.rtree->Count() + state.unindexed_rows.size();
 	}
 
 	const PhysicalSpatialJoin &op;
-	TupleDataParallelScanState scan_state;
 
-	// How many tuples we have scanned so far
+	// The next build side row to scan, the rtree entries are scanned in insertion order, followed by the unindexed rows
+	atomic<idx_t> next_position = {0};
+
+	// How many tuples (or partitions, if partitioned, or pairs of nodes, for a self join) we have scanned so far
 	idx_t tuples_maximum = 0;
 	atomic<idx_t> tuples_scanned = {0};
 
+	// Only used when the build side is partitioned, to hand out the other partitions to the source threads
+	mutex partition_lock;
+	bool partitions_prepared = false;
+	atomic<idx_t> next_partition = {1};
+
+	// Only used for self joins, the pairs of rtree nodes to join, and the profiling counters summed over all threads
+	static constexpr idx_t SELF_JOIN_TASKS_PER_THREAD = 16;
+	vector<FlatRTreeNodePair> self_join_tasks;
+	atomic<idx_t> next_task = {0};
+	atomic<idx_t> candidate_count = {0};
+	atomic<idx_t> match_count = {0};
+	atomic<idx_t> node_count = {0};
+	mutex timing_lock;
+	double filter_time = 0;
+	double refine_time = 0;
+
 public:
 	idx_t MaxThreads() override {
+		if (op.self_join) {
+			return MaxValue<idx_t>(self_join_tasks.size(), 1);
+		}
+
 		const auto &state = op.op_state->Cast<SpatialJoinGlobalOperatorState>();
-		const auto count = state.collection->Count();
+
+		if (state.IsPartitioned()) {
+			// Each thread joins a separate partition
+			return state.partitions.size() - 1;
+		}
+
+		if (!PropagatesBuildSide(op.join_type)) {
+			return 1;
+		}
 
 		// Rough approximation of the number of threads to use
-		return count / (STANDARD_VECTOR_SIZE * 10ULL);
+		return MaxValue<idx_t>(tuples_maximum / (STANDARD_VECTOR_SIZE * 10ULL), 1);
+	}
+
+	// Combine the probe side rows spilled by each thread into a single collection per partition
+	void PreparePartitions(SpatialJoinGlobalOperatorState &state) {
+		lock_guard<mutex> guard(partition_lock);
+		if (partitions_prepared) {
+			return;
+		}
+		for (auto &spill : state.probe_spills) {
+			for (idx_t partition_idx = 1; partition_idx < state.partitions.size(); partition_idx++) {
+				auto &partition = state.partitions[partition_idx];
+				auto &spilled = spill->collections[partition_idx];
+				if (!partition.probe) {
+					partition.probe = std::move(spilled);
+				} else {
+					partition.probe->Combine(*spilled);
+				}
+			}
+		}
+		state.probe_spills.clear();
+		partitions_prepared = true;
 	}
 };
 
 class SpatialJoinLocalSourceState final : public LocalSourceState {
 public:
-	explicit SpatialJoinLocalSourceState(const PhysicalSpatialJoin &op) : match_sel(STANDARD_VECTOR_SIZE) {
+	explicit SpatialJoinLocalSourceState(const PhysicalSpatialJoin &op, ExecutionContext &context) {
 
 		D_ASSERT(op.sink_state);
-		const auto &state = op.op_state->Cast<SpatialJoinGlobalOperatorState>();
 
-		vector<column_t> column_ids;
+		if (op.self_join) {
+			// We evaluate the predicate using the same state as the regular probe
+			probe_state = op.GetOperatorState(context);
+			self_join_scan.expansion = op.probe_side_expansion;
+			self_join_lhs_rows = make_unsafe_uniq_array<data_ptr_t>(STANDARD_VECTOR_SIZE);
+			result_lhs_rows = make_unsafe_uniq_array<data_ptr_t>(STANDARD_VECTOR_SIZE);
+			result_rhs_rows = make_unsafe_uniq_array<data_ptr_t>(STANDARD_VECTOR_SIZE);
+			return;
+		}
 
-		column_ids.insert(column_ids.end(), op.build_side_output_columns.begin(), op.build_side_output_columns.end());
+		const auto &state = op.op_state->Cast<SpatialJoinGlobalOperatorState>();
 
-		// Also add the match column
-		column_ids.push_back(op.build_side_key_types.size() + op.build_side_payload_types.size());
+		if (state.IsPartitioned()) {
+			// We probe the partitions using the same state as the regular probe
+			probe_state = op.GetOperatorState(context);
+			return;
+		}
 
-		// We dont need to keep the tuples aroun after scanning
-		state.collection->InitializeScan(scan_state, std::move(column_ids), TupleDataPinProperties::DESTROY_AFTER_DONE);
-		state.collection->InitializeScanChunk(scan_state, scan_chunk);
+		if (PropagatesBuildSide(op.join_type)) {
+			unmatched_rows = make_unsafe_uniq_array<data_ptr_t>(STANDARD_VECTOR_SIZE);
+		}
 	}
 
-	TupleDataLocalScanState scan_state;
-	DataChunk scan_chunk;
-	SelectionVector match_sel;
+	// Used to gather the unmatched build side rows, for right/outer joins
+	unsafe_unique_array<data_ptr_t> unmatched_rows;
+
+	// Only used when the build side is partitioned, the partition this thread joins the spilled probe rows with
+	optional_ptr<SpatialJoinPartition> partition;
+	unique_ptr<FlatRTree> partition_rtree;
+	unique_ptr<OperatorState> probe_state;
+	TupleDataScanState probe_scan_state;
+	DataChunk probe_chunk;
+	bool probe_needs_input = true;
+
+	// Only used for self joins. The rhs rows of the candidate pairs are stored in the build side pointers of the probe
+	// state, so that they can be used to evaluate the predicate.
+	FlatRTreeSelfJoinState self_join_scan;
+	bool self_join_active = false;
+	unsafe_unique_array<data_ptr_t> self_join_lhs_rows;
+	unsafe_unique_array<data_ptr_t> result_lhs_rows;
+	unsafe_unique_array<data_ptr_t> result_rhs_rows;
 };
 
 unique_ptr<GlobalSourceState> PhysicalSpatialJoin::GetGlobalSourceState(ClientContext &context) const {
-	auto gstate = make_uniq<SpatialJoinGlobalSourceState>(*this);
+	auto gstate = make_uniq<SpatialJoinGlobalSourceState>(context, *this);
 	return std::move(gstate);
 }
 
 unique_ptr<LocalSourceState> PhysicalSpatialJoin::GetLocalSourceState(ExecutionContext &context,
                                                                       GlobalSourceState &gstate_p) const {
-	auto lstate = make_uniq<SpatialJoinLocalSourceState>(*this);
+	auto lstate = make_uniq<SpatialJoinLocalSourceState>(*this, context);
 	return std::move(lstate);
 }
 
-SourceResultType PhysicalSpatialJoin::GetData(ExecutionContext &context, DataChunk &chunk,
-                                              OperatorSourceInput &input) const {
-	D_ASSERT(PropagatesBuildSide(join_type));
+// Join the remaining partitions of a partitioned build side, one partition pair per thread at a time
+static SourceResultType GetPartitionedData(ExecutionContext &context, const PhysicalSpatialJoin &op, DataChunk &chunk,
+                                           SpatialJoinGlobalSourceState &gstate, SpatialJoinLocalSourceState &lstate) {
+	auto &state = op.op_state->Cast<SpatialJoinGlobalOperatorState>();
+	gstate.PreparePartitions(state);
 
-	auto &gstate = input.global_state.Cast<SpatialJoinGlobalSourceState>();
-	auto &lstate = input.local_state.Cast<SpatialJoinLocalSourceState>();
+	auto &probe_state = lstate.probe_state->Cast<SpatialJoinLocalOperatorState>();
+
+	while (true) {
+		if (!lstate.partition) {
+			// Claim the next partition
+			const auto partition_idx = gstate.next_partition++;
+			if (partition_idx >= state.partitions.size()) {
+				state.FlushCounters(probe_state);
+				return SourceResultType::FINISHED;
+			}
 
-	const auto &tuples = gstate.op.op_state->Cast<SpatialJoinGlobalOperatorState>().collection;
+			auto &partition = state.partitions[partition_idx];
+			if (partition.rtree_size == 0 || !partition.probe || partition.probe->Count() == 0) {
+				// Nothing to join in this partition
+				partition.build.reset();
+				partition.probe.reset();
+				gstate.tuples_scanned++;
+				continue;
+			}
 
-	while (tuples->Scan(gstate.scan_state, lstate.scan_state, lstate.scan_chunk)) {
-		gstate.tuples_scanned += lstate.scan_chunk.size();
+			// Build the rtree for this partition, this pins the build side rows of the partition
+			Profiler timer;
+			timer.Start();
+			lstate.partition_rtree = CreateFlatRTree(context.client, op, *partition.build, partition.rtree_size);
+			lstate.partition_rtree->Build();
+			timer.End();
+			probe_state.build_time += timer.Elapsed();
 
-		const auto matches = FlatVector::GetData<bool>(lstate.scan_chunk.data.back());
+			partition.probe->InitializeScan(lstate.probe_scan_state, TupleDataPinProperties::DESTROY_AFTER_DONE);
+			partition.probe->InitializeScanChunk(lstate.probe_scan_state, lstate.probe_chunk);
 
-		idx_t result_count = 0;
-		for (idx_t i = 0; i < lstate.scan_chunk.size(); i++) {
-			if (!matches[i]) {
-				lstate.match_sel.set_index(result_count++, i);
+			lstate.partition = &partition;
+			lstate.probe_needs_input = true;
+		}
+
+		if (lstate.probe_needs_input) {
+			lstate.probe_chunk.Reset();
+			if (!lstate.partition->probe->Scan(lstate.probe_scan_state, lstate.probe_chunk)) {
+				// We are done with this partition, release it
+#if SPATIAL_USE_GEOS
+				if (probe_state.prepared_cache) {
+					probe_state.prepared_cache->Clear();
+				}
+#endif
+				lstate.partition_rtree.reset();
+				lstate.partition->build.reset();
+				lstate.partition->probe.reset();
+				lstate.partition = nullptr;
+				gstate.tuples_scanned++;
+				continue;
 			}
+			lstate.probe_needs_input = false;
 		}
 
-		if (result_count > 0) {
+		chunk.Reset();
+		const auto result = ProbeRTree(op, lstate.probe_chunk, chunk, lstate.partition_rtree.get(),
+		                               *lstate.partition->build, probe_state);
+		lstate.probe_needs_input = result == OperatorResultType::NEED_MORE_INPUT;
+
+		if (chunk.size() != 0) {
+			return SourceResultType::HAVE_MORE_OUTPUT;
+		}
+	}
+}
+
+// Join the rtree of the build side with itself, one pair of nodes per thread at a time
+static SourceResultType GetSelfJoinData(const PhysicalSpatialJoin &op, DataChunk &chunk,
+                                        SpatialJoinGlobalSourceState &gstate, SpatialJoinLocalSourceState &lstate) {
+	auto &sink = op.sink_state->Cast<SpatialJoinGlobalState>();
+	auto &probe_state = lstate.probe_state->Cast<SpatialJoinLocalOperatorState>();
+	auto &args = probe_state.match_pred_arg_chunk;
+	auto &sel = *FlatVector::IncrementalSelectionVector();
 
-			const auto lhs_col_count = probe_side_output_columns.size();
-			const auto rhs_col_count = build_side_output_columns.size();
+	const auto lhs_rows = lstate.self_join_lhs_rows.get();
+	const auto rhs_rows = probe_state.build_side_pointers.get();
 
-			// Null the LHS columns
-			for (idx_t i = 0; i < lhs_col_count; i++) {
-				auto &target = chunk.data[i];
-				target.SetVectorType(VectorType::CONSTANT_VECTOR);
-				ConstantVector::SetNull(target, true);
+	while (true) {
+		if (!lstate.self_join_active) {
+			// Claim the next pair of nodes
+			const auto task_idx = gstate.next_task++;
+			if (task_idx >= gstate.self_join_tasks.size()) {
+				gstate.candidate_count += probe_state.candidate_count;
+				gstate.match_count += probe_state.match_count;
+				gstate.node_count += lstate.self_join_scan.node_count;
+				probe_state.candidate_count = 0;
+				probe_state.match_count = 0;
+				lstate.self_join_scan.node_count = 0;
+
+				lock_guard<mutex> guard(gstate.timing_lock);
+				gstate.filter_time += probe_state.filter_time;
+				gstate.refine_time += probe_state.refine_time;
+				probe_state.filter_time = 0;
+				probe_state.refine_time = 0;
+				return SourceResultType::FINISHED;
 			}
+			sink.rtree->InitSelfJoinScan(lstate.self_join_scan, gstate.self_join_tasks[task_idx]);
+			lstate.self_join_active = true;
+		}
+
+		// Every candidate pair can produce two output rows, one for each orientation
+		Profiler timer;
+		timer.Start();
+		const auto count = sink.rtree->SelfJoinScan(lstate.self_join_scan, lhs_rows, rhs_rows, STANDARD_VECTOR_SIZE / 2);
+		timer.End();
+		probe_state.filter_time += timer.Elapsed();
+		if (count == 0) {
+			lstate.self_join_active = false;
+			gstate.tuples_scanned++;
+			continue;
+		}
+		probe_state.candidate_count += count;
+
+		// Evaluate the predicate for the candidate pairs
+		Vector lhs_pointers(LogicalType::POINTER, reinterpret_cast<data_ptr_t>(lhs_rows));
+		Vector rhs_pointers(LogicalType::POINTER, reinterpret_cast<data_ptr_t>(rhs_rows));
+		args.Reset();
+		sink.collection->Gather(lhs_pointers, sel, count, 0, args.data[0], sel, nullptr);
+		sink.collection->Gather(rhs_pointers, sel, count, 0, args.data[1], sel, nullptr);
+		args.SetCardinality(count);
 
-			// Set the RHS columns
-			for (idx_t i = 0; i < rhs_col_count; i++) {
-				auto &target = chunk.data[lhs_col_count + i];
-				// Offset by one here to skip the match column
-				target.Slice(lstate.scan_chunk.data[i], lstate.match_sel, result_count);
+		const auto match_count = SelectMatches(probe_state, count);
+		probe_state.match_count += match_count;
+
+		// The predicate is symmetric, so each matching pair of distinct rows is emitted in both orientations
+		idx_t result_count = 0;
+		for (idx_t i = 0; i < match_count; i++) {
+			const auto pair_idx = probe_state.match_sel.get_index(i);
+			lstate.result_lhs_rows[result_count] = lhs_rows[pair_idx];
+			lstate.result_rhs_rows[result_count] = rhs_rows[pair_idx];
+			result_count++;
+			if (lhs_rows[pair_idx] != rhs_rows[pair_idx]) {
+				lstate.result_lhs_rows[result_count] = rhs_rows[pair_idx];
+				lstate.result_rhs_rows[result_count] = lhs_rows[pair_idx];
+				result_count++;
 			}
+		}
 
-			chunk.SetCardinality(result_count);
-			return SourceResultType::HAVE_MORE_OUTPUT;
+		if (result_count == 0) {
+			continue;
 		}
+
+		// Gather both sides of the output from the build side rows
+		const auto lhs_col_count = op.self_join_probe_columns.size();
+		const auto rhs_col_count = op.build_side_output_columns.size();
+
+		Vector result_lhs(LogicalType::POINTER, reinterpret_cast<data_ptr_t>(lstate.result_lhs_rows.get()));
+		Vector result_rhs(LogicalType::POINTER, reinterpret_cast<data_ptr_t>(lstate.result_rhs_rows.get()));
+		for (idx_t i = 0; i < lhs_col_count; i++) {
+			sink.collection->Gather(result_lhs, sel, result_count, op.self_join_probe_columns[i], chunk.data[i], sel,
+			                        nullptr);
+		}
+		for (idx_t i = 0; i < rhs_col_count; i++) {
+			sink.collection->Gather(result_rhs, sel, result_count, op.build_side_output_columns[i],
+			                        chunk.data[lhs_col_count + i], sel, nullptr);
+		}
+
+		chunk.SetCardinality(result_count);
+		return SourceResultType::HAVE_MORE_OUTPUT;
 	}
+}
 
-	return SourceResultType::FINISHED;
+SourceResultType PhysicalSpatialJoin::GetData(ExecutionContext &context, DataChunk &chunk,
+                                              OperatorSourceInput &input) const {
+	auto &gstate = input.global_state.Cast<SpatialJoinGlobalSourceState>();
+	auto &lstate = input.local_state.Cast<SpatialJoinLocalSourceState>();
+
+	if (self_join) {
+		return GetSelfJoinData(*this, chunk, gstate, lstate);
+	}
+
+	if (op_state->Cast<SpatialJoinGlobalOperatorState>().IsPartitioned()) {
+		return GetPartitionedData(context, *this, chunk, gstate, lstate);
+	}
+
+	if (!PropagatesBuildSide(join_type)) {
+		// Nothing to emit
+		return SourceResultType::FINISHED;
+	}
+
+	auto &state = op_state->Cast<SpatialJoinGlobalOperatorState>();
+	if (!state.rtree) {
+		return SourceResultType::FINISHED;
+	}
+
+	const auto &rtree = *state.rtree;
+	const auto &found_match = *state.found_match;
+	const idx_t rtree_count = rtree.Count();
+
+	// Each thread claims a range of build side rows at a time, and emits the ones that were not matched
+	while (true) {
+		const auto range_beg = gstate.next_position.fetch_add(STANDARD_VECTOR_SIZE);
+		if (range_beg >= gstate.tuples_maximum) {
+			return SourceResultType::FINISHED;
+		}
+		const auto range_end = MinValue<idx_t>(range_beg + STANDARD_VECTOR_SIZE, gstate.tuples_maximum);
+
+		idx_t result_count = 0;
+		for (auto position = range_beg; position < range_end; position++) {
+			if (position >= rtree_count) {
+				// Rows that are not in the rtree never match
+				lstate.unmatched_rows[result_count++] = state.unindexed_rows[position - rtree_count];
+			} else if (!found_match.IsSet(position)) {
+				lstate.unmatched_rows[result_count++] = rtree.GetRow(UnsafeNumericCast<uint32_t>(position));
+			}
+		}
+		gstate.tuples_scanned += range_end - range_beg;
+
+		if (result_count == 0) {
+			continue;
+		}
+
+		const auto lhs_col_count = probe_side_output_columns.size();
+		const auto rhs_col_count = build_side_output_columns.size();
+
+		// Null the LHS columns
+		for (idx_t i = 0; i < lhs_col_count; i++) {
+			auto &target = chunk.data[i];
+			target.SetVectorType(VectorType::CONSTANT_VECTOR);
+			ConstantVector::SetNull(target, true);
+		}
+
+		// Gather the RHS columns
+		Vector row_pointers(LogicalType::POINTER, reinterpret_cast<data_ptr_t>(lstate.unmatched_rows.get()));
+		auto &sel = *FlatVector::IncrementalSelectionVector();
+		for (idx_t i = 0; i < rhs_col_count; i++) {
+			auto &target = chunk.data[lhs_col_count + i];
+			state.collection->Gather(row_pointers, sel, result_count, build_side_output_columns[i], target, sel,
+			                         nullptr);
+		}
+
+		chunk.SetCardinality(result_count);
+		return SourceResultType::HAVE_MORE_OUTPUT;
+	}
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -1130,4 +2222,78 @@ ProgressData PhysicalSpatialJoin::GetProgress(ClientContext &context, GlobalSour
 	return res;
 }
 
+InsertionOrderPreservingMap<string> PhysicalSpatialJoin::ExtraSourceParams(GlobalSourceState &gstate,
+                                                                           LocalSourceState &lstate) const {
+	InsertionOrderPreservingMap<string> result;
+
+	idx_t build_count;
+	idx_t build_task_count;
+	idx_t probe_count;
+	idx_t candidate_count;
+	idx_t match_count;
+	idx_t node_count;
+	idx_t rtree_memory;
+	double build_time;
+	double filter_time;
+	double refine_time;
+	if (self_join) {
+		// Every build side row is joined with the other rows, the matches are the matching unordered pairs
+		auto &source_state = gstate.Cast<SpatialJoinGlobalSourceState>();
+		const auto &sink = sink_state->Cast<SpatialJoinGlobalState>();
+		build_count = sink.build_count;
+		probe_count = build_count;
+		candidate_count = source_state.candidate_count.load();
+		match_count = source_state.match_count.load();
+		node_count = source_state.node_count.load();
+		rtree_memory = sink.rtree_memory;
+		build_time = sink.GetBuildTime();
+		build_task_count = sink.GetBuildTaskCount();
+
+		lock_guard<mutex> guard(source_state.timing_lock);
+		filter_time = source_state.filter_time;
+		refine_time = source_state.refine_time;
+	} else if (op_state) {
+		auto &state = op_state->Cast<SpatialJoinGlobalOperatorState>();
+		build_count = state.build_count;
+		probe_count = state.probe_count.load();
+		candidate_count = state.candidate_count.load();
+		match_count = state.match_count.load();
+		node_count = state.node_count.load();
+		rtree_memory = state.rtree_memory;
+		build_task_count = state.build_task_count;
+
+		lock_guard<mutex> guard(state.timing_lock);
+		build_time = state.build_time;
+		filter_time = state.filter_time;
+		refine_time = state.refine_time;
+	} else {
+		return result;
+	}
+
+	result["Build Rows"] = to_string(build_count);
+	result["Build Time"] = StringUtil::Format("%.4fs", build_time);
+	if (build_task_count > 1) {
+		result["Build Tasks"] = to_string(build_task_count);
+	}
+	result["RTree Size"] = StringUtil::BytesToHumanReadableString(rtree_memory);
+	result["Probe Rows"] = to_string(probe_count);
+	result["Nodes Visited"] = to_string(node_count);
+	result["Candidate Pairs"] = to_string(candidate_count);
+	result["Matches"] = to_string(match_count);
+	if (candidate_count != 0) {
+		const auto hit_rate = 100.0 * static_cast<double>(match_count) / static_cast<double>(candidate_count);
+		result["Refinement Hit Rate"] = StringUtil::Format("%.2f%%", hit_rate);
+	}
+	// The time is summed over all threads, so that the filter and refine steps can be compared
+	result["Filter Time"] = StringUtil::Format("%.4fs", filter_time);
+	result["Refine Time"] = StringUtil::Format("%.4fs", refine_time);
+	if (op_state && op_state->Cast<SpatialJoinGlobalOperatorState>().IsPartitioned()) {
+		result["Build Partitions"] = to_string(op_state->Cast<SpatialJoinGlobalOperatorState>().partitions.size());
+	}
+	if (op_state && op_state->Cast<SpatialJoinGlobalOperatorState>().cached_build) {
+		result["Cached Build"] = "true";
+	}
+	return result;
+}
+
 } // namespace duckdb
\ No newline at end of file
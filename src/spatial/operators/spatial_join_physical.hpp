@@ -2,6 +2,8 @@
 #include "duckdb/execution/operator/join/physical_join.hpp"
 #include "duckdb/planner/operator/logical_join.hpp"
 #include "duckdb/common/types/row/tuple_data_layout.hpp"
+#include "spatial/operators/spatial_join_cache.hpp"
+#include "spatial/operators/spatial_join_logical.hpp"
 
 namespace duckdb {
 
@@ -28,8 +30,33 @@ public:
 
 	vector<LogicalType> build_side_key_types;
 
+	//! For distance predicates (e.g. ST_DWithin), the distance to expand the probe side bounds by
+	double probe_side_expansion = 0;
+
+	//! For geodesic distance predicates (e.g. ST_DWithin_Sphere), the distance is in meters while the coordinates are
+	//! (latitude, longitude) in degrees. Then this is the radius of the sphere to convert the distance to an angle
+	//! with, and the expanded probe side bounds depend on the latitude and wrap around the antimeridian. Otherwise 0.
+	double geodesic_radius = 0;
+
+	//! The maximum number of boxes the rtree is probed with per probe side row
+	static constexpr idx_t MAX_PROBE_BOXES = 2;
+
+	//! If set, both sides of the join are read from the (single) build side child, and the rtree is joined with itself
+	//! in the source phase. Then the probe side output columns are gathered from these columns of the layout.
+	bool self_join = false;
+	vector<column_t> self_join_probe_columns;
+
+	//! Whether the build side is indexed with an rtree or a uniform grid
+	SpatialJoinAlgorithm algorithm = SpatialJoinAlgorithm::RTREE;
+
 	shared_ptr<TupleDataLayout> layout;
-	idx_t build_side_match_offset = 0; // This is the byte offset to the match column for right/outer joins
+
+	//! If set, the build side is a plain scan of this table, and the built rtree is kept in the SpatialJoinBuildCache
+	//! under the key, to be probed by later queries instead of scanning the table again
+	optional_ptr<DuckTableEntry> build_cache_table;
+	string build_cache_key;
+	//! The version of the table the build side of the current execution is cached for, set when building the pipelines
+	SpatialJoinBuildCache::TableVersion build_cache_version;
 
 public:
 	// Operator Interface
@@ -70,18 +97,31 @@ public:
 	SourceResultType GetData(ExecutionContext &context, DataChunk &chunk, OperatorSourceInput &input) const override;
 
 	bool IsSource() const override {
-		// The PhysicalSpatialJoin is only a source if the join type is RIGHT/OUTER
-		return PropagatesBuildSide(join_type);
+		// The PhysicalSpatialJoin is a source if the join type is RIGHT/OUTER, or if the join type is INNER, in which
+		// case the build side may get partitioned and the remaining partitions are joined in a second pass (or, for a
+		// self join, the whole join happens in the source phase)
+		return PropagatesBuildSide(join_type) || join_type == JoinType::INNER;
 	}
 
 	bool ParallelSource() const override {
 		return true;
 	}
 
+public:
+	// Pipeline construction, a self join has no probe side child and is built like a regular sink
+	void BuildPipelines(Pipeline &current, MetaPipeline &meta_pipeline) override;
+	vector<const_reference<PhysicalOperator>> GetSources() const override;
+
 public:
 	//! Returns the current progress percentage, or a negative value if progress bars are not supported
 	ProgressData GetProgress(ClientContext &context, GlobalSourceState &gstate) const override;
 
+	//! Reports the build and probe side row counts, the time spent building the rtree and its size, the number of rtree
+	//! nodes visited, how many of the candidate pairs matched, and the time spent filtering and refining the candidate
+	//! pairs, when profiling
+	InsertionOrderPreservingMap<string> ExtraSourceParams(GlobalSourceState &gstate,
+	                                                      LocalSourceState &lstate) const override;
+
 	InsertionOrderPreservingMap<string> ParamsToString() const override;
 	string GetName() const override;
 };
@@ -0,0 +1,362 @@
+#include "spatial/operators/spatial_join_refine.hpp"
+#include "spatial/geometry/geometry_serialization.hpp"
+#include "spatial/geometry/segment_index.hpp"
+#include "spatial/geometry/sgl.hpp"
+
+#include "duckdb/common/string_util.hpp"
+
+#include <algorithm>
+
+namespace duckdb {
+
+// The predicates we can refine, expressed as predicate(probe, build)
+enum class SpatialJoinPredicate : uint8_t {
+	INTERSECTS,
+	TOUCHES,
+	CROSSES,
+	OVERLAPS,
+	CONTAINS,
+	CONTAINS_PROPERLY,
+	WITHIN,
+	WITHIN_PROPERLY,
+	COVERS,
+	COVERED_BY,
+	EQUALS,
+};
+
+namespace {
+
+enum class ShapeKind : uint8_t { POINT, AREA, OTHER };
+
+// The parts of a geometry we need to decide a predicate natively
+struct Shape {
+	ShapeKind kind = ShapeKind::OTHER;
+	// Only set for points
+	sgl::vertex_xy point = {0, 0};
+	// Only set for areas that are an axis-aligned rectangle (with a non-zero area)
+	bool is_box = false;
+	sgl::box_xy box = {};
+};
+
+bool TryGetBox(const sgl::geometry &geom, sgl::box_xy &box) {
+	if (geom.get_type() != sgl::geometry_type::POLYGON || geom.get_count() != 1) {
+		return false;
+	}
+	const auto &ring = *geom.get_first_part();
+	if (ring.get_count() != 5) {
+		return false;
+	}
+
+	sgl::vertex_xy v[5];
+	for (uint32_t i = 0; i < 5; i++) {
+		v[i] = ring.get_vertex_xy(i);
+	}
+	if (!(v[0] == v[4])) {
+		return false;
+	}
+
+	// Every edge must be either horizontal or vertical, alternating between the two
+	for (uint32_t i = 0; i < 4; i++) {
+		const auto moves_x = v[i].x != v[i + 1].x;
+		const auto moves_y = v[i].y != v[i + 1].y;
+		if (moves_x == moves_y) {
+			return false;
+		}
+		const auto next_moves_x = v[(i + 1) % 4].x != v[(i + 1) % 4 + 1].x;
+		if (moves_x == next_moves_x) {
+			return false;
+		}
+	}
+
+	box.min.x = std::min(v[0].x, v[2].x);
+	box.min.y = std::min(v[0].y, v[2].y);
+	box.max.x = std::max(v[0].x, v[2].x);
+	box.max.y = std::max(v[0].y, v[2].y);
+	return true;
+}
+
+void Classify(const sgl::geometry &geom, Shape &shape) {
+	shape = Shape();
+	switch (geom.get_type()) {
+	case sgl::geometry_type::POINT:
+		if (!geom.is_empty()) {
+			shape.kind = ShapeKind::POINT;
+			shape.point = geom.get_vertex_xy(0);
+		}
+		break;
+	case sgl::geometry_type::POLYGON:
+	case sgl::geometry_type::MULTI_POLYGON:
+		if (!geom.is_empty()) {
+			shape.kind = ShapeKind::AREA;
+			shape.is_box = TryGetBox(geom, shape.box);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+// Locate a point relative to a POLYGON or MULTI_POLYGON, with the same orientation filter as the native scalar
+// predicates. Returns UNKNOWN if the filter can't decide, then the pair is left to GEOS.
+NativeLocation LocatePointInPolygon(const sgl::geometry &poly, const sgl::vertex_xy &point) {
+	const PointXY<double> p(point.x, point.y);
+	auto ring = poly.get_first_part();
+	return LocateInRings(poly.get_count(), [&](uint32_t ring_idx) {
+		if (ring_idx != 0) {
+			ring = ring->get_next();
+		}
+		return LocateInRing(p, ring->get_count(), [&](idx_t i) {
+			const auto vertex = ring->get_vertex_xy(UnsafeNumericCast<uint32_t>(i));
+			return PointXY<double>(vertex.x, vertex.y);
+		});
+	});
+}
+
+NativeLocation LocatePoint(const sgl::geometry &geom, const sgl::vertex_xy &point) {
+	if (geom.get_type() == sgl::geometry_type::POLYGON) {
+		return LocatePointInPolygon(geom, point);
+	}
+	D_ASSERT(geom.get_type() == sgl::geometry_type::MULTI_POLYGON);
+	auto result = NativeLocation::EXTERIOR;
+	auto part = geom.get_first_part();
+	for (uint32_t part_idx = 0; part_idx < geom.get_count(); part_idx++, part = part->get_next()) {
+		const auto location = LocatePointInPolygon(*part, point);
+		if (location == NativeLocation::INTERIOR || location == NativeLocation::UNKNOWN) {
+			return location;
+		}
+		if (location == NativeLocation::BOUNDARY) {
+			result = location;
+		}
+	}
+	return result;
+}
+
+// predicate(point, area), given where the point is located relative to the area
+bool EvaluatePointArea(SpatialJoinPredicate predicate, NativeLocation location) {
+	switch (predicate) {
+	case SpatialJoinPredicate::INTERSECTS:
+	case SpatialJoinPredicate::COVERED_BY:
+		return location != NativeLocation::EXTERIOR;
+	case SpatialJoinPredicate::WITHIN:
+	case SpatialJoinPredicate::WITHIN_PROPERLY:
+		return location == NativeLocation::INTERIOR;
+	case SpatialJoinPredicate::TOUCHES:
+		return location == NativeLocation::BOUNDARY;
+	default:
+		// A point can not contain, cover, overlap, cross or equal an area
+		return false;
+	}
+}
+
+// predicate(area, point), given where the point is located relative to the area
+bool EvaluateAreaPoint(SpatialJoinPredicate predicate, NativeLocation location) {
+	switch (predicate) {
+	case SpatialJoinPredicate::INTERSECTS:
+	case SpatialJoinPredicate::COVERS:
+		return location != NativeLocation::EXTERIOR;
+	case SpatialJoinPredicate::CONTAINS:
+	case SpatialJoinPredicate::CONTAINS_PROPERLY:
+		return location == NativeLocation::INTERIOR;
+	case SpatialJoinPredicate::TOUCHES:
+		return location == NativeLocation::BOUNDARY;
+	default:
+		// An area can not be within, covered by, overlap, cross or equal a point
+		return false;
+	}
+}
+
+// predicate(point, point)
+bool EvaluatePointPoint(SpatialJoinPredicate predicate, const sgl::vertex_xy &lhs, const sgl::vertex_xy &rhs) {
+	switch (predicate) {
+	case SpatialJoinPredicate::TOUCHES:
+	case SpatialJoinPredicate::CROSSES:
+	case SpatialJoinPredicate::OVERLAPS:
+		// Points have no boundary, and two points can only overlap if they are equal
+		return false;
+	default:
+		return lhs == rhs;
+	}
+}
+
+bool BoxContains(const sgl::box_xy &outer, const sgl::box_xy &inner) {
+	return outer.min.x <= inner.min.x && inner.max.x <= outer.max.x && outer.min.y <= inner.min.y &&
+	       inner.max.y <= outer.max.y;
+}
+
+bool BoxContainsProperly(const sgl::box_xy &outer, const sgl::box_xy &inner) {
+	return outer.min.x < inner.min.x && inner.max.x < outer.max.x && outer.min.y < inner.min.y &&
+	       inner.max.y < outer.max.y;
+}
+
+// predicate(box, box), both boxes have a non-zero area
+bool EvaluateBoxBox(SpatialJoinPredicate predicate, const sgl::box_xy &lhs, const sgl::box_xy &rhs) {
+	const auto overlap_w = std::min(lhs.max.x, rhs.max.x) - std::max(lhs.min.x, rhs.min.x);
+	const auto overlap_h = std::min(lhs.max.y, rhs.max.y) - std::max(lhs.min.y, rhs.min.y);
+	const auto intersects = overlap_w >= 0 && overlap_h >= 0;
+	const auto interiors_intersect = overlap_w > 0 && overlap_h > 0;
+
+	switch (predicate) {
+	case SpatialJoinPredicate::INTERSECTS:
+		return intersects;
+	case SpatialJoinPredicate::TOUCHES:
+		return intersects && !interiors_intersect;
+	case SpatialJoinPredicate::CROSSES:
+		return false;
+	case SpatialJoinPredicate::OVERLAPS:
+		return interiors_intersect && !BoxContains(lhs, rhs) && !BoxContains(rhs, lhs);
+	case SpatialJoinPredicate::CONTAINS:
+	case SpatialJoinPredicate::COVERS:
+		return BoxContains(lhs, rhs);
+	case SpatialJoinPredicate::CONTAINS_PROPERLY:
+		return BoxContainsProperly(lhs, rhs);
+	case SpatialJoinPredicate::WITHIN:
+	case SpatialJoinPredicate::COVERED_BY:
+		return BoxContains(rhs, lhs);
+	case SpatialJoinPredicate::WITHIN_PROPERLY:
+		return BoxContainsProperly(rhs, lhs);
+	case SpatialJoinPredicate::EQUALS:
+		return lhs.min == rhs.min && lhs.max == rhs.max;
+	default:
+		return false;
+	}
+}
+
+// Try to decide the predicate for a pair of shapes, returns false if the pair has to be evaluated in full
+bool TryEvaluate(SpatialJoinPredicate predicate, const Shape &probe, const sgl::geometry &probe_geom,
+                 const Shape &build, const sgl::geometry &build_geom, bool &result) {
+	if (probe.kind == ShapeKind::POINT && build.kind == ShapeKind::POINT) {
+		result = EvaluatePointPoint(predicate, probe.point, build.point);
+		return true;
+	}
+	if (probe.kind == ShapeKind::POINT && build.kind == ShapeKind::AREA) {
+		const auto location = LocatePoint(build_geom, probe.point);
+		if (location == NativeLocation::UNKNOWN) {
+			return false;
+		}
+		result = EvaluatePointArea(predicate, location);
+		return true;
+	}
+	if (probe.kind == ShapeKind::AREA && build.kind == ShapeKind::POINT) {
+		const auto location = LocatePoint(probe_geom, build.point);
+		if (location == NativeLocation::UNKNOWN) {
+			return false;
+		}
+		result = EvaluateAreaPoint(predicate, location);
+		return true;
+	}
+	if (probe.is_box && build.is_box) {
+		result = EvaluateBoxBox(predicate, probe.box, build.box);
+		return true;
+	}
+	return false;
+}
+
+} // namespace
+
+unique_ptr<SpatialJoinRefiner> SpatialJoinRefiner::TryCreate(Allocator &allocator, const string &predicate_name) {
+	// The predicates keep the order of the call, the probe side geometry is the first argument
+	static const case_insensitive_map_t<SpatialJoinPredicate> predicates = {
+	    {"ST_Intersects", SpatialJoinPredicate::INTERSECTS},
+	    {"ST_Touches", SpatialJoinPredicate::TOUCHES},
+	    {"ST_Crosses", SpatialJoinPredicate::CROSSES},
+	    {"ST_Overlaps", SpatialJoinPredicate::OVERLAPS},
+	    {"ST_Contains", SpatialJoinPredicate::CONTAINS},
+	    {"ST_ContainsProperly", SpatialJoinPredicate::CONTAINS_PROPERLY},
+	    {"ST_Within", SpatialJoinPredicate::WITHIN},
+	    {"ST_WithinProperly", SpatialJoinPredicate::WITHIN_PROPERLY},
+	    {"ST_Covers", SpatialJoinPredicate::COVERS},
+	    {"ST_CoveredBy", SpatialJoinPredicate::COVERED_BY},
+	    {"ST_Equals", SpatialJoinPredicate::EQUALS},
+	};
+
+	const auto it = predicates.find(predicate_name);
+	if (it == predicates.end()) {
+		return nullptr;
+	}
+	return make_uniq<SpatialJoinRefiner>(allocator, it->second);
+}
+
+SpatialJoinRefiner::SpatialJoinRefiner(Allocator &allocator, SpatialJoinPredicate predicate_p)
+    : predicate(predicate_p), arena(allocator) {
+	order = make_unsafe_uniq_array<sel_t>(STANDARD_VECTOR_SIZE);
+}
+
+idx_t SpatialJoinRefiner::Refine(Vector &probe_vec, Vector &build_vec, const data_ptr_t *build_rows, idx_t count,
+                                 bool *matches, SelectionVector &undecided_sel) {
+	D_ASSERT(count <= STANDARD_VECTOR_SIZE);
+
+	UnifiedVectorFormat probe_format;
+	UnifiedVectorFormat build_format;
+	probe_vec.ToUnifiedFormat(count, probe_format);
+	build_vec.ToUnifiedFormat(count, build_format);
+
+	const auto probe_data = UnifiedVectorFormat::GetData<string_t>(probe_format);
+	const auto build_data = UnifiedVectorFormat::GetData<string_t>(build_format);
+
+	// Group the candidates by build side row
+	for (idx_t i = 0; i < count; i++) {
+		order[i] = UnsafeNumericCast<sel_t>(i);
+	}
+	std::sort(order.get(), order.get() + count,
+	          [&](const sel_t lhs, const sel_t rhs) { return build_rows[lhs] < build_rows[rhs]; });
+
+	arena.Reset();
+
+	idx_t undecided_count = 0;
+	idx_t group_beg = 0;
+	while (group_beg < count) {
+		const auto build_row = build_rows[order[group_beg]];
+		auto group_end = group_beg + 1;
+		while (group_end < count && build_rows[order[group_end]] == build_row) {
+			group_end++;
+		}
+
+		// Deserialize the build side geometry once for the whole group
+		const auto build_idx = build_format.sel->get_index(order[group_beg]);
+		const auto build_valid = build_format.validity.RowIsValid(build_idx);
+
+		sgl::geometry build_geom;
+		Shape build_shape;
+		if (build_valid) {
+			const auto &blob = build_data[build_idx];
+			Serde::Deserialize(build_geom, arena, blob.GetDataUnsafe(), blob.GetSize());
+			Classify(build_geom, build_shape);
+		}
+
+		for (auto group_idx = group_beg; group_idx < group_end; group_idx++) {
+			const auto pair_idx = order[group_idx];
+			const auto probe_idx = probe_format.sel->get_index(pair_idx);
+
+			if (!build_valid || !probe_format.validity.RowIsValid(probe_idx)) {
+				// The predicate is NULL, which does not match
+				matches[pair_idx] = false;
+				continue;
+			}
+
+			if (build_shape.kind == ShapeKind::OTHER) {
+				undecided_sel.set_index(undecided_count++, pair_idx);
+				continue;
+			}
+
+			const auto &blob = probe_data[probe_idx];
+			sgl::geometry probe_geom;
+			Serde::Deserialize(probe_geom, arena, blob.GetDataUnsafe(), blob.GetSize());
+
+			Shape probe_shape;
+			Classify(probe_geom, probe_shape);
+
+			bool result;
+			if (TryEvaluate(predicate, probe_shape, probe_geom, build_shape, build_geom, result)) {
+				matches[pair_idx] = result;
+			} else {
+				undecided_sel.set_index(undecided_count++, pair_idx);
+			}
+		}
+
+		group_beg = group_end;
+	}
+
+	return undecided_count;
+}
+
+} // namespace duckdb
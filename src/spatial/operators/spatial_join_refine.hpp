@@ -0,0 +1,34 @@
+#pragma once
+
+#include "duckdb/common/types/vector.hpp"
+#include "duckdb/storage/arena_allocator.hpp"
+
+namespace duckdb {
+
+enum class SpatialJoinPredicate : uint8_t;
+
+// Refines the candidate pairs of a spatial join, i.e. evaluates the spatial predicate for the (probe, build) pairs whose
+// bounding boxes intersect. The candidates are grouped by build side row, so that each build side geometry is only
+// deserialized once per batch, and the common point/polygon, point/point and box/box cases are decided natively.
+// The pairs that can not be decided this way are left to the caller. This is not thread-safe.
+class SpatialJoinRefiner {
+public:
+	// Returns nullptr if none of the pairs of the predicate can be decided natively
+	static unique_ptr<SpatialJoinRefiner> TryCreate(Allocator &allocator, const string &predicate_name);
+
+	SpatialJoinRefiner(Allocator &allocator, SpatialJoinPredicate predicate);
+
+	// Refine each (probe, build) pair, setting whether it matches in 'matches'. Returns the number of pairs that could
+	// not be decided, their indexes are written to 'undecided_sel' (and their entry in 'matches' is left untouched).
+	idx_t Refine(Vector &probe_vec, Vector &build_vec, const data_ptr_t *build_rows, idx_t count, bool *matches,
+	             SelectionVector &undecided_sel);
+
+private:
+	SpatialJoinPredicate predicate;
+	ArenaAllocator arena;
+
+	// The candidates of the current batch, ordered by build side row
+	unsafe_unique_array<sel_t> order;
+};
+
+} // namespace duckdb
@@ -0,0 +1,1004 @@
+#pragma once
+
+#include "duckdb/common/allocator.hpp"
+#include "duckdb/common/types/selection_vector.hpp"
+#include "duckdb/common/types/vector.hpp"
+#include "spatial/geometry/geometry_type.hpp"
+#include "spatial/geometry/sgl.hpp"
+#include "spatial/util/math.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace duckdb {
+
+//======================================================================================================================
+// Flat RTree
+//======================================================================================================================
+// The packed rtree (or uniform grid) over the bounds of the build side of a spatial join. It is also used by other
+// operators that need to find the intersecting boxes of many rows at once, such as ST_ClusterDBSCAN.
+
+template <class T>
+class typed_view {
+public:
+	size_t size() const {
+		return len;
+	}
+	T *data() {
+		return ptr;
+	}
+	const T *data() const {
+		return ptr;
+	}
+	T &operator[](size_t idx) {
+		return data()[idx];
+	}
+	const T &operator[](size_t idx) const {
+		return data()[idx];
+	}
+
+	void set(T *ptr_p, const size_t len_p) {
+		ptr = ptr_p;
+		len = len_p;
+	}
+
+private:
+	T *ptr = nullptr;
+	size_t len = 0;
+};
+
+// Stores boxes as a structure-of-arrays, so that testing a run of boxes against a query box is a tight, branch-free
+// loop over four float arrays that the compiler can vectorize (SSE/AVX/NEON) without any platform specific code.
+class FlatBoxArray {
+	using Box = Box2D<float>;
+
+public:
+	void Initialize(Allocator &alloc, idx_t count_p) {
+		count = count_p;
+		data = alloc.Allocate(sizeof(float) * 4 * count);
+		min_x = reinterpret_cast<float *>(data.get());
+		min_y = min_x + count;
+		max_x = min_y + count;
+		max_y = max_x + count;
+	}
+
+	idx_t size() const {
+		return count;
+	}
+
+	Box Get(idx_t idx) const {
+		D_ASSERT(idx < count);
+		return Box(PointXY<float>(min_x[idx], min_y[idx]), PointXY<float>(max_x[idx], max_y[idx]));
+	}
+
+	void Set(idx_t idx, const Box &box) {
+		D_ASSERT(idx < count);
+		min_x[idx] = box.min.x;
+		min_y[idx] = box.min.y;
+		max_x[idx] = box.max.x;
+		max_y[idx] = box.max.y;
+	}
+
+	void Swap(idx_t lhs, idx_t rhs) {
+		std::swap(min_x[lhs], min_x[rhs]);
+		std::swap(min_y[lhs], min_y[rhs]);
+		std::swap(max_x[lhs], max_x[rhs]);
+		std::swap(max_y[lhs], max_y[rhs]);
+	}
+
+	// Test the boxes [beg, end) against the query box, setting result[i - beg] to 1 if box i intersects it.
+	// Same semantics as Box::Intersects.
+	void Intersects(const Box &box, idx_t beg, idx_t end, uint8_t *result) const {
+		D_ASSERT(beg <= end && end <= count);
+		const auto len = end - beg;
+		const auto x0 = min_x + beg;
+		const auto y0 = min_y + beg;
+		const auto x1 = max_x + beg;
+		const auto y1 = max_y + beg;
+		for (idx_t i = 0; i < len; i++) {
+			result[i] = static_cast<uint8_t>(!(x0[i] > box.max.x) & !(x1[i] < box.min.x) & !(y0[i] > box.max.y) &
+			                                 !(y1[i] < box.min.y));
+		}
+	}
+
+	// The first box in [beg, end) whose min x is greater than x, the boxes must be sorted by their min x
+	idx_t UpperBoundMinX(float x, idx_t beg, idx_t end) const {
+		D_ASSERT(beg <= end && end <= count);
+		return NumericCast<idx_t>(std::upper_bound(min_x + beg, min_x + end, x) - min_x);
+	}
+
+private:
+	AllocatedData data;
+	idx_t count = 0;
+	float *min_x = nullptr;
+	float *min_y = nullptr;
+	float *max_x = nullptr;
+	float *max_y = nullptr;
+};
+
+// Expand a box by a distance, rounding outwards so that the result always covers the exactly expanded box
+inline Box2D<float> ExpandBox(const Box2D<float> &box, double distance) {
+	if (distance == 0) {
+		return box;
+	}
+	Box2D<float> result;
+	result.min.x = MathUtil::DoubleToFloatDown(static_cast<double>(box.min.x) - distance);
+	result.min.y = MathUtil::DoubleToFloatDown(static_cast<double>(box.min.y) - distance);
+	result.max.x = MathUtil::DoubleToFloatUp(static_cast<double>(box.max.x) + distance);
+	result.max.y = MathUtil::DoubleToFloatUp(static_cast<double>(box.max.y) + distance);
+	return result;
+}
+
+// Probes a FlatRTree with a whole batch of boxes at once. Each node is visited once for all the probe boxes that
+// intersect it, so the top levels of the tree only have to be loaded once per batch.
+class FlatRTreeScanState {
+	friend class FlatRTree;
+	using Box = Box2D<float>;
+
+public:
+	explicit FlatRTreeScanState() : matches(LogicalType::POINTER), matches_sel(STANDARD_VECTOR_SIZE) {
+	}
+
+	// Clear all probes
+	void Reset() {
+		probe_boxes.clear();
+		probe_ids.clear();
+		exhausted = true;
+		matches_idx = 0;
+		matches_count = 0;
+	}
+
+	// Add a box to probe the tree with. The probe index is emitted alongside each match.
+	void AddProbe(const Box &box, sel_t probe_idx) {
+		probe_boxes.push_back(box);
+		probe_ids.push_back(probe_idx);
+	}
+
+public:
+	Vector matches;              // the build side row of each match
+	SelectionVector matches_sel; // the probe index of each match
+	idx_t matches_count = 0;
+	idx_t matches_idx = 0;
+
+	// The insertion position of the build side row of each match
+	uint32_t matches_pos[STANDARD_VECTOR_SIZE] = {};
+
+	// The nodes visited since the join last collected them into its "Nodes Visited" metric
+	idx_t node_count = 0;
+
+private:
+	// A node to visit, together with the probes (stored in the probe stack) that intersect the node
+	struct Frame {
+		uint32_t node_beg;
+		uint32_t probe_beg;
+		uint32_t probe_end;
+	};
+
+	vector<Box> probe_boxes;
+	vector<sel_t> probe_ids;
+
+	vector<Frame> frame_stack;
+	vector<uint32_t> probe_stack;
+
+	// The result of testing each probe of a node against each entry of the node, one row of node_size per probe
+	vector<uint8_t> node_hits;
+	vector<uint8_t> leaf_hits;
+
+	// The leaf node we are currently emitting matches from
+	Frame leaf = {};
+	bool leaf_active = false;
+	size_t entry_pos = 0;
+	uint32_t probe_pos = 0;
+
+	// When probing a grid, the range of cells covered by the current probe box, and the cell we are emitting from
+	bool cell_active = false;
+	uint32_t cell_min_x = 0;
+	uint32_t cell_max_x = 0;
+	uint32_t cell_max_y = 0;
+	uint32_t cell_x = 0;
+	uint32_t cell_y = 0;
+	bool cell_hits_valid = false;
+	size_t cell_beg = 0;
+	size_t cell_end = 0;
+
+	bool exhausted = true;
+};
+
+// A pair of nodes (given by the position of their first entry) on the same layer of a FlatRTree, with lhs <= rhs
+struct FlatRTreeNodePair {
+	uint32_t lhs_beg;
+	uint32_t rhs_beg;
+};
+
+// Joins (a part of) a FlatRTree with itself, emitting every unordered pair of entries whose boxes intersect once.
+// The tree is traversed as pairs of nodes, so a pair of subtrees is skipped as soon as their bounds do not intersect.
+class FlatRTreeSelfJoinState {
+	friend class FlatRTree;
+
+public:
+	// The distance to expand the lhs boxes by, for distance predicates
+	double expansion = 0;
+
+	// The number of pairs of nodes visited so far, for profiling
+	idx_t node_count = 0;
+
+private:
+	vector<FlatRTreeNodePair> pair_stack;
+	vector<uint8_t> node_hits;
+
+	// The pair of leaf nodes we are currently emitting from, and the hits of the current lhs entry
+	FlatRTreeNodePair leaf = {};
+	bool leaf_active = false;
+	size_t lhs_pos = 0;
+	size_t rhs_pos = 0;
+	size_t hits_beg = 0;
+	bool hits_valid = false;
+	vector<uint8_t> leaf_hits;
+};
+
+// The rtree is packed bottom-up from the entries sorted along a hilbert curve. Alternatively, the entries can be
+// bucketed into a uniform grid over their bounds instead (see BuildGrid), which is what the GRID join algorithm uses.
+class FlatRTree {
+public:
+	using Box = Box2D<float>;
+
+	FlatRTree(Allocator &alloc_p, uint32_t item_count_p, uint32_t node_size_p, bool is_grid_p = false)
+	    : alloc(alloc_p), item_count(item_count_p), node_size(node_size_p), is_grid(is_grid_p) {
+
+		uint32_t count = item_count;
+		uint32_t nodes = item_count;
+
+		layer_bounds.push_back(nodes);
+
+		if (item_count_p == 0) {
+			return;
+		}
+
+		// A grid has no internal nodes
+		while (!is_grid && count > 1) {
+			count = (count + node_size - 1) / node_size;
+			nodes += count;
+			layer_bounds.push_back(nodes);
+		}
+
+		box_array.Initialize(alloc, nodes);
+		idx_array_mem = alloc.Allocate(sizeof(uint32_t) * nodes);
+		row_array_mem = alloc.Allocate(sizeof(data_ptr_t) * item_count);
+
+		idx_array.set(reinterpret_cast<uint32_t *>(idx_array_mem.get()), nodes);
+		row_array.set(reinterpret_cast<data_ptr_t *>(row_array_mem.get()), item_count);
+
+		// Make sure that memory is initialized
+		for (size_t i = 0; i < nodes; i++) {
+			box_array.Set(i, Box());
+			idx_array[i] = 0;
+		}
+		for (size_t i = 0; i < item_count; i++) {
+			row_array[i] = nullptr;
+		}
+	}
+
+	uint32_t Count() const {
+		return item_count;
+	}
+
+	bool IsGrid() const {
+		return is_grid;
+	}
+
+	// The number of bytes allocated for the boxes, child indices and row pointers of the tree, and for the cells of
+	// the grid. The cells of the grid are only allocated once it is built.
+	idx_t GetMemoryUsage() const {
+		return box_array.size() * sizeof(float) * 4 + idx_array.size() * sizeof(uint32_t) +
+		       row_array.size() * sizeof(data_ptr_t) + cell_boxes.size() * sizeof(float) * 4 +
+		       cell_entries.size() * sizeof(uint32_t) + cell_offsets.size() * sizeof(uint32_t);
+	}
+
+	// The bounds of all the entries in the tree, i.e. the box of the root. Only valid once the tree is built.
+	Box GetBounds() const {
+		D_ASSERT(item_count != 0);
+		if (is_grid) {
+			return tree_box;
+		}
+		return box_array.Get(box_array.size() - 1);
+	}
+
+	// Get the row pushed at the given insertion position
+	data_ptr_t GetRow(uint32_t position) const {
+		return row_array[position];
+	}
+
+	// Return insertion index
+	uint32_t Push(const Box &box, data_ptr_t row) {
+		// Push the index and the box
+		idx_array[current_position] = current_position;
+		box_array.Set(current_position, box);
+
+		// Update the bounds
+		tree_box.Union(box);
+
+		// Store the row pointer
+		row_array[current_position] = row;
+
+		return current_position++;
+	}
+
+	void Sort(vector<uint32_t> &curve) {
+		Sort(curve, 0, curve.size() - 1);
+	}
+
+	void Sort(vector<uint32_t> &curve, size_t l_idx, size_t r_idx) {
+		if (l_idx < r_idx) {
+			const auto pivot = curve[(l_idx + r_idx) >> 1];
+			auto pivot_l = l_idx - 1;
+			auto pivot_r = r_idx + 1;
+
+			while (true) {
+				do {
+					++pivot_l;
+				} while (curve[pivot_l] < pivot);
+				do {
+					--pivot_r;
+				} while (curve[pivot_r] > pivot);
+
+				if (pivot_l >= pivot_r) {
+					break;
+				}
+
+				// Reorder the curve, boxes and indices
+				// TODO: Pass callback here and make static
+				std::swap(curve[pivot_l], curve[pivot_r]);
+				box_array.Swap(pivot_l, pivot_r);
+				std::swap(idx_array[pivot_l], idx_array[pivot_r]);
+			}
+
+			Sort(curve, l_idx, pivot_r);
+			Sort(curve, pivot_r + 1, r_idx);
+		}
+	}
+
+	void Build() {
+		D_ASSERT(item_count == current_position);
+
+		if (is_grid) {
+			BuildGrid();
+			return;
+		}
+
+		if (item_count == 0) {
+			// Nothing to build, e.g. all the build side geometries were empty
+			return;
+		}
+
+		if (item_count <= node_size) {
+			box_array.Set(current_position++, tree_box);
+			return;
+		}
+
+		// Generate hilbert curve values
+		PrepareCurve();
+
+		vector<uint32_t> curve(item_count);
+		for (idx_t i = 0; i < item_count; i++) {
+			curve[i] = GetCurveValue(box_array.Get(i));
+		}
+
+		// Now, sort the indices based on their curve value
+		Sort(curve);
+
+		// Pack each layer of the tree, bottom-up
+		for (idx_t layer_idx = 0; layer_idx < GetLayerCount() - 1; layer_idx++) {
+			PackLayer(layer_idx, 0, GetLayerSize(layer_idx + 1));
+		}
+
+		FinishBuild();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Build helpers (also used by the parallel build)
+	//------------------------------------------------------------------------------------------------------------------
+
+	// Compute the scale factors used to map box centers onto the hilbert curve
+	void PrepareCurve() {
+		constexpr auto max_hilbert = std::numeric_limits<uint16_t>::max();
+		curve_scale_x = max_hilbert / (tree_box.max.x - tree_box.min.x);
+		curve_scale_y = max_hilbert / (tree_box.max.y - tree_box.min.y);
+	}
+
+	uint32_t GetCurveValue(const Box &box) const {
+		const auto hx = static_cast<uint32_t>(curve_scale_x * ((box.min.x + box.max.x) / 2 - tree_box.min.x));
+		const auto hy = static_cast<uint32_t>(curve_scale_y * ((box.min.y + box.max.y) / 2 - tree_box.min.y));
+		return sgl::util::hilbert_encode(16, hx, hy);
+	}
+
+	// The number of layers, including the leaf layer
+	idx_t GetLayerCount() const {
+		return layer_bounds.size();
+	}
+
+	// The number of nodes in the given layer
+	idx_t GetLayerSize(idx_t layer_idx) const {
+		return layer_idx == 0 ? layer_bounds[0] : layer_bounds[layer_idx] - layer_bounds[layer_idx - 1];
+	}
+
+	// Create the parent nodes [parent_beg, parent_end) of the given layer from its (already sorted) entries.
+	// Parents never overlap, so disjoint ranges of the same layer can be packed concurrently.
+	void PackLayer(idx_t layer_idx, idx_t parent_beg, idx_t parent_end) {
+		const auto child_beg = layer_idx == 0 ? 0 : layer_bounds[layer_idx - 1];
+		const auto child_end = layer_bounds[layer_idx];
+		const auto parent_off = layer_bounds[layer_idx];
+
+		for (auto parent_idx = parent_beg; parent_idx < parent_end; parent_idx++) {
+			const auto entry_beg = child_beg + parent_idx * node_size;
+			const auto entry_end = MinValue<idx_t>(entry_beg + node_size, child_end);
+
+			auto node_box = box_array.Get(entry_beg);
+			for (auto entry_idx = entry_beg + 1; entry_idx < entry_end; entry_idx++) {
+				node_box.Union(box_array.Get(entry_idx));
+			}
+
+			idx_array[parent_off + parent_idx] = UnsafeNumericCast<uint32_t>(entry_beg);
+			box_array.Set(parent_off + parent_idx, node_box);
+		}
+	}
+
+	void FinishBuild() {
+		current_position = layer_bounds.back();
+	}
+
+	Box GetBox(idx_t entry_idx) const {
+		return box_array.Get(entry_idx);
+	}
+
+	uint32_t GetIndex(idx_t entry_idx) const {
+		return idx_array[entry_idx];
+	}
+
+	void SetEntry(idx_t entry_idx, const Box &box, uint32_t index) {
+		box_array.Set(entry_idx, box);
+		idx_array[entry_idx] = index;
+	}
+
+	size_t UpperBound(size_t node_idx) const {
+		const auto it = std::upper_bound(layer_bounds.begin(), layer_bounds.end(), node_idx);
+		if (it == layer_bounds.end()) {
+			return layer_bounds.back();
+		}
+		return *it;
+	}
+
+	void InitScan(FlatRTreeScanState &state) const {
+		state.frame_stack.clear();
+		state.probe_stack.clear();
+		state.leaf_active = false;
+		state.cell_active = false;
+		state.probe_pos = 0;
+		state.matches_idx = 0;
+		state.matches_count = 0;
+
+		const auto probe_count = UnsafeNumericCast<uint32_t>(state.probe_boxes.size());
+		state.exhausted = probe_count == 0 || item_count == 0;
+		if (state.exhausted || is_grid) {
+			return;
+		}
+
+		// Start at the root
+		for (uint32_t i = 0; i < probe_count; i++) {
+			state.probe_stack.push_back(i);
+		}
+		state.frame_stack.push_back({UnsafeNumericCast<uint32_t>(box_array.size() - 1), 0, probe_count});
+	}
+
+	// Fill the matches vector with the next batch of (probe, row) pairs.
+	// Returns false if there are no more matches
+	bool Scan(FlatRTreeScanState &state) const {
+		if (state.exhausted) {
+			return false;
+		}
+		if (is_grid) {
+			return ScanGrid(state);
+		}
+
+		idx_t count = 0;
+		const auto ptr = FlatVector::GetData<data_ptr_t>(state.matches);
+
+		while (true) {
+			if (state.leaf_active) {
+				const auto &leaf = state.leaf;
+				const auto entry_end = std::min<size_t>(leaf.node_beg + node_size, UpperBound(leaf.node_beg));
+
+				while (state.probe_pos < leaf.probe_end) {
+					const auto probe_id = state.probe_ids[state.probe_stack[state.probe_pos]];
+					const auto hits = &state.leaf_hits[(state.probe_pos - leaf.probe_beg) * node_size];
+
+					while (state.entry_pos < entry_end) {
+						const auto entry_idx = state.entry_pos++;
+						if (!hits[entry_idx - leaf.node_beg]) {
+							continue;
+						}
+
+						ptr[count] = row_array[idx_array[entry_idx]];
+						state.matches_pos[count] = idx_array[entry_idx];
+						state.matches_sel.set_index(count, probe_id);
+						count++;
+
+						if (count == STANDARD_VECTOR_SIZE) {
+							// Yield!, there might be more rows
+							state.matches_count = count;
+							state.matches_idx = 0;
+							return true;
+						}
+					}
+
+					state.probe_pos++;
+					state.entry_pos = leaf.node_beg;
+				}
+
+				state.leaf_active = false;
+			}
+
+			if (state.frame_stack.empty()) {
+				// There are no more nodes to search
+				state.exhausted = true;
+				break;
+			}
+
+			const auto frame = state.frame_stack.back();
+			state.frame_stack.pop_back();
+			state.node_count++;
+
+			// The probes above this frame belong to frames we have already visited
+			state.probe_stack.resize(frame.probe_end);
+
+			// Test every probe of this frame against every entry of the node
+			const auto entry_end = std::min<size_t>(frame.node_beg + node_size, UpperBound(frame.node_beg));
+			const auto is_leaf = frame.node_beg < item_count;
+			auto &hits = is_leaf ? state.leaf_hits : state.node_hits;
+			hits.resize((frame.probe_end - frame.probe_beg) * node_size);
+			for (auto probe_idx = frame.probe_beg; probe_idx < frame.probe_end; probe_idx++) {
+				const auto &probe_box = state.probe_boxes[state.probe_stack[probe_idx]];
+				box_array.Intersects(probe_box, frame.node_beg, entry_end,
+				                     &hits[(probe_idx - frame.probe_beg) * node_size]);
+			}
+
+			if (is_leaf) {
+				// Leaf node, emit the matches
+				state.leaf = frame;
+				state.leaf_active = true;
+				state.entry_pos = frame.node_beg;
+				state.probe_pos = frame.probe_beg;
+				continue;
+			}
+
+			// Internal node, push the children along with the probes that intersect them
+			for (auto entry_idx = entry_end; entry_idx-- > frame.node_beg;) {
+				const auto child_beg = UnsafeNumericCast<uint32_t>(state.probe_stack.size());
+				const auto hit_idx = entry_idx - frame.node_beg;
+
+				for (auto probe_idx = frame.probe_beg; probe_idx < frame.probe_end; probe_idx++) {
+					if (hits[(probe_idx - frame.probe_beg) * node_size + hit_idx]) {
+						state.probe_stack.push_back(state.probe_stack[probe_idx]);
+					}
+				}
+
+				const auto child_end = UnsafeNumericCast<uint32_t>(state.probe_stack.size());
+				if (child_end != child_beg) {
+					state.frame_stack.push_back({idx_array[entry_idx], child_beg, child_end});
+				}
+			}
+		}
+
+		state.matches_count = count;
+		state.matches_idx = 0;
+		return count > 0;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Self Join
+	//------------------------------------------------------------------------------------------------------------------
+
+	// Split the self join of the tree into independent pairs of nodes, by expanding the intersecting pairs of nodes
+	// layer by layer until there are at least the given number of pairs, or we reach the leaves
+	vector<FlatRTreeNodePair> GetSelfJoinTasks(idx_t min_tasks, double expansion) const {
+		D_ASSERT(!is_grid);
+		vector<FlatRTreeNodePair> tasks;
+		if (item_count == 0) {
+			return tasks;
+		}
+
+		// The root is a single entry, pair it with itself
+		const auto root = UnsafeNumericCast<uint32_t>(box_array.size() - 1);
+		tasks.push_back({root, root});
+
+		vector<FlatRTreeNodePair> next_tasks;
+		vector<uint8_t> hits;
+		while (tasks.size() < min_tasks && !IsLeafNode(tasks[0].lhs_beg)) {
+			next_tasks.clear();
+			for (const auto &task : tasks) {
+				ExpandNodePair(task, expansion, hits, next_tasks);
+			}
+			std::swap(tasks, next_tasks);
+			if (tasks.empty()) {
+				break;
+			}
+		}
+		return tasks;
+	}
+
+	void InitSelfJoinScan(FlatRTreeSelfJoinState &state, const FlatRTreeNodePair &task) const {
+		state.pair_stack.clear();
+		state.pair_stack.push_back(task);
+		state.leaf_active = false;
+	}
+
+	// Fill lhs and rhs with the rows of the next (at most capacity) pairs of entries whose boxes intersect.
+	// Each unordered pair is emitted once, and every entry is paired with itself. Returns zero once exhausted.
+	idx_t SelfJoinScan(FlatRTreeSelfJoinState &state, data_ptr_t *lhs, data_ptr_t *rhs, idx_t capacity) const {
+		idx_t count = 0;
+
+		while (true) {
+			if (state.leaf_active) {
+				const auto &leaf = state.leaf;
+				const auto lhs_end = GetNodeEnd(leaf.lhs_beg);
+				const auto rhs_end = GetNodeEnd(leaf.rhs_beg);
+
+				while (state.lhs_pos < lhs_end) {
+					if (!state.hits_valid) {
+						// When joining a node with itself, only visit each unordered pair of entries once
+						state.hits_beg = leaf.lhs_beg == leaf.rhs_beg ? state.lhs_pos : leaf.rhs_beg;
+						state.leaf_hits.resize(node_size);
+						const auto box = ExpandBox(box_array.Get(state.lhs_pos), state.expansion);
+						box_array.Intersects(box, state.hits_beg, rhs_end, state.leaf_hits.data());
+						state.rhs_pos = state.hits_beg;
+						state.hits_valid = true;
+					}
+
+					const auto lhs_row = row_array[idx_array[state.lhs_pos]];
+					while (state.rhs_pos < rhs_end) {
+						const auto entry_idx = state.rhs_pos++;
+						if (!state.leaf_hits[entry_idx - state.hits_beg]) {
+							continue;
+						}
+
+						lhs[count] = lhs_row;
+						rhs[count] = row_array[idx_array[entry_idx]];
+						count++;
+
+						if (count == capacity) {
+							// Yield!, there might be more pairs
+							return count;
+						}
+					}
+
+					state.lhs_pos++;
+					state.hits_valid = false;
+				}
+
+				state.leaf_active = false;
+			}
+
+			if (state.pair_stack.empty()) {
+				// There are no more node pairs to visit
+				return count;
+			}
+
+			const auto pair = state.pair_stack.back();
+			state.pair_stack.pop_back();
+			state.node_count++;
+
+			if (IsLeafNode(pair.lhs_beg)) {
+				// Pair of leaf nodes, emit the intersecting entries
+				state.leaf = pair;
+				state.leaf_active = true;
+				state.lhs_pos = pair.lhs_beg;
+				state.hits_valid = false;
+				continue;
+			}
+
+			// Pair of internal nodes, push the pairs of children that intersect
+			ExpandNodePair(pair, state.expansion, state.node_hits, state.pair_stack);
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Grid
+	//------------------------------------------------------------------------------------------------------------------
+	// The grid splits the bounds of the entries into equally sized cells, with about GRID_ENTRIES_PER_CELL entries per
+	// cell on average. Each entry is stored in every cell its box overlaps, and the entries of each cell are stored
+	// contiguously and sorted by their min x, so a probe box only tests the entries of the cells it overlaps, up to the
+	// first entry that lies to the right of it (a plane sweep along x). Points fall into exactly one cell, so for
+	// uniformly dense points this is both faster to build and more cache-friendly to probe than the tree.
+	//
+	// A pair of boxes that overlap several of the same cells is found in each of them. To emit it only once, we use
+	// the reference point method: the pair is only emitted from the cell containing the lower-left corner of the
+	// intersection of the two boxes, which lies in exactly one of the cells they share.
+
+	static constexpr idx_t GRID_ENTRIES_PER_CELL = 8;
+	static constexpr uint32_t GRID_MAX_CELLS_PER_AXIS = 4096;
+	// Boxes that overlap many cells are copied into all of them. Make the cells coarser if there are more copies
+	static constexpr idx_t GRID_MAX_COPIES_PER_ENTRY = 4;
+
+	void BuildGrid() {
+		if (item_count == 0) {
+			return;
+		}
+
+		// Pick the number of cells along each axis, keeping the cells about as wide as they are high
+		const auto width = static_cast<double>(tree_box.max.x) - static_cast<double>(tree_box.min.x);
+		const auto height = static_cast<double>(tree_box.max.y) - static_cast<double>(tree_box.min.y);
+		const auto cell_count = MaxValue<double>(static_cast<double>(item_count) / GRID_ENTRIES_PER_CELL, 1);
+		double cells_x = 1;
+		double cells_y = 1;
+		if (width > 0 && height > 0) {
+			cells_x = std::sqrt(cell_count * width / height);
+			cells_y = cell_count / cells_x;
+		} else if (width > 0) {
+			cells_x = cell_count;
+		} else if (height > 0) {
+			cells_y = cell_count;
+		}
+		SetGridSize(cells_x, cells_y, width, height);
+
+		// Count the entries of each cell, making the cells coarser if the boxes are copied into too many of them
+		vector<uint32_t> offsets;
+		while (true) {
+			offsets.assign(static_cast<idx_t>(grid_size_x) * grid_size_y + 1, 0);
+			idx_t copy_count = 0;
+			for (idx_t i = 0; i < item_count; i++) {
+				const auto box = box_array.Get(i);
+				const auto x_beg = GetCellX(box.min.x);
+				const auto x_end = GetCellX(box.max.x) + 1;
+				const auto y_beg = GetCellY(box.min.y);
+				const auto y_end = GetCellY(box.max.y) + 1;
+				for (auto y = y_beg; y < y_end; y++) {
+					for (auto x = x_beg; x < x_end; x++) {
+						offsets[static_cast<idx_t>(y) * grid_size_x + x + 1]++;
+					}
+				}
+				copy_count += static_cast<idx_t>(x_end - x_beg) * (y_end - y_beg);
+			}
+			if (copy_count <= item_count * GRID_MAX_COPIES_PER_ENTRY || (grid_size_x == 1 && grid_size_y == 1)) {
+				break;
+			}
+			SetGridSize(grid_size_x / 2.0, grid_size_y / 2.0, width, height);
+		}
+
+		for (idx_t i = 1; i < offsets.size(); i++) {
+			offsets[i] += offsets[i - 1];
+		}
+		const auto copy_count = offsets.back();
+
+		cell_offsets_mem = alloc.Allocate(sizeof(uint32_t) * offsets.size());
+		cell_offsets.set(reinterpret_cast<uint32_t *>(cell_offsets_mem.get()), offsets.size());
+		std::copy(offsets.begin(), offsets.end(), cell_offsets.data());
+
+		// Scatter the insertion positions of the entries into their cells
+		cell_entries_mem = alloc.Allocate(sizeof(uint32_t) * copy_count);
+		cell_entries.set(reinterpret_cast<uint32_t *>(cell_entries_mem.get()), copy_count);
+		for (idx_t i = 0; i < item_count; i++) {
+			const auto box = box_array.Get(i);
+			const auto x_beg = GetCellX(box.min.x);
+			const auto x_end = GetCellX(box.max.x) + 1;
+			const auto y_beg = GetCellY(box.min.y);
+			const auto y_end = GetCellY(box.max.y) + 1;
+			for (auto y = y_beg; y < y_end; y++) {
+				for (auto x = x_beg; x < x_end; x++) {
+					cell_entries[offsets[static_cast<idx_t>(y) * grid_size_x + x]++] = UnsafeNumericCast<uint32_t>(i);
+				}
+			}
+		}
+
+		// Sort the entries of each cell by their min x, and copy their boxes next to each other
+		cell_boxes.Initialize(alloc, copy_count);
+		for (idx_t cell_idx = 0; cell_idx + 1 < cell_offsets.size(); cell_idx++) {
+			const auto beg = cell_entries.data() + cell_offsets[cell_idx];
+			const auto end = cell_entries.data() + cell_offsets[cell_idx + 1];
+			std::sort(beg, end, [&](uint32_t lhs, uint32_t rhs) {
+				return box_array.Get(lhs).min.x < box_array.Get(rhs).min.x;
+			});
+		}
+		for (idx_t i = 0; i < copy_count; i++) {
+			cell_boxes.Set(i, box_array.Get(cell_entries[i]));
+		}
+	}
+
+	// Fill the matches vector with the next batch of (probe, row) pairs from the grid.
+	// Returns false if there are no more matches
+	bool ScanGrid(FlatRTreeScanState &state) const {
+		idx_t count = 0;
+		const auto ptr = FlatVector::GetData<data_ptr_t>(state.matches);
+		const auto probe_count = state.probe_boxes.size();
+
+		while (state.probe_pos < probe_count) {
+			const auto &probe_box = state.probe_boxes[state.probe_pos];
+			const auto probe_id = state.probe_ids[state.probe_pos];
+
+			if (!state.cell_active) {
+				if (!tree_box.Intersects(probe_box)) {
+					state.probe_pos++;
+					continue;
+				}
+				// Start at the lower-left cell covered by the probe box
+				state.cell_min_x = GetCellX(probe_box.min.x);
+				state.cell_max_x = GetCellX(probe_box.max.x);
+				state.cell_max_y = GetCellY(probe_box.max.y);
+				state.cell_x = state.cell_min_x;
+				state.cell_y = GetCellY(probe_box.min.y);
+				state.cell_hits_valid = false;
+				state.cell_active = true;
+			}
+
+			while (state.cell_y <= state.cell_max_y) {
+				if (!state.cell_hits_valid) {
+					// Test the entries of the cell up to the first one that lies to the right of the probe box
+					const auto cell_idx = static_cast<idx_t>(state.cell_y) * grid_size_x + state.cell_x;
+					state.cell_beg = cell_offsets[cell_idx];
+					state.cell_end = cell_boxes.UpperBoundMinX(probe_box.max.x, state.cell_beg,
+					                                           cell_offsets[cell_idx + 1]);
+					state.leaf_hits.resize(state.cell_end - state.cell_beg);
+					cell_boxes.Intersects(probe_box, state.cell_beg, state.cell_end, state.leaf_hits.data());
+					state.entry_pos = state.cell_beg;
+					state.cell_hits_valid = true;
+					state.node_count++;
+				}
+
+				while (state.entry_pos < state.cell_end) {
+					const auto entry_idx = state.entry_pos++;
+					if (!state.leaf_hits[entry_idx - state.cell_beg]) {
+						continue;
+					}
+
+					// Only emit the pair from the cell that contains the reference point
+					const auto entry_box = cell_boxes.Get(entry_idx);
+					if (GetCellX(MaxValue(probe_box.min.x, entry_box.min.x)) != state.cell_x ||
+					    GetCellY(MaxValue(probe_box.min.y, entry_box.min.y)) != state.cell_y) {
+						continue;
+					}
+
+					const auto position = cell_entries[entry_idx];
+					ptr[count] = row_array[position];
+					state.matches_pos[count] = position;
+					state.matches_sel.set_index(count, probe_id);
+					count++;
+
+					if (count == STANDARD_VECTOR_SIZE) {
+						// Yield!, there might be more rows
+						state.matches_count = count;
+						state.matches_idx = 0;
+						return true;
+					}
+				}
+
+				// Move on to the next cell covered by the probe box
+				state.cell_hits_valid = false;
+				if (state.cell_x++ == state.cell_max_x) {
+					state.cell_x = state.cell_min_x;
+					state.cell_y++;
+				}
+			}
+
+			state.cell_active = false;
+			state.probe_pos++;
+		}
+
+		state.exhausted = true;
+		state.matches_count = count;
+		state.matches_idx = 0;
+		return count > 0;
+	}
+
+private:
+	void SetGridSize(double cells_x, double cells_y, double width, double height) {
+		grid_size_x = static_cast<uint32_t>(MinValue<double>(MaxValue<double>(std::ceil(cells_x), 1),
+		                                                     GRID_MAX_CELLS_PER_AXIS));
+		grid_size_y = static_cast<uint32_t>(MinValue<double>(MaxValue<double>(std::ceil(cells_y), 1),
+		                                                     GRID_MAX_CELLS_PER_AXIS));
+		grid_scale_x = width > 0 ? grid_size_x / width : 0;
+		grid_scale_y = height > 0 ? grid_size_y / height : 0;
+	}
+
+	// The column (or row) of the cell containing the coordinate, coordinates outside the grid are clamped to its edge
+	uint32_t GetCellX(float x) const {
+		return GetCell(x, tree_box.min.x, grid_scale_x, grid_size_x);
+	}
+
+	uint32_t GetCellY(float y) const {
+		return GetCell(y, tree_box.min.y, grid_scale_y, grid_size_y);
+	}
+
+	static uint32_t GetCell(float value, float min_value, double scale, uint32_t size) {
+		const auto cell = (static_cast<double>(value) - static_cast<double>(min_value)) * scale;
+		if (!(cell > 0)) {
+			return 0;
+		}
+		if (cell >= static_cast<double>(size - 1)) {
+			return size - 1;
+		}
+		return static_cast<uint32_t>(cell);
+	}
+
+	bool IsLeafNode(size_t node_beg) const {
+		return node_beg < item_count;
+	}
+
+	size_t GetNodeEnd(size_t node_beg) const {
+		return std::min<size_t>(node_beg + node_size, UpperBound(node_beg));
+	}
+
+	// Push the pairs of children of a pair of internal nodes whose boxes intersect
+	void ExpandNodePair(const FlatRTreeNodePair &pair, double expansion, vector<uint8_t> &hits,
+	                    vector<FlatRTreeNodePair> &result) const {
+		const auto lhs_end = GetNodeEnd(pair.lhs_beg);
+		const auto rhs_end = GetNodeEnd(pair.rhs_beg);
+		hits.resize(node_size);
+
+		for (size_t lhs_idx = pair.lhs_beg; lhs_idx < lhs_end; lhs_idx++) {
+			// When joining a node with itself, only visit each unordered pair of children once
+			const auto rhs_beg = pair.lhs_beg == pair.rhs_beg ? lhs_idx : pair.rhs_beg;
+			box_array.Intersects(ExpandBox(box_array.Get(lhs_idx), expansion), rhs_beg, rhs_end, hits.data());
+			for (auto rhs_idx = rhs_beg; rhs_idx < rhs_end; rhs_idx++) {
+				if (hits[rhs_idx - rhs_beg]) {
+					result.push_back({idx_array[lhs_idx], idx_array[rhs_idx]});
+				}
+			}
+		}
+	}
+
+private:
+	Allocator &alloc;
+
+	vector<uint32_t> layer_bounds;
+
+	AllocatedData idx_array_mem;
+	AllocatedData row_array_mem;
+
+	typed_view<uint32_t> idx_array;
+	FlatBoxArray box_array;
+	typed_view<data_ptr_t> row_array;
+
+	Box tree_box;
+
+	float curve_scale_x = 0;
+	float curve_scale_y = 0;
+
+	uint32_t item_count = 0;
+	uint32_t node_size = 0;
+	uint32_t current_position = 0;
+
+	// The cells of the grid, only used if the entries are put into a grid instead of a tree
+	bool is_grid = false;
+	uint32_t grid_size_x = 1;
+	uint32_t grid_size_y = 1;
+	double grid_scale_x = 0;
+	double grid_scale_y = 0;
+
+	AllocatedData cell_offsets_mem;
+	AllocatedData cell_entries_mem;
+
+	// The first entry of each cell (and the end of the last one), row by row
+	typed_view<uint32_t> cell_offsets;
+	// The insertion position and box of the entries of each cell, sorted by min x
+	typed_view<uint32_t> cell_entries;
+	FlatBoxArray cell_boxes;
+};
+
+// Pick the node size of the rtree from the number of items in it. Small trees are probed faster with small nodes, as
+// fewer entries are tested per visited node, while large trees benefit from wide nodes that keep the tree shallow.
+// We aim for a tree of at most four levels below the root, starting at 16 and doubling the node size up to 64, so up to
+// ~65k items use 16, up to ~1M items use 32 and anything larger uses 64.
+inline uint32_t GetRTreeNodeSize(idx_t item_count) {
+	static constexpr uint32_t RTREE_MIN_NODE_SIZE = 16;
+	static constexpr uint32_t RTREE_MAX_NODE_SIZE = 64;
+
+	auto node_size = RTREE_MIN_NODE_SIZE;
+	while (node_size < RTREE_MAX_NODE_SIZE) {
+		const auto capacity = static_cast<idx_t>(node_size) * node_size * node_size * node_size;
+		if (item_count <= capacity) {
+			break;
+		}
+		node_size *= 2;
+	}
+	return node_size;
+}
+
+} // namespace duckdb
@@ -5,19 +5,25 @@
 #include "duckdb.hpp"
 #include "index/rtree/rtree.hpp"
 #include "spatial/index/rtree/rtree_module.hpp"
+#include "spatial/modules/flatgeobuf/flatgeobuf_module.hpp"
 #include "spatial/modules/gdal/gdal_module.hpp"
+#include "spatial/modules/geojson/geojson_module.hpp"
 #if SPATIAL_USE_GEOS
 #include "spatial/modules/geos/geos_module.hpp"
 #endif
 #include "operators/spatial_operator_extension.hpp"
 #include "spatial/modules/main/spatial_functions.hpp"
+#include "spatial/modules/mvt/mvt_module.hpp"
 #include "spatial/modules/osm/osm_module.hpp"
 #include "spatial/modules/proj/proj_module.hpp"
 #include "spatial/modules/shapefile/shapefile_module.hpp"
+#include "spatial/operators/covering_filter_optimizer.hpp"
 #include "spatial/operators/spatial_operator_extension.hpp"
 #include "spatial/operators/spatial_join_optimizer.hpp"
 #include "spatial/spatial_geoarrow.hpp"
 #include "spatial/spatial_types.hpp"
+#include "spatial/util/scratch_pool.hpp"
+#include "spatial/util/spatial_profiler.hpp"
 
 namespace duckdb {
 
@@ -25,26 +31,36 @@ static void LoadInternal(DatabaseInstance &instance) {
 
 	// Register the types
 	GeoTypes::Register(instance);
+	GeometryScratchPool::Register(instance);
+	SpatialProfiler::Register(instance);
 
 	RegisterSpatialCastFunctions(instance);
 	RegisterSpatialScalarFunctions(instance);
 	RegisterSpatialAggregateFunctions(instance);
 	RegisterSpatialTableFunctions(instance);
+
+	// The ST_Transform filter pushdown of the PROJ module has to run before the other optimizers
+	RegisterProjModule(instance);
+
 	SpatialJoinOptimizer::Register(instance);
+	CoveringFilterOptimizer::Register(instance);
 	GeoArrow::Register(instance);
 
-	RegisterProjModule(instance);
 	RegisterGDALModule(instance);
 #if SPATIAL_USE_GEOS
 	RegisterGEOSModule(instance);
 #endif
 	RegisterOSMModule(instance);
 	RegisterShapefileModule(instance);
+	RegisterFlatGeobufModule(instance);
+	RegisterGeoJSONModule(instance);
+	RegisterMVTModule(instance);
 
 	RTreeModule::RegisterIndex(instance);
 	RTreeModule::RegisterIndexPragmas(instance);
 	RTreeModule::RegisterIndexScan(instance);
 	RTreeModule::RegisterIndexPlanScan(instance);
+	RTreeModule::RegisterIndexPlanExtent(instance);
 
 	RegisterSpatialOperatorExtension(instance);
 	;
@@ -17,30 +17,44 @@ namespace duckdb {
 
 namespace {
 
-struct GeoArrowWKB {
-	static unique_ptr<ArrowType> GetType(const ArrowSchema &schema, const ArrowSchemaMetadata &schema_metadata) {
-		// Validate extension metadata. This metadata also contains a CRS, which we drop
-		// because the GEOMETRY type does not implement a CRS at the type level.
-		string extension_metadata = schema_metadata.GetOption(ArrowSchemaMetadata::ARROW_METADATA_KEY);
-		if (!extension_metadata.empty()) {
-			using namespace duckdb_yyjson_spatial;
-
-			unique_ptr<yyjson_doc, void (*)(yyjson_doc *)> doc(
-			    yyjson_read(extension_metadata.data(), extension_metadata.size(), YYJSON_READ_NOFLAG), yyjson_doc_free);
-			if (!doc) {
-				throw SerializationException("Invalid JSON in GeoArrow metadata");
-			}
+//! Validate GeoArrow extension metadata. This metadata also contains a CRS, which we drop
+//! because the geometry types do not implement a CRS at the type level.
+void ValidateMetadata(const ArrowSchemaMetadata &schema_metadata) {
+	string extension_metadata = schema_metadata.GetOption(ArrowSchemaMetadata::ARROW_METADATA_KEY);
+	if (extension_metadata.empty()) {
+		return;
+	}
 
-			yyjson_val *val = yyjson_doc_get_root(doc.get());
-			if (!yyjson_is_obj(val)) {
-				throw SerializationException("Invalid GeoArrow metadata: not a JSON object");
-			}
+	using namespace duckdb_yyjson_spatial;
 
-			yyjson_val *edges = yyjson_obj_get(val, "edges");
-			if (edges && yyjson_is_str(edges) && std::strcmp(yyjson_get_str(edges), "planar") != 0) {
-				throw NotImplementedException("Can't import non-planar edges");
-			}
-		}
+	unique_ptr<yyjson_doc, void (*)(yyjson_doc *)> doc(
+	    yyjson_read(extension_metadata.data(), extension_metadata.size(), YYJSON_READ_NOFLAG), yyjson_doc_free);
+	if (!doc) {
+		throw SerializationException("Invalid JSON in GeoArrow metadata");
+	}
+
+	yyjson_val *val = yyjson_doc_get_root(doc.get());
+	if (!yyjson_is_obj(val)) {
+		throw SerializationException("Invalid GeoArrow metadata: not a JSON object");
+	}
+
+	yyjson_val *edges = yyjson_obj_get(val, "edges");
+	if (edges && yyjson_is_str(edges) && std::strcmp(yyjson_get_str(edges), "planar") != 0) {
+		throw NotImplementedException("Can't import non-planar edges");
+	}
+}
+
+string_t SerializeGeometry(Vector &result, const sgl::geometry &geom) {
+	const auto size = Serde::GetRequiredSize(geom);
+	auto blob = StringVector::EmptyString(result, size);
+	Serde::Serialize(geom, blob.GetDataWriteable(), size);
+	blob.Finalize();
+	return blob;
+}
+
+struct GeoArrowWKB {
+	static unique_ptr<ArrowType> GetType(const ArrowSchema &schema, const ArrowSchemaMetadata &schema_metadata) {
+		ValidateMetadata(schema_metadata);
 
 		const auto format = string(schema.format);
 		if (format == "z") {
@@ -90,6 +104,12 @@ struct GeoArrowWKB {
 
 		UnaryExecutor::ExecuteWithNulls<string_t, string_t>(
 		    source, result, count, [&](const string_t &wkb, ValidityMask &mask, idx_t idx) {
+			    // Arrays from other producers are nearly always little-endian WKB, so try copying it before parsing
+			    string_t blob;
+			    if (Serde::TryFromWKB(wkb.GetDataUnsafe(), wkb.GetSize(), true, result, blob)) {
+				    return blob;
+			    }
+
 			    reader.buf = wkb.GetDataUnsafe();
 			    reader.end = reader.buf + wkb.GetSize();
 
@@ -105,26 +125,393 @@ struct GeoArrowWKB {
 			    }
 
 			    // Serialize the geometry to the result blob
-			    const auto size = Serde::GetRequiredSize(geom);
-			    auto blob = StringVector::EmptyString(result, size);
-			    Serde::Serialize(geom, blob.GetDataWriteable(), size);
-			    blob.Finalize();
-			    return blob;
+			    return SerializeGeometry(result, geom);
 		    });
 	}
 
 	static void DuckToArrow(ClientContext &context, Vector &source, Vector &result, idx_t count) {
-		WKBWriter writer;
-		UnaryExecutor::Execute<geometry_t, string_t>(
-		    source, result, count, [&](const geometry_t &input) { return writer.Write(input, result); });
+		WKBWriter::Write(source, result, count);
+	}
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Native GeoArrow encodings
+//----------------------------------------------------------------------------------------------------------------------
+// The native encodings store geometries as nested lists of coordinates. We support the separated coordinate layout
+// (a struct of x/y doubles), which is also how POINT_2D, LINESTRING_2D and POLYGON_2D are stored, so those types are
+// handed to and from Arrow as they are. The multi-geometries have no native equivalent and are imported as GEOMETRY.
+
+//! The number of list levels above the coordinates
+constexpr idx_t GetNestingDepth(const sgl::geometry_type type) {
+	return type == sgl::geometry_type::POINT             ? 0
+	       : type == sgl::geometry_type::LINESTRING       ? 1
+	       : type == sgl::geometry_type::POLYGON          ? 2
+	       : type == sgl::geometry_type::MULTI_POINT      ? 1
+	       : type == sgl::geometry_type::MULTI_LINESTRING ? 2
+	                                                      : 3;
+}
+
+//! The name of the list child at the given level, as recommended by the GeoArrow specification
+const char *GetChildName(const sgl::geometry_type type, const idx_t level) {
+	switch (type) {
+	case sgl::geometry_type::LINESTRING:
+		return "vertices";
+	case sgl::geometry_type::POLYGON:
+		return level == 0 ? "rings" : "vertices";
+	case sgl::geometry_type::MULTI_POINT:
+		return "points";
+	case sgl::geometry_type::MULTI_LINESTRING:
+		return level == 0 ? "linestrings" : "vertices";
+	case sgl::geometry_type::MULTI_POLYGON:
+		return level == 0 ? "polygons" : level == 1 ? "rings" : "vertices";
+	default:
+		throw InternalException("Unsupported GeoArrow geometry type");
+	}
+}
+
+LogicalType GetNestedType(const idx_t depth) {
+	if (depth == 0) {
+		return LogicalType::STRUCT({{"x", LogicalType::DOUBLE}, {"y", LogicalType::DOUBLE}});
+	}
+	return LogicalType::LIST(GetNestedType(depth - 1));
+}
+
+//! Build the arrow type for the coordinates or list level of a native GeoArrow array
+unique_ptr<ArrowType> GetNestedArrowType(const ArrowSchema &schema, const LogicalType &type, const idx_t depth) {
+	const auto format = string(schema.format);
+	if (depth == 0) {
+		if (format != "+s") {
+			throw NotImplementedException(
+			    "Can't import GeoArrow coordinates with format \"%s\", only separated (struct) coordinates are supported",
+			    format.c_str());
+		}
+		if (schema.n_children != 2) {
+			throw NotImplementedException("Can't import GeoArrow coordinates with %lld dimensions, only xy coordinates "
+			                              "are supported",
+			                              schema.n_children);
+		}
+		vector<unique_ptr<ArrowType>> children;
+		for (int64_t i = 0; i < schema.n_children; i++) {
+			if (string(schema.children[i]->format) != "g") {
+				throw InvalidInputException("GeoArrow coordinates must be doubles, got format \"%s\"",
+				                            schema.children[i]->format);
+			}
+			children.push_back(make_uniq<ArrowType>(LogicalType::DOUBLE));
+		}
+		return make_uniq<ArrowType>(type, make_uniq<ArrowStructInfo>(std::move(children)));
+	}
+
+	ArrowVariableSizeType size_type;
+	if (format == "+l") {
+		size_type = ArrowVariableSizeType::NORMAL;
+	} else if (format == "+L") {
+		size_type = ArrowVariableSizeType::SUPER_SIZE;
+	} else {
+		throw InvalidInputException("Expected a list in the native GeoArrow encoding, got format \"%s\"",
+		                            format.c_str());
+	}
+	if (schema.n_children != 1) {
+		throw InvalidInputException("Invalid native GeoArrow list: expected a single child");
+	}
+	auto child = GetNestedArrowType(*schema.children[0], GetNestedType(depth - 1), depth - 1);
+	return make_uniq<ArrowType>(type, ArrowListInfo::List(std::move(child), size_type));
+}
+
+void ReleaseNestedSchema(ArrowSchema *schema) {
+	// The nested schemas are owned by the root schema holder
+	if (schema) {
+		schema->release = nullptr;
+	}
+}
+
+//! Allocate the child schemas of a nested schema in the root schema holder
+vector<ArrowSchema> &InitializeChildSchemas(DuckDBArrowSchemaHolder &root_holder, ArrowSchema &schema,
+                                            const idx_t child_count) {
+	root_holder.nested_children.emplace_back();
+	auto &children = root_holder.nested_children.back();
+	children.resize(child_count);
+
+	root_holder.nested_children_ptr.emplace_back();
+	auto &children_ptrs = root_holder.nested_children_ptr.back();
+	children_ptrs.resize(child_count);
+
+	for (idx_t i = 0; i < child_count; i++) {
+		auto &child = children[i];
+		child.private_data = nullptr;
+		child.release = ReleaseNestedSchema;
+		child.flags = ARROW_FLAG_NULLABLE;
+		child.metadata = nullptr;
+		child.n_children = 0;
+		child.children = nullptr;
+		child.dictionary = nullptr;
+		children_ptrs[i] = &child;
+	}
+
+	schema.n_children = static_cast<int64_t>(child_count);
+	schema.children = children_ptrs.data();
+	return children;
+}
+
+void PopulateNestedSchema(DuckDBArrowSchemaHolder &root_holder, ArrowSchema &schema, const sgl::geometry_type type,
+                          const idx_t level, const char *list_format) {
+	const auto depth = GetNestingDepth(type);
+	const auto is_coords = level == depth;
+	auto &children = InitializeChildSchemas(root_holder, schema, is_coords ? 2 : 1);
+
+	if (is_coords) {
+		schema.format = "+s";
+		children[0].name = "x";
+		children[0].format = "g";
+		children[1].name = "y";
+		children[1].format = "g";
+	} else {
+		schema.format = list_format;
+		children[0].name = GetChildName(type, level);
+		PopulateNestedSchema(root_holder, children[0], type, level + 1, list_format);
+	}
+}
+
+//! Assembles geometries from the flattened list levels and coordinates of a native GeoArrow array
+class NativeGeometryReader {
+public:
+	NativeGeometryReader(ArenaAllocator &arena, Vector &source, const idx_t depth) : arena(arena) {
+		reference<Vector> vec = source;
+		for (idx_t level = 0; level < depth; level++) {
+			if (level > 0) {
+				level_entries[level - 1] = ListVector::GetData(vec.get());
+			}
+			vec = ListVector::GetEntry(vec.get());
+		}
+		auto &coord_children = StructVector::GetEntries(vec.get());
+		x_data = FlatVector::GetData<double>(*coord_children[0]);
+		y_data = FlatVector::GetData<double>(*coord_children[1]);
+	}
+
+	void ReadPoint(sgl::geometry &geom, const idx_t idx) {
+		// Empty points are encoded as NaN coordinates
+		if (std::isnan(x_data[idx]) && std::isnan(y_data[idx])) {
+			return;
+		}
+		ReadVertices(geom, list_entry_t(idx, 1));
+	}
+
+	void Read(sgl::geometry &geom, const list_entry_t &entry) {
+		switch (geom.get_type()) {
+		case sgl::geometry_type::LINESTRING:
+			ReadVertices(geom, entry);
+			break;
+		case sgl::geometry_type::POLYGON:
+			ReadPolygon(geom, entry, level_entries[0]);
+			break;
+		case sgl::geometry_type::MULTI_POINT:
+			for (idx_t i = 0; i < entry.length; i++) {
+				auto &part = MakePart(sgl::geometry_type::POINT);
+				ReadPoint(part, entry.offset + i);
+				geom.append_part(&part);
+			}
+			break;
+		case sgl::geometry_type::MULTI_LINESTRING:
+			for (idx_t i = 0; i < entry.length; i++) {
+				auto &part = MakePart(sgl::geometry_type::LINESTRING);
+				ReadVertices(part, level_entries[0][entry.offset + i]);
+				geom.append_part(&part);
+			}
+			break;
+		case sgl::geometry_type::MULTI_POLYGON:
+			for (idx_t i = 0; i < entry.length; i++) {
+				auto &part = MakePart(sgl::geometry_type::POLYGON);
+				ReadPolygon(part, level_entries[0][entry.offset + i], level_entries[1]);
+				geom.append_part(&part);
+			}
+			break;
+		default:
+			throw InternalException("Unsupported GeoArrow geometry type");
+		}
+	}
+
+private:
+	sgl::geometry &MakePart(const sgl::geometry_type type) {
+		const auto mem = arena.AllocateAligned(sizeof(sgl::geometry));
+		return *new (mem) sgl::geometry(type);
+	}
+
+	void ReadVertices(sgl::geometry &geom, const list_entry_t &entry) {
+		// The coordinates are separated in arrow, but interleaved in the geometry
+		const auto vertex_data_mem = arena.AllocateAligned(sizeof(double) * 2 * entry.length);
+		const auto vertex_data_ptr = reinterpret_cast<double *>(vertex_data_mem);
+		for (idx_t i = 0; i < entry.length; i++) {
+			vertex_data_ptr[i * 2] = x_data[entry.offset + i];
+			vertex_data_ptr[i * 2 + 1] = y_data[entry.offset + i];
+		}
+		geom.set_vertex_data(vertex_data_mem, UnsafeNumericCast<uint32_t>(entry.length));
+	}
+
+	void ReadPolygon(sgl::geometry &geom, const list_entry_t &entry, const list_entry_t *ring_entries) {
+		for (idx_t i = 0; i < entry.length; i++) {
+			auto &ring = MakePart(sgl::geometry_type::LINESTRING);
+			ReadVertices(ring, ring_entries[entry.offset + i]);
+			geom.append_part(&ring);
+		}
+	}
+
+private:
+	ArenaAllocator &arena;
+	const double *x_data = nullptr;
+	const double *y_data = nullptr;
+	//! The list entries of each level below the top level
+	const list_entry_t *level_entries[2] = {nullptr, nullptr};
+};
+
+template <sgl::geometry_type TYPE>
+struct GeoArrowNative {
+	static constexpr auto DEPTH = GetNestingDepth(TYPE);
+
+	static const char *GetExtensionName() {
+		switch (TYPE) {
+		case sgl::geometry_type::POINT:
+			return "geoarrow.point";
+		case sgl::geometry_type::LINESTRING:
+			return "geoarrow.linestring";
+		case sgl::geometry_type::POLYGON:
+			return "geoarrow.polygon";
+		case sgl::geometry_type::MULTI_POINT:
+			return "geoarrow.multipoint";
+		case sgl::geometry_type::MULTI_LINESTRING:
+			return "geoarrow.multilinestring";
+		default:
+			return "geoarrow.multipolygon";
+		}
+	}
+
+	//! The type the extension is imported as and exported from
+	static LogicalType GetDuckDBType() {
+		switch (TYPE) {
+		case sgl::geometry_type::POINT:
+			return GeoTypes::POINT_2D();
+		case sgl::geometry_type::LINESTRING:
+			return GeoTypes::LINESTRING_2D();
+		case sgl::geometry_type::POLYGON:
+			return GeoTypes::POLYGON_2D();
+		default:
+			return GeoTypes::GEOMETRY();
+		}
+	}
+
+	static unique_ptr<ArrowType> GetType(const ArrowSchema &schema, const ArrowSchemaMetadata &schema_metadata) {
+		ValidateMetadata(schema_metadata);
+		return GetNestedArrowType(schema, GetDuckDBType(), DEPTH);
+	}
+
+	static void PopulateSchema(DuckDBArrowSchemaHolder &root_holder, ArrowSchema &schema, const LogicalType &type,
+	                           ClientContext &context, const ArrowTypeExtension &extension) {
+		ArrowSchemaMetadata schema_metadata;
+		schema_metadata.AddOption(ArrowSchemaMetadata::ARROW_EXTENSION_NAME, GetExtensionName());
+		schema_metadata.AddOption(ArrowSchemaMetadata::ARROW_METADATA_KEY, "{}");
+		root_holder.metadata_info.emplace_back(schema_metadata.SerializeMetadata());
+		schema.metadata = root_holder.metadata_info.back().get();
+
+		const auto options = context.GetClientProperties();
+		const auto list_format = options.arrow_offset_size == ArrowOffsetSize::LARGE ? "+L" : "+l";
+		PopulateNestedSchema(root_holder, schema, TYPE, 0, list_format);
+	}
+
+	//! The native types already have the GeoArrow layout, so they are passed through as they are
+	static void Passthrough(ClientContext &context, Vector &source, Vector &result, idx_t count) {
+		result.Reference(source);
+	}
+
+	//! The multi-geometries are assembled directly from the coordinates, without going through WKB
+	static void ArrowToGeometry(ClientContext &context, Vector &source, Vector &result, idx_t count) {
+		ArenaAllocator arena(Allocator::Get(context));
+
+		source.Flatten(count);
+		NativeGeometryReader reader(arena, source, DEPTH);
+
+		UnaryExecutor::Execute<list_entry_t, string_t>(source, result, count, [&](const list_entry_t &entry) {
+			sgl::geometry geom(TYPE, false, false);
+			reader.Read(geom, entry);
+			return SerializeGeometry(result, geom);
+		});
+	}
+
+	static ArrowTypeExtension GetExtension() {
+		const auto duckdb_type = GetDuckDBType();
+		const auto internal_type = duckdb_type.id() == LogicalTypeId::BLOB ? GetNestedType(DEPTH) : duckdb_type;
+		const auto arrow_to_duck = duckdb_type.id() == LogicalTypeId::BLOB ? ArrowToGeometry : Passthrough;
+		// GEOMETRY is always exported as WKB, as a column can contain any mix of geometry types
+		const auto duck_to_arrow = duckdb_type.id() == LogicalTypeId::BLOB ? nullptr : Passthrough;
+		return ArrowTypeExtension(
+		    GetExtensionName(), PopulateSchema, GetType,
+		    make_shared_ptr<ArrowTypeExtensionData>(duckdb_type, internal_type, arrow_to_duck, duck_to_arrow));
+	}
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// GeoArrow box
+//----------------------------------------------------------------------------------------------------------------------
+// BOX_2D has the geoarrow.box layout (a struct of four doubles), only the field names differ.
+
+struct GeoArrowBox {
+	static unique_ptr<ArrowType> GetType(const ArrowSchema &schema, const ArrowSchemaMetadata &schema_metadata) {
+		ValidateMetadata(schema_metadata);
+
+		const auto format = string(schema.format);
+		if (format != "+s" || schema.n_children != 4) {
+			throw NotImplementedException("Can't import geoarrow.box with format \"%s\", only 2D boxes are supported",
+			                              format.c_str());
+		}
+		vector<unique_ptr<ArrowType>> children;
+		for (int64_t i = 0; i < schema.n_children; i++) {
+			if (string(schema.children[i]->format) != "g") {
+				throw InvalidInputException("geoarrow.box bounds must be doubles, got format \"%s\"",
+				                            schema.children[i]->format);
+			}
+			children.push_back(make_uniq<ArrowType>(LogicalType::DOUBLE));
+		}
+		return make_uniq<ArrowType>(GeoTypes::BOX_2D(), make_uniq<ArrowStructInfo>(std::move(children)));
+	}
+
+	static void PopulateSchema(DuckDBArrowSchemaHolder &root_holder, ArrowSchema &schema, const LogicalType &type,
+	                           ClientContext &context, const ArrowTypeExtension &extension) {
+		ArrowSchemaMetadata schema_metadata;
+		schema_metadata.AddOption(ArrowSchemaMetadata::ARROW_EXTENSION_NAME, "geoarrow.box");
+		schema_metadata.AddOption(ArrowSchemaMetadata::ARROW_METADATA_KEY, "{}");
+		root_holder.metadata_info.emplace_back(schema_metadata.SerializeMetadata());
+		schema.metadata = root_holder.metadata_info.back().get();
+
+		static const char *field_names[] = {"xmin", "ymin", "xmax", "ymax"};
+
+		schema.format = "+s";
+		auto &children = InitializeChildSchemas(root_holder, schema, 4);
+		for (idx_t i = 0; i < 4; i++) {
+			children[i].name = field_names[i];
+			children[i].format = "g";
+		}
+	}
+
+	static void Passthrough(ClientContext &context, Vector &source, Vector &result, idx_t count) {
+		result.Reference(source);
 	}
 };
 
 void RegisterArrowExtensions(DBConfig &config) {
+	// GEOMETRY is exported through the first extension registered for it, so register geoarrow.wkb first
 	config.RegisterArrowExtension(
 	    {"geoarrow.wkb", GeoArrowWKB::PopulateSchema, GeoArrowWKB::GetType,
 	     make_shared_ptr<ArrowTypeExtensionData>(GeoTypes::GEOMETRY(), LogicalType::BLOB, GeoArrowWKB::ArrowToDuck,
 	                                             GeoArrowWKB::DuckToArrow)});
+
+	config.RegisterArrowExtension(GeoArrowNative<sgl::geometry_type::POINT>::GetExtension());
+	config.RegisterArrowExtension(GeoArrowNative<sgl::geometry_type::LINESTRING>::GetExtension());
+	config.RegisterArrowExtension(GeoArrowNative<sgl::geometry_type::POLYGON>::GetExtension());
+	config.RegisterArrowExtension(GeoArrowNative<sgl::geometry_type::MULTI_POINT>::GetExtension());
+	config.RegisterArrowExtension(GeoArrowNative<sgl::geometry_type::MULTI_LINESTRING>::GetExtension());
+	config.RegisterArrowExtension(GeoArrowNative<sgl::geometry_type::MULTI_POLYGON>::GetExtension());
+
+	config.RegisterArrowExtension({"geoarrow.box", GeoArrowBox::PopulateSchema, GeoArrowBox::GetType,
+	                               make_shared_ptr<ArrowTypeExtensionData>(GeoTypes::BOX_2D(), GeoTypes::BOX_2D(),
+	                                                                       GeoArrowBox::Passthrough,
+	                                                                       GeoArrowBox::Passthrough)});
 }
 
 class GeoArrowRegisterFunctionData final : public TableFunctionData {
@@ -68,6 +68,12 @@ LogicalType GeoTypes::WKB_BLOB() {
 	return blob_type;
 }
 
+LogicalType GeoTypes::COMPRESSED_GEOMETRY() {
+	auto blob_type = LogicalType(LogicalTypeId::BLOB);
+	blob_type.SetAlias("COMPRESSED_GEOMETRY");
+	return blob_type;
+}
+
 LogicalType GeoTypes::CreateEnumType(const string &name, const vector<string> &members) {
 	auto varchar_vector = Vector(LogicalType::VARCHAR, members.size());
 	auto varchar_data = FlatVector::GetData<string_t>(varchar_vector);
@@ -108,6 +114,9 @@ void GeoTypes::Register(DatabaseInstance &db) {
 
 	// WKB_BLOB
 	ExtensionUtil::RegisterType(db, "WKB_BLOB", GeoTypes::WKB_BLOB());
+
+	// COMPRESSED_GEOMETRY
+	ExtensionUtil::RegisterType(db, "COMPRESSED_GEOMETRY", GeoTypes::COMPRESSED_GEOMETRY());
 }
 
 } // namespace duckdb
\ No newline at end of file
@@ -18,6 +18,7 @@ struct GeoTypes {
 	static LogicalType BOX_2DF();
 	static LogicalType GEOMETRY();
 	static LogicalType WKB_BLOB();
+	static LogicalType COMPRESSED_GEOMETRY();
 
 	static void Register(DatabaseInstance &db);
 
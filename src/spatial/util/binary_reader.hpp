@@ -64,6 +64,10 @@ public:
 		return end;
 	}
 
+	const char *GetPtr() const {
+		return ptr;
+	}
+
 private:
 	void CheckSize(const size_t size) const {
 		if (ptr + size > end) {
@@ -52,6 +52,10 @@ public:
 		return end;
 	}
 
+	char *GetPtr() const {
+		return ptr;
+	}
+
 private:
 	void CheckSize(const size_t size) const {
 		if (ptr + size > end) {
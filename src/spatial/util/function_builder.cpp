@@ -58,6 +58,71 @@ string FunctionBuilder::RemoveIndentAndTrailingWhitespace(const char *ptr) {
 	return result;
 }
 
+bool FunctionBuilder::TryExecuteDictionary(const scalar_function_t &function, DataChunk &args, ExpressionState &state,
+                                           Vector &result) {
+	// Only execute on the dictionary if it is referenced at least this many times per entry
+	static constexpr idx_t DICTIONARY_THRESHOLD = 2;
+
+	const auto count = args.size();
+
+	// Find the dictionary argument, all other arguments have to be constant
+	optional_idx dict_idx;
+	for (idx_t i = 0; i < args.ColumnCount(); i++) {
+		const auto vector_type = args.data[i].GetVectorType();
+		if (vector_type == VectorType::CONSTANT_VECTOR) {
+			continue;
+		}
+		if (vector_type != VectorType::DICTIONARY_VECTOR || dict_idx.IsValid()) {
+			return false;
+		}
+		dict_idx = i;
+	}
+	if (!dict_idx.IsValid()) {
+		return false;
+	}
+
+	auto &input = args.data[dict_idx.GetIndex()];
+	const auto dict_size = DictionaryVector::DictionarySize(input);
+	if (!dict_size.IsValid() || dict_size.GetIndex() * DICTIONARY_THRESHOLD > count) {
+		return false;
+	}
+
+	// Only execute the referenced entries, unreferenced entries could be invalid input and raise errors
+	const auto &input_sel = DictionaryVector::SelVector(input);
+	vector<idx_t> dict_to_entry(dict_size.GetIndex(), DConstants::INVALID_INDEX);
+	SelectionVector entry_sel(count);
+	SelectionVector result_sel(count);
+	idx_t entry_count = 0;
+	for (idx_t i = 0; i < count; i++) {
+		const auto dict_row = input_sel.get_index(i);
+		auto &entry = dict_to_entry[dict_row];
+		if (entry == DConstants::INVALID_INDEX) {
+			entry = entry_count;
+			entry_sel.set_index(entry_count++, dict_row);
+		}
+		result_sel.set_index(i, entry);
+	}
+
+	DataChunk entries;
+	entries.InitializeEmpty(args.GetTypes());
+	for (idx_t i = 0; i < args.ColumnCount(); i++) {
+		if (i == dict_idx.GetIndex()) {
+			entries.data[i].Slice(DictionaryVector::Child(input), entry_sel, entry_count);
+			entries.data[i].Flatten(entry_count);
+		} else {
+			entries.data[i].Reference(args.data[i]);
+		}
+	}
+	entries.SetCardinality(entry_count);
+
+	Vector entry_result(result.GetType(), entry_count);
+	function(entries, state, entry_result);
+
+	// Reference the result of each entry from the rows
+	result.Slice(entry_result, result_sel, count);
+	return true;
+}
+
 void FunctionBuilder::Register(DatabaseInstance &db, const char *name, ScalarFunctionBuilder &builder) {
 	// Register the function
 	ExtensionUtil::RegisterFunction(db, std::move(builder.set));
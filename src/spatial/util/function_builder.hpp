@@ -35,6 +35,11 @@ public:
 
 	static string RemoveIndentAndTrailingWhitespace(const char *str);
 
+	//! Execute a scalar function whose only non-constant argument is a dictionary vector once per referenced dictionary
+	//! entry, and emit a dictionary vector. Returns false if the input is not worth it, without executing anything.
+	static bool TryExecuteDictionary(const scalar_function_t &function, DataChunk &args, ExpressionState &state,
+	                                 Vector &result);
+
 private:
 	static void Register(DatabaseInstance &db, const char *name, ScalarFunctionBuilder &builder);
 	static void Register(DatabaseInstance &db, const char *name, AggregateFunctionBuilder &builder);
@@ -54,6 +59,7 @@ public:
 	void SetFunction(scalar_function_t fn);
 	void SetInit(init_local_state_t init);
 	void SetBind(bind_scalar_function_t bind);
+	void SetStatistics(function_statistics_t statistics);
 	void SetDescription(const string &desc);
 	void SetExample(const string &ex);
 
@@ -87,6 +93,10 @@ inline void ScalarFunctionVariantBuilder::SetBind(bind_scalar_function_t bind) {
 	function.bind = bind;
 }
 
+inline void ScalarFunctionVariantBuilder::SetStatistics(function_statistics_t statistics) {
+	function.statistics = statistics;
+}
+
 inline void ScalarFunctionVariantBuilder::SetDescription(const string &desc) {
 	description.description = desc;
 }
@@ -145,6 +155,16 @@ void ScalarFunctionBuilder::AddVariant(CALLBACK &&callback) {
 		throw InternalException("Return type not set in ScalarFunctionBuilder::AddVariant");
 	}
 
+	// Execute dictionary encoded input (e.g. a few distinct geometries referenced by many rows) once per entry
+	if (builder.function.function && builder.function.stability != FunctionStability::VOLATILE) {
+		auto function = std::move(builder.function.function);
+		builder.function.function = [function](DataChunk &args, ExpressionState &state, Vector &result) {
+			if (!FunctionBuilder::TryExecuteDictionary(function, args, state, result)) {
+				function(args, state, result);
+			}
+		};
+	}
+
 	// Add the new variant to the set
 	set.AddFunction(std::move(builder.function));
 
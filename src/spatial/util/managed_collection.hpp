@@ -54,10 +54,18 @@ public:
 
 	T Fetch(idx_t idx);
 
+	// Pin a block for reading, returning the handle and the number of items written to it.
+	// The items are stored contiguously at the start of the block.
+	BufferHandle PinBlock(idx_t block_idx, idx_t &item_count);
+
 	idx_t Count() const {
 		return size;
 	}
 
+	idx_t BlockCount() const {
+		return blocks.size();
+	}
+
 	void Clear() {
 		blocks.clear();
 		size = 0;
@@ -222,4 +230,11 @@ T ManagedCollection<T>::Fetch(idx_t idx) {
 	return Load<T>(ptr);
 }
 
+template <class T>
+BufferHandle ManagedCollection<T>::PinBlock(idx_t block_idx, idx_t &item_count) {
+	auto &block = blocks[block_idx];
+	item_count = block.item_count;
+	return manager.Pin(block.handle);
+}
+
 } // namespace duckdb
\ No newline at end of file
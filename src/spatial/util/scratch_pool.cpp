@@ -0,0 +1,164 @@
+#include "spatial/util/scratch_pool.hpp"
+
+#include "duckdb/common/numeric_utils.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+namespace duckdb {
+
+namespace {
+
+struct ScratchPoolAllocatorData final : PrivateAllocatorData {
+	explicit ScratchPoolAllocatorData(GeometryScratchPool &pool_p) : pool(pool_p) {
+	}
+	GeometryScratchPool &pool;
+};
+
+// The size class of a block, i.e. log2 of its size rounded up to a power of two, relative to MIN_BLOCK_SIZE
+idx_t GetSizeClass(idx_t size) {
+	idx_t size_class = 0;
+	while ((GeometryScratchPool::MIN_BLOCK_SIZE << size_class) < size) {
+		size_class++;
+	}
+	return size_class;
+}
+
+idx_t GetClassSize(idx_t size_class) {
+	return GeometryScratchPool::MIN_BLOCK_SIZE << size_class;
+}
+
+} // namespace
+
+GeometryScratchPool::GeometryScratchPool(Allocator &backing_p)
+    : backing(backing_p),
+      allocator(AllocateBlock, FreeBlock, ReallocateBlock, make_uniq<ScratchPoolAllocatorData>(*this)),
+      capacity(DEFAULT_CAPACITY) {
+}
+
+GeometryScratchPool::~GeometryScratchPool() {
+	for (auto &shard : shards) {
+		Shrink(shard, 0);
+	}
+}
+
+shared_ptr<GeometryScratchPool> GeometryScratchPool::Get(ClientContext &context) {
+	auto &object_cache = ObjectCache::GetObjectCache(context);
+	auto result = object_cache.GetOrCreate<GeometryScratchPool>(ObjectType(), BufferAllocator::Get(context));
+
+	Value capacity_value;
+	if (context.TryGetCurrentSetting(SETTING_NAME, capacity_value)) {
+		const auto new_capacity = capacity_value.GetValue<idx_t>();
+		if (new_capacity != result->capacity.load()) {
+			result->SetCapacity(new_capacity);
+		}
+	}
+	return result;
+}
+
+void GeometryScratchPool::Register(DatabaseInstance &db) {
+	db.config.AddExtensionOption(SETTING_NAME,
+	                             "The number of bytes of scratch memory for geometries that is kept around for reuse "
+	                             "per CPU, after the functions using it are done with it. 0 disables the reuse",
+	                             LogicalType::UBIGINT, Value::UBIGINT(DEFAULT_CAPACITY));
+}
+
+void GeometryScratchPool::Reset(ArenaAllocator &arena) {
+	const auto head = arena.GetHead();
+	if (head && head->maximum_size > MAX_RETAINED_ARENA_SIZE) {
+		// Give back all blocks, the oversized ones are released while the others go back into the pool
+		arena.Destroy();
+	} else {
+		arena.Reset();
+	}
+}
+
+void GeometryScratchPool::SetCapacity(idx_t capacity_p) {
+	capacity = capacity_p;
+	for (auto &shard : shards) {
+		lock_guard<mutex> guard(shard.lock);
+		Shrink(shard, capacity_p);
+	}
+}
+
+data_ptr_t GeometryScratchPool::AllocateBlock(PrivateAllocatorData *private_data, idx_t size) {
+	return private_data->Cast<ScratchPoolAllocatorData>().pool.Allocate(size);
+}
+
+void GeometryScratchPool::FreeBlock(PrivateAllocatorData *private_data, data_ptr_t pointer, idx_t size) {
+	private_data->Cast<ScratchPoolAllocatorData>().pool.Free(pointer, size);
+}
+
+data_ptr_t GeometryScratchPool::ReallocateBlock(PrivateAllocatorData *private_data, data_ptr_t pointer,
+                                                idx_t old_size, idx_t size) {
+	// The arenas never reallocate their blocks, but this has to work regardless
+	auto &pool = private_data->Cast<ScratchPoolAllocatorData>().pool;
+	const auto result = pool.Allocate(size);
+	if (pointer) {
+		memcpy(result, pointer, MinValue(old_size, size));
+		pool.Free(pointer, old_size);
+	}
+	return result;
+}
+
+data_ptr_t GeometryScratchPool::Allocate(idx_t size) {
+	if (size > MAX_BLOCK_SIZE) {
+		return backing.AllocateData(size);
+	}
+
+	const auto size_class = GetSizeClass(size);
+	{
+		auto &shard = GetShard();
+		lock_guard<mutex> guard(shard.lock);
+		auto &free_list = shard.free_lists[size_class];
+		if (!free_list.empty()) {
+			const auto result = free_list.back();
+			free_list.pop_back();
+			shard.retained -= GetClassSize(size_class);
+			return result;
+		}
+	}
+	return backing.AllocateData(GetClassSize(size_class));
+}
+
+void GeometryScratchPool::Free(data_ptr_t pointer, idx_t size) {
+	if (size > MAX_BLOCK_SIZE) {
+		backing.FreeData(pointer, size);
+		return;
+	}
+
+	const auto size_class = GetSizeClass(size);
+	const auto class_size = GetClassSize(size_class);
+	{
+		auto &shard = GetShard();
+		lock_guard<mutex> guard(shard.lock);
+		if (shard.retained + class_size <= capacity.load()) {
+			shard.free_lists[size_class].push_back(pointer);
+			shard.retained += class_size;
+			return;
+		}
+	}
+	backing.FreeData(pointer, class_size);
+}
+
+GeometryScratchPool::Shard &GeometryScratchPool::GetShard() {
+	// The cpu id is only an estimate, but all we need is for threads to mostly stay out of each other's way
+	const auto cpu_id = TaskScheduler::GetEstimatedCPUId();
+	return shards[cpu_id < 0 ? 0 : NumericCast<idx_t>(cpu_id) % SHARD_COUNT];
+}
+
+void GeometryScratchPool::Shrink(Shard &shard, idx_t capacity_p) {
+	// Release the largest blocks first
+	for (idx_t size_class = CLASS_COUNT; size_class-- > 0 && shard.retained > capacity_p;) {
+		auto &free_list = shard.free_lists[size_class];
+		while (!free_list.empty() && shard.retained > capacity_p) {
+			backing.FreeData(free_list.back(), GetClassSize(size_class));
+			free_list.pop_back();
+			shard.retained -= GetClassSize(size_class);
+		}
+	}
+}
+
+} // namespace duckdb
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "duckdb/common/allocator.hpp"
+#include "duckdb/common/atomic.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/vector.hpp"
+#include "duckdb/storage/arena_allocator.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+namespace duckdb {
+
+class ClientContext;
+class DatabaseInstance;
+
+//! A pool of scratch memory blocks, shared by the arenas of all geometry function local states of a database.
+//! The blocks are kept in a free list per power-of-two size class, with one set of free lists per CPU, so that the
+//! memory an arena gives back is reused by the next arena on the same thread instead of every arena holding on to its
+//! own high-water mark. The blocks come from the buffer allocator, so both the blocks in use and the blocks retained in
+//! the pool count towards the memory limit.
+class GeometryScratchPool final : public ObjectCacheEntry {
+public:
+	static constexpr auto SETTING_NAME = "geometry_scratch_pool_size";
+	//! The default number of bytes retained per CPU
+	static constexpr idx_t DEFAULT_CAPACITY = 4 * 1024 * 1024;
+	//! The smallest size class, which is the initial capacity of an arena
+	static constexpr idx_t MIN_BLOCK_SIZE = ArenaAllocator::ARENA_ALLOCATOR_INITIAL_CAPACITY;
+	//! The largest size class, larger blocks are always given back to the buffer allocator when they are freed
+	static constexpr idx_t MAX_BLOCK_SIZE = 1024 * 1024;
+	//! The largest block an arena holds on to across resets, see Reset
+	static constexpr idx_t MAX_RETAINED_ARENA_SIZE = 64 * 1024;
+	static constexpr idx_t SHARD_COUNT = 64;
+
+	explicit GeometryScratchPool(Allocator &backing);
+	~GeometryScratchPool() override;
+
+	static string ObjectType() {
+		return "spatial_geometry_scratch_pool";
+	}
+
+	string GetObjectType() override {
+		return ObjectType();
+	}
+
+	static shared_ptr<GeometryScratchPool> Get(ClientContext &context);
+	static void Register(DatabaseInstance &db);
+
+	//! The allocator to construct the arenas with. This is thread-safe, and must outlive the arenas using it.
+	Allocator &GetAllocator() {
+		return allocator;
+	}
+
+	//! Reset an arena, keeping its last block for the next batch unless it grew larger than MAX_RETAINED_ARENA_SIZE
+	//! (e.g. to fit a huge geometry), in which case all of its blocks are given back.
+	static void Reset(ArenaAllocator &arena);
+
+	//! Set the number of bytes retained per CPU, releasing the blocks over the new capacity
+	void SetCapacity(idx_t capacity);
+
+private:
+	static constexpr idx_t CLASS_COUNT = 10;
+	static_assert(MIN_BLOCK_SIZE << (CLASS_COUNT - 1) == MAX_BLOCK_SIZE, "size classes must span up to MAX_BLOCK_SIZE");
+
+	struct Shard {
+		mutex lock;
+		vector<data_ptr_t> free_lists[CLASS_COUNT];
+		idx_t retained = 0;
+	};
+
+	static data_ptr_t AllocateBlock(PrivateAllocatorData *private_data, idx_t size);
+	static void FreeBlock(PrivateAllocatorData *private_data, data_ptr_t pointer, idx_t size);
+	static data_ptr_t ReallocateBlock(PrivateAllocatorData *private_data, data_ptr_t pointer, idx_t old_size,
+	                                  idx_t size);
+
+	data_ptr_t Allocate(idx_t size);
+	void Free(data_ptr_t pointer, idx_t size);
+	Shard &GetShard();
+	void Shrink(Shard &shard, idx_t capacity);
+
+	Allocator &backing;
+	Allocator allocator;
+	atomic<idx_t> capacity;
+	Shard shards[SHARD_COUNT];
+};
+
+} // namespace duckdb
@@ -0,0 +1,226 @@
+#include "spatial/util/spatial_profiler.hpp"
+
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/vector.hpp"
+#include "duckdb/function/pragma_function.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+#include <algorithm>
+
+namespace duckdb {
+
+atomic<bool> SpatialProfiler::enabled = {false};
+
+namespace {
+
+// The counters of a single thread. Only the owning thread writes to them, so they are updated without atomic
+// read-modify-write operations, and other threads only read them (or reset them, which may lose a concurrent update).
+struct ThreadCounters;
+
+struct CounterRegistry {
+	mutex lock;
+	vector<ThreadCounters *> threads;
+	// The counters of the threads that have exited
+	uint64_t retired_calls[SpatialProfiler::CATEGORY_COUNT] = {};
+	uint64_t retired_nanos[SpatialProfiler::CATEGORY_COUNT] = {};
+};
+
+// Never destroyed, so that threads exiting after the static destructors ran can still unregister
+CounterRegistry &GetRegistry() {
+	static auto registry = new CounterRegistry();
+	return *registry;
+}
+
+struct ThreadCounters {
+	atomic<uint64_t> calls[SpatialProfiler::CATEGORY_COUNT] = {};
+	atomic<uint64_t> nanos[SpatialProfiler::CATEGORY_COUNT] = {};
+	SpatialProfileScope *current = nullptr;
+
+	ThreadCounters() {
+		auto &registry = GetRegistry();
+		lock_guard<mutex> guard(registry.lock);
+		registry.threads.push_back(this);
+	}
+
+	~ThreadCounters() {
+		auto &registry = GetRegistry();
+		lock_guard<mutex> guard(registry.lock);
+		for (idx_t i = 0; i < SpatialProfiler::CATEGORY_COUNT; i++) {
+			registry.retired_calls[i] += calls[i].load(std::memory_order_relaxed);
+			registry.retired_nanos[i] += nanos[i].load(std::memory_order_relaxed);
+		}
+		registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+	}
+};
+
+ThreadCounters &GetThreadCounters() {
+	thread_local ThreadCounters counters;
+	return counters;
+}
+
+void Increment(atomic<uint64_t> &counter, uint64_t value) {
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+const char *SpatialProfiler::GetName(SpatialProfileCategory category) {
+	switch (category) {
+	case SpatialProfileCategory::SERIALIZE:
+		return "serialize";
+	case SpatialProfileCategory::DESERIALIZE:
+		return "deserialize";
+	case SpatialProfileCategory::GEOS_SERIALIZE:
+		return "geos_serialize";
+	case SpatialProfileCategory::GEOS_DESERIALIZE:
+		return "geos_deserialize";
+	case SpatialProfileCategory::GEOS_KERNEL:
+		return "geos_kernel";
+	case SpatialProfileCategory::PROJ_CREATE:
+		return "proj_create";
+	case SpatialProfileCategory::PROJ_TRANSFORM:
+		return "proj_transform";
+	default:
+		return "unknown";
+	}
+}
+
+void SpatialProfiler::Record(SpatialProfileCategory category, uint64_t nanos) {
+	auto &counters = GetThreadCounters();
+	const auto idx = static_cast<idx_t>(category);
+	Increment(counters.calls[idx], 1);
+	Increment(counters.nanos[idx], nanos);
+}
+
+void SpatialProfiler::GetTotals(uint64_t calls[], uint64_t nanos[]) {
+	auto &registry = GetRegistry();
+	lock_guard<mutex> guard(registry.lock);
+	for (idx_t i = 0; i < CATEGORY_COUNT; i++) {
+		calls[i] = registry.retired_calls[i];
+		nanos[i] = registry.retired_nanos[i];
+		for (const auto thread : registry.threads) {
+			calls[i] += thread->calls[i].load(std::memory_order_relaxed);
+			nanos[i] += thread->nanos[i].load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void SpatialProfiler::Reset() {
+	auto &registry = GetRegistry();
+	lock_guard<mutex> guard(registry.lock);
+	for (idx_t i = 0; i < CATEGORY_COUNT; i++) {
+		registry.retired_calls[i] = 0;
+		registry.retired_nanos[i] = 0;
+		for (const auto thread : registry.threads) {
+			thread->calls[i].store(0, std::memory_order_relaxed);
+			thread->nanos[i].store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Scope
+//------------------------------------------------------------------------------
+void SpatialProfileScope::Start() {
+	auto &counters = GetThreadCounters();
+	active = true;
+	parent = counters.current;
+	counters.current = this;
+	start = std::chrono::steady_clock::now();
+}
+
+void SpatialProfileScope::Stop() {
+	const auto elapsed = static_cast<uint64_t>(
+	    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+	auto &counters = GetThreadCounters();
+	counters.current = parent;
+	if (parent) {
+		parent->child_nanos += elapsed;
+	}
+	SpatialProfiler::Record(category, elapsed - std::min(child_nanos, elapsed));
+}
+
+//------------------------------------------------------------------------------
+// Table Function
+//------------------------------------------------------------------------------
+namespace {
+
+struct SpatialProfileState final : public GlobalTableFunctionState {
+	uint64_t calls[SpatialProfiler::CATEGORY_COUNT] = {};
+	uint64_t nanos[SpatialProfiler::CATEGORY_COUNT] = {};
+	bool done = false;
+};
+
+unique_ptr<FunctionData> SpatialProfileBind(ClientContext &context, TableFunctionBindInput &input,
+                                            vector<LogicalType> &return_types, vector<string> &names) {
+	names.emplace_back("category");
+	return_types.emplace_back(LogicalType::VARCHAR);
+
+	names.emplace_back("calls");
+	return_types.emplace_back(LogicalType::UBIGINT);
+
+	names.emplace_back("time_ms");
+	return_types.emplace_back(LogicalType::DOUBLE);
+
+	names.emplace_back("ns_per_call");
+	return_types.emplace_back(LogicalType::DOUBLE);
+
+	return nullptr;
+}
+
+unique_ptr<GlobalTableFunctionState> SpatialProfileInit(ClientContext &context, TableFunctionInitInput &input) {
+	auto result = make_uniq<SpatialProfileState>();
+	SpatialProfiler::GetTotals(result->calls, result->nanos);
+	return std::move(result);
+}
+
+void SpatialProfileExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &state = data_p.global_state->Cast<SpatialProfileState>();
+	if (state.done) {
+		return;
+	}
+	state.done = true;
+
+	for (idx_t i = 0; i < SpatialProfiler::CATEGORY_COUNT; i++) {
+		const auto calls = state.calls[i];
+		const auto nanos = static_cast<double>(state.nanos[i]);
+		output.data[0].SetValue(i, Value(SpatialProfiler::GetName(static_cast<SpatialProfileCategory>(i))));
+		output.data[1].SetValue(i, Value::UBIGINT(calls));
+		output.data[2].SetValue(i, Value::DOUBLE(nanos / 1e6));
+		output.data[3].SetValue(i, calls == 0 ? Value(LogicalType::DOUBLE) : Value::DOUBLE(nanos / calls));
+	}
+	output.SetCardinality(SpatialProfiler::CATEGORY_COUNT);
+}
+
+void SpatialProfileResetPragma(ClientContext &context, const FunctionParameters &parameters) {
+	SpatialProfiler::Reset();
+}
+
+void SetSpatialProfiling(ClientContext &context, SetScope scope, Value &parameter) {
+	SpatialProfiler::SetEnabled(!parameter.IsNull() && BooleanValue::Get(parameter));
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Register
+//------------------------------------------------------------------------------
+void SpatialProfiler::Register(DatabaseInstance &db) {
+	db.config.AddExtensionOption(SETTING_NAME,
+	                             "Count the calls and time spent serializing geometries, in GEOS and in PROJ, see "
+	                             "spatial_profile(). The counters are shared by the whole process",
+	                             LogicalType::BOOLEAN, Value::BOOLEAN(false), SetSpatialProfiling);
+
+	const TableFunction profile_function("spatial_profile", {}, SpatialProfileExecute, SpatialProfileBind,
+	                                     SpatialProfileInit);
+	ExtensionUtil::RegisterFunction(db, profile_function);
+
+	const auto reset_function = PragmaFunction::PragmaStatement("spatial_profile_reset", SpatialProfileResetPragma);
+	ExtensionUtil::RegisterFunction(db, reset_function);
+}
+
+} // namespace duckdb
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "duckdb/common/atomic.hpp"
+#include "duckdb/common/typedefs.hpp"
+
+#include <chrono>
+
+namespace duckdb {
+
+class DatabaseInstance;
+
+//! The boundaries of the extension that are timed when profiling is enabled
+enum class SpatialProfileCategory : uint8_t {
+	//! Serde::Serialize, converting an sgl geometry into a GEOMETRY blob
+	SERIALIZE = 0,
+	//! Serde::Deserialize, converting a GEOMETRY blob into an sgl geometry
+	DESERIALIZE,
+	//! Converting a GEOS geometry into a GEOMETRY blob
+	GEOS_SERIALIZE,
+	//! Converting a GEOMETRY blob into a GEOS geometry
+	GEOS_DESERIALIZE,
+	//! The GEOS scalar functions, excluding the time spent in the (de)serialization above
+	GEOS_KERNEL,
+	//! Resolving a transformation between two CRS (proj_create_crs_to_crs)
+	PROJ_CREATE,
+	//! Transforming coordinates with PROJ
+	PROJ_TRANSFORM,
+};
+
+//! Opt-in timing of the expensive boundaries of the extension, enabled with `SET spatial_profiling = true`. Each thread
+//! counts the calls and the time spent in each category in its own counters, which are summed when queried with the
+//! spatial_profile() table function, and reset with `PRAGMA spatial_profile_reset`. The counters are shared by all
+//! database instances in the process.
+class SpatialProfiler {
+public:
+	static constexpr auto SETTING_NAME = "spatial_profiling";
+	static constexpr idx_t CATEGORY_COUNT = 7;
+
+	static bool IsEnabled() {
+		return enabled.load(std::memory_order_relaxed);
+	}
+	static void SetEnabled(bool enabled_p) {
+		enabled.store(enabled_p, std::memory_order_relaxed);
+	}
+
+	static const char *GetName(SpatialProfileCategory category);
+
+	//! Add a call that took the given number of nanoseconds to the counters of the current thread
+	static void Record(SpatialProfileCategory category, uint64_t nanos);
+
+	//! Sum the counters of all threads, both arrays must have CATEGORY_COUNT entries
+	static void GetTotals(uint64_t calls[], uint64_t nanos[]);
+
+	//! Reset the counters of all threads
+	static void Reset();
+
+	static void Register(DatabaseInstance &db);
+
+private:
+	static atomic<bool> enabled;
+};
+
+//! Times the enclosing block if profiling is enabled, and does nothing otherwise. Scopes can be nested, the time spent
+//! in nested scopes is only counted for the innermost one, so e.g. the time of a GEOS function excludes the time spent
+//! deserializing its arguments.
+class SpatialProfileScope {
+public:
+	explicit SpatialProfileScope(SpatialProfileCategory category_p) : category(category_p) {
+		if (SpatialProfiler::IsEnabled()) {
+			Start();
+		}
+	}
+
+	~SpatialProfileScope() {
+		if (active) {
+			Stop();
+		}
+	}
+
+	// Not copyable
+	SpatialProfileScope(const SpatialProfileScope &) = delete;
+	SpatialProfileScope &operator=(const SpatialProfileScope &) = delete;
+
+private:
+	void Start();
+	void Stop();
+
+	SpatialProfileCategory category;
+	bool active = false;
+	SpatialProfileScope *parent = nullptr;
+	uint64_t child_nanos = 0;
+	std::chrono::steady_clock::time_point start;
+};
+
+} // namespace duckdb
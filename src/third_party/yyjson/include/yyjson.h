@@ -1035,6 +1035,23 @@ yyjson_api_inline char *yyjson_write(const yyjson_doc *doc,
     return yyjson_write_opts(doc, flg, NULL, len, NULL);
 }
 
+/**
+ Write a single double number to a buffer, using the same shortest round-trip
+ formatting as the document writer (spatial extension addition).
+
+ @param val The number to write.
+ @param buf The output buffer, must have room for at least 32 bytes.
+    No null-terminator is written.
+ @param flg The JSON write options.
+    Supports `YYJSON_WRITE_ALLOW_INF_AND_NAN` and
+    `YYJSON_WRITE_INF_AND_NAN_AS_NULL`.
+ @return A pointer to the character after the last character written,
+    or NULL if the number is inf or nan and the flags do not allow it.
+ */
+yyjson_api char *yyjson_write_number_f64(double val,
+                                         char *buf,
+                                         yyjson_write_flag flg);
+
 
 
 /**
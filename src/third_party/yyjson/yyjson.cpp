@@ -6673,6 +6673,11 @@ static_noinline u8 *write_f64_raw(u8 *buf, u64 raw, yyjson_write_flag flg) {
 
 #endif /* FP_WRITER */
 
+/** Write a double number (requires 32 bytes buffer), spatial addition. */
+char *yyjson_write_number_f64(double val, char *buf, yyjson_write_flag flg) {
+    return (char *)write_f64_raw((u8 *)buf, f64_to_raw(val), flg);
+}
+
 /** Write a JSON number (requires 32 bytes buffer). */
 static_inline u8 *write_number(u8 *cur, yyjson_val *val,
                                yyjson_write_flag flg) {
@@ -86,3 +86,86 @@ def test_roundtrip_segments(geoarrow_con):
 
     # Check roundtrip output
     assert geoarrow_con.sql("""SELECT * from geo_table""").to_arrow_table() == geo_table
+
+
+def test_native_export(geoarrow_con):
+    tab = geoarrow_con.sql(
+        """SELECT ST_GeomFromText('LINESTRING (0 1, 2 3)')::LINESTRING_2D as geom;"""
+    ).to_arrow_table()
+    field = tab.schema.field("geom")
+    assert field.metadata[b"ARROW:extension:name"] == b"geoarrow.linestring"
+    assert field.type.value_type == pa.struct([("x", pa.float64()), ("y", pa.float64())])
+    assert tab["geom"].to_pylist() == [[{"x": 0.0, "y": 1.0}, {"x": 2.0, "y": 3.0}]]
+
+
+def test_native_import(geoarrow_con):
+    coords = pa.struct([("x", pa.float64()), ("y", pa.float64())])
+    multipolygon = pa.array(
+        [
+            [[[{"x": 0, "y": 0}, {"x": 1, "y": 0}, {"x": 1, "y": 1}, {"x": 0, "y": 0}]]],
+            None,
+            [],
+        ],
+        pa.list_(pa.list_(pa.list_(coords))),
+    )
+    multipoint = pa.array(
+        [[{"x": 0, "y": 1}, {"x": 2, "y": 3}], None, []], pa.list_(coords)
+    )
+    schema = pa.schema(
+        [
+            pa.field(
+                "multipolygon",
+                multipolygon.type,
+                metadata={"ARROW:extension:name": "geoarrow.multipolygon"},
+            ),
+            pa.field(
+                "multipoint",
+                multipoint.type,
+                metadata={"ARROW:extension:name": "geoarrow.multipoint"},
+            ),
+        ]
+    )
+    geo_table = pa.table([multipolygon, multipoint], schema=schema)
+
+    tab = geoarrow_con.sql(
+        """SELECT ST_AsText(multipolygon) as a, ST_AsText(multipoint) as b FROM geo_table;"""
+    ).to_arrow_table()
+    assert tab["a"].to_pylist() == [
+        "MULTIPOLYGON (((0 0, 1 0, 1 1, 0 0)))",
+        None,
+        "MULTIPOLYGON EMPTY",
+    ]
+    assert tab["b"].to_pylist() == ["MULTIPOINT (0 1, 2 3)", None, "MULTIPOINT EMPTY"]
+
+
+def test_reject_interleaved_coordinates(geoarrow_con):
+    field = pa.field(
+        "geometry",
+        pa.list_(pa.float64(), 2),
+        metadata={"ARROW:extension:name": "geoarrow.point"},
+    )
+    geo_table = pa.table([pa.array([], pa.list_(pa.float64(), 2))], schema=pa.schema([field]))
+    with pytest.raises(duckdb.NotImplementedException, match="separated"):
+        geoarrow_con.sql("""SELECT * from geo_table""")
+
+
+def test_point_and_box_export(geoarrow_con):
+    tab = geoarrow_con.sql(
+        """SELECT ST_Point2D(1, 2) as pt, ST_Extent(ST_GeomFromText('LINESTRING (0 1, 2 3)')) as box;"""
+    ).to_arrow_table()
+    pt_field = tab.schema.field("pt")
+    assert pt_field.metadata[b"ARROW:extension:name"] == b"geoarrow.point"
+    assert pt_field.type == pa.struct([("x", pa.float64()), ("y", pa.float64())])
+    assert tab["pt"].to_pylist() == [{"x": 1.0, "y": 2.0}]
+
+    box_field = tab.schema.field("box")
+    assert box_field.metadata[b"ARROW:extension:name"] == b"geoarrow.box"
+    assert [f.name for f in box_field.type] == ["xmin", "ymin", "xmax", "ymax"]
+    assert tab["box"].to_pylist() == [
+        {"xmin": 0.0, "ymin": 1.0, "xmax": 2.0, "ymax": 3.0}
+    ]
+
+    # And back
+    assert geoarrow_con.sql("""SELECT typeof(pt), typeof(box) FROM tab""").fetchall() == [
+        ("POINT_2D", "BOX_2D")
+    ]